@@ -1869,6 +1869,7 @@ string MainWindow::getModelInfo() {
 		str+= "Meshes: "+intToStr(model->getMeshCount());
 		str+= ", Vertices: "+intToStr(model->getVertexCount());
 		str+= ", Triangles: "+intToStr(model->getTriangleCount());
+		str+= ", ACMR: "+floatToStr(model->getCacheStats().getACMR(),3);
 		str+= ", Version: "+intToStr(model->getFileVersion());
 	}
 
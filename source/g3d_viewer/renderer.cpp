@@ -236,6 +236,8 @@ void Renderer::init() {
 
 	modelManager = gf->newModelManager();
 	modelManager->setTextureManager(textureManager);
+	// Models get re-exported while the viewer has them open
+	Model::setMapDataInPlace(false);
 
 	//red tex
 	customTextureRed= textureManager->newTexture2D();
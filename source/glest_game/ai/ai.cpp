@@ -232,12 +232,239 @@ UpgradeTask * UpgradeTask::loadGame(const XmlNode *rootNode, Faction *faction) {
 	return newTask;
 }
 
+// =====================================================
+// 	class AiBlackboard
+// =====================================================
+
+AiBlackboard::AiBlackboard() {
+	aiInterface			= NULL;
+	structureValid		= false;
+	structureVersion	= 0;
+	structureUnitCount	= 0;
+	harvestValid		= false;
+	harvestFrame		= 0;
+}
+
+void AiBlackboard::init(AiInterface *aiInterface) {
+	this->aiInterface = aiInterface;
+	invalidate();
+}
+
+void AiBlackboard::invalidate() {
+	structureValid	= false;
+	harvestValid	= false;
+}
+
+void AiBlackboard::refresh() {
+	Faction *faction = aiInterface->getMyFaction();
+	int unitCount = aiInterface->getMyUnitCount();
+	if(structureValid == true &&
+		structureVersion == faction->getUnitStateVersion() &&
+		structureUnitCount == unitCount) {
+		return;
+	}
+
+	structureValid		= true;
+	structureVersion	= faction->getUnitStateVersion();
+	structureUnitCount	= unitCount;
+	harvestValid		= false;
+
+	unitInfoList.resize(unitCount);
+	countByType.clear();
+	countByClass.clear();
+	ableUnitsIdle.clear();
+	ableUnitsDoingCommand.clear();
+	mobileUnits.clear();
+
+	for(int i = 0; i < unitCount; ++i) {
+		const Unit *unit = aiInterface->getMyUnit(i);
+		UnitInfo &info = unitInfoList[i];
+
+		info.type			= unit->getType();
+		info.commandable	= info.type->isCommandable();
+		info.currentCommand	= (unit->anyCommand() ? unit->getCurrCommand()->getCommandType()->getClass() : ccNull);
+
+		countByType[info.type]++;
+		if(info.type->isMobile()) {
+			mobileUnits.push_back(i);
+		}
+	}
+}
+
+int AiBlackboard::getCountOfType(const UnitType *ut) {
+	refresh();
+
+	std::map<const UnitType*,int>::const_iterator iterFind = countByType.find(ut);
+	return (iterFind != countByType.end() ? iterFind->second : 0);
+}
+
+int AiBlackboard::getCountOfClass(UnitClass uc,UnitClass *additionalUnitClassToExcludeFromCount) {
+	refresh();
+
+	std::pair<int,int> key(uc,(additionalUnitClassToExcludeFromCount != NULL ? *additionalUnitClassToExcludeFromCount : -1));
+	std::map<std::pair<int,int>,int>::const_iterator iterFind = countByClass.find(key);
+	if(iterFind != countByClass.end()) {
+		return iterFind->second;
+	}
+
+	// Classes are a property of the unit type so only the distinct types
+	// need to be examined
+	int count = 0;
+	for(std::map<const UnitType*,int>::const_iterator iterMap = countByType.begin();
+		iterMap != countByType.end(); ++iterMap) {
+		const UnitType *ut = iterMap->first;
+		if(ut->isOfClass(uc)) {
+			// Skip unit if it ALSO contains the exclusion unit class type
+			if(additionalUnitClassToExcludeFromCount != NULL &&
+				ut->isOfClass(*additionalUnitClassToExcludeFromCount)) {
+				continue;
+			}
+			count += iterMap->second;
+		}
+	}
+	countByClass[key] = count;
+	return count;
+}
+
+const vector<int> &AiBlackboard::getAbleUnits(CommandClass ability, bool idleOnly) {
+	refresh();
+
+	std::pair<int,int> key(ability,idleOnly);
+	UnitIndexListMap::iterator iterFind = ableUnitsIdle.find(key);
+	if(iterFind != ableUnitsIdle.end()) {
+		return iterFind->second;
+	}
+
+	UnitIndexList &units = ableUnitsIdle[key];
+	for(int i = 0; i < (int)unitInfoList.size(); ++i) {
+		const UnitInfo &info = unitInfoList[i];
+		if(info.commandable && info.type->hasCommandClass(ability)) {
+			if(!idleOnly || info.currentCommand == ccNull || info.currentCommand == ccStop) {
+				units.push_back(i);
+			}
+		}
+	}
+	return units;
+}
+
+const vector<int> &AiBlackboard::getAbleUnits(CommandClass ability, CommandClass currentCommand) {
+	refresh();
+
+	std::pair<int,int> key(ability,currentCommand);
+	UnitIndexListMap::iterator iterFind = ableUnitsDoingCommand.find(key);
+	if(iterFind != ableUnitsDoingCommand.end()) {
+		return iterFind->second;
+	}
+
+	UnitIndexList &units = ableUnitsDoingCommand[key];
+	for(int i = 0; i < (int)unitInfoList.size(); ++i) {
+		const UnitInfo &info = unitInfoList[i];
+		if(info.commandable && info.type->hasCommandClass(ability)) {
+			if(info.currentCommand != ccNull && info.currentCommand == currentCommand) {
+				units.push_back(i);
+			}
+		}
+	}
+	return units;
+}
+
+const vector<int> &AiBlackboard::getMobileUnits() {
+	refresh();
+	return mobileUnits;
+}
+
+const vector<int> &AiBlackboard::getUnitsHarvestingResourceType(const ResourceType *rt) {
+	refresh();
+
+	// Harvest targets and resource amounts change during the world update
+	// without any command change so this view only lives for one frame
+	int frame = aiInterface->getWorld()->getFrameCount();
+	if(harvestValid == false || harvestFrame != frame) {
+		unitsGettingResource.clear();
+		harvestValid = true;
+		harvestFrame = frame;
+	}
+
+	std::map<const ResourceType*, UnitIndexList>::iterator iterFind = unitsGettingResource.find(rt);
+	if(iterFind != unitsGettingResource.end()) {
+		return iterFind->second;
+	}
+	return computeHarvestingResourceType(rt);
+}
+
+const vector<int> &AiBlackboard::computeHarvestingResourceType(const ResourceType *rt) {
+	UnitIndexList &units = unitsGettingResource[rt];
+
+	Map *map= aiInterface->getMap();
+	for(int i = 0; i < (int)unitInfoList.size(); ++i) {
+		const UnitInfo &info = unitInfoList[i];
+		if(info.commandable == false ||
+			(info.currentCommand != ccHarvest &&
+			 info.currentCommand != ccProduce &&
+			 info.currentCommand != ccBuild)) {
+			continue;
+		}
+
+		const Unit *unit= aiInterface->getMyUnit(i);
+		if(unit->getType()->hasCommandClass(ccHarvest)) {
+			if(info.currentCommand == ccHarvest) {
+				Command *command= unit->getCurrCommand();
+				const HarvestCommandType *hct= dynamic_cast<const HarvestCommandType*>(command->getCommandType());
+				if(hct != NULL) {
+					const Vec2i unitTargetPos = unit->getTargetPos();
+					SurfaceCell *sc= map->getSurfaceCell(Map::toSurfCoords(unitTargetPos));
+					Resource *r= sc->getResource();
+					if (r != NULL && r->getType() == rt) {
+						units.push_back(i);
+					}
+				}
+			}
+		}
+		else if(unit->getType()->hasCommandClass(ccProduce)) {
+			if(info.currentCommand == ccProduce) {
+				Command *command= unit->getCurrCommand();
+				const ProduceCommandType *pct= dynamic_cast<const ProduceCommandType*>(command->getCommandType());
+				if(pct != NULL) {
+					const UnitType *ut = pct->getProducedUnit();
+					if(ut != NULL) {
+						const Resource *r = ut->getCost(rt);
+						if (r != NULL && r->getAmount() < 0) {
+							units.push_back(i);
+						}
+					}
+				}
+			}
+		}
+		else if(unit->getType()->hasCommandClass(ccBuild)) {
+			if(info.currentCommand == ccBuild) {
+				Command *command= unit->getCurrCommand();
+				const BuildCommandType *bct= dynamic_cast<const BuildCommandType*>(command->getCommandType());
+				if(bct != NULL) {
+					for(int j = 0; j < bct->getBuildingCount(); ++j) {
+						const UnitType *ut = bct->getBuilding(j);
+						if(ut != NULL) {
+							const Resource *r = ut->getCost(rt);
+							if (r != NULL && r->getAmount() < 0) {
+								units.push_back(i);
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return units;
+}
+
 // =====================================================
 // 	class Ai
 // =====================================================
 
 void Ai::init(AiInterface *aiInterface, int useStartLocation) {
 	this->aiInterface= aiInterface;
+	blackboard.init(aiInterface);
 
 	Faction *faction = this->aiInterface->getMyFaction();
 	if(faction->getAIBehaviorStaticOverideValue(aibsvcMaxBuildRadius) != INT_MAX) {
@@ -421,29 +648,11 @@ void Ai::update() {
 // ==================== state requests ====================
 
 int Ai::getCountOfType(const UnitType *ut){
-    int count= 0;
-	for(int i=0; i<aiInterface->getMyUnitCount(); ++i){
-		if(ut == aiInterface->getMyUnit(i)->getType()){
-			count++;
-		}
-	}
-    return count;
+	return blackboard.getCountOfType(ut);
 }
 
 int Ai::getCountOfClass(UnitClass uc,UnitClass *additionalUnitClassToExcludeFromCount) {
-    int count= 0;
-    for(int i = 0; i < aiInterface->getMyUnitCount(); ++i) {
-		if(aiInterface->getMyUnit(i)->getType()->isOfClass(uc)) {
-			// Skip unit if it ALSO contains the exclusion unit class type
-			if(additionalUnitClassToExcludeFromCount != NULL) {
-				if(aiInterface->getMyUnit(i)->getType()->isOfClass(*additionalUnitClassToExcludeFromCount)) {
-					continue;
-				}
-			}
-            ++count;
-		}
-    }
-    return count;
+	return blackboard.getCountOfClass(uc,additionalUnitClassToExcludeFromCount);
 }
 
 float Ai::getRatioOfClass(UnitClass uc,UnitClass *additionalUnitClassToExcludeFromCount) {
@@ -526,18 +735,9 @@ bool Ai::isStableBase() {
 }
 
 bool Ai::findAbleUnit(int *unitIndex, CommandClass ability, bool idleOnly){
-	vector<int> units;
+	const vector<int> &units = blackboard.getAbleUnits(ability, idleOnly);
 
 	*unitIndex= -1;
-	for(int i=0; i<aiInterface->getMyUnitCount(); ++i){
-		const Unit *unit= aiInterface->getMyUnit(i);
-		if(unit->getType()->isCommandable() && unit->getType()->hasCommandClass(ability)){
-			if(!idleOnly || !unit->anyCommand() || unit->getCurrCommand()->getCommandType()->getClass()==ccStop){
-				units.push_back(i);
-			}
-		}
-	}
-
 	if(units.empty()){
 		return false;
 	}
@@ -548,97 +748,17 @@ bool Ai::findAbleUnit(int *unitIndex, CommandClass ability, bool idleOnly){
 }
 
 vector<int> Ai::findUnitsHarvestingResourceType(const ResourceType *rt) {
-	vector<int> units;
-
-	Map *map= aiInterface->getMap();
-	for(int i = 0; i < aiInterface->getMyUnitCount(); ++i) {
-		const Unit *unit= aiInterface->getMyUnit(i);
-		if(unit->getType()->isCommandable()) {
-			if(unit->getType()->hasCommandClass(ccHarvest)) {
-				if(unit->anyCommand() && unit->getCurrCommand()->getCommandType()->getClass() == ccHarvest) {
-					Command *command= unit->getCurrCommand();
-					const HarvestCommandType *hct= dynamic_cast<const HarvestCommandType*>(command->getCommandType());
-					if(hct != NULL) {
-						const Vec2i unitTargetPos = unit->getTargetPos();
-						SurfaceCell *sc= map->getSurfaceCell(Map::toSurfCoords(unitTargetPos));
-						Resource *r= sc->getResource();
-						if (r != NULL && r->getType() == rt) {
-							units.push_back(i);
-						}
-					}
-				}
-			}
-			else if(unit->getType()->hasCommandClass(ccProduce)) {
-				if(unit->anyCommand() && unit->getCurrCommand()->getCommandType()->getClass() == ccProduce) {
-					Command *command= unit->getCurrCommand();
-					const ProduceCommandType *pct= dynamic_cast<const ProduceCommandType*>(command->getCommandType());
-					if(pct != NULL) {
-						const UnitType *ut = pct->getProducedUnit();
-						if(ut != NULL) {
-							const Resource *r = ut->getCost(rt);
-							if(r != NULL) {
-								if (r != NULL && r->getAmount() < 0) {
-									units.push_back(i);
-								}
-							}
-						}
-					}
-				}
-			}
-			else if(unit->getType()->hasCommandClass(ccBuild)) {
-				if(unit->anyCommand() && unit->getCurrCommand()->getCommandType()->getClass() == ccBuild) {
-					Command *command= unit->getCurrCommand();
-					const BuildCommandType *bct= dynamic_cast<const BuildCommandType*>(command->getCommandType());
-					if(bct != NULL) {
-						for(int j = 0; j < bct->getBuildingCount(); ++j) {
-							const UnitType *ut = bct->getBuilding(j);
-							if(ut != NULL) {
-								const Resource *r = ut->getCost(rt);
-								if(r != NULL) {
-									if (r != NULL && r->getAmount() < 0) {
-										units.push_back(i);
-										break;
-									}
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	return units;
+	return blackboard.getUnitsHarvestingResourceType(rt);
 }
 
 vector<int> Ai::findUnitsDoingCommand(CommandClass currentCommand) {
-	vector<int> units;
-
-	for(int i = 0; i < aiInterface->getMyUnitCount(); ++i) {
-		const Unit *unit= aiInterface->getMyUnit(i);
-		if(unit->getType()->isCommandable() && unit->getType()->hasCommandClass(currentCommand)) {
-			if(unit->anyCommand() && unit->getCurrCommand()->getCommandType()->getClass() == currentCommand) {
-				units.push_back(i);
-			}
-		}
-	}
-
-	return units;
+	return blackboard.getAbleUnits(currentCommand, currentCommand);
 }
 
 bool Ai::findAbleUnit(int *unitIndex, CommandClass ability, CommandClass currentCommand){
-	vector<int> units;
+	const vector<int> &units = blackboard.getAbleUnits(ability, currentCommand);
 
 	*unitIndex= -1;
-	for(int i=0; i<aiInterface->getMyUnitCount(); ++i){
-		const Unit *unit= aiInterface->getMyUnit(i);
-		if(unit->getType()->isCommandable() && unit->getType()->hasCommandClass(ability)){
-			if(unit->anyCommand() && unit->getCurrCommand()->getCommandType()->getClass()==currentCommand){
-				units.push_back(i);
-			}
-		}
-	}
-
 	if(units.empty()){
 		return false;
 	}
@@ -1010,15 +1130,14 @@ bool Ai::haveBlockedUnits() {
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld [START]\n",__FILE__,__FUNCTION__,__LINE__,chrono.getMillis());
 
-	int unitCount = aiInterface->getMyUnitCount();
+	const vector<int> &mobileUnits = blackboard.getMobileUnits();
 	Map *map = aiInterface->getMap();
 	//If there is no close store
-	for(int j=0; j < unitCount; ++j) {
-		const Unit *u= aiInterface->getMyUnit(j);
-		const UnitType *ut= u->getType();
+	for(int idx=0; idx < (int)mobileUnits.size(); ++idx) {
+		const Unit *u= aiInterface->getMyUnit(mobileUnits[idx]);
 
 		// If this building is a store
-		if(u->isAlive() && ut->isMobile() && u->getPath() != NULL && (u->getPath()->isBlocked() || u->getPath()->getBlockCount())) {
+		if(u->isAlive() && u->getPath() != NULL && (u->getPath()->isBlocked() || u->getPath()->getBlockCount())) {
 			Vec2i unitPos = u->getPosNotThreadSafe();
 
 			//printf("#1 AI found blocked unit [%d - %s]\n",u->getId(),u->getFullName().c_str());
@@ -1102,16 +1221,15 @@ void Ai::unblockUnits() {
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld [START]\n",__FILE__,__FUNCTION__,__LINE__,chrono.getMillis());
 
-	int unitCount = aiInterface->getMyUnitCount();
+	const vector<int> &mobileUnits = blackboard.getMobileUnits();
 	Map *map = aiInterface->getMap();
 	// Find blocked units and move surrounding units out of the way
 	std::map<float, std::map<int, const Unit *> > signalAdjacentUnits;
-	for(int idx=0; idx < unitCount; ++idx) {
-		const Unit *u= aiInterface->getMyUnit(idx);
-		const UnitType *ut= u->getType();
+	for(int idx=0; idx < (int)mobileUnits.size(); ++idx) {
+		const Unit *u= aiInterface->getMyUnit(mobileUnits[idx]);
 
 		// If this building is a store
-		if(u->isAlive() && ut->isMobile() && u->getPath() != NULL && (u->getPath()->isBlocked() || u->getPath()->getBlockCount())) {
+		if(u->isAlive() && u->getPath() != NULL && (u->getPath()->isBlocked() || u->getPath()->getBlockCount())) {
 			Vec2i unitPos = u->getPosNotThreadSafe();
 
 			//printf("#2 AI found blocked unit [%d - %s]\n",u->getId(),u->getFullName().c_str());
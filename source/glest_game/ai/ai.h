@@ -121,6 +121,62 @@ public:
 	static UpgradeTask * loadGame(const XmlNode *rootNode, Faction *faction);
 };
 
+// =====================================================
+// 	class AiBlackboard
+//
+///	Cached view of the AI's own units used by the rules.
+/// Structural data (types, classes, current commands) is
+/// rebuilt only when the faction reports a unit change,
+/// data that also depends on the map is rebuilt per frame.
+/// All unit index lists keep faction unit order so random
+/// picks stay deterministic.
+// =====================================================
+
+class AiBlackboard {
+private:
+	typedef vector<int> UnitIndexList;
+	typedef std::map<std::pair<int,int>, UnitIndexList> UnitIndexListMap;
+
+	class UnitInfo {
+	public:
+		const UnitType *type;
+		bool commandable;
+		CommandClass currentCommand;
+	};
+
+	AiInterface *aiInterface;
+
+	bool structureValid;
+	unsigned int structureVersion;
+	int structureUnitCount;
+	vector<UnitInfo> unitInfoList;
+	std::map<const UnitType*,int> countByType;
+	std::map<std::pair<int,int>,int> countByClass;
+	UnitIndexListMap ableUnitsIdle;
+	UnitIndexListMap ableUnitsDoingCommand;
+	UnitIndexList mobileUnits;
+
+	bool harvestValid;
+	int harvestFrame;
+	std::map<const ResourceType*, UnitIndexList> unitsGettingResource;
+
+	void refresh();
+	const UnitIndexList &computeHarvestingResourceType(const ResourceType *rt);
+
+public:
+	AiBlackboard();
+
+	void init(AiInterface *aiInterface);
+	void invalidate();
+
+	int getCountOfType(const UnitType *ut);
+	int getCountOfClass(UnitClass uc,UnitClass *additionalUnitClassToExcludeFromCount=NULL);
+	const vector<int> &getAbleUnits(CommandClass ability, bool idleOnly);
+	const vector<int> &getAbleUnits(CommandClass ability, CommandClass currentCommand);
+	const vector<int> &getMobileUnits();
+	const vector<int> &getUnitsHarvestingResourceType(const ResourceType *rt);
+};
+
 // ===============================
 // 	class AI 
 //
@@ -167,6 +223,7 @@ private:
 	RandomGen random;
 	std::map<int,int> factionSwitchTeamRequestCount;
 	int minWarriors;
+	AiBlackboard blackboard;
 
 	bool getAdjacentUnits(std::map<float, std::map<int, const Unit *> > &signalAdjacentUnits, const Unit *unit);
 
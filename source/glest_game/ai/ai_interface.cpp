@@ -61,7 +61,7 @@ void AiInterfaceThread::setQuitStatus(bool value) {
 
 void AiInterfaceThread::signal(int frameIndex) {
 	if(frameIndex >= 0) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
 		this->frameIndex.first = frameIndex;
 		this->frameIndex.second = false;
@@ -73,7 +73,7 @@ void AiInterfaceThread::signal(int frameIndex) {
 
 void AiInterfaceThread::setTaskCompleted(int frameIndex) {
 	if(frameIndex >= 0) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
 		if(this->frameIndex.first == frameIndex) {
 			this->frameIndex.second = true;
@@ -97,7 +97,7 @@ bool AiInterfaceThread::isSignalCompleted(int frameIndex) {
 	if(getRunningStatus() == false) {
 		return true;
 	}
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
 	//bool result = (event != NULL ? event->eventCompleted : true);
 	bool result = (this->frameIndex.first == frameIndex && this->frameIndex.second == true);
@@ -110,7 +110,7 @@ bool AiInterfaceThread::isSignalCompleted(int frameIndex) {
 
 void AiInterfaceThread::signalQuit() {
 	if(this->aiIntf != NULL) {
-		MutexSafeWrapper safeMutex(this->aiIntf->getMutex(),string(__FILE__) + "_" + intToStr(__LINE__));
+		MutexSafeWrapper safeMutex(this->aiIntf->getMutex(),CODE_AT_LINE);
 		this->aiIntf = NULL;
 	}
 
@@ -135,7 +135,7 @@ void AiInterfaceThread::execute() {
 
 			semTaskSignalled.waitTillSignalled();
 
-			static string masterSlaveOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *masterSlaveOwnerId = CODE_AT_LINE;
 			MasterSlaveThreadControllerSafeWrapper safeMasterController(masterController,20000,masterSlaveOwnerId);
 
 			if(getQuitStatus() == true) {
@@ -143,7 +143,7 @@ void AiInterfaceThread::execute() {
 				break;
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
             MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
             bool executeTask = (frameIndex.first >= 0);
 
@@ -154,7 +154,7 @@ void AiInterfaceThread::execute() {
             if(executeTask == true) {
 				ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
 
-				MutexSafeWrapper safeMutex(this->aiIntf->getMutex(),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(this->aiIntf->getMutex(),CODE_AT_LINE);
 
 				this->aiIntf->update();
 
@@ -188,6 +188,7 @@ AiInterface::AiInterface(Game &game, int factionIndex, int teamIndex,
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
 	this->aiMutex = new Mutex(CODE_AT_LINE);
+	this->readyCommandListMutex = new Mutex(CODE_AT_LINE);
 	this->workerThread = NULL;
 	this->world= game.getWorld();
 	this->commander= game.getCommander();
@@ -239,7 +240,7 @@ AiInterface::AiInterface(Game &game, int factionIndex, int teamIndex,
 			}
 			workerThread = NULL;
 		}
-		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		this->workerThread = new AiInterfaceThread(this);
 		this->workerThread->setUniqueID(mutexOwnerId);
 		this->workerThread->start();
@@ -260,6 +261,7 @@ void AiInterface::init() {
     logLevel=0;
     fp=NULL;;
     aiMutex=NULL;
+    readyCommandListMutex=NULL;
     workerThread=NULL;
 }
 
@@ -284,6 +286,8 @@ AiInterface::~AiInterface() {
 
 	delete aiMutex;
 	aiMutex = NULL;
+	delete readyCommandListMutex;
+	readyCommandListMutex = NULL;
 }
 
 void AiInterface::signalWorkerThread(int frameIndex) {
@@ -307,6 +311,17 @@ bool AiInterface::isWorkerThreadSignalCompleted(int frameIndex) {
 void AiInterface::update() {
 	timer++;
 	ai.update();
+
+	if(deferredCommandList.empty() == false) {
+		MutexSafeWrapper safeMutex(readyCommandListMutex,CODE_AT_LINE);
+		readyCommandList.insert(readyCommandList.end(),deferredCommandList.begin(),deferredCommandList.end());
+		deferredCommandList.clear();
+	}
+}
+
+void AiInterface::flushDeferredCommands() {
+	MutexSafeWrapper safeMutex(readyCommandListMutex,CODE_AT_LINE);
+	commander->pushDeferredNetworkCommands(readyCommandList);
 }
 
 // ==================== misc ====================
@@ -319,7 +334,7 @@ void AiInterface::printLog(int logLevel, const string &s){
     if(isLogLevelEnabled(logLevel) == true) {
 		string logString= "(" + intToStr(factionIndex) + ") " + s;
 
-		MutexSafeWrapper safeMutex(aiMutex,string(__FILE__) + "_" + intToStr(__LINE__));
+		MutexSafeWrapper safeMutex(aiMutex,CODE_AT_LINE);
 		//print log to file
 		if(fp != NULL) {
 			fprintf(fp, "%s\n", logString.c_str());
@@ -346,6 +361,12 @@ bool AiInterface::executeCommandOverNetwork() {
 	return faction->getCpuControl(enableServerControlledAI,isNetworkGame,role);
 }
 
+std::vector<NetworkCommand> * AiInterface::getDeferredCommandList() {
+	// Only defer when the AI runs in parallel with other factions, the
+	// inline update already runs in faction index order
+	return (workerThread != NULL ? &deferredCommandList : NULL);
+}
+
 std::pair<CommandResult,string> AiInterface::giveCommandSwitchTeamVote(const Faction* faction, SwitchTeamVote *vote) {
 	assert(this->gameSettings != NULL);
 
@@ -359,7 +380,7 @@ std::pair<CommandResult,string> AiInterface::giveCommand(int unitIndex, CommandC
 	std::pair<CommandResult,string> result(crFailUndefined,"");
 	if(executeCommandOverNetwork() == true) {
 		const Unit *unit = getMyUnit(unitIndex);
-		result = commander->tryGiveCommand(unit, unit->getType()->getFirstCtOfClass(commandClass), pos, unit->getType(),CardinalDir::NORTH);
+		result = commander->tryGiveCommand(unit, unit->getType()->getFirstCtOfClass(commandClass), pos, unit->getType(),CardinalDir::NORTH,false,NULL,-1,getDeferredCommandList());
 		return result;
 	}
 	else {
@@ -410,7 +431,7 @@ std::pair<CommandResult,string> AiInterface::giveCommand(const Unit *unit, const
 
 	if(executeCommandOverNetwork() == true) {
 		result = commander->tryGiveCommand(unit, commandType, pos,
-				unit->getType(),CardinalDir::NORTH, false, NULL,unitGroupCommandId);
+				unit->getType(),CardinalDir::NORTH, false, NULL,unitGroupCommandId,getDeferredCommandList());
 		return result;
 	}
 	else {
@@ -460,7 +481,7 @@ std::pair<CommandResult,string> AiInterface::giveCommand(int unitIndex, const Co
 
 	if(executeCommandOverNetwork() == true) {
 		const Unit *unit = getMyUnit(unitIndex);
-		result = commander->tryGiveCommand(unit, commandType, pos, unit->getType(),CardinalDir::NORTH);
+		result = commander->tryGiveCommand(unit, commandType, pos, unit->getType(),CardinalDir::NORTH,false,NULL,-1,getDeferredCommandList());
 		return result;
 	}
 	else {
@@ -508,7 +529,7 @@ std::pair<CommandResult,string> AiInterface::giveCommand(int unitIndex, const Co
 
 	if(executeCommandOverNetwork() == true) {
 		const Unit *unit = getMyUnit(unitIndex);
-		result = commander->tryGiveCommand(unit, commandType, pos, ut,CardinalDir::NORTH);
+		result = commander->tryGiveCommand(unit, commandType, pos, ut,CardinalDir::NORTH,false,NULL,-1,getDeferredCommandList());
 		return result;
 	}
 	else {
@@ -558,7 +579,7 @@ std::pair<CommandResult,string> AiInterface::giveCommand(int unitIndex, const Co
 		Unit *targetUnit = u;
 		const Unit *unit = getMyUnit(unitIndex);
 
-		result = commander->tryGiveCommand(unit, commandType, Vec2i(0), unit->getType(),CardinalDir::NORTH,false,targetUnit);
+		result = commander->tryGiveCommand(unit, commandType, Vec2i(0), unit->getType(),CardinalDir::NORTH,false,targetUnit,-1,getDeferredCommandList());
 
 		return result;
 	}
@@ -83,6 +83,12 @@ private:
     AiInterfaceThread *workerThread;
     std::vector<Vec2i> enemyWarningPositionList;
 
+    // Commands given while the AI updates in its worker thread are held
+    // here and handed to the commander by the game in faction index order
+    std::vector<NetworkCommand> deferredCommandList;
+    std::vector<NetworkCommand> readyCommandList;
+    Mutex *readyCommandListMutex;
+
 public:
     AiInterface(Game &game, int factionIndex, int teamIndex, int useStartLocation=-1);
     ~AiInterface();
@@ -106,6 +112,7 @@ public:
 
     void signalWorkerThread(int frameIndex);
     bool isWorkerThreadSignalCompleted(int frameIndex);
+    void flushDeferredCommands();
     AiInterfaceThread *getWorkerThread() { return workerThread; }
 
     bool isLogLevelEnabled(int level);
@@ -163,6 +170,7 @@ public:
 private:
 	string getLogFilename() const	{return "ai"+intToStr(factionIndex)+".log";}
 	bool executeCommandOverNetwork();
+	std::vector<NetworkCommand> * getDeferredCommandList();
 
 	void init();
 };
@@ -89,7 +89,7 @@ PathFinder::~PathFinder() {
 
 void PathFinder::clearCaches() {
 	for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		FactionState &faction = factions.getFactionState(factionIndex);
 		MutexSafeWrapper safeMutex(faction.getMutexPreCache(),mutexOwnerId);
 
@@ -101,7 +101,7 @@ void PathFinder::clearCaches() {
 void PathFinder::clearUnitPrecache(Unit *unit) {
 	if(unit != NULL && factions.size() > unit->getFactionIndex()) {
 		int factionIndex = unit->getFactionIndex();
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		FactionState &faction = factions.getFactionState(factionIndex);
 		MutexSafeWrapper safeMutex(faction.getMutexPreCache(),mutexOwnerId);
 
@@ -113,7 +113,7 @@ void PathFinder::clearUnitPrecache(Unit *unit) {
 void PathFinder::removeUnitPrecache(Unit *unit) {
 	if(unit != NULL && factions.size() > unit->getFactionIndex()) {
 		int factionIndex = unit->getFactionIndex();
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		FactionState &faction = factions.getFactionState(factionIndex);
 		MutexSafeWrapper safeMutex(faction.getMutexPreCache(),mutexOwnerId);
 
@@ -133,7 +133,7 @@ TravelState PathFinder::findPath(Unit *unit, const Vec2i &finalPos, bool *wasStu
 
 	int factionIndex = unit->getFactionIndex();
 	FactionState &faction = factions.getFactionState(factionIndex);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutexPrecache(faction.getMutexPreCache(),mutexOwnerId);
 
 	if(map == NULL) {
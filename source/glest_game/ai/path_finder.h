@@ -18,6 +18,7 @@
 #endif
 
 #include "vec.h"
+#include "sim_math.h"
 #include <vector>
 #include <map>
 #include "game_constants.h"
@@ -29,6 +30,7 @@
 
 using std::vector;
 using Shared::Graphics::Vec2i;
+using Shared::Graphics::distSquared;
 
 namespace Glest { namespace Game {
 
@@ -224,8 +226,11 @@ private:
 	}
 
 	Vec2i computeNearestFreePos(const Unit *unit, const Vec2i &targetPos);
+	// Only compared with other heuristics, the squared distance orders
+	// nodes the same as pos.dist(finalPos). It is exact as a float up to
+	// 2^24, so while both offsets stay below 2896 cells
 	inline static float heuristic(const Vec2i &pos, const Vec2i &finalPos) {
-		return pos.dist(finalPos);
+		return static_cast<float>(distSquared(pos, finalPos));
 	}
 
 	inline static bool openPos(const Vec2i &sucPos, FactionState &faction) {
@@ -142,7 +142,8 @@ std::pair<CommandResult,string> Commander::tryGiveCommand(const Selection *selec
 std::pair<CommandResult,string> Commander::tryGiveCommand(const Unit* unit, const CommandType *commandType,
 									const Vec2i &pos, const UnitType* unitType,
 									CardinalDir facing, bool tryQueue,Unit *targetUnit,
-									int unitGroupCommandId) const {
+									int unitGroupCommandId,
+									std::vector<NetworkCommand> *deferredCommandList) const {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	if(this->pauseNetworkCommands == true) {
@@ -169,7 +170,7 @@ std::pair<CommandResult,string> Commander::tryGiveCommand(const Unit* unit, cons
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s] Line: %d took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
-		result = pushNetworkCommand(&networkCommand);
+		result = pushNetworkCommand(&networkCommand,deferredCommandList);
 	}
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s] Line: %d took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
@@ -443,7 +444,8 @@ std::pair<CommandResult,string> Commander::computeResult(const CommandResultCont
 	return std::pair<CommandResult,string>(crSuccess,"");
 }
 
-std::pair<CommandResult,string> Commander::pushNetworkCommand(const NetworkCommand* networkCommand) const {
+std::pair<CommandResult,string> Commander::pushNetworkCommand(const NetworkCommand* networkCommand,
+		std::vector<NetworkCommand> *deferredCommandList) const {
 	GameNetworkInterface *gameNetworkInterface= NetworkManager::getInstance().getGameNetworkInterface();
 	std::pair<CommandResult,string> result(crSuccess,"");
 
@@ -468,8 +470,14 @@ std::pair<CommandResult,string> Commander::pushNetworkCommand(const NetworkComma
 		}
 	}
 
-	//add the command to the interface
-	gameNetworkInterface->requestCommand(networkCommand);
+	//add the command to the interface, commands from AI worker threads are
+	//held back and handed over later in faction index order
+	if(deferredCommandList != NULL) {
+		deferredCommandList->push_back(*networkCommand);
+	}
+	else {
+		gameNetworkInterface->requestCommand(networkCommand);
+	}
 
 	//calculate the result of the command
 	if(unit != NULL && networkCommand->getNetworkCommandType() == nctGiveCommand) {
@@ -481,6 +489,16 @@ std::pair<CommandResult,string> Commander::pushNetworkCommand(const NetworkComma
 	return result;
 }
 
+void Commander::pushDeferredNetworkCommands(std::vector<NetworkCommand> &deferredCommandList) const {
+	if(deferredCommandList.empty() == false) {
+		GameNetworkInterface *gameNetworkInterface= NetworkManager::getInstance().getGameNetworkInterface();
+		for(unsigned int i = 0; i < deferredCommandList.size(); ++i) {
+			gameNetworkInterface->requestCommand(&deferredCommandList[i]);
+		}
+		deferredCommandList.clear();
+	}
+}
+
 void Commander::signalNetworkUpdate(Game *game) {
     updateNetwork(game);
 }
@@ -77,7 +77,7 @@ public:
 										const Vec2i &pos, const UnitType* unitType,
 										CardinalDir facing, bool tryQueue,Unit *targetUnit=NULL) const;
 
-	std::pair<CommandResult,string> tryGiveCommand(const Unit* unit, const CommandType *commandType, const Vec2i &pos, const UnitType* unitType, CardinalDir facing, bool tryQueue = false,Unit *targetUnit=NULL,int unitGroupCommandId=-1) const;
+	std::pair<CommandResult,string> tryGiveCommand(const Unit* unit, const CommandType *commandType, const Vec2i &pos, const UnitType* unitType, CardinalDir facing, bool tryQueue = false,Unit *targetUnit=NULL,int unitGroupCommandId=-1,std::vector<NetworkCommand> *deferredCommandList=NULL) const;
 	std::pair<CommandResult,string> tryGiveCommand(const Selection *selection, CommandClass commandClass, const Vec2i &pos= Vec2i(0), const Unit *targetUnit= NULL, bool tryQueue = false) const;
 	std::pair<CommandResult,string> tryGiveCommand(const Selection *selection, const CommandType *commandType, const Vec2i &pos= Vec2i(0), const Unit *targetUnit= NULL, bool tryQueue = false) const;
 	std::pair<CommandResult,string> tryGiveCommand(const Selection *selection, const Vec2i &pos, const Unit *targetUnit= NULL, bool tryQueue = false, int unitCommandGroupId = -1) const;
@@ -93,9 +93,10 @@ public:
 	void tryNetworkPlayerDisconnected(int factionIndex) const;
 
 	Command* buildCommand(const NetworkCommand* networkCommand) const;
+	void pushDeferredNetworkCommands(std::vector<NetworkCommand> &deferredCommandList) const;
 
 private:
-	std::pair<CommandResult,string> pushNetworkCommand(const NetworkCommand* networkCommand) const;
+	std::pair<CommandResult,string> pushNetworkCommand(const NetworkCommand* networkCommand,std::vector<NetworkCommand> *deferredCommandList=NULL) const;
 	std::pair<CommandResult,string> computeResult(const CommandResultContainer &results) const;
 	void giveNetworkCommand(NetworkCommand* networkCommand) const;
 	bool canSubmitCommandType(const Unit *unit, const CommandType *commandType) const;
@@ -996,7 +996,7 @@ void Game::load() {
 }
 
 void Game::load(int loadTypes) {
-	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+	bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 	Chrono chronoPerf;
 	if(showPerfStats) chronoPerf.start();
 	char perfBuf[8096]="";
@@ -1136,6 +1136,10 @@ void Game::load(int loadTypes) {
     if((loadTypes & lgt_TechTree) == lgt_TechTree) {
     	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
+		// Model textures keep decoding in the background while the rest of
+		// the techtree loads, Renderer::initGame uploads them
+		Renderer::getInstance().setDeferredTextureInit(rsGame, true);
+
 		//tech, load before map because of resources
 		world.loadTech(	config.getPathListForType(ptTechs,scenarioDir), techName,
 						factions, &checksum,loadedFileList);
@@ -1146,6 +1150,10 @@ void Game::load(int loadTypes) {
 
 			throw megaglest_runtime_error(szBuf, true);
 		}
+
+		if(showPerfStats) {
+			perfList.push_back(Renderer::getInstance().getModelLoadStats(rsGame) + "\n");
+		}
     }
 
 	if(showPerfStats) {
@@ -1217,7 +1225,7 @@ void Game::init() {
 }
 
 void Game::init(bool initForPreviewOnly) {
-	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+	bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 	Chrono chronoPerf;
 	if(showPerfStats) chronoPerf.start();
 	char perfBuf[8096]="";
@@ -1397,7 +1405,7 @@ void Game::init(bool initForPreviewOnly) {
 				aiInterfaces[i]= NULL;
 			}
 		}
-		if(Config::getInstance().getBool("EnableNewThreadManager","false") == true) {
+		if(Config::getInstance().getSnapshot().enableNewThreadManager == true) {
 			masterController.setSlaves(slaveThreadList);
 		}
 
@@ -1781,7 +1789,7 @@ void Game::update() {
 			currentUIState->update();
 		}
 
-		bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+		bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 		Chrono chronoPerf;
 		char perfBuf[8096]="";
 		std::vector<string> perfList;
@@ -2036,7 +2044,7 @@ void Game::update() {
 
 						addPerformanceCount("CalculateNetworkCRCSynchChecks",chronoGamePerformanceCounts.getMillis());
 
-						const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
+						const bool newThreadManager = Config::getInstance().getSnapshot().enableNewThreadManager;
 						if(newThreadManager == true) {
 							int currentFrameCount = world.getFrameCount();
 							masterController.signalSlaves(&currentFrameCount);
@@ -2101,6 +2109,14 @@ void Game::update() {
 							addPerformanceCount("ProcessAIWorkerThreads",chronoGamePerformanceCounts.getMillis());
 						}
 
+						// Hand over commands the AI worker threads queued this frame in
+						// faction index order so every peer sees the same sequence
+						for(int j = 0; j < (int)aiInterfaces.size(); ++j) {
+							if(aiInterfaces[j] != NULL) {
+								aiInterfaces[j]->flushDeferredCommands();
+							}
+						}
+
 						if(showPerfStats) {
 							sprintf(perfBuf,"In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chronoPerf.getMillis());
 							perfList.push_back(perfBuf);
@@ -2810,9 +2826,9 @@ string Game::getGamePerformanceCounts(bool displayWarnings) const {
 	}
 
 	bool displayWarningHeader 	= true;
-	bool WARN_TO_CONSOLE 		= Config::getInstance().getBool("PerformanceWarningEnabled","false");
-	int WARNING_MILLIS 			= Config::getInstance().getInt("PerformanceWarningMillis","7");
-	int WARNING_RENDER_MILLIS 	= Config::getInstance().getInt("PerformanceWarningRenderMillis","40");
+	bool WARN_TO_CONSOLE 		= Config::getInstance().getSnapshot().performanceWarningEnabled;
+	int WARNING_MILLIS 			= Config::getInstance().getSnapshot().performanceWarningMillis;
+	int WARNING_RENDER_MILLIS 	= Config::getInstance().getSnapshot().performanceWarningRenderMillis;
 
 	string result = "";
 	for(std::map<string,int64>::const_iterator iterMap = gamePerformanceCounts.begin();
@@ -3174,7 +3190,7 @@ void Game::ReplaceDisconnectedNetworkPlayersWithAI(bool isNetworkGame, NetworkRo
 			}
 		}
 
-		if(newAIPlayerCreated == true && Config::getInstance().getBool("EnableNewThreadManager","false") == true) {
+		if(newAIPlayerCreated == true && Config::getInstance().getSnapshot().enableNewThreadManager == true) {
 			bool enableServerControlledAI 	= this->gameSettings.getEnableServerControlledAI();
 
 			masterController.clearSlaves(true);
@@ -4447,7 +4463,7 @@ void Game::mouseMove(int x, int y, const MouseState *ms) {
 					}
 				}
 				else {
-					bool mouseMoveScrollsWorld = Config::getInstance().getBool("MouseMoveScrollsWorld","true");
+					bool mouseMoveScrollsWorld = Config::getInstance().getSnapshot().mouseMoveScrollsWorld;
 					if(mouseMoveScrollsWorld == true) {
 						if (y < 10) {
 							gameCamera.setMoveZ(-scrollSpeed);
@@ -5370,8 +5386,9 @@ string Game::getDebugStats(std::map<int,string> &factionDebugInfo) {
 	str+= "UnitRangeCellsLookupItemCache: " + world.getUnitUpdater()->getUnitRangeCellsLookupItemCacheStats()+"\n";
 	str+= "ExploredCellsLookupItemCache: " 	+ world.getExploredCellsLookupItemCacheStats()+"\n";
 	str+= "FowAlphaCellsLookupItemCache: "  + world.getFowAlphaCellsLookupItemCacheStats()+"\n";
+	str+= "UnitMemory: "  + world.getUnitMemoryStats()+"\n";
 
-	const string selectionType = toLower(Config::getInstance().getString("SelectionType",Config::colorPicking));
+	const string selectionType = toLower(Config::getInstance().getSnapshot().selectionType);
 	str += "Selection type: " + toLower(selectionType) + "\n";
 
 	if(selectionType == Config::colorPicking) {
@@ -232,7 +232,7 @@ public:
     bool isUnMarkCellMode() const { return isUnMarkCellEnabled; }
     const Texture2D * getUnMarkCellTexture() const { return unmarkCellTexture; }
 
-    std::map<Vec2i, MarkedCell> getMapMarkedCellList() const { return mapMarkedCellList; }
+    const std::map<Vec2i, MarkedCell> &getMapMarkedCellList() const { return mapMarkedCellList; }
 
     const Texture2D * getHighlightCellTexture() const { return highlightCellTexture; }
     const std::vector<MarkedCell> * getHighlightedCells() const { return &highlightedCells; }
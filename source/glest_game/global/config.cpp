@@ -19,6 +19,8 @@
 #include "conversion.h"
 #include "window.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include "leak_dumper.h"
 
@@ -95,6 +97,35 @@ const char *Config::ACTIVE_MOD_PROPERTY_NAME			= "current_mod_name";
 
 map<string,string> Config::customRuntimeProperties;
 
+// =====================================================
+// 	class ConfigSnapshot
+// =====================================================
+
+// Convert a default value the way the matching Config getter
+// converts a stored one
+static bool getSnapshotDefaultBool(const char *value)		{ return strToBool(value); }
+static int getSnapshotDefaultInt(const char *value)			{ return strToInt(value); }
+static string getSnapshotDefaultString(const char *value)	{ return value; }
+
+ConfigSnapshot::ConfigSnapshot() {
+#define CONFIG_SNAPSHOT_DEFAULT(getter, type, field, key, defaultValue) field = getSnapshotDefault##getter(defaultValue);
+	CONFIG_SNAPSHOT_SETTINGS(CONFIG_SNAPSHOT_DEFAULT)
+#undef CONFIG_SNAPSHOT_DEFAULT
+}
+
+void ConfigSnapshot::refresh(const Config &config) {
+#define CONFIG_SNAPSHOT_REFRESH(getter, type, field, key, defaultValue) field = config.get##getter(key, defaultValue);
+	CONFIG_SNAPSHOT_SETTINGS(CONFIG_SNAPSHOT_REFRESH)
+#undef CONFIG_SNAPSHOT_REFRESH
+}
+
+bool ConfigSnapshot::isSnapshotKey(const string &key) {
+#define CONFIG_SNAPSHOT_KEY(getter, type, field, keyName, defaultValue) if(key == keyName) return true;
+	CONFIG_SNAPSHOT_SETTINGS(CONFIG_SNAPSHOT_KEY)
+#undef CONFIG_SNAPSHOT_KEY
+	return false;
+}
+
 // =====================================================
 // 	class Config
 // =====================================================
@@ -299,6 +330,8 @@ Config::Config(std::pair<ConfigType,ConfigType> type, std::pair<string,string> f
     	SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
     	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] ERROR trying to auto-create cfgFile.second = [%s]\n",__FILE__,__FUNCTION__,__LINE__,fileName.second.c_str());
     }
+
+    snapshot.refresh(*this);
 }
 
 Config &Config::getInstance(std::pair<ConfigType,ConfigType> type, std::pair<string,string> file, std::pair<bool,bool> fileMustExist, string custom_path) {
@@ -324,6 +357,27 @@ void Config::CopyAll(Config *src, Config *dest) {
 	dest->fileName		= src->fileName;
 	dest->fileNameParameter = src->fileNameParameter;
 	dest->fileLoaded	= src->fileLoaded;
+	dest->notifyChanged();
+}
+
+void Config::notifyChanged() {
+	snapshot.refresh(*this);
+	for(unsigned int i = 0; i < changeListeners.size(); ++i) {
+		changeListeners[i]->configChanged(*this);
+	}
+}
+
+void Config::addChangeListener(ConfigChangeListener *listener) {
+	if(std::find(changeListeners.begin(),changeListeners.end(),listener) == changeListeners.end()) {
+		changeListeners.push_back(listener);
+	}
+}
+
+void Config::removeChangeListener(ConfigChangeListener *listener) {
+	vector<ConfigChangeListener *>::iterator iterFind = std::find(changeListeners.begin(),changeListeners.end(),listener);
+	if(iterFind != changeListeners.end()) {
+		changeListeners.erase(iterFind);
+	}
 }
 
 void Config::reload() {
@@ -592,55 +646,53 @@ SDLKey Config::getSDLKey(const char *key) const {
 void Config::setInt(const string &key, int value, bool tempBuffer) {
 	if(tempBuffer == true) {
 		tempProperties.setInt(key, value);
-		return;
 	}
-	if(fileLoaded.second == true) {
+	else if(fileLoaded.second == true) {
 		properties.second.setInt(key, value);
-		return;
 	}
-	properties.first.setInt(key, value);
+	else {
+		properties.first.setInt(key, value);
+	}
+	notifyChanged();
 }
 
 void Config::setBool(const string &key, bool value, bool tempBuffer) {
 	if(tempBuffer == true) {
 		tempProperties.setBool(key, value);
-		return;
 	}
-
-	if(fileLoaded.second == true) {
+	else if(fileLoaded.second == true) {
 		properties.second.setBool(key, value);
-		return;
 	}
-
-	properties.first.setBool(key, value);
+	else {
+		properties.first.setBool(key, value);
+	}
+	notifyChanged();
 }
 
 void Config::setFloat(const string &key, float value, bool tempBuffer) {
 	if(tempBuffer == true) {
 		tempProperties.setFloat(key, value);
-		return;
 	}
-
-	if(fileLoaded.second == true) {
+	else if(fileLoaded.second == true) {
 		properties.second.setFloat(key, value);
-		return;
 	}
-
-	properties.first.setFloat(key, value);
+	else {
+		properties.first.setFloat(key, value);
+	}
+	notifyChanged();
 }
 
 void Config::setString(const string &key, const string &value, bool tempBuffer) {
 	if(tempBuffer == true) {
 		tempProperties.setString(key, value);
-		return;
 	}
-
-	if(fileLoaded.second == true) {
+	else if(fileLoaded.second == true) {
 		properties.second.setString(key, value);
-		return;
 	}
-
-	properties.first.setString(key, value);
+	else {
+		properties.first.setString(key, value);
+	}
+	notifyChanged();
 }
 
 vector<pair<string,string> > Config::getPropertiesFromContainer(const Properties &propertiesObj) const {
@@ -695,6 +747,52 @@ void Config::setUserProperties(const vector<pair<string,string> > &valueList) {
 		const pair<string,string> &nameValuePair = valueList[idx];
 		propertiesObj.setString(nameValuePair.first,nameValuePair.second);
 	}
+	notifyChanged();
+}
+
+static int getKeyEditDistance(const string &left, const string &right) {
+	vector<int> previous(right.size() + 1);
+	vector<int> current(right.size() + 1);
+	for(unsigned int j = 0; j <= right.size(); ++j) {
+		previous[j] = j;
+	}
+	for(unsigned int i = 1; i <= left.size(); ++i) {
+		current[0] = i;
+		for(unsigned int j = 1; j <= right.size(); ++j) {
+			int cost = (tolower(left[i-1]) == tolower(right[j-1]) ? 0 : 1);
+			current[j] = min(min(previous[j] + 1, current[j-1] + 1), previous[j-1] + cost);
+		}
+		previous.swap(current);
+	}
+	return previous[right.size()];
+}
+
+vector<pair<string,string> > Config::getUnknownUserKeys() const {
+	const int maxMisspelledDistance = 2;
+	vector<pair<string,string> > result;
+	if(fileLoaded.second == false) {
+		return result;
+	}
+
+	for(int i = 0; i < properties.second.getPropertyCount(); ++i) {
+		string key = properties.second.getKey(i);
+		if(properties.first.hasString(key) == true || ConfigSnapshot::isSnapshotKey(key) == true) {
+			continue;
+		}
+
+		string closestKey = "";
+		int closestDistance = maxMisspelledDistance + 1;
+		for(int j = 0; j < properties.first.getPropertyCount(); ++j) {
+			string knownKey = properties.first.getKey(j);
+			int distance = getKeyEditDistance(key, knownKey);
+			if(distance < closestDistance) {
+				closestDistance = distance;
+				closestKey = knownKey;
+			}
+		}
+		result.push_back(make_pair(key,closestKey));
+	}
+	return result;
 }
 
 string Config::getFileName(bool userFilename) const {
@@ -33,6 +33,63 @@ using Shared::Util::Properties;
 //	Game configuration
 // =====================================================
 
+class Config;
+
+// =====================================================
+// 	class ConfigSnapshot
+//
+//	Typed copy of the settings read per frame or per unit,
+//	so hot code reads plain fields instead of looking up
+//	string keys in up to three property maps
+// =====================================================
+
+// Getter type, field type, field, key, default value
+#define CONFIG_SNAPSHOT_SETTINGS(SETTING) \
+	SETTING(Bool,	bool,	showPerfStats,					"ShowPerfStats",					"false") \
+	SETTING(Bool,	bool,	enableNewThreadManager,			"EnableNewThreadManager",			"false") \
+	SETTING(Bool,	bool,	unitParticles,					"UnitParticles",					"true") \
+	SETTING(Bool,	bool,	tilesetParticles,				"TilesetParticles",					"true") \
+	SETTING(Bool,	bool,	disableWaterSounds,				"DisableWaterSounds",				"false") \
+	SETTING(Bool,	bool,	enableFrustumCache,				"EnableFrustrumCache",				"false") \
+	SETTING(Bool,	bool,	batchUnitRendering,				"BatchUnitRendering",				"true") \
+	SETTING(Bool,	bool,	debugGameSynchUI,				"DebugGameSynchUI",					"false") \
+	SETTING(Bool,	bool,	recordMode,						"RecordMode",						"false") \
+	SETTING(Bool,	bool,	photoMode,						"PhotoMode",						"false") \
+	SETTING(Bool,	bool,	inGameClock,					"InGameClock",						"true") \
+	SETTING(Bool,	bool,	inGameLocalClock,				"InGameLocalClock",					"true") \
+	SETTING(Bool,	bool,	inGameFrameCounter,				"InGameFrameCounter",				"false") \
+	SETTING(Bool,	bool,	twoLineTeamResourceRendering,	"TwoLineTeamResourceRendering",		"false") \
+	SETTING(Bool,	bool,	mouseMoveScrollsWorld,			"MouseMoveScrollsWorld",			"true") \
+	SETTING(Bool,	bool,	performanceWarningEnabled,		"PerformanceWarningEnabled",		"false") \
+	SETTING(Int,	int,	performanceWarningMillis,		"PerformanceWarningMillis",			"7") \
+	SETTING(Int,	int,	performanceWarningRenderMillis,	"PerformanceWarningRenderMillis",	"40") \
+	SETTING(Int,	int,	animatedTilesetObjects,			"AnimatedTilesetObjects",			"-1") \
+	SETTING(String,	string,	selectionType,					"SelectionType",					Config::colorPicking)
+
+class ConfigSnapshot {
+public:
+#define CONFIG_SNAPSHOT_FIELD(getter, type, field, key, defaultValue) type field;
+	CONFIG_SNAPSHOT_SETTINGS(CONFIG_SNAPSHOT_FIELD)
+#undef CONFIG_SNAPSHOT_FIELD
+
+	ConfigSnapshot();
+	void refresh(const Config &config);
+
+	static bool isSnapshotKey(const string &key);
+};
+
+// =====================================================
+// 	class ConfigChangeListener
+//
+//	Notified after any setting of a Config changes
+// =====================================================
+
+class ConfigChangeListener {
+public:
+	virtual ~ConfigChangeListener() {}
+	virtual void configChanged(const Config &config) = 0;
+};
+
 enum ConfigType {
     cfgMainGame,
     cfgUserGame,
@@ -52,6 +109,9 @@ private:
 	std::pair<string,string> fileName;
 	std::pair<bool,bool> fileLoaded;
 
+	ConfigSnapshot snapshot;
+	vector<ConfigChangeListener *> changeListeners;
+
 	static map<ConfigType,Config> configList;
 
     static const char *glest_ini_filename;
@@ -78,6 +138,7 @@ protected:
 	static void CopyAll(Config *src,Config *dest);
 	vector<pair<string,string> > getPropertiesFromContainer(const Properties &propertiesObj) const;
 	static bool replaceFileWithLocalFile(const vector<string> &dirList, string fileNamePart, string &resultToReplace);
+	void notifyChanged();
 
 public:
 
@@ -104,6 +165,14 @@ public:
 	void setFloat(const string &key, float value, bool tempBuffer=false);
 	void setString(const string &key, const string &value, bool tempBuffer=false);
 
+	const ConfigSnapshot & getSnapshot() const { return snapshot; }
+	void addChangeListener(ConfigChangeListener *listener);
+	void removeChangeListener(ConfigChangeListener *listener);
+
+	// User settings that are neither in the master file nor read by the
+	// snapshot, paired with the closest known key if it looks misspelled
+	vector<pair<string,string> > getUnknownUserKeys() const;
+
     vector<string> getPathListForType(PathType type, string scenarioDir = "");
 
     vector<pair<string,string> > getMergedProperties() const;
@@ -115,6 +115,15 @@ CoreData::~CoreData() {
 void CoreData::cleanup() {
 	deleteValues(waterSounds.getSoundsPtr()->begin(), waterSounds.getSoundsPtr()->end());
 	waterSounds.getSoundsPtr()->clear();
+
+	// The samples belong to the sound cache, give them back while it
+	// still exists rather than from this object's static destructor
+	clickSoundA.close();
+	clickSoundB.close();
+	clickSoundC.close();
+	attentionSound.close();
+	highlightSound.close();
+	markerSound.close();
 }
 
 Texture2D *CoreData::getTextureBySystemId(TextureSystemType type) {
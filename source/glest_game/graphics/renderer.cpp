@@ -199,6 +199,9 @@ Renderer::Renderer() : BaseRenderer(), saveScreenShotThreadAccessor(new Mutex(CO
 
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	objectVisibilityIndex.clear();
+	unitVisibilityGrid.clear();
+	unitVisibilityGridUnits.clear();
 
 	lastRenderFps=MIN_FPS_NORMAL_RENDERING;
 	shadowsOffDueToMinRender=false;
@@ -250,14 +253,16 @@ Renderer::Renderer() : BaseRenderer(), saveScreenShotThreadAccessor(new Mutex(CO
 		if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
 			modelManager[i]= graphicsFactory->newModelManager();
 			textureManager[i]= graphicsFactory->newTextureManager();
+			textureManager[i]->setShareTextures(true);
 			modelManager[i]->setTextureManager(textureManager[i]);
+			modelManager[i]->setShareModels(true);
 			fontManager[i]= graphicsFactory->newFontManager();
 		}
 		particleManager[i]= graphicsFactory->newParticleManager();
 	}
 
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
-		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		saveScreenShotThread = new SimpleTaskThread(this,0,25);
 		saveScreenShotThread->setUniqueID(mutexOwnerId);
 		saveScreenShotThread->start();
@@ -286,7 +291,7 @@ void Renderer::cleanupScreenshotThread() {
 		if(getSaveScreenQueueSize() > 0) {
 			if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line %d] FORCING MEMORY CLEANUP and NOT SAVING screenshots, saveScreenQueue.size() = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,saveScreenQueue.size());
 
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor,mutexOwnerId);
 			for(std::list<std::pair<string,Pixmap2D *> >::iterator iter = saveScreenQueue.begin();
 				iter != saveScreenQueue.end(); ++iter) {
@@ -334,6 +339,9 @@ Renderer::~Renderer() {
 		mapSurfaceData.clear();
 		quadCache = VisibleQuadContainerCache();
 		quadCache.clearFrustumData();
+		objectVisibilityIndex.clear();
+		unitVisibilityGrid.clear();
+		unitVisibilityGridUnits.clear();
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
@@ -358,7 +366,7 @@ void Renderer::simpleTask(BaseThread *callingThread,void *userdata) {
 	// This code reads pixmaps from a queue and saves them to disk
 	Pixmap2D *savePixMapBuffer=NULL;
 	string path="";
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor,mutexOwnerId);
 	if(saveScreenQueue.empty() == false) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line %d] saveScreenQueue.size() = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,saveScreenQueue.size());
@@ -484,6 +492,9 @@ void Renderer::initGame(const Game *game, GameCamera *gameCamera) {
 	VisibleQuadContainerCache::enableFrustumCalcs = Config::getInstance().getBool("EnableFrustrumCalcs","true");
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	objectVisibilityIndex.clear();
+	unitVisibilityGrid.clear();
+	unitVisibilityGridUnits.clear();
 
 	SurfaceData::nextUniqueId = 1;
 	mapSurfaceData.clear();
@@ -560,6 +571,7 @@ void Renderer::initGame(const Game *game, GameCamera *gameCamera) {
 
 	//texture init
 	modelManager[rsGame]->init();
+	textureManager[rsGame]->setDeferredInit(false);
 	textureManager[rsGame]->init();
 	fontManager[rsGame]->init();
 
@@ -691,6 +703,9 @@ void Renderer::reset3dMenu() {
 void Renderer::end() {
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	objectVisibilityIndex.clear();
+	unitVisibilityGrid.clear();
+	unitVisibilityGridUnits.clear();
 
 	if(Renderer::rendererEnded == true) {
 		return;
@@ -731,6 +746,9 @@ void Renderer::endScenario() {
 	this->gameCamera = NULL;
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	objectVisibilityIndex.clear();
+	unitVisibilityGrid.clear();
+	unitVisibilityGridUnits.clear();
 
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return;
@@ -766,6 +784,9 @@ void Renderer::endGame(bool isFinalEnd) {
 	try {
 		quadCache = VisibleQuadContainerCache();
 		quadCache.clearFrustumData();
+		objectVisibilityIndex.clear();
+		unitVisibilityGrid.clear();
+		unitVisibilityGridUnits.clear();
 	}
 	catch(const exception &e) {
 		char szBuf[8096]="";
@@ -907,6 +928,26 @@ Model *Renderer::newModel(ResourceScope rs,const string &path,bool deletePixMapA
 	return modelManager[rs]->newModel(path,deletePixMapAfterLoad,loadedFileList,sourceLoader);
 }
 
+void Renderer::setDeferredTextureInit(ResourceScope rs, bool value) {
+	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+		return;
+	}
+
+	textureManager[rs]->setDeferredInit(value);
+}
+
+string Renderer::getModelLoadStats(ResourceScope rs) const {
+	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+		return "";
+	}
+
+	const ModelManager *manager = modelManager[rs];
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"Loaded %u models (%u from the model cache, %u shared) in " MG_I64_SPECIFIER " msecs",
+			manager->getLoadCount(),manager->getCachedCount(),manager->getSharedCount(),manager->getLoadMicros() / 1000);
+	return szBuf;
+}
+
 void Renderer::endModel(ResourceScope rs, Model *model,bool mustExistInList) {
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return;
@@ -1227,7 +1268,7 @@ bool Renderer::ExtractFrustum(VisibleQuadContainerCache &quadCacheItem) {
 //   }
 
    // Check the frustum cache
-   const bool useFrustumCache = Config::getInstance().getBool("EnableFrustrumCache","false");
+   const bool useFrustumCache = Config::getInstance().getSnapshot().enableFrustumCache;
    pair<vector<float>,vector<float> > lookupKey;
    if(useFrustumCache == true) {
 	   lookupKey = make_pair(proj,modl);
@@ -1433,28 +1474,7 @@ bool Renderer::SphereInFrustum(vector<vector<float> > &frustum,  float x, float
 }
 
 bool Renderer::CubeInFrustum(vector<vector<float> > &frustum, float x, float y, float z, float size ) {
-   unsigned int p=0;
-
-   for( p = 0; p < frustum.size(); p++ ) {
-      if( frustum[p][0] * (x - size) + frustum[p][1] * (y - size) + frustum[p][2] * (z - size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x + size) + frustum[p][1] * (y - size) + frustum[p][2] * (z - size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x - size) + frustum[p][1] * (y + size) + frustum[p][2] * (z - size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x + size) + frustum[p][1] * (y + size) + frustum[p][2] * (z - size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x - size) + frustum[p][1] * (y - size) + frustum[p][2] * (z + size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x + size) + frustum[p][1] * (y - size) + frustum[p][2] * (z + size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x - size) + frustum[p][1] * (y + size) + frustum[p][2] * (z + size) + frustum[p][3] > 0 )
-         continue;
-      if( frustum[p][0] * (x + size) + frustum[p][1] * (y + size) + frustum[p][2] * (z + size) + frustum[p][3] > 0 )
-         continue;
-      return false;
-   }
-   return true;
+   return FrustumCulling::cubeInFrustum(frustum, x, y, z, size);
 }
 
 void Renderer::computeVisibleQuad() {
@@ -1744,7 +1764,7 @@ void Renderer::renderMouse3d() {
 	}
 
 	Config &config= Config::getInstance();
-	if(config.getBool("RecordMode","false") == true) {
+	if(config.getSnapshot().recordMode == true) {
 		return;
 	}
 
@@ -2307,9 +2327,9 @@ void Renderer::renderClock() {
 	}
 
 	Config &config= Config::getInstance();
-	if(config.getBool("InGameClock","true") == false &&
-		config.getBool("InGameLocalClock","true") == false &&
-		config.getBool("InGameFrameCounter","false") == false) {
+	if(config.getSnapshot().inGameClock == false &&
+		config.getSnapshot().inGameLocalClock == false &&
+		config.getSnapshot().inGameFrameCounter == false) {
 		return;
 	}
 
@@ -2318,7 +2338,7 @@ void Renderer::renderClock() {
 	const World *world = game->getWorld();
 	const Vec4f fontColor = game->getGui()->getDisplay()->getColor();
 
-	if(config.getBool("InGameClock","true") == true) {
+	if(config.getSnapshot().inGameClock == true) {
 		Lang &lang= Lang::getInstance();
 		char szBuf[501]="";
 
@@ -2333,7 +2353,7 @@ void Renderer::renderClock() {
 		str += szBuf;
 	}
 
-	if(config.getBool("InGameLocalClock","true") == true) {
+	if(config.getSnapshot().inGameLocalClock == true) {
 		time_t nowTime = time(NULL);
 		struct tm *loctime = localtime(&nowTime);
 		char szBuf2[100]="";
@@ -2348,7 +2368,7 @@ void Renderer::renderClock() {
 		str += szBuf;
 	}
 
-	if(config.getBool("InGameFrameCounter","false") == true) {
+	if(config.getSnapshot().inGameFrameCounter == true) {
 		char szBuf[200]="";
 		snprintf(szBuf,200,"Frame: %d",game->getWorld()->getFrameCount() / 20);
 		if(str != "") {
@@ -2406,7 +2426,7 @@ void Renderer::renderResourceStatus() {
 	bool renderSharedTeamUnits=false;
 	bool renderLocalFactionResources=false;
 
-	if(config.getBool("TwoLineTeamResourceRendering","false") == true) {
+	if(config.getSnapshot().twoLineTeamResourceRendering == true) {
 		if( sharedTeamResources == true || sharedTeamUnits == true){
 			twoRessourceLines=true;
 		}
@@ -2644,7 +2664,7 @@ void Renderer::renderSelectionQuad() {
 	}
 
 	Config &config= Config::getInstance();
-	if(config.getBool("RecordMode","false") == true) {
+	if(config.getSnapshot().recordMode == true) {
 		return;
 	}
 
@@ -4846,7 +4866,7 @@ void Renderer::renderObjects(const int renderFps) {
 	//const Map *map= world->getMap();
 
 	Config &config= Config::getInstance();
-	int tilesetObjectsToAnimate=config.getInt("AnimatedTilesetObjects","-1");
+	int tilesetObjectsToAnimate=config.getSnapshot().animatedTilesetObjects;
 
     assertGl();
 
@@ -5275,6 +5295,7 @@ void Renderer::renderUnits(bool airUnits, const int renderFps) {
 
 	VisibleQuadContainerCache &qCache = getQuadCache();
 	if(qCache.visibleQuadUnitList.empty() == false) {
+		const bool batchUnits = Config::getInstance().getSnapshot().batchUnitRendering;
 		bool modelRenderStarted = false;
 		for(int visibleUnitIndex = 0;
 				visibleUnitIndex < (int)qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
@@ -5307,50 +5328,61 @@ void Renderer::renderUnits(bool airUnits, const int renderFps) {
 				modelRenderer->begin(true, true, true, false, &meshCallbackTeamColor);
 			}
 
-			glMatrixMode(GL_MODELVIEW);
-			glPushMatrix();
-
-			//translate
 			Vec3f currVec= unit->getCurrVectorFlat();
-			glTranslatef(currVec.x, currVec.y, currVec.z);
-
-			//rotate
 			float zrot=unit->getRotationZ();
 			float xrot=unit->getRotationX();
-			if(zrot!=.0f){
-				glRotatef(zrot, 0.f, 0.f, 1.f);
-			}
-			if(xrot!=.0f){
-				glRotatef(xrot, 1.f, 0.f, 0.f);
-			}
-			glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
 
 			//dead alpha
 			const SkillType *st= unit->getCurrSkill();
-			if(st->getClass() == scDie && static_cast<const DieSkillType*>(st)->getFade()) {
-				float alpha= 1.0f - unit->getAnimProgressAsFloat();
-				glDisable(GL_COLOR_MATERIAL);
-				glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, alpha).ptr());
+			bool fade= (st->getClass() == scDie && static_cast<const DieSkillType*>(st)->getFade());
+			float alpha= (fade == true ? 1.0f - unit->getAnimProgressAsFloat() : 1.0f);
+
+			Model *model= unit->getCurrentModelPtr();
+			if(batchUnits == true) {
+				unitDrawList.addInstance(model, unit->getFaction()->getTexture(), currVec,
+						zrot, xrot, unit->getRotation(), unit->getAnimProgressAsFloat(),
+						unit->isAlive() && !unit->isAnimProgressBound(), alpha);
 			}
 			else {
-				glEnable(GL_COLOR_MATERIAL);
-				// we cut off a tiny bit here to avoid problems with fully transparent texture parts cutting units in background rendered later.
-				glAlphaFunc(GL_GREATER, 0.02f);
-			}
+				glMatrixMode(GL_MODELVIEW);
+				glPushMatrix();
 
-			//render
-			Model *model= unit->getCurrentModelPtr();
-			//printf("Rendering model [%d - %s]\n[%s]\nCamera [%s]\nDistance: %f\n",unit->getId(),unit->getType()->getName().c_str(),unit->getCurrVector().getString().c_str(),this->gameCamera->getPos().getString().c_str(),this->gameCamera->getPos().dist(unit->getCurrVector()));
+				//translate
+				glTranslatef(currVec.x, currVec.y, currVec.z);
 
-			//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
-				model->updateInterpolationData(unit->getAnimProgressAsFloat(), unit->isAlive() && !unit->isAnimProgressBound());
-			//}
+				//rotate
+				if(zrot!=.0f){
+					glRotatef(zrot, 0.f, 0.f, 1.f);
+				}
+				if(xrot!=.0f){
+					glRotatef(xrot, 1.f, 0.f, 0.f);
+				}
+				glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
 
-			modelRenderer->render(model);
+				if(fade == true) {
+					glDisable(GL_COLOR_MATERIAL);
+					glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, alpha).ptr());
+				}
+				else {
+					glEnable(GL_COLOR_MATERIAL);
+					// we cut off a tiny bit here to avoid problems with fully transparent texture parts cutting units in background rendered later.
+					glAlphaFunc(GL_GREATER, 0.02f);
+				}
+
+				//render
+				//printf("Rendering model [%d - %s]\n[%s]\nCamera [%s]\nDistance: %f\n",unit->getId(),unit->getType()->getName().c_str(),unit->getCurrVector().getString().c_str(),this->gameCamera->getPos().getString().c_str(),this->gameCamera->getPos().dist(unit->getCurrVector()));
+
+				//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
+					model->updateInterpolationData(unit->getAnimProgressAsFloat(), unit->isAlive() && !unit->isAnimProgressBound());
+				//}
+
+				modelRenderer->render(model);
+
+				glPopMatrix();
+			}
 			triangleCount+= model->getTriangleCount();
 			pointCount+= model->getVertexCount();
 
-			glPopMatrix();
 			unit->setVisible(true);
 
 			if(	showDebugUI == true &&
@@ -5363,6 +5395,14 @@ void Renderer::renderUnits(bool airUnits, const int renderFps) {
 		}
 
 		if(modelRenderStarted == true) {
+			if(batchUnits == true) {
+				// Units sharing a mesh and team colour are drawn together
+				glEnable(GL_COLOR_MATERIAL);
+				glAlphaFunc(GL_GREATER, 0.02f);
+				unitDrawList.build();
+				modelRenderer->renderDrawList(unitDrawList);
+				unitDrawList.clear();
+			}
 			modelRenderer->end();
 			glPopAttrib();
 		}
@@ -5513,7 +5553,7 @@ void Renderer::renderSelectionEffects(int healthbarMode) {
 	}
 
 	Config &config= Config::getInstance();
-	if(config.getBool("RecordMode","false") == true) {
+	if(config.getSnapshot().recordMode == true) {
 		return;
 	}
 
@@ -5747,11 +5787,11 @@ void Renderer::renderHealthBars(int healthbarMode){
 	}
 
 	Config &config= Config::getInstance();
-	if(config.getBool("RecordMode","false") == true) {
+	if(config.getSnapshot().recordMode == true) {
 		return;
 	}
 
-	if(config.getBool("PhotoMode")) {
+	if(config.getSnapshot().photoMode) {
 		return;
 	}
 
@@ -6193,7 +6233,7 @@ void Renderer::renderMinimap(){
 	VisibleQuadContainerCache &qCache = getQuadCache();
 	std::vector<Unit *> visibleUnitList = qCache.visibleUnitList;
 
-	const bool showAllUnitsInMinimap = Config::getInstance().getBool("DebugGameSynchUI","false");
+	const bool showAllUnitsInMinimap = Config::getInstance().getSnapshot().debugGameSynchUI;
 	if(showAllUnitsInMinimap == true) {
 		visibleUnitList.clear();
 
@@ -7008,7 +7048,7 @@ Vec3f Renderer::computeScreenPosition(const Vec3f &worldPos) {
 void Renderer::computeSelected(	Selection::UnitContainer &units, const Object *&obj,
 								const bool withObjectSelection,
 								const Vec2i &posDown, const Vec2i &posUp) {
-	const string selectionType=toLower(Config::getInstance().getString("SelectionType",Config::colorPicking));
+	const string selectionType=toLower(Config::getInstance().getSnapshot().selectionType);
 
 	if(selectionType==Config::colorPicking) {
 		selectUsingColorPicking(units,obj, withObjectSelection,posDown, posUp);
@@ -7688,7 +7728,7 @@ void Renderer::saveScreen(const string &path,int w, int h) {
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 	// Signal the threads queue to add a screenshot save request
-	MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor,CODE_AT_LINE);
 	saveScreenQueue.push_back(make_pair(path,pixmapScreenShot));
 	safeMutex.ReleaseLock();
 
@@ -7696,7 +7736,7 @@ void Renderer::saveScreen(const string &path,int w, int h) {
 }
 
 unsigned int Renderer::getSaveScreenQueueSize() {
-	MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(saveScreenShotThreadAccessor,CODE_AT_LINE);
 	int queueSize = (int)saveScreenQueue.size();
 	safeMutex.ReleaseLock();
 
@@ -8667,7 +8707,7 @@ void Renderer::renderArrow(const Vec3f &pos1, const Vec3f &pos2,
 	}
 
 	Config &config= Config::getInstance();
-	if(config.getBool("RecordMode","false") == true) {
+	if(config.getSnapshot().recordMode == true) {
 		return;
 	}
 
@@ -9090,6 +9130,13 @@ void Renderer::removeUnitFromQuadCache(const Unit *unit) {
 			break;
 		}
 	}
+
+	int itemIndex = unit->getVisibilityGridItem();
+	if(itemIndex >= 0 && itemIndex < (int)unitVisibilityGridUnits.size() &&
+		unitVisibilityGridUnits[itemIndex] == unit) {
+		unitVisibilityGrid.removeItem(itemIndex);
+		unitVisibilityGridUnits[itemIndex] = NULL;
+	}
 }
 
 VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
@@ -9113,6 +9160,22 @@ VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
 			//}
 
 			// Unit calculations
+			if(VisibleQuadContainerCache::enableFrustumCalcs == true) {
+				// Units stay in a loose grid that follows their cells so whole
+				// areas are accepted or rejected by the frustum before testing
+				// single units
+				if(unitVisibilityGrid.isInitialized() == false) {
+					initUnitVisibilityGrid(world);
+				}
+				for(int i = 0; i < world->getFactionCount(); ++i) {
+					const Faction *faction = world->getFaction(i);
+					for(int j = 0; j < faction->getUnitCount(); ++j) {
+						updateUnitInVisibilityGrid(faction->getUnit(j));
+					}
+				}
+				unitVisibilityGrid.classify(quadCache.frustumData);
+			}
+
 			for(int i = 0; i < world->getFactionCount(); ++i) {
 				const Faction *faction = world->getFaction(i);
 				for(int j = 0; j < faction->getUnitCount(); ++j) {
@@ -9121,7 +9184,21 @@ VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
 					bool unitCheckedForRender = false;
 					if(VisibleQuadContainerCache::enableFrustumCalcs == true) {
 						//bool insideQuad 	= PointInFrustum(quadCache.frustumData, unit->getCurrVector().x, unit->getCurrVector().y, unit->getCurrVector().z );
-						bool insideQuad 	= CubeInFrustum(quadCache.frustumData, unit->getCurrMidHeightVector().x, unit->getCurrMidHeightVector().y, unit->getCurrMidHeightVector().z, unit->getType()->getRenderSize());
+						bool insideQuad 	= false;
+						switch(unitVisibilityGrid.getItemClassification(unit->getVisibilityGridItem())) {
+							case FrustumCulling::bcInside:
+								insideQuad = true;
+								break;
+							case FrustumCulling::bcOutside:
+								insideQuad = false;
+								break;
+							default:
+								{
+								Vec3f unitCenter = unit->getCurrMidHeightVector();
+								insideQuad = CubeInFrustum(quadCache.frustumData, unitCenter.x, unitCenter.y, unitCenter.z, unit->getType()->getRenderSize());
+								}
+								break;
+						}
 						bool renderInMap 	= world->toRenderUnit(unit);
 						if(insideQuad == false || renderInMap == false) {
 							unit->setVisible(false);
@@ -9207,43 +9284,48 @@ VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
 				}
 				quadCache.clearNonVolatileCacheData();
 
-				//int loops1=0;
-				PosQuadIterator pqi(map,visibleQuad, Map::cellScale);
-				while(pqi.next()) {
-					const Vec2i &pos= pqi.getPos();
-					if(map->isInside(pos)) {
-						//loops1++;
-						const Vec2i &mapPos = Map::toSurfCoords(pos);
-
-						//quadCache.visibleCellList.push_back(mapPos);
-
-						SurfaceCell *sc = map->getSurfaceCell(mapPos);
-						Object *o = sc->getObject();
+				// Only cells holding an object can add to the list, so look them up
+				// in the object index instead of walking every cell of the quad
+				if(objectVisibilityIndex.isBuilt() == false) {
+					buildObjectVisibilityIndex(map);
+				}
 
-						if(VisibleQuadContainerCache::enableFrustumCalcs == true) {
-							if(o != NULL) {
-								//bool insideQuad 	= PointInFrustum(quadCache.frustumData, o->getPos().x, o->getPos().y, o->getPos().z );
-								bool insideQuad 	= CubeInFrustum(quadCache.frustumData, o->getPos().x, o->getPos().y, o->getPos().z, 1);
-								if(insideQuad == false) {
-									o->setVisible(false);
-									continue;
-								}
-							}
-						}
+				const Rect2i quadBounds = visibleQuad.computeBoundingRect();
+				const Rect2i surfaceBounds(
+						max(quadBounds.p[0].x, 0) / Map::cellScale,
+						max(quadBounds.p[0].y, 0) / Map::cellScale,
+						max(quadBounds.p[1].x, 0) / Map::cellScale + 1,
+						max(quadBounds.p[1].y, 0) / Map::cellScale + 1);
+				objectVisibilityQueryList.clear();
+				objectVisibilityIndex.query(
+						(VisibleQuadContainerCache::enableFrustumCalcs == true ? &quadCache.frustumData : NULL),
+						surfaceBounds, objectVisibilityQueryList);
+
+				// Items are indexed row by row, keep the order of a cell walk
+				std::sort(objectVisibilityQueryList.begin(),objectVisibilityQueryList.end());
+
+				const bool showWorld = world->showWorldForPlayer(world->getThisFactionIndex());
+				for(unsigned int queryIndex = 0; queryIndex < objectVisibilityQueryList.size(); ++queryIndex) {
+					const VisibilityItem &item = objectVisibilityIndex.getItem(objectVisibilityQueryList[queryIndex]);
+					const Vec2i pos = item.cell * Map::cellScale;
+					if(map->isInside(pos) == false || visibleQuad.isInside(pos) == false) {
+						continue;
+					}
 
-                        bool cellExplored = world->showWorldForPlayer(world->getThisFactionIndex());
-                        if(cellExplored == false) {
-                            cellExplored = sc->isExplored(world->getThisTeamIndex());
-                        }
+					SurfaceCell *sc = map->getSurfaceCell(item.cell);
+					Object *o = sc->getObject();
+					if(o == NULL) {
+						continue;
+					}
 
-						bool isExplored = (cellExplored == true && o != NULL);
-						//bool isVisible = (sc->isVisible(world->getThisTeamIndex()) && o != NULL);
-						bool isVisible = true;
+					bool cellExplored = showWorld;
+					if(cellExplored == false) {
+						cellExplored = sc->isExplored(world->getThisTeamIndex());
+					}
 
-						if(isExplored == true && isVisible == true) {
-							quadCache.visibleObjectList.push_back(o);
-							o->setVisible(true);
-						}
+					if(cellExplored == true) {
+						quadCache.visibleObjectList.push_back(o);
+						o->setVisible(true);
 					}
 				}
 
@@ -9251,7 +9333,7 @@ VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
 
 				//int loops2=0;
 
-				std::map<Vec2i, MarkedCell> markedCells = game->getMapMarkedCellList();
+				const std::map<Vec2i, MarkedCell> &markedCells = game->getMapMarkedCellList();
 
 				const Rect2i mapBounds(0, 0, map->getSurfaceW()-1, map->getSurfaceH()-1);
 				Quad2i scaledQuad = visibleQuad / Map::cellScale;
@@ -9310,6 +9392,61 @@ VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
 	return quadCache;
 }
 
+void Renderer::buildObjectVisibilityIndex(const Map *map) {
+	// Tileset objects never move, index them once per map
+	vector<VisibilityItem> items;
+	for(int y = 0; y < map->getSurfaceH(); ++y) {
+		for(int x = 0; x < map->getSurfaceW(); ++x) {
+			const Object *o = map->getSurfaceCell(x, y)->getObject();
+			if(o != NULL) {
+				items.push_back(VisibilityItem(Vec2i(x, y), o->getPos(), 1));
+			}
+		}
+	}
+	objectVisibilityIndex.build(items);
+}
+
+void Renderer::initUnitVisibilityGrid(const World *world) {
+	// Units are drawn between the lowest cell and an air unit above the
+	// highest cell or the tallest obstacle under it
+	const Map *map= world->getMap();
+	float minHeight = map->getCell(0, 0)->getHeight();
+	float maxHeight = minHeight;
+	for(int y = 0; y < map->getH(); ++y) {
+		for(int x = 0; x < map->getW(); ++x) {
+			float height = map->getCell(x, y)->getHeight();
+			minHeight = min(minHeight, height);
+			maxHeight = max(maxHeight, height);
+		}
+	}
+	maxHeight += max(world->getTileset()->getAirHeight(), Tileset::standardAirHeight * 3);
+
+	const int unitVisibilityGridCellSize = 8;
+	unitVisibilityGrid.init(map->getW(), map->getH(), unitVisibilityGridCellSize, minHeight, maxHeight);
+	unitVisibilityGridUnits.clear();
+}
+
+void Renderer::updateUnitInVisibilityGrid(Unit *unit) {
+	// A moving unit is drawn up to one cell behind its position, offset by
+	// half its size and raised by half its height
+	const UnitType *type = unit->getType();
+	float reach = max(type->getSize() / 2.f + 1.5f, type->getHeight() / 2.f) + type->getRenderSize();
+
+	int itemIndex = unit->getVisibilityGridItem();
+	if(itemIndex >= 0 && itemIndex < (int)unitVisibilityGridUnits.size() &&
+		unitVisibilityGridUnits[itemIndex] == unit) {
+		unitVisibilityGrid.updateItem(itemIndex, unit->getPos(), reach);
+		return;
+	}
+
+	itemIndex = unitVisibilityGrid.addItem(unit->getPos(), reach);
+	if(itemIndex >= (int)unitVisibilityGridUnits.size()) {
+		unitVisibilityGridUnits.resize(itemIndex + 1);
+	}
+	unitVisibilityGridUnits[itemIndex] = unit;
+	unit->setVisibilityGridItem(itemIndex);
+}
+
 void Renderer::updateMarkedCellScreenPosQuadCache(Vec2i pos) {
 	const World *world= game->getWorld();
 	const Map *map= world->getMap();
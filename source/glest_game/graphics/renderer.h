@@ -38,6 +38,7 @@
 #include "base_renderer.h"
 #include "simple_threads.h"
 #include "video_player.h"
+#include "visibility_index.h"
 
 #ifdef DEBUG_RENDERING_ENABLED
 #	define IF_DEBUG_EDITION(x) x
@@ -69,6 +70,8 @@ class ChatManager;
 class Object;
 class ConsoleLineInfo;
 class SurfaceCell;
+class Map;
+class World;
 class Program;
 // =====================================================
 // 	class MeshCallbackTeamColor
@@ -278,6 +281,12 @@ private:
 	VisibleQuadContainerCache quadCache;
 	VisibleQuadContainerCache quadCacheSelection;
 
+	// Spatial indices used to rebuild the quad cache
+	VisibilityQuadTree objectVisibilityIndex;
+	VisibilityLooseGrid unitVisibilityGrid;
+	vector<const Unit *> unitVisibilityGridUnits;
+	vector<int> objectVisibilityQueryList;
+
 	//renderers
 	ModelRenderer *modelRenderer;
 	TextRenderer2D *textRenderer;
@@ -315,6 +324,8 @@ private:
 	//std::vector<std::pair<Unit *,Vec3f> > renderUnitTitleList;
 	std::vector<Unit *> visibleFrameUnitList;
 	string visibleFrameUnitListCameraKey;
+	// Reused every frame so its buffers keep their size
+	ModelDrawList unitDrawList;
 
 	bool no2DMouseRendering;
 	bool showDebugUI;
@@ -427,6 +438,10 @@ private:
 	bool SphereInFrustum(vector<vector<float> > &frustum,  float x, float y, float z, float radius);
 	bool CubeInFrustum(vector<vector<float> > &frustum, float x, float y, float z, float size );
 
+	void buildObjectVisibilityIndex(const Map *map);
+	void initUnitVisibilityGrid(const World *world);
+	void updateUnitInVisibilityGrid(Unit *unit);
+
 private:
 	Renderer();
 	~Renderer();
@@ -468,6 +483,8 @@ public:
 	void endLastTexture(ResourceScope rs, bool mustExistInList=false);
 
 	Model *newModel(ResourceScope rs,const string &path,bool deletePixMapAfterLoad=false,std::map<string,vector<pair<string, string> > > *loadedFileList=NULL, string *sourceLoader=NULL);
+	void setDeferredTextureInit(ResourceScope rs, bool value);
+	string getModelLoadStats(ResourceScope rs) const;
 	void endModel(ResourceScope rs, Model *model, bool mustExistInList=false);
 	void endLastModel(ResourceScope rs, bool mustExistInList=false);
 
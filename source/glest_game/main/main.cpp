@@ -55,6 +55,9 @@
 #include "auto_test.h"
 #include "lua_script.h"
 #include "interpolation.h"
+#include "sound_cache.h"
+#include "map_catalog.h"
+#include "task_scheduler.h"
 
 // To handle signal catching
 #if defined(__GNUC__) && !defined(__MINGW32__) && !defined(__FreeBSD__) && !defined(BSD)
@@ -122,6 +125,7 @@ static bool gameInitialized 					= false;
 
 static Program *mainProgram 					= NULL;
 static FileCRCPreCacheThread *preCacheThread	= NULL;
+static MapCatalogThread *mapCatalogThread		= NULL;
 #ifdef WIN32
 static string runtimeErrorMsg 					= "";
 #endif
@@ -156,6 +160,14 @@ public:
 };
 
 void cleanupCRCThread() {
+	if(mapCatalogThread != NULL) {
+		mapCatalogThread->signalQuit();
+		if(mapCatalogThread->shutdownAndWait() == true) {
+			delete mapCatalogThread;
+		}
+		mapCatalogThread = NULL;
+	}
+
 	if(preCacheThread != NULL) {
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
@@ -221,6 +233,11 @@ static void cleanupProcessObjects() {
     cleanupCRCThread();
     if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
+    if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"%s",TaskScheduler::getInstance().getStatsReport().c_str());
+    if(TaskScheduler::getInstance().shutdown(5000) == false) {
+    	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("TaskScheduler threads did not stop in time\n");
+    }
+
     if(Renderer::isEnded() == false) {
     	Renderer::getInstance().end();
     	CoreData &coreData= CoreData::getInstance();
@@ -229,6 +246,12 @@ static void cleanupProcessObjects() {
 
     if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
+    if(MutexContentionProfiler::isEnabled() == true) {
+    	string report = MutexContentionProfiler::getReport();
+    	printf("%s",report.c_str());
+    	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"%s",report.c_str());
+    }
+
 	SystemFlags::Close();
 	SystemFlags::SHUTDOWN_PROGRAM_MODE=true;
 
@@ -1494,6 +1517,7 @@ void setupLogging(Config &config, bool haveSpecialOutputCommandLineOption) {
     SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled      	= config.getBool("DebugMode","false");
     SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled     	= config.getBool("DebugNetwork","false");
     SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled 	= config.getBool("DebugPerformance","false");
+    MutexContentionProfiler::setEnabled(config.getBool("DebugMutexContention","false"));
     SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled  	= config.getBool("DebugWorldSynch","false");
     SystemFlags::getSystemSettingType(SystemFlags::debugUnitCommands).enabled  	= config.getBool("DebugUnitCommands","false");
     SystemFlags::getSystemSettingType(SystemFlags::debugPathFinder).enabled  	= config.getBool("DebugPathFinder","false");
@@ -4446,6 +4470,15 @@ int glestMain(int argc, char** argv) {
         }
 	    setCRCCacheFilePath(crcCachePath);
 
+	    // Preprocessed models, off unless asked for
+	    if(config.getBool("G3dModelCache","false") == true) {
+	    	string modelCachePath = crcCachePath + "models/";
+	        if(isdir(modelCachePath.c_str()) == false) {
+	        	createDirectoryPaths(modelCachePath);
+	        }
+	    	Model::setCachePath(modelCachePath);
+	    }
+
 	    string savedGamePath = userData + "saved/";
         if(isdir(savedGamePath.c_str()) == false) {
         	createDirectoryPaths(savedGamePath);
@@ -4690,6 +4723,7 @@ int glestMain(int argc, char** argv) {
 
         // Set some statics based on ini entries
 		SystemFlags::ENABLE_THREADED_LOGGING = config.getBool("ThreadedLogging","true");
+		SystemFlags::THREADED_LOGGING_RATE_LIMIT = config.getInt("ThreadedLoggingRateLimit","0");
 		FontGl::setDefault_fontType(config.getString("DefaultFont",FontGl::getDefault_fontType().c_str()));
 		UPNP_Tools::isUPNP = !config.getBool("DisableUPNP","false");
 		Texture::useTextureCompression = config.getBool("EnableTextureCompression","false");
@@ -4733,6 +4767,22 @@ int glestMain(int argc, char** argv) {
         // Setup debug logging etc
 		setupLogging(config, haveSpecialOutputCommandLineOption);
 
+		// Settings read only by code that are not in the master ini are
+		// reported too, so this is only shown in verbose mode
+		vector<pair<string,string> > unknownConfigKeys = config.getUnknownUserKeys();
+		for(unsigned int i = 0; i < unknownConfigKeys.size(); ++i) {
+			const pair<string,string> &unknownKey = unknownConfigKeys[i];
+			if(SystemFlags::VERBOSE_MODE_ENABLED) {
+				if(unknownKey.second != "") {
+					printf("**INFO** Unknown setting [%s] in [%s], did you mean [%s]?\n",unknownKey.first.c_str(),config.getFileName(true).c_str(),unknownKey.second.c_str());
+				}
+				else {
+					printf("**INFO** Unknown setting [%s] in [%s]\n",unknownKey.first.c_str(),config.getFileName(true).c_str());
+				}
+			}
+			SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] Unknown setting [%s] closest known [%s]\n",__FILE__,__FUNCTION__,__LINE__,unknownKey.first.c_str(),unknownKey.second.c_str());
+		}
+
         SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] Font::charCount = %d, Font::fontTypeName [%s] Shared::Platform::PlatformContextGl::charSet = %d, Font::fontIsMultibyte = %d, fontIsRightToLeft = %d\n",__FILE__,__FUNCTION__,__LINE__,::Shared::Graphics::Font::charCount,::Shared::Graphics::Font::fontTypeName.c_str(),::Shared::Platform::PlatformContextGl::charSet,::Shared::Graphics::Font::fontIsMultibyte, ::Shared::Graphics::Font::fontIsRightToLeft);
 
 		NetworkInterface::setDisplayMessageFunction(ExceptionHandler::DisplayMessage);
@@ -4771,6 +4821,9 @@ int glestMain(int argc, char** argv) {
 		InterpolationData::setEnableInterpolation(false);
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("**INFO** Disabling Interpolation\n");
 	}
+	InterpolationData::setQuantizationStep(config.getFloat("VertexInterpolationQuantizationStep","0.015625"));
+	InterpolationData::setPoseCacheSize(config.getInt("VertexInterpolationPoseCacheSize","4"));
+	::Shared::Sound::PcmSoundCache::getInstance().setMemoryLimit((uint64)config.getInt("SoundCacheMemoryLimitMB","64") * 1024 * 1024);
 
 
         if(config.getBool("EnableVSynch","false") == true) {
@@ -5316,6 +5369,10 @@ int glestMain(int argc, char** argv) {
 					try {
 						printf("About to load model [%s] [%u of " MG_SIZE_T_SPECIFIER "]\n",file.c_str(),i,models.size());
 						Model *model = renderer.newModel(rsGlobal, file);
+						MeshCacheStats beforeStats;
+						MeshCacheStats afterStats;
+						model->optimizeMeshes(&beforeStats, &afterStats);
+						printf("Optimized model [%s] %s\n",file.c_str(),MeshOptimizer::getReport(beforeStats, afterStats).c_str());
 						printf("About to save converted model [%s]\n",file.c_str());
 						model->save(file,textureFormat,keepsmallest);
                         Renderer::getInstance().endModel(rsGlobal, model);
@@ -5385,7 +5442,7 @@ int glestMain(int argc, char** argv) {
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] precache thread enabled = %d\n",__FILE__,__FUNCTION__,__LINE__,startCRCPrecacheThread);
 		if (startCRCPrecacheThread == true
 				&& GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			vector<string> techDataPaths = config.getPathListForType(ptTechs);
 
 			FileCRCPreCacheThread::setPreCacheThreadCacheLookupKey(GameConstants::preCacheThreadCacheLookupKey);
@@ -5400,6 +5457,12 @@ int glestMain(int argc, char** argv) {
 			preCacheThread->start();
 		}
 
+		// Index every map for the lobby lists and previews
+		if(config.getBool("MapCatalogThread","true") == true) {
+			mapCatalogThread = new MapCatalogThread(config.getPathListForType(ptMaps));
+			mapCatalogThread->start();
+		}
+
 		std::auto_ptr<NavtiveLanguageNameListCacheGenerator> lngCacheGen;
 		std::auto_ptr<SimpleTaskThread> languageCacheGen;
 
@@ -389,7 +389,7 @@ void Program::loopWorker() {
 
 	Chrono chronoPerformanceCounts;
 
-	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+	bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 	Chrono chronoPerf;
 	char perfBuf[8096]="";
 	std::vector<string> perfList;
@@ -843,7 +843,7 @@ void Program::init(WindowGl *window, bool initSound, bool toggleFullScreen){
 			if(BaseThread::shutdownAndWait(soundThreadManager) == true) {
 				delete soundThreadManager;
 			}
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			soundThreadManager = new SimpleTaskThread(&SoundRenderer::getInstance(),0,SOUND_THREAD_UPDATE_MILLISECONDS);
 			soundThreadManager->setUniqueID(mutexOwnerId);
 			soundThreadManager->start();
@@ -923,7 +923,7 @@ void Program::stopSoundSystem() {
 void Program::startSoundSystem() {
 	stopSoundSystem();
 	if(SoundRenderer::getInstance().runningThreaded() == true) {
-		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		soundThreadManager = new SimpleTaskThread(&SoundRenderer::getInstance(),0,SOUND_THREAD_UPDATE_MILLISECONDS);
 		soundThreadManager->setUniqueID(mutexOwnerId);
 		soundThreadManager->start();
@@ -619,7 +619,7 @@ MenuStateConnectedGame::MenuStateConnectedGame(Program *program, MainMenu *mainM
         ftpClientThread->start();
     }
 	// Start http meta data thread
-    static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+    static const char *mutexOwnerId = CODE_AT_LINE;
 	modHttpServerThread = new SimpleTaskThread(this,0,200);
 	modHttpServerThread->setUniqueID(mutexOwnerId);
 	modHttpServerThread->start();
@@ -976,7 +976,7 @@ string MenuStateConnectedGame::refreshMapModInfo(string mapInfo) {
 void MenuStateConnectedGame::simpleTask(BaseThread *callingThread,void *userdata) {
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),mutexOwnerId);
     if(callingThread->getQuitStatus() == true || safeMutexThreadOwner.isValidMutex() == false) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
@@ -1084,7 +1084,7 @@ void MenuStateConnectedGame::simpleTask(BaseThread *callingThread,void *userdata
 
     if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-    MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),string(__FILE__) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),CODE_AT_LINE);
 	tilesetListRemote.clear();
 	Tokenize(tilesetsMetaData,tilesetListRemote,"\n");
 	safeMutex.ReleaseLock(true);
@@ -1282,18 +1282,18 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
                     	if(button == 0 && ftpMessageBox.getButtonCount() == 3) {
 							string mapName = getMissingMapFromFTPServer;
 
-							MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+							MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 							string mapURL = mapCacheList[mapName].url;
 							safeMutexThread.ReleaseLock();
 
 							if(ftpClientThread != NULL) ftpClientThread->addMapToRequests(mapName,mapURL);
-                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
                     		fileFTPProgressList[getMissingMapFromFTPServer] = pair<int,string>(0,"");
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
                     	else {
                     		ftpClientThread->addMapToRequests(getMissingMapFromFTPServer);
-                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
                     		fileFTPProgressList[getMissingMapFromFTPServer] = pair<int,string>(0,"");
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
@@ -1320,18 +1320,18 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
                     	if(button == 0 && ftpMessageBox.getButtonCount() == 3) {
     						string tilesetName = getMissingTilesetFromFTPServer;
 
-    						MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+    						MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
     						string tilesetURL = tilesetCacheList[tilesetName].url;
     						safeMutexThread.ReleaseLock();
 
     						if(ftpClientThread != NULL) ftpClientThread->addTilesetToRequests(tilesetName,tilesetURL);
-                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
                     		fileFTPProgressList[getMissingTilesetFromFTPServer] = pair<int,string>(0,"");
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
                     	else {
 							ftpClientThread->addTilesetToRequests(getMissingTilesetFromFTPServer);
-							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
 							fileFTPProgressList[getMissingTilesetFromFTPServer] = pair<int,string>(0,"");
 							safeMutexFTPProgress.ReleaseLock();
                     	}
@@ -1358,18 +1358,18 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
                     	if(button == 0 && ftpMessageBox.getButtonCount() == 3) {
     						string techName = getMissingTechtreeFromFTPServer;
 
-    						MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+    						MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
     						string techURL = techCacheList[techName].url;
     						safeMutexThread.ReleaseLock();
 
     						if(ftpClientThread != NULL) ftpClientThread->addTechtreeToRequests(techName,techURL);
-                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+                    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
                     		fileFTPProgressList[getMissingTechtreeFromFTPServer] = pair<int,string>(0,"");
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
                     	else {
 							ftpClientThread->addTechtreeToRequests(getMissingTechtreeFromFTPServer);
-							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
 							fileFTPProgressList[getMissingTechtreeFromFTPServer] = pair<int,string>(0,"");
 							safeMutexFTPProgress.ReleaseLock();
                     	}
@@ -2746,7 +2746,7 @@ void MenuStateConnectedGame::render() {
 		renderer.renderLabel(&labelAllowNativeLanguageTechtree);
 		renderer.renderCheckBox(&checkBoxAllowNativeLanguageTechtree);
 
-        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
 
         // !!! START TEMP MV
         //renderer.renderButton(&buttonCancelDownloads);
@@ -2845,7 +2845,7 @@ void MenuStateConnectedGame::update() {
 		newLabelConnectionInfo = lang.getString("MGGameStatus2");
 	}
 	// Test progress bar
-    //MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+    //MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
     //fileFTPProgressList["test"] = pair<int,string>(difftime(time(NULL),lastNetworkSendPing) * 20,"test file 123");
     //safeMutexFTPProgress.ReleaseLock();
     //
@@ -2946,7 +2946,7 @@ void MenuStateConnectedGame::update() {
 
 				if(clientInterface->isConnected() && clientInterface->getJoinGameInProgress() == false &&
 					pingCount >= MAX_PING_LAG_COUNT && clientInterface->getLastPingLag() >= (GameConstants::networkPingInterval * MAX_PING_LAG_COUNT)) {
-					MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
 					if(fileFTPProgressList.empty() == true) {
 						Lang &lang= Lang::getInstance();
 						const vector<string> languageList = displayedGamesettings.getUniqueNetworkPlayerLanguages();
@@ -2979,7 +2979,7 @@ void MenuStateConnectedGame::update() {
             	displayedGamesettings.getMap() != "") {
                 Config &config = Config::getInstance();
 
-                MutexSafeWrapper safeMutexFTPProgress(ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+                MutexSafeWrapper safeMutexFTPProgress(ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL,CODE_AT_LINE);
 
                 uint32 tilesetCRC = lastCheckedCRCTilesetValue;
                 if(lastCheckedCRCTilesetName != displayedGamesettings.getTileset() &&
@@ -3469,7 +3469,7 @@ void MenuStateConnectedGame::update() {
 			    clientInterface->getReadyForInGameJoin() == true &&
 			   ftpClientThread != NULL) {
 
-				MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
 				if(readyToJoinInProgressGame == false) {
 					if(getInProgressSavedGameFromFTPServer == "") {
 
@@ -3977,7 +3977,9 @@ bool MenuStateConnectedGame::loadMapInfo(string file, MapInfo *mapInfo, bool loa
 				if(loadMapPreview == true) {
 					if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 					if(mapPreview.getMapFileLoaded() != file) {
-						mapPreview.loadFromFile(file.c_str());
+						if(mapPreview.loadFromCatalog(file) == false) {
+							mapPreview.loadFromFile(file.c_str());
+						}
 						cleanupMapPreviewTexture();
 					}
 				}
@@ -4104,7 +4106,7 @@ void MenuStateConnectedGame::FTPClient_CallbackEvent(string itemName,
             }
             //if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] current file [%s] fileProgress = %d [now = %f, total = %f]\n",itemName.c_str(),stats->currentFilename.c_str(), fileProgress,stats->download_now,stats->download_total);
 
-            MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+            MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
             pair<int,string> lastProgress;
             std::map<string,pair<int,string> >::iterator iterFind = fileFTPProgressList.find(itemName);
             if(iterFind == fileFTPProgressList.end()) {
@@ -4173,7 +4175,7 @@ void MenuStateConnectedGame::FTPClient_CallbackEvent(string itemName,
         getMissingMapFromFTPServerInProgress = false;
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
         fileFTPProgressList.erase(itemName);
         safeMutexFTPProgress.ReleaseLock();
 
@@ -4248,7 +4250,7 @@ void MenuStateConnectedGame::FTPClient_CallbackEvent(string itemName,
         getMissingTilesetFromFTPServerInProgress = false;
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
         fileFTPProgressList.erase(itemName);
         safeMutexFTPProgress.ReleaseLock(true);
 
@@ -4341,7 +4343,7 @@ void MenuStateConnectedGame::FTPClient_CallbackEvent(string itemName,
         getMissingTechtreeFromFTPServerInProgress = false;
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
         fileFTPProgressList.erase(itemName);
         safeMutexFTPProgress.ReleaseLock(true);
 
@@ -4435,7 +4437,7 @@ void MenuStateConnectedGame::FTPClient_CallbackEvent(string itemName,
     	getInProgressSavedGameFromFTPServerInProgress = false;
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),CODE_AT_LINE);
         //fileFTPProgressList.erase(itemName);
         std::map<string,pair<int,string> >::iterator iterFind = fileFTPProgressList.find(itemName);
         if(iterFind == fileFTPProgressList.end()) {
@@ -4606,7 +4608,7 @@ void MenuStateConnectedGame::setupUIFromGameSettings(GameSettings *gameSettings,
 					snprintf(szBuf,8096,"%s %s ?",lang.getString("DownloadMissingTilesetQuestion").c_str(),gameSettings->getTileset().c_str());
 
 					// Is the item in the mod center?
-					MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 					if(tilesetCacheList.find(getMissingTilesetFromFTPServer) == tilesetCacheList.end()) {
 						ftpMessageBox.init(lang.getString("Yes"),lang.getString("NoDownload"));
 					}
@@ -4679,7 +4681,7 @@ void MenuStateConnectedGame::setupUIFromGameSettings(GameSettings *gameSettings,
 					snprintf(szBuf,8096,"%s %s ?",lang.getString("DownloadMissingTechtreeQuestion").c_str(),gameSettings->getTech().c_str());
 
 					// Is the item in the mod center?
-					MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 					if(techCacheList.find(getMissingTechtreeFromFTPServer) == techCacheList.end()) {
 						ftpMessageBox.init(lang.getString("Yes"),lang.getString("NoDownload"));
 					}
@@ -4774,7 +4776,7 @@ void MenuStateConnectedGame::setupUIFromGameSettings(GameSettings *gameSettings,
 					snprintf(szBuf,8096,"%s %s ?",lang.getString("DownloadMissingMapQuestion").c_str(),currentMap.c_str());
 
 					// Is the item in the mod center?
-					MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutexThread((modHttpServerThread != NULL ? modHttpServerThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 					if(mapCacheList.find(getMissingMapFromFTPServer) == mapCacheList.end()) {
 						ftpMessageBox.init(lang.getString("Yes"),lang.getString("NoDownload"));
 					}
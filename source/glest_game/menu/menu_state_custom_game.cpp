@@ -698,11 +698,11 @@ MenuStateCustomGame::MenuStateCustomGame(Program *program, MainMenu *mainMenu,
 
 	GraphicComponent::applyAllCustomProperties(containerName);
 
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	publishToMasterserverThread = new SimpleTaskThread(this,0,300,false,(void *)tnt_MASTERSERVER);
 	publishToMasterserverThread->setUniqueID(mutexOwnerId);
 
-	static string mutexOwnerId2 = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId2 = CODE_AT_LINE;
 	publishToClientsThread = new SimpleTaskThread(this,0,200,false,(void *)tnt_CLIENTS,false);
 	publishToClientsThread->setUniqueID(mutexOwnerId2);
 
@@ -1133,8 +1133,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 
 				soundRenderer.playFx(coreData.getClickSoundA());
 
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 				needToBroadcastServerSettings = false;
 				needToRepublishToMasterserver = false;
 				lastNetworkPing               = time(NULL);
@@ -1160,8 +1160,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 			else if(listBoxMap.mouseClick(x, y,advanceToItemStartingWith)){
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"%s\n", getCurrentMapFile().c_str());
 
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				loadMapInfo(Config::getMapPath(getCurrentMapFile(),"",false), &mapInfo, true);
 				labelMapInfo.setText(mapInfo.desc);
@@ -1179,8 +1179,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && listBoxFogOfWar.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				cleanupMapPreviewTexture();
 				if(checkBoxPublishServer.getValue() == true) {
@@ -1193,8 +1193,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && checkBoxAllowObservers.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1208,8 +1208,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAllowInGameJoinPlayer.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1224,8 +1224,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				serverInterface->setAllowInGameConnections(checkBoxAllowInGameJoinPlayer.getValue() == true);
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && checkBoxAllowTeamUnitSharing.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 
 				if(checkBoxPublishServer.getValue() == true) {
@@ -1238,8 +1238,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && checkBoxAllowTeamResourceSharing.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 
 				if(checkBoxPublishServer.getValue() == true) {
@@ -1252,8 +1252,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAllowNativeLanguageTechtree.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1266,8 +1266,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && checkBoxEnableSwitchTeamMode.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1280,8 +1280,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && listBoxAISwitchTeamAcceptPercent.getEnabled() && listBoxAISwitchTeamAcceptPercent.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1294,8 +1294,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if (checkBoxAdvanced.getValue() == 1 && listBoxFallbackCpuMultiplier.getEditable() == true && listBoxFallbackCpuMultiplier.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1310,8 +1310,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 			else if (checkBoxAdvanced.mouseClick(x, y)) {
 			}
 			else if(listBoxTileset.mouseClick(x, y,advanceToItemStartingWith)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1325,8 +1325,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if(listBoxMapFilter.mouseClick(x, y)){
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				switchToNextMapGroup(listBoxMapFilter.getSelectedItemIndex()-oldListBoxMapfilterIndex);
 
@@ -1350,8 +1350,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 			else if(listBoxTechTree.mouseClick(x, y,advanceToItemStartingWith)){
 				reloadFactions(listBoxTechTree.getItemCount() <= 1,(checkBoxScenario.getValue() == true ? scenarioFiles[listBoxScenario.getSelectedItemIndex()] : ""));
 
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1364,8 +1364,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				}
 			}
 			else if(checkBoxPublishServer.mouseClick(x, y) && checkBoxPublishServer.getEditable()) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				needToRepublishToMasterserver = true;
 				soundRenderer.playFx(coreData.getClickSoundC());
@@ -1377,8 +1377,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 				setActiveInputLabel(&labelGameName);
 			}
 			else if(checkBoxAdvanced.getValue() == 1 && checkBoxNetworkPauseGameForLaggedClients.mouseClick(x, y)) {
-				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+				MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 				if(checkBoxPublishServer.getValue() == true) {
 					needToRepublishToMasterserver = true;
@@ -1396,8 +1396,8 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton) {
 			}
 			else {
 				for(int i = 0; i < mapInfo.players; ++i) {
-					MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-					MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+					MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 					// set multiplier
 					if(listBoxRMultiplier[i].mouseClick(x, y)) {
@@ -1693,8 +1693,8 @@ void MenuStateCustomGame::loadGameSettings(std::string fileName) {
 	ServerInterface* serverInterface= NetworkManager::getInstance().getServerInterface();
 	serverInterface->setGameSettings(&gameSettings,false);
 
-	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-	MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+	MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 	if(checkBoxPublishServer.getValue() == true) {
 		needToRepublishToMasterserver = true;
@@ -1758,8 +1758,8 @@ void MenuStateCustomGame::PlayNow(bool saveGame) {
 		return;
 	}
 
-	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-	MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+	MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 	if(saveGame == true) {
 		saveGameSettingsToFile(SAVED_GAME_FILENAME);
@@ -2421,8 +2421,8 @@ void MenuStateCustomGame::update() {
 	//sleep(200);
 	// END
 
-	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-	MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+	MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 	try {
 		if(serverInitError == true) {
@@ -2798,7 +2798,7 @@ void MenuStateCustomGame::update() {
 			if(this->headlessServerMode == true && hasOneNetworkSlotOpen == false) {
 				bool anyoneConnected = false;
 				for(int i= 0; i < mapInfo.players; ++i) {
-					MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+					MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 					ServerInterface* serverInterface= NetworkManager::getInstance().getServerInterface();
 					ConnectionSlot *slot = serverInterface->getSlot(i,true);
@@ -3072,7 +3072,7 @@ void MenuStateCustomGame::publishToMasterserver() {
 	Config &config= Config::getInstance();
 	//string serverinfo="";
 
-	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 	publishToServerInfo.clear();
 
@@ -3194,14 +3194,14 @@ void MenuStateCustomGame::simpleTaskForMasterServer(BaseThread *callingThread) {
     try {
         //printf("-=-=-=-=- IN MenuStateCustomGame simpleTask - A\n");
 
-        MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),CODE_AT_LINE);
         if(callingThread->getQuitStatus() == true || safeMutexThreadOwner.isValidMutex() == false) {
             return;
         }
 
         //printf("-=-=-=-=- IN MenuStateCustomGame simpleTask - B\n");
 
-        MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),CODE_AT_LINE);
         bool republish                                  = (needToRepublishToMasterserver == true  && publishToServerInfo.empty() == false);
         needToRepublishToMasterserver                   = false;
         std::map<string,string> newPublishToServerInfo  = publishToServerInfo;
@@ -3250,7 +3250,7 @@ void MenuStateCustomGame::simpleTaskForMasterServer(BaseThread *callingThread) {
             std::string serverInfo = SystemFlags::getHTTP(request,handle);
             //SystemFlags::cleanupHTTP(&handle);
 
-            MutexSafeWrapper safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),string(__FILE__) + "_" + intToStr(__LINE__));
+            MutexSafeWrapper safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),CODE_AT_LINE);
             if(callingThread->getQuitStatus() == true || safeMutexThreadOwner2.isValidMutex() == false) {
                 return;
             }
@@ -3315,14 +3315,14 @@ void MenuStateCustomGame::simpleTaskForClients(BaseThread *callingThread) {
     try {
         //printf("-=-=-=-=- IN MenuStateCustomGame simpleTask - A\n");
 
-        MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),CODE_AT_LINE);
         if(callingThread->getQuitStatus() == true || safeMutexThreadOwner.isValidMutex() == false) {
             return;
         }
 
         //printf("-=-=-=-=- IN MenuStateCustomGame simpleTask - B\n");
 
-        MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),CODE_AT_LINE);
         bool broadCastSettings                          = needToBroadcastServerSettings;
 
         //printf("simpleTask broadCastSettings = %d\n",broadCastSettings);
@@ -3351,7 +3351,7 @@ void MenuStateCustomGame::simpleTaskForClients(BaseThread *callingThread) {
         //printf("-=-=-=-=- IN MenuStateCustomGame simpleTask - D\n");
 
         if(broadCastSettings == true) {
-            MutexSafeWrapper safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),string(__FILE__) + "_" + intToStr(__LINE__));
+            MutexSafeWrapper safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),CODE_AT_LINE);
             if(callingThread->getQuitStatus() == true || safeMutexThreadOwner2.isValidMutex() == false) {
                 return;
             }
@@ -3388,7 +3388,7 @@ void MenuStateCustomGame::simpleTaskForClients(BaseThread *callingThread) {
         //printf("-=-=-=-=- IN MenuStateCustomGame simpleTask - E\n");
 
         if(needPing == true) {
-            MutexSafeWrapper safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),string(__FILE__) + "_" + intToStr(__LINE__));
+            MutexSafeWrapper safeMutexThreadOwner2(callingThread->getMutexThreadOwnerValid(),CODE_AT_LINE);
             if(callingThread->getQuitStatus() == true || safeMutexThreadOwner2.isValidMutex() == false) {
                 return;
             }
@@ -4238,7 +4238,9 @@ void MenuStateCustomGame::loadMapInfo(string file, MapInfo *mapInfo, bool loadMa
 			if(loadMapPreview == true) {
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-				mapPreview.loadFromFile(file.c_str());
+				if(mapPreview.loadFromCatalog(file) == false) {
+					mapPreview.loadFromFile(file.c_str());
+				}
 
 				//printf("Loading map preview MAP\n");
 				cleanupMapPreviewTexture();
@@ -4435,8 +4437,8 @@ void MenuStateCustomGame::keyDown(SDL_KeyboardEvent key) {
 	if(activeInputLabel != NULL) {
 		bool handled = keyDownEditLabel(key, &activeInputLabel);
 		if(handled == true) {
-			MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-			MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+			MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 	        if(hasNetworkGameSettings() == true) {
 	            needToSetChangedGameSettings = true;
@@ -4494,8 +4496,8 @@ void MenuStateCustomGame::keyPress(SDL_KeyboardEvent c) {
 	if(activeInputLabel != NULL) {
 		bool handled = keyPressEditLabel(c, &activeInputLabel);
 		if(handled == true && &labelGameName != activeInputLabel) {
-			MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-			MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+			MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 			if(hasNetworkGameSettings() == true) {
 				needToSetChangedGameSettings = true;
@@ -4818,8 +4820,8 @@ void MenuStateCustomGame::processScenario() {
 			updateControlers();
 			updateNetworkSlots();
 
-			MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
-			MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex((publishToMasterserverThread != NULL ? publishToMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
+			MutexSafeWrapper safeMutexCLI((publishToClientsThread != NULL ? publishToClientsThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 			if(checkBoxPublishServer.getValue() == true) {
 				needToRepublishToMasterserver = true;
@@ -271,7 +271,7 @@ MenuStateMasterserver::MenuStateMasterserver(Program *program, MainMenu *mainMen
 
 	needUpdateFromServer = true;
 
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	updateFromMasterserverThread = new SimpleTaskThread(this,0,100);
 	updateFromMasterserverThread->setUniqueID(mutexOwnerId);
 	updateFromMasterserverThread->start();
@@ -306,7 +306,7 @@ MenuStateMasterserver::MenuStateMasterserver(Program *program, MainMenu *mainMen
     	ircArgs.push_back("");
     }
 
-    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,CODE_AT_LINE);
 
     if(SystemFlags::VERBOSE_MODE_ENABLED) printf("#1 IRCCLient Cache check\n");
     IRCThread * &ircThread = CacheManager::getCachedItem< IRCThread * >(GameConstants::ircClientCacheLookupKey);
@@ -324,7 +324,7 @@ MenuStateMasterserver::MenuStateMasterserver(Program *program, MainMenu *mainMen
     if(ircThread == NULL) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("#2 IRCCLient Cache check\n");
 
-    	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+    	static const char *mutexOwnerId = CODE_AT_LINE;
     	ircThread = new IRCThread(ircArgs,this);
     	ircClient = ircThread;
     	ircClient->setUniqueID(mutexOwnerId);
@@ -419,7 +419,7 @@ void MenuStateMasterserver::setButtonLinePosition(int pos){
 }
 
 void MenuStateMasterserver::IRC_CallbackEvent(IRCEventType evt, const char* origin, const char **params, unsigned int count) {
-    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,CODE_AT_LINE);
     if(ircClient != NULL) {
         if(evt == IRC_evt_exitThread) {
         	ircClient->leaveChannel();
@@ -447,7 +447,7 @@ void MenuStateMasterserver::IRC_CallbackEvent(IRCEventType evt, const char* orig
 void MenuStateMasterserver::cleanup() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-    MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
     needUpdateFromServer = false;
     safeMutex.ReleaseLock();
 
@@ -492,7 +492,7 @@ void MenuStateMasterserver::cleanup() {
 	clearServerLines();
 	clearUserButtons();
 
-    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,CODE_AT_LINE);
     if(ircClient != NULL) {
     	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
@@ -559,7 +559,7 @@ void MenuStateMasterserver::mouseClick(int x, int y, MouseButton mouseButton){
 	else if(buttonRefresh.mouseClick(x, y)){
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-		MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+		MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 		soundRenderer.playFx(coreData.getClickSoundB());
 		needUpdateFromServer = true;
 
@@ -587,7 +587,7 @@ void MenuStateMasterserver::mouseClick(int x, int y, MouseButton mouseButton){
     else if(buttonCreateGame.mouseClick(x, y)){
     	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-    	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 		soundRenderer.playFx(coreData.getClickSoundB());
 		needUpdateFromServer = false;
 		safeMutex.ReleaseLock();
@@ -606,12 +606,12 @@ void MenuStateMasterserver::mouseClick(int x, int y, MouseButton mouseButton){
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
     }
     else if(listBoxAutoRefresh.mouseClick(x, y)){
-    	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 		soundRenderer.playFx(coreData.getClickSoundA());
 		autoRefreshTime=10*listBoxAutoRefresh.getSelectedItemIndex();
     }
     else {
-    	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
     	bool clicked=false;
     	if(!clicked && serverScrollBar.getElementCount()!=0){
     		for(int i = serverScrollBar.getVisibleStart(); i <= serverScrollBar.getVisibleEnd(); ++i) {
@@ -668,7 +668,7 @@ void MenuStateMasterserver::mouseUp(int x, int y, const MouseButton mouseButton)
 }
 
 void MenuStateMasterserver::mouseMove(int x, int y, const MouseState *ms){
-	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 
 	if (mainMessageBox.getEnabled()) {
 		mainMessageBox.mouseMove(x, y);
@@ -703,7 +703,7 @@ void MenuStateMasterserver::mouseMove(int x, int y, const MouseState *ms){
 void MenuStateMasterserver::render(){
 	Renderer &renderer= Renderer::getInstance();
 
-	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 	if(mainMessageBox.getEnabled()) {
 		renderer.renderMessageBox(&mainMessageBox);
 	}
@@ -736,7 +736,7 @@ void MenuStateMasterserver::render(){
 		renderer.renderLabel(&selectButton,&titleLabelColor);
 
 		Lang &lang= Lang::getInstance();
-		MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+		MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,CODE_AT_LINE);
         if(ircClient != NULL &&
            ircClient->isConnected() == true &&
            ircClient->getHasJoinedChannel() == true) {
@@ -797,7 +797,7 @@ void MenuStateMasterserver::render(){
 }
 
 void MenuStateMasterserver::update() {
-	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex((updateFromMasterserverThread != NULL ? updateFromMasterserverThread->getMutexThreadObjectAccessor() : NULL),CODE_AT_LINE);
 	if(autoRefreshTime!=0 && difftime(time(NULL),lastRefreshTimer) >= autoRefreshTime ) {
 		needUpdateFromServer = true;
 		lastRefreshTimer= time(NULL);
@@ -825,7 +825,7 @@ void MenuStateMasterserver::update() {
     //console
     consoleIRC.update();
 
-    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,CODE_AT_LINE);
     if(ircClient != NULL) {
         std::vector<string> nickList = ircClient->getNickList();
 
@@ -907,7 +907,7 @@ void MenuStateMasterserver::simpleTask(BaseThread *callingThread,void *userdata)
 	if(callingThread->getQuitStatus() == true) {
 		return;
 	}
-	MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(callingThread->getMutexThreadObjectAccessor(),CODE_AT_LINE);
 	bool needUpdate = needUpdateFromServer;
 
 	if(needUpdate == true) {
@@ -1202,7 +1202,7 @@ void MenuStateMasterserver::keyDown(SDL_KeyboardEvent key) {
 		//chatmanger only if connected to irc!
 		if (chatManager.getEditEnabled() == true) {
 			//printf("keyDown key [%d] chatManager.getText() [%s]\n",key,chatManager.getText().c_str());
-			MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutexIRCPtr(mutexIRCClient,CODE_AT_LINE);
 			//if (key == vkReturn && ircClient != NULL) {
 			if(isKeyPressed(SDLK_RETURN,key) == true && ircClient != NULL) {
 				ircClient->SendIRCCmdMessage(IRC_CHANNEL, chatManager.getText());
@@ -254,7 +254,7 @@ MenuStateMods::MenuStateMods(Program *program, MainMenu *mainMenu) :
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
 	// Start http meta data thread
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	modHttpServerThread = new SimpleTaskThread(this,0,200);
 	modHttpServerThread->setUniqueID(mutexOwnerId);
 	modHttpServerThread->start();
@@ -399,7 +399,7 @@ void MenuStateMods::reloadUI() {
 void MenuStateMods::simpleTask(BaseThread *callingThread,void *userdata) {
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),mutexOwnerId);
     if(callingThread->getQuitStatus() == true || safeMutexThreadOwner.isValidMutex() == false) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
@@ -1312,7 +1312,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 							string mapName = selectedMapName;
 							string mapURL = mapCacheList[mapName].url;
 							if(ftpClientThread != NULL) ftpClientThread->addMapToRequests(mapName,mapURL);
-							static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+							static const char *mutexOwnerId = CODE_AT_LINE;
 							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 							if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 							fileFTPProgressList[mapName] = pair<int,string>(0,"");
@@ -1350,7 +1350,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 								}
 							}
 			    		}
-			    		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			    		static const char *mutexOwnerId = CODE_AT_LINE;
 			    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 			    		if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 			            Checksum::clearFileCache();
@@ -1372,7 +1372,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 						string tilesetURL = tilesetCacheList[tilesetName].url;
 						if(ftpClientThread != NULL) ftpClientThread->addTilesetToRequests(tilesetName,tilesetURL);
 
-						static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 						if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 						fileFTPProgressList[tilesetName] = pair<int,string>(0,"");
@@ -1409,7 +1409,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 							}
 			    		}
 
-			    		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			    		static const char *mutexOwnerId = CODE_AT_LINE;
 			    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 			    		if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 			            // Clear the CRC file Cache
@@ -1432,7 +1432,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 						string techURL = techCacheList[techName].url;
 						if(ftpClientThread != NULL) ftpClientThread->addTechtreeToRequests(techName,techURL);
 
-						static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 						if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 						fileFTPProgressList[techName] = pair<int,string>(0,"");
@@ -1468,7 +1468,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 							}
 			    		}
 
-			    		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			    		static const char *mutexOwnerId = CODE_AT_LINE;
 			    		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 			    		if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 			            Checksum::clearFileCache();
@@ -1490,7 +1490,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 						string scenarioURL = scenarioCacheList[scenarioName].url;
 						if(ftpClientThread != NULL) ftpClientThread->addScenarioToRequests(scenarioName,scenarioURL);
 
-						static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+						static const char *mutexOwnerId = CODE_AT_LINE;
 						MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 						if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 						fileFTPProgressList[scenarioName] = pair<int,string>(0,"");
@@ -1560,7 +1560,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 				string techURL = techCacheList[techName].url;
 				if(ftpClientThread != NULL) ftpClientThread->addTechtreeToRequests(techName,techURL);
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 				if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 				fileFTPProgressList[techName] = pair<int,string>(0,"");
@@ -1640,7 +1640,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 				string tilesetURL = tilesetCacheList[tilesetName].url;
 				if(ftpClientThread != NULL) ftpClientThread->addTilesetToRequests(tilesetName,tilesetURL);
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 				if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 				fileFTPProgressList[tilesetName] = pair<int,string>(0,"");
@@ -1710,7 +1710,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 				string mapURL = mapCacheList[mapName].url;
 				if(ftpClientThread != NULL) ftpClientThread->addMapToRequests(mapName,mapURL);
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 				if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 				fileFTPProgressList[mapName] = pair<int,string>(0,"");
@@ -1791,7 +1791,7 @@ void MenuStateMods::mouseClick(int x, int y, MouseButton mouseButton) {
 				//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d] adding file to download [%s]\n",__FILE__,__FUNCTION__,__LINE__,scenarioURL.c_str());
 				if(ftpClientThread != NULL) ftpClientThread->addScenarioToRequests(scenarioName,scenarioURL);
 
-				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId = CODE_AT_LINE;
 				MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 				if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 				fileFTPProgressList[scenarioName] = pair<int,string>(0,"");
@@ -2025,7 +2025,7 @@ void MenuStateMods::showRemoteDesription(ModInfo *modInfo) {
 	    if(tempImage != "" && fileExists(tempImage) == false) {
 	    	if(ftpClientThread != NULL) ftpClientThread->addFileToRequests(tempImage,modInfo->imageUrl);
 
-	    	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	    	static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 			if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 			fileFTPProgressList[tempImage] = pair<int,string>(0,"");
@@ -2033,7 +2033,7 @@ void MenuStateMods::showRemoteDesription(ModInfo *modInfo) {
 
 	    }
 	    else {
-	    	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	    	static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 			if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 			if(fileFTPProgressList.find(tempImage) == fileFTPProgressList.end()) {
@@ -2351,7 +2351,7 @@ void MenuStateMods::render() {
 		}
 		renderer.renderScrollBar(&keyScenarioScrollBar);
 
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 		if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         if(fileFTPProgressList.empty() == false) {
@@ -2564,7 +2564,7 @@ void MenuStateMods::FTPClient_CallbackEvent(string itemName,
             }
             //if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] current file [%s] fileProgress = %d [now = %f, total = %f]\n",itemName.c_str(),stats->currentFilename.c_str(), fileProgress,stats->download_now,stats->download_total);
 
-            static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+            static const char *mutexOwnerId = CODE_AT_LINE;
             MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
             if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
             pair<int,string> lastProgress = fileFTPProgressList[itemName];
@@ -2591,7 +2591,7 @@ void MenuStateMods::FTPClient_CallbackEvent(string itemName,
     else if(type == ftp_cct_File) {
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+        static const char *mutexOwnerId = CODE_AT_LINE;
         MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
         if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         fileFTPProgressList.erase(itemName);
@@ -2607,7 +2607,7 @@ void MenuStateMods::FTPClient_CallbackEvent(string itemName,
     else if(type == ftp_cct_Map) {
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+        static const char *mutexOwnerId = CODE_AT_LINE;
         MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
         if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         fileFTPProgressList.erase(itemName);
@@ -2632,7 +2632,7 @@ void MenuStateMods::FTPClient_CallbackEvent(string itemName,
     else if(type == ftp_cct_Tileset) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-    	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+    	static const char *mutexOwnerId = CODE_AT_LINE;
     	MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
     	if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         fileFTPProgressList.erase(itemName);
@@ -2660,7 +2660,7 @@ void MenuStateMods::FTPClient_CallbackEvent(string itemName,
     else if(type == ftp_cct_Techtree) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-    	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+    	static const char *mutexOwnerId = CODE_AT_LINE;
     	MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
     	if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         fileFTPProgressList.erase(itemName);
@@ -2705,7 +2705,7 @@ void MenuStateMods::FTPClient_CallbackEvent(string itemName,
     else if(type == ftp_cct_Scenario) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-    	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+    	static const char *mutexOwnerId = CODE_AT_LINE;
         MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
         if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         fileFTPProgressList.erase(itemName);
@@ -243,7 +243,7 @@ void MenuStateRoot::mouseClick(int x, int y, MouseButton mouseButton){
 					printf("Adding ftpFileName [%s] ftpFileURL [%s]\n",ftpFileName.c_str(),ftpFileURL.c_str());
 					if(ftpClientThread != NULL) ftpClientThread->addTempFileToRequests(ftpFileName,ftpFileURL);
 
-					static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
 					if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
 					fileFTPProgressList[ftpFileName] = pair<int,string>(0,"");
@@ -384,7 +384,7 @@ void MenuStateRoot::FTPClient_CallbackEvent(string itemName,
             }
             //if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] current file [%s] fileProgress = %d [now = %f, total = %f]\n",itemName.c_str(),stats->currentFilename.c_str(), fileProgress,stats->download_now,stats->download_total);
 
-            static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+            static const char *mutexOwnerId = CODE_AT_LINE;
             MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
             if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
             pair<int,string> lastProgress = fileFTPProgressList[itemName];
@@ -419,7 +419,7 @@ void MenuStateRoot::FTPClient_CallbackEvent(string itemName,
     else if(type == ftp_cct_TempFile) {
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Got FTP Callback for [%s] result = %d [%s]\n",itemName.c_str(),result.first,result.second.c_str());
 
-        static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+        static const char *mutexOwnerId = CODE_AT_LINE;
         MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),mutexOwnerId);
         if(ftpClientThread != NULL && ftpClientThread->getProgressMutex() != NULL) ftpClientThread->getProgressMutex()->setOwnerId(mutexOwnerId);
         fileFTPProgressList.erase(itemName);
@@ -599,7 +599,7 @@ void MenuStateRoot::update() {
 
 		string updateCheckURL = Config::getInstance().getString("UpdateCheckURL","");
 		if(updateCheckURL != "") {
-		    static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		    static const char *mutexOwnerId = CODE_AT_LINE;
 		    updatesHttpServerThread = new SimpleTaskThread(this,1,200);
 		    updatesHttpServerThread->setUniqueID(mutexOwnerId);
 		    updatesHttpServerThread->start();
@@ -612,7 +612,7 @@ void MenuStateRoot::update() {
 void MenuStateRoot::simpleTask(BaseThread *callingThread,void *userdata) {
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutexThreadOwner(callingThread->getMutexThreadOwnerValid(),mutexOwnerId);
     if(callingThread->getQuitStatus() == true || safeMutexThreadOwner.isValidMutex() == false) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d]\n",__FILE__,__FUNCTION__,__LINE__);
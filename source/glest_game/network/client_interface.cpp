@@ -1432,7 +1432,7 @@ void ClientInterface::updateKeyframe(int frameCount) {
 
 	if(getQuit() == false && getQuitThread() == false) {
 		if(networkCommandListThread == NULL) {
-			static string mutexOwnerId 	= string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId 	= CODE_AT_LINE;
 			networkCommandListThread 	= new ClientInterfaceThread(this);
 			networkCommandListThread->setUniqueID(mutexOwnerId);
 			networkCommandListThread->start();
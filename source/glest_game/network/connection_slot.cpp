@@ -285,7 +285,7 @@ void ConnectionSlotThread::execute() {
 					}
 					//printf("#4 Checking action for slot: %d\n",slotIndex);
 
-					static string masterSlaveOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *masterSlaveOwnerId = CODE_AT_LINE;
 					MasterSlaveThreadControllerSafeWrapper safeMasterController(masterController,20000,masterSlaveOwnerId);
 					if(getQuitStatus() == true) {
 						if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
@@ -398,7 +398,7 @@ ConnectionSlot::ConnectionSlot(ServerInterface* serverInterface, int playerIndex
 
 	this->setSocket(NULL);
 	this->slotThreadWorker 					= NULL;
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	this->slotThreadWorker 					= new ConnectionSlotThread(this->serverInterface,playerIndex);
 	this->slotThreadWorker->setUniqueID(mutexOwnerId);
 	this->slotThreadWorker->start();
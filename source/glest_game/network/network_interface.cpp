@@ -79,33 +79,33 @@ NetworkInterface::~NetworkInterface() {
 }
 
 uint32 NetworkInterface::getNetworkPlayerFactionCRC(int index) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkPlayerFactionCRCMutex,mutexOwnerId);
 
 	return networkPlayerFactionCRC[index];
 }
 void NetworkInterface::setNetworkPlayerFactionCRC(int index, uint32 crc) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkPlayerFactionCRCMutex,mutexOwnerId);
 
 	networkPlayerFactionCRC[index]=crc;
 }
 
 void NetworkInterface::addChatInfo(const ChatMsgInfo &msg) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	chatTextList.push_back(msg);
 }
 
 void NetworkInterface::addMarkedCell(const MarkedCell &msg) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	markedCellList.push_back(msg);
 }
 void NetworkInterface::addUnMarkedCell(const UnMarkedCell &msg) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	unmarkedCellList.push_back(msg);
@@ -167,27 +167,27 @@ bool NetworkInterface::isConnected(){
 }
 
 void NetworkInterface::setLastPingInfo(const NetworkMessagePing &ping) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	this->lastPingInfo = ping;
 }
 
 void NetworkInterface::setLastPingInfoToNow() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	this->lastPingInfo.setPingReceivedLocalTime(time(NULL));
 }
 
 NetworkMessagePing NetworkInterface::getLastPingInfo() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	return lastPingInfo;
 }
 double NetworkInterface::getLastPingLag() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	return difftime((long int)time(NULL),lastPingInfo.getPingReceivedLocalTime());
@@ -212,7 +212,7 @@ void NetworkInterface::DisplayErrorMessage(string sErr, bool closeSocket) {
 std::vector<ChatMsgInfo> NetworkInterface::getChatTextList(bool clearList) {
 	std::vector<ChatMsgInfo> result;
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(chatTextList.empty() == false) {
@@ -226,7 +226,7 @@ std::vector<ChatMsgInfo> NetworkInterface::getChatTextList(bool clearList) {
 }
 
 void NetworkInterface::clearChatInfo() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(chatTextList.empty() == false) {
@@ -238,7 +238,7 @@ void NetworkInterface::clearChatInfo() {
 std::vector<MarkedCell> NetworkInterface::getMarkedCellList(bool clearList) {
 	std::vector<MarkedCell> result;
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(markedCellList.empty() == false) {
@@ -252,7 +252,7 @@ std::vector<MarkedCell> NetworkInterface::getMarkedCellList(bool clearList) {
 }
 
 void NetworkInterface::clearMarkedCellList() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(markedCellList.empty() == false) {
@@ -264,7 +264,7 @@ void NetworkInterface::clearMarkedCellList() {
 std::vector<UnMarkedCell> NetworkInterface::getUnMarkedCellList(bool clearList) {
 	std::vector<UnMarkedCell> result;
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(unmarkedCellList.empty() == false) {
@@ -278,7 +278,7 @@ std::vector<UnMarkedCell> NetworkInterface::getUnMarkedCellList(bool clearList)
 }
 
 void NetworkInterface::clearUnMarkedCellList() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(unmarkedCellList.empty() == false) {
@@ -290,7 +290,7 @@ void NetworkInterface::clearUnMarkedCellList() {
 std::vector<MarkedCell> NetworkInterface::getHighlightedCellList(bool clearList) {
 	std::vector<MarkedCell> result;
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(highlightedCellList.empty() == false) {
@@ -304,7 +304,7 @@ std::vector<MarkedCell> NetworkInterface::getHighlightedCellList(bool clearList)
 }
 
 void NetworkInterface::clearHighlightedCellList() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	if(highlightedCellList.empty() == false) {
@@ -314,7 +314,7 @@ void NetworkInterface::clearHighlightedCellList() {
 }
 
 void NetworkInterface::setHighlightedCell(const MarkedCell &msg){
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(networkAccessMutex,mutexOwnerId);
 
 	for(int idx = 0; idx < (int)highlightedCellList.size(); idx++) {
@@ -349,11 +349,11 @@ void GameNetworkInterface::requestCommand(const NetworkCommand *networkCommand,
 	Mutex *mutex = getServerSynchAccessor();
 
     if(insertAtStart == false) {
-    	MutexSafeWrapper safeMutex(mutex,string(__FILE__) + "_" + intToStr(__LINE__));
+    	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
         requestedCommands.push_back(*networkCommand);
     }
     else {
-    	MutexSafeWrapper safeMutex(mutex,string(__FILE__) + "_" + intToStr(__LINE__));
+    	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
         requestedCommands.insert(requestedCommands.begin(),*networkCommand);
     }
 }
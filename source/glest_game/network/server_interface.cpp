@@ -25,6 +25,7 @@
 #include "miniftpserver.h"
 #include "map_preview.h"
 #include "stats.h"
+#include "task_scheduler.h"
 #include <time.h>
 #include <set>
 #include <iostream>
@@ -83,7 +84,7 @@ ServerInterface::ServerInterface(bool publishEnabled, ClientLagCallbackInterface
 	currentFrameCount 				= 0;
 	gameStartTime 					= 0;
 	resumeGameStartTime				= 0;
-	publishToMasterserverThread 	= NULL;
+	publishToMasterserverTaskId 	= -1;
 	lastMasterserverHeartbeatTime 	= 0;
 	needToRepublishToMasterserver 	= false;
 	ftpServer 						= NULL;
@@ -221,12 +222,10 @@ ServerInterface::ServerInterface(bool publishEnabled, ClientLagCallbackInterface
 		ftpServer->start();
 	}
 
-	if(publishToMasterserverThread == NULL) {
+	if(publishToMasterserverTaskId < 0) {
 		if(needToRepublishToMasterserver == true || GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
-			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
-			publishToMasterserverThread = new SimpleTaskThread(this,0,125);
-			publishToMasterserverThread->setUniqueID(mutexOwnerId);
-			publishToMasterserverThread->start();
+			static const char *mutexOwnerId = CODE_AT_LINE;
+			publishToMasterserverTaskId = TaskScheduler::getInstance().scheduleTask(this,125,0,NULL,mutexOwnerId);
 
 			if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] needToRepublishToMasterserver = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,needToRepublishToMasterserver);
 		}
@@ -243,17 +242,14 @@ void ServerInterface::setPublishEnabled(bool value) {
 
 void ServerInterface::shutdownMasterserverPublishThread() {
 	MutexSafeWrapper safeMutex(masterServerThreadAccessor,CODE_AT_LINE);
+	int taskId = publishToMasterserverTaskId;
+	// A running publish needs the accessor to finish
+	safeMutex.ReleaseLock();
 
-	if(publishToMasterserverThread != NULL) {
-		time_t elapsed = time(NULL);
-		publishToMasterserverThread->signalQuit();
-		for(;publishToMasterserverThread->canShutdown(false) == false &&
-			difftime((long int)time(NULL),elapsed) <= 15;) {
-			//sleep(150);
-		}
-		if(publishToMasterserverThread->canShutdown(true)) {
-			delete publishToMasterserverThread;
-			publishToMasterserverThread = NULL;
+	if(taskId >= 0) {
+		if(TaskScheduler::getInstance().cancelTask(taskId,15000) == true) {
+			MutexSafeWrapper safeMutexTask(masterServerThreadAccessor,CODE_AT_LINE);
+			publishToMasterserverTaskId = -1;
 		}
 	}
 }
@@ -886,7 +882,7 @@ void ServerInterface::signalClientsToRecieveData(std::map<PLATFORM_SOCKET,bool>
 	//printf("====================================In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	//printf("Signal clients get new data\n");
-	const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
+	const bool newThreadManager = Config::getInstance().getSnapshot().enableNewThreadManager;
 	if(newThreadManager == true) {
 		masterController.clearSlaves(true);
 		std::vector<SlaveThreadControllerInterface *> slaveThreadList;
@@ -1062,7 +1058,7 @@ void ServerInterface::checkForCompletedClients(std::map<int,bool> & mapSlotSigna
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
+	const bool newThreadManager = Config::getInstance().getSnapshot().enableNewThreadManager;
 	if(newThreadManager == true) {
 		checkForCompletedClientsUsingThreadManager(mapSlotSignalledList, errorMsgList);
 	}
@@ -2374,14 +2370,12 @@ bool ServerInterface::launchGame(const GameSettings *gameSettings) {
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] needToRepublishToMasterserver = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,needToRepublishToMasterserver);
 
-		if(publishToMasterserverThread == NULL) {
+		if(publishToMasterserverTaskId < 0) {
 			if(needToRepublishToMasterserver == true ||
 				GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 
-				static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
-				publishToMasterserverThread = new SimpleTaskThread(this,0,125);
-				publishToMasterserverThread->setUniqueID(mutexOwnerId);
-				publishToMasterserverThread->start();
+				static const char *mutexOwnerId = CODE_AT_LINE;
+				publishToMasterserverTaskId = TaskScheduler::getInstance().scheduleTask(this,125,0,NULL,mutexOwnerId);
 
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] needToRepublishToMasterserver = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,needToRepublishToMasterserver);
 			}
@@ -2895,7 +2889,7 @@ std::map<string,string> ServerInterface::publishToMasterserver() {
 	publishToServerInfo["privacyPlease"] 		= intToStr(config.getBool("PrivacyPlease","false"));
 	publishToServerInfo["gameStatus"] 			= intToStr(game_status_in_progress);
 
-	if(publishToMasterserverThread == NULL) {
+	if(publishToMasterserverTaskId < 0) {
 		publishToServerInfo["gameCmd"]		= "gameOver";
 		publishToServerInfo["gameStatus"] 	= intToStr(game_status_finished);
 	}
@@ -2963,7 +2957,7 @@ void ServerInterface::simpleTask(BaseThread *callingThread,void *userdata) {
 	if(difftime((long int)time(NULL),lastMasterserverHeartbeatTime) >= MASTERSERVER_HEARTBEAT_GAME_STATUS_SECONDS) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Checking to see masterserver needs an update of the game status [%d] callingThread [%p] publishToMasterserverThread [%p]\n",needToRepublishToMasterserver,callingThread,publishToMasterserverThread);
+		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Checking to see masterserver needs an update of the game status [%d] callingThread [%p] publishToMasterserverTaskId [%d]\n",needToRepublishToMasterserver,callingThread,publishToMasterserverTaskId);
 
 		lastMasterserverHeartbeatTime = time(NULL);
 		if(needToRepublishToMasterserver == true) {
@@ -66,7 +66,8 @@ private:
 
 	time_t lastGlobalLagCheckTime;
 
-	SimpleTaskThread *publishToMasterserverThread;
+	// TaskScheduler task publishing to the masterserver, -1 when not running
+	int publishToMasterserverTaskId;
 	Mutex *masterServerThreadAccessor;
 	time_t lastMasterserverHeartbeatTime;
 	bool needToRepublishToMasterserver;
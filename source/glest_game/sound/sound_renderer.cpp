@@ -55,7 +55,7 @@ bool SoundRenderer::init(Window *window) {
 	cleanup();
 	stopAllSounds();
 
-    MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
 	if(runThreadSafe == true) {
 	    safeMutex.setMutex(mutex);
 	}
@@ -81,7 +81,7 @@ void SoundRenderer::cleanup() {
 
     if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-    MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+    MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
 	if(runThreadSafe == true) {
 	    safeMutex.setMutex(mutex);
 	}
@@ -124,7 +124,7 @@ SoundRenderer &SoundRenderer::getInstance() {
 
 void SoundRenderer::update() {
     if(wasInitOk() == true && soundPlayer != NULL) {
-        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
     	if(runThreadSafe == true) {
     	    safeMutex.setMutex(mutex);
     	}
@@ -141,7 +141,7 @@ void SoundRenderer::playMusic(StrSound *strSound) {
 		strSound->setVolume(musicVolume);
 		strSound->restart();
 		if(soundPlayer != NULL) {
-	        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+	        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
             if(runThreadSafe == true) {
                 safeMutex.setMutex(mutex);
             }
@@ -161,7 +161,7 @@ void SoundRenderer::setMusicVolume(StrSound *strSound) {
 
 void SoundRenderer::stopMusic(StrSound *strSound) {
     if(soundPlayer != NULL) {
-        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
     	if(runThreadSafe == true) {
     	    safeMutex.setMutex(mutex);
     	}
@@ -190,7 +190,7 @@ void SoundRenderer::playFx(StaticSound *staticSound, Vec3f soundPos, Vec3f camPo
 			staticSound->setVolume(correctedVol);
 
 			if(soundPlayer != NULL) {
-		        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+		        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
                 if(runThreadSafe == true) {
                     safeMutex.setMutex(mutex);
                 }
@@ -207,7 +207,7 @@ void SoundRenderer::playFx(StaticSound *staticSound) {
 	if(staticSound!=NULL){
 		staticSound->setVolume(fxVolume);
 		if(soundPlayer != NULL) {
-	        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+	        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
             if(runThreadSafe == true) {
                 safeMutex.setMutex(mutex);
             }
@@ -225,7 +225,7 @@ void SoundRenderer::playAmbient(StrSound *strSound) {
 	if(strSound != NULL) {
 		strSound->setVolume(ambientVolume);
 		if(soundPlayer != NULL) {
-	        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+	        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
             if(runThreadSafe == true) {
                 safeMutex.setMutex(mutex);
             }
@@ -239,7 +239,7 @@ void SoundRenderer::playAmbient(StrSound *strSound) {
 
 void SoundRenderer::stopAmbient(StrSound *strSound) {
     if(soundPlayer != NULL) {
-        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
     	if(runThreadSafe == true) {
     	    safeMutex.setMutex(mutex);
     	}
@@ -254,7 +254,7 @@ void SoundRenderer::stopAmbient(StrSound *strSound) {
 
 void SoundRenderer::stopAllSounds(int64 fadeOff) {
     if(soundPlayer != NULL) {
-        MutexSafeWrapper safeMutex(NULL,string(__FILE__) + "_" + intToStr(__LINE__));
+        MutexSafeWrapper safeMutex(NULL,CODE_AT_LINE);
     	if(runThreadSafe == true) {
     	    safeMutex.setMutex(mutex);
     	}
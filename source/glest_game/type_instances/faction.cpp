@@ -156,7 +156,7 @@ bool CommandGroupUnitSorter::compare(const Unit *l, const Unit *r) {
 }
 
 void Faction::sortUnitsByCommandGroups() {
-	MutexSafeWrapper safeMutex(unitsMutex,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(unitsMutex,CODE_AT_LINE);
 	//printf("====== sortUnitsByCommandGroups for faction # %d [%s] unitCount = %d\n",this->getIndex(),this->getType()->getName().c_str(),units.size());
 	//for(unsigned int i = 0; i < units.size(); ++i) {
 	//	printf("%d / %d [%p] <>",i,units.size(),&units[i]);
@@ -205,6 +205,11 @@ void Faction::sortUnitsByCommandGroups() {
 		units.push_back(this->findUnit(unitId));
 	}
 
+	UnitRegistry *unitRegistry = world->getUnitRegistry();
+	for(unsigned int i = 0; i < units.size(); ++i) {
+		unitRegistry->setUnitIndex(units[i]->getId(), i);
+	}
+
 	//assert(originalUnitSize == units.size());
 }
 
@@ -239,7 +244,7 @@ void FactionThread::setQuitStatus(bool value) {
 
 void FactionThread::signalPathfinder(int frameIndex) {
 	if(frameIndex >= 0) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
 		this->frameIndex.first = frameIndex;
 		this->frameIndex.second = false;
@@ -251,7 +256,7 @@ void FactionThread::signalPathfinder(int frameIndex) {
 
 void FactionThread::setTaskCompleted(int frameIndex) {
 	if(frameIndex >= 0) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
 		if(this->frameIndex.first == frameIndex) {
 			this->frameIndex.second = true;
@@ -275,7 +280,7 @@ bool FactionThread::isSignalPathfinderCompleted(int frameIndex) {
 	if(getRunningStatus() == false) {
 		return true;
 	}
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
 	//bool result = (event != NULL ? event->eventCompleted : true);
 	bool result = (this->frameIndex.first == frameIndex && this->frameIndex.second == true);
@@ -309,7 +314,7 @@ void FactionThread::execute() {
 
 			codeLocation = "3";
 			//printf("In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
-			static string masterSlaveOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *masterSlaveOwnerId = CODE_AT_LINE;
 			MasterSlaveThreadControllerSafeWrapper safeMasterController(masterController,20000,masterSlaveOwnerId);
 			//printf("In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
@@ -318,7 +323,7 @@ void FactionThread::execute() {
 				break;
 			}
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
             MutexSafeWrapper safeMutex(triggerIdMutex,mutexOwnerId);
             bool executeTask = (this->frameIndex.first >= 0);
 			int currentTriggeredFrameIndex = this->frameIndex.first;
@@ -351,7 +356,7 @@ void FactionThread::execute() {
 				}
 
 				codeLocation = "8";
-				static string mutexOwnerId2 = string(__FILE__) + string("_") + intToStr(__LINE__);
+				static const char *mutexOwnerId2 = CODE_AT_LINE;
 				MutexSafeWrapper safeMutex(faction->getUnitMutex(),mutexOwnerId2);
 
 				//if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
@@ -492,6 +497,10 @@ void Faction::init() {
 	thisFaction=false;
 	currentSwitchTeamVoteFactionIndex = -1;
 	allowSharedTeamUnits = false;
+	unitStateVersion = 0;
+	aliveUnitCount = 0;
+	mobileUnitCount = 0;
+	beingBuiltUnitCount = 0;
 
 	loadWorldNode = NULL;
 	techTree = NULL;
@@ -522,7 +531,7 @@ Faction::~Faction() {
 		workerThread = NULL;
 	}
 
-	MutexSafeWrapper safeMutex(unitsMutex,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(unitsMutex,CODE_AT_LINE);
 	deleteValues(units.begin(), units.end());
 	units.clear();
 
@@ -549,7 +558,7 @@ void Faction::end() {
 		workerThread = NULL;
 	}
 
-	MutexSafeWrapper safeMutex(unitsMutex,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(unitsMutex,CODE_AT_LINE);
 	deleteValues(units.begin(), units.end());
 	units.clear();
 
@@ -558,58 +567,95 @@ void Faction::end() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 }
 
+void Faction::setUnitRegistryFlags(const Unit *unit, uint8 flags) {
+	if(world == NULL) {
+		return;
+	}
+	UnitRegistry *unitRegistry = world->getUnitRegistry();
+	uint8 oldFlags = unitRegistry->setFlags(unit->getId(), flags);
+	// Units still being created are counted once they are added
+	if(unitRegistry->find(unit->getId()) == unit) {
+		applyUnitRegistryFlags(oldFlags, -1);
+		applyUnitRegistryFlags(flags, 1);
+	}
+}
+
+void Faction::applyUnitRegistryFlags(uint8 flags, int delta) {
+	if(flags & urfAlive) {
+		aliveUnitCount += delta;
+	}
+	if(flags & urfMobile) {
+		mobileUnitCount += delta;
+	}
+	if(flags & urfBeingBuilt) {
+		beingBuiltUnitCount += delta;
+	}
+}
+
 void Faction::notifyUnitAliveStatusChange(const Unit *unit) {
 	if(unit != NULL) {
+		unitStateVersion++;
+		uint8 flags = (world != NULL ? world->getUnitRegistry()->getFlags(unit->getId()) : 0);
 		if(unit->isAlive() == true) {
-			aliveUnitListCache[unit->getId()] = unit;
+			flags |= urfAlive;
 
 			if(unit->getType()->isMobile() == true) {
-				mobileUnitListCache[unit->getId()] = unit;
+				flags |= urfMobile;
 			}
 		}
 		else {
-			aliveUnitListCache.erase(unit->getId());
-			mobileUnitListCache.erase(unit->getId());
-			beingBuiltUnitListCache.erase(unit->getId());
+			flags = 0;
 		}
+		setUnitRegistryFlags(unit, flags);
 	}
 }
 
 void Faction::notifyUnitTypeChange(const Unit *unit, const UnitType *newType) {
 	if(unit != NULL) {
+		unitStateVersion++;
+		uint8 flags = (world != NULL ? world->getUnitRegistry()->getFlags(unit->getId()) : 0);
 		if(unit->getType()->isMobile() == true) {
-			mobileUnitListCache.erase(unit->getId());
+			flags &= ~urfMobile;
 		}
 
 		if(newType != NULL && newType->isMobile() == true) {
-			mobileUnitListCache[unit->getId()] = unit;
+			flags |= urfMobile;
 		}
+		setUnitRegistryFlags(unit, flags);
 	}
 }
 
 void Faction::notifyUnitSkillTypeChange(const Unit *unit, const SkillType *newType) {
 	if(unit != NULL) {
+		uint8 flags = (world != NULL ? world->getUnitRegistry()->getFlags(unit->getId()) : 0);
 		if(unit->isBeingBuilt() == true) {
-			beingBuiltUnitListCache.erase(unit->getId());
+			flags &= ~urfBeingBuilt;
 		}
 		if(newType != NULL && newType->getClass() == scBeBuilt) {
-			beingBuiltUnitListCache[unit->getId()] = unit;
+			flags |= urfBeingBuilt;
 		}
+		setUnitRegistryFlags(unit, flags);
+	}
+}
+
+void Faction::notifyUnitCommandChange(const Unit *unit) {
+	if(unit != NULL) {
+		unitStateVersion++;
 	}
 }
 
 bool Faction::hasAliveUnits(bool filterMobileUnits, bool filterBuiltUnits) const {
 	bool result = false;
-	if(aliveUnitListCache.empty() == false) {
+	if(aliveUnitCount > 0) {
 		if(filterMobileUnits == true) {
-			result = (mobileUnitListCache.empty() == false);
+			result = (mobileUnitCount > 0);
 		}
 		else {
 			result = true;
 		}
 
 		if(result == true && filterBuiltUnits == true) {
-			result = (beingBuiltUnitListCache.empty() == true);
+			result = (beingBuiltUnitCount == 0);
 		}
 	}
 	return result;
@@ -758,7 +804,7 @@ void Faction::init(
 			}
 			workerThread = NULL;
 		}
-		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		this->workerThread = new FactionThread(this);
 		this->workerThread->setUniqueID(mutexOwnerId);
 		this->workerThread->start();
@@ -1322,36 +1368,46 @@ void Faction::setResourceBalance(const ResourceType *rt, int balance){
 }
 
 Unit *Faction::findUnit(int id) const {
-	UnitMap::const_iterator itFound = unitMap.find(id);
-	if(itFound == unitMap.end()) {
+	if(world == NULL) {
+		return NULL;
+	}
+	Unit *unit = world->getUnitRegistry()->find(id);
+	if(unit == NULL || unit->getFaction() != this) {
 		return NULL;
 	}
-	return itFound->second;
+	return unit;
 }
 
 void Faction::addUnit(Unit *unit) {
-	MutexSafeWrapper safeMutex(unitsMutex,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(unitsMutex,CODE_AT_LINE);
+	UnitRegistry *unitRegistry = world->getUnitRegistry();
+	bool registered = (unitRegistry->find(unit->getId()) == unit);
 	units.push_back(unit);
-	unitMap[unit->getId()] = unit;
+	unitRegistry->add(unit, (int)units.size() - 1);
+	if(registered == false) {
+		applyUnitRegistryFlags(unitRegistry->getFlags(unit->getId()), 1);
+	}
+	unitStateVersion++;
 }
 
 void Faction::removeUnit(Unit *unit){
-	MutexSafeWrapper safeMutex(unitsMutex,string(__FILE__) + "_" + intToStr(__LINE__));
-
-	assert(units.size()==unitMap.size());
+	MutexSafeWrapper safeMutex(unitsMutex,CODE_AT_LINE);
 
+	UnitRegistry *unitRegistry = world->getUnitRegistry();
 	int unitId = unit->getId();
-	for(int i=0; i < (int)units.size(); ++i) {
-		if(units[i]->getId() == unitId) {
-			units.erase(units.begin()+i);
-			unitMap.erase(unitId);
-			assert(units.size() == unitMap.size());
-			return;
-		}
+	int unitIndex = unitRegistry->getUnitIndex(unitId);
+	if(unitIndex < 0 || unitIndex >= (int)units.size() || units[unitIndex] != unit) {
+		throw megaglest_runtime_error("Could not remove unit from faction!");
 	}
 
-	throw megaglest_runtime_error("Could not remove unit from faction!");
-	//assert(false);
+	// The update order of the remaining units must not change, it is
+	// part of the simulation every peer runs, so shift the tail down
+	units.erase(units.begin() + unitIndex);
+	for(int index = unitIndex; index < (int)units.size(); ++index) {
+		unitRegistry->setUnitIndex(units[index]->getId(), index);
+	}
+	applyUnitRegistryFlags(unitRegistry->remove(unitId), -1);
+	unitStateVersion++;
 }
 
 void Faction::addStore(const UnitType *unitType) {
@@ -2107,10 +2163,6 @@ void Faction::clearCaches() {
 	cacheResourceTargetList.clear();
 	cachedCloseResourceTargetLookupList.clear();
 
-	//aliveUnitListCache.clear();
-	//mobileUnitListCache.clear();
-	//beingBuiltUnitListCache.clear();
-
 	unsigned int unitCount = this->getUnitCount();
 	for(unsigned int i = 0; i < unitCount; ++i) {
 		Unit *unit = this->getUnit(i);
@@ -2135,18 +2187,9 @@ uint64 Faction::getCacheKBytes(uint64 *cache1Size, uint64 *cache2Size, uint64 *c
 		iterMap1 != cachedCloseResourceTargetLookupList.end(); ++iterMap1) {
 		cache2Count++;
 	}
-	for(std::map<int,const Unit *>::iterator iterMap1 = aliveUnitListCache.begin();
-		iterMap1 != aliveUnitListCache.end(); ++iterMap1) {
-		cache3Count++;
-	}
-	for(std::map<int,const Unit *>::iterator iterMap1 = mobileUnitListCache.begin();
-		iterMap1 != mobileUnitListCache.end(); ++iterMap1) {
-		cache4Count++;
-	}
-	for(std::map<int,const Unit *>::iterator iterMap1 = beingBuiltUnitListCache.begin();
-		iterMap1 != beingBuiltUnitListCache.end(); ++iterMap1) {
-		cache5Count++;
-	}
+	cache3Count = aliveUnitCount;
+	cache4Count = mobileUnitCount;
+	cache5Count = beingBuiltUnitCount;
 
 	if(cache1Size) {
 		*cache1Size = cache1Count;
@@ -2166,9 +2209,7 @@ uint64 Faction::getCacheKBytes(uint64 *cache1Size, uint64 *cache2Size, uint64 *c
 
 	uint64 totalBytes = cache1Count * sizeof(int);
 	totalBytes += cache2Count * sizeof(bool);
-	totalBytes += cache3Count * (sizeof(int) + sizeof(const Unit *));
-	totalBytes += cache4Count * (sizeof(int) + sizeof(const Unit *));
-	totalBytes += cache5Count * (sizeof(int) + sizeof(const Unit *));
+	// The unit flags live in the world's unit registry
 
 	totalBytes /= 1000;
 
@@ -54,8 +54,10 @@ class SurfaceCell;
 
 class FowAlphaCellsLookupItem {
 public:
+	typedef std::vector<std::pair<Vec2i,float> > SurfPosAlphaList;
 
-	std::map<Vec2i,float> surfPosAlphaList;
+	// One entry per surface cell, sorted by position
+	SurfPosAlphaList surfPosAlphaList;
 };
 
 class ExploredCellsLookupItem {
@@ -128,7 +130,6 @@ private:
     typedef vector<Resource> Store;
 	typedef vector<Faction*> Allies;
 	typedef vector<Unit*> Units;
-	typedef map<int, Unit*> UnitMap;
 
 private:
 	UpgradeManager upgradeManager; 
@@ -139,7 +140,6 @@ private:
 
 	Mutex *unitsMutex;
 	Units units;
-	UnitMap unitMap;
 	World *world;
 	ScriptManager *scriptManager;
 	
@@ -183,12 +183,20 @@ private:
 
 	std::map<int,string> crcWorldFrameDetails;
 
-	std::map<int,const Unit *> aliveUnitListCache;
-	std::map<int,const Unit *> mobileUnitListCache;
-	std::map<int,const Unit *> beingBuiltUnitListCache;
+	// Units of this faction with each UnitRegistryFlag set
+	int aliveUnitCount;
+	int mobileUnitCount;
+	int beingBuiltUnitCount;
 
 	std::map<std::string, bool> resourceTypeCostCache;
 
+	// Bumped whenever a unit is added, removed, morphed, killed or has its
+	// command queue changed so AI views can tell when to rebuild
+	unsigned int unitStateVersion;
+
+	void setUnitRegistryFlags(const Unit *unit, uint8 flags);
+	void applyUnitRegistryFlags(uint8 flags, int delta);
+
 public:
 	Faction();
 	~Faction();
@@ -205,6 +213,8 @@ public:
 	void notifyUnitAliveStatusChange(const Unit *unit);
 	void notifyUnitTypeChange(const Unit *unit, const UnitType *newType);
 	void notifyUnitSkillTypeChange(const Unit *unit, const SkillType *newType);
+	void notifyUnitCommandChange(const Unit *unit);
+	inline unsigned int getUnitStateVersion() const { return unitStateVersion; }
 	bool hasAliveUnits(bool filterMobileUnits, bool filterBuiltUnits) const;
 
 	inline void addWorldSynchThreadedLogList(const string &data) {
@@ -107,7 +107,7 @@ void Object::initParticles() {
 }
 
 void Object::initParticlesFromTypes(const ModelParticleSystemTypes *particleTypes) {
-	bool showTilesetParticles = Config::getInstance().getBool("TilesetParticles", "true");
+	bool showTilesetParticles = Config::getInstance().getSnapshot().tilesetParticles;
 	if(showTilesetParticles == true && GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false &&
 			particleTypes->empty() == false && unitParticleSystems.empty() == true) {
 		for(ObjectParticleSystemTypes::const_iterator it= particleTypes->begin(); it != particleTypes->end(); ++it){
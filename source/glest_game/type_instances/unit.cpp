@@ -35,40 +35,29 @@ using namespace Shared::Util;
 
 namespace Glest{ namespace Game{
 
+// Orders the stores before a pointer is published to other threads
+#ifdef WIN32
+static inline void publishBarrier() {
+	MemoryBarrier();
+}
+#else
+static inline void publishBarrier() {
+	__sync_synchronize();
+}
+#endif
+
 const int CHANGE_COMMAND_SPEED 					= 325;
 const uint32 MIN_FRAMECOUNT_CHANGE_COMMAND_SPEED	= 160;
 
 //Mutex Unit::mutexDeletedUnits;
 //map<void *,bool> Unit::deletedUnits;
 
-const int UnitPathBasic::maxBlockCount= GameConstants::updateFps / 2;
-
 #ifdef LEAK_CHECK_UNITS
-std::map<UnitPathBasic *,bool> UnitPathBasic::mapMemoryList;
 std::map<Unit *,bool> Unit::mapMemoryList;
 std::map<UnitPathInterface *,int> Unit::mapMemoryList2;
 #endif
 
-UnitPathBasic::UnitPathBasic() : UnitPathInterface() {
-#ifdef LEAK_CHECK_UNITS
-	UnitPathBasic::mapMemoryList[this]=true;
-#endif
-
-	this->blockCount = 0;
-	this->pathQueue.clear();
-	this->map = NULL;
-}
-
-UnitPathBasic::~UnitPathBasic() {
-	this->blockCount = 0;
-	this->pathQueue.clear();
-	this->map = NULL;
-
-#ifdef LEAK_CHECK_UNITS
-	UnitPathBasic::mapMemoryList.erase(this);
-#endif
-}
-
+// Needs the owner units, so it is not in unit_path.cpp
 #ifdef LEAK_CHECK_UNITS
 void UnitPathBasic::dumpMemoryList() {
 	printf("===== START report of Unfreed UnitPathBasic pointers =====\n");
@@ -83,133 +72,6 @@ void UnitPathBasic::dumpMemoryList() {
 }
 #endif
 
-void UnitPathBasic::clearCaches() {
-	this->blockCount = 0;
-	this->pathQueue.clear();
-}
-
-bool UnitPathBasic::isEmpty() const {
-	return pathQueue.empty();
-}
-
-bool UnitPathBasic::isBlocked() const {
-	return blockCount >= maxBlockCount;
-}
-
-bool UnitPathBasic::isStuck() const {
-	return (isBlocked() == true && blockCount >= (maxBlockCount * 2));
-}
-
-void UnitPathBasic::clear() {
-	pathQueue.clear();
-	blockCount= 0;
-}
-
-void UnitPathBasic::incBlockCount() {
-	pathQueue.clear();
-	blockCount++;
-}
-
-void UnitPathBasic::add(const Vec2i &path) {
-	if(this->map != NULL) {
-		if(this->map->isInside(path) == false) {
-			throw megaglest_runtime_error("Invalid map path position = " + path.getString() + " map w x h = " + intToStr(map->getW()) + " " + intToStr(map->getH()));
-		}
-		else if(this->map->isInsideSurface(this->map->toSurfCoords(path)) == false) {
-			throw megaglest_runtime_error("Invalid map surface path position = " + path.getString() + " map surface w x h = " + intToStr(map->getSurfaceW()) + " " + intToStr(map->getSurfaceH()));
-		}
-	}
-
-	pathQueue.push_back(path);
-}
-
-Vec2i UnitPathBasic::pop(bool removeFrontPos) {
-	if(pathQueue.empty() == true) {
-		throw megaglest_runtime_error("pathQueue.size() = " + intToStr(pathQueue.size()));
-	}
-	Vec2i p= pathQueue.front();
-	if(removeFrontPos == true) {
-		pathQueue.erase(pathQueue.begin());
-	}
-	return p;
-}
-std::string UnitPathBasic::toString() const {
-	std::string result = "unit path blockCount = " + intToStr(blockCount) + "\npathQueue size = " + intToStr(pathQueue.size());
-	for(int idx = 0; idx < (int)pathQueue.size(); ++idx) {
-		result += " index = " + intToStr(idx) + " value = " + pathQueue[idx].getString();
-	}
-
-	return result;
-}
-
-void UnitPathBasic::saveGame(XmlNode *rootNode) {
-	std::map<string,string> mapTagReplacements;
-	XmlNode *unitPathBasicNode = rootNode->addChild("UnitPathBasic");
-
-//	int blockCount;
-	unitPathBasicNode->addAttribute("blockCount",intToStr(blockCount), mapTagReplacements);
-//	vector<Vec2i> pathQueue;
-	for(unsigned int i = 0; i < pathQueue.size(); ++i) {
-		Vec2i &vec = pathQueue[i];
-
-		XmlNode *pathQueueNode = unitPathBasicNode->addChild("pathQueue");
-		pathQueueNode->addAttribute("vec",vec.getString(), mapTagReplacements);
-	}
-}
-
-void UnitPathBasic::loadGame(const XmlNode *rootNode) {
-	const XmlNode *unitPathBasicNode = rootNode->getChild("UnitPathBasic");
-
-	blockCount = unitPathBasicNode->getAttribute("blockCount")->getIntValue();
-
-	pathQueue.clear();
-	vector<XmlNode *> pathqueueNodeList = unitPathBasicNode->getChildList("pathQueue");
-	for(unsigned int i = 0; i < pathqueueNodeList.size(); ++i) {
-		XmlNode *node = pathqueueNodeList[i];
-
-		Vec2i vec = Vec2i::strToVec2(node->getAttribute("vec")->getValue());
-		pathQueue.push_back(vec);
-	}
-}
-
-Checksum UnitPathBasic::getCRC() {
-	Checksum crcForPath;
-
-	crcForPath.addInt(blockCount);
-	crcForPath.addInt((int)pathQueue.size());
-
-	return crcForPath;
-}
-
-// =====================================================
-// 	class UnitPath
-// =====================================================
-
-void WaypointPath::condense() {
-	if (size() < 2) {
-		return;
-	}
-	iterator prev, curr;
-	prev = curr = begin();
-	while (++curr != end()) {
-		if (prev->dist(*curr) < 3.f) {
-			prev = erase(prev);
-		} else {
-			++prev;
-		}
-	}
-}
-
-std::string UnitPath::toString() const {
-	std::string result = "unit path blockCount = " + intToStr(blockCount) + " pathQueue size = " + intToStr(size());
-	result += " path = ";
-	for (const_iterator it = begin(); it != end(); ++it) {
-		result += " [" + intToStr(it->x) + "," + intToStr(it->y) + "]";
-	}
-
-	return result;
-}
-
 // =====================================================
 // 	class UnitReference
 // =====================================================
@@ -322,7 +184,7 @@ void UnitAttackBoostEffect::setSource(const Unit *unit) {
 
 void UnitAttackBoostEffect::applyLoadedAttackBoostParticles(UnitParticleSystemType *upstPtr,const XmlNode *node, Unit* unit) {
 	if (upstPtr != NULL) {
-		bool showUnitParticles = Config::getInstance().getBool("UnitParticles","true");
+		bool showUnitParticles = Config::getInstance().getSnapshot().unitParticles;
 		if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				showUnitParticles = false;
 			}
@@ -520,11 +382,11 @@ Unit::Unit(int id, UnitPathInterface *unitpath, const Vec2i &pos,
 #endif
 
 	mutexCommands = new Mutex(CODE_AT_LINE);
+	coldState = NULL;
 	changedActiveCommand = false;
 	lastChangedActiveCommandFrame = 0;
 	changedActiveCommandFrame = 0;
 
-	lastSynchDataString="";
 	modelFacing = CardinalDir::NORTH;
 	lastStuckFrame = 0;
 	lastStuckPos = Vec2i(0,0);
@@ -537,11 +399,6 @@ Unit::Unit(int id, UnitPathInterface *unitpath, const Vec2i &pos,
 	causeOfDeath = ucodNone;
 	pathfindFailedConsecutiveFrameCount = 0;
 
-	lastSynchDataString = "";
-	lastFile = "";
-	lastLine = 0;
-	lastSource = "";
-
 	targetRotationZ=.0f;
 	targetRotationX=.0f;
 	rotationZ=.0f;
@@ -573,6 +430,7 @@ Unit::Unit(int id, UnitPathInterface *unitpath, const Vec2i &pos,
 	this->targetVec   = Vec3f(0.0);
 	this->targetPos   = Vec2i(0);
 	this->lastRenderFrame = 0;
+	this->visibilityGridItem = -1;
 	this->visible = true;
 	this->retryCurrCommandCount=0;
 	this->screenPos = Vec3f(0.0);
@@ -648,7 +506,7 @@ Unit::Unit(int id, UnitPathInterface *unitpath, const Vec2i &pos,
 	calculateFogOfWarRadius();
 
 //	if(isUnitDeleted(this) == true) {
-//		MutexSafeWrapper safeMutex(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
+//		MutexSafeWrapper safeMutex(&mutexDeletedUnits,CODE_AT_LINE);
 //		deletedUnits.erase(this);
 //	}
 
@@ -656,13 +514,11 @@ Unit::Unit(int id, UnitPathInterface *unitpath, const Vec2i &pos,
 }
 
 Unit::~Unit() {
-	badHarvestPosList.clear();
-
 	this->faction->deleteLivingUnits(id);
 	this->faction->deleteLivingUnitsp(this);
 
 	//remove commands
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	changedActiveCommand = false;
@@ -701,9 +557,12 @@ Unit::~Unit() {
 		game->removeUnitFromSelection(this);
 	}
 
-	//MutexSafeWrapper safeMutex1(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
+	//MutexSafeWrapper safeMutex1(&mutexDeletedUnits,CODE_AT_LINE);
 	//deletedUnits[this]=true;
 
+	delete coldState;
+	coldState = NULL;
+
 	delete mutexCommands;
 	mutexCommands=NULL;
 
@@ -777,33 +636,61 @@ bool Unit::isNetworkCRCEnabled() {
 	return isNetworkCRCEnabled;
 }
 
+UnitColdState * Unit::getColdState() {
+	if(coldState == NULL) {
+		// Synch logging may reach here from the faction threads
+		static const char *mutexOwnerId = CODE_AT_LINE;
+		MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
+		if(coldState == NULL) {
+			UnitColdState *newColdState = new UnitColdState();
+			// Other threads check coldState without the lock, the
+			// state must be complete before they can see it
+			publishBarrier();
+			coldState = newColdState;
+		}
+	}
+	return coldState;
+}
+
+void Unit::setCurrentUnitTitle(string value) {
+	if(coldState != NULL || value != "") {
+		getColdState()->currentUnitTitle = value;
+	}
+}
+
+void Unit::setNetworkCRCParticleLogInfo(string networkCRCParticleLogInfo) {
+	if(coldState != NULL || networkCRCParticleLogInfo != "") {
+		getColdState()->networkCRCParticleLogInfo = networkCRCParticleLogInfo;
+	}
+}
+
 void Unit::clearNetworkCRCDecHpList() {
-	if(networkCRCDecHpList.empty() == false) {
-		networkCRCDecHpList.clear();
+	if(coldState != NULL && coldState->networkCRCDecHpList.empty() == false) {
+		coldState->networkCRCDecHpList.clear();
 	}
 }
 void Unit::clearParticleInfo() {
-	if(networkCRCParticleInfoList.empty() == false) {
-		networkCRCParticleInfoList.clear();
+	if(coldState != NULL && coldState->networkCRCParticleInfoList.empty() == false) {
+		coldState->networkCRCParticleInfoList.clear();
 	}
 }
 
 void Unit::addNetworkCRCDecHp(string info) {
 	if(isNetworkCRCEnabled() == true) {
-		networkCRCDecHpList.push_back(info);
+		getColdState()->networkCRCDecHpList.push_back(info);
 	}
 }
 
 void Unit::logParticleInfo(string info) {
 	if(isNetworkCRCEnabled() == true) {
-		networkCRCParticleInfoList.push_back(info);
+		getColdState()->networkCRCParticleInfoList.push_back(info);
 	}
 }
 string Unit::getParticleInfo() const {
 	string result = "";
-	if(networkCRCParticleInfoList.empty() == false) {
-		for(unsigned int index = 0; index < networkCRCParticleInfoList.size(); ++index) {
-			result += networkCRCParticleInfoList[index] + "|";
+	if(coldState != NULL && coldState->networkCRCParticleInfoList.empty() == false) {
+		for(unsigned int index = 0; index < coldState->networkCRCParticleInfoList.size(); ++index) {
+			result += coldState->networkCRCParticleInfoList[index] + "|";
 		}
 	}
 	return result;
@@ -844,7 +731,7 @@ void Unit::end(ParticleSystem *particleSystem) {
 
 //bool Unit::isUnitDeleted(void *unit) {
 //	bool result = false;
-//	MutexSafeWrapper safeMutex(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
+//	MutexSafeWrapper safeMutex(&mutexDeletedUnits,CODE_AT_LINE);
 //	if(deletedUnits.find(unit) != deletedUnits.end()) {
 //		result = true;
 //	}
@@ -870,7 +757,7 @@ void Unit::setCurrField(Field currField) {
 // ====================================== get ======================================
 
 Vec2i Unit::getCenteredPos() const {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	if(type == NULL) {
@@ -883,7 +770,7 @@ Vec2i Unit::getCenteredPos() const {
 }
 
 Vec2f Unit::getFloatCenteredPos() const {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	if(type == NULL) {
@@ -1375,7 +1262,7 @@ void Unit::setPos(const Vec2i &pos, bool clearPathFinder) {
 		throw megaglest_runtime_error("#3 Invalid path position = " + pos.getString());
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	if(clearPathFinder == true && this->unitPath != NULL) {
@@ -1412,6 +1299,12 @@ FowAlphaCellsLookupItem Unit::getFogOfWarRadius(bool useCache) const {
 	int radius = sightRange + World::indirectSightRange;
 	PosCircularIterator pci(map, this->getPosNotThreadSafe(), radius);
 	FowAlphaCellsLookupItem result;
+
+	// Several cells share a surface cell and the last one wins, collect
+	// them in visit order and keep the last per surface cell
+	FowAlphaCellsLookupItem::SurfPosAlphaList visited;
+	Vec2i minSurfPos = Map::toSurfCoords(this->getPosNotThreadSafe());
+	Vec2i maxSurfPos = minSurfPos;
 	while(pci.next()){
 		const Vec2i sightpos= pci.getPos();
 		Vec2i surfPos= Map::toSurfCoords(sightpos);
@@ -1435,7 +1328,30 @@ FowAlphaCellsLookupItem Unit::getFogOfWarRadius(bool useCache) const {
 		if(dist > sightRange) {
 			alpha= clamp(1.f-(dist - sightRange) / (World::indirectSightRange), 0.f, maxAlpha);
 		}
-		result.surfPosAlphaList[surfPos] = alpha;
+		visited.push_back(std::make_pair(surfPos, alpha));
+		minSurfPos = Vec2i(min(minSurfPos.x, surfPos.x), min(minSurfPos.y, surfPos.y));
+		maxSurfPos = Vec2i(max(maxSurfPos.x, surfPos.x), max(maxSurfPos.y, surfPos.y));
+	}
+
+	int surfW = maxSurfPos.x - minSurfPos.x + 1;
+	int surfH = maxSurfPos.y - minSurfPos.y + 1;
+	vector<int> lastVisit(surfW * surfH, -1);
+	int surfCellCount = 0;
+	for(int index = 0; index < (int)visited.size(); ++index) {
+		const Vec2i &surfPos = visited[index].first;
+		int &visit = lastVisit[(surfPos.x - minSurfPos.x) * surfH + (surfPos.y - minSurfPos.y)];
+		if(visit < 0) {
+			surfCellCount++;
+		}
+		visit = index;
+	}
+
+	// Same order as Vec2i::operator<, x then y
+	result.surfPosAlphaList.reserve(surfCellCount);
+	for(int index = 0; index < (int)lastVisit.size(); ++index) {
+		if(lastVisit[index] >= 0) {
+			result.surfPosAlphaList.push_back(visited[lastVisit[index]]);
+		}
 	}
 	return result;
 }
@@ -1443,8 +1359,9 @@ FowAlphaCellsLookupItem Unit::getFogOfWarRadius(bool useCache) const {
 void Unit::calculateFogOfWarRadius(bool forceRefresh) {
 	if(game->getWorld()->getFogOfWar() == true) {
 		if(forceRefresh || this->pos != this->cachedFowPos) {
-			cachedFow = getFogOfWarRadius(false);
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			FowAlphaCellsLookupItem fow = getFogOfWarRadius(false);
+			cachedFow.surfPosAlphaList.swap(fow.surfPosAlphaList);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 			this->cachedFowPos = this->pos;
 		}
@@ -1724,7 +1641,7 @@ bool Unit::anyCommand(bool validateCommandtype) const {
 
 //return current command, assert that there is always one command
 Command *Unit::getCurrrentCommandThreadSafe() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	if(commands.empty() == false) {
@@ -1735,7 +1652,7 @@ Command *Unit::getCurrrentCommandThreadSafe() {
 }
 
 void Unit::replaceCurrCommand(Command *cmd) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	assert(commands.empty() == false);
@@ -1812,7 +1729,7 @@ std::pair<CommandResult,string> Unit::giveCommand(Command *command, bool tryQueu
 					if(SystemFlags::getSystemSettingType(SystemFlags::debugUnitCommands).enabled)
 						SystemFlags::OutputDebug(SystemFlags::debugUnitCommands,"In [%s::%s Line: %d] Deleting lower priority command [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,(*i)->toString(false).c_str());
 
-					static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+					static const char *mutexOwnerId = CODE_AT_LINE;
 					MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 					deleteQueuedCommand(*i);
@@ -1896,7 +1813,7 @@ std::pair<CommandResult,string> Unit::giveCommand(Command *command, bool tryQueu
 
 	//push back command
 	if(result.first == crSuccess) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 		commands.push_back(command);
@@ -1907,6 +1824,7 @@ std::pair<CommandResult,string> Unit::giveCommand(Command *command, bool tryQueu
 		delete command;
 		changedActiveCommand = false;
 	}
+	notifyFactionCommandChange();
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s] Line: %d took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
@@ -1925,7 +1843,7 @@ CommandResult Unit::finishCommand() {
 	}
 
 	//pop front
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	delete commands.front();
@@ -1946,6 +1864,7 @@ CommandResult Unit::finishCommand() {
 			break;
 		}
 	}
+	notifyFactionCommandChange();
 
 	return crSuccess;
 }
@@ -1966,13 +1885,14 @@ CommandResult Unit::cancelCommand() {
 	undoCommand(commands.back());
 
 	//delete ans pop command
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 	delete commands.back();
 	commands.pop_back();
 
 	safeMutex.ReleaseLock();
+	notifyFactionCommandChange();
 
 	//clear routes
 	this->unitPath->clear();
@@ -2355,7 +2275,7 @@ int64 Unit::getUpdatedProgress(int64 currentProgress, int64 updateFPS, int64 spe
 		char szBuf[8096]="";
 		snprintf(szBuf,8095,"currentProgress = " MG_I64_SPECIFIER " updateFPS = " MG_I64_SPECIFIER " speed = " MG_I64_SPECIFIER " diagonalFactor = " MG_I64_SPECIFIER " heightFactor = " MG_I64_SPECIFIER " speedDenominator = " MG_I64_SPECIFIER " progressIncrease = " MG_I64_SPECIFIER " [" MG_I64_SPECIFIER "] height [%f] airHeight [%f] cellUnitHeight [%d] cellObjectHeight [%d] skill [%s] pos [%s] lastpos [%s]",
 				currentProgress,updateFPS,speed,diagonalFactor,heightFactor,speedDenominator,progressIncrease,((speed * diagonalFactor * heightFactor) / speedDenominator),height,airHeight,cellUnitHeight,cellObjectHeight,(currSkill != NULL ? currSkill->getName().c_str() : "none"),pos.getString().c_str(),lastPos.getString().c_str());
-		networkCRCLogInfo = szBuf;
+		getColdState()->networkCRCLogInfo = szBuf;
 
 		//printf("%s\n",szBuf);
 	}
@@ -3766,7 +3686,7 @@ void Unit::clearCommands() {
 	while(commands.empty() == false) {
 		undoCommand(commands.back());
 
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 
 		delete commands.back();
@@ -3775,6 +3695,13 @@ void Unit::clearCommands() {
 		safeMutex.ReleaseLock();
 	}
 	changedActiveCommand = false;
+	notifyFactionCommandChange();
+}
+
+void Unit::notifyFactionCommandChange() {
+	if(this->faction != NULL) {
+		this->faction->notifyUnitCommandChange(this);
+	}
 }
 
 void Unit::deleteQueuedCommand(Command *command) {
@@ -4481,13 +4408,14 @@ void Unit::logSynchDataCommon(string file,int line,string source,bool threadedMo
 				progress2,
 				(unitPath != NULL ? unitPath->toString().c_str() : "NULL"));
 
-	    if( lastSynchDataString != string(szBuf) ||
-	    	lastFile != file ||
-	    	lastLine != line ||
-	    	lastSource != source) {
-	    	lastSynchDataString = string(szBuf);
-	    	lastFile = file;
-	    	lastSource = source;
+	    UnitColdState *cold = getColdState();
+	    if( cold->lastSynchDataString != string(szBuf) ||
+	    	cold->lastFile != file ||
+	    	cold->lastLine != line ||
+	    	cold->lastSource != source) {
+	    	cold->lastSynchDataString = string(szBuf);
+	    	cold->lastFile = file;
+	    	cold->lastSource = source;
 
 	    	char szBufDataText[8096]="";
 	    	snprintf(szBufDataText,8096,"----------------------------------- START [FRAME %d UNIT: %d - %s] ------------------------------------------------\n",getFrameCount(),this->id,this->getType()->getName(false).c_str());
@@ -4526,21 +4454,23 @@ void Unit::logSynchDataCommon(string file,int line,string source,bool threadedMo
 void Unit::addBadHarvestPos(const Vec2i &value) {
 	//Chrono chron;
 	//chron.start();
-	badHarvestPosList[value] = getFrameCount();
+	getColdState()->badHarvestPosList[value] = getFrameCount();
 	cleanupOldBadHarvestPos();
 }
 
 void Unit::removeBadHarvestPos(const Vec2i &value) {
-	std::map<Vec2i,int>::iterator iter = badHarvestPosList.find(value);
-	if(iter != badHarvestPosList.end()) {
-		badHarvestPosList.erase(value);
+	if(coldState != NULL) {
+		std::map<Vec2i,int>::iterator iter = coldState->badHarvestPosList.find(value);
+		if(iter != coldState->badHarvestPosList.end()) {
+			coldState->badHarvestPosList.erase(value);
+		}
 	}
 	cleanupOldBadHarvestPos();
 }
 
 void Unit::cleanupOldBadHarvestPos() {
 	const unsigned int cleanupInterval = (GameConstants::updateFps * 5);
-	bool needToCleanup = (getFrameCount() % cleanupInterval == 0);
+	bool needToCleanup = (coldState != NULL && getFrameCount() % cleanupInterval == 0);
 
 	//printf("========================> cleanupOldBadHarvestPos() [%d] badHarvestPosList.size [%ld] cleanupInterval [%d] getFrameCount() [%d] needToCleanup [%d]\n",getFrameCount(),badHarvestPosList.size(),cleanupInterval,getFrameCount(),needToCleanup);
 
@@ -4548,6 +4478,7 @@ void Unit::cleanupOldBadHarvestPos() {
 		//printf("========================> cleanupOldBadHarvestPos() [%d] badHarvestPosList.size [%ld]\n",getFrameCount(),badHarvestPosList.size());
 
 		std::vector<Vec2i> purgeList;
+		std::map<Vec2i,int> &badHarvestPosList = coldState->badHarvestPosList;
 		for(std::map<Vec2i,int>::iterator iter = badHarvestPosList.begin(); iter != badHarvestPosList.end(); ++iter) {
 			if(getFrameCount() - iter->second >= cleanupInterval) {
 				//printf("cleanupOldBadHarvestPos() [%d][%d]\n",getFrameCount(),iter->second);
@@ -4659,7 +4590,7 @@ string Unit::getUniquePickName() const {
 Vec2i Unit::getPos() {
 	Vec2i result;
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexCommands,mutexOwnerId);
 	result = this->pos;
 	safeMutex.ReleaseLock();
@@ -4668,7 +4599,7 @@ Vec2i Unit::getPos() {
 }
 
 void Unit::clearCaches() {
-	cachedFow.surfPosAlphaList.clear();
+	FowAlphaCellsLookupItem::SurfPosAlphaList().swap(cachedFow.surfPosAlphaList);
 	cachedFowPos = Vec2i(0,0);
 
 	cacheExploredCells.exploredCellList.clear();
@@ -4683,15 +4614,55 @@ void Unit::clearCaches() {
 	lastHarvestedResourcePos = Vec2i(0,0);
 }
 
+void Unit::addMemoryUsage(UnitMemoryUsage &usage) const {
+	usage.unitCount++;
+	usage.bytes[UnitMemoryUsage::umObject] += sizeof(*this);
+
+	if(unitPath != NULL) {
+		usage.bytes[UnitMemoryUsage::umPath] += unitPath->getMemoryBytes();
+	}
+	usage.bytes[UnitMemoryUsage::umPath] += waypointPath.size() * (sizeof(Vec2i) + UnitMemoryUsage::listNodeOverhead);
+
+	usage.bytes[UnitMemoryUsage::umCommands] += commands.size() * (sizeof(Command) + sizeof(Command *) + UnitMemoryUsage::listNodeOverhead);
+	usage.bytes[UnitMemoryUsage::umCommands] += observers.size() * (sizeof(UnitObserver *) + UnitMemoryUsage::listNodeOverhead);
+
+	// The particle systems themselves belong to the renderer
+	uint64 particleBytes = unitParticleSystems.capacity() * sizeof(UnitParticleSystem *);
+	particleBytes += queuedUnitParticleSystemTypes.capacity() * sizeof(UnitParticleSystemType *);
+	particleBytes += damageParticleSystems.capacity() * sizeof(UnitParticleSystem *);
+	particleBytes += damageParticleSystemsInUse.size() * (sizeof(std::pair<int, UnitParticleSystem *>) + UnitMemoryUsage::mapNodeOverhead);
+	particleBytes += fireParticleSystems.capacity() * sizeof(ParticleSystem *);
+	particleBytes += smokeParticleSystems.capacity() * sizeof(UnitParticleSystem *);
+	particleBytes += attackParticleSystems.capacity() * sizeof(ParticleSystem *);
+	usage.bytes[UnitMemoryUsage::umParticles] += particleBytes;
+
+	usage.bytes[UnitMemoryUsage::umFogOfWar] += cachedFow.surfPosAlphaList.capacity() * sizeof(std::pair<Vec2i,float>);
+	usage.bytes[UnitMemoryUsage::umExploredCells] += (cacheExploredCells.exploredCellList.capacity() +
+			cacheExploredCells.visibleCellList.capacity()) * sizeof(SurfaceCell *);
+
+	uint64 boostBytes = currentAttackBoostOriginatorEffect.currentAttackBoostUnits.capacity() * sizeof(int);
+	if(currentAttackBoostOriginatorEffect.currentAppliedEffect != NULL) {
+		boostBytes += sizeof(UnitAttackBoostEffect);
+	}
+	boostBytes += currentAttackBoostEffects.capacity() * sizeof(UnitAttackBoostEffect *);
+	boostBytes += currentAttackBoostEffects.size() * sizeof(UnitAttackBoostEffect);
+	usage.bytes[UnitMemoryUsage::umAttackBoosts] += boostBytes;
+
+	if(coldState != NULL) {
+		usage.coldStateCount++;
+		usage.bytes[UnitMemoryUsage::umColdState] += coldState->getMemoryBytes();
+	}
+}
+
 bool Unit::showTranslatedTechTree() const {
 	return (this->game != NULL ? this->game->showTranslatedTechTree() : true);
 }
 
 string Unit::getNetworkCRCDecHpList() const {
 	string result = "";
-	if(networkCRCDecHpList.empty() == false) {
-		for(unsigned int index = 0; index < networkCRCDecHpList.size(); ++index) {
-			result += networkCRCDecHpList[index] + " ";
+	if(coldState != NULL && coldState->networkCRCDecHpList.empty() == false) {
+		for(unsigned int index = 0; index < coldState->networkCRCDecHpList.size(); ++index) {
+			result += coldState->networkCRCDecHpList[index] + " ";
 		}
 	}
 	return result;
@@ -4723,7 +4694,7 @@ std::string Unit::toString(bool crcMode) const {
 	result += " deadCount = " + intToStr(this->deadCount);
 	result += " progress = " + intToStr(this->progress);
 	result += "\n";
-	result += "networkCRCLogInfo = " + networkCRCLogInfo;
+	result += "networkCRCLogInfo = " + (coldState != NULL ? coldState->networkCRCLogInfo : "");
 	result += "\n";
 	if(crcMode == false) {
 		result += " lastAnimProgress = " + intToStr(this->lastAnimProgress);
@@ -4809,7 +4780,7 @@ std::string Unit::toString(bool crcMode) const {
 
     result += "screenPos = " + screenPos.getString() + "\n";
 
-    result += "currentUnitTitle = " + currentUnitTitle + "\n";
+    result += "currentUnitTitle = " + getCurrentUnitTitle() + "\n";
 
     result += "inBailOutAttempt = " + intToStr(inBailOutAttempt) + "\n";
 
@@ -4827,10 +4798,10 @@ std::string Unit::toString(bool crcMode) const {
 	if(attackParticleSystems.empty() == false) {
 		result += "attackParticleSystems count = " + intToStr(attackParticleSystems.size()) + "\n";
 	}
-	if(networkCRCParticleLogInfo != "") {
-		result += "networkCRCParticleLogInfo = " + networkCRCParticleLogInfo + "\n";
+	if(coldState != NULL && coldState->networkCRCParticleLogInfo != "") {
+		result += "networkCRCParticleLogInfo = " + coldState->networkCRCParticleLogInfo + "\n";
 	}
-	if(networkCRCDecHpList.empty() == false) {
+	if(coldState != NULL && coldState->networkCRCDecHpList.empty() == false) {
 		result += "getNetworkCRCDecHpList() = " + getNetworkCRCDecHpList() + "\n";
 	}
 
@@ -5055,14 +5026,16 @@ void Unit::saveGame(XmlNode *rootNode) {
 //	CardinalDir modelFacing;
 	unitNode->addAttribute("modelFacing",intToStr(modelFacing), mapTagReplacements);
 
+	const UnitColdState emptyColdState;
+	const UnitColdState &cold = (coldState != NULL ? *coldState : emptyColdState);
 //	std::string lastSynchDataString;
-	unitNode->addAttribute("lastSynchDataString",lastSynchDataString, mapTagReplacements);
+	unitNode->addAttribute("lastSynchDataString",cold.lastSynchDataString, mapTagReplacements);
 //	std::string lastFile;
-	unitNode->addAttribute("lastFile",lastFile, mapTagReplacements);
+	unitNode->addAttribute("lastFile",cold.lastFile, mapTagReplacements);
 //	int lastLine;
-	unitNode->addAttribute("lastLine",intToStr(lastLine), mapTagReplacements);
+	unitNode->addAttribute("lastLine",intToStr(cold.lastLine), mapTagReplacements);
 //	std::string lastSource;
-	unitNode->addAttribute("lastSource",lastSource, mapTagReplacements);
+	unitNode->addAttribute("lastSource",cold.lastSource, mapTagReplacements);
 //	int lastRenderFrame;
 	unitNode->addAttribute("lastRenderFrame",intToStr(lastRenderFrame), mapTagReplacements);
 //	bool visible;
@@ -5072,14 +5045,14 @@ void Unit::saveGame(XmlNode *rootNode) {
 //	Vec3f screenPos;
 	unitNode->addAttribute("screenPos",screenPos.getString(), mapTagReplacements);
 //	string currentUnitTitle;
-	unitNode->addAttribute("currentUnitTitle",currentUnitTitle, mapTagReplacements);
+	unitNode->addAttribute("currentUnitTitle",cold.currentUnitTitle, mapTagReplacements);
 //
 //	bool inBailOutAttempt;
 	unitNode->addAttribute("inBailOutAttempt",intToStr(inBailOutAttempt), mapTagReplacements);
 //	//std::vector<std::pair<Vec2i,Chrono> > badHarvestPosList;
 //	std::map<Vec2i,int> badHarvestPosList;
-	for(std::map<Vec2i,int>::const_iterator iterMap = badHarvestPosList.begin();
-			iterMap != badHarvestPosList.end(); ++iterMap) {
+	for(std::map<Vec2i,int>::const_iterator iterMap = cold.badHarvestPosList.begin();
+			iterMap != cold.badHarvestPosList.end(); ++iterMap) {
 		XmlNode *badHarvestPosListNode = unitNode->addChild("badHarvestPosList");
 
 		badHarvestPosListNode->addAttribute("key",iterMap->first.getString(), mapTagReplacements);
@@ -5345,7 +5318,7 @@ Unit * Unit::loadGame(const XmlNode *rootNode, GameSettings *settings, Faction *
 		XmlNode *node = commandNodeList[i];
 		Command *command = Command::loadGame(node,ut,world);
 
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex(result->mutexCommands,mutexOwnerId);
 		result->commands.push_back(command);
 		safeMutex.ReleaseLock();
@@ -5510,7 +5483,7 @@ Unit * Unit::loadGame(const XmlNode *rootNode, GameSettings *settings, Faction *
 //	Vec3f screenPos;
 	result->screenPos = Vec3f::strToVec3(unitNode->getAttribute("screenPos")->getValue());
 //	string currentUnitTitle;
-	result->currentUnitTitle = unitNode->getAttribute("currentUnitTitle")->getValue();
+	result->setCurrentUnitTitle(unitNode->getAttribute("currentUnitTitle")->getValue());
 //
 //	bool inBailOutAttempt;
 	result->inBailOutAttempt = unitNode->getAttribute("inBailOutAttempt")->getIntValue() != 0;
@@ -5792,7 +5765,7 @@ Checksum Unit::getCRC() {
 
 	crcForUnit.addInt(inBailOutAttempt);
 
-	crcForUnit.addInt((int)badHarvestPosList.size());
+	crcForUnit.addInt(coldState != NULL ? (int)coldState->badHarvestPosList.size() : 0);
 	//crcForUnit.addInt(lastHarvestResourceTarget.first());
 
 	if(consoleDebug) printf("#14 Unit: %d CRC: %u\n",id,crcForUnit.getSum());
@@ -5862,8 +5835,8 @@ Checksum Unit::getCRC() {
 		}
 	}
 
-	if(this->networkCRCParticleLogInfo != "") {
-		crcForUnit.addString(this->networkCRCParticleLogInfo);
+	if(coldState != NULL && coldState->networkCRCParticleLogInfo != "") {
+		crcForUnit.addString(coldState->networkCRCParticleLogInfo);
 	}
 
 	return crcForUnit;
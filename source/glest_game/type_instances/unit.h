@@ -22,12 +22,12 @@
 #include "skill_type.h"
 #include "game_constants.h"
 #include "platform_common.h"
+#include "unit_path.h"
+#include "unit_memory.h"
 #include <vector>
 #include "faction.h"
 #include "leak_dumper.h"
 
-//#define LEAK_CHECK_UNITS
-
 namespace Glest { namespace Game {
 
 using Shared::Graphics::ParticleSystem;
@@ -135,158 +135,6 @@ public:
 	void loadGame(const XmlNode *rootNode,World *world);
 };
 
-class UnitPathInterface {
-
-public:
-	UnitPathInterface() {}
-	virtual ~UnitPathInterface() {}
-
-	virtual bool isBlocked() const = 0;
-	virtual bool isEmpty() const = 0;
-	virtual bool isStuck() const = 0;
-
-	virtual void clear() = 0;
-	virtual void clearBlockCount() = 0;
-	virtual void incBlockCount() = 0;
-	virtual void add(const Vec2i &path) = 0;
-	//virtual Vec2i pop() = 0;
-	virtual int getBlockCount() const = 0;
-	virtual int getQueueCount() const = 0;
-
-	virtual vector<Vec2i> getQueue() const = 0;
-
-	virtual std::string toString() const = 0;
-
-	virtual void setMap(Map *value) = 0;
-	virtual Map * getMap() = 0;
-
-	virtual void saveGame(XmlNode *rootNode) = 0;
-	virtual void loadGame(const XmlNode *rootNode) = 0;
-
-	virtual void clearCaches() = 0;
-
-	virtual Checksum getCRC() = 0;
-};
-
-class UnitPathBasic : public UnitPathInterface {
-private:
-	static const int maxBlockCount;
-	Map *map;
-
-#ifdef LEAK_CHECK_UNITS
-	static std::map<UnitPathBasic *,bool> mapMemoryList;
-#endif
-
-private:
-	int blockCount;
-	vector<Vec2i> pathQueue;
-
-public:
-	UnitPathBasic();
-	virtual ~UnitPathBasic();
-
-#ifdef LEAK_CHECK_UNITS
-	static void dumpMemoryList();
-#endif
-
-	virtual bool isBlocked() const;
-	virtual bool isEmpty() const;
-	virtual bool isStuck() const;
-
-	virtual void clear();
-	virtual void clearBlockCount() { blockCount = 0; }
-	virtual void incBlockCount();
-	virtual void add(const Vec2i &path);
-	Vec2i pop(bool removeFrontPos=true);
-	virtual int getBlockCount() const { return blockCount; }
-	virtual int getQueueCount() const { return (int)pathQueue.size(); }
-
-	virtual vector<Vec2i> getQueue() const { return pathQueue; }
-
-	virtual void setMap(Map *value) { map = value; }
-	virtual Map * getMap() { return map; }
-
-	virtual std::string toString() const;
-
-	virtual void saveGame(XmlNode *rootNode);
-	virtual void loadGame(const XmlNode *rootNode);
-	virtual void clearCaches();
-
-	virtual Checksum getCRC();
-};
-
-// =====================================================
-// 	class UnitPath
-// =====================================================
-/** Holds the next cells of a Unit movement
-  * @extends std::list<Shared::Math::Vec2i>
-  */
-class UnitPath : public list<Vec2i>, public UnitPathInterface {
-private:
-	static const int maxBlockCount = 10; /**< number of command updates to wait on a blocked path */
-
-private:
-	int blockCount;		/**< number of command updates this path has been blocked */
-	Map *map;
-
-public:
-	UnitPath() : UnitPathInterface(), blockCount(0), map(NULL) {} /**< Construct path object */
-
-	virtual bool isBlocked() const	{return blockCount >= maxBlockCount;} /**< is this path blocked	   */
-	virtual bool isEmpty() const	{return list<Vec2i>::empty();}	/**< is path empty				  */
-	virtual bool isStuck() const	{return false; }
-
-	int  size() const		{return (int)list<Vec2i>::size();}	/**< size of path				 */
-	virtual void clear()			{list<Vec2i>::clear(); blockCount = 0;} /**< clear the path		*/
-	virtual void clearBlockCount() { blockCount = 0; }
-	virtual void incBlockCount()	{++blockCount;}		   /**< increment block counter			   */
-	virtual void push(Vec2i &pos)	{push_front(pos);}	  /**< push onto front of path			  */
-	bool empty() const		{return list<Vec2i>::empty();}	/**< is path empty				  */
-	virtual void add(const Vec2i &pos)	{ push_front(pos);}	  /**< push onto front of path			  */
-
-
-#if 0
-	// old style, to work with original PathFinder
-	Vec2i peek()			{return back();}	 /**< peek at the next position			 */
-	void pop()				{this->pop_back();}	/**< pop the next position off the path */
-#else
-	// new style
-	Vec2i peek()			{return front();}	 /**< peek at the next position			 */
-	//virtual Vec2i pop()		{ Vec2i p= front(); erase(begin()); return p; }	/**< pop the next position off the path */
-	void pop()		{ erase(begin()); }	/**< pop the next position off the path */
-#endif
-	virtual int getBlockCount() const { return blockCount; }
-	virtual int getQueueCount() const { return this->size(); }
-
-	virtual vector<Vec2i> getQueue() const {
-		vector<Vec2i> result;
-		for(list<Vec2i>::const_iterator iter = this->begin(); iter != this->end(); ++iter) {
-			result.push_back(*iter);
-		}
-		return result;
-	}
-
-	virtual void setMap(Map *value) { map = value; }
-	virtual Map * getMap() { return map; }
-
-	virtual std::string toString() const;
-
-	virtual void saveGame(XmlNode *rootNode) {};
-	virtual void loadGame(const XmlNode *rootNode) {};
-	virtual void clearCaches() {};
-
-	virtual Checksum getCRC() { return Checksum(); };
-};
-
-class WaypointPath : public list<Vec2i> {
-public:
-	WaypointPath() {}
-	void push(const Vec2i &pos)	{ push_front(pos); }
-	Vec2i peek() const			{return front();}
-	void pop()					{erase(begin());}
-	void condense();
-};
-
 
 // ===============================
 // 	class Unit
@@ -425,26 +273,16 @@ private:
 
 	CardinalDir modelFacing;
 
-	std::string lastSynchDataString;
-	std::string lastFile;
-	int32 lastLine;
-	std::string lastSource;
 	int32 lastRenderFrame;
 	bool visible;
+	int32 visibilityGridItem;
 
 	int retryCurrCommandCount;
 
 	Vec3f screenPos;
-	string currentUnitTitle;
 
 	bool inBailOutAttempt;
-	// This buffer stores a list of bad harvest cells, along with the start
-	// time of when it was detected. Typically this may be due to a unit
-	// constantly getting blocked from getting to the resource so this
-	// list may be used to tell areas of the game to ignore those cells for a
-	// period of time
 	//std::vector<std::pair<Vec2i,Chrono> > badHarvestPosList;
-	std::map<Vec2i,int> badHarvestPosList;
 	//time_t lastBadHarvestListPurge;
 	std::pair<Vec2i,int> lastHarvestResourceTarget;
 
@@ -493,10 +331,9 @@ private:
 
 	Vec2i lastHarvestedResourcePos;
 
-	string networkCRCLogInfo;
-	string networkCRCParticleLogInfo;
-	vector<string> networkCRCDecHpList;
-	vector<string> networkCRCParticleInfoList;
+	// Rarely used state, NULL until something needs it. Read without
+	// a lock, so it is only set once the state is fully built
+	UnitColdState * volatile coldState;
 
 public:
     Unit(int id, UnitPathInterface *path, const Vec2i &pos, const UnitType *type, Faction *faction, Map *map, CardinalDir placeFacing);
@@ -703,14 +540,17 @@ public:
 	inline int getLastRenderFrame() const { return lastRenderFrame; }
 	inline void setLastRenderFrame(int value) { lastRenderFrame = value; }
 
+	inline int getVisibilityGridItem() const { return visibilityGridItem; }
+	inline void setVisibilityGridItem(int value) { visibilityGridItem = value; }
+
 	inline int getRetryCurrCommandCount() const { return retryCurrCommandCount; }
 	inline void setRetryCurrCommandCount(int value) { retryCurrCommandCount = value; }
 
 	inline Vec3f getScreenPos() const { return screenPos; }
 	void setScreenPos(Vec3f value) { screenPos = value; }
 
-	inline string getCurrentUnitTitle() const {return currentUnitTitle;}
-	void setCurrentUnitTitle(string value) { currentUnitTitle = value;}
+	inline string getCurrentUnitTitle() const { return (coldState != NULL ? coldState->currentUnitTitle : ""); }
+	void setCurrentUnitTitle(string value);
 
 	void exploreCells(bool forceRefresh=false);
 
@@ -723,12 +563,12 @@ public:
 	void removeBadHarvestPos(const Vec2i &value);
 	inline bool isBadHarvestPos(const Vec2i &value,bool checkPeerUnits=true) const {
 		bool result = false;
-		if(badHarvestPosList.empty() == true) {
+		if(coldState == NULL || coldState->badHarvestPosList.empty() == true) {
 			return result;
 		}
 
-		std::map<Vec2i,int>::const_iterator iter = badHarvestPosList.find(value);
-		if(iter != badHarvestPosList.end()) {
+		std::map<Vec2i,int>::const_iterator iter = coldState->badHarvestPosList.find(value);
+		if(iter != coldState->badHarvestPosList.end()) {
 			result = true;
 		}
 		else if(checkPeerUnits == true) {
@@ -802,15 +642,19 @@ public:
 
 	Checksum getCRC();
 
+	void addMemoryUsage(UnitMemoryUsage &usage) const;
+
 	virtual void end(ParticleSystem *particleSystem);
 	virtual void logParticleInfo(string info);
-	void setNetworkCRCParticleLogInfo(string networkCRCParticleLogInfo) { this->networkCRCParticleLogInfo = networkCRCParticleLogInfo; }
+	void setNetworkCRCParticleLogInfo(string networkCRCParticleLogInfo);
 	void clearParticleInfo();
 	void addNetworkCRCDecHp(string info);
 	void clearNetworkCRCDecHpList();
 
 private:
 
+	UnitColdState * getColdState();
+
 	void cleanupAllParticlesystems();
 	bool isNetworkCRCEnabled();
 	string getNetworkCRCDecHpList() const;
@@ -822,6 +666,7 @@ private:
 	void updateTarget();
 	void clearCommands();
 	void deleteQueuedCommand(Command *command);
+	void notifyFactionCommandChange();
 	CommandResult undoCommand(Command *command);
 	void stopDamageParticles(bool force);
 	void startDamageParticles();
@@ -0,0 +1,105 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "unit_memory.h"
+#include "conversion.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class UnitColdState
+// =====================================================
+
+static std::size_t getStringHeapBytes(const string &value) {
+	return (value.empty() == false ? value.capacity() + 1 : 0);
+}
+
+std::size_t UnitColdState::getMemoryBytes() const {
+	std::size_t result = sizeof(*this);
+	result += getStringHeapBytes(lastSynchDataString);
+	result += getStringHeapBytes(lastFile);
+	result += getStringHeapBytes(lastSource);
+	result += getStringHeapBytes(currentUnitTitle);
+	result += badHarvestPosList.size() * (sizeof(std::pair<Vec2i,int>) + UnitMemoryUsage::mapNodeOverhead);
+	result += getStringHeapBytes(networkCRCLogInfo);
+	result += getStringHeapBytes(networkCRCParticleLogInfo);
+	result += networkCRCDecHpList.capacity() * sizeof(string);
+	for(unsigned int index = 0; index < networkCRCDecHpList.size(); ++index) {
+		result += getStringHeapBytes(networkCRCDecHpList[index]);
+	}
+	result += networkCRCParticleInfoList.capacity() * sizeof(string);
+	for(unsigned int index = 0; index < networkCRCParticleInfoList.size(); ++index) {
+		result += getStringHeapBytes(networkCRCParticleInfoList[index]);
+	}
+	return result;
+}
+
+// =====================================================
+// 	class UnitMemoryUsage
+// =====================================================
+
+const std::size_t UnitMemoryUsage::listNodeOverhead	= 2 * sizeof(void *);
+const std::size_t UnitMemoryUsage::mapNodeOverhead	= 4 * sizeof(void *);
+
+UnitMemoryUsage::UnitMemoryUsage() {
+	unitCount = 0;
+	coldStateCount = 0;
+	for(int index = 0; index < umCount; ++index) {
+		bytes[index] = 0;
+	}
+}
+
+const char * UnitMemoryUsage::getSubsystemName(Subsystem subsystem) {
+	switch(subsystem) {
+		case umObject:
+			return "object";
+		case umPath:
+			return "path";
+		case umCommands:
+			return "commands";
+		case umParticles:
+			return "particles";
+		case umFogOfWar:
+			return "fow";
+		case umExploredCells:
+			return "explored";
+		case umAttackBoosts:
+			return "boosts";
+		case umColdState:
+			return "cold";
+		default:
+			return "unknown";
+	}
+}
+
+uint64 UnitMemoryUsage::getTotalBytes() const {
+	uint64 result = 0;
+	for(int index = 0; index < umCount; ++index) {
+		result += bytes[index];
+	}
+	return result;
+}
+
+string UnitMemoryUsage::toString() const {
+	string result = "units [" + intToStr(unitCount) + "] cold [" + intToStr(coldStateCount) + "] bytes/unit:";
+	for(int index = 0; index < umCount; ++index) {
+		uint64 perUnit = (unitCount > 0 ? bytes[index] / unitCount : 0);
+		result += string(" ") + getSubsystemName(static_cast<Subsystem>(index)) + " [" + formatNumber(perUnit) + "]";
+	}
+	uint64 totalPerUnit = (unitCount > 0 ? getTotalBytes() / unitCount : 0);
+	result += " all [" + formatNumber(totalPerUnit) + "] total KB: " + formatNumber(getTotalBytes() / 1000);
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,103 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_UNITMEMORY_H_
+#define _GLEST_GAME_UNITMEMORY_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "vec.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+
+namespace Glest { namespace Game {
+
+using Shared::Graphics::Vec2i;
+using Shared::Platform::int32;
+using Shared::Platform::uint64;
+
+// =====================================================
+// 	class UnitColdState
+//
+///	Unit state only touched by synch logging, network CRC
+/// checks, path finder debugging and blocked harvesters.
+/// Allocated on first use so most units never carry it.
+// =====================================================
+
+class UnitColdState {
+public:
+	UnitColdState() : lastLine(0) {}
+
+	std::string lastSynchDataString;
+	std::string lastFile;
+	int32 lastLine;
+	std::string lastSource;
+
+	string currentUnitTitle;
+
+	// This buffer stores a list of bad harvest cells, along with the start
+	// time of when it was detected. Typically this may be due to a unit
+	// constantly getting blocked from getting to the resource so this
+	// list may be used to tell areas of the game to ignore those cells for a
+	// period of time
+	std::map<Vec2i,int> badHarvestPosList;
+
+	string networkCRCLogInfo;
+	string networkCRCParticleLogInfo;
+	vector<string> networkCRCDecHpList;
+	vector<string> networkCRCParticleInfoList;
+
+	std::size_t getMemoryBytes() const;
+};
+
+// =====================================================
+// 	class UnitMemoryUsage
+//
+///	Approximate bytes held by units, by subsystem
+// =====================================================
+
+class UnitMemoryUsage {
+public:
+	enum Subsystem {
+		umObject,
+		umPath,
+		umCommands,
+		umParticles,
+		umFogOfWar,
+		umExploredCells,
+		umAttackBoosts,
+		umColdState,
+
+		umCount
+	};
+
+	// Node overhead of the standard containers
+	static const std::size_t listNodeOverhead;
+	static const std::size_t mapNodeOverhead;
+
+	int unitCount;
+	int coldStateCount;
+	uint64 bytes[umCount];
+
+	UnitMemoryUsage();
+
+	static const char * getSubsystemName(Subsystem subsystem);
+	uint64 getTotalBytes() const;
+	string toString() const;
+};
+
+}}// end namespace
+
+#endif
@@ -0,0 +1,179 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "unit_path.h"
+#include "map.h"
+#include "conversion.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class UnitPathBasic
+// =====================================================
+
+const int UnitPathBasic::maxBlockCount;
+
+#ifdef LEAK_CHECK_UNITS
+std::map<UnitPathBasic *,bool> UnitPathBasic::mapMemoryList;
+#endif
+
+UnitPathBasic::UnitPathBasic() : UnitPathInterface() {
+#ifdef LEAK_CHECK_UNITS
+	UnitPathBasic::mapMemoryList[this]=true;
+#endif
+
+	this->blockCount = 0;
+	this->pathQueue.clear();
+	this->map = NULL;
+}
+
+UnitPathBasic::~UnitPathBasic() {
+	this->blockCount = 0;
+	this->pathQueue.clear();
+	this->map = NULL;
+
+#ifdef LEAK_CHECK_UNITS
+	UnitPathBasic::mapMemoryList.erase(this);
+#endif
+}
+
+void UnitPathBasic::clearCaches() {
+	this->blockCount = 0;
+	this->pathQueue.clear();
+}
+
+bool UnitPathBasic::isEmpty() const {
+	return pathQueue.empty();
+}
+
+bool UnitPathBasic::isBlocked() const {
+	return blockCount >= maxBlockCount;
+}
+
+bool UnitPathBasic::isStuck() const {
+	return (isBlocked() == true && blockCount >= (maxBlockCount * 2));
+}
+
+void UnitPathBasic::clear() {
+	pathQueue.clear();
+	blockCount= 0;
+}
+
+void UnitPathBasic::incBlockCount() {
+	pathQueue.clear();
+	blockCount++;
+}
+
+void UnitPathBasic::add(const Vec2i &path) {
+	if(this->map != NULL) {
+		if(this->map->isInside(path) == false) {
+			throw megaglest_runtime_error("Invalid map path position = " + path.getString() + " map w x h = " + intToStr(map->getW()) + " " + intToStr(map->getH()));
+		}
+		else if(this->map->isInsideSurface(this->map->toSurfCoords(path)) == false) {
+			throw megaglest_runtime_error("Invalid map surface path position = " + path.getString() + " map surface w x h = " + intToStr(map->getSurfaceW()) + " " + intToStr(map->getSurfaceH()));
+		}
+	}
+
+	pathQueue.push_back(path);
+}
+
+Vec2i UnitPathBasic::pop(bool removeFrontPos) {
+	if(pathQueue.empty() == true) {
+		throw megaglest_runtime_error("pathQueue.size() = " + intToStr(pathQueue.size()));
+	}
+	Vec2i p= pathQueue.front();
+	if(removeFrontPos == true) {
+		pathQueue.erase(pathQueue.begin());
+	}
+	return p;
+}
+std::string UnitPathBasic::toString() const {
+	std::string result = "unit path blockCount = " + intToStr(blockCount) + "\npathQueue size = " + intToStr(pathQueue.size());
+	for(int idx = 0; idx < (int)pathQueue.size(); ++idx) {
+		result += " index = " + intToStr(idx) + " value = " + pathQueue[idx].getString();
+	}
+
+	return result;
+}
+
+void UnitPathBasic::saveGame(XmlNode *rootNode) {
+	std::map<string,string> mapTagReplacements;
+	XmlNode *unitPathBasicNode = rootNode->addChild("UnitPathBasic");
+
+//	int blockCount;
+	unitPathBasicNode->addAttribute("blockCount",intToStr(blockCount), mapTagReplacements);
+//	vector<Vec2i> pathQueue;
+	for(unsigned int i = 0; i < pathQueue.size(); ++i) {
+		Vec2i &vec = pathQueue[i];
+
+		XmlNode *pathQueueNode = unitPathBasicNode->addChild("pathQueue");
+		pathQueueNode->addAttribute("vec",vec.getString(), mapTagReplacements);
+	}
+}
+
+void UnitPathBasic::loadGame(const XmlNode *rootNode) {
+	const XmlNode *unitPathBasicNode = rootNode->getChild("UnitPathBasic");
+
+	blockCount = unitPathBasicNode->getAttribute("blockCount")->getIntValue();
+
+	pathQueue.clear();
+	vector<XmlNode *> pathqueueNodeList = unitPathBasicNode->getChildList("pathQueue");
+	for(unsigned int i = 0; i < pathqueueNodeList.size(); ++i) {
+		XmlNode *node = pathqueueNodeList[i];
+
+		Vec2i vec = Vec2i::strToVec2(node->getAttribute("vec")->getValue());
+		pathQueue.push_back(vec);
+	}
+}
+
+Checksum UnitPathBasic::getCRC() {
+	Checksum crcForPath;
+
+	crcForPath.addInt(blockCount);
+	crcForPath.addInt((int)pathQueue.size());
+
+	return crcForPath;
+}
+
+// =====================================================
+// 	class UnitPath
+// =====================================================
+
+void WaypointPath::condense() {
+	if (size() < 2) {
+		return;
+	}
+	iterator prev, curr;
+	prev = curr = begin();
+	while (++curr != end()) {
+		if (prev->dist(*curr) < 3.f) {
+			prev = erase(prev);
+		} else {
+			++prev;
+		}
+	}
+}
+
+std::string UnitPath::toString() const {
+	std::string result = "unit path blockCount = " + intToStr(blockCount) + " pathQueue size = " + intToStr(size());
+	result += " path = ";
+	for(int index = cells.size() - 1; index >= 0; --index) {
+		result += " [" + intToStr(cells[index].x) + "," + intToStr(cells[index].y) + "]";
+	}
+
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,213 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_UNITPATH_H_
+#define _GLEST_GAME_UNITPATH_H_
+
+#ifdef WIN32
+    #include <winsock2.h>
+    #include <winsock.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include "vec.h"
+#include "small_vector.h"
+#include "checksum.h"
+#include "xml_parser.h"
+#include "leak_dumper.h"
+
+//#define LEAK_CHECK_UNITS
+
+using std::string;
+using std::vector;
+using std::list;
+using Shared::Xml::XmlNode;
+
+namespace Glest { namespace Game {
+
+using Shared::Graphics::Vec2i;
+using Shared::Util::Checksum;
+using Shared::Util::SmallVector;
+
+class Map;
+
+// =====================================================
+// 	class UnitPathInterface
+//
+///	The next cells of a Unit movement. The paths don't
+/// need a world, so the unit tests link them directly.
+// =====================================================
+
+class UnitPathInterface {
+
+public:
+	UnitPathInterface() {}
+	virtual ~UnitPathInterface() {}
+
+	virtual bool isBlocked() const = 0;
+	virtual bool isEmpty() const = 0;
+	virtual bool isStuck() const = 0;
+
+	virtual void clear() = 0;
+	virtual void clearBlockCount() = 0;
+	virtual void incBlockCount() = 0;
+	virtual void add(const Vec2i &path) = 0;
+	//virtual Vec2i pop() = 0;
+	virtual int getBlockCount() const = 0;
+	virtual int getQueueCount() const = 0;
+
+	virtual vector<Vec2i> getQueue() const = 0;
+
+	virtual std::string toString() const = 0;
+
+	virtual void setMap(Map *value) = 0;
+	virtual Map * getMap() = 0;
+
+	virtual void saveGame(XmlNode *rootNode) = 0;
+	virtual void loadGame(const XmlNode *rootNode) = 0;
+
+	virtual void clearCaches() = 0;
+
+	virtual Checksum getCRC() = 0;
+
+	// Size of the path object including its heap storage
+	virtual std::size_t getMemoryBytes() const = 0;
+};
+
+class UnitPathBasic : public UnitPathInterface {
+private:
+	// Paths are refreshed every 10 to 20 cells, longer ones go to the heap
+	static const int inlineCellCount = 20;
+	typedef SmallVector<Vec2i,inlineCellCount> PathQueue;
+
+	static const int maxBlockCount = 20; /**< half a second of command updates at 40 fps */
+	Map *map;
+
+#ifdef LEAK_CHECK_UNITS
+	static std::map<UnitPathBasic *,bool> mapMemoryList;
+#endif
+
+private:
+	int blockCount;
+	PathQueue pathQueue;
+
+public:
+	UnitPathBasic();
+	virtual ~UnitPathBasic();
+
+#ifdef LEAK_CHECK_UNITS
+	static void dumpMemoryList();
+#endif
+
+	virtual bool isBlocked() const;
+	virtual bool isEmpty() const;
+	virtual bool isStuck() const;
+
+	virtual void clear();
+	virtual void clearBlockCount() { blockCount = 0; }
+	virtual void incBlockCount();
+	virtual void add(const Vec2i &path);
+	Vec2i pop(bool removeFrontPos=true);
+	virtual int getBlockCount() const { return blockCount; }
+	virtual int getQueueCount() const { return (int)pathQueue.size(); }
+
+	virtual vector<Vec2i> getQueue() const { return vector<Vec2i>(pathQueue.begin(),pathQueue.end()); }
+
+	virtual void setMap(Map *value) { map = value; }
+	virtual Map * getMap() { return map; }
+
+	virtual std::string toString() const;
+
+	virtual void saveGame(XmlNode *rootNode);
+	virtual void loadGame(const XmlNode *rootNode);
+	virtual void clearCaches();
+
+	virtual Checksum getCRC();
+
+	virtual std::size_t getMemoryBytes() const { return sizeof(*this) + pathQueue.getHeapBytes(); }
+};
+
+// =====================================================
+// 	class UnitPath
+// =====================================================
+/** Holds the next cells of a Unit movement, the next cell is kept
+  * at the back of the storage so peek and pop don't move the rest
+  */
+class UnitPath : public UnitPathInterface {
+private:
+	static const int maxBlockCount = 10; /**< number of command updates to wait on a blocked path */
+	static const int inlineCellCount = 20;
+
+	typedef SmallVector<Vec2i,inlineCellCount> Cells;
+
+private:
+	Cells cells;		/**< path cells, last one first */
+	int blockCount;		/**< number of command updates this path has been blocked */
+	Map *map;
+
+public:
+	UnitPath() : UnitPathInterface(), blockCount(0), map(NULL) {} /**< Construct path object */
+
+	virtual bool isBlocked() const	{return blockCount >= maxBlockCount;} /**< is this path blocked	   */
+	virtual bool isEmpty() const	{return cells.empty();}	/**< is path empty				  */
+	virtual bool isStuck() const	{return false; }
+
+	int  size() const		{return cells.size();}	/**< size of path				 */
+	virtual void clear()			{cells.clear(); blockCount = 0;} /**< clear the path		*/
+	virtual void clearBlockCount() { blockCount = 0; }
+	virtual void incBlockCount()	{++blockCount;}		   /**< increment block counter			   */
+	virtual void push(Vec2i &pos)	{cells.push_back(pos);}	  /**< push onto front of path			  */
+	bool empty() const		{return cells.empty();}	/**< is path empty				  */
+	virtual void add(const Vec2i &pos)	{ cells.push_back(pos);}	  /**< push onto front of path			  */
+
+	Vec2i peek()			{return cells.back();}	 /**< peek at the next position			 */
+	void pop()				{cells.pop_back();}	/**< pop the next position off the path */
+
+	virtual int getBlockCount() const { return blockCount; }
+	virtual int getQueueCount() const { return this->size(); }
+
+	virtual vector<Vec2i> getQueue() const {
+		vector<Vec2i> result;
+		for(int index = cells.size() - 1; index >= 0; --index) {
+			result.push_back(cells[index]);
+		}
+		return result;
+	}
+
+	virtual void setMap(Map *value) { map = value; }
+	virtual Map * getMap() { return map; }
+
+	virtual std::string toString() const;
+
+	virtual void saveGame(XmlNode *rootNode) {};
+	virtual void loadGame(const XmlNode *rootNode) {};
+	virtual void clearCaches() {};
+
+	virtual Checksum getCRC() { return Checksum(); };
+
+	virtual std::size_t getMemoryBytes() const { return sizeof(*this) + cells.getHeapBytes(); }
+};
+
+class WaypointPath : public list<Vec2i> {
+public:
+	WaypointPath() {}
+	void push(const Vec2i &pos)	{ push_front(pos); }
+	Vec2i peek() const			{return front();}
+	void pop()					{erase(begin());}
+	void condense();
+};
+
+}}// end namespace
+
+#endif
@@ -14,6 +14,10 @@
 
 #include <cassert>
 
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
 #include "tileset.h"
 #include "unit.h"
 #include "resource.h"
@@ -28,6 +32,7 @@
 #include "map_preview.h"
 #include "world.h"
 #include "byte_order.h"
+#include "base_thread.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Graphics;
@@ -290,14 +295,86 @@ void SurfaceCell::loadGame(const XmlNode *rootNode, int index, World *world) {
 //		}
 	}
 }
+
+// =====================================================
+// 	class MapRowJobList
+//
+//	Hands out blocks of surface rows of one terrain pass,
+//	the calling thread works through the same list
+// =====================================================
+
+class MapRowJobList {
+public:
+	static const int rowsPerJob = 8;
+	static const int minRowsPerWorker = 64;
+
+	Mutex mutex;
+	Semaphore workerDone;
+	Map *map;
+	MapRowPass pass;
+	int rowCount;
+	int nextRow;
+	string error;
+
+	// mrpSmoothSurface
+	const float *oldHeights;
+	float *newHeights;
+	bool *cliffs;
+
+	MapRowJobList(Map *map, MapRowPass pass, int rowCount) :
+		mutex(CODE_AT_LINE), map(map), pass(pass), rowCount(rowCount), nextRow(0),
+		oldHeights(NULL), newHeights(NULL), cliffs(NULL) {
+	}
+
+	void process() {
+		for(;;) {
+			MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+			int firstRow = nextRow;
+			nextRow += rowsPerJob;
+			safeMutex.ReleaseLock();
+
+			if(firstRow >= rowCount) {
+				break;
+			}
+
+			try {
+				map->computeRows(*this, firstRow, min(firstRow + rowsPerJob, rowCount));
+			}
+			catch(const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+
+				MutexSafeWrapper safeMutexError(&mutex,CODE_AT_LINE);
+				error = ex.what();
+			}
+		}
+	}
+};
+
+class MapRowWorkerThread : public BaseThread {
+private:
+	MapRowJobList *jobs;
+
+public:
+	MapRowWorkerThread(MapRowJobList *jobs) : BaseThread(), jobs(jobs) {
+		setUniqueID("MapRowWorkerThread");
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		jobs->process();
+		jobs->workerDone.signal();
+	}
+};
+
 // =====================================================
 // 	class Map
 // =====================================================
 
 // ===================== PUBLIC ========================
 
-const int Map::cellScale= 2;
+const int Map::cellScale;
 const int Map::mapScale= 2;
+int Map::rowWorkerThreadCount= -1;
 
 Map::Map() {
 	cells= NULL;
@@ -357,6 +434,9 @@ Vec2i Map::getStartLocation(int locationIndex) const {
 }
 
 Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
+	Chrono chrono;
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
+
     Checksum mapChecksum;
 	try{
 #ifdef WIN32
@@ -444,17 +524,24 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			cells= new Cell[getCellArraySize()];
 			surfaceCells= new SurfaceCell[getSurfaceCellArraySize()];
 
+			// Each layer is read as one block, objects keep their
+			// creation order below
+			vector<float32> heights(surfaceSize);
+			vector<int8> surfaces(surfaceSize);
+			vector<int8> objNumbers(surfaceSize);
+			size_t expectedBytes = (size_t)surfaceSize;
+			if((readBytes = fread(&heights[0], sizeof(float32), surfaceSize, f)) != expectedBytes ||
+				(readBytes = fread(&surfaces[0], sizeof(int8), surfaceSize, f)) != expectedBytes ||
+				(readBytes = fread(&objNumbers[0], sizeof(int8), surfaceSize, f)) != expectedBytes) {
+				char szBuf[8096]="";
+				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " expected " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,expectedBytes,__LINE__);
+				throw megaglest_runtime_error(szBuf);
+			}
+
 			//read heightmap
 			for(int j = 0; j < surfaceH; ++j) {
 				for(int i = 0; i < surfaceW; ++i) {
-					float32 alt=0;
-					readBytes = fread(&alt, sizeof(float32), 1, f);
-					if(readBytes != 1) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					alt = ::Shared::PlatformByteOrder::fromCommonEndian(alt);
+					float32 alt = ::Shared::PlatformByteOrder::fromCommonEndian(heights[j * surfaceW + i]);
 
 					SurfaceCell *sc= getSurfaceCell(i, j);
 					sc->setVertex(Vec3f(i*mapScale, alt / heightFactor, j*mapScale));
@@ -464,14 +551,7 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			//read surfaces
 			for(int j = 0; j < surfaceH; ++j) {
 				for(int i = 0; i < surfaceW; ++i) {
-					int8 surf=0;
-					readBytes = fread(&surf, sizeof(int8), 1, f);
-					if(readBytes != 1) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					surf = ::Shared::PlatformByteOrder::fromCommonEndian(surf);
+					int8 surf = ::Shared::PlatformByteOrder::fromCommonEndian(surfaces[j * surfaceW + i]);
 
 					getSurfaceCell(i, j)->setSurfaceType(surf-1);
 				}
@@ -481,14 +561,7 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			for(int j = 0; j < h; j += cellScale) {
 				for(int i = 0; i < w; i += cellScale) {
 
-					int8 objNumber=0;
-					readBytes = fread(&objNumber, sizeof(int8), 1, f);
-					if(readBytes != 1) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					objNumber = ::Shared::PlatformByteOrder::fromCommonEndian(objNumber);
+					int8 objNumber = ::Shared::PlatformByteOrder::fromCommonEndian(objNumbers[(j / cellScale) * surfaceW + (i / cellScale)]);
 
 					SurfaceCell *sc= getSurfaceCell(toSurfCoords(Vec2i(i, j)));
 					if(objNumber <= 0) {
@@ -523,10 +596,15 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 		throw megaglest_runtime_error("Error loading map: "+ path+ "\n"+ e.what());
 	}
 
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] map [%s] %dx%d loaded in usecs: %lld\n",__FILE__,__FUNCTION__,__LINE__,path.c_str(),surfaceW,surfaceH,(long long int)chrono.getMicros());
+
 	return mapChecksum;
 }
 
 void Map::init(Tileset *tileset) {
+	Chrono chrono;
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
+
 	Logger::getInstance().add(Lang::getInstance().getString("LogScreenGameUnLoadingMap","",true), true);
 	maxMapHeight=0.0f;
 	smoothSurface(tileset);
@@ -534,6 +612,8 @@ void Map::init(Tileset *tileset) {
 	computeInterpolatedHeights();
 	computeNearSubmerged();
 	computeCellColors();
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] map [%s] %dx%d terrain passes took usecs: %lld, rowWorkerThreadCount = %d\n",__FILE__,__FUNCTION__,__LINE__,mapFile.c_str(),surfaceW,surfaceH,(long long int)chrono.getMicros(),rowWorkerThreadCount);
 }
 
 
@@ -1589,106 +1669,59 @@ void Map::flatternTerrain(const Unit *unit){
 
 //compute normals
 void Map::computeNormals(){
-    //compute center normals
-    for(int i=1; i<surfaceW-1; ++i){
-        for(int j=1; j<surfaceH-1; ++j){
-            getSurfaceCell(i, j)->setNormal(
-				getSurfaceCell(i, j)->getVertex().normal(getSurfaceCell(i, j-1)->getVertex(),
-					getSurfaceCell(i+1, j)->getVertex(),
-					getSurfaceCell(i, j+1)->getVertex(),
-					getSurfaceCell(i-1, j)->getVertex()));
-        }
-    }
+	MapRowJobList jobs(this, mrpNormals, surfaceH);
+	runRowPass(jobs);
 }
 
 void Map::computeInterpolatedHeights(){
-
-	for(int i=0; i<w; ++i){
-		for(int j=0; j<h; ++j){
-			getCell(i, j)->setHeight(getSurfaceCell(toSurfCoords(Vec2i(i, j)))->getHeight());
-		}
-	}
-
-	for(int i=1; i<surfaceW-1; ++i){
-		for(int j=1; j<surfaceH-1; ++j){
-			for(int k=0; k<cellScale; ++k){
-				for(int l=0; l<cellScale; ++l){
-					if(k==0 && l==0){
-						getCell(i*cellScale, j*cellScale)->setHeight(getSurfaceCell(i, j)->getHeight());
-					}
-					else if(k!=0 && l==0){
-						getCell(i*cellScale+k, j*cellScale)->setHeight((
-							getSurfaceCell(i, j)->getHeight()+
-							getSurfaceCell(i+1, j)->getHeight())/2.f);
-					}
-					else if(l!=0 && k==0){
-						getCell(i*cellScale, j*cellScale+l)->setHeight((
-							getSurfaceCell(i, j)->getHeight()+
-							getSurfaceCell(i, j+1)->getHeight())/2.f);
-					}
-					else{
-						getCell(i*cellScale+k, j*cellScale+l)->setHeight((
-							getSurfaceCell(i, j)->getHeight()+
-							getSurfaceCell(i, j+1)->getHeight()+
-							getSurfaceCell(i+1, j)->getHeight()+
-							getSurfaceCell(i+1, j+1)->getHeight())/4.f);
-					}
-				}
-			}
-		}
-	}
+	MapRowJobList jobs(this, mrpInterpolatedHeights, surfaceH);
+	runRowPass(jobs);
 }
 
 void Map::smoothSurface(Tileset *tileset) {
 	float *oldHeights = new float[getSurfaceCellArraySize()];
+	float *newHeights = new float[getSurfaceCellArraySize()];
+	bool *cliffs = new bool[getSurfaceCellArraySize()];
 	//int arraySize=getSurfaceCellArraySize();
 
 	for (int i = 0; i < getSurfaceCellArraySize(); ++i) {
 		oldHeights[i] = surfaceCells[i].getHeight();
 	}
 
+	// The smoothed heights only read oldHeights and are computed on the
+	// workers, cliff objects are replaced here in the original order
+	MapRowJobList jobs(this, mrpSmoothSurface, surfaceH);
+	jobs.oldHeights = oldHeights;
+	jobs.newHeights = newHeights;
+	jobs.cliffs = cliffs;
+	runRowPass(jobs);
+
 	for (int i = 1; i < surfaceW - 1; ++i) {
 		for (int j = 1; j < surfaceH - 1; ++j) {
-			float height = 0.f;
-			float numUsedToSmooth = 0.f;
-			for (int k = -1; k <= 1; ++k) {
-				for (int l = -1; l <= 1; ++l) {
-#ifdef USE_STREFLOP
-					if (cliffLevel<=0.1f || cliffLevel > streflop::fabs(static_cast<streflop::Simple>(oldHeights[(j) * surfaceW + (i)]
-							- oldHeights[(j + k) * surfaceW + (i + l)]))) {
-#else
-					if (cliffLevel<=0.1f || cliffLevel > fabs(oldHeights[(j) * surfaceW + (i)]
-							- oldHeights[(j + k) * surfaceW + (i + l)])) {
-#endif
-						height += oldHeights[(j + k) * surfaceW + (i + l)];
-						numUsedToSmooth++;
-					}
-					else {
-						// we have something which should not be smoothed!
-						// This is a cliff and must be textured -> set cliff texture
-						getSurfaceCell(i, j)->setSurfaceType(5);
-						//set invisible blocking object and replace resource objects
-						//and non blocking objects with invisible blocker too
-						Object *formerObject =
-								getSurfaceCell(i, j)->getObject();
-						if (formerObject != NULL) {
-							if (formerObject->getWalkable()
-									|| formerObject->getResource() != NULL) {
-								delete formerObject;
-								formerObject = NULL;
-							}
-						}
-						if (formerObject == NULL) {
-							Object *o = new Object(tileset->getObjectType(9),
-									getSurfaceCell(i, j)->getVertex(),
-									Vec2i(i,j));
-							getSurfaceCell(i, j)->setObject(o);
-						}
+			if (cliffs[j * surfaceW + i] == true) {
+				// we have something which should not be smoothed!
+				// This is a cliff and must be textured -> set cliff texture
+				getSurfaceCell(i, j)->setSurfaceType(5);
+				//set invisible blocking object and replace resource objects
+				//and non blocking objects with invisible blocker too
+				Object *formerObject =
+						getSurfaceCell(i, j)->getObject();
+				if (formerObject != NULL) {
+					if (formerObject->getWalkable()
+							|| formerObject->getResource() != NULL) {
+						delete formerObject;
+						formerObject = NULL;
 					}
 				}
+				if (formerObject == NULL) {
+					Object *o = new Object(tileset->getObjectType(9),
+							getSurfaceCell(i, j)->getVertex(),
+							Vec2i(i,j));
+					getSurfaceCell(i, j)->setObject(o);
+				}
 			}
 
-			height /= numUsedToSmooth;
+			float height = newHeights[j * surfaceW + i];
 			if(maxMapHeight<height){
 				maxMapHeight=height;
 			}
@@ -1701,39 +1734,181 @@ void Map::smoothSurface(Tileset *tileset) {
 		}
 	}
 	delete[] oldHeights;
+	delete[] newHeights;
+	delete[] cliffs;
 }
 
 void Map::computeNearSubmerged(){
+	MapRowJobList jobs(this, mrpNearSubmerged, surfaceH);
+	runRowPass(jobs);
+}
+
+void Map::computeCellColors(){
+	MapRowJobList jobs(this, mrpCellColors, surfaceH);
+	runRowPass(jobs);
+}
+
+void Map::runRowPass(MapRowJobList &jobs) {
+	int workerCount = rowWorkerThreadCount;
+	if(workerCount < 0) {
+#ifdef WIN32
+		SYSTEM_INFO sysinfo;
+		GetSystemInfo(&sysinfo);
+		workerCount = (int)sysinfo.dwNumberOfProcessors - 1;
+#else
+		workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+#endif
+	}
+	workerCount = min(workerCount,jobs.rowCount / MapRowJobList::minRowsPerWorker);
+	if(workerCount < 0) {
+		workerCount = 0;
+	}
+
+	vector<MapRowWorkerThread *> workers;
+	for(int index = 0; index < workerCount; ++index) {
+		MapRowWorkerThread *worker = new MapRowWorkerThread(&jobs);
+		worker->start();
+		workers.push_back(worker);
+	}
 
-	for(int i=0; i<surfaceW-1; ++i){
-		for(int j=0; j<surfaceH-1; ++j){
-			bool anySubmerged= false;
-			for(int k=-1; k<=2; ++k){
-				for(int l=-1; l<=2; ++l){
-					Vec2i pos= Vec2i(i+k, j+l);
-					if(isInsideSurface(pos) && isInsideSurface(toSurfCoords(pos))) {
-						if(getSubmerged(getSurfaceCell(pos)))
-							anySubmerged= true;
+	jobs.process();
+
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		jobs.workerDone.waitTillSignalled();
+	}
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		if(workers[index]->shutdownAndJoin() == true) {
+			delete workers[index];
+		}
+	}
+
+	if(jobs.error != "") {
+		throw megaglest_runtime_error(jobs.error);
+	}
+}
+
+// Every pass writes only the cells of its own surface rows, so the rows
+// can be computed in any order with the same result
+void Map::computeRows(const MapRowJobList &jobs, int firstRow, int lastRow) {
+	switch(jobs.pass) {
+		case mrpSmoothSurface: {
+			const float *oldHeights = jobs.oldHeights;
+			for (int j = max(firstRow, 1); j < min(lastRow, surfaceH - 1); ++j) {
+				for (int i = 1; i < surfaceW - 1; ++i) {
+					float height = 0.f;
+					float numUsedToSmooth = 0.f;
+					bool cliff = false;
+					for (int k = -1; k <= 1; ++k) {
+						for (int l = -1; l <= 1; ++l) {
+#ifdef USE_STREFLOP
+							if (cliffLevel<=0.1f || cliffLevel > streflop::fabs(static_cast<streflop::Simple>(oldHeights[(j) * surfaceW + (i)]
+									- oldHeights[(j + k) * surfaceW + (i + l)]))) {
+#else
+							if (cliffLevel<=0.1f || cliffLevel > fabs(oldHeights[(j) * surfaceW + (i)]
+									- oldHeights[(j + k) * surfaceW + (i + l)])) {
+#endif
+								height += oldHeights[(j + k) * surfaceW + (i + l)];
+								numUsedToSmooth++;
+							}
+							else {
+								cliff = true;
+							}
+						}
 					}
+
+					height /= numUsedToSmooth;
+					jobs.newHeights[j * surfaceW + i] = height;
+					jobs.cliffs[j * surfaceW + i] = cliff;
 				}
 			}
-			getSurfaceCell(i, j)->setNearSubmerged(anySubmerged);
+			break;
 		}
-	}
-}
 
-void Map::computeCellColors(){
-	for(int i=0; i<surfaceW; ++i){
-		for(int j=0; j<surfaceH; ++j){
-			SurfaceCell *sc= getSurfaceCell(i, j);
-			if(getDeepSubmerged(sc)){
-				float factor= clamp(waterLevel-sc->getHeight()*1.5f, 1.f, 1.5f);
-				sc->setColor(Vec3f(1.0f, 1.0f, 1.0f)/factor);
+		case mrpNormals:
+			//compute center normals
+			for(int j = max(firstRow, 1); j < min(lastRow, surfaceH - 1); ++j) {
+				for(int i=1; i<surfaceW-1; ++i){
+					getSurfaceCell(i, j)->setNormal(
+						getSurfaceCell(i, j)->getVertex().normal(getSurfaceCell(i, j-1)->getVertex(),
+							getSurfaceCell(i+1, j)->getVertex(),
+							getSurfaceCell(i, j+1)->getVertex(),
+							getSurfaceCell(i-1, j)->getVertex()));
+				}
 			}
-			else{
-				sc->setColor(Vec3f(1.0f, 1.0f, 1.0f));
+			break;
+
+		case mrpInterpolatedHeights:
+			for(int j = firstRow; j < lastRow; ++j) {
+				for(int l = 0; l < cellScale; ++l) {
+					for(int i = 0; i < w; ++i) {
+						getCell(i, j*cellScale+l)->setHeight(getSurfaceCell(toSurfCoords(Vec2i(i, j*cellScale+l)))->getHeight());
+					}
+				}
+				if(j < 1 || j >= surfaceH - 1) {
+					continue;
+				}
+
+				for(int i=1; i<surfaceW-1; ++i){
+					for(int k=0; k<cellScale; ++k){
+						for(int l=0; l<cellScale; ++l){
+							if(k==0 && l==0){
+								getCell(i*cellScale, j*cellScale)->setHeight(getSurfaceCell(i, j)->getHeight());
+							}
+							else if(k!=0 && l==0){
+								getCell(i*cellScale+k, j*cellScale)->setHeight((
+									getSurfaceCell(i, j)->getHeight()+
+									getSurfaceCell(i+1, j)->getHeight())/2.f);
+							}
+							else if(l!=0 && k==0){
+								getCell(i*cellScale, j*cellScale+l)->setHeight((
+									getSurfaceCell(i, j)->getHeight()+
+									getSurfaceCell(i, j+1)->getHeight())/2.f);
+							}
+							else{
+								getCell(i*cellScale+k, j*cellScale+l)->setHeight((
+									getSurfaceCell(i, j)->getHeight()+
+									getSurfaceCell(i, j+1)->getHeight()+
+									getSurfaceCell(i+1, j)->getHeight()+
+									getSurfaceCell(i+1, j+1)->getHeight())/4.f);
+							}
+						}
+					}
+				}
 			}
-		}
+			break;
+
+		case mrpNearSubmerged:
+			for(int j = firstRow; j < min(lastRow, surfaceH - 1); ++j) {
+				for(int i=0; i<surfaceW-1; ++i){
+					bool anySubmerged= false;
+					for(int k=-1; k<=2; ++k){
+						for(int l=-1; l<=2; ++l){
+							Vec2i pos= Vec2i(i+k, j+l);
+							if(isInsideSurface(pos) && isInsideSurface(toSurfCoords(pos))) {
+								if(getSubmerged(getSurfaceCell(pos)))
+									anySubmerged= true;
+							}
+						}
+					}
+					getSurfaceCell(i, j)->setNearSubmerged(anySubmerged);
+				}
+			}
+			break;
+
+		case mrpCellColors:
+			for(int j = firstRow; j < lastRow; ++j) {
+				for(int i=0; i<surfaceW; ++i){
+					SurfaceCell *sc= getSurfaceCell(i, j);
+					if(getDeepSubmerged(sc)){
+						float factor= clamp(waterLevel-sc->getHeight()*1.5f, 1.f, 1.5f);
+						sc->setColor(Vec3f(1.0f, 1.0f, 1.0f)/factor);
+					}
+					else{
+						sc->setColor(Vec3f(1.0f, 1.0f, 1.0f));
+					}
+				}
+			}
+			break;
 	}
 }
 
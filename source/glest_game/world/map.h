@@ -206,11 +206,25 @@ public:
 	std::map<Vec2i,std::map<Vec2i,bool> > cachedCanMoveSoonList;
 };
 
+enum MapRowPass {
+	mrpSmoothSurface,
+	mrpNormals,
+	mrpInterpolatedHeights,
+	mrpNearSubmerged,
+	mrpCellColors
+};
+
+class MapRowJobList;
+
 class Map {
 public:
-	static const int cellScale;	//number of cells per surfaceCell
+	static const int cellScale = 2;	//number of cells per surfaceCell
 	static const int mapScale;	//horizontal scale of surface
 
+	// Extra threads for the full map terrain passes, -1 uses one less than
+	// there are cores and 0 runs them on the calling thread only
+	static int rowWorkerThreadCount;
+
 private:
 	string title;
 	float waterLevel;
@@ -479,10 +493,14 @@ public:
 	void loadGame(const XmlNode *rootNode,World *world);
 
 private:
+	friend class MapRowJobList;
+
 	//compute
 	void smoothSurface(Tileset *tileset);
 	void computeNearSubmerged();
 	void computeCellColors();
+	void runRowPass(MapRowJobList &jobs);
+	void computeRows(const MapRowJobList &jobs, int firstRow, int lastRow);
     void putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut, bool isMorph);
 };
 
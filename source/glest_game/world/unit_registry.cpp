@@ -0,0 +1,115 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "unit_registry.h"
+
+#include "unit.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class UnitRegistry
+// =====================================================
+
+UnitRegistry::UnitRegistry() {
+	unitCount = 0;
+}
+
+UnitRegistry::~UnitRegistry() {
+	clear();
+}
+
+void UnitRegistry::clear() {
+	for(unsigned int i = 0; i < pages.size(); ++i) {
+		delete [] pages[i];
+	}
+	pages.clear();
+	unitCount = 0;
+}
+
+UnitRegistrySlot *UnitRegistry::getSlot(int id) {
+	if(id < 0) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Invalid unit id [%d] for the unit registry",id);
+		throw megaglest_runtime_error(szBuf);
+	}
+
+	unsigned int pageIndex = (unsigned int)(id >> pageBits);
+	if(pageIndex >= pages.size()) {
+		pages.resize(pageIndex + 1, NULL);
+	}
+	if(pages[pageIndex] == NULL) {
+		pages[pageIndex] = new UnitRegistrySlot[pageSize];
+	}
+	return &pages[pageIndex][id & (pageSize - 1)];
+}
+
+void UnitRegistry::add(Unit *unit, int unitIndex) {
+	UnitRegistrySlot *slot = getSlot(unit->getId());
+	if(slot->unit != NULL && slot->unit != unit) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Unit id [%d] is already registered",unit->getId());
+		throw megaglest_runtime_error(szBuf);
+	}
+	if(slot->unit == NULL) {
+		unitCount++;
+	}
+	slot->unit = unit;
+	slot->unitIndex = unitIndex;
+}
+
+uint8 UnitRegistry::remove(int id) {
+	if(find(id) == NULL) {
+		return 0;
+	}
+	UnitRegistrySlot *slot = getSlot(id);
+	uint8 flags = slot->flags;
+	*slot = UnitRegistrySlot();
+	unitCount--;
+	return flags;
+}
+
+int UnitRegistry::getUnitIndex(int id) const {
+	const UnitRegistrySlot *slot = findSlot(id);
+	return (slot != NULL && slot->unit != NULL ? slot->unitIndex : -1);
+}
+
+void UnitRegistry::setUnitIndex(int id, int unitIndex) {
+	if(find(id) != NULL) {
+		getSlot(id)->unitIndex = unitIndex;
+	}
+}
+
+uint8 UnitRegistry::getFlags(int id) const {
+	const UnitRegistrySlot *slot = findSlot(id);
+	return (slot != NULL ? slot->flags : 0);
+}
+
+uint8 UnitRegistry::setFlags(int id, uint8 flags) {
+	UnitRegistrySlot *slot = getSlot(id);
+	uint8 oldFlags = slot->flags;
+	slot->flags = flags;
+	return oldFlags;
+}
+
+int UnitRegistry::getPageCount() const {
+	int result = 0;
+	for(unsigned int i = 0; i < pages.size(); ++i) {
+		if(pages[i] != NULL) {
+			result++;
+		}
+	}
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,101 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_UNITREGISTRY_H_
+#define _GLEST_GAME_UNITREGISTRY_H_
+
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using namespace Shared::Platform;
+
+namespace Glest{ namespace Game{
+
+class Unit;
+
+enum UnitRegistryFlag {
+	urfAlive		= 0x01,
+	urfMobile		= 0x02,
+	urfBeingBuilt	= 0x04
+};
+
+// =====================================================
+// 	class UnitRegistrySlot
+// =====================================================
+
+class UnitRegistrySlot {
+public:
+	Unit *unit;
+	// Position in the units of its faction
+	int unitIndex;
+	// UnitRegistryFlag bits, kept before the unit is added
+	uint8 flags;
+
+	UnitRegistrySlot() : unit(NULL), unitIndex(-1), flags(0) {}
+};
+
+// =====================================================
+// 	class UnitRegistry
+//
+///	Every unit of the world indexed by id. Ids are handed
+/// out in dense runs per faction and never reused, so the
+/// id is its own generation: a removed unit's id finds NULL
+/// from then on. Slots live in fixed size pages allocated
+/// the first time an id in their range shows up.
+// =====================================================
+
+class UnitRegistry {
+private:
+	static const int pageBits = 10;
+	static const int pageSize = 1 << pageBits;
+
+	vector<UnitRegistrySlot *> pages;
+	int unitCount;
+
+	inline const UnitRegistrySlot *findSlot(int id) const {
+		if(id < 0 || (id >> pageBits) >= (int)pages.size() || pages[id >> pageBits] == NULL) {
+			return NULL;
+		}
+		return &pages[id >> pageBits][id & (pageSize - 1)];
+	}
+	// Allocates the page on first use
+	UnitRegistrySlot *getSlot(int id);
+
+public:
+	UnitRegistry();
+	~UnitRegistry();
+
+	void clear();
+
+	void add(Unit *unit, int unitIndex);
+	// Returns the flags the unit had
+	uint8 remove(int id);
+
+	inline Unit *find(int id) const {
+		const UnitRegistrySlot *slot = findSlot(id);
+		return (slot != NULL ? slot->unit : NULL);
+	}
+	int getUnitIndex(int id) const;
+	void setUnitIndex(int id, int unitIndex);
+
+	uint8 getFlags(int id) const;
+	// Returns the flags before the change
+	uint8 setFlags(int id, uint8 flags);
+
+	inline int getUnitCount() const	{ return unitCount; }
+	int getPageCount() const;
+};
+
+}}//end namespace
+
+#endif
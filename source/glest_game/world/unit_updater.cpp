@@ -28,6 +28,7 @@
 #include "sound_renderer.h"
 #include "upgrade.h"
 #include "unit.h"
+#include "sim_math.h"
 
 #include "leak_dumper.h"
 
@@ -43,7 +44,8 @@ namespace Glest{ namespace Game{
 // ===================== PUBLIC ========================
 
 UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)),
-		mutexUnitRangeCellsLookupItemCache(new Mutex(CODE_AT_LINE)) {
+		mutexUnitRangeCellsLookupItemCache(new Mutex(CODE_AT_LINE)),
+		rangeScratchArena(GameConstants::maxPlayers + 1) {
     this->game= NULL;
 	this->gui= NULL;
 	this->gameCamera= NULL;
@@ -97,7 +99,7 @@ UnitUpdater::~UnitUpdater() {
 	delete pathFinder;
 	pathFinder = NULL;
 
-	MutexSafeWrapper safeMutex(mutexAttackWarnings,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(mutexAttackWarnings,CODE_AT_LINE);
 	while(attackWarnings.empty() == false) {
 		AttackWarningData* awd = attackWarnings.back();
 		attackWarnings.pop_back();
@@ -288,7 +290,7 @@ bool UnitUpdater::updateUnit(Unit *unit) {
 
 			//play water sound
 			if(map->getCell(unit->getPos())->getHeight() < map->getWaterLevel() && unit->getCurrField() == fLand) {
-				if(Config::getInstance().getBool("DisableWaterSounds","false") == false) {
+				if(Config::getInstance().getSnapshot().disableWaterSounds == false) {
 					soundRenderer.playFx(
 						CoreData::getInstance().getWaterSound(),
 						unit->getCurrMidHeightVector(),
@@ -1402,7 +1404,7 @@ void UnitUpdater::updateHarvest(Unit *unit, int frameIndex) {
 	    							isNearResource = map->isResourceNear(frameIndex,unit->getPos(), r->getType(), targetPos,unit->getType()->getSize(),unit);
 	    						}
 	    						if(isNearResource == true) {
-	    							if((unit->getPos().dist(command->getPos()) < harvestDistance || unit->getPos().dist(targetPos) < harvestDistance) && isNearResource == true) {
+	    							if((isInsideRadius(unit->getPos(), command->getPos(), harvestDistance) || isInsideRadius(unit->getPos(), targetPos, harvestDistance)) && isNearResource == true) {
 	    								canHarvestDestPos = true;
 	    							}
 	    						}
@@ -1517,7 +1519,7 @@ void UnitUpdater::updateHarvest(Unit *unit, int frameIndex) {
 									{
 										bool isNearResource = map->isResourceNear(frameIndex,unit->getPos(), r->getType(), targetPos,unit->getType()->getSize(),unit,true);
 										if(isNearResource == true) {
-											if((unit->getPos().dist(command->getPos()) < harvestDistance || unit->getPos().dist(targetPos) < harvestDistance) && isNearResource == true) {
+											if((isInsideRadius(unit->getPos(), command->getPos(), harvestDistance) || isInsideRadius(unit->getPos(), targetPos, harvestDistance)) && isNearResource == true) {
 												canHarvestDestPos = true;
 											}
 										}
@@ -2773,7 +2775,8 @@ bool UnitUpdater::findCachedCellsEnemies(Vec2i center, int range, int size, vect
 										 const AttackSkillType *ast, const Unit *unit,
 										 const Unit *commandTarget) {
 	bool result = false;
-	MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,mutexOwnerId);
 	std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterFind = UnitRangeCellsLookupItemCache.find(center);
 
 	if(iterFind != UnitRangeCellsLookupItemCache.end()) {
@@ -2851,14 +2854,23 @@ void UnitUpdater::findEnemiesForCell(const Vec2i pos, int size, int sightRange,
 	}
 }
 
+vector<Unit*> & UnitUpdater::acquireRangeScratchList(const Unit *unit, bool evalMode) {
+	// evalMode is only set by the faction worker threads which each update
+	// their own faction's units, everything else runs on the main thread
+	int slot = 0;
+	if(evalMode == true) {
+		slot = unit->getFactionIndex() + 1;
+	}
+	return rangeScratchArena.acquire(slot);
+}
+
 //if the unit has any enemy on range
 bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 							  const AttackSkillType *ast,bool evalMode) {
 	bool result=false;
 
 	try {
-	vector<Unit*> enemies;
-    enemies.reserve(100);
+	vector<Unit*> &enemies = acquireRangeScratchList(unit,evalMode);
 
 	//we check command target
 	const Unit *commandTarget = NULL;
@@ -2871,7 +2883,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 	//aux vars
 	int size 			= unit->getType()->getSize();
 	Vec2i center 		= unit->getPos();
-	Vec2f floatCenter	= unit->getFloatCenteredPos();
+	Vec2i doubledCenter	= getDoubledCenter(center, size);
 
 	//bool foundInCache = true;
 	if(findCachedCellsEnemies(center,range,size,enemies,ast,
@@ -2883,11 +2895,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 		for(int i = center.x - range; i < center.x + range + size; ++i) {
 			for(int j = center.y - range; j < center.y + range + size; ++j) {
 				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-				if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
+				if(map->isInside(i, j) && isCellInRange(doubledCenter, i, j, range+1) == true){
 					Cell *cell = map->getCell(i,j);
 					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
 
@@ -2899,7 +2907,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 
 		// Ok update our caches with the latest info
 		if(cacheItem.rangeCellList.empty() == false) {
-			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,CODE_AT_LINE);
 
 			UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
 		}
@@ -2916,7 +2924,8 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 	bool isMega= controlType == ctCpuMega || controlType == ctNetworkCpuMega;
 
 
-	string randomInfoData = "enemies.size() = " + intToStr(enemies.size());
+	bool trackRandomCaller = (unit->getRandom()->getDisableLastCallerTracking() == false);
+	Vec2i unitCenteredPos = unit->getCenteredPos();
 
 	//printf("unit %d has control:%d\n",unit->getId(),controlType);
     for(int i = 0; i< (int)enemies.size(); ++i) {
@@ -2937,7 +2946,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
     		// Attackers get first priority
     		if(enemy->getType()->hasSkillClass(scAttack) == true) {
 
-    			float currentDist = unit->getCenteredPos().dist(enemy->getCenteredPos());
+    			float currentDist = unitCenteredPos.dist(enemy->getCenteredPos());
 
     			//randomInfoData += " currentDist = " + floatToStr(currentDist);
 
@@ -2964,9 +2973,14 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 
     if(evalMode == false && (isUltra || isMega)) {
 
-    	unit->getRandom()->addLastCaller(randomInfoData);
+    	// The caller strings are only kept for network CRC debugging
+    	string randomCaller = "";
+    	if(trackRandomCaller == true) {
+    		unit->getRandom()->addLastCaller("enemies.size() = " + intToStr(enemies.size()));
+    		randomCaller = extractFileFromDirectoryPath(__FILE__) + intToStr(__LINE__);
+    	}
 
-    	if( attackingEnemySeen!=NULL && unit->getRandom()->randRange(0,2,extractFileFromDirectoryPath(__FILE__) + intToStr(__LINE__)) != 2 ) {
+    	if( attackingEnemySeen!=NULL && unit->getRandom()->randRange(0,2,randomCaller) != 2 ) {
     		*rangedPtr 	= attackingEnemySeen;
     		enemySeen 	= attackingEnemySeen;
     		//printf("Da hat er wen gefunden:%s\n",enemySeen->getType()->getName(false).c_str());
@@ -3000,7 +3014,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 			float nearestDistance		= 0.f;
 
 
-			MutexSafeWrapper safeMutex(mutexAttackWarnings,string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexAttackWarnings,CODE_AT_LINE);
 			for(int i = (int)attackWarnings.size() - 1; i >= 0; --i) {
 				if(world->getFrameCount() - attackWarnings[i]->lastFrameCount > 200) { //after 200 frames attack break we warn again
 					AttackWarningData *toDelete =attackWarnings[i];
@@ -3049,7 +3063,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 	    		awd->attackPosition.x=enemyFloatCenter.x;
 	    		awd->attackPosition.y=enemyFloatCenter.y;
 
-				MutexSafeWrapper safeMutex(mutexAttackWarnings,string(__FILE__) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(mutexAttackWarnings,CODE_AT_LINE);
 	    		attackWarnings.push_back(awd);
 
 	    		if(world->getAttackWarningsEnabled() == true) {
@@ -3106,7 +3120,7 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 	//aux vars
 	int size 			= unit->getType()->getSize();
 	Vec2i center 		= unit->getPosNotThreadSafe();
-	Vec2f floatCenter	= unit->getFloatCenteredPos();
+	Vec2i doubledCenter	= getDoubledCenter(center, size);
 
 	//bool foundInCache = true;
 	if(findCachedCellsEnemies(center,range,size,enemies,ast,
@@ -3118,11 +3132,7 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 		for(int i = center.x - range; i < center.x + range + size; ++i) {
 			for(int j = center.y - range; j < center.y + range + size; ++j) {
 				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-				if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
+				if(map->isInside(i, j) && isCellInRange(doubledCenter, i, j, range+1) == true){
 					Cell *cell = map->getCell(i,j);
 					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
 
@@ -3133,7 +3143,7 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 
 		// Ok update our caches with the latest info
 		if(cacheItem.rangeCellList.empty() == false) {
-			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
+			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,CODE_AT_LINE);
 
 			UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
 		}
@@ -3196,18 +3206,14 @@ vector<Unit*> UnitUpdater::findUnitsInRange(const Unit *unit, int radius) {
 	//aux vars
 	int size 			= unit->getType()->getSize();
 	Vec2i center 		= unit->getPosNotThreadSafe();
-	Vec2f floatCenter	= unit->getFloatCenteredPos();
+	Vec2i doubledCenter	= getDoubledCenter(center, size);
 
 	//nearby cells
 	//UnitRangeCellsLookupItem cacheItem;
 	for(int i = center.x - range; i < center.x + range + size; ++i) {
 		for(int j = center.y - range; j < center.y + range + size; ++j) {
 			//cells inside map and in range
-#ifdef USE_STREFLOP
-			if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-			if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
+			if(map->isInside(i, j) && isCellInRange(doubledCenter, i, j, range+1) == true){
 				Cell *cell = map->getCell(i,j);
 				findUnitsForCell(cell,units);
 			}
@@ -3225,7 +3231,7 @@ string UnitUpdater::getUnitRangeCellsLookupItemCacheStats() {
 	int rangeCount = 0;
 	int rangeCountCellCount = 0;
 
-	MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,CODE_AT_LINE);
 	for(std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterMap1 = UnitRangeCellsLookupItemCache.begin();
 		iterMap1 != UnitRangeCellsLookupItemCache.end(); ++iterMap1) {
 		posCount++;
@@ -20,11 +20,13 @@
 #include "gui.h"
 #include "particle.h"
 #include "randomgen.h"
+#include "scratch_arena.h"
 #include "command.h"
 #include "leak_dumper.h"
 
 using Shared::Graphics::ParticleObserver;
 using Shared::Util::RandomGen;
+using Shared::Util::ScratchArena;
 
 namespace Glest{ namespace Game{
 
@@ -89,6 +91,12 @@ private:
 	//std::map<int,ExploredCellsLookupKey> ExploredCellsLookupItemCacheTimer;
 	//int UnitRangeCellsLookupItemCacheTimerCount;
 
+	// Candidate buffers for unitOnRange, slot 0 is the main thread and
+	// slot 1 + faction index is that faction's worker thread
+	ScratchArena<Unit*> rangeScratchArena;
+
+	vector<Unit*> & acquireRangeScratchList(const Unit *unit, bool evalMode);
+
 	bool findCachedCellsEnemies(Vec2i center, int range,
 								int size, vector<Unit*> &enemies,
 								const AttackSkillType *ast, const Unit *unit,
@@ -22,6 +22,7 @@
 #include "sound_renderer.h"
 #include "game_settings.h"
 #include "cache_manager.h"
+#include "sim_math.h"
 #include <iostream>
 #include "sound.h"
 #include "sound_renderer.h"
@@ -105,6 +106,7 @@ void World::cleanup() {
 		delete factions[i];
 	}
 	factions.clear();
+	unitRegistry.clear();
 
 #ifdef LEAK_CHECK_UNITS
 	printf("%s::%s\n",__FILE__,__FUNCTION__);
@@ -186,6 +188,7 @@ void World::end(){
 		delete factions[i];
 	}
 	factions.clear();
+	unitRegistry.clear();
 
 #ifdef LEAK_CHECK_UNITS
 	printf("%s::%s\n",__FILE__,__FUNCTION__);
@@ -572,7 +575,7 @@ void World::updateAllTilesetObjects() {
 }
 
 void World::updateAllFactionUnits() {
-	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+	bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 	Chrono chronoPerf;
 	if(showPerfStats) chronoPerf.start();
 	char perfBuf[8096]="";
@@ -615,7 +618,7 @@ void World::updateAllFactionUnits() {
 	Chrono chrono;
 	chrono.start();
 
-	const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
+	const bool newThreadManager = Config::getInstance().getSnapshot().enableNewThreadManager;
 	if(newThreadManager == true) {
 		masterController.signalSlaves(&frameCount);
 		bool slavesCompleted = masterController.waitTillSlavesTrigger(20000);
@@ -825,7 +828,7 @@ void World::update() {
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+	bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 	Chrono chronoPerf;
 	char perfBuf[8096]="";
 	std::vector<string> perfList;
@@ -963,7 +966,7 @@ bool World::canTickWorld() const {
 }
 
 void World::tick() {
-	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
+	bool showPerfStats = Config::getInstance().getSnapshot().showPerfStats;
 	Chrono chronoPerf;
 	char perfBuf[8096]="";
 	std::vector<string> perfList;
@@ -1083,14 +1086,7 @@ void World::tick() {
 }
 
 Unit* World::findUnitById(int id) const {
-	for(int i= 0; i<getFactionCount(); ++i) {
-		const Faction* faction= getFaction(i);
-		Unit* unit = faction->findUnit(id);
-		if(unit != NULL) {
-			return unit;
-		}
-	}
-	return NULL;
+	return unitRegistry.find(id);
 }
 
 const UnitType* World::findUnitTypeById(const FactionType* factionType, int id) {
@@ -2064,7 +2060,7 @@ void World::initFactionTypes(GameSettings *gs) {
 		}
 	}
 
-	if(Config::getInstance().getBool("EnableNewThreadManager","false") == true) {
+	if(Config::getInstance().getSnapshot().enableNewThreadManager == true) {
 		std::vector<SlaveThreadControllerInterface *> slaveThreadList;
 		for(unsigned int i = 0; i < factions.size(); ++i) {
 			Faction *faction = factions[i];
@@ -2085,7 +2081,7 @@ void World::initFactionTypes(GameSettings *gs) {
 
 		//printf("**LOAD World thisFactionIndex = %d\n",thisFactionIndex);
 
-		MutexSafeWrapper safeMutex(mutexFactionNextUnitId,string(__FILE__) + "_" + intToStr(__LINE__));
+		MutexSafeWrapper safeMutex(mutexFactionNextUnitId,CODE_AT_LINE);
 	//	std::map<int,int> mapFactionNextUnitId;
 //		for(std::map<int,int>::iterator iterMap = mapFactionNextUnitId.begin();
 //				iterMap != mapFactionNextUnitId.end(); ++iterMap) {
@@ -2412,14 +2408,13 @@ ExploredCellsLookupItem World::exploreCells(const Vec2i &newPos, int sightRange,
 				}
 
 				//explore
-				float posLength = currRelPos.length();
-				if(posLength < surfSightRange + indirectSightRange + 1) {
+				if(isInsideRadius(currRelPos, surfSightRange + indirectSightRange + 1) == true) {
                     sc->setExplored(teamIndex, true);
                     exploredCellsCache.exploredCellList.push_back(sc);
 				}
 
 				//visible
-				if(posLength < surfSightRange) {
+				if(isInsideRadius(currRelPos, surfSightRange) == true) {
 					sc->setVisible(teamIndex, true);
 					exploredCellsCache.visibleCellList.push_back(sc);
 				}
@@ -2607,7 +2602,7 @@ void World::computeFow() {
 					unit->isOperative() == true) {
 
 				const FowAlphaCellsLookupItem &cellList = unit->getCachedFow();
-				for(std::map<Vec2i,float>::const_iterator iterMap = cellList.surfPosAlphaList.begin();
+				for(FowAlphaCellsLookupItem::SurfPosAlphaList::const_iterator iterMap = cellList.surfPosAlphaList.begin();
 					iterMap != cellList.surfPosAlphaList.end(); ++iterMap) {
 					const Vec2i &surfPos = iterMap->first;
 					const float &alpha = iterMap->second;
@@ -2636,7 +2631,7 @@ const GameSettings * World::getGameSettings() const {
 // Calculates the unit unit ID for each faction
 //
 int World::getNextUnitId(Faction *faction)	{
-	MutexSafeWrapper safeMutex(mutexFactionNextUnitId,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(mutexFactionNextUnitId,CODE_AT_LINE);
 	if(mapFactionNextUnitId.find(faction->getIndex()) == mapFactionNextUnitId.end()) {
 		mapFactionNextUnitId[faction->getIndex()] = faction->getIndex() * 100000;
 	}
@@ -2822,6 +2817,17 @@ string World::getFowAlphaCellsLookupItemCacheStats() {
 	return result;
 }
 
+string World::getUnitMemoryStats() {
+	UnitMemoryUsage usage;
+	for(int factionIndex = 0; factionIndex < getFactionCount(); ++factionIndex) {
+		Faction *faction= getFaction(factionIndex);
+		for(int unitIndex = 0; unitIndex < faction->getUnitCount(); ++unitIndex) {
+			faction->getUnit(unitIndex)->addMemoryUsage(usage);
+		}
+	}
+	return usage.toString();
+}
+
 string World::getAllFactionsCacheStats() {
 	string result = "";
 
@@ -2984,7 +2990,7 @@ void World::saveGame(XmlNode *rootNode) {
 	worldNode->addAttribute("frameCount",intToStr(frameCount), mapTagReplacements);
 //	//int nextUnitId;
 //	Mutex mutexFactionNextUnitId;
-	MutexSafeWrapper safeMutex(mutexFactionNextUnitId,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutex(mutexFactionNextUnitId,CODE_AT_LINE);
 //	std::map<int,int> mapFactionNextUnitId;
 	for(std::map<int,int>::iterator iterMap = mapFactionNextUnitId.begin();
 			iterMap != mapFactionNextUnitId.end(); ++iterMap) {
@@ -33,6 +33,7 @@
 #include "water_effects.h"
 #include "faction.h"
 #include "unit_updater.h"
+#include "unit_registry.h"
 #include "randomgen.h"
 #include "game_constants.h"
 #include "leak_dumper.h"
@@ -96,6 +97,7 @@ private:
     Stats stats;	//BattleEnd will delete this object
 
 	Factions factions;
+	UnitRegistry unitRegistry;
 
 	RandomGen random;
 
@@ -302,6 +304,7 @@ public:
 	bool showWorldForPlayer(int factionIndex, bool excludeFogOfWarCheck=false) const;
 
 	inline UnitUpdater * getUnitUpdater() { return &unitUpdater; }
+	inline UnitRegistry * getUnitRegistry() { return &unitRegistry; }
 
 	void playStaticVideo(const string &playVideo);
 	void playStreamingVideo(const string &playVideo);
@@ -312,6 +315,7 @@ public:
 
 	string getExploredCellsLookupItemCacheStats();
 	string getFowAlphaCellsLookupItemCacheStats();
+	string getUnitMemoryStats();
 	string getAllFactionsCacheStats();
 
 	void placeUnitAtLocation(const Vec2i &location, int radius, Unit *unit, bool spaciated);
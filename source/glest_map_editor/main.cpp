@@ -489,6 +489,7 @@ void MainWindow::onClose(wxCloseEvent &event) {
 void MainWindow::setupStartupSettings() {
 	string playerName = Config::getInstance().getString("NetPlayerName","");
 	program = new Program(glCanvas->GetClientSize().x, glCanvas->GetClientSize().y, playerName);
+	program->setUndoMemoryBudget(Config::getInstance().getInt("MapEditorUndoMemoryMB",intToStr(Program::defaultUndoMemoryMB).c_str()));
 	fileName = "New (unsaved) Map";
 
 	//printf("#0 file load [%s]\n",currentFile.c_str());
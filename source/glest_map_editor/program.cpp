@@ -13,6 +13,7 @@
 #include "program.h"
 #include "util.h"
 #include <iostream>
+#include <algorithm>
 #include "platform_util.h"
 
 using namespace Shared::Util;
@@ -22,120 +23,109 @@ namespace MapEditor {
 ////////////////////////////
 // class UndoPoint
 ////////////////////////////
-int UndoPoint::w = 0;
-int UndoPoint::h = 0;
+size_t UndoPoint::tileBytes = 0;
 
 UndoPoint::UndoPoint()
 		: change(ctNone)
-		, surface(0)
-		, object(0)
-		, resource(0)
-		, height(0) {
-	w = Program::map->getW();
-	h = Program::map->getH();
-}
-/*
-UndoPoint::UndoPoint(ChangeType change) {
-	w = Program::map->getW();
-	h = Program::map->getH();
-
-	init(change);
-}*/
-
-void UndoPoint::init(ChangeType change) {
-	this->change = change;
-	switch (change) {
-		// Back up everything
-		case ctAll:
-		// Back up heights
-		case ctHeight:
-		case ctGradient:
-			// Build an array of heights from the map
-			//std::cout << "Building an array of heights to use for our UndoPoint" << std::endl;
-			height = new float[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 height[j * w + i] = Program::map->getHeight(i, j);
-				}
-			}
-			//std::cout << "Built the array" << std::endl;
-			if (change != ctAll) break;
-		// Back up surfaces
-		case ctSurface:
-			surface = new int[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 surface[j * w + i] = Program::map->getSurface(i, j);
-				}
-			}
-			if (change != ctAll) break;
-		// Back up both objects and resources if either changes
-		case ctObject:
-		case ctResource:
-			object = new int[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 object[j * w + i] = Program::map->getObject(i, j);
-				}
-			}
-			resource = new int[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 resource[j * w + i] = Program::map->getResource(i, j);
-				}
-			}
-			break;
+		, w(0)
+		, h(0)
+		, tilesW(0)
+		, tilesH(0) {
+}
+
+UndoPoint::UndoPoint(const UndoPoint &obj)
+		: change(obj.change)
+		, w(obj.w)
+		, h(obj.h)
+		, tilesW(obj.tilesW)
+		, tilesH(obj.tilesH)
+		, tiles(obj.tiles) {
+	for (unsigned int i = 0; i < tiles.size(); ++i) {
+		tiles[i]->refCount++;
+	}
+}
+
+UndoPoint & UndoPoint::operator=(const UndoPoint &obj) {
+	if (this != &obj) {
+		// Take the new references first, obj may share our tiles
+		for (unsigned int i = 0; i < obj.tiles.size(); ++i) {
+			obj.tiles[i]->refCount++;
+		}
+		releaseTiles();
+		change = obj.change;
+		w = obj.w;
+		h = obj.h;
+		tilesW = obj.tilesW;
+		tilesH = obj.tilesH;
+		tiles = obj.tiles;
 	}
+	return *this;
 }
 
 UndoPoint::~UndoPoint() {
-	delete [] height;
-	delete [] resource;
-	delete [] object;
-	delete [] surface;
-}
-
-void UndoPoint::revert() {
-	//std::cout << "attempting to revert last changes to " << undoID << std::endl;
-	switch (change) {
-		// Revert Everything
-		case ctAll:
-		// Revert Heights
-		case ctHeight:
-		case ctGradient:
-			// Restore the array of heights to the map
-			//std::cout << "attempting to restore the height array" << std::endl;
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setHeight(i, j, height[j * w + i]);
-				}
-			}
-			if (change != ctAll) break;
-		// Revert surfaces
-		case ctSurface:
-			//std::cout << "attempting to restore the surface array" << std::endl;
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setSurface(i, j, static_cast<MapSurfaceType>(surface[j * w + i]));
-				}
+	releaseTiles();
+}
+
+void UndoPoint::releaseTiles() {
+	for (unsigned int i = 0; i < tiles.size(); ++i) {
+		tiles[i]->refCount--;
+		if (tiles[i]->refCount == 0) {
+			tileBytes -= tiles[i]->cells.getMemoryBytes();
+			delete tiles[i];
+		}
+	}
+	tiles.clear();
+}
+
+void UndoPoint::init(ChangeType change, const UndoPoint &previous) {
+	MapPreview *map = Program::map;
+	releaseTiles();
+
+	// All layers are kept whatever the change type, unchanged tiles
+	// cost nothing
+	this->change = change;
+	w = map->getW();
+	h = map->getH();
+	tilesW = map->getTilesW();
+	tilesH = map->getTilesH();
+	bool sameSize = (previous.w == w && previous.h == h);
+
+	tiles.resize(tilesW * tilesH, NULL);
+	for (int tileY = 0; tileY < tilesH; ++tileY) {
+		for (int tileX = 0; tileX < tilesW; ++tileX) {
+			int index = tileY * tilesW + tileX;
+			UndoTile *tile = NULL;
+			if (sameSize && previous.tiles[index]->cells.stamp == map->getTileStamp(tileX, tileY)) {
+				tile = previous.tiles[index];
 			}
-			if (change != ctAll) break;
-		// Revert objects and resources
-		case ctObject:
-		case ctResource:
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setObject(i, j, object[j * w + i]);
-				}
+			else {
+				tile = new UndoTile();
+				map->copyTile(tileX, tileY, tile->cells);
+				tileBytes += tile->cells.getMemoryBytes();
 			}
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setResource(i, j, resource[j * w + i]);
-				}
+			tile->refCount++;
+			tiles[index] = tile;
+		}
+	}
+}
+
+void UndoPoint::revert() const {
+	if (tiles.empty()) {
+		return;
+	}
+	MapPreview *map = Program::map;
+	// Undoing a resize, every tile is put back below
+	if (map->getW() != w || map->getH() != h) {
+		map->reset(w, h, (float)DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
+	}
+	for (int tileY = 0; tileY < tilesH; ++tileY) {
+		for (int tileX = 0; tileX < tilesW; ++tileX) {
+			const UndoTile *tile = tiles[tileY * tilesW + tileX];
+			if (map->getTileStamp(tileX, tileY) != tile->cells.stamp) {
+				map->restoreTile(tileX, tileY, tile->cells);
 			}
-			break;
+		}
 	}
-	//std::cout << "reverted changes (we hope)" << std::endl;
 }
 
 // ===============================================
@@ -151,6 +141,7 @@ Program::Program(int w, int h, string playerName) {
 	hideWater=false;
 	ofsetX = 0;
 	ofsetY = 0;
+	undoMemoryBudget = defaultUndoMemoryMB * 1024 * 1024;
 
 	map = new MapPreview();
 	resetFactions(8);
@@ -161,6 +152,8 @@ Program::Program(int w, int h, string playerName) {
 void Program::init() {
 	undoStack = ChangeStack();
 	redoStack = ChangeStack();
+	lastUndoPoint = UndoPoint();
+	undoMemoryBudget = defaultUndoMemoryMB * 1024 * 1024;
 	cellSize = 5;
 	grid=false;
 	heightmap=false;
@@ -171,6 +164,7 @@ void Program::init() {
 }
 
 Program::~Program() {
+	clearUndoHistory();
 	delete map;
 	map = NULL;
 }
@@ -233,9 +227,11 @@ void Program::setUndoPoint(ChangeType change) {
 	if (change == ctLocation) return;
 
 	undoStack.push(UndoPoint());
-	undoStack.top().init(change);
+	undoStack.top().init(change, lastUndoPoint);
+	lastUndoPoint = undoStack.top();
 
 	redoStack.clear();
+	trimUndoHistory();
 }
 
 bool Program::undo() {
@@ -244,10 +240,12 @@ bool Program::undo() {
 	}
 	// push current state onto redo stack
 	redoStack.push(UndoPoint());
-	redoStack.top().init(undoStack.top().getChange());
+	redoStack.top().init(undoStack.top().getChange(), lastUndoPoint);
 
 	undoStack.top().revert();
+	lastUndoPoint = undoStack.top();
 	undoStack.pop();
+	trimUndoHistory();
 	return true;
 }
 
@@ -257,13 +255,46 @@ bool Program::redo() {
 	}
 	// push current state onto undo stack
 	undoStack.push(UndoPoint());
-	undoStack.top().init(redoStack.top().getChange());
+	undoStack.top().init(redoStack.top().getChange(), lastUndoPoint);
 
 	redoStack.top().revert();
+	lastUndoPoint = redoStack.top();
 	redoStack.pop();
+	trimUndoHistory();
 	return true;
 }
 
+void Program::clearUndoHistory() {
+	undoStack.clear();
+	redoStack.clear();
+	lastUndoPoint = UndoPoint();
+}
+
+// Drops the oldest undo points, then the furthest redo points, until the
+// history fits the budget. The last step either way is always kept.
+void Program::trimUndoHistory() {
+	while (getUndoMemoryBytes() > undoMemoryBudget) {
+		if (undoStack.size() > 1) {
+			undoStack.dropOldest();
+		}
+		else if (redoStack.size() > 1) {
+			redoStack.dropOldest();
+		}
+		else {
+			break;
+		}
+	}
+}
+
+void Program::setUndoMemoryBudget(int megaBytes) {
+	undoMemoryBudget = (size_t)std::max(megaBytes, 1) * 1024 * 1024;
+	trimUndoHistory();
+}
+
+size_t Program::getUndoMemoryBytes() const {
+	return UndoPoint::getTileBytes() + undoStack.getMemoryBytes() + redoStack.getMemoryBytes();
+}
+
 void Program::renderMap(int w, int h) {
 	if(map) renderer.renderMap(map, ofsetX, ofsetY, w, h, cellSize, grid,heightmap,hideWater);
 }
@@ -573,8 +604,7 @@ void Program::switchMapSurfaces(int surf1, int surf2) {
 }
 
 void Program::reset(int w, int h, int alt, int surf) {
-	undoStack.clear();
-	redoStack.clear();
+	clearUndoHistory();
 	if(map) map->reset(w, h, (float) alt, static_cast<MapSurfaceType>(surf));
 }
 
@@ -659,8 +689,7 @@ void Program::setMapAdvanced(int altFactor, int waterLevel, int cliffLevel , int
 }
 
 void Program::loadMap(const string &path) {
-	undoStack.clear();
-	redoStack.clear();
+	clearUndoHistory();
 
 	std::string encodedPath = path;
 //#ifdef WIN32
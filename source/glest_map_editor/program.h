@@ -18,6 +18,7 @@
 #include "base_renderer.h"
 
 #include <stack>
+#include <vector>
 
 using std::stack;
 using namespace Shared::Map;
@@ -38,52 +39,70 @@ enum ChangeType {
 	ctAll
 };
 
+// =============================================
+// class UndoTile
+// The cells of one map tile as they were when an undo point was
+// taken, shared by every later undo point that found the tile unchanged
+// =============================================
+class UndoTile {
+	public:
+		MapPreviewTile cells;
+		int refCount;
+
+		UndoTile() : refCount(0) { }
+};
+
 // =============================================
 // class Undo Point
-// A linked list class that is more of an extension / modification on
-// the already existing Cell struct in map.h
-// Provides the ability to only specify a certain property of the map to change
+// A copy on write snapshot of the map cells. The map is split into
+// tiles and a new undo point only copies the tiles changed since the
+// previous one, the others are shared, so taking and reverting an
+// undo point costs in proportion to the edited area
 // =============================================
 class UndoPoint {
 	private:
-		// Only keep a certain number of undo points in memory otherwise
-		// Big projects could hog a lot of memory
-		const static int MAX_UNDO_LIST_SIZE = 100;
-		static int undoCount;
+		// Bytes of all tiles held by any undo point
+		static size_t tileBytes;
 
 		ChangeType change;
 
-		// Pointers to arrays of each property
-		int *surface;
-		int *object;
-		int *resource;
-		float *height;
+		// Map width and height and the tiles, tile (x, y) is at y * tilesW + x
+		int w;
+		int h;
+		int tilesW;
+		int tilesH;
+		std::vector<UndoTile *> tiles;
 
-		// Map width and height
-		static int w;
-		static int h;
+		void releaseTiles();
 
 	public:
 		UndoPoint();
+		UndoPoint(const UndoPoint &obj);
+		UndoPoint & operator=(const UndoPoint &obj);
 		~UndoPoint();
-		void init(ChangeType change);
-		void revert();
+
+		// Shares the tiles not changed since previous was taken
+		void init(ChangeType change, const UndoPoint &previous);
+		void revert() const;
 
 		inline ChangeType getChange() const 	{ return change; }
+		inline size_t getMemoryBytes() const	{ return sizeof(UndoPoint) + tiles.size() * sizeof(UndoTile *); }
+		static size_t getTileBytes()			{ return tileBytes; }
 };
 
 class ChangeStack : public std::stack<UndoPoint> {
 public:
-	static const unsigned int maxSize = 100;
-
 	ChangeStack() : std::stack<UndoPoint>() { }
 	void clear() { c.clear(); }
 
-	void push(UndoPoint p) {
-		if (c.size() >= maxSize) {
-			c.pop_front();
+	// The history is limited by Program's memory budget, not by a count
+	void dropOldest() { c.pop_front(); }
+	size_t getMemoryBytes() const {
+		size_t result = 0;
+		for (std::deque<UndoPoint>::const_iterator iter = c.begin(); iter != c.end(); ++iter) {
+			result += iter->getMemoryBytes();
 		}
-		stack<UndoPoint>::push(p);
+		return result;
 	}
 };
 
@@ -104,9 +123,17 @@ private:
 	static MapPreview *map;
 	friend class UndoPoint;
 	ChangeStack undoStack, redoStack;
+	// The last undo point taken or reverted to, the next one shares
+	// the tiles that did not change since
+	UndoPoint lastUndoPoint;
+	size_t undoMemoryBudget;
 
 	void init();
+	void clearUndoHistory();
+	void trimUndoHistory();
 public:
+	static const int defaultUndoMemoryMB = 64;
+
 	Program(int w, int h, string playerName);
 	~Program();
 
@@ -130,6 +157,8 @@ public:
 	void setUndoPoint(ChangeType change);
 	bool undo();
 	bool redo();
+	void setUndoMemoryBudget(int megaBytes);
+	size_t getUndoMemoryBytes() const;
 
 	//map ops
 	void reset(int w, int h, int alt, int surf);
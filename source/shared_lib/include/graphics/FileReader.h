@@ -242,7 +242,9 @@ static inline T* readFromFileReaders(vector<FileReader<T> const *>* readers, con
 template <typename T>
 T* FileReader<T>::readPath(const string& filepath) {
 	const string& extension = extractExtension(filepath);
-	vector<FileReader<T> const * >* possibleReaders = (getFileReadersMap())[extension];
+	// find rather than operator[] so textures can be decoded on several threads at once
+	typename map<string, vector<FileReader<T> const * >* >::const_iterator iterFind = getFileReadersMap().find(extension);
+	vector<FileReader<T> const * >* possibleReaders = (iterFind != getFileReadersMap().end() ? iterFind->second : NULL);
 	if (possibleReaders != NULL) {
 		//Search in these possible readers
 		T* ret = readFromFileReaders(possibleReaders, filepath);
@@ -265,7 +267,8 @@ T* FileReader<T>::readPath(const string& filepath) {
 template <typename T>
 T* FileReader<T>::readPath(const string& filepath, T* object) {
 	const string& extension = extractExtension(filepath);
-	vector<FileReader<T> const * >* possibleReaders = (getFileReadersMap())[extension];
+	typename map<string, vector<FileReader<T> const * >* >::const_iterator iterFind = getFileReadersMap().find(extension);
+	vector<FileReader<T> const * >* possibleReaders = (iterFind != getFileReadersMap().end() ? iterFind->second : NULL);
 	if (possibleReaders != NULL) {
 		//Search in these possible readers
 		T* ret = readFromFileReaders(possibleReaders, filepath, object);
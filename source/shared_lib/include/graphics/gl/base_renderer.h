@@ -12,7 +12,9 @@
 #ifndef _BASE_RENDERER_H_
 #define _BASE_RENDERER_H_
 
+#include <vector>
 #include "graphics_interface.h"
+#include "vec.h"
 #include "leak_dumper.h"
 
 namespace Shared { namespace Graphics {
@@ -22,8 +24,22 @@ namespace Shared { namespace Graphics {
 // ===============================================
 
 class BaseRenderer : public RendererMapInterface {
+private:
+	// Surface colour and cliff flag of every map cell, between frames
+	// only the dirty rect of the map is computed again
+	std::vector<Vec3f> mapCellColors;
+	std::vector<uint8> mapCellCliffs;
+	const MapPreview *mapCellColorsMap;
+	int mapCellColorsW;
+	int mapCellColorsH;
+	bool mapCellColorsHeightMap;
+	bool mapCellColorsHideWater;
+
+	void updateMapCellColors(MapPreview *map, bool heightMap, bool hideWater);
+
 public:
-	BaseRenderer() { }
+	BaseRenderer() : mapCellColorsMap(NULL), mapCellColorsW(0), mapCellColorsH(0),
+		mapCellColorsHeightMap(false), mapCellColorsHideWater(false) { }
 	virtual ~BaseRenderer() { }
 
 	virtual void initMapSurface(int clientW, int clientH);
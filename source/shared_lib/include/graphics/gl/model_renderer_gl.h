@@ -36,6 +36,7 @@ public:
 	virtual void end();
 	virtual void render(Model *model,int renderMode=rmNormal);
 	virtual void renderNormalsOnly(Model *model);
+	virtual void renderDrawList(const ModelDrawList &drawList, int renderMode=rmNormal);
 
 	void setDuplicateTexCoords(bool duplicateTexCoords)			{this->duplicateTexCoords= duplicateTexCoords;}
 	void setSecondaryTexCoordUnit(int secondaryTexCoordUnit)	{this->secondaryTexCoordUnit= secondaryTexCoordUnit;}
@@ -43,6 +44,10 @@ public:
 private:
 	
 	void renderMesh(Mesh *mesh,int renderMode=rmNormal);
+	bool beginMesh(Mesh *mesh,int renderMode);
+	void setMeshArrays(Mesh *mesh);
+	void drawMesh(Mesh *mesh);
+	void endMesh(Mesh *mesh,int renderMode);
 	void renderMeshNormals(Mesh *mesh);
 };
 
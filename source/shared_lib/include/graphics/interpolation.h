@@ -15,10 +15,53 @@
 #include "vec.h"
 #include "model.h"
 #include <map>
+#include <vector>
 #include "leak_dumper.h"
 
+using std::vector;
+
 namespace Shared{ namespace Graphics{
 
+// =====================================================
+//	class InterpolationPoseCache
+//
+///	Interpolated poses of one mesh keyed by frame pair and
+/// local time. Units showing the same pose of a shared
+/// model reuse one result instead of each lerping every
+/// vertex again.
+// =====================================================
+
+class InterpolationPoseCache {
+private:
+	class Entry {
+	public:
+		uint32 prevFrame;
+		uint32 nextFrame;
+		float localT;
+		uint32 lastUse;
+		Vec3f *data;
+	};
+
+	uint32 vertexCount;
+	vector<Entry> entries;
+	uint32 useCount;
+	uint32 computeCount;
+
+private:
+	InterpolationPoseCache(InterpolationPoseCache&);
+	void operator =(InterpolationPoseCache&);
+
+public:
+	InterpolationPoseCache(uint32 vertexCount, int maxEntries);
+	~InterpolationPoseCache();
+
+	const Vec3f *getPose(const Vec3f *src, uint32 prevFrame, uint32 nextFrame, float localT);
+	uint32 getComputeCount() const	{return computeCount;}
+
+	// dest[i] = prev[i] + (next[i] - prev[i]) * t over plain float arrays
+	static void lerp(const float *prev, const float *next, float t, float *dest, uint32 count);
+};
+
 // =====================================================
 //	class InterpolationData
 // =====================================================
@@ -27,20 +70,32 @@ class InterpolationData{
 private:
 	const Mesh *mesh;
 
-	Vec3f *vertices;
-	Vec3f *normals;
+	InterpolationPoseCache *vertexCache;
+	InterpolationPoseCache *normalCache;
+	const Vec3f *vertices;
+	const Vec3f *normals;
 
 	int raw_frame_ofs;
 
 	static bool enableInterpolation;
+	static float quantizationStep;
+	static int poseCacheSize;
 	
-	void update(const Vec3f* src, Vec3f* &dest, float t, bool cycle);
+	void update(const Vec3f* src, InterpolationPoseCache* &cache, const Vec3f* &dest, float t, bool cycle);
 
 public:
 	InterpolationData(const Mesh *mesh);
 	~InterpolationData();
 
 	static void setEnableInterpolation(bool enabled) { enableInterpolation = enabled; }
+	// Local times are rounded to multiples of step (1/64 of a key frame by
+	// default) so nearby poses are shared, 0 keeps them exact
+	static void setQuantizationStep(float step) { quantizationStep = step; }
+	static float getQuantizationStep() { return quantizationStep; }
+	static void setPoseCacheSize(int size) { poseCacheSize = size; }
+	static int getPoseCacheSize() { return poseCacheSize; }
+
+	static float quantizeLocalT(float localT, float step);
 
 	const Vec3f *getVertices() const	{return !vertices || !enableInterpolation? mesh->getVertices()+raw_frame_ofs: vertices;}
 	const Vec3f *getNormals() const		{return !normals || !enableInterpolation? mesh->getNormals()+raw_frame_ofs: normals;}
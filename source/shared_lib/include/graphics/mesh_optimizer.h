@@ -0,0 +1,75 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_MESHOPTIMIZER_H_
+#define _SHARED_GRAPHICS_MESHOPTIMIZER_H_
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using namespace Shared::Platform;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	class MeshCacheStats
+//
+///	Post transform vertex cache behaviour of index buffers,
+/// measured with a simulated FIFO cache. ACMR is the
+/// average number of cache misses per triangle, ATVR the
+/// misses per vertex in the buffers (1.0 is ideal).
+// =====================================================
+
+class MeshCacheStats {
+public:
+	uint32 vertexCount;
+	uint32 triangleCount;
+	uint32 cacheMisses;
+
+	MeshCacheStats() : vertexCount(0), triangleCount(0), cacheMisses(0) {}
+
+	void add(const MeshCacheStats &stats);
+	float getACMR() const;
+	float getATVR() const;
+};
+
+// =====================================================
+//	class MeshOptimizer
+//
+///	Index buffer reordering for the vertex cache, based on
+/// Tom Forsyth's linear speed vertex cache optimisation
+// =====================================================
+
+class MeshOptimizer {
+public:
+	// Cache size the reordering aims for and the metrics simulate
+	static const int cacheSize = 32;
+
+	// Reorders the triangles, their corners keep their winding
+	static void optimizeVertexCache(uint32 *indices, uint32 indexCount, uint32 vertexCount);
+	// Numbers the vertices in order of first use and rewrites the indices.
+	// remap receives the new index of every old vertex, unusedVertex for
+	// vertices no triangle references. Returns the used vertex count.
+	static uint32 optimizeVertexFetch(uint32 *indices, uint32 indexCount, uint32 vertexCount, vector<uint32> &remap);
+
+	static MeshCacheStats getCacheStats(const uint32 *indices, uint32 indexCount, uint32 vertexCount, int simulatedCacheSize=cacheSize);
+	static string getReport(const MeshCacheStats &before, const MeshCacheStats &after);
+
+	static const uint32 unusedVertex = 0xFFFFFFFF;
+};
+
+}}//end namespace
+
+#endif
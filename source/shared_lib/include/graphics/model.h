@@ -19,6 +19,7 @@
 #include "texture_manager.h"
 #include "texture.h"
 #include "model_header.h"
+#include "mesh_optimizer.h"
 #include <memory>
 #include "byte_order.h"
 #include "leak_dumper.h"
@@ -34,6 +35,15 @@ class Mesh;
 class ShadowVolumeData;
 class InterpolationData;
 class TextureManager;
+class MappedModelFile;
+class G3dReader;
+
+enum MeshDataFlag {
+	mdfVertices		= 1,
+	mdfNormals		= 2,
+	mdfTexCoords	= 4,
+	mdfIndices		= 8
+};
 
 // =====================================================
 //	class Mesh
@@ -61,6 +71,8 @@ private:
 	Vec2f *texCoords;
 	Vec3f *tangents;
 	uint32 *indices;
+	// Arrays that point into the model file instead of owning memory
+	uint32 mappedData;
 
 	//material data
 	Vec3f diffuseColor;
@@ -118,6 +130,7 @@ public:
 	const Vec2f *getTexCoords() const	{return texCoords;}
 	const Vec3f *getTangents() const	{return tangents;}
 	const uint32 *getIndices() const 	{return indices;}
+	bool hasMappedData() const			{return mappedData != 0;}
 
 	void setVertices(Vec3f *data, uint32 count);
 	void setNormals(Vec3f *data, uint32 count);
@@ -155,23 +168,34 @@ public:
 								string sourceLoader="",string modelFile="");
 
 	//load
-	void loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
+	void loadV2(int meshIndex, const string &dir, G3dReader &reader, TextureManager *textureManager,
 			bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList=NULL,string sourceLoader="",string modelFile="");
-	void loadV3(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
+	void loadV3(int meshIndex, const string &dir, G3dReader &reader, TextureManager *textureManager,
 			bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList=NULL,string sourceLoader="",string modelFile="");
-	void load(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList=NULL,string sourceLoader="",string modelFile="");
+	void load(int meshIndex, const string &dir, G3dReader &reader, TextureManager *textureManager,bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList=NULL,string sourceLoader="",string modelFile="");
+	bool loadCache(G3dReader &reader);
+	void loadCacheTextures(int meshIndex, const string &dir, TextureManager *textureManager,
+			bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList,string sourceLoader,string modelFile);
+	void saveCache(FILE *f);
 	void save(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 			string convertTextureToFormat, std::map<string,int> &textureDeleteList,
 			bool keepsmallest,string modelFile);
 
 	void deletePixels();
 
+	// Merges vertices that match in every frame, reorders the triangles for
+	// the vertex cache and the vertices in order of first use
+	void optimize(MeshCacheStats *before=NULL, MeshCacheStats *after=NULL);
+	MeshCacheStats getCacheStats() const;
+
 	void toEndian();
 	void fromEndian();
 
 private:
 	string findAlternateTexture(vector<string> conversionList, string textureFile);
 	void computeTangents();
+	template<class T> size_t readData(G3dReader &reader, T *&data, uint32 count, uint32 flag);
+	bool isSameVertex(uint32 vertex1, uint32 vertex2) const;
 
 };
 
@@ -198,6 +222,13 @@ private:
 	string fileName;
 	string sourceLoader;
 
+	// Keeps the file alive while meshes use its data in place
+	MappedModelFile *mappedFile;
+	bool loadedFromCache;
+
+	static string cachePath;
+	static bool mapDataInPlace;
+
 	//static bool masterserverMode;
 
 public:
@@ -212,6 +243,8 @@ public:
 	//data
 	void updateInterpolationData(float t, bool cycle);
 	void updateInterpolationVertices(float t, bool cycle);
+	// Poses a single mesh, for renderers drawing mesh by mesh
+	void updateMeshInterpolationData(uint32 meshIndex, float t, bool cycle);
 	void buildShadowVolumeData() const;
 
 	//get
@@ -223,6 +256,9 @@ public:
 	uint32 getTriangleCount() const;
 	uint32 getVertexCount() const;
 
+	void optimizeMeshes(MeshCacheStats *before=NULL, MeshCacheStats *after=NULL);
+	MeshCacheStats getCacheStats() const;
+
 	//io
 	void save(const string &path, string convertTextureToFormat,bool keepsmallest);
 	void saveG3d(const string &path, string convertTextureToFormat,bool keepsmallest);
@@ -231,6 +267,16 @@ public:
 	void deletePixels();
 
 	string getFileName() const { return fileName; }
+	bool getLoadedFromCache() const { return loadedFromCache; }
+
+	// Preprocessed copies of loaded models are kept here, empty disables them
+	static void setCachePath(const string &path)	{ cachePath = path; }
+	static string getCachePath()					{ return cachePath; }
+	// Tools that watch model files change on disk should copy instead
+	static void setMapDataInPlace(bool value)		{ mapDataInPlace = value; }
+	static bool getMapDataInPlace()					{ return mapDataInPlace; }
+	// Cache file used for path, empty while the cache is off
+	static string getCacheFileName(const string &path);
 
 	void toEndian();
 	void fromEndian();
@@ -243,6 +289,11 @@ protected:
 private:
 	void buildInterpolationData() const;
 	void autoJoinMeshFrames();
+
+	bool loadG3dCache(const string &path, const string &cacheFile, bool deletePixMapAfterLoad,
+			std::map<string,vector<pair<string, string> > > *loadedFileList, string sourceLoader);
+	void saveG3dCache(const string &path, const string &cacheFile);
+	void releaseUnusedFile();
 };
 
 class PixelBufferWrapper {
@@ -0,0 +1,120 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_MODELDRAWLIST_H_
+#define _SHARED_GRAPHICS_MODELDRAWLIST_H_
+
+#include <vector>
+#include "vec.h"
+#include "matrix.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using namespace Shared::Platform;
+
+namespace Shared{ namespace Graphics{
+
+class Model;
+class Texture;
+
+// =====================================================
+//	class ModelDrawInstance
+//
+///	One model to draw with its own transform and pose
+// =====================================================
+
+class ModelDrawInstance {
+public:
+	Model *model;
+	const Texture *teamTexture;
+	// OpenGL column order
+	Matrix4f transform;
+	float animProgress;
+	bool cycleAnim;
+	float alpha;
+};
+
+// =====================================================
+//	class ModelDrawItem
+//
+///	One mesh of one instance
+// =====================================================
+
+class ModelDrawItem {
+public:
+	Model *model;
+	uint32 meshIndex;
+	// Only set for meshes that take the team colour
+	const Texture *teamTexture;
+	uint32 instanceIndex;
+};
+
+// =====================================================
+//	class ModelDrawBucket
+//
+///	Consecutive items of the same mesh and team colour,
+/// their render state is set up once
+// =====================================================
+
+class ModelDrawBucket {
+public:
+	Model *model;
+	uint32 meshIndex;
+	const Texture *texture;
+	const Texture *teamTexture;
+	uint32 firstItem;
+	uint32 itemCount;
+};
+
+// =====================================================
+//	class ModelDrawList
+//
+///	Visible model instances sorted into buckets keyed by
+/// model, mesh, texture and team colour. Pure CPU work,
+/// submitting the buckets is up to the model renderer.
+// =====================================================
+
+class ModelDrawList {
+private:
+	vector<ModelDrawInstance> instances;
+	vector<ModelDrawItem> items;
+	vector<ModelDrawBucket> buckets;
+
+public:
+	void clear();
+	// Rotations in degrees, applied in z, x, y order after the translation
+	uint32 addInstance(Model *model, const Texture *teamTexture, const Vec3f &translation,
+			float rotationZ, float rotationX, float rotationY,
+			float animProgress, bool cycleAnim, float alpha=1.f);
+	// Expands the instances into mesh items and sorts them into buckets.
+	// The meshes of one model keep their order.
+	void build();
+
+	bool empty() const									{return instances.empty();}
+	uint32 getInstanceCount() const					{return (uint32)instances.size();}
+	const ModelDrawInstance &getInstance(uint32 i) const	{return instances[i];}
+	uint32 getItemCount() const							{return (uint32)items.size();}
+	const ModelDrawItem &getItem(uint32 i) const		{return items[i];}
+	uint32 getBucketCount() const						{return (uint32)buckets.size();}
+	const ModelDrawBucket &getBucket(uint32 i) const	{return buckets[i];}
+
+	// Texture and team colour switches when drawing the instances one by
+	// one in the order they were added, to compare against the buckets
+	uint32 getUnbatchedStateChanges() const;
+	uint32 getStateChanges() const;
+
+	static Matrix4f getTransform(const Vec3f &translation, float rotationZ, float rotationX, float rotationY);
+};
+
+}}//end namespace
+
+#endif
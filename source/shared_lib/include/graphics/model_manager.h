@@ -14,6 +14,7 @@
 
 #include "model.h"
 #include <vector>
+#include <map>
 #include "leak_dumper.h"
 
 using namespace std;
@@ -34,6 +35,17 @@ protected:
 	ModelContainer models;
 	TextureManager *textureManager;
 
+	// Models are shared by canonical path when enabled
+	bool shareModels;
+	std::map<string, Model *> modelsByPath;
+	std::map<Model *, int> modelRefCounts;
+	Model *lastModel;
+
+	uint32 loadCount;
+	uint32 sharedCount;
+	uint32 cachedCount;
+	int64 loadMicros;
+
 public:
 	ModelManager();
 	virtual ~ModelManager();
@@ -46,6 +58,13 @@ public:
 	void endLastModel(bool mustExistInList=false);
 
 	void setTextureManager(TextureManager *textureManager)	{this->textureManager= textureManager;}
+	void setShareModels(bool value)							{this->shareModels= value;}
+
+	// Load statistics since the last end()
+	uint32 getLoadCount() const		{return loadCount;}
+	uint32 getSharedCount() const	{return sharedCount;}
+	uint32 getCachedCount() const	{return cachedCount;}
+	int64 getLoadMicros() const		{return loadMicros;}
 };
 
 }}//end namespace
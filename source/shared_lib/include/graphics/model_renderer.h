@@ -14,6 +14,7 @@
 #define _SHARED_GRAPHICS_MODELRENDERER_H_
 
 #include "model.h"
+#include "model_draw_list.h"
 #include "leak_dumper.h"
 
 namespace Shared{ namespace Graphics{
@@ -38,6 +39,8 @@ class MeshCallback{
 public:
 	virtual ~MeshCallback(){};
 	virtual void execute(const Mesh *mesh)= 0;
+	// Draw lists switch the team colour between buckets
+	virtual void setTeamTexture(const Texture *teamTexture) {}
 };
 
 // =====================================================
@@ -68,6 +71,7 @@ public:
 	virtual void end()=0;
 	virtual void render(Model *model,int renderMode=rmNormal)=0;
 	virtual void renderNormalsOnly(Model *model)=0;
+	virtual void renderDrawList(const ModelDrawList &drawList, int renderMode=rmNormal)=0;
 };
 
 }}//end namespace
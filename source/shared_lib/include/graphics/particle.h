@@ -252,6 +252,29 @@ protected:
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual void updateParticle(Particle *p);
 	virtual bool deathTest(Particle *p);
+	virtual void updateParticles();
+
+	// Runs the update and death test of SystemType over all alive particles.
+	// The calls are qualified so each system gets one virtual dispatch per
+	// update instead of two per particle
+	template<class SystemType>
+	inline void updateAliveParticles(SystemType *system) {
+		for(int i= 0; i < aliveParticleCount; ++i) {
+			Particle *p= &particles[i];
+			system->SystemType::updateParticle(p);
+
+			if(system->SystemType::deathTest(p)) {
+
+				//kill the particle
+				killParticle(p);
+
+				//maintain alive particles at front of the array
+				if(aliveParticleCount > 0) {
+					particles[i]= particles[aliveParticleCount];
+				}
+			}
+		}
+	}
 };
 
 // =====================================================
@@ -271,6 +294,7 @@ public:
 	//virtual
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual void updateParticle(Particle *p);
+	virtual void updateParticles();
 
 	//set params
 	void setRadius(float radius);
@@ -405,6 +429,7 @@ public:
 	//virtual
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual void updateParticle(Particle *p);
+	virtual void updateParticles();
 	virtual void update();
 	virtual bool getVisible() const;
 	virtual void fade();
@@ -474,6 +499,7 @@ public:
 
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual bool deathTest(Particle *p);
+	virtual void updateParticles();
 
 	void setRadius(float radius);
 	void setWind(float windAngle, float windSpeed);
@@ -499,6 +525,7 @@ public:
 
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual bool deathTest(Particle *p);
+	virtual void updateParticles();
 
 	void setRadius(float radius);
 	void setWind(float windAngle, float windSpeed);
@@ -584,6 +611,7 @@ public:
 	virtual void update();
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual void updateParticle(Particle *p);
+	virtual void updateParticles();
 	
 	void setTrajectory(Trajectory trajectory)				{this->trajectory= trajectory;}
 	void setTrajectorySpeed(float trajectorySpeed)			{this->trajectorySpeed= trajectorySpeed;}
@@ -628,6 +656,7 @@ public:
 	virtual void update();
 	virtual void initParticle(Particle *p, int particleIndex);
 	virtual void updateParticle(Particle *p);
+	virtual void updateParticles();
 	
 	virtual void initParticleSystem();
 
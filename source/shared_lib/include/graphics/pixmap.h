@@ -293,6 +293,8 @@ public:
 	void copy(const Pixmap2D *sourcePixmap);
 	void subCopy(int x, int y, const Pixmap2D *sourcePixmap);
 	void copyImagePart(int x, int y, const Pixmap2D *sourcePixmap);
+	// Exchanges the contents with other without copying the pixels
+	void swap(Pixmap2D &other);
 	string getPath() const		{ return path;}
 	std::size_t getPixelByteCount() const;
 
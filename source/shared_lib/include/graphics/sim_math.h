@@ -0,0 +1,79 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_SIMMATH_H_
+#define _SHARED_GRAPHICS_SIMMATH_H_
+
+#include "vec.h"
+#include "leak_dumper.h"
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	Integer distance tests for the simulation
+//
+///	Cell positions are integers, so range and sight tests
+/// can compare squared distances instead of going through
+/// the truncated float square root of Vec2::dist. The
+/// results match the float tests for any map size and are
+/// the same on every platform and compiler.
+// =====================================================
+
+// Fixed point octile costs, sqrt(2) rounded to three digits
+const int octileStraightCost	= 1000;
+const int octileDiagonalCost	= 1414;
+
+inline int distSquared(const Vec2i &a, const Vec2i &b) {
+	int dx = b.x - a.x;
+	int dy = b.y - a.y;
+	return dx * dx + dy * dy;
+}
+
+// Same as relPos.length() < radius
+inline bool isInsideRadius(const Vec2i &relPos, int radius) {
+	return radius > 0 && relPos.x * relPos.x + relPos.y * relPos.y < radius * radius;
+}
+
+// Same as a.dist(b) < radius
+inline bool isInsideRadius(const Vec2i &a, const Vec2i &b, int radius) {
+	return radius > 0 && distSquared(a, b) < radius * radius;
+}
+
+// Twice the float centre of a unit, Vec2f(pos.x - 0.5f + size / 2.f, ...),
+// which is always a whole number
+inline Vec2i getDoubledCenter(const Vec2i &pos, int size) {
+	return Vec2i(pos.x * 2 + size - 1, pos.y * 2 + size - 1);
+}
+
+// Same as floor(floatCenter.dist(Vec2f(cellX, cellY))) <= maxFloorDist
+// for the float centre of doubledCenter
+inline bool isCellInRange(const Vec2i &doubledCenter, int cellX, int cellY, int maxFloorDist) {
+	if(maxFloorDist < 0) {
+		return false;
+	}
+	int dx = cellX * 2 - doubledCenter.x;
+	int dy = cellY * 2 - doubledCenter.y;
+	int limit = (maxFloorDist + 1) * 2;
+	return dx * dx + dy * dy < limit * limit;
+}
+
+// Cost of the shortest 8 way path without obstacles, in octileStraightCost
+// units per cell
+inline int octileDistance(const Vec2i &a, const Vec2i &b) {
+	int dx = (b.x > a.x ? b.x - a.x : a.x - b.x);
+	int dy = (b.y > a.y ? b.y - a.y : a.y - b.y);
+	int diagonal = (dx < dy ? dx : dy);
+	return octileStraightCost * (dx + dy) + (octileDiagonalCost - 2 * octileStraightCost) * diagonal;
+}
+
+}}//end namespace
+
+#endif
@@ -84,6 +84,7 @@ public:
 	void setWrapMode(WrapMode wrapMode)	{this->wrapMode= wrapMode;}
 	void setPixmapInit(bool pixmapInit)	{this->pixmapInit= pixmapInit;}
 	void setFormat(Format format)		{this->format= format;}
+	void setPath(const string &path)	{this->path= path;}
 
 	virtual void init(Filter filter= fBilinear, int maxAnisotropy= 1)=0;
 	virtual void end(bool deletePixelBuffer=true)=0;
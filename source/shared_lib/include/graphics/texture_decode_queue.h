@@ -0,0 +1,81 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_TEXTUREDECODEQUEUE_H_
+#define _SHARED_GRAPHICS_TEXTUREDECODEQUEUE_H_
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include "texture.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Shared{ namespace Graphics{
+
+class TextureDecodeJob;
+class TextureDecodeWorkerThread;
+
+// =====================================================
+//	class TextureDecodeQueue
+//
+///	Reads and decodes queued 2D textures on worker threads
+/// into a pixmap of their own. Only finish() touches the
+/// texture, so the GL upload stays on the render thread.
+// =====================================================
+
+class TextureDecodeQueue {
+private:
+	Mutex mutex;
+	Semaphore jobQueued;
+	std::deque<TextureDecodeJob *> queue;
+	std::map<Texture2D *, TextureDecodeJob *> jobs;
+	std::vector<TextureDecodeWorkerThread *> workers;
+	bool quitDecoding;
+	int workerCount;
+
+	uint32 decodeCount;
+	int64 decodeMicros;
+
+	TextureDecodeQueue();
+	~TextureDecodeQueue();
+
+	void decode(TextureDecodeJob *job);
+
+public:
+	static TextureDecodeQueue &getInstance();
+
+	// Decodes path with the component count of the texture pixmap
+	void queueTexture(Texture2D *texture, const string &path);
+	// Waits for the texture, decoding it on the calling thread if no worker
+	// has picked it up yet, and moves the pixels into it. A failed decode
+	// throws when throwOnError is set.
+	void finish(Texture2D *texture, bool throwOnError=true);
+	bool isQueued(Texture2D *texture);
+
+	void processQueue();
+	void stopWorkers();
+
+	// -1 uses one worker less than there are cores, 0 decodes everything
+	// in finish()
+	void setWorkerCount(int value);
+	int getWorkerCount() const		{return workerCount;}
+	uint32 getDecodeCount() const	{return decodeCount;}
+	int64 getDecodeMicros() const	{return decodeMicros;}
+};
+
+}}//end namespace
+
+#endif
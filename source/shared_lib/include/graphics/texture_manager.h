@@ -13,10 +13,13 @@
 #define _SHARED_GRAPHICS_TEXTUREMANAGER_H_
 
 #include <vector>
+#include <map>
 #include "texture.h"
 #include "leak_dumper.h"
 
 using std::vector;
+using std::map;
+using std::pair;
 
 namespace Shared{ namespace Graphics{
 
@@ -34,6 +37,20 @@ protected:
 	Texture::Filter textureFilter;
 	int maxAnisotropy;
 
+	// Textures still being decoded by TextureDecodeQueue and whether their
+	// pixels are dropped once uploaded
+	vector<pair<Texture2D *, bool> > pendingTextures;
+	bool deferredInit;
+
+	// Queued textures by canonical path and component count, so every
+	// spelling of a path only decodes the image once. Each extra model
+	// using a shared texture holds a reference that endTexture() drops.
+	bool shareTextures;
+	map<pair<string, int>, Texture2D *> texturesByPath;
+	map<Texture *, int> textureRefCounts;
+
+	void forgetTexture(Texture *texture);
+
 public:
 	TextureManager();
 	~TextureManager();
@@ -51,6 +68,23 @@ public:
 	int getMaxAnisotropy() const {return maxAnisotropy;}
 
 	Texture *getTexture(const string &path);
+
+	// Returns a texture whose pixels are decoded in the background, or the
+	// texture already queued for the same file when sharing is enabled.
+	// owned is set when the caller must give the texture back with
+	// endTexture(). Pending textures are uploaded by initPendingTextures()
+	// or init().
+	Texture2D *queueTexture2D(const string &path, int components, bool deletePixelsAfterInit, bool &owned);
+	void initPendingTextures();
+	bool hasPendingTextures() const		{return pendingTextures.empty() == false;}
+
+	// While set models leave their textures to the next init() instead of
+	// uploading them as soon as the model is loaded
+	void setDeferredInit(bool value)		{deferredInit= value;}
+	bool getDeferredInit() const			{return deferredInit;}
+	void setShareTextures(bool value)		{shareTextures= value;}
+	bool getShareTextures() const			{return shareTextures;}
+
 	Texture1D *newTexture1D();
 	Texture2D *newTexture2D();
 	Texture3D *newTexture3D();
@@ -0,0 +1,167 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_VISIBILITYINDEX_H_
+#define _SHARED_GRAPHICS_VISIBILITYINDEX_H_
+
+#include <vector>
+#include "vec.h"
+#include "math_util.h"
+#include "leak_dumper.h"
+
+using std::vector;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	class FrustumCulling
+//
+///	Frustum tests on the six planes the renderer extracts
+/// from the projection and modelview matrices. Pure CPU
+/// code so culling can run and be measured headless.
+// =====================================================
+
+class FrustumCulling {
+public:
+	enum BoxClassification {
+		bcOutside,
+		bcIntersecting,
+		bcInside
+	};
+
+	static bool cubeInFrustum(const vector<vector<float> > &frustum, float x, float y, float z, float size);
+	static BoxClassification classifyBox(const vector<vector<float> > &frustum, const Vec3f &minCorner, const Vec3f &maxCorner);
+};
+
+// =====================================================
+//	class VisibilityItem
+// =====================================================
+
+class VisibilityItem {
+public:
+	Vec2i cell;
+	Vec3f center;
+	float size;
+
+	VisibilityItem() : size(0) {}
+	VisibilityItem(const Vec2i &cell, const Vec3f &center, float size) :
+		cell(cell), center(center), size(size) {}
+};
+
+// =====================================================
+//	class VisibilityQuadTree
+//
+///	Static hierarchy over items that never move, such as
+/// tileset objects. Built once per map, queried with a
+/// cell rectangle and optionally the view frustum.
+// =====================================================
+
+class VisibilityQuadTree {
+private:
+	class Node {
+	public:
+		Rect2i cellRect;
+		Vec3f minCorner;
+		Vec3f maxCorner;
+		int children[4];
+		int firstItem;
+		int itemCount;
+	};
+
+	static const int maxLeafItems = 16;
+
+	vector<VisibilityItem> items;
+	vector<int> itemOrder;
+	vector<Node> nodes;
+	bool built;
+
+	int buildNode(const Rect2i &cellRect, int firstItem, int itemCount);
+	void queryNode(int nodeIndex, const vector<vector<float> > *frustum,
+			const Rect2i &cellBounds, vector<int> &result) const;
+
+public:
+	VisibilityQuadTree() : built(false) {}
+
+	void build(const vector<VisibilityItem> &items);
+	void clear();
+	bool isBuilt() const	{return built;}
+
+	const VisibilityItem &getItem(int index) const	{return items[index];}
+	int getItemCount() const						{return (int)items.size();}
+
+	// Appends the indices of the items inside cellBounds that pass the
+	// frustum test, in no particular order. A NULL frustum skips the test.
+	void query(const vector<vector<float> > *frustum, const Rect2i &cellBounds, vector<int> &result) const;
+};
+
+// =====================================================
+//	class VisibilityLooseGrid
+//
+///	Grid for moving items such as units. Items are added,
+/// moved and removed as they change and are only ever
+/// kept in the grid cell of their map cell. Every grid
+/// cell is loosened by the largest item reach so whole
+/// cells can be accepted or rejected against the frustum
+/// before testing single items.
+// =====================================================
+
+class VisibilityLooseGrid {
+private:
+	class Cell {
+	public:
+		int itemCount;
+		FrustumCulling::BoxClassification classification;
+	};
+
+	class Item {
+	public:
+		Vec2i cell;
+		int gridCell;
+	};
+
+	int cellSize;
+	int width;
+	int height;
+	float minHeight;
+	float maxHeight;
+	float maxReach;
+	vector<Cell> cells;
+	vector<Item> items;
+	vector<int> freeItems;
+
+	int getGridCell(const Vec2i &cell) const;
+
+public:
+	VisibilityLooseGrid();
+
+	// Heights are the lowest and highest an item center can ever be at
+	void init(int worldWidth, int worldHeight, int cellSize, float minHeight, float maxHeight);
+	void clear();
+	bool isInitialized() const	{return cells.empty() == false;}
+
+	// Reach is how far from its cell an item can be drawn, grid cells
+	// never shrink back once an item has loosened them
+	int addItem(const Vec2i &cell, float reach);
+	void updateItem(int itemIndex, const Vec2i &cell, float reach);
+	void removeItem(int itemIndex);
+	int getItemCount() const	{return (int)(items.size() - freeItems.size());}
+
+	void classify(const vector<vector<float> > &frustum);
+
+	// Inside or outside when the item's whole cell is, otherwise intersecting
+	FrustumCulling::BoxClassification getItemClassification(int itemIndex) const {
+		return cells[items[itemIndex].gridCell].classification;
+	}
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,120 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_MAPCATALOG_H_
+#define _SHARED_MAP_MAPCATALOG_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "base_thread.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using namespace Shared::Platform;
+using Shared::PlatformCommon::BaseThread;
+
+namespace Shared { namespace Map {
+
+// =====================================================
+//	class MapCatalogEntry
+//
+///	What the lobby needs to know about one map file,
+/// including a preview of at most previewMaxSize cells
+/// per side (height, surface, object | resource << 4)
+// =====================================================
+
+class MapCatalogEntry {
+public:
+	static const int previewMaxSize = 32;
+
+	int64 size;
+	int64 modifiedTime;
+	uint32 crc;
+	bool valid;
+
+	int players;
+	int width;
+	int height;
+	int heightFactor;
+	int waterLevel;
+	int cliffLevel;
+	string title;
+
+	int previewW;
+	int previewH;
+	vector<uint8> previewCells;
+	vector<int> previewStartLocations;
+
+	MapCatalogEntry();
+	bool isSameFile(const MapCatalogEntry &other) const {
+		return (size == other.size && modifiedTime == other.modifiedTime);
+	}
+};
+
+// =====================================================
+//	class MapCatalog
+//
+///	Persistent index of every map file, stored next to the
+/// CRC cache. Lookups only stat the file, entries are built
+/// or refreshed by a MapCatalogThread.
+// =====================================================
+
+class MapCatalog {
+private:
+	static Mutex catalogSynchAccessor;
+	static std::map<string,MapCatalogEntry> catalog;
+	static string catalogPath;
+	static bool catalogLoaded;
+	static bool catalogDirty;
+
+	static bool getFileKey(const string &path, MapCatalogEntry &entry);
+	static bool buildEntry(const string &path, MapCatalogEntry &entry);
+	static void loadCatalog();
+	static void saveCatalog();
+
+public:
+	static void setCatalogPath(const string &path);
+	static string getCatalogPath();
+
+	// false while the file is not indexed or changed since
+	static bool findEntry(const string &path, MapCatalogEntry &entry);
+	// Re-reads the file when it is not indexed or changed, false if
+	// it can not be read
+	static bool refreshEntry(const string &path);
+	// Drops the entries of files not in paths
+	static void pruneEntries(const vector<string> &paths);
+	static int getEntryCount();
+
+	static void save();
+	static void clear();
+};
+
+// =====================================================
+//	class MapCatalogThread
+// =====================================================
+
+class MapCatalogThread : public BaseThread {
+protected:
+	vector<string> mapPaths;
+
+public:
+	MapCatalogThread(const vector<string> &mapPaths);
+
+	virtual void execute();
+};
+
+}}// end namespace
+
+#endif
@@ -21,6 +21,7 @@
 
 using Shared::Platform::int8;
 using Shared::Platform::int32;
+using Shared::Platform::uint32;
 using Shared::Platform::float32;
 using Shared::Util::RandomGen;
 using Shared::Graphics::Vec2i;
@@ -108,6 +109,39 @@ public:
 	}
 };
 
+enum MapPreviewRowPass {
+	mprFlipX,
+	mprFlipY,
+	mprSmoothSurface,
+	mprSwitchSurfaces
+};
+
+class MapPreviewRowJobList;
+
+// ===============================================
+//	class MapPreviewTile
+//
+///	A copy of the cells of one tile of a MapPreview,
+/// the stamp tells whether the tile changed since
+// ===============================================
+
+class MapPreviewTile {
+public:
+	uint32 stamp;
+	int w;
+	int h;
+	std::vector<float> heights;
+	std::vector<int8> surfaces;
+	std::vector<int8> objects;
+	std::vector<int8> resources;
+
+	MapPreviewTile() : stamp(0), w(0), h(0) {}
+	int getMemoryBytes() const {
+		return (int)(sizeof(MapPreviewTile) + heights.size() * sizeof(float) +
+				surfaces.size() + objects.size() + resources.size());
+	}
+};
+
 // ===============================================
 //	class Map
 // ===============================================
@@ -116,15 +150,13 @@ class MapPreview {
 public:
 	static const int maxHeight = 20;
 	static const int minHeight = 0;
+	static const int tileSize = 32;
 
-private:
-	struct Cell {
-		int surface;
-		int object;
-		int resource;
-		float height;
-	};
+	// Extra threads for the whole map operations, -1 uses one less than
+	// there are cores and 0 runs them on the calling thread only
+	static int rowWorkerThreadCount;
 
+private:
 	struct StartLocation {
 		int x;
 		int y;
@@ -142,8 +174,24 @@ private:
 	int waterLevel;
 	int cliffLevel;
 	int cameraHeight;
-	//Cell **cells;
-	std::vector<std::vector<Cell> > cells;
+
+	// One plane per cell layer, row major: cell (x, y) is at y * w + x
+	std::vector<float> heights;
+	std::vector<int8> surfaces;
+	std::vector<int8> objects;
+	std::vector<int8> resources;
+
+	// Cells changed since the last clearDirtyRect(), inclusive and
+	// empty while dirtyMaxX < dirtyMinX
+	int dirtyMinX;
+	int dirtyMinY;
+	int dirtyMaxX;
+	int dirtyMaxY;
+
+	// One stamp per tile of tileSize x tileSize cells, renewed whenever
+	// one of its cells changes. A stamp is never handed out twice.
+	std::vector<uint32> tileStamps;
+	uint32 lastTileStamp;
 
 	int maxFactions;
 	//StartLocation *startLocations;
@@ -154,6 +202,14 @@ private:
 	string mapFileLoaded;
 	bool hasChanged;
 
+	friend class MapPreviewRowJobList;
+
+	inline int cellIndex(int x, int y) const { return y * w + x; }
+	void markDirty(int minX, int minY, int maxX, int maxY);
+	void markAllDirty();
+	void runRowPass(MapPreviewRowJobList &jobs);
+	void computeRows(MapPreviewRowJobList &jobs, int firstRow, int lastRow);
+
 public:
 	MapPreview();
 	~MapPreview();
@@ -161,6 +217,17 @@ public:
 	bool getHasChanged() const { return hasChanged; }
 	void setHasChanged(bool value) { hasChanged = value; }
 
+	// false when no cell changed since the last clearDirtyRect()
+	bool getDirtyRect(int &minX, int &minY, int &maxX, int &maxY) const;
+	void clearDirtyRect();
+
+	int getTilesW() const	{return (w + tileSize - 1) / tileSize;}
+	int getTilesH() const	{return (h + tileSize - 1) / tileSize;}
+	uint32 getTileStamp(int tileX, int tileY) const { return tileStamps[tileY * getTilesW() + tileX]; }
+	void copyTile(int tileX, int tileY, MapPreviewTile &tile) const;
+	// Puts back the cells and the stamp of a copied tile
+	void restoreTile(int tileX, int tileY, const MapPreviewTile &tile);
+
 	float getHeight(int x, int y) const;
 	bool isCliff(int x,int y);
 	MapSurfaceType getSurface(int x, int y) const;
@@ -222,7 +289,11 @@ public:
 	bool hasFileLoaded() const {return fileLoaded;}
 	string getMapFileLoaded() const { return mapFileLoaded; }
 
+	// Served from the map catalogue when it has the file indexed
+	bool loadFromCatalog(const string &path);
+
 	static bool loadMapInfo(string file, MapInfo *mapInfo, string i18nMaxMapPlayersTitle,string i18nMapSizeTitle,bool errorOnInvalidMap=true);
+	static bool loadMapInfoFromFile(string file, MapInfo *mapInfo, string i18nMaxMapPlayersTitle,string i18nMapSizeTitle,bool errorOnInvalidMap=true);
 	static string getMapPath(const vector<string> &pathList, const string &mapName, string scenarioDir="", bool errorOnNotFound=true);
 	static vector<string> findAllValidMaps(const vector<string> &pathList,
 			string scenarioDir, bool getUserDataOnly=false, bool cutExtension=true,
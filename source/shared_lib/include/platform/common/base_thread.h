@@ -78,6 +78,9 @@ public:
 
     static bool shutdownAndWait(BaseThread *ppThread);
     virtual bool shutdownAndWait();
+    // Like shutdownAndWait() but also waits for the thread function to
+    // return so deleting the thread afterwards never blocks in ~Thread
+    virtual bool shutdownAndJoin(int maxWaitMilliseconds=5000);
     virtual bool canShutdown(bool deleteSelfIfShutdownDelayed=false);
 
     virtual bool getDeleteSelfOnExecutionDone();
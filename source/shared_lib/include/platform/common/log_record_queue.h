@@ -0,0 +1,173 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_PLATFORMCOMMON_LOGRECORDQUEUE_H_
+#define _SHARED_PLATFORMCOMMON_LOGRECORDQUEUE_H_
+
+#include <cstdarg>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <deque>
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+
+namespace Shared { namespace PlatformCommon {
+
+// =====================================================
+//	class LogRecordFormat
+//
+///	A debug format string split into printf segments of
+/// one conversion each, so its arguments can be stored
+/// raw and formatted later
+// =====================================================
+
+class LogRecordFormat {
+public:
+	enum ArgType {
+		argNone,
+		argInt,
+		argLong,
+		argLongLong,
+		argSizeT,
+		argDouble,
+		argPointer,
+		argString
+	};
+
+	class Segment {
+	public:
+		// Literal text followed by at most one conversion
+		string text;
+		ArgType argType;
+		// Number of '*' width and precision arguments
+		int starCount;
+	};
+
+	int id;
+	// The pointer the caller passed, the text is checked against it
+	const char *source;
+	string text;
+	vector<Segment> segments;
+	// False when the format has conversions the queue cannot store
+	bool capturable;
+	// False once source was seen with different text, the caller
+	// formats into a reused buffer
+	volatile bool stable;
+
+	LogRecordFormat(int id, const char *source);
+	void parse();
+};
+
+// =====================================================
+//	class LogRecordQueue
+//
+///	Multi producer, single consumer queue of debug log
+/// records. Producers claim a slot with a compare and swap
+/// and store the format id with the raw arguments, the
+/// consumer formats them. When the slots are full records
+/// spill over to a list only the consumer drains, so
+/// producers never wait. Each category can be limited to a
+/// number of records per second.
+// =====================================================
+
+class LogRecordQueue {
+public:
+	static const int slotCount = 4096;
+	static const int slotPayloadBytes = 480;
+	static const int formatTableSize = 8192;
+	static const int maxEntryLength = 8096;
+	static const int categoryCount = SystemFlags::debugError + 1;
+
+private:
+	class Slot {
+	public:
+		volatile uint32 sequence;
+		SystemFlags::DebugType type;
+		// 0 for text formatted by the producer
+		int formatId;
+		int payloadSize;
+		time_t entryTime;
+		// Formatted text too long for the payload
+		char *heapText;
+		char payload[slotPayloadBytes];
+	};
+
+	// A record formatted by the producer while the slots were full
+	class OverflowRecord {
+	public:
+		SystemFlags::DebugType type;
+		time_t entryTime;
+		string entry;
+	};
+
+	class RateLimit {
+	public:
+		volatile int32 second;
+		volatile int32 count;
+		volatile int32 dropped;
+	};
+
+	Slot *slots;
+	volatile uint32 enqueuePos;
+	volatile uint32 dequeuePos;
+
+	Mutex mutexFormats;
+	// Open addressing table by format pointer
+	LogRecordFormat * volatile formatTable[formatTableSize];
+	LogRecordFormat * volatile formatsById[formatTableSize];
+	volatile int32 formatCount;
+
+	int rateLimit;
+	RateLimit rateLimits[categoryCount];
+
+	Mutex mutexOverflow;
+	// Set while overflow records wait, new records go after them
+	volatile bool overflowActive;
+	deque<OverflowRecord> overflowRecords;
+	volatile int32 overflowCount;
+	volatile int32 overflowTotal;
+
+	LogRecordFormat * findFormat(const char *fmt);
+	bool captureArgs(const LogRecordFormat *format, va_list argList, Slot &slot);
+	string formatRecord(const Slot &slot);
+	bool isRateLimited(SystemFlags::DebugType type, time_t now);
+	bool pushOverflow(SystemFlags::DebugType type, time_t now, const char *fmt, va_list argList, bool startOverflow);
+	bool popSlot(SystemFlags::DebugType &type, string &entry, time_t &entryTime);
+
+public:
+	LogRecordQueue();
+	~LogRecordQueue();
+
+	// 0 disables the limit, errors are never limited
+	void setRateLimit(int recordsPerSecond) { rateLimit = recordsPerSecond; }
+	int getRateLimit() const { return rateLimit; }
+
+	// Never waits, records over the rate limit are dropped
+	void push(SystemFlags::DebugType type, const char *fmt, va_list argList);
+	// Formats the oldest record, false when the queue is empty. Only
+	// one thread may pop.
+	bool pop(SystemFlags::DebugType &type, string &entry, time_t &entryTime);
+
+	std::size_t getCount();
+	int getFormatCount();
+	// Records dropped by the rate limit since the last call
+	int takeDroppedCount(SystemFlags::DebugType type);
+	// Records that spilled over since the queue was created
+	int getOverflowTotal();
+};
+
+}}//end namespace
+
+#endif
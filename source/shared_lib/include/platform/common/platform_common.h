@@ -229,6 +229,8 @@ void endPathWithSlash(string &path, bool requireOSSlash=false);
 void trimPathWithStartingSlash(string &path);
 void updatePathClimbingParts(string &path,bool processPreviousDirTokenCheck=true);
 string formatPath(string path);
+// Resolves . and .. parts so every spelling of a path gives the same string
+string getCanonicalPath(const string &path);
 
 string replaceAllHTMLEntities(string& context);
 string replaceAll(string& context, const string& from, const string& to);
@@ -16,6 +16,7 @@
 #include <string>
 #include "util.h"
 #include "texture.h"
+#include "log_record_queue.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -139,7 +140,10 @@ public:
 };
 
 // =====================================================
-//	class LogFileThread
+//	class LogFileWriter
+//
+//	Writes queued debug records to the log files, run as a
+//	periodic TaskScheduler task instead of on a thread of its own
 // =====================================================
 
 class LogFileEntry {
@@ -149,24 +153,32 @@ public:
     time_t entryDateTime;
 };
 
-class LogFileThread : public BaseThread
+class LogFileWriter : public SimpleTaskCallbackInterface
 {
 protected:
 
-    Mutex *mutexLogList;
+	// Debug records waiting to be formatted and written
+	LogRecordQueue logQueue;
+	// The current batch, only touched by the running task
 	vector<LogFileEntry> logList;
 	time_t lastSaveToDisk;
+	bool unflushedEntries;
 
-    void saveToDisk(bool forceSaveAll,bool logListAlreadyLocked);
-    bool checkSaveCurrentLogBufferToDisk();
+    void saveToDisk(bool forceFlush);
 
 public:
-	LogFileThread();
-	virtual ~LogFileThread();
-    virtual void execute();
-    void addLogEntry(SystemFlags::DebugType type, string logEntry);
+	static const int millisecsBetweenSaves = 25;
+	// A busy producer cannot keep a scheduler worker to itself, records
+	// left over are written on the next run
+	static const int maxBatchesPerSave = 8;
+
+	LogFileWriter();
+	virtual ~LogFileWriter();
+    virtual void simpleTask(BaseThread *callingThread,void *userdata);
+    void addLogEntry(SystemFlags::DebugType type, const char *fmt, va_list argList);
     std::size_t getLogEntryBufferCount();
-    virtual bool canShutdown(bool deleteSelfIfShutdownDelayed=false);
+    // Writes everything still queued, only call once the task is cancelled
+    void flush();
 };
 
 }}//end namespace
@@ -0,0 +1,169 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_PLATFORMCOMMON_TASKSCHEDULER_H_
+#define _SHARED_PLATFORMCOMMON_TASKSCHEDULER_H_
+
+#include "base_thread.h"
+#include "simple_threads.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Shared { namespace PlatformCommon {
+
+class TaskScheduler;
+
+// =====================================================
+//	class TaskSchedulerStats
+//
+///	Run time statistics of one scheduled task
+// =====================================================
+
+class TaskSchedulerStats {
+public:
+	string name;
+	unsigned int runCount;
+	// Runs that started more than a tick after they were due
+	unsigned int lateRunCount;
+	int64 totalMicros;
+	int64 maxMicros;
+	int64 lastMicros;
+
+	TaskSchedulerStats();
+};
+
+// =====================================================
+//	class TaskSchedulerThread
+//
+///	One of the worker threads of a TaskScheduler
+// =====================================================
+
+class TaskSchedulerThread : public BaseThread {
+protected:
+	TaskScheduler *scheduler;
+
+public:
+	TaskSchedulerThread(TaskScheduler *scheduler);
+	virtual void execute();
+	// Safe to delete, unlike getRunningStatus() == false
+	bool isExecuteComplete() { return isThreadExecuteCompleteStatus(); }
+};
+
+// =====================================================
+//	class TaskScheduler
+//
+///	Runs periodic SimpleTaskCallbackInterface callbacks on a small
+/// pool of worker threads instead of one SimpleTaskThread each.
+/// Due times are kept in a timer wheel of wheelSlotCount slots of
+/// tickMillis each, an idle worker sleeps until the next task is
+/// due. Workers are only started while every running one is busy
+/// and other tasks are waiting, so a single task needs one thread.
+/// The callingThread passed to the callback is the worker running
+/// it and may differ between runs.
+// =====================================================
+
+class TaskScheduler {
+public:
+	static const int wheelSlotCount = 256;
+	static const int tickMillis = 10;
+	static const int defaultWorkerThreadCount = 2;
+
+private:
+	class ScheduledTask {
+	public:
+		int id;
+		SimpleTaskCallbackInterface *callback;
+		void *userdata;
+		unsigned int millisecsBetweenExecutions;
+		// 0 runs the task until it is cancelled
+		unsigned int executionCount;
+		int64 dueTick;
+		bool running;
+		bool cancelled;
+		TaskSchedulerStats stats;
+
+		ScheduledTask();
+	};
+
+	Mutex mutexTasks;
+	std::map<int,ScheduledTask> tasks;
+	// Ids of the waiting tasks by dueTick % wheelSlotCount
+	std::vector<std::vector<int> > wheel;
+	std::deque<int> readyTasks;
+	int nextTaskId;
+
+	// Milliseconds since the scheduler was created, safe from the
+	// wrap around of the platform tick counter
+	int64 clockMillis;
+	uint32 lastClockTicks;
+	int64 lastTimerTick;
+	// The tick the idle workers sleep until, -1 while they wait for a task
+	int64 timerWakeTick;
+
+	Semaphore workerSignal;
+	int workerThreadCount;
+	int idleWorkerCount;
+	int runningTaskCount;
+	std::vector<TaskSchedulerThread *> workerThreads;
+	// Threads still in a task when shutdown() timed out
+	std::vector<TaskSchedulerThread *> stoppingThreads;
+	bool shuttingDown;
+
+	int64 getCurrentTick();
+	void startWorkerThread();
+	void addToWheel(ScheduledTask &task);
+	void removeFromWheel(const ScheduledTask &task);
+	void removeFromReadyTasks(int taskId);
+	void collectDueTasks(int64 currentTick);
+	int64 getNextWakeTick(int64 currentTick);
+
+	friend class TaskSchedulerThread;
+	void runWorker(BaseThread *callingThread);
+
+public:
+	TaskScheduler(int workerThreadCount=defaultWorkerThreadCount);
+	~TaskScheduler();
+
+	static TaskScheduler & getInstance();
+
+	// Returns the id of the task, the first run is after
+	// millisecsBetweenExecutions, -1 once the scheduler is shut down
+	int scheduleTask(SimpleTaskCallbackInterface *callback,
+					 unsigned int millisecsBetweenExecutions,
+					 unsigned int executionCount=0,
+					 void *userdata=NULL,
+					 const string &name="");
+	// The task is not run again. If it is running waits up to
+	// waitMilliseconds (-1 forever) for it to finish and returns false
+	// when it is still running.
+	bool cancelTask(int taskId, int waitMilliseconds=-1);
+	// Runs the task as soon as a worker is free
+	bool runTaskNow(int taskId);
+	bool isTaskScheduled(int taskId);
+	bool getTaskStats(int taskId, TaskSchedulerStats &stats);
+	string getStatsReport();
+
+	int getThreadCount();
+	// Cancels every task and stops the threads, false when some of
+	// them did not stop within timeoutMilliseconds. Those are deleted
+	// by a later call or the destructor.
+	bool shutdown(int timeoutMilliseconds);
+};
+
+}}//end namespace
+
+#endif
@@ -44,6 +44,7 @@ class Chrono;
 namespace Shared { namespace Platform {
 
 class Mutex;
+class Semaphore;
 //class uint32;
 
 enum ThreadState {
@@ -71,6 +72,7 @@ private:
 	SDL_Thread* thread;
 	//std::auto_ptr<Mutex> mutexthreadAccessor;
 	Mutex *mutexthreadAccessor;
+	Semaphore *executeCompleteSignal;
 	ThreadState currentState;
 	bool threadObjectValid();
 
@@ -84,6 +86,7 @@ protected:
 	void removeThreadFromList();
 	void queueAutoCleanThread();
 	bool isThreadExecuteCompleteStatus();
+	bool waitTillThreadExecuteComplete(int waitMilliseconds);
 
 public:
 	Thread();
@@ -118,26 +121,25 @@ private:
 
 	SDL_mutex* mutex;
 	int refCount;
-	string ownerId;
-	string deleteownerId;
+	const char *ownerId;
+	const char *deleteownerId;
 
 	SDL_mutex* mutexAccessor;
-	string lastownerId;
+	const char *lastownerId;
 
 	int maxRefCount;
-	Shared::PlatformCommon::Chrono *chronoPerf;
+	int64 lockedAtMillis;
 
 	bool isStaticMutexListMutex;
 	static auto_ptr<Mutex> mutexMutexList;
 	static vector<Mutex *> mutexList;
 
 public:
-	Mutex(string ownerId="");
+	// Owner ids are call site literals (CODE_AT_LINE), only the pointer is kept
+	Mutex(const char *ownerId="");
 	~Mutex();
-	void setOwnerId(string ownerId) {
-		if(this->ownerId != ownerId) {
-			this->ownerId = ownerId;
-		}
+	void setOwnerId(const char *ownerId) {
+		this->ownerId = ownerId;
 	}
 	void p();
 	void v();
@@ -146,32 +148,75 @@ public:
 	SDL_mutex* getMutex() { return mutex; }
 };
 
+// =====================================================
+//	class MutexContentionStats
+// =====================================================
+
+class MutexContentionStats {
+public:
+	const char *ownerId;
+	uint32 lockCount;
+	int64 waitMicros;
+	int64 maxWaitMicros;
+	int64 holdMicros;
+	int64 maxHoldMicros;
+
+	MutexContentionStats() : ownerId(NULL), lockCount(0), waitMicros(0),
+			maxWaitMicros(0), holdMicros(0), maxHoldMicros(0) {}
+};
+
+// =====================================================
+//	class MutexContentionProfiler
+//
+///	Optional lock profiling, off by default. Wait and hold
+/// times are summed per call site (the owner id literal)
+/// into a table owned by the locking thread, the tables
+/// are only merged for a report.
+// =====================================================
+
+class MutexContentionProfiler {
+private:
+	static bool enabled;
+
+public:
+	static void setEnabled(bool value) { enabled = value; }
+	static bool isEnabled() { return enabled; }
+
+	static int64 getCurMicros();
+	static void record(const char *ownerId, int64 waitMicros, int64 holdMicros);
+
+	// All threads merged, most time spent waiting first
+	static vector<MutexContentionStats> getStats();
+	static string getReport(int maxSites=20);
+	static void reset();
+};
+
 class MutexSafeWrapper {
 protected:
 	Mutex *mutex;
-	string ownerId;
+	const char *ownerId;
+	bool profiled;
+	int64 profileWaitMicros;
+	int64 profileLockedAt;
 #ifdef DEBUG_PERFORMANCE_MUTEXES
 	Chrono chrono;
 #endif
 
 public:
 
-	MutexSafeWrapper(Mutex *mutex,string ownerId="") {
+	MutexSafeWrapper(Mutex *mutex,const char *ownerId="") {
 		this->mutex = mutex;
-		if(this->ownerId != ownerId) {
-			this->ownerId = ownerId;
-		}
+		this->ownerId = ownerId;
+		this->profiled = false;
 		Lock();
 	}
 	~MutexSafeWrapper() {
 		ReleaseLock();
 	}
 
-    void setMutex(Mutex *mutex,string ownerId="") {
+    void setMutex(Mutex *mutex,const char *ownerId="") {
 		this->mutex = mutex;
-		if(this->ownerId != ownerId) {
-			this->ownerId = ownerId;
-		}
+		this->ownerId = ownerId;
 		Lock();
     }
     bool isValidMutex() const {
@@ -181,8 +226,8 @@ public:
 	void Lock() {
 		if(this->mutex != NULL) {
 		    #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("Locking Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("Locking Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 
@@ -190,19 +235,27 @@ public:
     		chrono.start();
 #endif
 
+    		this->profiled = MutexContentionProfiler::isEnabled();
+    		int64 waitStart = (this->profiled == true ? MutexContentionProfiler::getCurMicros() : 0);
+
 			this->mutex->p();
 			if(this->mutex != NULL) {
 				this->mutex->setOwnerId(ownerId);
 			}
 
+			if(this->profiled == true) {
+				this->profileLockedAt = MutexContentionProfiler::getCurMicros();
+				this->profileWaitMicros = this->profileLockedAt - waitStart;
+			}
+
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-			if(chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId.c_str());
+			if(chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId);
 			chrono.start();
 #endif
 
             #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("Locked Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("Locked Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 		}
@@ -210,20 +263,28 @@ public:
 	void ReleaseLock(bool keepMutex=false,bool deleteMutexOnRelease=false) {
 		if(this->mutex != NULL) {
 		    #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("UnLocking Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("UnLocking Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 
+            int64 holdMicros = (this->profiled == true ? MutexContentionProfiler::getCurMicros() - this->profileLockedAt : 0);
+
 			this->mutex->v();
 
+			// Recorded once unlocked so the table lookup is not held time
+			if(this->profiled == true) {
+				this->profiled = false;
+				MutexContentionProfiler::record(this->ownerId,this->profileWaitMicros,holdMicros);
+			}
+
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-			if(chrono.getMillis() > 100) printf("In [%s::%s Line: %d] MUTEX UNLOCKED and held locked for msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId.c_str());
+			if(chrono.getMillis() > 100) printf("In [%s::%s Line: %d] MUTEX UNLOCKED and held locked for msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId);
 #endif
 
             #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("UnLocked Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("UnLocked Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 
@@ -271,10 +332,8 @@ public:
 	void UnLockWrite();
 
 	int maxReaders();
-	void setOwnerId(string ownerId) {
-		if(this->ownerId != ownerId) {
-			this->ownerId = ownerId;
-		}
+	void setOwnerId(const char *ownerId) {
+		this->ownerId = ownerId;
 	}
 
 private:
@@ -282,14 +341,14 @@ private:
 	Mutex mutex;
 	int maxReadersCount;
 
-	string ownerId;
+	const char *ownerId;
 };
 
 
 class ReadWriteMutexSafeWrapper {
 protected:
 	ReadWriteMutex *mutex;
-	string ownerId;
+	const char *ownerId;
 	bool isReadLock;
 
 #ifdef DEBUG_PERFORMANCE_MUTEXES
@@ -298,28 +357,20 @@ protected:
 
 public:
 
-	ReadWriteMutexSafeWrapper(ReadWriteMutex *mutex,bool isReadLock=true, string ownerId="") {
+	ReadWriteMutexSafeWrapper(ReadWriteMutex *mutex,bool isReadLock=true, const char *ownerId="") {
 		this->mutex = mutex;
-		if(this->isReadLock != isReadLock) {
-			this->isReadLock = isReadLock;
-		}
-		if(this->ownerId != ownerId) {
-			this->ownerId = ownerId;
-		}
+		this->isReadLock = isReadLock;
+		this->ownerId = ownerId;
 		Lock();
 	}
 	~ReadWriteMutexSafeWrapper() {
 		ReleaseLock();
 	}
 
-    void setReadWriteMutex(ReadWriteMutex *mutex,bool isReadLock=true,string ownerId="") {
+    void setReadWriteMutex(ReadWriteMutex *mutex,bool isReadLock=true,const char *ownerId="") {
 		this->mutex = mutex;
-		if(this->isReadLock != isReadLock) {
-			this->isReadLock = isReadLock;
-		}
-		if(this->ownerId != ownerId) {
-			this->ownerId = ownerId;
-		}
+		this->isReadLock = isReadLock;
+		this->ownerId = ownerId;
 		Lock();
     }
     bool isValidReadWriteMutex() const {
@@ -329,8 +380,8 @@ public:
 	void Lock() {
 		if(this->mutex != NULL) {
 		    #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("Locking Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("Locking Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 
@@ -346,13 +397,13 @@ public:
     		}
 
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-			if(chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId.c_str());
+			if(chrono.getMillis() > 5) printf("In [%s::%s Line: %d] MUTEX LOCK took msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId);
 			chrono.start();
 #endif
 
             #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("Locked Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("Locked Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 		}
@@ -360,8 +411,8 @@ public:
 	void ReleaseLock(bool keepMutex=false) {
 		if(this->mutex != NULL) {
 		    #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("UnLocking Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("UnLocking Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 
@@ -373,12 +424,12 @@ public:
     		}
 
 #ifdef DEBUG_PERFORMANCE_MUTEXES
-			if(chrono.getMillis() > 100) printf("In [%s::%s Line: %d] MUTEX UNLOCKED and held locked for msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId.c_str());
+			if(chrono.getMillis() > 100) printf("In [%s::%s Line: %d] MUTEX UNLOCKED and held locked for msecs: %lld, this->mutex->getRefCount() = %d ownerId [%s]\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),this->mutex->getRefCount(),ownerId);
 #endif
 
             #ifdef DEBUG_MUTEXES
-            if(this->ownerId != "") {
-                printf("UnLocked Mutex [%s] refCount: %d\n",this->ownerId.c_str(),this->mutex->getRefCount());
+            if(this->ownerId[0] != '\0') {
+                printf("UnLocked Mutex [%s] refCount: %d\n",this->ownerId,this->mutex->getRefCount());
             }
             #endif
 
@@ -444,12 +495,12 @@ public:
 class MasterSlaveThreadControllerSafeWrapper {
 protected:
 	MasterSlaveThreadController *master;
-	string ownerId;
+	const char *ownerId;
 	int waitMilliseconds;
 
 public:
 
-	MasterSlaveThreadControllerSafeWrapper(MasterSlaveThreadController *master, int waitMilliseconds=-1, string ownerId="") {
+	MasterSlaveThreadControllerSafeWrapper(MasterSlaveThreadController *master, int waitMilliseconds=-1, const char *ownerId="") {
 		if(debugMasterSlaveThreadController) printf("In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
 		this->master = master;
@@ -9,6 +9,7 @@
 #define _SHARED_SOUND_SOUNDPLAYEROPENAL_H_
 
 #include "sound_player.h"
+#include "sound_cache.h"
 #include "platform_util.h"
 #include "platform_common.h"
 #include <SDL.h>
@@ -39,6 +40,7 @@ public:
 protected:
 	friend class SoundPlayerOpenAL;
 	ALenum getFormat(Sound* sound);
+	static ALenum getFormat(const SoundInfo *info, const string &fileName);
 
 	ALuint source;
 };
@@ -49,6 +51,7 @@ public:
 	virtual ~StaticSoundSource();
 
 	void play(StaticSound* sound);
+	void play(PcmSoundData* pcmData, float volume);
 
 protected:
 	friend class SoundPlayerOpenAL;
@@ -108,12 +111,24 @@ private:
 	friend class StaticSoundSource;
 	friend class StreamSoundSource;
 
+	class PendingStaticSound {
+	public:
+		PcmSoundData *pcmData;
+		float volume;
+		int64 queuedMillis;
+	};
+	// Sounds still decoding after this long are not worth playing anymore
+	static const int maxPendingStaticSoundMillis = 500;
+
 	void printOpenALInfo();
+	void playPendingStaticSounds();
+	void clearPendingStaticSounds();
 
 	StaticSoundSource* findStaticSoundSource();
 	StreamSoundSource* findStreamSoundSource();
 	void checkAlcError(string message);
-	static void checkAlError(string message);
+	static void checkAlError(const char *message);
+	static void checkAlError(const char *file, const char *function, int line);
 
 	ALCdevice* device;
 	ALCcontext* context;
@@ -122,6 +137,8 @@ private:
 	StaticSoundSources staticSources;
 	typedef std::vector<StreamSoundSource*> StreamSoundSources;
 	StreamSoundSources streamSources;
+	vector<PendingStaticSound> pendingStaticSounds;
+	Chrono pendingStaticSoundChrono;
 
 	SoundPlayerParams params;
 };
@@ -21,6 +21,8 @@ using namespace Shared::Platform;
 
 namespace Shared{ namespace Sound{
 
+class PcmSoundData;
+
 // =====================================================
 //	class SoundInfo
 // =====================================================
@@ -82,16 +84,25 @@ public:
 
 class StaticSound: public Sound{
 private:
-	int8 * samples;
+	PcmSoundData *pcmData;
 
 public:
 	StaticSound();
 	virtual ~StaticSound();
 
-	int8 *getSamples() const		{return samples;}
+	// Samples are decoded on first use and shared through PcmSoundCache,
+	// NULL until then
+	const int8 *getSamples() const;
+	PcmSoundData *getPcmData() const	{return pcmData;}
 	
 	void load(const string &path);
 	void close();
+
+	// Returns true if the samples can be played now, otherwise the file
+	// is queued for background decoding
+	bool requestSamples();
+	// Decodes on the calling thread if required
+	bool loadSamples();
 };
 
 // =====================================================
@@ -0,0 +1,130 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_SOUND_SOUNDCACHE_H_
+#define _SHARED_SOUND_SOUNDCACHE_H_
+
+#include <string>
+#include <map>
+#include <deque>
+#include "sound.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Shared{ namespace Sound{
+
+class PcmSoundDecodeThread;
+
+enum PcmSoundState {
+	pssUnloaded,
+	pssQueued,
+	pssDecoding,
+	pssReady,
+	pssFailed
+};
+
+// =====================================================
+//	class PcmSoundData
+//
+///	Decoded samples of one sound file, shared by every
+/// StaticSound loaded from the same path
+// =====================================================
+
+class PcmSoundData {
+private:
+	friend class PcmSoundCache;
+
+	string path;
+	SoundInfo info;
+	int8 *samples;
+	PcmSoundState state;
+	int refCount;
+	int pinCount;
+	uint64 lastUseTick;
+
+	PcmSoundData(const string &path);
+	~PcmSoundData();
+
+public:
+	const string &getPath() const		{return path;}
+	const SoundInfo &getInfo() const	{return info;}
+	const int8 *getSamples() const		{return samples;}
+	PcmSoundState getState() const		{return state;}
+	int getRefCount() const				{return refCount;}
+};
+
+// =====================================================
+//	class PcmSoundCache
+//
+///	Reference counted cache of decoded sounds. Files are
+/// only decoded the first time they are played, on a
+/// worker thread, and the least recently used samples
+/// are dropped once the memory limit is reached.
+// =====================================================
+
+class PcmSoundCache {
+private:
+	Mutex mutex;
+	Semaphore decodeRequested;
+	std::map<string, PcmSoundData *> entries;
+	std::deque<PcmSoundData *> decodeQueue;
+	PcmSoundDecodeThread *decodeThread;
+	bool quitDecoding;
+
+	uint64 memoryLimit;
+	uint64 memoryUsed;
+	uint64 useTick;
+	uint32 decodeCount;
+	uint32 evictionCount;
+
+	static uint64 defaultMemoryLimit;
+
+	PcmSoundCache();
+	~PcmSoundCache();
+
+	bool decode(PcmSoundData *data);
+	void evictIfRequired(const PcmSoundData *keep);
+
+public:
+	static PcmSoundCache &getInstance();
+
+	// Returns the shared entry for path, reading only the file header
+	PcmSoundData *acquire(const string &path);
+	// Every acquire is matched by one release, the last one frees the samples
+	void release(PcmSoundData *data);
+
+	// Returns true once the samples are decoded, otherwise queues the
+	// file on the decode thread and returns false
+	bool requestDecode(PcmSoundData *data);
+	// Decodes on the calling thread unless the samples are already there
+	bool decodeNow(PcmSoundData *data);
+
+	// Keeps the samples from being evicted while they are being read
+	bool pin(PcmSoundData *data);
+	void unpin(PcmSoundData *data);
+
+	void processDecodeQueue();
+	void stopDecodeThread();
+
+	void setMemoryLimit(uint64 bytes);
+	uint64 getMemoryLimit() const	{return memoryLimit;}
+	uint64 getMemoryUsed();
+	int getEntryCount();
+	uint32 getDecodeCount() const	{return decodeCount;}
+	uint32 getEvictionCount() const	{return evictionCount;}
+};
+
+}}//end namespace
+
+#endif
@@ -14,20 +14,59 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include "data_types.h"
 #include "thread.h"
 #include "leak_dumper.h"
 
 using std::string;
+using std::vector;
 using namespace Shared::Platform;
 
 namespace Shared{ namespace Util{
 
+// =====================================================
+//	class ChecksumFileIndexEntry
+//
+//	One row of the persistent per file CRC index, a file is only
+//	re-read when its size, modification time or inode changes
+// =====================================================
+
+class ChecksumFileIndexEntry {
+public:
+	int64	size;
+	int64	modifiedTime;
+	int64	inode;
+	uint32	crc;
+
+	ChecksumFileIndexEntry() : size(0), modifiedTime(0), inode(0), crc(0) {}
+	bool isSameFile(const ChecksumFileIndexEntry &other) const {
+		return (size == other.size && modifiedTime == other.modifiedTime && inode == other.inode);
+	}
+};
+
+// =====================================================
+//	class ChecksumStats
+// =====================================================
+
+class ChecksumStats {
+public:
+	int64	filesHashed;
+	int64	bytesHashed;
+	int64	filesFromIndex;
+	int64	hashMillis;
+
+	ChecksumStats() : filesHashed(0), bytesHashed(0), filesFromIndex(0), hashMillis(0) {}
+	string getReport() const;
+};
+
 // =====================================================
 //	class Checksum
 // =====================================================
 
 class Checksum {
+	friend class ChecksumFileJobList;
+
 private:
 	uint32	sum;
 	int32	r;
@@ -38,9 +77,23 @@ private:
 	static Mutex fileListCacheSynchAccessor;
 	static std::map<string,uint32> fileListCache;
 
+	static Mutex fileIndexSynchAccessor;
+	static std::map<string,ChecksumFileIndexEntry> fileIndex;
+	static bool fileIndexLoaded;
+	static bool fileIndexDirty;
+	static int fileHashWorkerThreadCount;
+	static ChecksumStats stats;
+
 	void addSum(uint32 value);
+	void addFileContentsToSum(const char *data, size_t size, bool isXMLFile);
 	bool addFileToSum(const string &path);
 
+	static string getFileIndexPath();
+	static bool getFileIndexKey(const string &path, ChecksumFileIndexEntry &entry);
+	static void loadFileIndex();
+	static void saveFileIndex();
+	static void computeFileSums(vector<string> &paths, vector<uint32> &results);
+
 public:
 	Checksum();
 
@@ -59,6 +112,14 @@ public:
 
 	static void removeFileFromCache(const string file);
 	static void clearFileCache();
+
+	static void setFileHashWorkerThreadCount(int value) { fileHashWorkerThreadCount = value; }
+	static int getFileHashWorkerThreadCount() { return fileHashWorkerThreadCount; }
+	static ChecksumStats getStats();
+	static void flushFileIndex();
+	// Saves and drops the loaded index so the next sum reads it from disk
+	// again, e.g. before the CRC cache path changes
+	static void reloadFileIndex();
 };
 
 }}//end namespace
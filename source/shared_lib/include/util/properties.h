@@ -108,6 +108,7 @@ public:
 	static bool applyTagsToValue(string &value, const std::map<string,string> *mapTagReplacementValues=NULL, bool skipUpdatePathClimbingParts=false);
 	static std::map<string,string> getTagReplacementValues(std::map<string,string> *mapExtraTagReplacementValues=NULL);
 	static bool isValuePathVariable(const string &value);
+	static string getPathVariableTagStartCharacters();
 	static void updateValuePathVariable(string &value, bool skipUpdatePathClimbingParts=false);
 
 	string getpath() const { return path;}
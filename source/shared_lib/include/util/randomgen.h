@@ -50,6 +50,7 @@ public:
 	void clearLastCaller();
 	void addLastCaller(std::string text);
 	void setDisableLastCallerTracking(bool value) { disableLastCallerTracking = value; }
+	bool getDisableLastCallerTracking() const { return disableLastCallerTracking; }
 };
 
 }}//end namespace
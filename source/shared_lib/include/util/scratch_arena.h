@@ -0,0 +1,60 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_SCRATCH_ARENA_H_
+#define _SHARED_UTIL_SCRATCH_ARENA_H_
+
+#include <vector>
+#include <memory>
+#include "leak_dumper.h"
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class ScratchArena
+//
+///	A fixed set of reusable buffers for hot query loops.
+/// Each caller thread owns one slot; acquiring a slot
+/// empties it but keeps its capacity so after warm up
+/// the queries no longer touch the heap.
+// =====================================================
+
+template<typename T, typename Alloc = std::allocator<T> >
+class ScratchArena {
+public:
+	typedef std::vector<T,Alloc> List;
+
+private:
+	std::vector<List> slots;
+
+public:
+	explicit ScratchArena(int slotCount=1) : slots(slotCount) {}
+
+	// Not thread safe, call before any worker uses the arena
+	void setSlotCount(int slotCount) { slots.resize(slotCount); }
+	int getSlotCount() const { return (int)slots.size(); }
+
+	inline List & acquire(int slot) {
+		List &list = slots.at(slot);
+		list.clear();
+		return list;
+	}
+
+	void clear() {
+		for(unsigned int i = 0; i < slots.size(); ++i) {
+			List().swap(slots[i]);
+		}
+	}
+};
+
+}}//end namespace
+
+#endif
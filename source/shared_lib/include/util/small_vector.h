@@ -0,0 +1,165 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_SMALL_VECTOR_H_
+#define _SHARED_UTIL_SMALL_VECTOR_H_
+
+#include <cstddef>
+#include "leak_dumper.h"
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class SmallVector
+//
+///	A vector that keeps up to inlineCapacity items inside
+/// the object and only goes to the heap when it grows
+/// past that. Meant for short per object lists such as
+/// unit paths, T must be default constructible and
+/// assignable.
+// =====================================================
+
+template<typename T, int inlineCapacity>
+class SmallVector {
+public:
+	typedef T value_type;
+	typedef T * iterator;
+	typedef const T * const_iterator;
+
+private:
+	T *items;
+	int count;
+	int capacity;
+	T inlineItems[inlineCapacity];
+
+	void grow(int minCapacity) {
+		int newCapacity = capacity * 2;
+		if(newCapacity < minCapacity) {
+			newCapacity = minCapacity;
+		}
+		T *newItems = new T[newCapacity];
+		for(int index = 0; index < count; ++index) {
+			newItems[index] = items[index];
+		}
+		if(items != inlineItems) {
+			delete [] items;
+		}
+		items = newItems;
+		capacity = newCapacity;
+	}
+
+	void assign(const SmallVector &obj) {
+		count = 0;
+		reserve(obj.count);
+		for(int index = 0; index < obj.count; ++index) {
+			items[index] = obj.items[index];
+		}
+		count = obj.count;
+	}
+
+public:
+	SmallVector() : items(inlineItems), count(0), capacity(inlineCapacity) {}
+	SmallVector(const SmallVector &obj) : items(inlineItems), count(0), capacity(inlineCapacity) {
+		assign(obj);
+	}
+	~SmallVector() {
+		if(items != inlineItems) {
+			delete [] items;
+		}
+		items = NULL;
+	}
+
+	SmallVector & operator=(const SmallVector &obj) {
+		if(this != &obj) {
+			assign(obj);
+		}
+		return *this;
+	}
+
+	inline int size() const					{ return count; }
+	inline bool empty() const				{ return count == 0; }
+	inline int getCapacity() const			{ return capacity; }
+	inline bool isInline() const			{ return items == inlineItems; }
+	// Bytes allocated outside of the object
+	inline std::size_t getHeapBytes() const { return (isInline() == true ? 0 : capacity * sizeof(T)); }
+
+	inline iterator begin()					{ return items; }
+	inline iterator end()					{ return items + count; }
+	inline const_iterator begin() const		{ return items; }
+	inline const_iterator end() const		{ return items + count; }
+
+	inline T & operator[](int index)				{ return items[index]; }
+	inline const T & operator[](int index) const	{ return items[index]; }
+	inline T & front()						{ return items[0]; }
+	inline const T & front() const			{ return items[0]; }
+	inline T & back()						{ return items[count - 1]; }
+	inline const T & back() const			{ return items[count - 1]; }
+
+	void reserve(int minCapacity) {
+		if(minCapacity > capacity) {
+			grow(minCapacity);
+		}
+	}
+
+	// Keeps any heap storage for the next fill
+	inline void clear()	{ count = 0; }
+
+	// Goes back to the inline storage when the items fit
+	void shrinkToFit() {
+		if(items != inlineItems && count <= inlineCapacity) {
+			for(int index = 0; index < count; ++index) {
+				inlineItems[index] = items[index];
+			}
+			delete [] items;
+			items = inlineItems;
+			capacity = inlineCapacity;
+		}
+	}
+
+	inline void push_back(const T &value) {
+		if(count == capacity) {
+			// value may live in the old storage
+			T copy = value;
+			grow(count + 1);
+			items[count++] = copy;
+		}
+		else {
+			items[count++] = value;
+		}
+	}
+
+	inline void pop_back() { --count; }
+
+	iterator insert(iterator pos, const T &value) {
+		int index = (int)(pos - items);
+		// value may live in the storage being moved
+		T copy = value;
+		push_back(copy);
+		for(int move = count - 1; move > index; --move) {
+			items[move] = items[move - 1];
+		}
+		items[index] = copy;
+		return items + index;
+	}
+
+	iterator erase(iterator pos) {
+		int index = (int)(pos - items);
+		for(int move = index + 1; move < count; ++move) {
+			items[move - 1] = items[move];
+		}
+		--count;
+		return items + index;
+	}
+};
+
+}}//end namespace
+
+#endif
@@ -155,6 +155,8 @@ public:
 	static int DEFAULT_HTTP_TIMEOUT;
 	static bool VERBOSE_MODE_ENABLED;
 	static bool ENABLE_THREADED_LOGGING;
+	// Threaded log entries per second and debug type, 0 for no limit
+	static int THREADED_LOGGING_RATE_LIMIT;
 	static bool SHUTDOWN_PROGRAM_MODE;
 
 	SystemFlags();
@@ -189,7 +191,8 @@ public:
 
 	// Let the macro call into this when require.. NEVER call it automatically.
 	static void handleDebug(DebugType type, const char *fmt, ...);
-	static void logDebugEntry(DebugType type, string debugEntry, time_t debugTime);
+	static void logDebugEntry(DebugType type, string debugEntry, time_t debugTime, bool flushStream=true);
+	static void flushDebugLogs();
 
 // If logging is enabled then define the logging method
 #ifndef UNDEF_DEBUG
@@ -64,6 +64,8 @@ class XmlIo;
 class XmlTree;
 class XmlNode;
 class XmlAttribute;
+class XmlTagReplacementContext;
+class XmlNodeArena;
 
 #if defined(WANT_XERCES)
 // =====================================================
@@ -156,22 +158,70 @@ public:
 	XmlNode *getRootNode() const	{return rootNode;}
 };
 
+// =====================================================
+//	class XmlTagReplacementContext
+//
+///	The tag replacements of one load, shared by every node
+/// and attribute instead of being copied into each of them.
+/// Values without any tag start character skip the
+/// replacement pass.
+// =====================================================
+
+class XmlTagReplacementContext {
+private:
+	const std::map<string,string> *mapTagReplacementValues;
+	string tagStartCharacters;
+	bool alwaysApplyTags;
+
+private:
+	void operator =(XmlTagReplacementContext&);
+
+public:
+	XmlTagReplacementContext(const std::map<string,string> &mapTagReplacementValues);
+
+	const std::map<string,string> &getTagReplacementValues() const { return *mapTagReplacementValues; }
+	bool applyTagsToValue(string &value, bool skipUpdatePathClimbingParts=false) const;
+};
+
 // =====================================================
 //	class XmlNode
 // =====================================================
 
 class XmlNode {
 private:
-	string name;
+	// Children with the same name, in document order
+	class ChildIndexEntry {
+	public:
+		const string *name;
+		vector<XmlNode*> nodes;
+
+		bool operator <(const ChildIndexEntry &entry) const { return *name < *entry.name; }
+	};
+
+	const string *name;
 	string text;
 	vector<XmlNode*> children;
 	vector<XmlAttribute*> attributes;
 	mutable const XmlNode* superNode;
 
+	// Nodes loaded by rapidxml live in an arena owned by the root node
+	XmlNodeArena *arena;
+	bool arenaAllocated;
+	vector<ChildIndexEntry> childNameIndex;
+
 private:
 	XmlNode(XmlNode&);
 	void operator =(XmlNode&);
 
+	XmlNode(xml_node<> *node, const XmlTagReplacementContext &tagReplacementContext,
+			bool skipUpdatePathClimbingParts, XmlNodeArena *arena);
+	void loadRapidXmlNode(xml_node<> *node, const XmlTagReplacementContext &tagReplacementContext,
+			bool skipUpdatePathClimbingParts);
+	void destroyChildren();
+	static void destroyChild(XmlNode *node);
+	void buildChildIndex();
+	const vector<XmlNode*> *getIndexedChildren(const string &childName) const;
+
 	string getTreeString() const;
 	bool hasChildNoSuper(const string& childName) const;
 
@@ -179,18 +229,18 @@ public:
 
 #if defined(WANT_XERCES)
 
-	XmlNode(XERCES_CPP_NAMESPACE::DOMNode *node, const std::map<string,string> &mapTagReplacementValues);
+	XmlNode(XERCES_CPP_NAMESPACE::DOMNode *node, const XmlTagReplacementContext &tagReplacementContext);
 	XERCES_CPP_NAMESPACE::DOMElement *buildElement(XERCES_CPP_NAMESPACE::DOMDocument *document) const;
 
 #endif
 
-	XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,bool skipUpdatePathClimbingParts=false);
+	XmlNode(xml_node<> *node, const XmlTagReplacementContext &tagReplacementContext,bool skipUpdatePathClimbingParts=false);
 	XmlNode(const string &name);
 	~XmlNode();
 	
 	void setSuper(const XmlNode* superNode) const { this->superNode = superNode; }
 
-	const string &getName() const	{return name;}
+	const string &getName() const	{return *name;}
 	size_t getChildCount() const		{return children.size();}
 	size_t getAttributeCount() const	{return attributes.size();}
 	const string &getText() const	{return text;}
@@ -219,12 +269,14 @@ public:
 // =====================================================
 
 class XmlAttribute {
+	friend class XmlNode;
+
 private:
 	string value;
-	string name;
+	const string *name;
 	bool skipRestrictionCheck;
 	bool usesCommondata;
-	std::map<string,string> mapTagReplacementValues;
+	bool arenaAllocated;
 
 private:
 	XmlAttribute(XmlAttribute&);
@@ -234,15 +286,17 @@ public:
 
 #if defined(WANT_XERCES)
 
-	XmlAttribute(XERCES_CPP_NAMESPACE::DOMNode *attribute, const std::map<string,string> &mapTagReplacementValues);
+	XmlAttribute(XERCES_CPP_NAMESPACE::DOMNode *attribute, const XmlTagReplacementContext &tagReplacementContext);
 
 #endif
 
-	XmlAttribute(xml_attribute<> *attribute, const std::map<string,string> &mapTagReplacementValues);
-	XmlAttribute(const string &name, const string &value, const std::map<string,string> &mapTagReplacementValues);
+	XmlAttribute(xml_attribute<> *attribute, const XmlTagReplacementContext &tagReplacementContext,
+			XmlNodeArena *arena=NULL);
+	XmlAttribute(const string &name, const string &value, const XmlTagReplacementContext &tagReplacementContext);
+	~XmlAttribute();
 
 public:
-	const string getName() const	{return name;}
+	const string &getName() const	{return *name;}
 	const string getValue(string prefixValue="", bool trimValueWithStartingSlash=false) const;
 
 	bool getBoolValue() const;
@@ -12,6 +12,7 @@
 
 #include "base_renderer.h"
 #include <cassert>
+#include <algorithm>
 #include "opengl.h"
 #include "vec.h"
 
@@ -35,10 +36,72 @@ void BaseRenderer::initMapSurface(int clientW, int clientH) {
 	assertGl();
 }
 
+void BaseRenderer::updateMapCellColors(MapPreview *map, bool heightMap, bool hideWater) {
+	int w = map->getW();
+	int h = map->getH();
+	int minX = 0;
+	int minY = 0;
+	int maxX = w - 1;
+	int maxY = h - 1;
+
+	if(map != mapCellColorsMap || w != mapCellColorsW || h != mapCellColorsH ||
+		heightMap != mapCellColorsHeightMap || hideWater != mapCellColorsHideWater) {
+		mapCellColorsMap = map;
+		mapCellColorsW = w;
+		mapCellColorsH = h;
+		mapCellColorsHeightMap = heightMap;
+		mapCellColorsHideWater = hideWater;
+		mapCellColors.resize(w * h);
+		mapCellCliffs.resize(w * h);
+	}
+	else if(map->getDirtyRect(minX, minY, maxX, maxY) == true) {
+		// a cliff depends on the heights around the cell
+		minX = max(minX - 1, 0);
+		minY = max(minY - 1, 0);
+		maxX = min(maxX + 1, w - 1);
+		maxY = min(maxY + 1, h - 1);
+	}
+	else {
+		return;
+	}
+
+	for (int j = minY; j <= maxY; j++) {
+		for (int i = minX; i <= maxX; i++) {
+			float alt = map->getHeight(i, j) / 20.f;
+			float showWater = map->getWaterLevel()/ 20.f - alt;
+			showWater = (showWater > 0)? showWater:0;
+			if(hideWater){
+				showWater = 0;
+			}
+			Vec3f surfColor;
+			switch (map->getSurface(i, j)) {
+				case st_Grass: surfColor = Vec3f(0.0, 0.8f * alt, 0.f + showWater); break;
+				case st_Secondary_Grass: surfColor = Vec3f(0.4f * alt, 0.6f * alt, 0.f + showWater); break;
+				case st_Road: surfColor = Vec3f(0.6f * alt, 0.3f * alt, 0.f + showWater); break;
+				case st_Stone: surfColor = Vec3f(0.7f * alt, 0.7f * alt, 0.7f * alt + showWater); break;
+				case st_Ground: surfColor = Vec3f(0.7f * alt, 0.5f * alt, 0.3f * alt + showWater); break;
+			}
+			if(heightMap){
+				surfColor = Vec3f(1.f * alt, 1.f * alt, 1.f * alt + showWater);
+			}
+			bool isCliff = false;
+			if(map->getCliffLevel()>0)
+			{// we maybe need to render cliff surfColor
+				if(map->isCliff(i, j)){
+					surfColor = Vec3f(0.95f * alt, 0.8f * alt, 0.0f * alt + showWater);
+					isCliff=true;
+				}
+			}
+			mapCellColors[j * w + i] = surfColor;
+			mapCellCliffs[j * w + i] = isCliff;
+		}
+	}
+	map->clearDirtyRect();
+}
+
 void BaseRenderer::renderMap(MapPreview *map, int x, int y,
 							 int clientW, int clientH, int cellSize, bool grid, bool heightMap, bool hideWater) {
-	float alt=0;
-	float showWater=0;
+	updateMapCellColors(map, heightMap, hideWater);
 
 	assertGl();
 
@@ -61,32 +124,9 @@ void BaseRenderer::renderMap(MapPreview *map, int x, int y,
 					&& i * cellSize + x < clientW
 					&& clientH - cellSize - j * cellSize + y > -cellSize
 					&& clientH - cellSize - j * cellSize + y < clientH) {
-				bool isCliff=false; // needed to speedup things
 				//surface
-				alt = map->getHeight(i, j) / 20.f;
-				showWater = map->getWaterLevel()/ 20.f - alt;
-				showWater = (showWater > 0)? showWater:0;
-				if(hideWater){
-					showWater = 0;
-				}
-				Vec3f surfColor;
-				switch (map->getSurface(i, j)) {
-					case st_Grass: surfColor = Vec3f(0.0, 0.8f * alt, 0.f + showWater); break;
-					case st_Secondary_Grass: surfColor = Vec3f(0.4f * alt, 0.6f * alt, 0.f + showWater); break;
-					case st_Road: surfColor = Vec3f(0.6f * alt, 0.3f * alt, 0.f + showWater); break;
-					case st_Stone: surfColor = Vec3f(0.7f * alt, 0.7f * alt, 0.7f * alt + showWater); break;
-					case st_Ground: surfColor = Vec3f(0.7f * alt, 0.5f * alt, 0.3f * alt + showWater); break;
-				}
-				if(heightMap){
-					surfColor = Vec3f(1.f * alt, 1.f * alt, 1.f * alt + showWater);
-				}
-				if(map->getCliffLevel()>0)
-				{// we maybe need to render cliff surfColor
-					if(map->isCliff(i, j)){
-						surfColor = Vec3f(0.95f * alt, 0.8f * alt, 0.0f * alt + showWater);
-						isCliff=true;
-					}
-				}
+				const Vec3f &surfColor = mapCellColors[j * map->getW() + i];
+				bool isCliff = (mapCellCliffs[j * map->getW() + i] != 0);
 				glColor3fv(surfColor.ptr());
 
 				glBegin(GL_TRIANGLE_STRIP);
@@ -155,13 +155,79 @@ void ModelRendererGl::renderNormalsOnly(Model *model) {
 	assertGl();
 }
 
+void ModelRendererGl::renderDrawList(const ModelDrawList &drawList, int renderMode) {
+	//assertions
+	assert(rendering);
+	assertGl();
+
+	glMatrixMode(GL_MODELVIEW);
+	bool fading = false;
+	for(uint32 i = 0; i < drawList.getBucketCount(); ++i) {
+		const ModelDrawBucket &bucket = drawList.getBucket(i);
+		Mesh *mesh = bucket.model->getMeshPtr(bucket.meshIndex);
+
+		if(meshCallback != NULL) {
+			meshCallback->setTeamTexture(bucket.teamTexture);
+		}
+		if(beginMesh(mesh, renderMode) == false) {
+			continue;
+		}
+
+		// Static meshes stay bound for the whole bucket, animated ones
+		// get the pose of every instance
+		bool useVBOs = (getVBOSupported() == true && mesh->getFrameCount() == 1);
+		if(useVBOs == true) {
+			setMeshArrays(mesh);
+		}
+		for(uint32 j = bucket.firstItem; j < bucket.firstItem + bucket.itemCount; ++j) {
+			const ModelDrawInstance &instance = drawList.getInstance(drawList.getItem(j).instanceIndex);
+
+			if(instance.alpha < 1.f) {
+				glDisable(GL_COLOR_MATERIAL);
+				glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, instance.alpha).ptr());
+				fading = true;
+			}
+			else if(fading == true) {
+				glEnable(GL_COLOR_MATERIAL);
+				fading = false;
+			}
+
+			if(useVBOs == false) {
+				instance.model->updateMeshInterpolationData(bucket.meshIndex, instance.animProgress, instance.cycleAnim);
+				setMeshArrays(mesh);
+			}
+
+			glPushMatrix();
+			glMultMatrixf(instance.transform.ptr());
+			drawMesh(mesh);
+			glPopMatrix();
+		}
+		endMesh(mesh, renderMode);
+	}
+	if(fading == true) {
+		glEnable(GL_COLOR_MATERIAL);
+	}
+
+	//assertions
+	assertGl();
+}
+
 // ===================== PRIVATE =======================
 
 void ModelRendererGl::renderMesh(Mesh *mesh,int renderMode) {
+	if(beginMesh(mesh, renderMode) == false) {
+		return;
+	}
+	setMeshArrays(mesh);
+	drawMesh(mesh);
+	endMesh(mesh, renderMode);
+}
+
+bool ModelRendererGl::beginMesh(Mesh *mesh,int renderMode) {
 
 	if(renderMode==rmSelection && mesh->getNoSelect()==true)
 	{// don't render this and do nothing
-		return;
+		return false;
 	}
 	//assertions
 	assertGl();
@@ -213,11 +279,10 @@ void ModelRendererGl::renderMesh(Mesh *mesh,int renderMode) {
 			meshCallback->execute(mesh);
 		}
 	}
+	return true;
+}
 
-	//misc vars
-	uint32 vertexCount= mesh->getVertexCount();
-	uint32 indexCount= mesh->getIndexCount();
-
+void ModelRendererGl::setMeshArrays(Mesh *mesh) {
 	//assertions
 	assertGl();
 
@@ -310,14 +375,18 @@ void ModelRendererGl::renderMesh(Mesh *mesh,int renderMode) {
 			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 		}
 	}
+}
+
+void ModelRendererGl::drawMesh(Mesh *mesh) {
+	//misc vars
+	uint32 vertexCount= mesh->getVertexCount();
+	uint32 indexCount= mesh->getIndexCount();
 
 	if(getVBOSupported() == true && mesh->getFrameCount() == 1) {
 		assertGl();
 
 		glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, mesh->getVBOIndexes() );
 		glDrawRangeElements(GL_TRIANGLES, 0, vertexCount-1, indexCount, GL_UNSIGNED_INT, (char *)NULL);
-		glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
-		glBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
 
 		//glDrawRangeElements(GL_TRIANGLES, 0, vertexCount-1, indexCount, GL_UNSIGNED_INT, mesh->getIndices());
 
@@ -329,6 +398,13 @@ void ModelRendererGl::renderMesh(Mesh *mesh,int renderMode) {
 
 		glDrawRangeElements(GL_TRIANGLES, 0, vertexCount-1, indexCount, GL_UNSIGNED_INT, mesh->getIndices());
 	}
+}
+
+void ModelRendererGl::endMesh(Mesh *mesh,int renderMode) {
+	if(getVBOSupported() == true && mesh->getFrameCount() == 1) {
+		glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
+		glBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
+	}
 
 	// glow
 	if(renderMode==rmNormal && mesh->getGlow()==true){
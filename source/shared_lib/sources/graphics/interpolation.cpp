@@ -13,6 +13,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <cmath>
 
 #include "model.h"
 #include "conversion.h"
@@ -26,17 +27,92 @@ using namespace Shared::Util;
 
 namespace Shared{ namespace Graphics{
 
+// =====================================================
+//	class InterpolationPoseCache
+// =====================================================
+
+InterpolationPoseCache::InterpolationPoseCache(uint32 vertexCount, int maxEntries) {
+	this->vertexCount	= vertexCount;
+	this->useCount		= 0;
+	this->computeCount	= 0;
+
+	entries.resize(max(maxEntries,1));
+	for(unsigned int i = 0; i < entries.size(); ++i) {
+		entries[i].prevFrame	= 0;
+		entries[i].nextFrame	= 0;
+		entries[i].localT		= 0;
+		entries[i].lastUse		= 0;
+		entries[i].data			= NULL;
+	}
+}
+
+InterpolationPoseCache::~InterpolationPoseCache() {
+	for(unsigned int i = 0; i < entries.size(); ++i) {
+		delete [] entries[i].data;
+		entries[i].data = NULL;
+	}
+}
+
+const Vec3f *InterpolationPoseCache::getPose(const Vec3f *src, uint32 prevFrame, uint32 nextFrame, float localT) {
+	useCount++;
+
+	// Reuse a matching pose, otherwise replace the least recently used one
+	unsigned int replaceIndex = 0;
+	for(unsigned int i = 0; i < entries.size(); ++i) {
+		Entry &entry = entries[i];
+		if(entry.data != NULL && entry.prevFrame == prevFrame &&
+			entry.nextFrame == nextFrame && entry.localT == localT) {
+			entry.lastUse = useCount;
+			return entry.data;
+		}
+		if(entry.data == NULL) {
+			replaceIndex = i;
+		}
+		else if(entries[replaceIndex].data != NULL && entry.lastUse < entries[replaceIndex].lastUse) {
+			replaceIndex = i;
+		}
+	}
+
+	Entry &entry = entries[replaceIndex];
+	if(entry.data == NULL) {
+		entry.data = new Vec3f[vertexCount];
+	}
+	entry.prevFrame	= prevFrame;
+	entry.nextFrame	= nextFrame;
+	entry.localT	= localT;
+	entry.lastUse	= useCount;
+
+	// Vec3f is three packed floats, the same layout the renderer hands to GL
+	lerp(&src[prevFrame * vertexCount].x, &src[nextFrame * vertexCount].x,
+			localT, &entry.data[0].x, vertexCount * 3);
+	computeCount++;
+
+	return entry.data;
+}
+
+void InterpolationPoseCache::lerp(const float *prev, const float *next, float t, float *dest, uint32 count) {
+	// A single flat loop without dependencies between iterations
+	// so the compiler can vectorize it
+	for(uint32 i = 0; i < count; ++i) {
+		dest[i] = prev[i] + (next[i] - prev[i]) * t;
+	}
+}
+
 // =====================================================
 //	class InterpolationData
 // =====================================================
 
 bool InterpolationData::enableInterpolation = true;
+float InterpolationData::quantizationStep = 1.0f / 64.0f;
+int InterpolationData::poseCacheSize = 4;
 
 InterpolationData::InterpolationData(const Mesh *mesh) {
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		throw megaglest_runtime_error("Loading graphics in headless server mode not allowed!");
 	}
 
+	vertexCache= NULL;
+	normalCache= NULL;
 	vertices= NULL;
 	normals= NULL;
 	
@@ -46,26 +122,36 @@ InterpolationData::InterpolationData(const Mesh *mesh) {
 }
 
 InterpolationData::~InterpolationData(){
-	delete [] vertices;
+	delete vertexCache;
+	vertexCache=NULL;
+	delete normalCache;
+	normalCache=NULL;
 	vertices=NULL;
-	delete [] normals;
 	normals=NULL;
 }
 
+float InterpolationData::quantizeLocalT(float localT, float step) {
+	if(step <= 0.0f) {
+		return localT;
+	}
+	float result = floor(localT / step + 0.5f) * step;
+	return min(max(result, 0.0f), 1.0f);
+}
+
 void InterpolationData::update(float t, bool cycle){
 	updateVertices(t, cycle);
 	updateNormals(t, cycle);
 }
 
 void InterpolationData::updateVertices(float t, bool cycle) {
-	update(mesh->getVertices(), vertices, t, cycle);
+	update(mesh->getVertices(), vertexCache, vertices, t, cycle);
 }
 
 void InterpolationData::updateNormals(float t, bool cycle) {
-	update(mesh->getNormals(), normals, t, cycle);
+	update(mesh->getNormals(), normalCache, normals, t, cycle);
 }
 
-void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cycle) {
+void InterpolationData::update(const Vec3f* src, InterpolationPoseCache* &cache, const Vec3f* &dest, float t, bool cycle) {
 
 	if(t <0.0f || t>1.0f) {
 		printf("ERROR t = [%f] for cycle [%d] f [%d] v [%d]\n",t,cycle,mesh->getFrameCount(),mesh->getVertexCount());
@@ -99,19 +185,16 @@ void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cyc
 		}
 
 		uint32 prevFrameBase= prevFrame*vertexCount;
-		uint32 nextFrameBase= nextFrame*vertexCount;
 
 		//assertions
 		assert(prevFrame<frameCount);
 		assert(nextFrame<frameCount);
 		
 		if(enableInterpolation) {
-			if(!dest) { // not previously allocated
-			      dest = new Vec3f[vertexCount];
-			}
-			for(uint32 j=0; j<vertexCount; ++j){
-				dest[j]= src[prevFrameBase+j].lerp(localT, src[nextFrameBase+j]);
+			if(!cache) { // not previously allocated
+				cache = new InterpolationPoseCache(vertexCount, poseCacheSize);
 			}
+			dest= cache->getPose(src, prevFrame, nextFrame, quantizeLocalT(localT, quantizationStep));
 		} else {
 			raw_frame_ofs = prevFrameBase;
 		}
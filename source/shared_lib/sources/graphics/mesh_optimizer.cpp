@@ -0,0 +1,237 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "mesh_optimizer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	class MeshCacheStats
+// =====================================================
+
+void MeshCacheStats::add(const MeshCacheStats &stats) {
+	vertexCount		+= stats.vertexCount;
+	triangleCount	+= stats.triangleCount;
+	cacheMisses		+= stats.cacheMisses;
+}
+
+float MeshCacheStats::getACMR() const {
+	return (triangleCount > 0 ? (float)cacheMisses / (float)triangleCount : 0.f);
+}
+
+float MeshCacheStats::getATVR() const {
+	return (vertexCount > 0 ? (float)cacheMisses / (float)vertexCount : 0.f);
+}
+
+// =====================================================
+//	class MeshOptimizer
+// =====================================================
+
+const int MeshOptimizer::cacheSize;
+const uint32 MeshOptimizer::unusedVertex;
+
+// Scoring constants from the original article
+static const float cacheDecayPower		= 1.5f;
+static const float lastTriangleScore	= 0.75f;
+static const float valenceBoostScale	= 2.0f;
+static const float valenceBoostPower	= 0.5f;
+
+static float getVertexScore(int cachePosition, uint32 remainingTriangles) {
+	if(remainingTriangles == 0) {
+		return -1.f;
+	}
+
+	float score = 0.f;
+	if(cachePosition >= 0) {
+		if(cachePosition < 3) {
+			// The triangle just drawn, no reason to prefer any of its corners
+			score = lastTriangleScore;
+		}
+		else {
+			const float scaler = 1.f / (MeshOptimizer::cacheSize - 3);
+			score = pow(1.f - (cachePosition - 3) * scaler, cacheDecayPower);
+		}
+	}
+	// Finishing off vertices with few triangles left frees cache slots early
+	score += valenceBoostScale * pow((float)remainingTriangles, -valenceBoostPower);
+	return score;
+}
+
+void MeshOptimizer::optimizeVertexCache(uint32 *indices, uint32 indexCount, uint32 vertexCount) {
+	const uint32 triangleCount = indexCount / 3;
+	if(triangleCount < 2 || vertexCount == 0) {
+		return;
+	}
+
+	// Triangles using each vertex
+	vector<uint32> remainingTriangles(vertexCount, 0);
+	for(uint32 i = 0; i < triangleCount * 3; ++i) {
+		remainingTriangles[indices[i]]++;
+	}
+	vector<uint32> vertexTriangleOffsets(vertexCount + 1, 0);
+	for(uint32 i = 0; i < vertexCount; ++i) {
+		vertexTriangleOffsets[i + 1] = vertexTriangleOffsets[i] + remainingTriangles[i];
+	}
+	vector<uint32> vertexTriangles(triangleCount * 3);
+	vector<uint32> fillOffsets(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+	for(uint32 i = 0; i < triangleCount * 3; ++i) {
+		vertexTriangles[fillOffsets[indices[i]]++] = i / 3;
+	}
+
+	vector<int> cachePositions(vertexCount, -1);
+	vector<float> vertexScores(vertexCount);
+	for(uint32 i = 0; i < vertexCount; ++i) {
+		vertexScores[i] = getVertexScore(-1, remainingTriangles[i]);
+	}
+	vector<float> triangleScores(triangleCount);
+	for(uint32 i = 0; i < triangleCount; ++i) {
+		triangleScores[i] = vertexScores[indices[i * 3]] +
+							vertexScores[indices[i * 3 + 1]] +
+							vertexScores[indices[i * 3 + 2]];
+	}
+	vector<bool> triangleAdded(triangleCount, false);
+	vector<uint32> result;
+	result.reserve(triangleCount * 3);
+
+	// Room for the three corners pushed in front of a full cache
+	vector<uint32> cache;
+	cache.reserve(cacheSize + 3);
+	vector<uint32> newCache;
+	newCache.reserve(cacheSize + 3);
+
+	uint32 nextUnaddedTriangle = 0;
+	int bestTriangle = -1;
+	for(;;) {
+		if(bestTriangle < 0) {
+			// Nothing in the cache is worth anything, start elsewhere
+			float bestScore = -1.f;
+			for(uint32 i = nextUnaddedTriangle; i < triangleCount; ++i) {
+				if(triangleAdded[i] == true) {
+					if(i == nextUnaddedTriangle) {
+						nextUnaddedTriangle++;
+					}
+					continue;
+				}
+				if(triangleScores[i] > bestScore) {
+					bestScore = triangleScores[i];
+					bestTriangle = i;
+				}
+			}
+			if(bestTriangle < 0) {
+				break;
+			}
+		}
+
+		const uint32 *corners = &indices[bestTriangle * 3];
+		triangleAdded[bestTriangle] = true;
+		newCache.clear();
+		for(int i = 0; i < 3; ++i) {
+			result.push_back(corners[i]);
+			newCache.push_back(corners[i]);
+
+			// Take the triangle off the vertex's list
+			uint32 vertex = corners[i];
+			uint32 begin = vertexTriangleOffsets[vertex];
+			uint32 end = begin + remainingTriangles[vertex];
+			for(uint32 j = begin; j < end; ++j) {
+				if(vertexTriangles[j] == (uint32)bestTriangle) {
+					vertexTriangles[j] = vertexTriangles[end - 1];
+					break;
+				}
+			}
+			remainingTriangles[vertex]--;
+		}
+		for(unsigned int i = 0; i < cache.size(); ++i) {
+			uint32 vertex = cache[i];
+			if(vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+				newCache.push_back(vertex);
+			}
+		}
+		cache.swap(newCache);
+
+		// Rescore what is in or just fell out of the cache and pick the
+		// best triangle touching it
+		bestTriangle = -1;
+		float bestScore = -1.f;
+		for(unsigned int i = 0; i < cache.size(); ++i) {
+			uint32 vertex = cache[i];
+			cachePositions[vertex] = (i < (unsigned int)cacheSize ? (int)i : -1);
+			float score = getVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+
+			uint32 begin = vertexTriangleOffsets[vertex];
+			uint32 end = begin + remainingTriangles[vertex];
+			for(uint32 j = begin; j < end; ++j) {
+				uint32 triangle = vertexTriangles[j];
+				triangleScores[triangle] += delta;
+				if(triangleScores[triangle] > bestScore) {
+					bestScore = triangleScores[triangle];
+					bestTriangle = triangle;
+				}
+			}
+		}
+		if(cache.size() > (unsigned int)cacheSize) {
+			cache.resize(cacheSize);
+		}
+	}
+
+	copy(result.begin(), result.end(), indices);
+}
+
+uint32 MeshOptimizer::optimizeVertexFetch(uint32 *indices, uint32 indexCount, uint32 vertexCount, vector<uint32> &remap) {
+	remap.assign(vertexCount, unusedVertex);
+
+	uint32 usedCount = 0;
+	for(uint32 i = 0; i < indexCount; ++i) {
+		uint32 &index = indices[i];
+		if(remap[index] == unusedVertex) {
+			remap[index] = usedCount++;
+		}
+		index = remap[index];
+	}
+	return usedCount;
+}
+
+MeshCacheStats MeshOptimizer::getCacheStats(const uint32 *indices, uint32 indexCount, uint32 vertexCount, int simulatedCacheSize) {
+	MeshCacheStats stats;
+	stats.vertexCount = vertexCount;
+	stats.triangleCount = indexCount / 3;
+
+	// GPUs replace the oldest entry, a hit does not refresh it
+	vector<uint32> insertTimes(vertexCount, 0);
+	uint32 time = (uint32)simulatedCacheSize + 1;
+	for(uint32 i = 0; i < stats.triangleCount * 3; ++i) {
+		uint32 vertex = indices[i];
+		if(time - insertTimes[vertex] > (uint32)simulatedCacheSize) {
+			insertTimes[vertex] = time++;
+			stats.cacheMisses++;
+		}
+	}
+	return stats;
+}
+
+string MeshOptimizer::getReport(const MeshCacheStats &before, const MeshCacheStats &after) {
+	char szBuf[512] = "";
+	snprintf(szBuf, 512, "triangles: %u vertices: %u -> %u ACMR: %.3f -> %.3f ATVR: %.3f -> %.3f",
+			after.triangleCount, before.vertexCount, after.vertexCount,
+			before.getACMR(), after.getACMR(), before.getATVR(), after.getATVR());
+	return szBuf;
+}
+
+}}//end namespace
@@ -13,7 +13,17 @@
 
 #include <cstdio>
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef WIN32
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
 
 #include "interpolation.h"
 #include "conversion.h"
@@ -21,6 +31,7 @@
 #include "platform_common.h"
 #include "opengl.h"
 #include "platform_util.h"
+#include "checksum.h"
 #include <memory>
 #include <map>
 #include <vector>
@@ -195,6 +206,222 @@ void fromEndianMeshHeaderV2(MeshHeaderV2 &header) {
 	}
 }
 
+// =====================================================
+//	class MappedModelFile
+//
+///	A whole model file in memory. Mapped copy on write where
+/// the platform allows it, so byte order fixes stay private,
+/// otherwise read with a single call.
+// =====================================================
+
+class MappedModelFile {
+private:
+	uint8 *data;
+	size_t size;
+	bool mapped;
+
+public:
+	MappedModelFile() {
+		data	= NULL;
+		size	= 0;
+		mapped	= false;
+	}
+	~MappedModelFile() {
+		close();
+	}
+
+	bool open(const string &path) {
+		close();
+#ifdef WIN32
+		FILE *f= _wfopen(utf8_decode(path).c_str(), L"rb");
+		if(f == NULL) {
+			return false;
+		}
+		fseek(f, 0, SEEK_END);
+		long fileSize = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		if(fileSize > 0) {
+			size = (size_t)fileSize;
+			data = new uint8[size];
+			size = fread(data, 1, size, f);
+		}
+		fclose(f);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if(fd < 0) {
+			return false;
+		}
+		struct stat fileStat;
+		if(fstat(fd, &fileStat) != 0 || S_ISREG(fileStat.st_mode) == false) {
+			::close(fd);
+			return false;
+		}
+		size = (size_t)fileStat.st_size;
+		if(size > 0) {
+			void *view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if(view != MAP_FAILED) {
+				data = static_cast<uint8 *>(view);
+				mapped = true;
+			}
+			else {
+				data = new uint8[size];
+				size_t bytesRead = 0;
+				for(;bytesRead < size;) {
+					ssize_t result = read(fd, &data[bytesRead], size - bytesRead);
+					if(result <= 0) {
+						break;
+					}
+					bytesRead += (size_t)result;
+				}
+				size = bytesRead;
+			}
+		}
+		::close(fd);
+#endif
+		return true;
+	}
+
+	void close() {
+		if(data != NULL) {
+#ifndef WIN32
+			if(mapped == true) {
+				munmap(data, size);
+			}
+			else
+#endif
+			{
+				delete [] data;
+			}
+		}
+		data	= NULL;
+		size	= 0;
+		mapped	= false;
+	}
+
+	uint8 *getData() const	{return data;}
+	size_t getSize() const	{return size;}
+};
+
+// =====================================================
+//	class G3dReader
+//
+///	fread and fseek over a MappedModelFile, that can also
+/// hand out arrays in place
+// =====================================================
+
+class G3dReader {
+private:
+	uint8 *data;
+	size_t size;
+	size_t offset;
+	bool inPlace;
+
+public:
+	G3dReader(MappedModelFile &file, bool inPlace) {
+		this->data		= file.getData();
+		this->size		= file.getSize();
+		this->offset	= 0;
+		this->inPlace	= inPlace;
+	}
+
+	size_t read(void *dest, size_t elementSize, size_t count) {
+		if(elementSize == 0 || offset >= size) {
+			return 0;
+		}
+		size_t available = (size - offset) / elementSize;
+		if(count > available) {
+			count = available;
+		}
+		memcpy(dest, &data[offset], elementSize * count);
+		offset += elementSize * count;
+		return count;
+	}
+
+	int seek(long distance, int origin) {
+		int64 position = (origin == SEEK_SET ? 0 : (int64)offset) + distance;
+		if(origin == SEEK_END || position < 0) {
+			return -1;
+		}
+		offset = (size_t)position;
+		return 0;
+	}
+
+	// Returns the next count elements where they are, or NULL when they
+	// have to be copied
+	template<class T> T *mapArray(uint32 count) {
+		if(inPlace == false || count == 0 || offset >= size ||
+			(size - offset) / sizeof(T) < count) {
+			return NULL;
+		}
+		uint8 *element = &data[offset];
+		if(((size_t)element % sizeof(float32)) != 0) {
+			return NULL;
+		}
+		offset += sizeof(T) * count;
+		return reinterpret_cast<T *>(element);
+	}
+};
+
+// =====================================================
+//	Preprocessed model cache, native byte order with
+//	every array 4 byte aligned so it can be used in place
+// =====================================================
+
+const uint32 modelCacheVersion			= 2;
+const uint32 modelCacheByteOrderMark	= 0x01020304;
+
+struct ModelCacheHeader {
+	uint8 id[4];
+	uint32 version;
+	uint32 byteOrderMark;
+	uint32 fileVersion;
+	uint32 meshCount;
+	uint32 withTextures;
+	int64 sourceSize;
+	int64 sourceModTime;
+	// Followed by the model path, padded to 4 bytes
+	uint32 pathSize;
+	uint32 reserved;
+};
+
+struct ModelCacheMeshHeader {
+	uint8 name[meshNameSize];
+	uint32 frameCount;
+	uint32 vertexCount;
+	uint32 indexCount;
+	uint32 texCoordFrameCount;
+	float32 diffuseColor[3];
+	float32 specularColor[3];
+	float32 specularPower;
+	float32 opacity;
+	uint32 properties;
+	uint32 textureFlags;
+	// Normals are stored as int16 components of normal / normalScale
+	float32 normalScale;
+	uint8 texturePaths[meshTextureCount][mapPathSize];
+};
+
+static bool getModelFileStamp(const string &path, int64 &size, int64 &modifiedTime) {
+#ifdef WIN32
+  #if defined(__MINGW32__)
+	struct _stat fileStat;
+  #else
+	struct _stat64i32 fileStat;
+  #endif
+	if(_wstat(utf8_decode(path).c_str(), &fileStat) != 0) {
+		return false;
+	}
+#else
+	struct stat fileStat;
+	if(stat(path.c_str(), &fileStat) != 0) {
+		return false;
+	}
+#endif
+	size = (int64)fileStat.st_size;
+	modifiedTime = (int64)fileStat.st_mtime;
+	return true;
+}
+
 // =====================================================
 //	class Mesh
 // =====================================================
@@ -215,6 +442,7 @@ Mesh::Mesh() {
 	texCoords= NULL;
 	tangents= NULL;
 	indices= NULL;
+	mappedData= 0;
 	interpolationData= NULL;
 
 	for(int i=0; i<meshTextureCount; ++i){
@@ -242,6 +470,7 @@ Mesh::~Mesh() {
 }
 
 void Mesh::init() {
+	mappedData= 0;
 	try {
 		vertices= new Vec3f[frameCount*vertexCount];
 	}
@@ -279,16 +508,25 @@ void Mesh::init() {
 void Mesh::end() {
 	ReleaseVBOs();
 
-	delete [] vertices;
+	if((mappedData & mdfVertices) == 0) {
+		delete [] vertices;
+	}
 	vertices=NULL;
-	delete [] normals;
+	if((mappedData & mdfNormals) == 0) {
+		delete [] normals;
+	}
 	normals=NULL;
-	delete [] texCoords;
+	if((mappedData & mdfTexCoords) == 0) {
+		delete [] texCoords;
+	}
 	texCoords=NULL;
 	delete [] tangents;
 	tangents=NULL;
-	delete [] indices;
+	if((mappedData & mdfIndices) == 0) {
+		delete [] indices;
+	}
 	indices=NULL;
+	mappedData=0;
 
 	cleanupInterpolationData();
 
@@ -409,13 +647,38 @@ string Mesh::findAlternateTexture(vector<string> conversionList, string textureF
 	return result;
 }
 
-void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
+// Points data at the next count elements of the file when they can be used
+// in place, otherwise reads them into an array of its own. Returns 1 like
+// fread when every element was there.
+template<class T> size_t Mesh::readData(G3dReader &reader, T *&data, uint32 count, uint32 flag) {
+	bool owned = (data != NULL && (mappedData & flag) == 0);
+	T *inPlace = (owned == false ? reader.mapArray<T>(count) : NULL);
+	if(inPlace != NULL) {
+		data = inPlace;
+		mappedData |= flag;
+		return 1;
+	}
+	if(owned == false) {
+		try {
+			data= new T[count];
+		}
+		catch(bad_alloc& ba) {
+			char szBuf[8096]="";
+			snprintf(szBuf,8096,"Error on line: %d size: %u msg: %s\n",__LINE__,count,ba.what());
+			throw megaglest_runtime_error(szBuf);
+		}
+		mappedData &= ~flag;
+	}
+	return reader.read(data, sizeof(T) * count, 1);
+}
+
+void Mesh::loadV2(int meshIndex, const string &dir, G3dReader &reader, TextureManager *textureManager,
 		bool deletePixMapAfterLoad, std::map<string,vector<pair<string, string> > > *loadedFileList,
 		string sourceLoader,string modelFile) {
 	this->textureManager = textureManager;
 	//read header
 	MeshHeaderV2 meshHeader;
-	size_t readBytes = fread(&meshHeader, sizeof(MeshHeaderV2), 1, f);
+	size_t readBytes = reader.read(&meshHeader, sizeof(MeshHeaderV2), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -441,8 +704,6 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	indexCount= meshHeader.indexCount;
 	texCoordFrameCount = meshHeader.texCoordFrameCount;
 
-	init();
-
 	//misc
 	twoSided= false;
 	customColor= false;
@@ -457,8 +718,10 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	}
 
 	//texture
-	if(meshHeader.hasTexture && textureManager!=NULL){
+	if(meshHeader.hasTexture) {
 		texturePaths[mtDiffuse]= toLower(reinterpret_cast<char*>(meshHeader.texName));
+	}
+	if(meshHeader.hasTexture && textureManager!=NULL){
 		string texPath= dir;
         if(texPath != "") {
         	endPathWithSlash(texPath);
@@ -467,7 +730,10 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v2 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 
-		textures[mtDiffuse]= dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
+		// Shared textures are looked up by queueTexture2D so every model holds a reference
+		if(textureManager->getShareTextures() == false) {
+			textures[mtDiffuse]= dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
+		}
 		if(textures[mtDiffuse] == NULL) {
 			if(fileExists(texPath) == false) {
 				vector<string> conversionList;
@@ -480,16 +746,10 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 			if(fileExists(texPath) == true) {
 				if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v2 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 
-				textures[mtDiffuse]= textureManager->newTexture2D();
-				textures[mtDiffuse]->load(texPath);
+				textures[mtDiffuse]= textureManager->queueTexture2D(texPath,-1,deletePixMapAfterLoad,texturesOwned[mtDiffuse]);
 				if(loadedFileList) {
 					(*loadedFileList)[texPath].push_back(make_pair(sourceLoader,sourceLoader));
 				}
-				texturesOwned[mtDiffuse]=true;
-				textures[mtDiffuse]->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
-				if(deletePixMapAfterLoad == true) {
-					textures[mtDiffuse]->deletePixels();
-				}
 			}
 			else {
 				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v2 model is missing texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
@@ -498,7 +758,7 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	}
 
 	//read data
-	readBytes = fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
+	readBytes = readData(reader, vertices, frameCount*vertexCount, mdfVertices);
 	if(readBytes != 1 && (frameCount * vertexCount) != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -506,7 +766,7 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	}
 	fromEndianVecArray<Vec3f>(vertices, frameCount*vertexCount);
 
-	readBytes = fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
+	readBytes = readData(reader, normals, frameCount*vertexCount, mdfNormals);
 	if(readBytes != 1 && (frameCount * vertexCount) != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -515,7 +775,7 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	fromEndianVecArray<Vec3f>(normals, frameCount*vertexCount);
 
 	if(textureFlags & (1<<mtDiffuse)) {
-		readBytes = fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
+		readBytes = readData(reader, texCoords, vertexCount, mdfTexCoords);
 		if(readBytes != 1 && vertexCount != 0) {
 			char szBuf[8096]="";
 			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -523,7 +783,10 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 		}
 		fromEndianVecArray<Vec2f>(texCoords, vertexCount);
 	}
-	readBytes = fread(&diffuseColor, sizeof(Vec3f), 1, f);
+	if(texCoords == NULL) {
+		texCoords= new Vec2f[vertexCount];
+	}
+	readBytes = reader.read(&diffuseColor, sizeof(Vec3f), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -531,7 +794,7 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	}
 	fromEndianVecArray<Vec3f>(&diffuseColor, 1);
 
-	readBytes = fread(&opacity, sizeof(float32), 1, f);
+	readBytes = reader.read(&opacity, sizeof(float32), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -539,13 +802,13 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	}
 	opacity = Shared::PlatformByteOrder::fromCommonEndian(opacity);
 
-	int seek_result = fseek(f, sizeof(Vec4f)*(meshHeader.colorFrameCount-1), SEEK_CUR);
+	int seek_result = reader.seek(sizeof(Vec4f)*(meshHeader.colorFrameCount-1), SEEK_CUR);
 	if(seek_result != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fseek returned failure = %d [%u] on line: %d.",seek_result,indexCount,__LINE__);
 		throw megaglest_runtime_error(szBuf);
 	}
-	readBytes = fread(indices, sizeof(uint32)*indexCount, 1, f);
+	readBytes = readData(reader, indices, indexCount, mdfIndices);
 	if(readBytes != 1 && indexCount != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u] on line: %d.",readBytes,indexCount,__LINE__);
@@ -554,7 +817,7 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 	Shared::PlatformByteOrder::fromEndianTypeArray<uint32>(indices, indexCount);
 }
 
-void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
+void Mesh::loadV3(int meshIndex, const string &dir, G3dReader &reader,
 		TextureManager *textureManager,bool deletePixMapAfterLoad,
 		std::map<string,vector<pair<string, string> > > *loadedFileList,
 		string sourceLoader,string modelFile) {
@@ -562,7 +825,7 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 
 	//read header
 	MeshHeaderV3 meshHeader;
-	size_t readBytes = fread(&meshHeader, sizeof(MeshHeaderV3), 1, f);
+	size_t readBytes = reader.read(&meshHeader, sizeof(MeshHeaderV3), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -582,8 +845,6 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 	indexCount= meshHeader.indexCount;
 	texCoordFrameCount = meshHeader.texCoordFrameCount;
 
-	init();
-
 	//misc
 	twoSided= (meshHeader.properties & mp3TwoSided) != 0;
 	customColor= (meshHeader.properties & mp3CustomColor) != 0;
@@ -598,8 +859,10 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Load v3, this = %p Found meshHeader.properties = %d, textureFlags = %d, texName [%s] mtDiffuse = %d meshIndex = %d modelFile [%s]\n",this,meshHeader.properties,textureFlags,toLower(reinterpret_cast<char*>(meshHeader.texName)).c_str(),mtDiffuse,meshIndex,modelFile.c_str());
 
 	//texture
-	if((meshHeader.properties & mp3NoTexture) != mp3NoTexture && textureManager!=NULL){
+	if((meshHeader.properties & mp3NoTexture) != mp3NoTexture) {
 		texturePaths[mtDiffuse]= toLower(reinterpret_cast<char*>(meshHeader.texName));
+	}
+	if((meshHeader.properties & mp3NoTexture) != mp3NoTexture && textureManager!=NULL){
 
 		string texPath= dir;
         if(texPath != "") {
@@ -609,7 +872,10 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v3 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 
-		textures[mtDiffuse]= dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
+		// Shared textures are looked up by queueTexture2D so every model holds a reference
+		if(textureManager->getShareTextures() == false) {
+			textures[mtDiffuse]= dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
+		}
 		if(textures[mtDiffuse] == NULL) {
 			if(fileExists(texPath) == false) {
 				vector<string> conversionList;
@@ -623,17 +889,10 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 			if(fileExists(texPath) == true) {
 				if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v3 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 
-				textures[mtDiffuse]= textureManager->newTexture2D();
-				textures[mtDiffuse]->load(texPath);
+				textures[mtDiffuse]= textureManager->queueTexture2D(texPath,-1,deletePixMapAfterLoad,texturesOwned[mtDiffuse]);
 				if(loadedFileList) {
 					(*loadedFileList)[texPath].push_back(make_pair(sourceLoader,sourceLoader));
 				}
-
-				texturesOwned[mtDiffuse]=true;
-				textures[mtDiffuse]->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
-				if(deletePixMapAfterLoad == true) {
-					textures[mtDiffuse]->deletePixels();
-				}
 			}
 			else {
 				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v3 model is missing texture [%s] meshHeader.properties = %d meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshHeader.properties,meshIndex,modelFile.c_str());
@@ -642,7 +901,7 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 	}
 
 	//read data
-	readBytes = fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
+	readBytes = readData(reader, vertices, frameCount*vertexCount, mdfVertices);
 	if(readBytes != 1 && (frameCount * vertexCount) != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -650,7 +909,7 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 	}
 	fromEndianVecArray<Vec3f>(vertices, frameCount*vertexCount);
 
-	readBytes = fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
+	readBytes = readData(reader, normals, frameCount*vertexCount, mdfNormals);
 	if(readBytes != 1 && (frameCount * vertexCount) != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -660,7 +919,7 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 
 	if(textureFlags & (1<<mtDiffuse)) {
 		for(unsigned int i=0; i<meshHeader.texCoordFrameCount; ++i){
-			readBytes = fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
+			readBytes = readData(reader, texCoords, vertexCount, mdfTexCoords);
 			if(readBytes != 1 && vertexCount != 0) {
 				char szBuf[8096]="";
 				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -669,7 +928,10 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 			fromEndianVecArray<Vec2f>(texCoords, vertexCount);
 		}
 	}
-	readBytes = fread(&diffuseColor, sizeof(Vec3f), 1, f);
+	if(texCoords == NULL) {
+		texCoords= new Vec2f[vertexCount];
+	}
+	readBytes = reader.read(&diffuseColor, sizeof(Vec3f), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -677,7 +939,7 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 	}
 	fromEndianVecArray<Vec3f>(&diffuseColor, 1);
 
-	readBytes = fread(&opacity, sizeof(float32), 1, f);
+	readBytes = reader.read(&opacity, sizeof(float32), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -685,14 +947,14 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 	}
 	opacity = Shared::PlatformByteOrder::fromCommonEndian(opacity);
 
-	int seek_result = fseek(f, sizeof(Vec4f)*(meshHeader.colorFrameCount-1), SEEK_CUR);
+	int seek_result = reader.seek(sizeof(Vec4f)*(meshHeader.colorFrameCount-1), SEEK_CUR);
 	if(seek_result != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fseek returned failure = %d [%u] on line: %d.",seek_result,indexCount,__LINE__);
 		throw megaglest_runtime_error(szBuf);
 	}
 
-	readBytes = fread(indices, sizeof(uint32)*indexCount, 1, f);
+	readBytes = readData(reader, indices, indexCount, mdfIndices);
 	if(readBytes != 1 && indexCount != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u] on line: %d.",readBytes,indexCount,__LINE__);
@@ -709,7 +971,11 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #1 load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
 
-	Texture2D* texture = dynamic_cast<Texture2D*>(textureManager->getTexture(textureFile));
+	// Shared textures are looked up by queueTexture2D so every model holds a reference
+	Texture2D* texture = NULL;
+	if(textureManager->getShareTextures() == false) {
+		texture = dynamic_cast<Texture2D*>(textureManager->getTexture(textureFile));
+	}
 	if(texture == NULL) {
 		if(fileExists(textureFile) == false) {
 			vector<string> conversionList;
@@ -726,24 +992,11 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #3 load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
 			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture exists loading [%s]\n",__FUNCTION__,textureFile.c_str());
 
-			texture = textureManager->newTexture2D();
-			if(textureChannelCount != -1) {
-				texture->getPixmap()->init(textureChannelCount);
-			}
-			texture->load(textureFile);
+			// Decoded in the background, Model::loadG3d uploads it
+			texture = textureManager->queueTexture2D(textureFile,textureChannelCount,deletePixMapAfterLoad,textureOwned);
 			if(loadedFileList) {
 				(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
 			}
-
-			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture loaded [%s]\n",__FUNCTION__,textureFile.c_str());
-
-			textureOwned = true;
-			texture->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
-			if(deletePixMapAfterLoad == true) {
-				texture->deletePixels();
-			}
-
-			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture inited [%s]\n",__FUNCTION__,textureFile.c_str());
 		}
 		else {
 			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #3 cannot load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
@@ -754,14 +1007,14 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 	return texture;
 }
 
-void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
+void Mesh::load(int meshIndex, const string &dir, G3dReader &reader, TextureManager *textureManager,
 				bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList,
 				string sourceLoader,string modelFile) {
 	this->textureManager = textureManager;
 	
 	//read header
 	MeshHeader meshHeader;
-	size_t readBytes = fread(&meshHeader, sizeof(MeshHeader), 1, f);
+	size_t readBytes = reader.read(&meshHeader, sizeof(MeshHeader), 1);
 	if(readBytes != 1) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -778,8 +1031,6 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 	vertexCount= meshHeader.vertexCount;
 	indexCount= meshHeader.indexCount;
 
-	init();
-
 	//properties
 	customColor= (meshHeader.properties & mpfCustomColor) != 0;
 	twoSided= (meshHeader.properties & mpfTwoSided) != 0;
@@ -806,7 +1057,7 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 		if(meshHeader.textures & flag) {
 			uint8 cMapPath[mapPathSize+1];
 			memset(&cMapPath[0],0,mapPathSize+1);
-			readBytes = fread(cMapPath, mapPathSize, 1, f);
+			readBytes = reader.read(cMapPath, mapPathSize, 1);
 			cMapPath[mapPathSize] = 0;
 			if(readBytes != 1 && mapPathSize != 0) {
 				char szBuf[8096]="";
@@ -819,6 +1070,7 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 			memset(&mapPathString[0],0,mapPathSize+1);
 			memcpy(&mapPathString[0],reinterpret_cast<char*>(cMapPath),mapPathSize);
 			string mapPath= toLower(mapPathString);
+			texturePaths[i]= mapPath;
 
 			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("mapPath [%s] meshHeader.textures = %d flag = %d (meshHeader.textures & flag) = %d meshIndex = %d i = %d\n",mapPath.c_str(),meshHeader.textures,flag,(meshHeader.textures & flag),meshIndex,i);
 
@@ -837,7 +1089,7 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 	}
 
 	//read data
-	readBytes = fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
+	readBytes = readData(reader, vertices, frameCount*vertexCount, mdfVertices);
 	if(readBytes != 1 && (frameCount * vertexCount) != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -845,7 +1097,7 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 	}
 	fromEndianVecArray<Vec3f>(vertices, frameCount*vertexCount);
 
-	readBytes = fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
+	readBytes = readData(reader, normals, frameCount*vertexCount, mdfNormals);
 	if(readBytes != 1 && (frameCount * vertexCount) != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -854,7 +1106,7 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 	fromEndianVecArray<Vec3f>(normals, frameCount*vertexCount);
 
 	if(meshHeader.textures!=0){
-		readBytes = fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
+		readBytes = readData(reader, texCoords, vertexCount, mdfTexCoords);
 		if(readBytes != 1 && vertexCount != 0) {
 			char szBuf[8096]="";
 			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.",readBytes,frameCount,vertexCount,__LINE__);
@@ -862,7 +1114,10 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 		}
 		fromEndianVecArray<Vec2f>(texCoords, vertexCount);
 	}
-	readBytes = fread(indices, sizeof(uint32)*indexCount, 1, f);
+	if(texCoords == NULL) {
+		texCoords= new Vec2f[vertexCount];
+	}
+	readBytes = readData(reader, indices, indexCount, mdfIndices);
 	if(readBytes != 1 && indexCount != 0) {
 		char szBuf[8096]="";
 		snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u] on line: %d.",readBytes,indexCount,__LINE__);
@@ -876,6 +1131,159 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 	}
 }
 
+bool Mesh::loadCache(G3dReader &reader) {
+	ModelCacheMeshHeader meshHeader;
+	if(reader.read(&meshHeader, sizeof(ModelCacheMeshHeader), 1) != 1) {
+		return false;
+	}
+
+	char meshName[meshNameSize+1]="";
+	memcpy(&meshName[0],&meshHeader.name[0],meshNameSize);
+	meshName[meshNameSize] = 0;
+	name = meshName;
+
+	frameCount= meshHeader.frameCount;
+	vertexCount= meshHeader.vertexCount;
+	indexCount= meshHeader.indexCount;
+	texCoordFrameCount= meshHeader.texCoordFrameCount;
+
+	customColor= (meshHeader.properties & mpfCustomColor) != 0;
+	twoSided= (meshHeader.properties & mpfTwoSided) != 0;
+	noSelect= (meshHeader.properties & mpfNoSelect) != 0;
+	glow= (meshHeader.properties & mpfGlow) != 0;
+
+	diffuseColor= Vec3f(meshHeader.diffuseColor);
+	specularColor= Vec3f(meshHeader.specularColor);
+	specularPower= meshHeader.specularPower;
+	opacity= meshHeader.opacity;
+	textureFlags= meshHeader.textureFlags;
+
+	for(int i = 0; i < meshTextureCount; ++i) {
+		char mapPath[mapPathSize+1]="";
+		memcpy(&mapPath[0],&meshHeader.texturePaths[i][0],mapPathSize);
+		mapPath[mapPathSize] = 0;
+		texturePaths[i]= mapPath;
+	}
+
+	uint32 frameVertexCount = frameCount * vertexCount;
+	if(readData(reader, vertices, frameVertexCount, mdfVertices) != 1 && frameVertexCount != 0) {
+		return false;
+	}
+
+	vector<int16> quantizedNormals(frameVertexCount * 3 + (frameVertexCount % 2));
+	if(quantizedNormals.empty() == false &&
+		reader.read(&quantizedNormals[0], sizeof(int16) * quantizedNormals.size(), 1) != 1) {
+		return false;
+	}
+	normals= new Vec3f[frameVertexCount];
+	mappedData &= ~mdfNormals;
+	float scale = meshHeader.normalScale / 32767.f;
+	for(uint32 i = 0; i < frameVertexCount; ++i) {
+		normals[i] = Vec3f(quantizedNormals[i * 3] * scale,
+						   quantizedNormals[i * 3 + 1] * scale,
+						   quantizedNormals[i * 3 + 2] * scale);
+	}
+
+	if(readData(reader, texCoords, vertexCount, mdfTexCoords) != 1 && vertexCount != 0) {
+		return false;
+	}
+	if(readData(reader, indices, indexCount, mdfIndices) != 1 && indexCount != 0) {
+		return false;
+	}
+	return true;
+}
+
+void Mesh::loadCacheTextures(int meshIndex, const string &dir, TextureManager *textureManager,
+		bool deletePixMapAfterLoad, std::map<string,vector<pair<string, string> > > *loadedFileList,
+		string sourceLoader, string modelFile) {
+	this->textureManager = textureManager;
+
+	if(textureManager != NULL) {
+		for(int i = 0; i < meshTextureCount; ++i) {
+			if(texturePaths[i] != "") {
+				string mapFullPath= dir;
+				if(mapFullPath != "") {
+					endPathWithSlash(mapFullPath);
+				}
+				mapFullPath += texturePaths[i];
+				textures[i] = loadMeshTexture(meshIndex, i, textureManager, mapFullPath,
+						meshTextureChannelCount[i],texturesOwned[i],
+						deletePixMapAfterLoad, loadedFileList, sourceLoader,modelFile);
+			}
+		}
+	}
+
+	//tangents
+	if(textures[mtNormal]!=NULL){
+		computeTangents();
+	}
+}
+
+void Mesh::saveCache(FILE *f) {
+	ModelCacheMeshHeader meshHeader;
+	memset(&meshHeader, 0, sizeof(ModelCacheMeshHeader));
+
+	strncpy((char*)meshHeader.name, name.c_str(), meshNameSize - 1);
+	meshHeader.frameCount= frameCount;
+	meshHeader.vertexCount= vertexCount;
+	meshHeader.indexCount= indexCount;
+	meshHeader.texCoordFrameCount= texCoordFrameCount;
+
+	meshHeader.properties= 0;
+	if(customColor) {
+		meshHeader.properties |= mpfCustomColor;
+	}
+	if(twoSided) {
+		meshHeader.properties |= mpfTwoSided;
+	}
+	if(noSelect) {
+		meshHeader.properties |= mpfNoSelect;
+	}
+	if(glow) {
+		meshHeader.properties |= mpfGlow;
+	}
+
+	memcpy(meshHeader.diffuseColor, diffuseColor.ptr(), sizeof(float32) * 3);
+	memcpy(meshHeader.specularColor, specularColor.ptr(), sizeof(float32) * 3);
+	meshHeader.specularPower= specularPower;
+	meshHeader.opacity= opacity;
+	meshHeader.textureFlags= textureFlags;
+
+	for(int i = 0; i < meshTextureCount; ++i) {
+		memcpy(&meshHeader.texturePaths[i][0],texturePaths[i].c_str(),
+				min((size_t)mapPathSize,texturePaths[i].length()));
+	}
+
+	uint32 frameVertexCount = frameCount * vertexCount;
+	float normalScale = 1.f;
+	for(uint32 i = 0; i < frameVertexCount; ++i) {
+		normalScale = max(normalScale, max(fabs(normals[i].x), max(fabs(normals[i].y), fabs(normals[i].z))));
+	}
+	meshHeader.normalScale= normalScale;
+
+	vector<int16> quantizedNormals(frameVertexCount * 3 + (frameVertexCount % 2), 0);
+	for(uint32 i = 0; i < frameVertexCount; ++i) {
+		quantizedNormals[i * 3]		= (int16)floor(normals[i].x / normalScale * 32767.f + 0.5f);
+		quantizedNormals[i * 3 + 1]	= (int16)floor(normals[i].y / normalScale * 32767.f + 0.5f);
+		quantizedNormals[i * 3 + 2]	= (int16)floor(normals[i].z / normalScale * 32767.f + 0.5f);
+	}
+
+	bool written = (fwrite(&meshHeader, sizeof(ModelCacheMeshHeader), 1, f) == 1);
+	if(frameVertexCount != 0) {
+		written = written && (fwrite(vertices, sizeof(Vec3f) * frameVertexCount, 1, f) == 1);
+		written = written && (fwrite(&quantizedNormals[0], sizeof(int16) * quantizedNormals.size(), 1, f) == 1);
+	}
+	if(vertexCount != 0) {
+		written = written && (fwrite(texCoords, sizeof(Vec2f) * vertexCount, 1, f) == 1);
+	}
+	if(indexCount != 0) {
+		written = written && (fwrite(indices, sizeof(uint32) * indexCount, 1, f) == 1);
+	}
+	if(written == false) {
+		throw megaglest_runtime_error("Error writing model cache mesh: " + name);
+	}
+}
+
 void Mesh::save(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 		string convertTextureToFormat, std::map<string,int> &textureDeleteList,
 		bool keepsmallest,string modelFile) {
@@ -998,6 +1406,7 @@ void Mesh::save(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 													NULL,
 													"",
 													modelFile);
+						textureManager->initPendingTextures();
 					}
 				}
 
@@ -1084,10 +1493,156 @@ void Mesh::deletePixels() {
 	}
 }
 
+// ========================== optimization =========================
+
+bool Mesh::isSameVertex(uint32 vertex1, uint32 vertex2) const {
+	for(uint32 frame = 0; frame < frameCount; ++frame) {
+		uint32 offset = frame * vertexCount;
+		if(memcmp(&vertices[offset + vertex1], &vertices[offset + vertex2], sizeof(Vec3f)) != 0 ||
+			memcmp(&normals[offset + vertex1], &normals[offset + vertex2], sizeof(Vec3f)) != 0) {
+			return false;
+		}
+	}
+	return (texCoords == NULL ||
+			memcmp(&texCoords[vertex1], &texCoords[vertex2], sizeof(Vec2f)) == 0);
+}
+
+void Mesh::optimize(MeshCacheStats *before, MeshCacheStats *after) {
+	MeshCacheStats beforeStats = getCacheStats();
+	if(before != NULL) {
+		before->add(beforeStats);
+	}
+
+	bool canOptimize = (frameCount > 0 && vertexCount > 0 && indexCount >= 3 &&
+						vertices != NULL && normals != NULL && indices != NULL);
+	for(uint32 i = 0; i < indexCount && canOptimize == true; ++i) {
+		canOptimize = (indices[i] < vertexCount);
+	}
+	if(canOptimize == false) {
+		if(after != NULL) {
+			after->add(beforeStats);
+		}
+		return;
+	}
+
+	uint32 newVertexCount = 0;
+	uint32 *newIndices = NULL;
+	Vec3f *newVertices = NULL;
+	Vec3f *newNormals = NULL;
+	Vec2f *newTexCoords = NULL;
+	try {
+		newIndices = new uint32[indexCount];
+
+		// Vertices equal in every frame, found through a hash of all their data
+		vector<pair<uint32, uint32> > vertexHashes(vertexCount);
+		for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+			Checksum checksum;
+			for(uint32 frame = 0; frame < frameCount; ++frame) {
+				uint32 offset = frame * vertexCount + vertex;
+				checksum.addBytes(&vertices[offset], sizeof(Vec3f));
+				checksum.addBytes(&normals[offset], sizeof(Vec3f));
+			}
+			if(texCoords != NULL) {
+				checksum.addBytes(&texCoords[vertex], sizeof(Vec2f));
+			}
+			vertexHashes[vertex] = make_pair(checksum.getSum(), vertex);
+		}
+		sort(vertexHashes.begin(), vertexHashes.end());
+
+		vector<uint32> uniqueVertex(vertexCount);
+		for(uint32 i = 0; i < vertexCount; ++i) {
+			uint32 vertex = vertexHashes[i].second;
+			uniqueVertex[vertex] = vertex;
+			for(uint32 j = i; j > 0 && vertexHashes[j - 1].first == vertexHashes[i].first; --j) {
+				uint32 other = vertexHashes[j - 1].second;
+				if(uniqueVertex[other] == other && isSameVertex(other, vertex) == true) {
+					uniqueVertex[vertex] = other;
+					break;
+				}
+			}
+		}
+		for(uint32 i = 0; i < indexCount; ++i) {
+			newIndices[i] = uniqueVertex[indices[i]];
+		}
+
+		// Blended meshes keep their triangle order, it shows through
+		if(opacity >= 1.f) {
+			MeshOptimizer::optimizeVertexCache(newIndices, indexCount, vertexCount);
+		}
+		vector<uint32> remap;
+		newVertexCount = MeshOptimizer::optimizeVertexFetch(newIndices, indexCount, vertexCount, remap);
+
+		newVertices = new Vec3f[frameCount * newVertexCount];
+		newNormals = new Vec3f[frameCount * newVertexCount];
+		if(texCoords != NULL) {
+			newTexCoords = new Vec2f[newVertexCount];
+		}
+		for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+			uint32 newVertex = remap[vertex];
+			if(newVertex == MeshOptimizer::unusedVertex) {
+				continue;
+			}
+			for(uint32 frame = 0; frame < frameCount; ++frame) {
+				newVertices[frame * newVertexCount + newVertex] = vertices[frame * vertexCount + vertex];
+				newNormals[frame * newVertexCount + newVertex] = normals[frame * vertexCount + vertex];
+			}
+			if(newTexCoords != NULL) {
+				newTexCoords[newVertex] = texCoords[vertex];
+			}
+		}
+	}
+	catch(bad_alloc& ba) {
+		delete [] newIndices;
+		delete [] newVertices;
+		delete [] newNormals;
+		delete [] newTexCoords;
+
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Error on line: %d size: %d msg: %s\n",__LINE__,frameCount * vertexCount,ba.what());
+		throw megaglest_runtime_error(szBuf);
+	}
+
+	if(hasBuiltVBOs == true) {
+		ReleaseVBOs();
+	}
+	bool hadInterpolationData = (interpolationData != NULL);
+	cleanupInterpolationData();
+
+	setVertices(newVertices, newVertexCount);
+	setNormals(newNormals, newVertexCount);
+	if(newTexCoords != NULL) {
+		setTexCoords(newTexCoords, newVertexCount);
+	}
+	setIndices(newIndices, indexCount);
+
+	if(tangents != NULL) {
+		computeTangents();
+	}
+	if(hadInterpolationData == true) {
+		buildInterpolationData();
+	}
+
+	if(after != NULL) {
+		after->add(getCacheStats());
+	}
+}
+
+MeshCacheStats Mesh::getCacheStats() const {
+	if(indices == NULL) {
+		MeshCacheStats stats;
+		stats.vertexCount = vertexCount;
+		return stats;
+	}
+	return MeshOptimizer::getCacheStats(indices, indexCount, vertexCount);
+}
+
 // ===============================================
 //	class Model
 // ===============================================
 
+string Model::cachePath		= "";
+bool Model::mapDataInPlace	= true;
+
 // ==================== constructor & destructor ====================
 
 Model::Model() {
@@ -1103,11 +1658,17 @@ Model::Model() {
 	lastCycleData	= false;
 	lastTVertex		= -1;
 	lastCycleVertex	= false;
+	mappedFile		= NULL;
+	loadedFromCache	= false;
 }
 
 Model::~Model() {
 	if(meshes) delete [] meshes;
 	meshes = NULL;
+
+	// Only after the meshes that point into it
+	delete mappedFile;
+	mappedFile = NULL;
 }
 
 // ==================== data ====================
@@ -1128,6 +1689,13 @@ void Model::updateInterpolationData(float t, bool cycle) {
 	}
 }
 
+void Model::updateMeshInterpolationData(uint32 meshIndex, float t, bool cycle) {
+	meshes[meshIndex].updateInterpolationData(t, cycle);
+	// The other meshes may be in another pose now
+	lastTData = -1.f;
+	lastTVertex = -1.f;
+}
+
 void Model::updateInterpolationVertices(float t, bool cycle) {
 	if(lastTVertex != t || lastCycleVertex != cycle) {
 		for(unsigned int i = 0; i < meshCount; ++i) {
@@ -1156,6 +1724,20 @@ uint32 Model::getVertexCount() const {
 	return vertexCount;
 }
 
+MeshCacheStats Model::getCacheStats() const {
+	MeshCacheStats stats;
+	for(uint32 i = 0; i < meshCount; ++i) {
+		stats.add(meshes[i].getCacheStats());
+	}
+	return stats;
+}
+
+void Model::optimizeMeshes(MeshCacheStats *before, MeshCacheStats *after) {
+	for(uint32 i = 0; i < meshCount; ++i) {
+		meshes[i].optimize(before, after);
+	}
+}
+
 // ==================== io ====================
 
 void Model::load(const string &path, bool deletePixMapAfterLoad,
@@ -1193,15 +1775,27 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 		string sourceLoader) {
 
     try{
-#ifdef WIN32
-		FILE *f= _wfopen(utf8_decode(path).c_str(), L"rb");
-#else
-		FILE *f=fopen(path.c_str(),"rb");
-#endif
-		if (f == NULL) {
+		string cacheFile = getCacheFileName(path);
+		if(cacheFile != "" && loadG3dCache(path, cacheFile, deletePixMapAfterLoad, loadedFileList, sourceLoader) == true) {
+			if(loadedFileList) {
+				(*loadedFileList)[path].push_back(make_pair(sourceLoader,sourceLoader));
+			}
+			loadedFromCache = true;
+			releaseUnusedFile();
+
+			if(textureManager != NULL && textureManager->getDeferredInit() == false) {
+				textureManager->initPendingTextures();
+			}
+			return;
+		}
+
+		// Frame data is used straight from the mapping where possible
+		mappedFile = new MappedModelFile();
+		if (mappedFile->open(path) == false) {
 		    printf("In [%s::%s] cannot load file = [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,path.c_str());
 			throw megaglest_runtime_error("Error opening g3d model file [" + path + "]",true);
 		}
+		G3dReader reader(*mappedFile, mapDataInPlace);
 
 		if(loadedFileList) {
 			(*loadedFileList)[path].push_back(make_pair(sourceLoader,sourceLoader));
@@ -1211,9 +1805,8 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 
 		//file header
 		FileHeader fileHeader;
-		size_t readBytes = fread(&fileHeader, sizeof(FileHeader), 1, f);
+		size_t readBytes = reader.read(&fileHeader, sizeof(FileHeader), 1);
 		if(readBytes != 1) {
-			fclose(f);
 			char szBuf[8096]="";
 			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
 			throw megaglest_runtime_error(szBuf);
@@ -1225,8 +1818,6 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 		memcpy(&fileId[0],reinterpret_cast<char*>(fileHeader.id),3);
 
 		if(strncmp(fileId, "G3D", 3) != 0) {
-			fclose(f);
-			f = NULL;
 		    printf("In [%s::%s] file = [%s] fileheader.id = [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,path.c_str(),fileId);
 			throw megaglest_runtime_error("Not a valid G3D model",true);
 		}
@@ -1238,7 +1829,7 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 		if(fileHeader.version == 4) {
 			//model header
 			ModelHeader modelHeader;
-			readBytes = fread(&modelHeader, sizeof(ModelHeader), 1, f);
+			readBytes = reader.read(&modelHeader, sizeof(ModelHeader), 1);
 			if(readBytes != 1) {
 				char szBuf[8096]="";
 				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
@@ -1265,14 +1856,14 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 			}
 
 			for(uint32 i = 0; i < meshCount; ++i) {
-				meshes[i].load(i, dir, f, textureManager,deletePixMapAfterLoad,
+				meshes[i].load(i, dir, reader, textureManager,deletePixMapAfterLoad,
 						loadedFileList,sourceLoader,path);
 				meshes[i].buildInterpolationData();
 			}
 		}
 		//version 3
 		else if(fileHeader.version == 3) {
-			readBytes = fread(&meshCount, sizeof(meshCount), 1, f);
+			readBytes = reader.read(&meshCount, sizeof(meshCount), 1);
 			if(readBytes != 1 && meshCount != 0) {
 				char szBuf[8096]="";
 				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u] on line: %d.",readBytes,meshCount,__LINE__);
@@ -1292,14 +1883,14 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 			}
 
 			for(uint32 i = 0; i < meshCount; ++i) {
-				meshes[i].loadV3(i, dir, f, textureManager,deletePixMapAfterLoad,
+				meshes[i].loadV3(i, dir, reader, textureManager,deletePixMapAfterLoad,
 						loadedFileList,sourceLoader,path);
 				meshes[i].buildInterpolationData();
 			}
 		}
 		//version 2
 		else if(fileHeader.version == 2) {
-			readBytes = fread(&meshCount, sizeof(meshCount), 1, f);
+			readBytes = reader.read(&meshCount, sizeof(meshCount), 1);
 			if(readBytes != 1 && meshCount != 0) {
 				char szBuf[8096]="";
 				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u] on line: %d.",readBytes,meshCount,__LINE__);
@@ -1320,7 +1911,7 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 			}
 
 			for(uint32 i = 0; i < meshCount; ++i){
-				meshes[i].loadV2(i,dir, f, textureManager,deletePixMapAfterLoad,
+				meshes[i].loadV2(i,dir, reader, textureManager,deletePixMapAfterLoad,
 						loadedFileList,sourceLoader,path);
 				meshes[i].buildInterpolationData();
 			}
@@ -1329,9 +1920,18 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 			throw megaglest_runtime_error("Invalid model version: "+ intToStr(fileHeader.version));
 		}
 
-		fclose(f);
-
 		autoJoinMeshFrames();
+
+		if(cacheFile != "") {
+			// Paid once per model, later loads read the optimized cache
+			optimizeMeshes();
+			saveG3dCache(path, cacheFile);
+		}
+		releaseUnusedFile();
+
+		if(textureManager != NULL && textureManager->getDeferredInit() == false) {
+			textureManager->initPendingTextures();
+		}
     }
     catch(megaglest_runtime_error& ex) {
     	//printf("1111111 ex.wantStackTrace() = %d\n",ex.wantStackTrace());
@@ -1346,6 +1946,156 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 	}
 }
 
+string Model::getCacheFileName(const string &path) {
+	if(cachePath == "") {
+		return "";
+	}
+	Checksum checksum;
+	checksum.addString(path);
+
+	string result = cachePath;
+	endPathWithSlash(result);
+	return result + "model_" + uIntToStr(checksum.getSum()) + ".g3dc";
+}
+
+// Loads the meshes as they were after the last full load, joined and with
+// quantized normals. Returns false when the cache is missing or stale.
+bool Model::loadG3dCache(const string &path, const string &cacheFile, bool deletePixMapAfterLoad,
+		std::map<string,vector<pair<string, string> > > *loadedFileList, string sourceLoader) {
+	int64 sourceSize = 0;
+	int64 sourceModTime = 0;
+	if(getModelFileStamp(path, sourceSize, sourceModTime) == false) {
+		return false;
+	}
+	MappedModelFile *cache = new MappedModelFile();
+	if(cache->open(cacheFile) == false) {
+		delete cache;
+		return false;
+	}
+	G3dReader reader(*cache, mapDataInPlace);
+
+	ModelCacheHeader header;
+	bool valid = (reader.read(&header, sizeof(ModelCacheHeader), 1) == 1 &&
+				memcmp(header.id, "G3C", 4) == 0 &&
+				header.version == modelCacheVersion &&
+				header.byteOrderMark == modelCacheByteOrderMark &&
+				header.withTextures == (textureManager != NULL ? 1u : 0u) &&
+				header.sourceSize == sourceSize &&
+				header.sourceModTime == sourceModTime &&
+				header.pathSize == path.length());
+	if(valid == true) {
+		// Cache names are only a hash of the path
+		vector<char> cachedPath((path.length() + 3) & ~3);
+		valid = (cachedPath.empty() == true ||
+				(reader.read(&cachedPath[0], cachedPath.size(), 1) == 1 &&
+				 memcmp(&cachedPath[0], path.c_str(), path.length()) == 0));
+	}
+
+	Mesh *cachedMeshes = NULL;
+	if(valid == true) {
+		try {
+			cachedMeshes = new Mesh[header.meshCount];
+			for(uint32 i = 0; i < header.meshCount && valid == true; ++i) {
+				valid = cachedMeshes[i].loadCache(reader);
+			}
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s] reading [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what(),cacheFile.c_str());
+			valid = false;
+		}
+	}
+	if(valid == false) {
+		delete [] cachedMeshes;
+		delete cache;
+		return false;
+	}
+
+	fileVersion = (uint8)header.fileVersion;
+	meshCount = header.meshCount;
+	meshes = cachedMeshes;
+	mappedFile = cache;
+
+	string dir= extractDirectoryPathFromFile(path);
+	for(uint32 i = 0; i < meshCount; ++i) {
+		meshes[i].loadCacheTextures(i, dir, textureManager, deletePixMapAfterLoad,
+				loadedFileList, sourceLoader, path);
+		meshes[i].buildInterpolationData();
+	}
+	return true;
+}
+
+void Model::saveG3dCache(const string &path, const string &cacheFile) {
+	int64 sourceSize = 0;
+	int64 sourceModTime = 0;
+	if(getModelFileStamp(path, sourceSize, sourceModTime) == false) {
+		return;
+	}
+
+	// Written aside and renamed, models still mapping the old cache keep it
+	string tempCacheFile = cacheFile + ".tmp";
+#ifdef WIN32
+	FILE *f= _wfopen(utf8_decode(tempCacheFile).c_str(), L"wb");
+#else
+	FILE *f= fopen(tempCacheFile.c_str(), "wb");
+#endif
+	if(f == NULL) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] cannot write model cache [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,tempCacheFile.c_str());
+		return;
+	}
+
+	ModelCacheHeader header;
+	memset(&header, 0, sizeof(ModelCacheHeader));
+	memcpy(header.id, "G3C", 4);
+	header.version = modelCacheVersion;
+	header.byteOrderMark = modelCacheByteOrderMark;
+	header.fileVersion = fileVersion;
+	header.meshCount = meshCount;
+	header.withTextures = (textureManager != NULL ? 1 : 0);
+	header.sourceSize = sourceSize;
+	header.sourceModTime = sourceModTime;
+	header.pathSize = (uint32)path.length();
+
+	vector<char> cachedPath((path.length() + 3) & ~3, 0);
+	if(cachedPath.empty() == false) {
+		memcpy(&cachedPath[0], path.c_str(), path.length());
+	}
+
+	bool written = (fwrite(&header, sizeof(ModelCacheHeader), 1, f) == 1);
+	if(cachedPath.empty() == false) {
+		written = written && (fwrite(&cachedPath[0], cachedPath.size(), 1, f) == 1);
+	}
+	try {
+		for(uint32 i = 0; i < meshCount && written == true; ++i) {
+			meshes[i].saveCache(f);
+		}
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s] writing [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what(),tempCacheFile.c_str());
+		written = false;
+	}
+	written = (fclose(f) == 0) && written;
+
+	if(written == true) {
+#ifdef WIN32
+		removeFile(cacheFile);
+#endif
+		written = renameFile(tempCacheFile, cacheFile);
+	}
+	if(written == false) {
+		removeFile(tempCacheFile);
+	}
+}
+
+void Model::releaseUnusedFile() {
+	for(uint32 i = 0; i < meshCount; ++i) {
+		if(meshes[i].hasMappedData() == true) {
+			return;
+		}
+	}
+	delete mappedFile;
+	mappedFile = NULL;
+}
+
 //save a model to a g3d file
 void Model::saveG3d(const string &path, string convertTextureToFormat,
 		bool keepsmallest) {
@@ -1437,28 +2187,40 @@ public:
 };
 
 void Mesh::setVertices(Vec3f *data, uint32 count) {
-	delete [] this->vertices;
+	if((this->mappedData & mdfVertices) == 0) {
+		delete [] this->vertices;
+	}
 	this->vertices = data;
+	this->mappedData &= ~mdfVertices;
 
 	this->vertexCount = count;
 }
 void Mesh::setNormals(Vec3f *data, uint32 count) {
-	delete [] this->normals;
+	if((this->mappedData & mdfNormals) == 0) {
+		delete [] this->normals;
+	}
 	this->normals = data;
+	this->mappedData &= ~mdfNormals;
 
 	this->vertexCount = count;
 }
 
 void Mesh::setTexCoords(Vec2f *data, uint32 count) {
-	delete [] this->texCoords;
+	if((this->mappedData & mdfTexCoords) == 0) {
+		delete [] this->texCoords;
+	}
 	this->texCoords = data;
+	this->mappedData &= ~mdfTexCoords;
 
 	this->vertexCount = count;
 }
 
 void Mesh::setIndices(uint32 *data, uint32 count) {
-	delete [] this->indices;
+	if((this->mappedData & mdfIndices) == 0) {
+		delete [] this->indices;
+	}
 	this->indices = data;
+	this->mappedData &= ~mdfIndices;
 
 	this->indexCount = count;
 }
@@ -1483,9 +2245,11 @@ void Mesh::copyInto(Mesh *dest, bool ignoreInterpolationData,
 	dest->indexCount 			= this->indexCount;
 	dest->texCoordFrameCount 	= this->texCoordFrameCount;
 
-	//vertex data
+	//vertex data, the copy always owns its arrays
 	if(dest->vertices != NULL) {
-		delete [] dest->vertices;
+		if((dest->mappedData & mdfVertices) == 0) {
+			delete [] dest->vertices;
+		}
 		dest->vertices = NULL;
 	}
 	if(this->vertices != NULL) {
@@ -1494,7 +2258,9 @@ void Mesh::copyInto(Mesh *dest, bool ignoreInterpolationData,
 	}
 
 	if(dest->normals != NULL) {
-		delete [] dest->normals;
+		if((dest->mappedData & mdfNormals) == 0) {
+			delete [] dest->normals;
+		}
 		dest->normals = NULL;
 	}
 	if(this->normals != NULL) {
@@ -1503,7 +2269,9 @@ void Mesh::copyInto(Mesh *dest, bool ignoreInterpolationData,
 	}
 
 	if(dest->texCoords != NULL) {
-		delete [] dest->texCoords;
+		if((dest->mappedData & mdfTexCoords) == 0) {
+			delete [] dest->texCoords;
+		}
 		dest->texCoords = NULL;
 	}
 	if(this->texCoords != NULL) {
@@ -1521,13 +2289,16 @@ void Mesh::copyInto(Mesh *dest, bool ignoreInterpolationData,
 	}
 
 	if(dest->indices != NULL) {
-		delete [] dest->indices;
+		if((dest->mappedData & mdfIndices) == 0) {
+			delete [] dest->indices;
+		}
 		dest->indices = NULL;
 	}
 	if(this->indices != NULL) {
 		dest->indices = new uint32[this->indexCount];
 		memcpy(&dest->indices[0],&this->indices[0],this->indexCount * sizeof(uint32));
 	}
+	dest->mappedData = 0;
 
 	//material data
 	dest->diffuseColor 	= this->diffuseColor;
@@ -1705,8 +2476,9 @@ void Model::autoJoinMeshFrames() {
 						base->setVertices(joined_vertices, newVertexCount);
 						base->setNormals(joined_normals, newVertexCount);
 
-						// If we have texture coords join them
-						if(base->getTextureFlags() & 1) {
+						// If we have texture coords join them, every loader
+						// allocates them so the arrays match the vertices
+						if(base->getTexCoords() != NULL && mesh->getTexCoords() != NULL) {
 							Vec2f *joined_texCoords = new Vec2f[newVertexCount];
 
 							// update texture coord buffers with joined mesh data
@@ -0,0 +1,203 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "model_draw_list.h"
+
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include "model.h"
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	class ModelDrawItemLess
+// =====================================================
+
+class ModelDrawItemLess {
+private:
+	const vector<ModelDrawInstance> *instances;
+
+public:
+	ModelDrawItemLess(const vector<ModelDrawInstance> *instances) : instances(instances) {}
+
+	bool operator()(const ModelDrawItem &item1, const ModelDrawItem &item2) const {
+		less<const void *> pointerLess;
+		if(item1.model != item2.model) {
+			return pointerLess(item1.model, item2.model);
+		}
+		if(item1.meshIndex != item2.meshIndex) {
+			return item1.meshIndex < item2.meshIndex;
+		}
+		if(item1.teamTexture != item2.teamTexture) {
+			return pointerLess(item1.teamTexture, item2.teamTexture);
+		}
+
+		// Fading instances change the material, keep them together at the
+		// end and the same poses next to each other
+		const ModelDrawInstance &instance1 = (*instances)[item1.instanceIndex];
+		const ModelDrawInstance &instance2 = (*instances)[item2.instanceIndex];
+		bool fading1 = (instance1.alpha < 1.f);
+		bool fading2 = (instance2.alpha < 1.f);
+		if(fading1 != fading2) {
+			return fading2;
+		}
+		if(instance1.animProgress != instance2.animProgress) {
+			return instance1.animProgress < instance2.animProgress;
+		}
+		return item1.instanceIndex < item2.instanceIndex;
+	}
+};
+
+// =====================================================
+//	class ModelDrawList
+// =====================================================
+
+void ModelDrawList::clear() {
+	instances.clear();
+	items.clear();
+	buckets.clear();
+}
+
+uint32 ModelDrawList::addInstance(Model *model, const Texture *teamTexture, const Vec3f &translation,
+		float rotationZ, float rotationX, float rotationY,
+		float animProgress, bool cycleAnim, float alpha) {
+	ModelDrawInstance instance;
+	instance.model			= model;
+	instance.teamTexture	= teamTexture;
+	instance.transform		= getTransform(translation, rotationZ, rotationX, rotationY);
+	instance.animProgress	= animProgress;
+	instance.cycleAnim		= cycleAnim;
+	instance.alpha			= alpha;
+	instances.push_back(instance);
+	return (uint32)instances.size() - 1;
+}
+
+void ModelDrawList::build() {
+	items.clear();
+	buckets.clear();
+
+	for(uint32 i = 0; i < instances.size(); ++i) {
+		const ModelDrawInstance &instance = instances[i];
+		for(uint32 j = 0; j < instance.model->getMeshCount(); ++j) {
+			ModelDrawItem item;
+			item.model			= instance.model;
+			item.meshIndex		= j;
+			item.teamTexture	= (instance.model->getMesh(j)->getCustomTexture() == true ? instance.teamTexture : NULL);
+			item.instanceIndex	= i;
+			items.push_back(item);
+		}
+	}
+	sort(items.begin(), items.end(), ModelDrawItemLess(&instances));
+
+	for(uint32 i = 0; i < items.size(); ++i) {
+		const ModelDrawItem &item = items[i];
+		if(buckets.empty() == false) {
+			ModelDrawBucket &bucket = buckets.back();
+			if(bucket.model == item.model && bucket.meshIndex == item.meshIndex &&
+				bucket.teamTexture == item.teamTexture) {
+				bucket.itemCount++;
+				continue;
+			}
+		}
+
+		ModelDrawBucket bucket;
+		bucket.model		= item.model;
+		bucket.meshIndex	= item.meshIndex;
+		bucket.texture		= item.model->getMesh(item.meshIndex)->getTexture(mtDiffuse);
+		bucket.teamTexture	= item.teamTexture;
+		bucket.firstItem	= i;
+		bucket.itemCount	= 1;
+		buckets.push_back(bucket);
+	}
+}
+
+uint32 ModelDrawList::getUnbatchedStateChanges() const {
+	uint32 stateChanges = 0;
+	const Texture *lastTexture = NULL;
+	const Texture *lastTeamTexture = NULL;
+	for(uint32 i = 0; i < instances.size(); ++i) {
+		const ModelDrawInstance &instance = instances[i];
+		for(uint32 j = 0; j < instance.model->getMeshCount(); ++j) {
+			const Mesh *mesh = instance.model->getMesh(j);
+			const Texture *texture = mesh->getTexture(mtDiffuse);
+			const Texture *teamTexture = (mesh->getCustomTexture() == true ? instance.teamTexture : NULL);
+			if(stateChanges == 0 || texture != lastTexture || teamTexture != lastTeamTexture) {
+				stateChanges++;
+				lastTexture = texture;
+				lastTeamTexture = teamTexture;
+			}
+		}
+	}
+	return stateChanges;
+}
+
+uint32 ModelDrawList::getStateChanges() const {
+	uint32 stateChanges = 0;
+	for(uint32 i = 0; i < buckets.size(); ++i) {
+		if(i == 0 || buckets[i].texture != buckets[i - 1].texture ||
+			buckets[i].teamTexture != buckets[i - 1].teamTexture) {
+			stateChanges++;
+		}
+	}
+	return stateChanges;
+}
+
+Matrix4f ModelDrawList::getTransform(const Vec3f &translation, float rotationZ, float rotationX, float rotationY) {
+	const float degreesToRadians = 3.14159265f / 180.f;
+
+	// Built row by row as glTranslatef and glRotatef would multiply them
+	float translate[16] = {	1.f, 0.f, 0.f, translation.x,
+							0.f, 1.f, 0.f, translation.y,
+							0.f, 0.f, 1.f, translation.z,
+							0.f, 0.f, 0.f, 1.f };
+	Matrix4f result(translate);
+
+	if(rotationZ != 0.f) {
+		float c = cos(rotationZ * degreesToRadians);
+		float s = sin(rotationZ * degreesToRadians);
+		float rotate[16] = {	c,  -s,  0.f, 0.f,
+								s,   c,  0.f, 0.f,
+								0.f, 0.f, 1.f, 0.f,
+								0.f, 0.f, 0.f, 1.f };
+		result = result * Matrix4f(rotate);
+	}
+	if(rotationX != 0.f) {
+		float c = cos(rotationX * degreesToRadians);
+		float s = sin(rotationX * degreesToRadians);
+		float rotate[16] = {	1.f, 0.f, 0.f, 0.f,
+								0.f, c,  -s,  0.f,
+								0.f, s,   c,  0.f,
+								0.f, 0.f, 0.f, 1.f };
+		result = result * Matrix4f(rotate);
+	}
+	float c = cos(rotationY * degreesToRadians);
+	float s = sin(rotationY * degreesToRadians);
+	float rotate[16] = {	c,   0.f, s,   0.f,
+							0.f, 1.f, 0.f, 0.f,
+							-s,  0.f, c,   0.f,
+							0.f, 0.f, 0.f, 1.f };
+	result = result * Matrix4f(rotate);
+
+	// OpenGL wants the columns first
+	Matrix4f transposed;
+	for(int row = 0; row < 4; ++row) {
+		for(int column = 0; column < 4; ++column) {
+			transposed[column * 4 + row] = result[row * 4 + column];
+		}
+	}
+	return transposed;
+}
+
+}}//end namespace
@@ -17,10 +17,12 @@
 #include <stdexcept>
 #include "util.h"
 #include "platform_util.h"
+#include "platform_common.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
 using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
 
 namespace Shared{ namespace Graphics{
 
@@ -34,6 +36,12 @@ ModelManager::ModelManager(){
 	}
 
 	textureManager= NULL;
+	shareModels= false;
+	lastModel= NULL;
+	loadCount= 0;
+	sharedCount= 0;
+	cachedCount= 0;
+	loadMicros= 0;
 }
 
 ModelManager::~ModelManager(){
@@ -41,8 +49,38 @@ ModelManager::~ModelManager(){
 }
 
 Model *ModelManager::newModel(const string &path,bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList, string *sourceLoader){
+	string canonicalPath;
+	if(shareModels == true) {
+		canonicalPath = getCanonicalPath(path);
+		std::map<string, Model *>::iterator iterFind = modelsByPath.find(canonicalPath);
+		if(iterFind != modelsByPath.end()) {
+			Model *model = iterFind->second;
+			modelRefCounts[model]++;
+			sharedCount++;
+			lastModel = model;
+
+			if(loadedFileList) {
+				string loader = (sourceLoader != NULL ? *sourceLoader : "");
+				(*loadedFileList)[path].push_back(make_pair(loader,loader));
+			}
+			return model;
+		}
+	}
+
+	Chrono chrono(true);
 	Model *model= GraphicsInterface::getInstance().getFactory()->newModel(path,textureManager,deletePixMapAfterLoad,loadedFileList,sourceLoader);
+	loadMicros += chrono.getMicros();
+	loadCount++;
+	if(model->getLoadedFromCache() == true) {
+		cachedCount++;
+	}
+
 	models.push_back(model);
+	if(shareModels == true) {
+		modelsByPath[canonicalPath] = model;
+		modelRefCounts[model] = 1;
+	}
+	lastModel = model;
 	return model;
 }
 
@@ -63,10 +101,37 @@ void ModelManager::end(){
 		}
 	}
 	models.clear();
+	modelsByPath.clear();
+	modelRefCounts.clear();
+	lastModel= NULL;
+
+	loadCount= 0;
+	sharedCount= 0;
+	cachedCount= 0;
+	loadMicros= 0;
 }
 
 void ModelManager::endModel(Model *model,bool mustExistInList) {
 	if(model != NULL) {
+		std::map<Model *, int>::iterator iterRef = modelRefCounts.find(model);
+		if(iterRef != modelRefCounts.end()) {
+			// Still used by another loader
+			if(--iterRef->second > 0) {
+				return;
+			}
+			modelRefCounts.erase(iterRef);
+			for(std::map<string, Model *>::iterator iterMap = modelsByPath.begin();
+				iterMap != modelsByPath.end(); ++iterMap) {
+				if(iterMap->second == model) {
+					modelsByPath.erase(iterMap);
+					break;
+				}
+			}
+		}
+		if(lastModel == model) {
+			lastModel = NULL;
+		}
+
 		bool found = false;
 		for(unsigned int idx = 0; idx < models.size(); idx++) {
 			Model *curModel = models[idx];
@@ -87,17 +152,15 @@ void ModelManager::endModel(Model *model,bool mustExistInList) {
 }
 
 void ModelManager::endLastModel(bool mustExistInList) {
-	bool found = false;
-	if(models.size() > 0) {
-		found = true;
-		size_t index = models.size()-1;
-		Model *curModel = models[index];
-		models.erase(models.begin() + index);
-
-		curModel->end();
-		delete curModel;
+	// With shared models the last one handed out need not be the last loaded
+	Model *model = lastModel;
+	if(model == NULL && models.empty() == false) {
+		model = models.back();
+	}
+	if(model != NULL) {
+		endModel(model,mustExistInList);
 	}
-	if(found == false && mustExistInList == true) {
+	else if(mustExistInList == true) {
 		throw std::runtime_error("found == false in endLastModel");
 	}
 }
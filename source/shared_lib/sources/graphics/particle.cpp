@@ -206,20 +206,7 @@ void ParticleSystem::update() {
     	particleSystemStartDelay--;
     }
     else if(state != sPause) {
-		for(int i= 0; i < aliveParticleCount; ++i) {
-			updateParticle(&particles[i]);
-
-			if(deathTest(&particles[i])) {
-
-				//kill the particle
-				killParticle(&particles[i]);
-
-				//maintain alive particles at front of the array
-				if(aliveParticleCount > 0) {
-					particles[i]= particles[aliveParticleCount];
-				}
-			}
-		}
+		updateParticles();
 
 		if(state != ParticleSystem::sFade) {
 			emissionState= emissionState + emissionRate;
@@ -626,6 +613,10 @@ bool ParticleSystem::deathTest(Particle *p) {
 	return p->energy <= 0;
 }
 
+void ParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 void ParticleSystem::killParticle(Particle *p) {
 	aliveParticleCount--;
 }
@@ -716,6 +707,10 @@ void FireParticleSystem::updateParticle(Particle *p){
 
 }
 
+void FireParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 string FireParticleSystem::toString() const {
 	string result = ParticleSystem::toString();
 
@@ -1345,6 +1340,10 @@ void UnitParticleSystem::updateParticle(Particle *p){
 	}
 }
 
+void UnitParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 // ================= SET PARAMS ====================
 
 void UnitParticleSystem::setWind(float windAngle, float windSpeed){
@@ -1592,6 +1591,10 @@ bool RainParticleSystem::deathTest(Particle *p){
 	return p->pos.y < 0;
 }
 
+void RainParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 void RainParticleSystem::setRadius(float radius) {
 	this->radius= radius;
 }
@@ -1671,6 +1674,10 @@ bool SnowParticleSystem::deathTest(Particle *p){
 	return p->pos.y < 0;
 }
 
+void SnowParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 void SnowParticleSystem::setRadius(float radius){
 	this->radius= radius;
 }
@@ -1975,6 +1982,10 @@ void ProjectileParticleSystem::updateParticle(Particle *p){
 	p->energy--;
 }
 
+void ProjectileParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 void ProjectileParticleSystem::setPath(Vec3f startPos, Vec3f endPos) {
 	startPos.x = truncateDecimal<float>(startPos.x,6);
 	startPos.y = truncateDecimal<float>(startPos.y,6);
@@ -2292,6 +2303,10 @@ void SplashParticleSystem::updateParticle(Particle *p){
 	p->size = truncateDecimal<float>(p->size,6);
 }
 
+void SplashParticleSystem::updateParticles() {
+	updateAliveParticles(this);
+}
+
 void SplashParticleSystem::saveGame(XmlNode *rootNode) {
 	std::map<string,string> mapTagReplacements;
 	XmlNode *splashParticleSystemNode = rootNode->addChild("SplashParticleSystem");
@@ -2406,8 +2421,8 @@ bool ParticleManager::hasActiveParticleSystem(ParticleSystem::ParticleSystemType
 			//currentParticleCount+= ps->getAliveParticleCount();
 
 			bool showParticle= true;
-			if(dynamic_cast<UnitParticleSystem *> (ps) != NULL ||
-			   dynamic_cast<FireParticleSystem *> (ps) != NULL) {
+			if(ps->getParticleSystemType() == ParticleSystem::pst_UnitParticleSystem ||
+			   ps->getParticleSystemType() == ParticleSystem::pst_FireParticleSystem) {
 				showParticle= ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
 			}
 			if(showParticle == true){
@@ -2439,8 +2454,9 @@ void ParticleManager::update(int renderFps){
 			currentParticleCount+= ps->getAliveParticleCount();
 
 			bool showParticle= true;
-			if( dynamic_cast<UnitParticleSystem *> (ps) != NULL ||
-				dynamic_cast<FireParticleSystem *> (ps) != NULL) {
+			ParticleSystem::ParticleSystemType particleSystemType = ps->getParticleSystemType();
+			if( particleSystemType == ParticleSystem::pst_UnitParticleSystem ||
+				particleSystemType == ParticleSystem::pst_FireParticleSystem) {
 				showParticle = ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
 			}
 			if(showParticle == true){
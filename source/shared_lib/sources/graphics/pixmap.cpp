@@ -13,6 +13,7 @@
 #include "pixmap.h"
 
 #include <stdexcept>
+#include <algorithm>
 #include <cstdio>
 #include <cassert>
 
@@ -965,6 +966,15 @@ void Pixmap2D::deletePixels() {
 	}
 }
 
+void Pixmap2D::swap(Pixmap2D &other) {
+	std::swap(h, other.h);
+	std::swap(w, other.w);
+	std::swap(components, other.components);
+	std::swap(pixels, other.pixels);
+	path.swap(other.path);
+	std::swap(crc, other.crc);
+}
+
 Pixmap2D::~Pixmap2D() {
 	deletePixels();
 }
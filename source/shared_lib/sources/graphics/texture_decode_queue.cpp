@@ -0,0 +1,266 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "texture_decode_queue.h"
+
+#include <stdexcept>
+
+#ifndef WIN32
+  #include <unistd.h>
+#endif
+
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "conversion.h"
+#include "base_thread.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Shared{ namespace Graphics{
+
+enum TextureDecodeState {
+	tdsQueued,
+	tdsDecoding,
+	tdsDone
+};
+
+// =====================================================
+//	class TextureDecodeJob
+// =====================================================
+
+class TextureDecodeJob {
+public:
+	Texture2D *texture;
+	string path;
+	Pixmap2D pixmap;
+	TextureDecodeState state;
+	bool failed;
+	string error;
+
+	TextureDecodeJob(Texture2D *texture, const string &path) :
+		texture(texture), path(path), state(tdsQueued), failed(false) {
+		pixmap.init(texture->getPixmap()->getComponents() != -1 ?
+				texture->getPixmap()->getComponents() : Texture::defaultComponents);
+	}
+};
+
+// =====================================================
+//	class TextureDecodeWorkerThread
+// =====================================================
+
+class TextureDecodeWorkerThread : public BaseThread {
+private:
+	TextureDecodeQueue *decodeQueue;
+
+public:
+	TextureDecodeWorkerThread(TextureDecodeQueue *decodeQueue) : BaseThread(), decodeQueue(decodeQueue) {
+		setUniqueID("TextureDecodeWorkerThread");
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		try {
+			decodeQueue->processQueue();
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		}
+	}
+};
+
+// =====================================================
+//	class TextureDecodeQueue
+// =====================================================
+
+TextureDecodeQueue::TextureDecodeQueue() : mutex(CODE_AT_LINE) {
+	quitDecoding	= false;
+	workerCount		= -1;
+	decodeCount		= 0;
+	decodeMicros	= 0;
+}
+
+TextureDecodeQueue::~TextureDecodeQueue() {
+	stopWorkers();
+
+	for(std::map<Texture2D *, TextureDecodeJob *>::iterator iterMap = jobs.begin();
+		iterMap != jobs.end(); ++iterMap) {
+		delete iterMap->second;
+	}
+	jobs.clear();
+	queue.clear();
+}
+
+TextureDecodeQueue &TextureDecodeQueue::getInstance() {
+	static TextureDecodeQueue decodeQueue;
+	return decodeQueue;
+}
+
+void TextureDecodeQueue::queueTexture(Texture2D *texture, const string &path) {
+	TextureDecodeJob *job = new TextureDecodeJob(texture, path);
+
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	if(jobs.find(texture) != jobs.end()) {
+		delete job;
+		throw megaglest_runtime_error("Texture is already queued for decoding: " + path);
+	}
+	jobs[texture] = job;
+	queue.push_back(job);
+
+	if(workers.empty() == true) {
+		int threadCount = workerCount;
+		if(threadCount < 0) {
+#ifdef WIN32
+			SYSTEM_INFO sysinfo;
+			GetSystemInfo(&sysinfo);
+			threadCount = (int)sysinfo.dwNumberOfProcessors - 1;
+#else
+			threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+#endif
+			threadCount = max(threadCount, 1);
+		}
+
+		quitDecoding = false;
+		for(int index = 0; index < threadCount; ++index) {
+			TextureDecodeWorkerThread *worker = new TextureDecodeWorkerThread(this);
+			worker->start();
+			workers.push_back(worker);
+		}
+		// Jobs left over from before the workers were stopped
+		for(unsigned int index = 1; index < queue.size() && workers.empty() == false; ++index) {
+			jobQueued.signal();
+		}
+	}
+	if(workers.empty() == false) {
+		jobQueued.signal();
+	}
+}
+
+void TextureDecodeQueue::decode(TextureDecodeJob *job) {
+	Chrono chrono(true);
+	try {
+		job->pixmap.load(job->path);
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error decoding [%s] [%s]\n",__FILE__,__FUNCTION__,__LINE__,job->path.c_str(),ex.what());
+		job->failed = true;
+		job->error = ex.what();
+	}
+
+	MutexSafeWrapper safeMutex(&mutex);
+	job->state = tdsDone;
+	decodeCount++;
+	decodeMicros += chrono.getMicros();
+}
+
+void TextureDecodeQueue::finish(Texture2D *texture, bool throwOnError) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	std::map<Texture2D *, TextureDecodeJob *>::iterator iterFind = jobs.find(texture);
+	if(iterFind == jobs.end()) {
+		return;
+	}
+	TextureDecodeJob *job = iterFind->second;
+
+	if(job->state == tdsQueued) {
+		// No worker has it yet, decoding here beats waiting in line
+		for(std::deque<TextureDecodeJob *>::iterator iterQueue = queue.begin();
+			iterQueue != queue.end(); ++iterQueue) {
+			if(*iterQueue == job) {
+				queue.erase(iterQueue);
+				break;
+			}
+		}
+		job->state = tdsDecoding;
+		safeMutex.ReleaseLock(true);
+		decode(job);
+		safeMutex.Lock();
+	}
+	for(;job->state != tdsDone;) {
+		safeMutex.ReleaseLock(true);
+		sleep(1);
+		safeMutex.Lock();
+	}
+	jobs.erase(texture);
+	safeMutex.ReleaseLock();
+
+	bool failed = job->failed;
+	string error = job->error;
+	if(failed == false) {
+		texture->getPixmap()->swap(job->pixmap);
+	}
+	delete job;
+
+	if(failed == true && throwOnError == true) {
+		throw megaglest_runtime_error(error);
+	}
+}
+
+bool TextureDecodeQueue::isQueued(Texture2D *texture) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	return (jobs.find(texture) != jobs.end());
+}
+
+void TextureDecodeQueue::processQueue() {
+	for(;;) {
+		jobQueued.waitTillSignalled();
+
+		MutexSafeWrapper safeMutex(&mutex);
+		if(quitDecoding == true) {
+			break;
+		}
+		if(queue.empty() == true) {
+			// finish() took the job over
+			continue;
+		}
+		TextureDecodeJob *job = queue.front();
+		queue.pop_front();
+		job->state = tdsDecoding;
+		safeMutex.ReleaseLock();
+
+		decode(job);
+	}
+}
+
+void TextureDecodeQueue::stopWorkers() {
+	// No function static owner id on the worker and shutdown paths, they
+	// also run from the destructor at exit after those statics are gone
+	MutexSafeWrapper safeMutex(&mutex);
+	std::vector<TextureDecodeWorkerThread *> stopping = workers;
+	workers.clear();
+	quitDecoding = true;
+	safeMutex.ReleaseLock();
+
+	// Queued jobs stay queued, finish() decodes them when needed
+	for(unsigned int index = 0; index < stopping.size(); ++index) {
+		stopping[index]->signalQuit();
+		jobQueued.signal();
+	}
+	for(unsigned int index = 0; index < stopping.size(); ++index) {
+		if(stopping[index]->shutdownAndJoin() == true) {
+			delete stopping[index];
+		}
+	}
+}
+
+void TextureDecodeQueue::setWorkerCount(int value) {
+	stopWorkers();
+
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	workerCount = value;
+}
+
+}}//end namespace
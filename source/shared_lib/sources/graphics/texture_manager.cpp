@@ -16,13 +16,16 @@
 
 #include "graphics_interface.h"
 #include "graphics_factory.h"
+#include "texture_decode_queue.h"
 
 #include "util.h"
 #include "platform_util.h"
+#include "platform_common.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
 using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
 
 namespace Shared{ namespace Graphics{
 
@@ -38,6 +41,8 @@ TextureManager::TextureManager() {
 
 	textureFilter= Texture::fBilinear;
 	maxAnisotropy= 1;
+	deferredInit= false;
+	shareTextures= false;
 }
 
 TextureManager::~TextureManager(){
@@ -50,8 +55,39 @@ void TextureManager::initTexture(Texture *texture) {
 	}
 }
 
+void TextureManager::forgetTexture(Texture *texture) {
+	Texture2D *texture2D = dynamic_cast<Texture2D *>(texture);
+	if(texture2D == NULL) {
+		return;
+	}
+
+	for(unsigned int idx = 0; idx < pendingTextures.size(); idx++) {
+		if(pendingTextures[idx].first == texture2D) {
+			pendingTextures.erase(pendingTextures.begin() + idx);
+			// The decode may still be running
+			TextureDecodeQueue::getInstance().finish(texture2D,false);
+			break;
+		}
+	}
+	for(map<pair<string, int>, Texture2D *>::iterator iterMap = texturesByPath.begin();
+		iterMap != texturesByPath.end(); ++iterMap) {
+		if(iterMap->second == texture2D) {
+			texturesByPath.erase(iterMap);
+			break;
+		}
+	}
+	textureRefCounts.erase(texture2D);
+}
+
 void TextureManager::endTexture(Texture *texture,bool mustExistInList) {
 	if(texture != NULL) {
+		// Shared textures stay until the last model using them lets go
+		map<Texture *, int>::iterator iterRef = textureRefCounts.find(texture);
+		if(iterRef != textureRefCounts.end() && iterRef->second > 1) {
+			iterRef->second--;
+			return;
+		}
+
 		bool found = false;
 		for(unsigned int idx = 0; idx < textures.size(); idx++) {
 			Texture *curTexture = textures[idx];
@@ -64,6 +100,7 @@ void TextureManager::endTexture(Texture *texture,bool mustExistInList) {
 		if(found == false && mustExistInList == true) {
 			throw std::runtime_error("found == false in endTexture");
 		}
+		forgetTexture(texture);
 		texture->end();
 		delete texture;
 	}
@@ -77,6 +114,7 @@ void TextureManager::endLastTexture(bool mustExistInList) {
 		Texture *curTexture = textures[index];
 		textures.erase(textures.begin() + index);
 
+		forgetTexture(curTexture);
 		curTexture->end();
 		delete curTexture;
 	}
@@ -86,6 +124,8 @@ void TextureManager::endLastTexture(bool mustExistInList) {
 }
 
 void TextureManager::init(bool forceInit) {
+	initPendingTextures();
+
 	for(unsigned int i=0; i<textures.size(); ++i){
 		Texture *texture = textures[i];
 		if(texture == NULL) {
@@ -102,6 +142,14 @@ void TextureManager::init(bool forceInit) {
 }
 
 void TextureManager::end(){
+	for(unsigned int i=0; i<pendingTextures.size(); ++i){
+		TextureDecodeQueue::getInstance().finish(pendingTextures[i].first,false);
+	}
+	pendingTextures.clear();
+	texturesByPath.clear();
+	textureRefCounts.clear();
+	deferredInit= false;
+
 	for(unsigned int i=0; i<textures.size(); ++i){
 		if(textures[i] != NULL) {
 			textures[i]->end();
@@ -128,6 +176,53 @@ Texture *TextureManager::getTexture(const string &path){
 	return NULL;
 }
 
+Texture2D *TextureManager::queueTexture2D(const string &path, int components, bool deletePixelsAfterInit, bool &owned) {
+	owned = false;
+
+	pair<string, int> pathKey;
+	if(shareTextures == true) {
+		pathKey = make_pair(getCanonicalPath(path), components);
+
+		map<pair<string, int>, Texture2D *>::iterator iterFind = texturesByPath.find(pathKey);
+		if(iterFind != texturesByPath.end()) {
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] [%s] shares the texture of [%s]\n",__FILE__,__FUNCTION__,__LINE__,path.c_str(),iterFind->second->getPath().c_str());
+			textureRefCounts[iterFind->second]++;
+			owned = true;
+			return iterFind->second;
+		}
+	}
+
+	Texture2D *texture = newTexture2D();
+	if(components != -1) {
+		texture->getPixmap()->init(components);
+	}
+	// Set up front so getTexture() finds it while it is decoding
+	texture->setPath(path);
+	TextureDecodeQueue::getInstance().queueTexture(texture, path);
+
+	pendingTextures.push_back(make_pair(texture, deletePixelsAfterInit));
+	if(shareTextures == true) {
+		texturesByPath[pathKey] = texture;
+		textureRefCounts[texture] = 1;
+	}
+	owned = true;
+	return texture;
+}
+
+void TextureManager::initPendingTextures() {
+	TextureDecodeQueue &decodeQueue = TextureDecodeQueue::getInstance();
+	for(;pendingTextures.empty() == false;) {
+		pair<Texture2D *, bool> pending = pendingTextures.front();
+		pendingTextures.erase(pendingTextures.begin());
+
+		decodeQueue.finish(pending.first);
+		pending.first->init(textureFilter, maxAnisotropy);
+		if(pending.second == true) {
+			pending.first->deletePixels();
+		}
+	}
+}
+
 Texture1D *TextureManager::newTexture1D(){
 	Texture1D *texture1D= GraphicsInterface::getInstance().getFactory()->newTexture1D();
 	textures.push_back(texture1D);
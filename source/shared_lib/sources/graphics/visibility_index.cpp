@@ -0,0 +1,314 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "visibility_index.h"
+
+#include <algorithm>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	class FrustumCulling
+// =====================================================
+
+bool FrustumCulling::cubeInFrustum(const vector<vector<float> > &frustum, float x, float y, float z, float size) {
+	for(unsigned int p = 0; p < frustum.size(); p++ ) {
+		const vector<float> &plane = frustum[p];
+		if( plane[0] * (x - size) + plane[1] * (y - size) + plane[2] * (z - size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x + size) + plane[1] * (y - size) + plane[2] * (z - size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x - size) + plane[1] * (y + size) + plane[2] * (z - size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x + size) + plane[1] * (y + size) + plane[2] * (z - size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x - size) + plane[1] * (y - size) + plane[2] * (z + size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x + size) + plane[1] * (y - size) + plane[2] * (z + size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x - size) + plane[1] * (y + size) + plane[2] * (z + size) + plane[3] > 0 )
+			continue;
+		if( plane[0] * (x + size) + plane[1] * (y + size) + plane[2] * (z + size) + plane[3] > 0 )
+			continue;
+		return false;
+	}
+	return true;
+}
+
+FrustumCulling::BoxClassification FrustumCulling::classifyBox(const vector<vector<float> > &frustum,
+		const Vec3f &minCorner, const Vec3f &maxCorner) {
+	BoxClassification result = bcInside;
+	for(unsigned int p = 0; p < frustum.size(); p++ ) {
+		const vector<float> &plane = frustum[p];
+
+		// The corners furthest along and against the plane normal
+		Vec3f positive(	plane[0] > 0 ? maxCorner.x : minCorner.x,
+						plane[1] > 0 ? maxCorner.y : minCorner.y,
+						plane[2] > 0 ? maxCorner.z : minCorner.z);
+		Vec3f negative(	plane[0] > 0 ? minCorner.x : maxCorner.x,
+						plane[1] > 0 ? minCorner.y : maxCorner.y,
+						plane[2] > 0 ? minCorner.z : maxCorner.z);
+
+		// Same comparison as cubeInFrustum, a box with no corner in front of
+		// one plane is outside
+		if(plane[0] * positive.x + plane[1] * positive.y + plane[2] * positive.z + plane[3] <= 0) {
+			return bcOutside;
+		}
+		if(plane[0] * negative.x + plane[1] * negative.y + plane[2] * negative.z + plane[3] <= 0) {
+			result = bcIntersecting;
+		}
+	}
+	return result;
+}
+
+// =====================================================
+//	class VisibilityQuadTree
+// =====================================================
+
+void VisibilityQuadTree::clear() {
+	items.clear();
+	itemOrder.clear();
+	nodes.clear();
+	built = false;
+}
+
+void VisibilityQuadTree::build(const vector<VisibilityItem> &items) {
+	clear();
+	this->items = items;
+	this->built = true;
+	if(items.empty() == true) {
+		return;
+	}
+
+	Rect2i cellRect(items[0].cell, items[0].cell + Vec2i(1));
+	itemOrder.resize(items.size());
+	for(unsigned int i = 0; i < items.size(); ++i) {
+		itemOrder[i] = i;
+
+		const Vec2i &cell = items[i].cell;
+		cellRect.p[0].x = min(cellRect.p[0].x, cell.x);
+		cellRect.p[0].y = min(cellRect.p[0].y, cell.y);
+		cellRect.p[1].x = max(cellRect.p[1].x, cell.x + 1);
+		cellRect.p[1].y = max(cellRect.p[1].y, cell.y + 1);
+	}
+	nodes.reserve(items.size() / maxLeafItems * 2 + 1);
+	buildNode(cellRect, 0, (int)items.size());
+}
+
+int VisibilityQuadTree::buildNode(const Rect2i &cellRect, int firstItem, int itemCount) {
+	int nodeIndex = (int)nodes.size();
+	nodes.push_back(Node());
+	nodes[nodeIndex].cellRect	= cellRect;
+	nodes[nodeIndex].firstItem	= firstItem;
+	nodes[nodeIndex].itemCount	= itemCount;
+	for(int i = 0; i < 4; ++i) {
+		nodes[nodeIndex].children[i] = -1;
+	}
+
+	// Bounds of every item cube below this node
+	Vec3f minCorner = items[itemOrder[firstItem]].center;
+	Vec3f maxCorner = minCorner;
+	for(int i = firstItem; i < firstItem + itemCount; ++i) {
+		const VisibilityItem &item = items[itemOrder[i]];
+		minCorner.x = min(minCorner.x, item.center.x - item.size);
+		minCorner.y = min(minCorner.y, item.center.y - item.size);
+		minCorner.z = min(minCorner.z, item.center.z - item.size);
+		maxCorner.x = max(maxCorner.x, item.center.x + item.size);
+		maxCorner.y = max(maxCorner.y, item.center.y + item.size);
+		maxCorner.z = max(maxCorner.z, item.center.z + item.size);
+	}
+	nodes[nodeIndex].minCorner = minCorner;
+	nodes[nodeIndex].maxCorner = maxCorner;
+
+	int cellWidth = cellRect.p[1].x - cellRect.p[0].x;
+	int cellHeight = cellRect.p[1].y - cellRect.p[0].y;
+	if(itemCount <= maxLeafItems || (cellWidth <= 1 && cellHeight <= 1)) {
+		return nodeIndex;
+	}
+
+	// Split into quadrants and group the items of each one together
+	Vec2i middle(cellRect.p[0].x + max(cellWidth / 2, 1), cellRect.p[0].y + max(cellHeight / 2, 1));
+	Rect2i quadrants[4] = {
+		Rect2i(cellRect.p[0].x, cellRect.p[0].y, middle.x, middle.y),
+		Rect2i(middle.x, cellRect.p[0].y, cellRect.p[1].x, middle.y),
+		Rect2i(cellRect.p[0].x, middle.y, middle.x, cellRect.p[1].y),
+		Rect2i(middle.x, middle.y, cellRect.p[1].x, cellRect.p[1].y)
+	};
+
+	int childFirstItem = firstItem;
+	for(int quadrant = 0; quadrant < 4; ++quadrant) {
+		int childItemCount = 0;
+		for(int i = childFirstItem; i < firstItem + itemCount; ++i) {
+			if(quadrants[quadrant].isInside(items[itemOrder[i]].cell)) {
+				swap(itemOrder[i], itemOrder[childFirstItem + childItemCount]);
+				childItemCount++;
+			}
+		}
+		if(childItemCount > 0) {
+			int childIndex = buildNode(quadrants[quadrant], childFirstItem, childItemCount);
+			nodes[nodeIndex].children[quadrant] = childIndex;
+		}
+		childFirstItem += childItemCount;
+	}
+	return nodeIndex;
+}
+
+void VisibilityQuadTree::query(const vector<vector<float> > *frustum, const Rect2i &cellBounds, vector<int> &result) const {
+	if(nodes.empty() == false) {
+		queryNode(0, frustum, cellBounds, result);
+	}
+}
+
+void VisibilityQuadTree::queryNode(int nodeIndex, const vector<vector<float> > *frustum,
+		const Rect2i &cellBounds, vector<int> &result) const {
+	const Node &node = nodes[nodeIndex];
+	if(node.cellRect.p[1].x <= cellBounds.p[0].x || node.cellRect.p[0].x >= cellBounds.p[1].x ||
+		node.cellRect.p[1].y <= cellBounds.p[0].y || node.cellRect.p[0].y >= cellBounds.p[1].y) {
+		return;
+	}
+
+	if(frustum != NULL) {
+		FrustumCulling::BoxClassification classification =
+				FrustumCulling::classifyBox(*frustum, node.minCorner, node.maxCorner);
+		if(classification == FrustumCulling::bcOutside) {
+			return;
+		}
+		// Everything below passes the frustum test, only the cells are left to check
+		if(classification == FrustumCulling::bcInside) {
+			frustum = NULL;
+		}
+	}
+
+	bool isLeaf = true;
+	for(int i = 0; i < 4; ++i) {
+		if(node.children[i] >= 0) {
+			isLeaf = false;
+			queryNode(node.children[i], frustum, cellBounds, result);
+		}
+	}
+
+	if(isLeaf == true) {
+		for(int i = node.firstItem; i < node.firstItem + node.itemCount; ++i) {
+			const VisibilityItem &item = items[itemOrder[i]];
+			if(cellBounds.isInside(item.cell) == true &&
+				(frustum == NULL ||
+				 FrustumCulling::cubeInFrustum(*frustum, item.center.x, item.center.y, item.center.z, item.size) == true)) {
+				result.push_back(itemOrder[i]);
+			}
+		}
+	}
+}
+
+// =====================================================
+//	class VisibilityLooseGrid
+// =====================================================
+
+VisibilityLooseGrid::VisibilityLooseGrid() {
+	cellSize	= 1;
+	width		= 0;
+	height		= 0;
+	minHeight	= 0;
+	maxHeight	= 0;
+	maxReach	= 0;
+}
+
+void VisibilityLooseGrid::init(int worldWidth, int worldHeight, int cellSize, float minHeight, float maxHeight) {
+	clear();
+	this->cellSize	= max(cellSize, 1);
+	this->width		= max(worldWidth / this->cellSize + 1, 1);
+	this->height	= max(worldHeight / this->cellSize + 1, 1);
+	this->minHeight	= minHeight;
+	this->maxHeight	= maxHeight;
+
+	cells.resize(width * height);
+	for(unsigned int i = 0; i < cells.size(); ++i) {
+		cells[i].itemCount = 0;
+		cells[i].classification = FrustumCulling::bcIntersecting;
+	}
+}
+
+void VisibilityLooseGrid::clear() {
+	cells.clear();
+	items.clear();
+	freeItems.clear();
+	width		= 0;
+	height		= 0;
+	maxReach	= 0;
+}
+
+int VisibilityLooseGrid::getGridCell(const Vec2i &cell) const {
+	int x = min(max(cell.x / cellSize, 0), width - 1);
+	int y = min(max(cell.y / cellSize, 0), height - 1);
+	return y * width + x;
+}
+
+int VisibilityLooseGrid::addItem(const Vec2i &cell, float reach) {
+	int itemIndex = 0;
+	if(freeItems.empty() == false) {
+		itemIndex = freeItems.back();
+		freeItems.pop_back();
+	}
+	else {
+		itemIndex = (int)items.size();
+		items.push_back(Item());
+	}
+
+	Item &item = items[itemIndex];
+	item.cell = cell;
+	item.gridCell = getGridCell(cell);
+	cells[item.gridCell].itemCount++;
+	maxReach = max(maxReach, reach);
+	return itemIndex;
+}
+
+void VisibilityLooseGrid::updateItem(int itemIndex, const Vec2i &cell, float reach) {
+	Item &item = items[itemIndex];
+	maxReach = max(maxReach, reach);
+	if(item.cell == cell) {
+		return;
+	}
+	item.cell = cell;
+
+	int gridCell = getGridCell(cell);
+	if(gridCell != item.gridCell) {
+		cells[item.gridCell].itemCount--;
+		cells[gridCell].itemCount++;
+		item.gridCell = gridCell;
+	}
+}
+
+void VisibilityLooseGrid::removeItem(int itemIndex) {
+	if(itemIndex < 0 || itemIndex >= (int)items.size() || items[itemIndex].gridCell < 0) {
+		return;
+	}
+	Item &item = items[itemIndex];
+	cells[item.gridCell].itemCount--;
+	item.gridCell = -1;
+	freeItems.push_back(itemIndex);
+}
+
+void VisibilityLooseGrid::classify(const vector<vector<float> > &frustum) {
+	for(int y = 0; y < height; ++y) {
+		for(int x = 0; x < width; ++x) {
+			Cell &cell = cells[y * width + x];
+			if(cell.itemCount > 0) {
+				Vec3f minCorner(x * cellSize - maxReach, minHeight - maxReach, y * cellSize - maxReach);
+				Vec3f maxCorner((x + 1) * cellSize + maxReach, maxHeight + maxReach, (y + 1) * cellSize + maxReach);
+				cell.classification = FrustumCulling::classifyBox(frustum, minCorner, maxCorner);
+			}
+		}
+	}
+}
+
+}}//end namespace
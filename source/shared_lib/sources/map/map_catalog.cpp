@@ -0,0 +1,471 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "map_catalog.h"
+
+#include <set>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "map_preview.h"
+#include "checksum.h"
+#include "byte_order.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Shared { namespace Map {
+
+static const char *MAP_CATALOGUE_HEADER = "MG_MAP_CATALOGUE_V1";
+
+// =====================================================
+//	class MapCatalogEntry
+// =====================================================
+
+MapCatalogEntry::MapCatalogEntry() {
+	size			= 0;
+	modifiedTime	= 0;
+	crc				= 0;
+	valid			= false;
+	players			= 0;
+	width			= 0;
+	height			= 0;
+	heightFactor	= 0;
+	waterLevel		= 0;
+	cliffLevel		= 0;
+	previewW		= 0;
+	previewH		= 0;
+}
+
+// =====================================================
+//	class MapCatalog
+// =====================================================
+
+Mutex MapCatalog::catalogSynchAccessor(CODE_AT_LINE);
+std::map<string,MapCatalogEntry> MapCatalog::catalog;
+string MapCatalog::catalogPath = "";
+bool MapCatalog::catalogLoaded = false;
+bool MapCatalog::catalogDirty = false;
+
+void MapCatalog::setCatalogPath(const string &path) {
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	catalogPath = path;
+	catalog.clear();
+	catalogLoaded = false;
+	catalogDirty = false;
+}
+
+string MapCatalog::getCatalogPath() {
+	if(catalogPath != "") {
+		return catalogPath;
+	}
+	string crcCachePath = getCRCCacheFilePath();
+	if(crcCachePath == "") {
+		return "";
+	}
+	return crcCachePath + "MAP_CATALOGUE";
+}
+
+bool MapCatalog::getFileKey(const string &path, MapCatalogEntry &entry) {
+#ifdef WIN32
+  #if defined(__MINGW32__)
+	struct _stat fileStat;
+  #else
+	struct _stat64i32 fileStat;
+  #endif
+	if(_wstat(utf8_decode(path).c_str(), &fileStat) != 0) {
+		return false;
+	}
+#else
+	struct stat fileStat;
+	if(stat(path.c_str(), &fileStat) != 0) {
+		return false;
+	}
+#endif
+	entry.size = (int64)fileStat.st_size;
+	entry.modifiedTime = (int64)fileStat.st_mtime;
+	return true;
+}
+
+bool MapCatalog::buildEntry(const string &path, MapCatalogEntry &entry) {
+	if(getFileKey(path, entry) == false) {
+		return false;
+	}
+
+	MapInfo mapInfo;
+	entry.valid = MapPreview::loadMapInfoFromFile(path, &mapInfo, "", "", false);
+	if(entry.valid == false) {
+		return true;
+	}
+
+	MapPreview map;
+	map.loadFromFile(path);
+
+	Checksum checksum;
+	checksum.addFile(path);
+	entry.crc			= checksum.getSum();
+	entry.players		= mapInfo.players;
+	entry.width			= mapInfo.size.x;
+	entry.height		= mapInfo.size.y;
+	entry.heightFactor	= map.getHeightFactor();
+	entry.waterLevel	= map.getWaterLevel();
+	entry.cliffLevel	= map.getCliffLevel();
+	entry.title			= map.getTitle();
+
+	// Map sizes are powers of two, so every preview cell covers a
+	// whole block of map cells. The preview must still be a valid map.
+	int scale = 1;
+	for(;max(map.getW(), map.getH()) / scale > MapCatalogEntry::previewMaxSize &&
+		min(map.getW(), map.getH()) / (scale * 2) >= MIN_MAP_CELL_DIMENSION;) {
+		scale *= 2;
+	}
+	entry.previewW = map.getW() / scale;
+	entry.previewH = map.getH() / scale;
+	entry.previewCells.assign(entry.previewW * entry.previewH * 3, 0);
+
+	for(int y = 0; y < entry.previewH; ++y) {
+		for(int x = 0; x < entry.previewW; ++x) {
+			float height = 0.f;
+			int cellCount = 0;
+			int object = 0;
+			int resource = 0;
+			for(int j = y * scale; j < min((y + 1) * scale, map.getH()); ++j) {
+				for(int i = x * scale; i < min((x + 1) * scale, map.getW()); ++i) {
+					height += map.getHeight(i, j);
+					cellCount++;
+					if(object == 0 && resource == 0) {
+						object = map.getObject(i, j);
+						resource = map.getResource(i, j);
+					}
+				}
+			}
+			int centerX = min(x * scale + scale / 2, map.getW() - 1);
+			int centerY = min(y * scale + scale / 2, map.getH() - 1);
+
+			uint8 *cell = &entry.previewCells[(y * entry.previewW + x) * 3];
+			cell[0] = (uint8)clamp((int)(height / max(cellCount, 1) * 10.f + 0.5f), 0, 255);
+			cell[1] = (uint8)map.getSurface(centerX, centerY);
+			cell[2] = (uint8)((object & 0x0F) | ((resource & 0x0F) << 4));
+		}
+	}
+
+	entry.previewStartLocations.clear();
+	for(int index = 0; index < map.getMaxFactions(); ++index) {
+		entry.previewStartLocations.push_back(map.getStartLocationX(index) / scale);
+		entry.previewStartLocations.push_back(map.getStartLocationY(index) / scale);
+	}
+	return true;
+}
+
+bool MapCatalog::findEntry(const string &path, MapCatalogEntry &entry) {
+	MapCatalogEntry key;
+	if(getFileKey(path, key) == false) {
+		return false;
+	}
+
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	loadCatalog();
+	std::map<string,MapCatalogEntry>::const_iterator iterFind = catalog.find(path);
+	if(iterFind == catalog.end() || iterFind->second.isSameFile(key) == false) {
+		return false;
+	}
+	entry = iterFind->second;
+	return true;
+}
+
+bool MapCatalog::refreshEntry(const string &path) {
+	MapCatalogEntry key;
+	if(getFileKey(path, key) == false) {
+		return false;
+	}
+
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	loadCatalog();
+	std::map<string,MapCatalogEntry>::const_iterator iterFind = catalog.find(path);
+	if(iterFind != catalog.end() && iterFind->second.isSameFile(key) == true) {
+		return true;
+	}
+	safeMutex.ReleaseLock();
+
+	// Built outside the lock so lookups are never kept waiting on a read
+	MapCatalogEntry entry;
+	try {
+		if(buildEntry(path, entry) == false) {
+			return false;
+		}
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s] indexing map [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what(),path.c_str());
+		entry = MapCatalogEntry();
+		getFileKey(path, entry);
+	}
+
+	MutexSafeWrapper safeMutexUpdate(&catalogSynchAccessor,CODE_AT_LINE);
+	catalog[path] = entry;
+	catalogDirty = true;
+	return true;
+}
+
+void MapCatalog::pruneEntries(const vector<string> &paths) {
+	std::set<string> keep(paths.begin(), paths.end());
+
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	loadCatalog();
+	for(std::map<string,MapCatalogEntry>::iterator iterMap = catalog.begin();
+		iterMap != catalog.end();) {
+		if(keep.find(iterMap->first) == keep.end()) {
+			catalog.erase(iterMap++);
+			catalogDirty = true;
+		}
+		else {
+			++iterMap;
+		}
+	}
+}
+
+int MapCatalog::getEntryCount() {
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	loadCatalog();
+	return (int)catalog.size();
+}
+
+void MapCatalog::save() {
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	saveCatalog();
+}
+
+void MapCatalog::clear() {
+	MutexSafeWrapper safeMutex(&catalogSynchAccessor,CODE_AT_LINE);
+	catalog.clear();
+	catalogLoaded = true;
+	catalogDirty = true;
+}
+
+template<typename T>
+static bool readCatalogValue(FILE *fp, T &value) {
+	if(fread(&value, sizeof(T), 1, fp) != 1) {
+		return false;
+	}
+	value = Shared::PlatformByteOrder::fromCommonEndian(value);
+	return true;
+}
+
+template<typename T>
+static void writeCatalogValue(FILE *fp, T value) {
+	value = Shared::PlatformByteOrder::toCommonEndian(value);
+	fwrite(&value, sizeof(T), 1, fp);
+}
+
+static bool readCatalogString(FILE *fp, string &value) {
+	uint16 length = 0;
+	if(readCatalogValue(fp, length) == false) {
+		return false;
+	}
+	value.resize(length);
+	return (length == 0 || fread(&value[0], 1, length, fp) == length);
+}
+
+static void writeCatalogString(FILE *fp, const string &value) {
+	uint16 length = (uint16)min((int)value.size(), 0xFFFF);
+	writeCatalogValue(fp, length);
+	fwrite(value.c_str(), 1, length, fp);
+}
+
+// must be called with catalogSynchAccessor locked
+void MapCatalog::loadCatalog() {
+	if(catalogLoaded == true) {
+		return;
+	}
+	catalogLoaded = true;
+
+	string catalogFile = getCatalogPath();
+	if(catalogFile == "" || fileExists(catalogFile) == false) {
+		return;
+	}
+
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(catalogFile).c_str(), L"rb");
+#else
+	FILE *fp = fopen(catalogFile.c_str(),"rb");
+#endif
+	if(fp == NULL) {
+		return;
+	}
+
+	// The catalogue is only valid for the game version that wrote it
+	string header;
+	string expectedHeader = string(MAP_CATALOGUE_HEADER) + " " + getGameVersion() + " " + getGameGITVersion();
+	if(readCatalogString(fp, header) == true && header == expectedHeader) {
+		for(;;) {
+			string path;
+			MapCatalogEntry entry;
+			int8 valid = 0;
+			uint16 previewW = 0;
+			uint16 previewH = 0;
+			uint8 startLocationCount = 0;
+			if(readCatalogString(fp, path) == false ||
+				readCatalogValue(fp, entry.size) == false ||
+				readCatalogValue(fp, entry.modifiedTime) == false ||
+				readCatalogValue(fp, entry.crc) == false ||
+				readCatalogValue(fp, valid) == false ||
+				readCatalogValue(fp, entry.players) == false ||
+				readCatalogValue(fp, entry.width) == false ||
+				readCatalogValue(fp, entry.height) == false ||
+				readCatalogValue(fp, entry.heightFactor) == false ||
+				readCatalogValue(fp, entry.waterLevel) == false ||
+				readCatalogValue(fp, entry.cliffLevel) == false ||
+				readCatalogString(fp, entry.title) == false ||
+				readCatalogValue(fp, previewW) == false ||
+				readCatalogValue(fp, previewH) == false) {
+				break;
+			}
+			entry.valid = (valid != 0);
+			entry.previewW = previewW;
+			entry.previewH = previewH;
+			entry.previewCells.resize(previewW * previewH * 3);
+			if(entry.previewCells.empty() == false &&
+				fread(&entry.previewCells[0], 1, entry.previewCells.size(), fp) != entry.previewCells.size()) {
+				break;
+			}
+			if(readCatalogValue(fp, startLocationCount) == false) {
+				break;
+			}
+			bool startLocationsRead = true;
+			for(int index = 0; index < startLocationCount * 2; ++index) {
+				int16 value = 0;
+				startLocationsRead = readCatalogValue(fp, value);
+				if(startLocationsRead == false) {
+					break;
+				}
+				entry.previewStartLocations.push_back(value);
+			}
+			if(startLocationsRead == false) {
+				break;
+			}
+			catalog[path] = entry;
+		}
+	}
+	fclose(fp);
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Loaded map catalogue [%s] entries: %d\n",catalogFile.c_str(),(int)catalog.size());
+}
+
+// must be called with catalogSynchAccessor locked
+void MapCatalog::saveCatalog() {
+	if(catalogDirty == false) {
+		return;
+	}
+	string catalogFile = getCatalogPath();
+	if(catalogFile == "") {
+		return;
+	}
+
+	string tempCatalogFile = catalogFile + ".tmp";
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(tempCatalogFile).c_str(), L"wb");
+#else
+	FILE *fp = fopen(tempCatalogFile.c_str(),"wb");
+#endif
+	if(fp == NULL) {
+		return;
+	}
+
+	writeCatalogString(fp, string(MAP_CATALOGUE_HEADER) + " " + getGameVersion() + " " + getGameGITVersion());
+	for(std::map<string,MapCatalogEntry>::const_iterator iterMap = catalog.begin();
+		iterMap != catalog.end(); ++iterMap) {
+		const MapCatalogEntry &entry = iterMap->second;
+		writeCatalogString(fp, iterMap->first);
+		writeCatalogValue(fp, entry.size);
+		writeCatalogValue(fp, entry.modifiedTime);
+		writeCatalogValue(fp, entry.crc);
+		writeCatalogValue(fp, (int8)entry.valid);
+		writeCatalogValue(fp, entry.players);
+		writeCatalogValue(fp, entry.width);
+		writeCatalogValue(fp, entry.height);
+		writeCatalogValue(fp, entry.heightFactor);
+		writeCatalogValue(fp, entry.waterLevel);
+		writeCatalogValue(fp, entry.cliffLevel);
+		writeCatalogString(fp, entry.title);
+		writeCatalogValue(fp, (uint16)entry.previewW);
+		writeCatalogValue(fp, (uint16)entry.previewH);
+		if(entry.previewCells.empty() == false) {
+			fwrite(&entry.previewCells[0], 1, entry.previewCells.size(), fp);
+		}
+		writeCatalogValue(fp, (uint8)(entry.previewStartLocations.size() / 2));
+		for(unsigned int index = 0; index < entry.previewStartLocations.size(); ++index) {
+			writeCatalogValue(fp, (int16)entry.previewStartLocations[index]);
+		}
+	}
+	fclose(fp);
+
+	removeFile(catalogFile);
+	if(renameFile(tempCatalogFile, catalogFile) == true) {
+		catalogDirty = false;
+	}
+}
+
+// =====================================================
+//	class MapCatalogThread
+// =====================================================
+
+MapCatalogThread::MapCatalogThread(const vector<string> &mapPaths) : BaseThread() {
+	this->mapPaths = mapPaths;
+	uniqueID = "MapCatalogThread";
+}
+
+void MapCatalogThread::execute() {
+	{
+		RunningStatusSafeWrapper runningStatus(this);
+		if(getQuitStatus() == true) {
+			return;
+		}
+
+		try {
+			Chrono chrono(true);
+			vector<string> files;
+			for(unsigned int index = 0; index < mapPaths.size(); ++index) {
+				string path = mapPaths[index];
+				endPathWithSlash(path);
+
+				vector<string> results;
+				findAll(path + "*.gbm", results, false, false);
+				for(unsigned int fileIndex = 0; fileIndex < results.size(); ++fileIndex) {
+					files.push_back(path + results[fileIndex]);
+				}
+				results.clear();
+				findAll(path + "*.mgm", results, false, false);
+				for(unsigned int fileIndex = 0; fileIndex < results.size(); ++fileIndex) {
+					files.push_back(path + results[fileIndex]);
+				}
+			}
+
+			for(unsigned int index = 0; index < files.size() && getQuitStatus() == false; ++index) {
+				MapCatalog::refreshEntry(files[index]);
+			}
+			if(getQuitStatus() == false) {
+				MapCatalog::pruneEntries(files);
+			}
+			MapCatalog::save();
+
+			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Map catalogue refreshed %d files in %lld msecs\n",(int)files.size(),(long long int)chrono.getMillis());
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		}
+	}
+	deleteSelfIfRequired();
+}
+
+}}// end namespace
@@ -17,12 +17,16 @@
 #include <stdexcept>
 #include <set>
 #include <iterator>
+#include <algorithm>
 #include "platform_util.h"
 #include "conversion.h"
 #include "byte_order.h"
+#include "map_catalog.h"
+#include "base_thread.h"
 
 #ifndef WIN32
 #include <errno.h>
+#include <unistd.h>
 #endif
 
 using namespace Shared::Util;
@@ -30,12 +34,94 @@ using namespace std;
 
 namespace Shared { namespace Map {
 
+// ===============================================
+//	class MapPreviewRowJobList
+//
+//	Hands out blocks of rows of one whole map operation,
+//	the calling thread works through the same list
+// ===============================================
+
+class MapPreviewRowJobList {
+public:
+	static const int rowsPerJob = 16;
+	static const int minRowsPerWorker = 128;
+
+	Mutex mutex;
+	Semaphore workerDone;
+	MapPreview *map;
+	MapPreviewRowPass pass;
+	int rowCount;
+	int nextRow;
+	string error;
+
+	// mprFlipX, mprFlipY, mprSmoothSurface
+	const float *oldHeights;
+	const int8 *oldSurfaces;
+	const int8 *oldObjects;
+	const int8 *oldResources;
+	// mprSmoothSurface
+	bool limitHeight;
+	// mprSwitchSurfaces
+	MapSurfaceType surface1;
+	MapSurfaceType surface2;
+	// set by the rows that switched a surface
+	bool changed;
+
+	MapPreviewRowJobList(MapPreview *map, MapPreviewRowPass pass, int rowCount) :
+		mutex(CODE_AT_LINE), map(map), pass(pass), rowCount(rowCount), nextRow(0),
+		oldHeights(NULL), oldSurfaces(NULL), oldObjects(NULL), oldResources(NULL), limitHeight(false),
+		surface1(DEFAULT_MAP_CELL_SURFACE_TYPE), surface2(DEFAULT_MAP_CELL_SURFACE_TYPE), changed(false) {
+	}
+
+	void process() {
+		for(;;) {
+			MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+			int firstRow = nextRow;
+			nextRow += rowsPerJob;
+			safeMutex.ReleaseLock();
+
+			if(firstRow >= rowCount) {
+				break;
+			}
+
+			try {
+				map->computeRows(*this, firstRow, min(firstRow + rowsPerJob, rowCount));
+			}
+			catch(const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+
+				MutexSafeWrapper safeMutexError(&mutex,CODE_AT_LINE);
+				error = ex.what();
+			}
+		}
+	}
+};
+
+class MapPreviewRowWorkerThread : public Shared::PlatformCommon::BaseThread {
+private:
+	MapPreviewRowJobList *jobs;
+
+public:
+	MapPreviewRowWorkerThread(MapPreviewRowJobList *jobs) : BaseThread(), jobs(jobs) {
+		setUniqueID("MapPreviewRowWorkerThread");
+	}
+
+	virtual void execute() {
+		Shared::PlatformCommon::RunningStatusSafeWrapper runningStatus(this);
+		jobs->process();
+		jobs->workerDone.signal();
+	}
+};
+
 // ===============================================
 //	class MapPreview
 // ===============================================
 
 // ================== PUBLIC =====================
 
+const int MapPreview::tileSize;
+int MapPreview::rowWorkerThreadCount = -1;
+
 MapPreview::MapPreview() {
 	mapFileLoaded = "";
 	fileLoaded = false;
@@ -43,8 +129,13 @@ MapPreview::MapPreview() {
 	waterLevel 	= DEFAULT_MAP_WATER_DEPTH;
 	cliffLevel = DEFAULT_CLIFF_HEIGHT;
 	cameraHeight = 0;
-	//cells = NULL;
-	cells.clear();
+	w = 0;
+	h = 0;
+	dirtyMinX = 0;
+	dirtyMinY = 0;
+	dirtyMaxX = -1;
+	dirtyMaxY = -1;
+	lastTileStamp = 0;
 	//startLocations = NULL;
 	startLocations.clear();
 	reset(DEFAULT_MAP_CELL_WIDTH, DEFAULT_MAP_CELL_LENGTH, (float)DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
@@ -61,17 +152,107 @@ MapPreview::~MapPreview() {
 	//delete [] startLocations;
 	//startLocations = NULL;
 	startLocations.clear();
+}
 
-	//for (int i = 0; i < h; i++) {
-	//	delete [] cells[i];
-	//}
-	//delete [] cells;
-	//cells = NULL;
-	cells.clear();
+bool MapPreview::getDirtyRect(int &minX, int &minY, int &maxX, int &maxY) const {
+	if(dirtyMaxX < dirtyMinX || dirtyMaxY < dirtyMinY) {
+		return false;
+	}
+	minX = dirtyMinX;
+	minY = dirtyMinY;
+	maxX = dirtyMaxX;
+	maxY = dirtyMaxY;
+	return true;
+}
+
+void MapPreview::clearDirtyRect() {
+	dirtyMinX = 0;
+	dirtyMinY = 0;
+	dirtyMaxX = -1;
+	dirtyMaxY = -1;
+}
+
+void MapPreview::markDirty(int minX, int minY, int maxX, int maxY) {
+	minX = max(minX, 0);
+	minY = max(minY, 0);
+	maxX = min(maxX, w - 1);
+	maxY = min(maxY, h - 1);
+	if(maxX < minX || maxY < minY) {
+		return;
+	}
+	if(dirtyMaxX < dirtyMinX || dirtyMaxY < dirtyMinY) {
+		dirtyMinX = minX;
+		dirtyMinY = minY;
+		dirtyMaxX = maxX;
+		dirtyMaxY = maxY;
+	}
+	else {
+		dirtyMinX = min(dirtyMinX, minX);
+		dirtyMinY = min(dirtyMinY, minY);
+		dirtyMaxX = max(dirtyMaxX, maxX);
+		dirtyMaxY = max(dirtyMaxY, maxY);
+	}
+
+	lastTileStamp++;
+	for(int tileY = minY / tileSize; tileY <= maxY / tileSize; ++tileY) {
+		for(int tileX = minX / tileSize; tileX <= maxX / tileSize; ++tileX) {
+			tileStamps[tileY * getTilesW() + tileX] = lastTileStamp;
+		}
+	}
+}
+
+void MapPreview::markAllDirty() {
+	dirtyMinX = 0;
+	dirtyMinY = 0;
+	dirtyMaxX = w - 1;
+	dirtyMaxY = h - 1;
+
+	lastTileStamp++;
+	tileStamps.assign(getTilesW() * getTilesH(), lastTileStamp);
+}
+
+void MapPreview::copyTile(int tileX, int tileY, MapPreviewTile &tile) const {
+	int x = tileX * tileSize;
+	int y = tileY * tileSize;
+	tile.stamp = getTileStamp(tileX, tileY);
+	tile.w = min(tileSize, w - x);
+	tile.h = min(tileSize, h - y);
+	tile.heights.resize(tile.w * tile.h);
+	tile.surfaces.resize(tile.w * tile.h);
+	tile.objects.resize(tile.w * tile.h);
+	tile.resources.resize(tile.w * tile.h);
+	for(int j = 0; j < tile.h; ++j) {
+		int index = cellIndex(x, y + j);
+		std::copy(heights.begin() + index, heights.begin() + index + tile.w, tile.heights.begin() + j * tile.w);
+		std::copy(surfaces.begin() + index, surfaces.begin() + index + tile.w, tile.surfaces.begin() + j * tile.w);
+		std::copy(objects.begin() + index, objects.begin() + index + tile.w, tile.objects.begin() + j * tile.w);
+		std::copy(resources.begin() + index, resources.begin() + index + tile.w, tile.resources.begin() + j * tile.w);
+	}
+}
+
+void MapPreview::restoreTile(int tileX, int tileY, const MapPreviewTile &tile) {
+	int x = tileX * tileSize;
+	int y = tileY * tileSize;
+	if(tile.w != min(tileSize, w - x) || tile.h != min(tileSize, h - y)) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Map tile of %dx%d cells does not fit at tile %d,%d",tile.w,tile.h,tileX,tileY);
+		throw megaglest_runtime_error(szBuf);
+	}
+	for(int j = 0; j < tile.h; ++j) {
+		int index = cellIndex(x, y + j);
+		std::copy(tile.heights.begin() + j * tile.w, tile.heights.begin() + (j + 1) * tile.w, heights.begin() + index);
+		std::copy(tile.surfaces.begin() + j * tile.w, tile.surfaces.begin() + (j + 1) * tile.w, surfaces.begin() + index);
+		std::copy(tile.objects.begin() + j * tile.w, tile.objects.begin() + (j + 1) * tile.w, objects.begin() + index);
+		std::copy(tile.resources.begin() + j * tile.w, tile.resources.begin() + (j + 1) * tile.w, resources.begin() + index);
+	}
+	markDirty(x, y, x + tile.w - 1, y + tile.h - 1);
+	// The cells are again the ones the stamp was handed out for
+	tileStamps[tileY * getTilesW() + tileX] = tile.stamp;
+	hasChanged = true;
 }
 
 float MapPreview::getHeight(int x, int y) const {
-	return cells[x][y].height;
+	return heights[cellIndex(x, y)];
 }
 
 bool MapPreview::isCliff(int x, int y){
@@ -93,15 +274,15 @@ bool MapPreview::isCliff(int x, int y){
 }
 
 MapSurfaceType MapPreview::getSurface(int x, int y) const {
-	return static_cast<MapSurfaceType>(cells[x][y].surface);
+	return static_cast<MapSurfaceType>(surfaces[cellIndex(x, y)]);
 }
 
 int MapPreview::getObject(int x, int y) const {
-	return cells[x][y].object;
+	return objects[cellIndex(x, y)];
 }
 
 int MapPreview::getResource(int x, int y) const {
-	return cells[x][y].resource;
+	return resources[cellIndex(x, y)];
 }
 
 int MapPreview::getStartLocationX(int index) const {
@@ -123,13 +304,13 @@ static int get_dist(int delta_x, int delta_y) {
 }
 
 void MapPreview::glestChangeHeight(int x, int y, int height, int radius) {
-
+	bool cellsChanged = false;
 	for (int i = x - radius + 1; i < x + radius; i++) {
 		for (int j = y - radius + 1; j < y + radius; j++) {
 			if (inside(i, j)) {
 				int dist = get_dist(i - x, j - y);
 				if (radius > dist) {
-					int oldAlt = static_cast<int>(cells[i][j].height);
+					int oldAlt = static_cast<int>(heights[cellIndex(i, j)]);
 					int altInc = height * (radius - dist - 1) / radius;
 					if (height > 0) {
 						altInc++;
@@ -140,14 +321,18 @@ void MapPreview::glestChangeHeight(int x, int y, int height, int radius) {
 					int newAlt = refAlt + altInc;
 					if ((height > 0 && newAlt > oldAlt) || (height < 0 && newAlt < oldAlt) || height == 0) {
 						if (newAlt >= 0 && newAlt <= 20) {
-							cells[i][j].height = static_cast<float>(newAlt);
-							hasChanged = true;
+							heights[cellIndex(i, j)] = static_cast<float>(newAlt);
+							cellsChanged = true;
 						}
 					}
 				}
 			}
 		}
 	}
+	if (cellsChanged) {
+		markDirty(x - radius, y - radius, x + radius, y + radius);
+		hasChanged = true;
+	}
 }
 
 
@@ -167,7 +352,8 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 	// If the radius is 1 don't bother doing any calculations
 	if (radius == 1) {
 		if(inside(x, y)){
-			cells[x][y].height = (float)goalAlt;
+			heights[cellIndex(x, y)] = (float)goalAlt;
+			markDirty(x, y, x, y);
 			hasChanged = true;
 		}
 		return;
@@ -190,7 +376,7 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 				tj = j;
 			}
 			if (inside(ti, tj)) {
-				gradient[indexI][indexJ] = (cells[ti][tj].height - (float)goalAlt) / (float)radius;
+				gradient[indexI][indexJ] = (heights[cellIndex(ti, tj)] - (float)goalAlt) / (float)radius;
 			//} else if (dist == 0) {
 				//gradient[indexI][indexJ] = 0;
 			}
@@ -199,7 +385,7 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 				gradient[indexI][indexJ] = (10.0f - (float)goalAlt) / (float)radius;
 			}
 			//std::cout << "gradient[" << indexI << "][" << indexJ << "] = " << gradient[indexI][indexJ] << std::endl;
-			//std::cout << "derived from height " << cells[ti][tj].height << " at " << ti << " " << tj << std::endl;
+			//std::cout << "derived from height " << heights[cellIndex(ti, tj)] << " at " << ti << " " << tj << std::endl;
 			indexJ++;
 		}
 		indexI++;
@@ -208,6 +394,7 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 
 	//  // A brush with radius n cells should have a true radius of n-1 distance  // No becasue then "radius" 1==2
 	// radius -= 1;
+	bool cellsChanged = false;
 	for (int i = x - radius; i <= x + radius; i++) {
 		for (int j = y - radius; j <= y + radius; j++) {
 			int dist = get_dist(i - x, j - y);
@@ -323,119 +510,108 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 
 					// if the change in height and what is supposed to be the change in height
 					// are the same sign then we can change the height
-					if (	((newAlt - cells[i][j].height) > 0 && height > 0) ||
-							((newAlt - cells[i][j].height) < 0 && height < 0) ||
+					if (	((newAlt - heights[cellIndex(i, j)]) > 0 && height > 0) ||
+							((newAlt - heights[cellIndex(i, j)]) < 0 && height < 0) ||
 							height == 0) {
-						cells[i][j].height = newAlt;
-						hasChanged = true;
+						heights[cellIndex(i, j)] = newAlt;
+						cellsChanged = true;
 					}
 				}
 		}
 	}
+	if (cellsChanged) {
+		markDirty(x - radius, y - radius, x + radius, y + radius);
+		hasChanged = true;
+	}
 }
 
 void MapPreview::setHeight(int x, int y, float height) {
-	cells[x][y].height = height;
+	heights[cellIndex(x, y)] = height;
+	markDirty(x, y, x, y);
 	hasChanged = true;
 }
 
 void MapPreview::setRefAlt(int x, int y) {
 	if (inside(x, y)) {
-		refAlt = static_cast<int>(cells[x][y].height);
+		refAlt = static_cast<int>(heights[cellIndex(x, y)]);
 		hasChanged = true;
 	}
 }
 
 void MapPreview::flipX() {
-	//Cell **oldCells = cells;
-	std::vector<std::vector<Cell> > oldCells = cells;
-
-	//cells = new Cell*[w];
-	cells.clear();
-	cells.resize(w);
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = oldCells[w-i-1][j].height;
-			cells[i][j].object = oldCells[w-i-1][j].object;
-			cells[i][j].resource = oldCells[w-i-1][j].resource;
-			cells[i][j].surface = oldCells[w-i-1][j].surface;
-		}
-	}
+	std::vector<float> oldHeights = heights;
+	std::vector<int8> oldSurfaces = surfaces;
+	std::vector<int8> oldObjects = objects;
+	std::vector<int8> oldResources = resources;
+
+	MapPreviewRowJobList jobs(this, mprFlipX, h);
+	jobs.oldHeights = &oldHeights[0];
+	jobs.oldSurfaces = &oldSurfaces[0];
+	jobs.oldObjects = &oldObjects[0];
+	jobs.oldResources = &oldResources[0];
+	runRowPass(jobs);
 
 	for (int i = 0; i < maxFactions; ++i) {
 		startLocations[i].x = w - startLocations[i].x - 1;
 	}
 
-	//for (int i = 0; i < w; i++) {
-	//	delete [] oldCells[i];
-	//}
-	//delete [] oldCells;
-
+	markAllDirty();
 	hasChanged = true;
 }
 
 void MapPreview::flipY() {
-	//Cell **oldCells = cells;
-	std::vector<std::vector<Cell> > oldCells = cells;
-
-	//cells = new Cell*[w];
-	cells.clear();
-	cells.resize(w);
-
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = oldCells[i][h-j-1].height;
-			cells[i][j].object = oldCells[i][h-j-1].object;
-			cells[i][j].resource = oldCells[i][h-j-1].resource;
-			cells[i][j].surface = oldCells[i][h-j-1].surface;
-		}
-	}
+	std::vector<float> oldHeights = heights;
+	std::vector<int8> oldSurfaces = surfaces;
+	std::vector<int8> oldObjects = objects;
+	std::vector<int8> oldResources = resources;
+
+	MapPreviewRowJobList jobs(this, mprFlipY, h);
+	jobs.oldHeights = &oldHeights[0];
+	jobs.oldSurfaces = &oldSurfaces[0];
+	jobs.oldObjects = &oldObjects[0];
+	jobs.oldResources = &oldResources[0];
+	runRowPass(jobs);
 
 	for (int i = 0; i < maxFactions; ++i) {
 		startLocations[i].y = h - startLocations[i].y - 1;
 	}
 
-	//for (int i = 0; i < w; i++) {
-	//	delete [] oldCells[i];
-	//}
-	//delete [] oldCells;
-
+	markAllDirty();
 	hasChanged = true;
 }
 
 // Copy a cell in the map from one cell to another, used by MirrorXY etc
 void MapPreview::copyXY(int x, int y, int sx, int sy) {
-	cells[x][y].height   = cells[sx][sy].height;
-	cells[x][y].object   = cells[sx][sy].object;
-	cells[x][y].resource = cells[sx][sy].resource;
-	cells[x][y].surface  = cells[sx][sy].surface;
+	heights[cellIndex(x, y)]   = heights[cellIndex(sx, sy)];
+	objects[cellIndex(x, y)]   = objects[cellIndex(sx, sy)];
+	resources[cellIndex(x, y)] = resources[cellIndex(sx, sy)];
+	surfaces[cellIndex(x, y)]  = surfaces[cellIndex(sx, sy)];
 
+	markDirty(x, y, x, y);
 	hasChanged = true;
 }
 
 // swap a cell in the map with another, used by rotate etc
 void MapPreview::swapXY(int x, int y, int sx, int sy) {
 	if(inside(x, y) && inside(sx, sy)) {
-		float tmpHeight= cells[x][y].height;
-		cells[x][y].height= cells[sx][sy].height;
-		cells[sx][sy].height= tmpHeight;
+		float tmpHeight= heights[cellIndex(x, y)];
+		heights[cellIndex(x, y)]= heights[cellIndex(sx, sy)];
+		heights[cellIndex(sx, sy)]= tmpHeight;
 
-		int tmpObject= cells[x][y].object;
-		cells[x][y].object= cells[sx][sy].object;
-		cells[sx][sy].object= tmpObject;
+		int tmpObject= objects[cellIndex(x, y)];
+		objects[cellIndex(x, y)]= objects[cellIndex(sx, sy)];
+		objects[cellIndex(sx, sy)]= tmpObject;
 
-		int tmpResource= cells[x][y].resource;
-		cells[x][y].resource= cells[sx][sy].resource;
-		cells[sx][sy].resource= tmpResource;
+		int tmpResource= resources[cellIndex(x, y)];
+		resources[cellIndex(x, y)]= resources[cellIndex(sx, sy)];
+		resources[cellIndex(sx, sy)]= tmpResource;
 
-		int tmpSurface= cells[x][y].surface;
-		cells[x][y].surface= cells[sx][sy].surface;
-		cells[sx][sy].surface= tmpSurface;
+		int tmpSurface= surfaces[cellIndex(x, y)];
+		surfaces[cellIndex(x, y)]= surfaces[cellIndex(sx, sy)];
+		surfaces[cellIndex(sx, sy)]= tmpSurface;
 
+		markDirty(x, y, x, y);
+		markDirty(sx, sy, sx, sy);
 		hasChanged = true;
 	}
 }
@@ -443,74 +619,92 @@ void MapPreview::swapXY(int x, int y, int sx, int sy) {
 void MapPreview::changeSurface(int x, int y, MapSurfaceType surface, int radius) {
 	int i = 0, j = 0;
 	int dist = 0;
+	bool cellsChanged = false;
 
 	for (i = x - radius + 1; i < x + radius; i++) {
 		for (j = y - radius + 1; j < y + radius; j++) {
 			if (inside(i, j)) {
 				dist = get_dist(i - x, j - y);
 				if (radius > dist) {  // was >=
-					cells[i][j].surface = surface;
-					hasChanged = true;
+					surfaces[cellIndex(i, j)] = surface;
+					cellsChanged = true;
 				}
 			}
 		}
 	}
+	if (cellsChanged) {
+		markDirty(x - radius, y - radius, x + radius, y + radius);
+		hasChanged = true;
+	}
 }
 
 void MapPreview::setSurface(int x, int y, MapSurfaceType surface) {
-	cells[x][y].surface = surface;
+	surfaces[cellIndex(x, y)] = surface;
+	markDirty(x, y, x, y);
 	hasChanged = true;
 }
 
 void MapPreview::changeObject(int x, int y, int object, int radius) {
 	int i = 0, j = 0;
 	int dist = 0;
+	bool cellsChanged = false;
 
 	for (i = x - radius + 1; i < x + radius; i++) {
 		for (j = y - radius + 1; j < y + radius; j++) {
 			if (inside(i, j)) {
 				dist = get_dist(i - x, j - y);
 				if (radius > dist) {  // was >=
-					cells[i][j].object = object;
-					cells[i][j].resource = 0;
-					hasChanged = true;
+					objects[cellIndex(i, j)] = object;
+					resources[cellIndex(i, j)] = 0;
+					cellsChanged = true;
 				}
 			}
 		}
 	}
+	if (cellsChanged) {
+		markDirty(x - radius, y - radius, x + radius, y + radius);
+		hasChanged = true;
+	}
 }
 
 void MapPreview::setObject(int x, int y, int object) {
-	cells[x][y].object = object;
+	objects[cellIndex(x, y)] = object;
 	if (object != 0) {
-		cells[x][y].resource = 0;
+		resources[cellIndex(x, y)] = 0;
 	}
+	markDirty(x, y, x, y);
 	hasChanged = true;
 }
 
 void MapPreview::changeResource(int x, int y, int resource, int radius) {
 	int i = 0, j = 0;
 	int dist = 0;
+	bool cellsChanged = false;
 
 	for (i = x - radius + 1; i < x + radius; i++) {
 		for (j = y - radius + 1; j < y + radius; j++) {
 			if (inside(i, j)) {
 				dist = get_dist(i - x, j - y);
 				if (radius > dist) {  // was >=
-					cells[i][j].resource = resource;
-					cells[i][j].object = 0;
-					hasChanged = true;
+					resources[cellIndex(i, j)] = resource;
+					objects[cellIndex(i, j)] = 0;
+					cellsChanged = true;
 				}
 			}
 		}
 	}
+	if (cellsChanged) {
+		markDirty(x - radius, y - radius, x + radius, y + radius);
+		hasChanged = true;
+	}
 }
 
 void MapPreview::setResource(int x, int y, int resource) {
-	cells[x][y].resource = resource;
+	resources[cellIndex(x, y)] = resource;
 	if (resource != 0) {
-		cells[x][y].object = 0;
+		objects[cellIndex(x, y)] = 0;
 	}
+	markDirty(x, y, x, y);
 	hasChanged = true;
 }
 
@@ -552,30 +746,16 @@ void MapPreview::reset(int w, int h, float alt, MapSurfaceType surf) {
 		throw megaglest_runtime_error(szBuf);
 	}
 
-	//if (cells != NULL) {
-	//	for (int i = 0; i < this->w; i++) {
-	//		delete [] cells[i];
-	//	}
-	//	delete [] cells;
-	//}
-	cells.clear();
-
 	this->w = w;
 	this->h = h;
 	//this->maxFactions = maxFactions;
 
-	//cells = new Cell*[w];
-	cells.resize(w);
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = alt;
-			cells[i][j].object = 0;
-			cells[i][j].resource = 0;
-			cells[i][j].surface = surf;
-		}
-	}
+	heights.assign(w * h, alt);
+	surfaces.assign(w * h, (int8)surf);
+	objects.assign(w * h, 0);
+	resources.assign(w * h, 0);
+
+	markAllDirty();
 	hasChanged = true;
 }
 
@@ -611,48 +791,38 @@ void MapPreview::resize(int w, int h, float alt, MapSurfaceType surf) {
 	this->h = h;
 	//this->maxFactions = maxFactions;
 
-	//create new cells
-	//Cell **oldCells = cells;
-	std::vector<std::vector<Cell> > oldCells = cells;
-
-	//cells = new Cell*[w];
-	cells.resize(w);
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = alt;
-			cells[i][j].object = 0;
-			cells[i][j].resource = 0;
-			cells[i][j].surface = surf;
-		}
-	}
+	std::vector<float> oldHeights;
+	std::vector<int8> oldSurfaces;
+	std::vector<int8> oldObjects;
+	std::vector<int8> oldResources;
+	oldHeights.swap(heights);
+	oldSurfaces.swap(surfaces);
+	oldObjects.swap(objects);
+	oldResources.swap(resources);
+
+	heights.assign(w * h, alt);
+	surfaces.assign(w * h, (int8)surf);
+	objects.assign(w * h, 0);
+	resources.assign(w * h, 0);
 
 	int wOffset = w < oldW ? 0 : (w - oldW) / 2;
 	int hOffset = h < oldH ? 0 : (h - oldH) / 2;
-	//assign old values to cells
-	for (int i = 0; i < oldW; i++) {
-		for (int j = 0; j < oldH; j++) {
-			if (i + wOffset < w && j + hOffset < h) {
-				cells[i+wOffset][j+hOffset].height = oldCells[i][j].height;
-				cells[i+wOffset][j+hOffset].object = oldCells[i][j].object;
-				cells[i+wOffset][j+hOffset].resource = oldCells[i][j].resource;
-				cells[i+wOffset][j+hOffset].surface = oldCells[i][j].surface;
-			}
-		}
+	//assign old values to cells, a row at a time
+	int copyW = min(oldW, w - wOffset);
+	for (int j = 0; j < oldH && j + hOffset < h; j++) {
+		int oldIndex = j * oldW;
+		int newIndex = cellIndex(wOffset, j + hOffset);
+		std::copy(oldHeights.begin() + oldIndex, oldHeights.begin() + oldIndex + copyW, heights.begin() + newIndex);
+		std::copy(oldSurfaces.begin() + oldIndex, oldSurfaces.begin() + oldIndex + copyW, surfaces.begin() + newIndex);
+		std::copy(oldObjects.begin() + oldIndex, oldObjects.begin() + oldIndex + copyW, objects.begin() + newIndex);
+		std::copy(oldResources.begin() + oldIndex, oldResources.begin() + oldIndex + copyW, resources.begin() + newIndex);
 	}
 	for (int i = 0; i < maxFactions; ++i) {
 		startLocations[i].x += wOffset;
 		startLocations[i].y += hOffset;
 	}
 
-	//delete old cells
-	//if (oldCells != NULL) {
-	//	for (int i = 0; i < oldW; i++)
-	//		delete [] oldCells[i];
-	//	delete [] oldCells;
-	//}
-
+	markAllDirty();
 	hasChanged = true;
 }
 
@@ -701,6 +871,8 @@ void MapPreview::setAdvanced(int heightFactor, int waterLevel, int cliffLevel, i
 	this->waterLevel = waterLevel;
 	this->cliffLevel = cliffLevel;
 	this->cameraHeight = cameraHeight;
+	// water and cliffs show on every cell
+	markAllDirty();
 	hasChanged = true;
 }
 
@@ -726,57 +898,139 @@ void MapPreview::randomizeFactions() {
 }
 
 void MapPreview::smoothSurface(bool limitHeight) {
-	float *oldHeights = new float[w*h];
+	std::vector<float> oldHeights = heights;
+
+	MapPreviewRowJobList jobs(this, mprSmoothSurface, h);
+	jobs.oldHeights = &oldHeights[0];
+	jobs.limitHeight = limitHeight;
+	runRowPass(jobs);
+
+	markAllDirty();
+}
+
+void MapPreview::switchSurfaces(MapSurfaceType surf1, MapSurfaceType surf2) {
+	if (surf1 >= st_Grass && surf1 <= st_Ground && surf2 >= st_Grass && surf2 <= st_Ground) {
+		MapPreviewRowJobList jobs(this, mprSwitchSurfaces, h);
+		jobs.surface1 = surf1;
+		jobs.surface2 = surf2;
+		runRowPass(jobs);
 
-	for (int i = 0; i < w; ++i) {
-		for (int j = 0; j < h; ++j) {
-			oldHeights[i*w+j] = cells[i][j].height;
-			//printf("count=%d height=%f h=%f\n",i*w+h,oldHeights[i*w+h],cells[i][j].height);
+		if (jobs.changed) {
+			markAllDirty();
+			hasChanged = true;
 		}
 	}
+	else {
+		throw megaglest_runtime_error("Incorrect surfaces");
+	}
+}
 
-	for (int i = 1; i < w - 1; ++i) {
-		for (int j = 1; j < h - 1; ++j) {
-			float height = 0.f;
-			float numUsedToSmooth = 0.f;
-			for (int k = -1; k <= 1; ++k) {
-				for (int l = -1; l <= 1; ++l) {
-					int tmpHeight=oldHeights[(j + k) * w + (i + l)];
-					if(limitHeight && tmpHeight>20){
-						tmpHeight=20;
-					}
-					if(limitHeight && tmpHeight<0){
-						tmpHeight=0;
-					}
-					height += tmpHeight;
-					numUsedToSmooth++;
-				}
-			}
-			height /= numUsedToSmooth;
-			cells[i][j].height=height;
+void MapPreview::runRowPass(MapPreviewRowJobList &jobs) {
+	int workerCount = rowWorkerThreadCount;
+	if(workerCount < 0) {
+#ifdef WIN32
+		SYSTEM_INFO sysinfo;
+		GetSystemInfo(&sysinfo);
+		workerCount = (int)sysinfo.dwNumberOfProcessors - 1;
+#else
+		workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+#endif
+	}
+	workerCount = min(workerCount,jobs.rowCount / MapPreviewRowJobList::minRowsPerWorker);
+	if(workerCount < 0) {
+		workerCount = 0;
+	}
+
+	vector<MapPreviewRowWorkerThread *> workers;
+	for(int index = 0; index < workerCount; ++index) {
+		MapPreviewRowWorkerThread *worker = new MapPreviewRowWorkerThread(&jobs);
+		worker->start();
+		workers.push_back(worker);
+	}
+
+	jobs.process();
+
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		jobs.workerDone.waitTillSignalled();
+	}
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		if(workers[index]->shutdownAndJoin() == true) {
+			delete workers[index];
 		}
 	}
-	delete[] oldHeights;
+
+	if(jobs.error != "") {
+		throw megaglest_runtime_error(jobs.error);
+	}
 }
 
-void MapPreview::switchSurfaces(MapSurfaceType surf1, MapSurfaceType surf2) {
-	if (surf1 >= st_Grass && surf1 <= st_Ground && surf2 >= st_Grass && surf2 <= st_Ground) {
-		for (int i = 0; i < w; ++i) {
-			for (int j = 0; j < h; ++j) {
-				if (cells[i][j].surface == surf1) {
-					cells[i][j].surface = surf2;
-					hasChanged = true;
+void MapPreview::computeRows(MapPreviewRowJobList &jobs, int firstRow, int lastRow) {
+	switch(jobs.pass) {
+		case mprFlipX:
+			for (int j = firstRow; j < lastRow; ++j) {
+				for (int i = 0; i < w; ++i) {
+					int oldIndex = cellIndex(w - i - 1, j);
+					heights[cellIndex(i, j)] = jobs.oldHeights[oldIndex];
+					surfaces[cellIndex(i, j)] = jobs.oldSurfaces[oldIndex];
+					objects[cellIndex(i, j)] = jobs.oldObjects[oldIndex];
+					resources[cellIndex(i, j)] = jobs.oldResources[oldIndex];
+				}
+			}
+			break;
+
+		case mprFlipY:
+			for (int j = firstRow; j < lastRow; ++j) {
+				int oldIndex = cellIndex(0, h - j - 1);
+				std::copy(jobs.oldHeights + oldIndex, jobs.oldHeights + oldIndex + w, heights.begin() + cellIndex(0, j));
+				std::copy(jobs.oldSurfaces + oldIndex, jobs.oldSurfaces + oldIndex + w, surfaces.begin() + cellIndex(0, j));
+				std::copy(jobs.oldObjects + oldIndex, jobs.oldObjects + oldIndex + w, objects.begin() + cellIndex(0, j));
+				std::copy(jobs.oldResources + oldIndex, jobs.oldResources + oldIndex + w, resources.begin() + cellIndex(0, j));
+			}
+			break;
+
+		case mprSmoothSurface:
+			for (int j = max(firstRow, 1); j < min(lastRow, h - 1); ++j) {
+				for (int i = 1; i < w - 1; ++i) {
+					float height = 0.f;
+					float numUsedToSmooth = 0.f;
+					for (int k = -1; k <= 1; ++k) {
+						for (int l = -1; l <= 1; ++l) {
+							int tmpHeight=jobs.oldHeights[cellIndex(i + l, j + k)];
+							if(jobs.limitHeight && tmpHeight>20){
+								tmpHeight=20;
+							}
+							if(jobs.limitHeight && tmpHeight<0){
+								tmpHeight=0;
+							}
+							height += tmpHeight;
+							numUsedToSmooth++;
+						}
+					}
+					height /= numUsedToSmooth;
+					heights[cellIndex(i, j)]=height;
+				}
+			}
+			break;
+
+		case mprSwitchSurfaces: {
+			bool rowsChanged = false;
+			for (int index = cellIndex(0, firstRow); index < cellIndex(0, lastRow); ++index) {
+				if (surfaces[index] == jobs.surface1) {
+					surfaces[index] = jobs.surface2;
+					rowsChanged = true;
 				}
-				else if (cells[i][j].surface == surf2) {
-					cells[i][j].surface = surf1;
-					hasChanged = true;
+				else if (surfaces[index] == jobs.surface2) {
+					surfaces[index] = jobs.surface1;
+					rowsChanged = true;
 				}
 			}
+			if (rowsChanged) {
+				MutexSafeWrapper safeMutex(&jobs.mutex,CODE_AT_LINE);
+				jobs.changed = true;
+			}
+			break;
 		}
 	}
-	else {
-		throw megaglest_runtime_error("Incorrect surfaces");
-	}
 }
 
 void toEndianMapFileHeader(MapFileHeader &header) {
@@ -865,51 +1119,37 @@ void MapPreview::loadFromFile(const string &path) {
 			startLocations[i].y = Shared::PlatformByteOrder::fromCommonEndian(startLocations[i].y);
 		}
 
-		//read Heights
+		//read Heights, the layers are stored row by row like the planes
 		reset(header.width, header.height, (float)DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				bytes = fread(&cells[i][j].height, sizeof(float), 1, f1);
-				if(bytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				cells[i][j].height = Shared::PlatformByteOrder::fromCommonEndian(cells[i][j].height);
-			}
+		bytes = fread(&heights[0], sizeof(float), heights.size(), f1);
+		if(bytes != heights.size()) {
+			char szBuf[8096]="";
+			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
+			throw megaglest_runtime_error(szBuf);
+		}
+		for (unsigned int index = 0; index < heights.size(); ++index) {
+			heights[index] = Shared::PlatformByteOrder::fromCommonEndian(heights[index]);
 		}
 
 		//read surfaces
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				bytes = fread(&cells[i][j].surface, sizeof(int8), 1, f1);
-				if(bytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				cells[i][j].surface = Shared::PlatformByteOrder::fromCommonEndian(cells[i][j].surface);
-			}
+		bytes = fread(&surfaces[0], sizeof(int8), surfaces.size(), f1);
+		if(bytes != surfaces.size()) {
+			char szBuf[8096]="";
+			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
+			throw megaglest_runtime_error(szBuf);
 		}
 
 		//read objects
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				int8 obj;
-				bytes = fread(&obj, sizeof(int8), 1, f1);
-				if(bytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				obj = Shared::PlatformByteOrder::fromCommonEndian(obj);
-
-				if (obj <= 10) {
-					cells[i][j].object = obj;
-				}
-				else {
-					cells[i][j].resource = obj - 10;
-				}
+		bytes = fread(&objects[0], sizeof(int8), objects.size(), f1);
+		if(bytes != objects.size()) {
+			char szBuf[8096]="";
+			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
+			throw megaglest_runtime_error(szBuf);
+		}
+		for (unsigned int index = 0; index < objects.size(); ++index) {
+			if (objects[index] > 10) {
+				resources[index] = objects[index] - 10;
+				objects[index] = 0;
 			}
 		}
 
@@ -969,30 +1209,19 @@ void MapPreview::saveToFile(const string &path) {
 		}
 
 		//write Heights
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				fwrite(&cells[i][j].height, sizeof(float32), 1, f1);
-			}
-		}
+		fwrite(&heights[0], sizeof(float32), heights.size(), f1);
 
 		//write surfaces
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				fwrite(&cells[i][j].surface, sizeof(int8), 1, f1);
-			}
-		}
+		fwrite(&surfaces[0], sizeof(int8), surfaces.size(), f1);
 
-		//write objects
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				if (cells[i][j].resource == 0)
-					fwrite(&cells[i][j].object, sizeof(int8), 1, f1);
-				else {
-					int8 res = cells[i][j].resource + 10;
-					fwrite(&res, sizeof(int8), 1, f1);
-				}
+		//write objects, resources are stored as objects above 10
+		std::vector<int8> objectLayer(objects);
+		for (unsigned int index = 0; index < objectLayer.size(); ++index) {
+			if (resources[index] != 0) {
+				objectLayer[index] = resources[index] + 10;
 			}
 		}
+		fwrite(&objectLayer[0], sizeof(int8), objectLayer.size(), f1);
 
 		if(f1) fclose(f1);
 
@@ -1008,12 +1237,9 @@ void MapPreview::saveToFile(const string &path) {
 // ==================== PRIVATE ====================
 
 void MapPreview::resetHeights(int height) {
-	for (int i = 0; i < w; ++i) {
-		for (int j = 0; j < h; ++j) {
-			cells[i][j].height = static_cast<float>(height);
-			hasChanged = true;
-		}
-	}
+	std::fill(heights.begin(), heights.end(), static_cast<float>(height));
+	markAllDirty();
+	hasChanged = true;
 }
 
 void MapPreview::realRandomize(int minimumHeight, int maximumHeight, int _chanceDevider, int _smoothRecursions) {
@@ -1033,10 +1259,11 @@ void MapPreview::realRandomize(int minimumHeight, int maximumHeight, int _chance
 	for (int i = 1; i < w-1; ++i) {
 		for (int j = 1; j < h-1; ++j) {
 			if(rand()%chanceDevider==1){
-				cells[i][j].height=(rand() % moduloParam)+minimumHeight;
+				heights[cellIndex(i, j)]=(rand() % moduloParam)+minimumHeight;
 			}
 		}
 	}
+	markAllDirty();
 	for( int i = 0; i<smoothRecursions;++i){
 		if(i+1==smoothRecursions)
 			smoothSurface(true);
@@ -1046,11 +1273,64 @@ void MapPreview::realRandomize(int minimumHeight, int maximumHeight, int _chance
 }
 
 void MapPreview::applyNewHeight(float newHeight, int x, int y, int strenght) {
-	cells[x][y].height = static_cast<float>(((cells[x][y].height * strenght) + newHeight) / (strenght + 1));
+	heights[cellIndex(x, y)] = static_cast<float>(((heights[cellIndex(x, y)] * strenght) + newHeight) / (strenght + 1));
+	markDirty(x, y, x, y);
 	hasChanged = true;
 }
 
+bool MapPreview::loadFromCatalog(const string &path) {
+	MapCatalogEntry entry;
+	if(MapCatalog::findEntry(path, entry) == false || entry.valid == false ||
+		entry.previewCells.empty() == true) {
+		return false;
+	}
+
+	heightFactor = entry.heightFactor;
+	waterLevel = entry.waterLevel;
+	cliffLevel = entry.cliffLevel;
+	title = entry.title;
+
+	resetFactions(entry.players);
+	for(int i = 0; i < maxFactions && i * 2 + 1 < (int)entry.previewStartLocations.size(); ++i) {
+		startLocations[i].x = entry.previewStartLocations[i * 2];
+		startLocations[i].y = entry.previewStartLocations[i * 2 + 1];
+	}
+
+	reset(entry.previewW, entry.previewH, (float)DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
+	for (int j = 0; j < h; ++j) {
+		for (int i = 0; i < w; ++i) {
+			const uint8 *cell = &entry.previewCells[(j * w + i) * 3];
+			heights[cellIndex(i, j)] = cell[0] / 10.f;
+			surfaces[cellIndex(i, j)] = cell[1];
+			objects[cellIndex(i, j)] = (cell[2] & 0x0F);
+			resources[cellIndex(i, j)] = (cell[2] >> 4);
+		}
+	}
+
+	fileLoaded = true;
+	mapFileLoaded = path;
+	hasChanged = false;
+	return true;
+}
+
 bool MapPreview::loadMapInfo(string file, MapInfo *mapInfo, string i18nMaxMapPlayersTitle,string i18nMapSizeTitle,bool errorOnInvalidMap) {
+	MapCatalogEntry entry;
+	if(MapCatalog::findEntry(file, entry) == true &&
+		(entry.valid == true || errorOnInvalidMap == false)) {
+		if(entry.valid == true) {
+			mapInfo->size.x	= entry.width;
+			mapInfo->size.y	= entry.height;
+			mapInfo->players= entry.players;
+
+			mapInfo->desc 	=  i18nMaxMapPlayersTitle 	+ ": " + intToStr(mapInfo->players) + "\n";
+			mapInfo->desc 	+= i18nMapSizeTitle 		+ ": " + intToStr(mapInfo->size.x) + " x " + intToStr(mapInfo->size.y);
+		}
+		return entry.valid;
+	}
+	return loadMapInfoFromFile(file, mapInfo, i18nMaxMapPlayersTitle, i18nMapSizeTitle, errorOnInvalidMap);
+}
+
+bool MapPreview::loadMapInfoFromFile(string file, MapInfo *mapInfo, string i18nMaxMapPlayersTitle,string i18nMapSizeTitle,bool errorOnInvalidMap) {
 	bool validMap = false;
 	FILE *f = NULL;
 	try {
@@ -0,0 +1,702 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "log_record_queue.h"
+#include "platform_common.h"
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+
+#ifndef va_copy
+#define va_copy(dest,src) ((dest) = (src))
+#endif
+
+namespace Shared { namespace PlatformCommon {
+
+// Producers only touch shared state through these
+#ifdef WIN32
+
+static inline int32 atomicCompareAndSwap(volatile int32 *value, int32 expected, int32 newValue) {
+	return InterlockedCompareExchange((volatile LONG *)value, newValue, expected);
+}
+static inline int32 atomicIncrement(volatile int32 *value) {
+	return InterlockedIncrement((volatile LONG *)value);
+}
+static inline int32 atomicExchange(volatile int32 *value, int32 newValue) {
+	return InterlockedExchange((volatile LONG *)value, newValue);
+}
+static inline void memoryBarrier() {
+	MemoryBarrier();
+}
+
+#else
+
+static inline int32 atomicCompareAndSwap(volatile int32 *value, int32 expected, int32 newValue) {
+	return __sync_val_compare_and_swap(value, expected, newValue);
+}
+static inline int32 atomicIncrement(volatile int32 *value) {
+	return __sync_add_and_fetch(value, 1);
+}
+static inline int32 atomicExchange(volatile int32 *value, int32 newValue) {
+	__sync_synchronize();
+	return __sync_lock_test_and_set(value, newValue);
+}
+static inline void memoryBarrier() {
+	__sync_synchronize();
+}
+
+#endif
+
+// =====================================================
+//	class LogRecordFormat
+// =====================================================
+
+LogRecordFormat::LogRecordFormat(int id, const char *source) {
+	this->id = id;
+	this->source = source;
+	this->text = (source != NULL ? source : "");
+	this->capturable = false;
+	this->stable = true;
+}
+
+void LogRecordFormat::parse() {
+	enum LengthType {
+		lengthNone,
+		lengthLong,
+		lengthLongLong,
+		lengthSizeT,
+		lengthLongDouble
+	};
+
+	segments.clear();
+	capturable = true;
+
+	string literal = "";
+	const char *pos = text.c_str();
+	for(;*pos != '\0';) {
+		if(*pos != '%') {
+			literal += *pos++;
+			continue;
+		}
+		if(pos[1] == '%') {
+			literal += "%%";
+			pos += 2;
+			continue;
+		}
+
+		const char *conversionStart = pos++;
+		int starCount = 0;
+		for(;*pos != '\0' && strchr("-+ #0'",*pos) != NULL; ++pos) {
+		}
+		if(*pos == '*') {
+			starCount++;
+			pos++;
+		}
+		for(;isdigit((unsigned char)*pos); ++pos) {
+		}
+		if(*pos == '.') {
+			pos++;
+			if(*pos == '*') {
+				starCount++;
+				pos++;
+			}
+			for(;isdigit((unsigned char)*pos); ++pos) {
+			}
+		}
+
+		LengthType length = lengthNone;
+		if(*pos == 'h') {
+			pos++;
+			if(*pos == 'h') {
+				pos++;
+			}
+		}
+		else if(*pos == 'l') {
+			pos++;
+			length = lengthLong;
+			if(*pos == 'l') {
+				pos++;
+				length = lengthLongLong;
+			}
+		}
+		else if(*pos == 'q' || *pos == 'j') {
+			pos++;
+			length = lengthLongLong;
+		}
+		else if(*pos == 'z' || *pos == 't') {
+			pos++;
+			length = lengthSizeT;
+		}
+		else if(*pos == 'L') {
+			pos++;
+			length = lengthLongDouble;
+		}
+		else if(*pos == 'I') {
+			if(pos[1] == '6' && pos[2] == '4') {
+				pos += 3;
+				length = lengthLongLong;
+			}
+			else if(pos[1] == '3' && pos[2] == '2') {
+				pos += 3;
+			}
+			else {
+				pos++;
+				length = lengthSizeT;
+			}
+		}
+
+		Segment segment;
+		segment.starCount = starCount;
+		segment.argType = argNone;
+		switch(*pos) {
+			case 'd':
+			case 'i':
+			case 'o':
+			case 'u':
+			case 'x':
+			case 'X':
+				segment.argType = (length == lengthLong ? argLong :
+								   length == lengthLongLong ? argLongLong :
+								   length == lengthSizeT ? argSizeT : argInt);
+				capturable = (length != lengthLongDouble);
+				break;
+			// %lc takes a promoted wint_t
+			case 'c':
+				segment.argType = argInt;
+				break;
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				segment.argType = argDouble;
+				capturable = (length == lengthNone || length == lengthLong);
+				break;
+			case 'p':
+				segment.argType = argPointer;
+				break;
+			case 's':
+				segment.argType = argString;
+				capturable = (length == lengthNone);
+				break;
+			default:
+				capturable = false;
+				break;
+		}
+		if(capturable == false) {
+			segments.clear();
+			return;
+		}
+		pos++;
+
+		segment.text = literal + string(conversionStart, pos - conversionStart);
+		segments.push_back(segment);
+		literal = "";
+	}
+
+	if(literal.empty() == false) {
+		Segment segment;
+		segment.text = literal;
+		segment.argType = argNone;
+		segment.starCount = 0;
+		segments.push_back(segment);
+	}
+}
+
+// =====================================================
+//	class LogRecordQueue
+// =====================================================
+
+LogRecordQueue::LogRecordQueue() : mutexFormats(CODE_AT_LINE), mutexOverflow(CODE_AT_LINE) {
+	slots = new Slot[slotCount];
+	for(int index = 0; index < slotCount; ++index) {
+		slots[index].sequence = index;
+		slots[index].formatId = 0;
+		slots[index].payloadSize = 0;
+		slots[index].heapText = NULL;
+	}
+	enqueuePos = 0;
+	dequeuePos = 0;
+
+	for(int index = 0; index < formatTableSize; ++index) {
+		formatTable[index] = NULL;
+		formatsById[index] = NULL;
+	}
+	formatCount = 0;
+
+	rateLimit = 0;
+	for(int index = 0; index < categoryCount; ++index) {
+		rateLimits[index].second = 0;
+		rateLimits[index].count = 0;
+		rateLimits[index].dropped = 0;
+	}
+	overflowActive = false;
+	overflowCount = 0;
+	overflowTotal = 0;
+}
+
+LogRecordQueue::~LogRecordQueue() {
+	for(int index = 0; index < slotCount; ++index) {
+		delete [] slots[index].heapText;
+	}
+	delete [] slots;
+	slots = NULL;
+
+	for(int index = 0; index < formatCount; ++index) {
+		delete formatsById[index];
+		formatsById[index] = NULL;
+	}
+}
+
+LogRecordFormat * LogRecordQueue::findFormat(const char *fmt) {
+	const int mask = formatTableSize - 1;
+	const int firstIndex = (int)((((size_t)fmt >> 2) * 2654435761u) & mask);
+
+	int index = firstIndex;
+	for(int probe = 0; probe < formatTableSize; ++probe) {
+		LogRecordFormat *format = formatTable[index];
+		if(format == NULL) {
+			break;
+		}
+		if(format->source == fmt) {
+			return format;
+		}
+		index = (index + 1) & mask;
+	}
+
+	// First record from this format
+	MutexSafeWrapper safeMutex(&mutexFormats,CODE_AT_LINE);
+	index = firstIndex;
+	for(int probe = 0; probe < formatTableSize; ++probe) {
+		LogRecordFormat *format = formatTable[index];
+		if(format == NULL) {
+			break;
+		}
+		if(format->source == fmt) {
+			return format;
+		}
+		index = (index + 1) & mask;
+	}
+	// Keep the probe sequences short, the caller formats the entry itself
+	if(formatCount >= formatTableSize - formatTableSize / 4) {
+		return NULL;
+	}
+
+	LogRecordFormat *format = new LogRecordFormat(formatCount + 1, fmt);
+	format->parse();
+	formatsById[formatCount] = format;
+	memoryBarrier();
+	formatTable[index] = format;
+	formatCount = formatCount + 1;
+	return format;
+}
+
+bool LogRecordQueue::captureArgs(const LogRecordFormat *format, va_list argList, Slot &slot) {
+	char *payload = slot.payload;
+	int size = 0;
+
+	for(unsigned int index = 0; index < format->segments.size(); ++index) {
+		const LogRecordFormat::Segment &segment = format->segments[index];
+		if(size + (int)((segment.starCount + 1) * sizeof(int64)) > slotPayloadBytes) {
+			return false;
+		}
+		for(int star = 0; star < segment.starCount; ++star) {
+			int value = va_arg(argList, int);
+			memcpy(&payload[size], &value, sizeof(value));
+			size += sizeof(value);
+		}
+
+		switch(segment.argType) {
+			case LogRecordFormat::argNone:
+				break;
+			case LogRecordFormat::argInt:
+				{
+				int value = va_arg(argList, int);
+				memcpy(&payload[size], &value, sizeof(value));
+				size += sizeof(value);
+				}
+				break;
+			case LogRecordFormat::argLong:
+				{
+				long value = va_arg(argList, long);
+				memcpy(&payload[size], &value, sizeof(value));
+				size += sizeof(value);
+				}
+				break;
+			case LogRecordFormat::argLongLong:
+				{
+				long long value = va_arg(argList, long long);
+				memcpy(&payload[size], &value, sizeof(value));
+				size += sizeof(value);
+				}
+				break;
+			case LogRecordFormat::argSizeT:
+				{
+				size_t value = va_arg(argList, size_t);
+				memcpy(&payload[size], &value, sizeof(value));
+				size += sizeof(value);
+				}
+				break;
+			case LogRecordFormat::argDouble:
+				{
+				double value = va_arg(argList, double);
+				memcpy(&payload[size], &value, sizeof(value));
+				size += sizeof(value);
+				}
+				break;
+			case LogRecordFormat::argPointer:
+				{
+				void *value = va_arg(argList, void *);
+				memcpy(&payload[size], &value, sizeof(value));
+				size += sizeof(value);
+				}
+				break;
+			case LogRecordFormat::argString:
+				{
+				const char *value = va_arg(argList, const char *);
+				// -1 for a NULL string
+				int32 length = (value != NULL ? (int32)strlen(value) : -1);
+				memcpy(&payload[size], &length, sizeof(length));
+				size += sizeof(length);
+				if(length >= 0) {
+					if(size + length + 1 > slotPayloadBytes) {
+						return false;
+					}
+					memcpy(&payload[size], value, length + 1);
+					size += length + 1;
+				}
+				}
+				break;
+		}
+	}
+	slot.payloadSize = size;
+	return true;
+}
+
+template<typename T>
+static void appendLogSegment(string &result, const LogRecordFormat::Segment &segment,
+							 const int *stars, T value) {
+	char szBuf[LogRecordQueue::maxEntryLength]="";
+	switch(segment.starCount) {
+		case 0:
+			snprintf(szBuf,LogRecordQueue::maxEntryLength-1,segment.text.c_str(),value);
+			break;
+		case 1:
+			snprintf(szBuf,LogRecordQueue::maxEntryLength-1,segment.text.c_str(),stars[0],value);
+			break;
+		default:
+			snprintf(szBuf,LogRecordQueue::maxEntryLength-1,segment.text.c_str(),stars[0],stars[1],value);
+			break;
+	}
+	result += szBuf;
+}
+
+string LogRecordQueue::formatRecord(const Slot &slot) {
+	if(slot.formatId == 0) {
+		if(slot.heapText != NULL) {
+			return slot.heapText;
+		}
+		return string(slot.payload, slot.payloadSize);
+	}
+
+	const LogRecordFormat *format = formatsById[slot.formatId - 1];
+	const char *payload = slot.payload;
+	int offset = 0;
+
+	string result = "";
+	for(unsigned int index = 0; index < format->segments.size(); ++index) {
+		const LogRecordFormat::Segment &segment = format->segments[index];
+		int stars[2] = { 0, 0 };
+		for(int star = 0; star < segment.starCount && star < 2; ++star) {
+			memcpy(&stars[star], &payload[offset], sizeof(int));
+			offset += sizeof(int);
+		}
+
+		switch(segment.argType) {
+			case LogRecordFormat::argNone:
+				{
+				char szBuf[maxEntryLength]="";
+				snprintf(szBuf,maxEntryLength-1,segment.text.c_str(),0);
+				result += szBuf;
+				}
+				break;
+			case LogRecordFormat::argInt:
+				{
+				int value = 0;
+				memcpy(&value, &payload[offset], sizeof(value));
+				offset += sizeof(value);
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+			case LogRecordFormat::argLong:
+				{
+				long value = 0;
+				memcpy(&value, &payload[offset], sizeof(value));
+				offset += sizeof(value);
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+			case LogRecordFormat::argLongLong:
+				{
+				long long value = 0;
+				memcpy(&value, &payload[offset], sizeof(value));
+				offset += sizeof(value);
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+			case LogRecordFormat::argSizeT:
+				{
+				size_t value = 0;
+				memcpy(&value, &payload[offset], sizeof(value));
+				offset += sizeof(value);
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+			case LogRecordFormat::argDouble:
+				{
+				double value = 0;
+				memcpy(&value, &payload[offset], sizeof(value));
+				offset += sizeof(value);
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+			case LogRecordFormat::argPointer:
+				{
+				void *value = NULL;
+				memcpy(&value, &payload[offset], sizeof(value));
+				offset += sizeof(value);
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+			case LogRecordFormat::argString:
+				{
+				int32 length = 0;
+				memcpy(&length, &payload[offset], sizeof(length));
+				offset += sizeof(length);
+				const char *value = NULL;
+				if(length >= 0) {
+					value = &payload[offset];
+					offset += length + 1;
+				}
+				appendLogSegment(result, segment, stars, value);
+				}
+				break;
+		}
+	}
+
+	// Same limit as formatting the whole entry at once
+	if(result.size() > (size_t)maxEntryLength - 2) {
+		result.resize(maxEntryLength - 2);
+	}
+	return result;
+}
+
+bool LogRecordQueue::isRateLimited(SystemFlags::DebugType type, time_t now) {
+	if(rateLimit <= 0 || type == SystemFlags::debugError) {
+		return false;
+	}
+
+	RateLimit &limit = rateLimits[type];
+	int32 second = (int32)now;
+	int32 lastSecond = limit.second;
+	if(lastSecond != second &&
+		atomicCompareAndSwap(&limit.second, lastSecond, second) == lastSecond) {
+		// Approximate, records racing this reset count for the old second
+		atomicExchange(&limit.count, 0);
+	}
+	if(atomicIncrement(&limit.count) > rateLimit) {
+		atomicIncrement(&limit.dropped);
+		return true;
+	}
+	return false;
+}
+
+bool LogRecordQueue::pushOverflow(SystemFlags::DebugType type, time_t now, const char *fmt, va_list argList, bool startOverflow) {
+	OverflowRecord record;
+	record.type = type;
+	record.entryTime = now;
+	if(fmt != NULL) {
+		char szBuf[maxEntryLength]="";
+		va_list argCopy;
+		va_copy(argCopy, argList);
+		vsnprintf(szBuf,maxEntryLength-1,fmt,argCopy);
+		va_end(argCopy);
+		record.entry = szBuf;
+	}
+
+	MutexSafeWrapper safeMutex(&mutexOverflow,CODE_AT_LINE);
+	if(overflowActive == false) {
+		// The consumer caught up, use the slots again
+		if(startOverflow == false) {
+			return false;
+		}
+		overflowActive = true;
+	}
+	overflowRecords.push_back(record);
+	overflowCount = overflowCount + 1;
+	overflowTotal = overflowTotal + 1;
+	return true;
+}
+
+void LogRecordQueue::push(SystemFlags::DebugType type, const char *fmt, va_list argList) {
+	time_t now = time(NULL);
+	if(isRateLimited(type, now) == true) {
+		return;
+	}
+
+	// Records go after the ones that spilled over, so each producer's
+	// records stay in order
+	if(overflowActive == true &&
+		pushOverflow(type, now, fmt, argList, false) == true) {
+		return;
+	}
+
+	Slot *slot = NULL;
+	uint32 pos = enqueuePos;
+	for(;;) {
+		slot = &slots[pos & (slotCount - 1)];
+		uint32 sequence = slot->sequence;
+		memoryBarrier();
+		int32 diff = (int32)(sequence - pos);
+		if(diff == 0) {
+			if((uint32)atomicCompareAndSwap((volatile int32 *)&enqueuePos, (int32)pos, (int32)(pos + 1)) == pos) {
+				break;
+			}
+		}
+		else if(diff < 0) {
+			// Full
+			pushOverflow(type, now, fmt, argList, true);
+			return;
+		}
+		pos = enqueuePos;
+	}
+
+	slot->type = type;
+	slot->entryTime = now;
+	slot->heapText = NULL;
+
+	bool captured = false;
+	LogRecordFormat *format = (fmt != NULL ? findFormat(fmt) : NULL);
+	if(format != NULL && format->capturable == true && format->stable == true) {
+		if(strcmp(format->text.c_str(), fmt) == 0) {
+			va_list argCopy;
+			va_copy(argCopy, argList);
+			captured = captureArgs(format, argCopy, *slot);
+			va_end(argCopy);
+			if(captured == true) {
+				slot->formatId = format->id;
+			}
+		}
+		else {
+			format->stable = false;
+		}
+	}
+
+	if(captured == false) {
+		char szBuf[maxEntryLength]="";
+		if(fmt != NULL) {
+			vsnprintf(szBuf,maxEntryLength-1,fmt,argList);
+		}
+		int length = (int)strlen(szBuf);
+		slot->formatId = 0;
+		slot->payloadSize = length;
+		if(length < slotPayloadBytes) {
+			memcpy(slot->payload, szBuf, length + 1);
+		}
+		else {
+			slot->heapText = new char[length + 1];
+			memcpy(slot->heapText, szBuf, length + 1);
+		}
+	}
+
+	memoryBarrier();
+	slot->sequence = pos + 1;
+}
+
+bool LogRecordQueue::popSlot(SystemFlags::DebugType &type, string &entry, time_t &entryTime) {
+	Slot &slot = slots[dequeuePos & (slotCount - 1)];
+	uint32 sequence = slot.sequence;
+	memoryBarrier();
+	if((int32)(sequence - (dequeuePos + 1)) < 0) {
+		return false;
+	}
+
+	type = slot.type;
+	entryTime = slot.entryTime;
+	entry = formatRecord(slot);
+	if(slot.heapText != NULL) {
+		delete [] slot.heapText;
+		slot.heapText = NULL;
+	}
+
+	memoryBarrier();
+	slot.sequence = dequeuePos + slotCount;
+	dequeuePos++;
+	return true;
+}
+
+bool LogRecordQueue::pop(SystemFlags::DebugType &type, string &entry, time_t &entryTime) {
+	// Records in the slots are older than the ones that spilled over
+	if(popSlot(type, entry, entryTime) == true) {
+		return true;
+	}
+	if(overflowActive == false) {
+		return false;
+	}
+
+	MutexSafeWrapper safeMutex(&mutexOverflow,CODE_AT_LINE);
+	// A producer claimed a slot before it saw the overflow
+	if(enqueuePos != dequeuePos) {
+		return false;
+	}
+	if(overflowRecords.empty() == true) {
+		overflowActive = false;
+		return false;
+	}
+
+	OverflowRecord &record = overflowRecords.front();
+	type = record.type;
+	entryTime = record.entryTime;
+	entry = record.entry;
+	overflowRecords.pop_front();
+	overflowCount = overflowCount - 1;
+	// Caught up, the next records use the slots
+	if(overflowRecords.empty() == true) {
+		overflowActive = false;
+	}
+	return true;
+}
+
+std::size_t LogRecordQueue::getCount() {
+	int32 count = (int32)(enqueuePos - dequeuePos);
+	return (count > 0 ? count : 0) + overflowCount;
+}
+
+int LogRecordQueue::getFormatCount() {
+	return formatCount;
+}
+
+int LogRecordQueue::takeDroppedCount(SystemFlags::DebugType type) {
+	return atomicExchange(&rateLimits[type].dropped, 0);
+}
+
+int LogRecordQueue::getOverflowTotal() {
+	return overflowTotal;
+}
+
+}}//end namespace
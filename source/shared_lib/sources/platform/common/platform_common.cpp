@@ -554,6 +554,38 @@ string formatPath(string path) {
   return path;
 }
 
+string getCanonicalPath(const string &path) {
+	string cleanPath = path;
+	replaceAll(cleanPath, "\\", "/");
+#ifdef WIN32
+	cleanPath = toLower(cleanPath);
+#endif
+
+	vector<string> parts;
+	Tokenize(cleanPath,parts,"/");
+	vector<string> canonicalParts;
+	for(unsigned int i = 0; i < parts.size(); ++i) {
+		if(parts[i] == "" || parts[i] == ".") {
+			continue;
+		}
+		if(parts[i] == ".." && canonicalParts.empty() == false && canonicalParts.back() != "..") {
+			canonicalParts.pop_back();
+		}
+		else {
+			canonicalParts.push_back(parts[i]);
+		}
+	}
+
+	string result = (StartsWith(cleanPath, "/") == true ? "/" : "");
+	for(unsigned int i = 0; i < canonicalParts.size(); ++i) {
+		if(i > 0) {
+			result += "/";
+		}
+		result += canonicalParts[i];
+	}
+	return result;
+}
+
 void trimPathWithStartingSlash(string &path) {
 	if(StartsWith(path, "/") == true || StartsWith(path, "\\") == true) {
 		path.erase(path.begin(),path.begin()+1);
@@ -978,6 +1010,9 @@ uint32 getFolderTreeContentsCheckSumRecursively(vector<string> paths, string pat
 	crcTreeCache[cacheKey] = result;
 	writeCachedFileCRCValue(crcCacheFile, crcTreeCache[cacheKey],getCRCCacheFileName(cacheKeys));
 	//}
+	if(recursiveChecksum == NULL) {
+		Checksum::flushFileIndex();
+	}
 	return result;
 }
 
@@ -1138,6 +1173,7 @@ uint32 getFolderTreeContentsCheckSumRecursively(const string &path, const string
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s] scanning [%s] ending checksum = %d for cacheKey [%s] fileMatchCount = %d, fileLoopCount = %d\n",__FILE__,__FUNCTION__,path.c_str(),crcTreeCache[cacheKey],cacheKey.c_str(),fileMatchCount,fileLoopCount);
 		writeCachedFileCRCValue(crcCacheFile, crcTreeCache[cacheKey],getCRCCacheFileName(cacheKeys));
 		//}
+		Checksum::flushFileIndex();
 
 		return result;
 	}
@@ -1204,6 +1240,7 @@ vector<std::pair<string,uint32> > getFolderTreeContentsCheckSumListRecursively(v
 
 	if(topLevelCaller == true) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] EXITING TOP LEVEL RECURSION, checksumFiles.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,checksumFiles.size());
+		Checksum::flushFileIndex();
 	}
 
 	crcTreeCache[cacheKey] = checksumFiles;
@@ -1449,6 +1486,7 @@ vector<std::pair<string,uint32> > getFolderTreeContentsCheckSumListRecursively(c
 
 	if(topLevelCaller == true) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] EXITING TOP LEVEL RECURSION, checksumFiles.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,checksumFiles.size());
+		Checksum::flushFileIndex();
 	}
 
     return crcTreeCache[cacheKey];
@@ -65,7 +65,7 @@ FileCRCPreCacheThread::~FileCRCPreCacheThread() {
 }
 
 void FileCRCPreCacheThread::setPauseForGame(bool pauseForGame) {
-	static string mutexOwnerId = CODE_AT_LINE;
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexPauseForGame,mutexOwnerId);
 	this->pauseForGame = pauseForGame;
 
@@ -78,7 +78,7 @@ void FileCRCPreCacheThread::setPauseForGame(bool pauseForGame) {
 }
 
 bool FileCRCPreCacheThread::getPauseForGame() {
-	static string mutexOwnerId = CODE_AT_LINE;
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexPauseForGame,mutexOwnerId);
 	return this->pauseForGame;
 }
@@ -178,10 +178,10 @@ void FileCRCPreCacheThread::execute() {
 									new FileCRCPreCacheThread(techDataPaths,
 											workerTechList,
 											this->processTechCB);
-							static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+							static const char *mutexOwnerId = CODE_AT_LINE;
 							workerThread->setUniqueID(mutexOwnerId);
 							workerThread->setPauseForGame(this->getPauseForGame());
-							static string mutexOwnerId2 = CODE_AT_LINE;
+							static const char *mutexOwnerId2 = CODE_AT_LINE;
 							MutexSafeWrapper safeMutexPause(mutexPauseForGame,mutexOwnerId2);
 							preCacheWorkerThreadList.push_back(workerThread);
 							safeMutexPause.ReleaseLock();
@@ -228,7 +228,7 @@ void FileCRCPreCacheThread::execute() {
 									else if(workerThread->getRunningStatus() == false) {
 										sleep(25);
 
-										static string mutexOwnerId2 = CODE_AT_LINE;
+										static const char *mutexOwnerId2 = CODE_AT_LINE;
 										MutexSafeWrapper safeMutexPause(mutexPauseForGame,mutexOwnerId2);
 
 										delete workerThread;
@@ -262,6 +262,9 @@ void FileCRCPreCacheThread::execute() {
 			            if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] unknown error\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 			        }
 
+					Checksum::flushFileIndex();
+					if(SystemFlags::VERBOSE_MODE_ENABLED) printf("%s\n",Checksum::getStats().getReport().c_str());
+					if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] %s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,Checksum::getStats().getReport().c_str());
 					if(SystemFlags::VERBOSE_MODE_ENABLED) printf("********************** CRC Controller thread took %.2f seconds END **********************\n",difftime(time(NULL),elapsedTime));
                 }
             }
@@ -410,13 +413,13 @@ SimpleTaskThread::SimpleTaskThread(	SimpleTaskCallbackInterface *simpleTaskInter
 
 	setTaskSignalled(false);
 
-	string mutexOwnerId = CODE_AT_LINE;
+	const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexLastExecuteTimestamp,mutexOwnerId);
 	mutexLastExecuteTimestamp->setOwnerId(mutexOwnerId);
 	lastExecuteTimestamp = time(NULL);
 
 	if(this->wantSetupAndShutdown == true) {
-		string mutexOwnerId1 = CODE_AT_LINE;
+		const char *mutexOwnerId1 = CODE_AT_LINE;
 		MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid,mutexOwnerId1);
 		if(this->simpleTaskInterfaceValid == true) {
 			safeMutex1.ReleaseLock();
@@ -460,7 +463,7 @@ void SimpleTaskThread::cleanup() {
 		}
 		else if(this->simpleTaskInterface != NULL) {
 			//printf("~SimpleTaskThread LINE: %d this = %p\n",__LINE__,this);
-			string mutexOwnerId1 = CODE_AT_LINE;
+			const char *mutexOwnerId1 = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid,mutexOwnerId1);
 			//printf("~SimpleTaskThread LINE: %d this = %p\n",__LINE__,this);
 			if(this->simpleTaskInterfaceValid == true) {
@@ -481,7 +484,7 @@ void SimpleTaskThread::setOverrideShutdownTask(taskFunctionCallback *ptr) {
 }
 
 bool SimpleTaskThread::isThreadExecutionLagging() {
-	string mutexOwnerId = CODE_AT_LINE;
+	const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexLastExecuteTimestamp,mutexOwnerId);
 	mutexLastExecuteTimestamp->setOwnerId(mutexOwnerId);
 	bool result = (difftime(time(NULL),lastExecuteTimestamp) >= 5.0);
@@ -502,13 +505,13 @@ bool SimpleTaskThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
 }
 
 bool SimpleTaskThread::getSimpleTaskInterfaceValid() {
-	string mutexOwnerId1 = CODE_AT_LINE;
+	const char *mutexOwnerId1 = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid,mutexOwnerId1);
 
 	return this->simpleTaskInterfaceValid;
 }
 void SimpleTaskThread::setSimpleTaskInterfaceValid(bool value) {
-	string mutexOwnerId1 = CODE_AT_LINE;
+	const char *mutexOwnerId1 = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid,mutexOwnerId1);
 
 	this->simpleTaskInterfaceValid = value;
@@ -532,7 +535,7 @@ void SimpleTaskThread::execute() {
 
             unsigned int idx = 0;
             for(;this->simpleTaskInterface != NULL;) {
-        		string mutexOwnerId1 = CODE_AT_LINE;
+        		const char *mutexOwnerId1 = CODE_AT_LINE;
         		MutexSafeWrapper safeMutex1(mutexSimpleTaskInterfaceValid,mutexOwnerId1);
         		if(this->simpleTaskInterfaceValid == false) {
         			break;
@@ -561,7 +564,7 @@ void SimpleTaskThread::execute() {
                         if(getQuitStatus() == true) {
                         	break;
                         }
-                        string mutexOwnerId = CODE_AT_LINE;
+                        const char *mutexOwnerId = CODE_AT_LINE;
                         MutexSafeWrapper safeMutex(mutexLastExecuteTimestamp,mutexOwnerId);
                         mutexLastExecuteTimestamp->setOwnerId(mutexOwnerId);
                     	lastExecuteTimestamp = time(NULL);
@@ -612,7 +615,7 @@ void SimpleTaskThread::execute() {
 }
 
 void SimpleTaskThread::setTaskSignalled(bool value) {
-	string mutexOwnerId = CODE_AT_LINE;
+	const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexTaskSignaller,mutexOwnerId);
 	mutexTaskSignaller->setOwnerId(mutexOwnerId);
 	taskSignalled = value;
@@ -620,7 +623,7 @@ void SimpleTaskThread::setTaskSignalled(bool value) {
 }
 
 bool SimpleTaskThread::getTaskSignalled() {
-	string mutexOwnerId = CODE_AT_LINE;
+	const char *mutexOwnerId = CODE_AT_LINE;
 	MutexSafeWrapper safeMutex(mutexTaskSignaller,mutexOwnerId);
 	mutexTaskSignaller->setOwnerId(mutexOwnerId);
 	bool retval = taskSignalled;
@@ -631,160 +634,77 @@ bool SimpleTaskThread::getTaskSignalled() {
 
 // -------------------------------------------------
 
-LogFileThread::LogFileThread() : BaseThread(), mutexLogList(new Mutex(CODE_AT_LINE)) {
-	uniqueID = "LogFileThread";
+LogFileWriter::LogFileWriter() {
     logList.clear();
     lastSaveToDisk = time(NULL);
-    static string mutexOwnerId = CODE_AT_LINE;
-    mutexLogList->setOwnerId(mutexOwnerId);
+    unflushedEntries = false;
 }
 
-LogFileThread::~LogFileThread() {
-
-	delete mutexLogList;
-	mutexLogList = NULL;
-
-	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("#1 In [%s::%s Line: %d] LogFile thread is deleting\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-}
-
-void LogFileThread::addLogEntry(SystemFlags::DebugType type, string logEntry) {
-	static string mutexOwnerId = CODE_AT_LINE;
-    MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
-    mutexLogList->setOwnerId(mutexOwnerId);
-	LogFileEntry entry;
-	entry.type = type;
-	entry.entry = logEntry;
-	entry.entryDateTime = time(NULL);
-	logList.push_back(entry);
-
-    //if(logList.size() >= 750000) {
-    //    saveToDisk(false,true);
-    //}
-}
-
-bool LogFileThread::checkSaveCurrentLogBufferToDisk() {
-    bool ret = false;
-    if(difftime(time(NULL),lastSaveToDisk) >= 5 ||
-       LogFileThread::getLogEntryBufferCount() >= 1000000) {
-        lastSaveToDisk = time(NULL);
-        ret = true;
-    }
-    return ret;
+LogFileWriter::~LogFileWriter() {
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("#1 In [%s::%s Line: %d] LogFile writer is deleting\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 }
 
-void LogFileThread::execute() {
-	void *ptr_cpy = this->ptr;
-    bool mustDeleteSelf = false;
-    {
-        RunningStatusSafeWrapper runningStatus(this);
-        if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-        if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-
-        if(getQuitStatus() == true) {
-            deleteSelfIfRequired();
-            return;
-        }
-
-        if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-        if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"LogFile thread is running\n");
-
-        try	{
-        	ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
-            for(;this->getQuitStatus() == false;) {
-                while(this->getQuitStatus() == false &&
-                	  checkSaveCurrentLogBufferToDisk() == true) {
-                    saveToDisk(false,false);
-                }
-                if(this->getQuitStatus() == false) {
-                    sleep(25);
-                }
-            }
-
-            // Ensure remaining entryies are logged to disk on shutdown
-            if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-            saveToDisk(true,false);
-            if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-        }
-        catch(const exception &ex) {
-            if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
-        }
-        catch(...) {
-            if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] UNKNOWN Error\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-        }
-
-        if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] LogFile thread is starting to exit\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-
-        mustDeleteSelf = getDeleteSelfOnExecutionDone();
-        if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] LogFile thread is exiting, mustDeleteSelf = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,mustDeleteSelf);
-    }
-    if(mustDeleteSelf == true) {
-    	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] LogFile thread is deleting self\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-    	if(isThreadDeleted(ptr_cpy) == false) {
-    		this->setDeleteAfterExecute(true);
-    	}
-        return;
-    }
+void LogFileWriter::addLogEntry(SystemFlags::DebugType type, const char *fmt, va_list argList) {
+	logQueue.push(type, fmt, argList);
 }
 
-std::size_t LogFileThread::getLogEntryBufferCount() {
-	static string mutexOwnerId = CODE_AT_LINE;
-    MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
-    mutexLogList->setOwnerId(mutexOwnerId);
-    std::size_t logCount = logList.size();
-    safeMutex.ReleaseLock();
-    return logCount;
+void LogFileWriter::simpleTask(BaseThread *callingThread,void *userdata) {
+	for(int batch = 0; batch < maxBatchesPerSave; ++batch) {
+		saveToDisk(false);
+		if(logQueue.getCount() == 0) {
+			break;
+		}
+	}
 }
 
-bool LogFileThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
-	bool ret = (getExecutingTask() == false);
-	if(ret == false && deleteSelfIfShutdownDelayed == true) {
-	    setDeleteSelfOnExecutionDone(deleteSelfIfShutdownDelayed);
-	    deleteSelfIfRequired();
-	    signalQuit();
+void LogFileWriter::flush() {
+	// Ensure remaining entries are logged to disk on shutdown
+	for(;logQueue.getCount() > 0;) {
+		saveToDisk(false);
 	}
-
-	return ret;
+	saveToDisk(true);
 }
 
-void LogFileThread::saveToDisk(bool forceSaveAll,bool logListAlreadyLocked) {
-	static string mutexOwnerId = CODE_AT_LINE;
-    MutexSafeWrapper safeMutex(NULL,mutexOwnerId);
-    if(logListAlreadyLocked == false) {
-        safeMutex.setMutex(mutexLogList);
-        mutexLogList->setOwnerId(mutexOwnerId);
-    }
+std::size_t LogFileWriter::getLogEntryBufferCount() {
+    return logQueue.getCount();
+}
 
-    std::size_t logCount = logList.size();
-    if(logCount > 0) {
-        vector<LogFileEntry> tempLogList = logList;
-        safeMutex.ReleaseLock(true);
+void LogFileWriter::saveToDisk(bool forceFlush) {
+	logQueue.setRateLimit(SystemFlags::THREADED_LOGGING_RATE_LIMIT);
 
-        logCount = tempLogList.size();
-        //if(forceSaveAll == false) {
-        //    logCount = min(logCount,(std::size_t)2000000);
-        //}
+	// Format a batch first so the producers get their slots back
+	logList.clear();
+	LogFileEntry entry;
+	for(;logList.size() < (size_t)LogRecordQueue::slotCount &&
+		logQueue.pop(entry.type, entry.entry, entry.entryDateTime) == true;) {
+		logList.push_back(entry);
+	}
+	for(int type = 0; type < LogRecordQueue::categoryCount; ++type) {
+		int droppedCount = logQueue.takeDroppedCount((SystemFlags::DebugType)type);
+		if(droppedCount > 0) {
+			char szBuf[8096]="";
+			snprintf(szBuf,8096,"Dropped %d log entries over the limit of %d per second\n",droppedCount,logQueue.getRateLimit());
+			entry.type = (SystemFlags::DebugType)type;
+			entry.entry = szBuf;
+			entry.entryDateTime = time(NULL);
+			logList.push_back(entry);
+		}
+	}
 
-        if(logCount > 0) {
-            for(unsigned int i = 0; i < logCount; ++i) {
-                LogFileEntry &entry = tempLogList[i];
-                SystemFlags::logDebugEntry(entry.type, entry.entry, entry.entryDateTime);
-            }
+	for(unsigned int index = 0; index < logList.size(); ++index) {
+		LogFileEntry &logEntry = logList[index];
+		SystemFlags::logDebugEntry(logEntry.type, logEntry.entry, logEntry.entryDateTime, false);
+	}
+	if(logList.empty() == false) {
+		unflushedEntries = true;
+	}
 
-            safeMutex.Lock();
-            if(logList.size() > 0) {
-				if(logList.size() < logCount) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"logList.size() <= logCount [%lld][%lld]",(long long int)logList.size(),(long long int)logCount);
-					throw megaglest_runtime_error(szBuf);
-				}
-				logList.erase(logList.begin(),logList.begin() + logCount);
-            }
-            safeMutex.ReleaseLock();
-        }
-    }
-    else {
-        safeMutex.ReleaseLock();
-    }
+	if(unflushedEntries == true &&
+		(forceFlush == true || difftime(time(NULL),lastSaveToDisk) >= 1)) {
+		SystemFlags::flushDebugLogs();
+		lastSaveToDisk = time(NULL);
+		unflushedEntries = false;
+	}
 }
 
 }}//end namespace
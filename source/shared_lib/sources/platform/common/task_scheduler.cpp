@@ -0,0 +1,426 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "task_scheduler.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "conversion.h"
+#include "util.h"
+#include <algorithm>
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+
+namespace Shared { namespace PlatformCommon {
+
+// =====================================================
+//	class TaskSchedulerStats
+// =====================================================
+
+TaskSchedulerStats::TaskSchedulerStats() {
+	runCount = 0;
+	lateRunCount = 0;
+	totalMicros = 0;
+	maxMicros = 0;
+	lastMicros = 0;
+}
+
+// =====================================================
+//	class TaskSchedulerThread
+// =====================================================
+
+TaskSchedulerThread::TaskSchedulerThread(TaskScheduler *scheduler) : BaseThread() {
+	this->scheduler = scheduler;
+	uniqueID = "TaskSchedulerWorkerThread";
+}
+
+void TaskSchedulerThread::execute() {
+	{
+		RunningStatusSafeWrapper runningStatus(this);
+		if(getQuitStatus() == true) {
+			return;
+		}
+
+		try {
+			scheduler->runWorker(this);
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		}
+	}
+	deleteSelfIfRequired();
+}
+
+// =====================================================
+//	class TaskScheduler
+// =====================================================
+
+TaskScheduler::ScheduledTask::ScheduledTask() {
+	id = -1;
+	callback = NULL;
+	userdata = NULL;
+	millisecsBetweenExecutions = 0;
+	executionCount = 0;
+	dueTick = 0;
+	running = false;
+	cancelled = false;
+}
+
+TaskScheduler::TaskScheduler(int workerThreadCount) : mutexTasks(CODE_AT_LINE),
+		wheel(wheelSlotCount) {
+	nextTaskId = 1;
+	clockMillis = 0;
+	lastClockTicks = (uint32)Chrono::getCurMillis();
+	lastTimerTick = 0;
+	timerWakeTick = -1;
+	this->workerThreadCount = max(workerThreadCount, 1);
+	idleWorkerCount = 0;
+	runningTaskCount = 0;
+	shuttingDown = false;
+}
+
+TaskScheduler::~TaskScheduler() {
+	shutdown(5000);
+}
+
+TaskScheduler & TaskScheduler::getInstance() {
+	static TaskScheduler scheduler;
+	return scheduler;
+}
+
+// Callers hold mutexTasks
+int64 TaskScheduler::getCurrentTick() {
+	uint32 ticks = (uint32)Chrono::getCurMillis();
+	clockMillis += (uint32)(ticks - lastClockTicks);
+	lastClockTicks = ticks;
+	return clockMillis / tickMillis;
+}
+
+// Callers hold mutexTasks
+void TaskScheduler::startWorkerThread() {
+	if(shuttingDown == true || (int)workerThreads.size() >= workerThreadCount) {
+		return;
+	}
+	TaskSchedulerThread *workerThread = new TaskSchedulerThread(this);
+	workerThreads.push_back(workerThread);
+	workerThread->start();
+}
+
+void TaskScheduler::addToWheel(ScheduledTask &task) {
+	int64 ticks = max<int64>(1, (task.millisecsBetweenExecutions + tickMillis - 1) / tickMillis);
+	task.dueTick = getCurrentTick() + ticks;
+	wheel[task.dueTick % wheelSlotCount].push_back(task.id);
+
+	// Wake an idle worker when it sleeps past the new due time, a busy
+	// one looks at the wheel again after its run
+	if(idleWorkerCount > 0 && (timerWakeTick < 0 || task.dueTick < timerWakeTick)) {
+		timerWakeTick = task.dueTick;
+		workerSignal.signal();
+	}
+}
+
+void TaskScheduler::removeFromWheel(const ScheduledTask &task) {
+	vector<int> &slot = wheel[task.dueTick % wheelSlotCount];
+	slot.erase(std::remove(slot.begin(), slot.end(), task.id), slot.end());
+}
+
+void TaskScheduler::removeFromReadyTasks(int taskId) {
+	readyTasks.erase(std::remove(readyTasks.begin(), readyTasks.end(), taskId), readyTasks.end());
+}
+
+// Callers hold mutexTasks
+void TaskScheduler::collectDueTasks(int64 currentTick) {
+	// Move the tasks of the slots passed since the last look to the ready
+	// list, a task stays in its slot until the turn it is due in
+	int64 slotsToCheck = min<int64>(currentTick - lastTimerTick, wheelSlotCount);
+	for(int64 tick = currentTick - slotsToCheck + 1; tick <= currentTick; ++tick) {
+		vector<int> &slot = wheel[tick % wheelSlotCount];
+		for(unsigned int index = 0; index < slot.size();) {
+			std::map<int,ScheduledTask>::iterator iterFind = tasks.find(slot[index]);
+			if(iterFind == tasks.end() || iterFind->second.dueTick <= currentTick) {
+				if(iterFind != tasks.end()) {
+					readyTasks.push_back(slot[index]);
+				}
+				slot[index] = slot.back();
+				slot.pop_back();
+			}
+			else {
+				index++;
+			}
+		}
+	}
+	lastTimerTick = max(lastTimerTick, currentTick);
+}
+
+// Callers hold mutexTasks, returns -1 when no task is waiting
+int64 TaskScheduler::getNextWakeTick(int64 currentTick) {
+	// The first slot with a task due in this turn
+	bool haveWaitingTasks = false;
+	for(int offset = 1; offset <= wheelSlotCount; ++offset) {
+		const vector<int> &slot = wheel[(currentTick + offset) % wheelSlotCount];
+		for(unsigned int index = 0; index < slot.size(); ++index) {
+			haveWaitingTasks = true;
+			std::map<int,ScheduledTask>::const_iterator iterFind = tasks.find(slot[index]);
+			if(iterFind != tasks.end() && iterFind->second.dueTick == currentTick + offset) {
+				return currentTick + offset;
+			}
+		}
+	}
+	return (haveWaitingTasks == true ? currentTick + wheelSlotCount : -1);
+}
+
+void TaskScheduler::runWorker(BaseThread *callingThread) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	for(;callingThread->getQuitStatus() == false;) {
+		int64 currentTick = getCurrentTick();
+		collectDueTasks(currentTick);
+
+		// Nothing due, keep the timer until the next task is
+		if(readyTasks.empty() == true) {
+			int64 wakeTick = getNextWakeTick(currentTick);
+			timerWakeTick = wakeTick;
+			int waitMilliseconds = (wakeTick < 0 ? -1 : max<int>(0, (int)(wakeTick * tickMillis - clockMillis)));
+			idleWorkerCount++;
+			safeMutex.ReleaseLock(true);
+
+			workerSignal.waitTillSignalled(waitMilliseconds);
+
+			safeMutex.Lock();
+			idleWorkerCount--;
+			continue;
+		}
+
+		int taskId = readyTasks.front();
+		readyTasks.pop_front();
+		std::map<int,ScheduledTask>::iterator iterFind = tasks.find(taskId);
+		if(iterFind == tasks.end()) {
+			continue;
+		}
+		ScheduledTask &task = iterFind->second;
+		task.running = true;
+		runningTaskCount++;
+		if(currentTick > task.dueTick + 1) {
+			task.stats.lateRunCount++;
+		}
+		SimpleTaskCallbackInterface *callback = task.callback;
+		void *userdata = task.userdata;
+		string taskName = task.stats.name;
+
+		// Somebody has to watch the other tasks while this one runs
+		if((int)tasks.size() > runningTaskCount) {
+			if(idleWorkerCount > 0) {
+				if(readyTasks.empty() == false) {
+					workerSignal.signal();
+				}
+			}
+			else {
+				startWorkerThread();
+			}
+		}
+		safeMutex.ReleaseLock(true);
+
+		Chrono chrono(true);
+		try {
+			ExecutingTaskSafeWrapper safeExecutingTaskMutex(callingThread);
+			callback->simpleTask(callingThread,userdata);
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s] in task [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what(),taskName.c_str());
+		}
+		int64 elapsedMicros = chrono.getMicros();
+
+		// A task is not erased while it runs, task is still valid
+		safeMutex.Lock();
+		task.running = false;
+		runningTaskCount--;
+		task.stats.runCount++;
+		task.stats.lastMicros = elapsedMicros;
+		task.stats.totalMicros += elapsedMicros;
+		task.stats.maxMicros = max(task.stats.maxMicros, elapsedMicros);
+
+		if(task.cancelled == true ||
+			(task.executionCount > 0 && task.stats.runCount >= task.executionCount)) {
+			tasks.erase(iterFind);
+		}
+		else {
+			// Like a SimpleTaskThread the pause starts after the run
+			addToWheel(task);
+		}
+	}
+}
+
+int TaskScheduler::scheduleTask(SimpleTaskCallbackInterface *callback,
+								unsigned int millisecsBetweenExecutions,
+								unsigned int executionCount,
+								void *userdata, const string &name) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	if(shuttingDown == true || callback == NULL) {
+		return -1;
+	}
+	if(workerThreads.empty() == true) {
+		startWorkerThread();
+	}
+
+	ScheduledTask &task = tasks[nextTaskId];
+	task.id = nextTaskId++;
+	task.callback = callback;
+	task.userdata = userdata;
+	task.millisecsBetweenExecutions = millisecsBetweenExecutions;
+	task.executionCount = executionCount;
+	task.stats.name = (name != "" ? name : "task " + intToStr(task.id));
+	addToWheel(task);
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] scheduled [%s] every %u msecs\n",__FILE__,__FUNCTION__,__LINE__,task.stats.name.c_str(),millisecsBetweenExecutions);
+	return task.id;
+}
+
+bool TaskScheduler::cancelTask(int taskId, int waitMilliseconds) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	std::map<int,ScheduledTask>::iterator iterFind = tasks.find(taskId);
+	if(iterFind == tasks.end()) {
+		return true;
+	}
+	if(iterFind->second.running == false) {
+		removeFromWheel(iterFind->second);
+		removeFromReadyTasks(taskId);
+		tasks.erase(iterFind);
+		return true;
+	}
+
+	// The worker drops the task once the current run is done. Called from
+	// the task itself waitMilliseconds must be 0.
+	iterFind->second.cancelled = true;
+	safeMutex.ReleaseLock();
+
+	Chrono chrono(true);
+	for(;;) {
+		MutexSafeWrapper safeMutexRunning(&mutexTasks,CODE_AT_LINE);
+		bool stillRunning = (tasks.find(taskId) != tasks.end());
+		safeMutexRunning.ReleaseLock();
+		if(stillRunning == false) {
+			return true;
+		}
+		if(waitMilliseconds >= 0 && chrono.getMillis() >= waitMilliseconds) {
+			return false;
+		}
+		sleep(1);
+	}
+}
+
+bool TaskScheduler::runTaskNow(int taskId) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	std::map<int,ScheduledTask>::iterator iterFind = tasks.find(taskId);
+	if(iterFind == tasks.end() || iterFind->second.cancelled == true) {
+		return false;
+	}
+	ScheduledTask &task = iterFind->second;
+	if(task.running == false &&
+		std::find(readyTasks.begin(), readyTasks.end(), taskId) == readyTasks.end()) {
+		removeFromWheel(task);
+		task.dueTick = getCurrentTick();
+		readyTasks.push_back(taskId);
+		if(idleWorkerCount > 0) {
+			workerSignal.signal();
+		}
+		else {
+			startWorkerThread();
+		}
+	}
+	return true;
+}
+
+bool TaskScheduler::isTaskScheduled(int taskId) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	std::map<int,ScheduledTask>::iterator iterFind = tasks.find(taskId);
+	return (iterFind != tasks.end() && iterFind->second.cancelled == false);
+}
+
+bool TaskScheduler::getTaskStats(int taskId, TaskSchedulerStats &stats) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	std::map<int,ScheduledTask>::iterator iterFind = tasks.find(taskId);
+	if(iterFind == tasks.end()) {
+		return false;
+	}
+	stats = iterFind->second.stats;
+	return true;
+}
+
+string TaskScheduler::getStatsReport() {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	string result = "Scheduled tasks: " + intToStr((int)tasks.size()) + " on " +
+			intToStr((int)workerThreads.size()) + " threads\n";
+	for(std::map<int,ScheduledTask>::const_iterator iterMap = tasks.begin();
+		iterMap != tasks.end(); ++iterMap) {
+		const TaskSchedulerStats &stats = iterMap->second.stats;
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"%s: runs %u late %u total " MG_I64_SPECIFIER " usecs max " MG_I64_SPECIFIER " usecs last " MG_I64_SPECIFIER " usecs\n",
+				stats.name.c_str(),stats.runCount,stats.lateRunCount,stats.totalMicros,stats.maxMicros,stats.lastMicros);
+		result += szBuf;
+	}
+	return result;
+}
+
+int TaskScheduler::getThreadCount() {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	return (int)workerThreads.size();
+}
+
+bool TaskScheduler::shutdown(int timeoutMilliseconds) {
+	MutexSafeWrapper safeMutex(&mutexTasks,CODE_AT_LINE);
+	shuttingDown = true;
+	for(std::map<int,ScheduledTask>::iterator iterMap = tasks.begin();
+		iterMap != tasks.end();) {
+		if(iterMap->second.running == true) {
+			iterMap->second.cancelled = true;
+			++iterMap;
+		}
+		else {
+			tasks.erase(iterMap++);
+		}
+	}
+	for(unsigned int index = 0; index < wheel.size(); ++index) {
+		wheel[index].clear();
+	}
+	readyTasks.clear();
+
+	vector<TaskSchedulerThread *> threads = workerThreads;
+	workerThreads.clear();
+	threads.insert(threads.end(), stoppingThreads.begin(), stoppingThreads.end());
+	stoppingThreads.clear();
+	safeMutex.ReleaseLock();
+
+	for(unsigned int index = 0; index < threads.size(); ++index) {
+		threads[index]->signalQuit();
+		workerSignal.signal();
+	}
+
+	bool result = true;
+	Chrono chrono(true);
+	for(unsigned int index = 0; index < threads.size(); ++index) {
+		for(;threads[index]->isExecuteComplete() == false &&
+			chrono.getMillis() < timeoutMilliseconds;) {
+			sleep(1);
+		}
+		if(threads[index]->isExecuteComplete() == true) {
+			delete threads[index];
+		}
+		else {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] thread [%s] did not stop within %d msecs\n",__FILE__,__FUNCTION__,__LINE__,threads[index]->getUniqueID().c_str(),timeoutMilliseconds);
+			MutexSafeWrapper safeMutexStopping(&mutexTasks,CODE_AT_LINE);
+			stoppingThreads.push_back(threads[index]);
+			result = false;
+		}
+	}
+	return result;
+}
+
+}}//end namespace
@@ -218,7 +218,7 @@ int file_progress(struct FtpFile *out,double download_total, double download_now
          stats.currentFilename  = out->currentFilename;
          stats.downloadType		= out->downloadType;
 
-         static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+         static const char *mutexOwnerId = CODE_AT_LINE;
          MutexSafeWrapper safeMutex(out->ftpServer->getProgressMutex(),mutexOwnerId);
          out->ftpServer->getProgressMutex()->setOwnerId(mutexOwnerId);
          out->ftpServer->getCallBackObject()->FTPClient_CallbackEvent(
@@ -397,7 +397,7 @@ void FTPClientThread::getMapFromServer(pair<string,string> mapFileName) {
 		}
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     if(this->pCBObject != NULL) {
@@ -411,7 +411,7 @@ void FTPClientThread::getMapFromServer(pair<string,string> mapFileName) {
 
 void FTPClientThread::addMapToRequests(string mapFilename,string URL) {
 	std::pair<string,string> item = make_pair(mapFilename,URL);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(&mutexMapFileList,mutexOwnerId);
     mutexMapFileList.setOwnerId(mutexOwnerId);
     if(std::find(mapFileList.begin(),mapFileList.end(),item) == mapFileList.end()) {
@@ -421,7 +421,7 @@ void FTPClientThread::addMapToRequests(string mapFilename,string URL) {
 
 void FTPClientThread::addTilesetToRequests(string tileSetName,string URL) {
 	std::pair<string,string> item = make_pair(tileSetName,URL);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(&mutexTilesetList,mutexOwnerId);
     mutexTilesetList.setOwnerId(mutexOwnerId);
     if(std::find(tilesetList.begin(),tilesetList.end(),item) == tilesetList.end()) {
@@ -431,7 +431,7 @@ void FTPClientThread::addTilesetToRequests(string tileSetName,string URL) {
 
 void FTPClientThread::addTechtreeToRequests(string techtreeName,string URL) {
 	std::pair<string,string> item = make_pair(techtreeName,URL);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(&mutexTechtreeList,mutexOwnerId);
     mutexTechtreeList.setOwnerId(mutexOwnerId);
     if(std::find(techtreeList.begin(),techtreeList.end(),item) == techtreeList.end()) {
@@ -441,7 +441,7 @@ void FTPClientThread::addTechtreeToRequests(string techtreeName,string URL) {
 
 void FTPClientThread::addScenarioToRequests(string fileName,string URL) {
 	std::pair<string,string> item = make_pair(fileName,URL);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(&mutexScenarioList,mutexOwnerId);
     mutexScenarioList.setOwnerId(mutexOwnerId);
     if(std::find(scenarioList.begin(),scenarioList.end(),item) == scenarioList.end()) {
@@ -451,7 +451,7 @@ void FTPClientThread::addScenarioToRequests(string fileName,string URL) {
 
 void FTPClientThread::addFileToRequests(string fileName,string URL) {
 	std::pair<string,string> item = make_pair(fileName,URL);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(&mutexFileList,mutexOwnerId);
     mutexFileList.setOwnerId(mutexOwnerId);
     if(std::find(fileList.begin(),fileList.end(),item) == fileList.end()) {
@@ -461,7 +461,7 @@ void FTPClientThread::addFileToRequests(string fileName,string URL) {
 
 void FTPClientThread::addTempFileToRequests(string fileName,string URL) {
 	std::pair<string,string> item = make_pair(fileName,URL);
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(&mutexTempFileList,mutexOwnerId);
     mutexTempFileList.setOwnerId(mutexOwnerId);
     if(std::find(tempFileList.begin(),tempFileList.end(),item) == tempFileList.end()) {
@@ -500,7 +500,7 @@ void FTPClientThread::getTilesetFromServer(pair<string,string> tileSetName) {
 		}
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     if(this->pCBObject != NULL) {
@@ -593,7 +593,7 @@ pair<FTP_Client_ResultType,string> FTPClientThread::getTilesetFromServer(
 					destRootArchiveFolder,
 					destRootArchiveFolder + tileSetName.first + this->fileArchiveExtension);
 
-			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			static const char *mutexOwnerId = CODE_AT_LINE;
 		    MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
 		    this->getProgressMutex()->setOwnerId(mutexOwnerId);
 
@@ -675,7 +675,7 @@ void FTPClientThread::getTechtreeFromServer(pair<string,string> techtreeName) {
 		}
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     if(this->pCBObject != NULL) {
@@ -719,7 +719,7 @@ pair<FTP_Client_ResultType,string>  FTPClientThread::getTechtreeFromServer(pair<
         		destRootArchiveFolder,
         		destRootArchiveFolder + techtreeName.first + this->fileArchiveExtension);
 
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 	    MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
 	    this->getProgressMutex()->setOwnerId(mutexOwnerId);
 	    if(this->pCBObject != NULL) {
@@ -750,7 +750,7 @@ void FTPClientThread::getScenarioFromServer(pair<string,string> fileName) {
 		result = getScenarioInternalFromServer(fileName);
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     if(this->pCBObject != NULL) {
@@ -792,7 +792,7 @@ pair<FTP_Client_ResultType,string>  FTPClientThread::getScenarioInternalFromServ
         		destRootArchiveFolder,
         		destRootArchiveFolder + fileName.first + this->fileArchiveExtension);
 
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+		static const char *mutexOwnerId = CODE_AT_LINE;
 	    MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
 	    this->getProgressMutex()->setOwnerId(mutexOwnerId);
 	    if(this->pCBObject != NULL) {
@@ -828,7 +828,7 @@ void FTPClientThread::getFileFromServer(pair<string,string> fileName) {
 		result = getFileInternalFromServer(fileName);
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     if(this->pCBObject != NULL) {
@@ -882,7 +882,7 @@ void FTPClientThread::getTempFileFromServer(pair<string,string> fileName) {
 		result = getTempFileInternalFromServer(fileName);
 	}
 
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     if(this->pCBObject != NULL) {
@@ -1085,14 +1085,14 @@ pair<FTP_Client_ResultType,string>  FTPClientThread::getFileFromServer(FTP_Clien
 }
 
 FTPClientCallbackInterface * FTPClientThread::getCallBackObject() {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     return pCBObject;
 }
 
 void FTPClientThread::setCallBackObject(FTPClientCallbackInterface *value) {
-	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(this->getProgressMutex(),mutexOwnerId);
     this->getProgressMutex()->setOwnerId(mutexOwnerId);
     pCBObject = value;
@@ -1128,7 +1128,7 @@ void FTPClientThread::execute() {
 
         try	{
             while(this->getQuitStatus() == false) {
-            	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+            	static const char *mutexOwnerId = CODE_AT_LINE;
                 MutexSafeWrapper safeMutex(&mutexMapFileList,mutexOwnerId);
                 mutexMapFileList.setOwnerId(mutexOwnerId);
                 if(mapFileList.size() > 0) {
@@ -1146,7 +1146,7 @@ void FTPClientThread::execute() {
                     break;
                 }
 
-                static string mutexOwnerId2 = string(__FILE__) + string("_") + intToStr(__LINE__);
+                static const char *mutexOwnerId2 = CODE_AT_LINE;
                 MutexSafeWrapper safeMutex2(&mutexTilesetList,mutexOwnerId2);
                 mutexTilesetList.setOwnerId(mutexOwnerId2);
                 if(tilesetList.size() > 0) {
@@ -1160,7 +1160,7 @@ void FTPClientThread::execute() {
                     safeMutex2.ReleaseLock();
                 }
 
-                static string mutexOwnerId3 = string(__FILE__) + string("_") + intToStr(__LINE__);
+                static const char *mutexOwnerId3 = CODE_AT_LINE;
                 MutexSafeWrapper safeMutex3(&mutexTechtreeList,mutexOwnerId3);
                 mutexTechtreeList.setOwnerId(mutexOwnerId3);
                 if(techtreeList.size() > 0) {
@@ -1174,7 +1174,7 @@ void FTPClientThread::execute() {
                     safeMutex3.ReleaseLock();
                 }
 
-                static string mutexOwnerId4 = string(__FILE__) + string("_") + intToStr(__LINE__);
+                static const char *mutexOwnerId4 = CODE_AT_LINE;
                 MutexSafeWrapper safeMutex4(&mutexScenarioList,mutexOwnerId4);
                 mutexScenarioList.setOwnerId(mutexOwnerId4);
                 if(scenarioList.size() > 0) {
@@ -1188,7 +1188,7 @@ void FTPClientThread::execute() {
                     safeMutex4.ReleaseLock();
                 }
 
-                static string mutexOwnerId5 = string(__FILE__) + string("_") + intToStr(__LINE__);
+                static const char *mutexOwnerId5 = CODE_AT_LINE;
                 MutexSafeWrapper safeMutex5(&mutexFileList,mutexOwnerId5);
                 mutexFileList.setOwnerId(mutexOwnerId5);
                 if(fileList.size() > 0) {
@@ -1202,7 +1202,7 @@ void FTPClientThread::execute() {
                     safeMutex5.ReleaseLock();
                 }
 
-                static string mutexOwnerId6 = string(__FILE__) + string("_") + intToStr(__LINE__);
+                static const char *mutexOwnerId6 = CODE_AT_LINE;
                 MutexSafeWrapper safeMutex6(&mutexTempFileList,mutexOwnerId6);
                 mutexTempFileList.setOwnerId(mutexOwnerId6);
                 if(tempFileList.size() > 0) {
@@ -1913,7 +1913,7 @@ void ClientSocket::startBroadCastClientThread(DiscoveredServersInterface *cb) {
 
 	ClientSocket::stopBroadCastClientThread();
 
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	broadCastClientThread = new BroadCastClientSocketThread(cb);
 	broadCastClientThread->setUniqueID(mutexOwnerId);
 	broadCastClientThread->start();
@@ -2266,7 +2266,7 @@ void ServerSocket::startBroadCastThread() {
 
 	//printf("Start broadcast thread [%p]\n",broadCastThread);
 
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	static const char *mutexOwnerId = CODE_AT_LINE;
 	broadCastThread->setUniqueID(mutexOwnerId);
 	broadCastThread->start();
 
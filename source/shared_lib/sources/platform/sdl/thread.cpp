@@ -19,6 +19,11 @@
 #include "base_thread.h"
 #include "time.h"
 #include <memory>
+#include <map>
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
 
 using namespace std;
 
@@ -130,6 +135,7 @@ public:
 // =====================================
 Thread::Thread() : thread(NULL),
 		mutexthreadAccessor(new Mutex(CODE_AT_LINE)),
+		executeCompleteSignal(new Semaphore()),
 		deleteAfterExecute(false), currentState(thrsNew) {
 	addThreadToList();
 }
@@ -190,6 +196,21 @@ bool Thread::isThreadExecuteCompleteStatus() {
 	MutexSafeWrapper safeMutex(mutexthreadAccessor);
 	return (currentState == thrsExecuteComplete);
 }
+
+// Blocks on the signal raised when the thread function returns instead of
+// polling the thread state
+bool Thread::waitTillThreadExecuteComplete(int waitMilliseconds) {
+	if(isThreadExecuteCompleteStatus() == true) {
+		return true;
+	}
+	if(executeCompleteSignal->waitTillSignalled(waitMilliseconds) != 0) {
+		return isThreadExecuteCompleteStatus();
+	}
+	// Pass the signal on to any other waiter
+	executeCompleteSignal->signal();
+	return true;
+}
+
 Thread::~Thread() {
 	if(Thread::getEnableVerboseMode()) printf("In ~Thread Line: %d [%p] thread = %p\n",__LINE__,this,thread);
 
@@ -230,6 +251,8 @@ Thread::~Thread() {
 
 	delete mutexthreadAccessor;
 	mutexthreadAccessor = NULL;
+	delete executeCompleteSignal;
+	executeCompleteSignal = NULL;
 	if(Thread::getEnableVerboseMode()) printf("In ~Thread Line: %d [%p] thread = %p\n",__LINE__,this,thread);
 }
 
@@ -313,6 +336,10 @@ int Thread::beginExecution(void* data) {
 	thread->currentState = thrsExecuteComplete;
 	safeMutex.ReleaseLock();
 
+	// Last access to the thread object, the destructor joins the thread
+	// once the state above is complete
+	thread->executeCompleteSignal->signal();
+
 	return 0;
 }
 
@@ -438,7 +465,7 @@ public:
 const bool debugMutexLock 						= false;
 const int debugMutexLockMillisecondThreshold 	= 2000;
 
-Mutex::Mutex(string ownerId) {
+Mutex::Mutex(const char *ownerId) {
 	this->isStaticMutexListMutex 	= false;
 	this->mutexAccessor 			= SDL_CreateMutex();
 
@@ -448,6 +475,7 @@ Mutex::Mutex(string ownerId) {
 	this->refCount					= 0;
     this->ownerId 					= ownerId;
     this->lastownerId 				= "";
+    this->lockedAtMillis			= 0;
     this->mutex 					= SDL_CreateMutex();
 	if(this->mutex == NULL) {
 		char szBuf[8096]="";
@@ -456,11 +484,6 @@ Mutex::Mutex(string ownerId) {
 	}
 	this->deleteownerId 			= "";
 
-	this->chronoPerf 				= NULL;
-	if(debugMutexLock == true) {
-		this->chronoPerf = new Chrono();
-	}
-
 	if(Mutex::mutexMutexList.get()) {
 		MutexSafeWrapper safeMutexX(Mutex::mutexMutexList.get());
 		Mutex::mutexList.push_back(this);
@@ -487,21 +510,16 @@ Mutex::~Mutex() {
 	SDLMutexSafeWrapper safeMutex(&mutexAccessor,true);
 	if(mutex == NULL) {
 		char szBuf[8096]="";
-		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId.c_str(),deleteownerId.c_str());
+		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId,deleteownerId);
 		throw megaglest_runtime_error(szBuf);
 		//printf("%s\n",szBuf);
 	}
 	else if(refCount >= 1) {
 		char szBuf[8096]="";
-		snprintf(szBuf,8095,"In [%s::%s Line: %d] about to destroy mutex refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId.c_str(),deleteownerId.c_str());
+		snprintf(szBuf,8095,"In [%s::%s Line: %d] about to destroy mutex refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId,deleteownerId);
 		throw megaglest_runtime_error(szBuf);
 	}
 
-	if(debugMutexLock == true) {
-		delete chronoPerf;
-		chronoPerf = NULL;
-	}
-
 	if(mutex != NULL) {
 		deleteownerId = ownerId;
 		SDL_DestroyMutex(mutex);
@@ -509,7 +527,7 @@ Mutex::~Mutex() {
 	}
 
 //	if(maxRefCount <= 1) {
-//		printf("***> MUTEX candidate for removal ownerId [%s] deleteownerId [%s] lastownerId [%s]\n",ownerId.c_str(),deleteownerId.c_str(),lastownerId.c_str());
+//		printf("***> MUTEX candidate for removal ownerId [%s] deleteownerId [%s] lastownerId [%s]\n",ownerId,deleteownerId,lastownerId);
 //	}
 }
 
@@ -519,48 +537,216 @@ void Mutex::p() {
 		string stack = PlatformExceptionHandler::getStackTrace();
 
 		char szBuf[8096]="";
-		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s] stack: %s",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId.c_str(),deleteownerId.c_str(),stack.c_str());
+		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s] stack: %s",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId,deleteownerId,stack.c_str());
 		throw megaglest_runtime_error(szBuf);
 	}
-	std::auto_ptr<Chrono> chronoLockPerf;
-	if(debugMutexLock == true) {
-		chronoLockPerf.reset(new Chrono());
-		chronoLockPerf->start();
-	}
+	int64 lockStartMillis = (debugMutexLock == true ? Chrono::getCurMillis() : 0);
 
 //	maxRefCount = max(maxRefCount,refCount+1);
 	SDL_mutexP(mutex);
 	refCount++;
 
 	if(debugMutexLock == true) {
-		if(chronoLockPerf->getMillis() >= debugMutexLockMillisecondThreshold) {
-			printf("\n**WARNING possible mutex lock detected ms [%lld] Last ownerid: [%s]\n",(long long int)chronoLockPerf->getMillis(),lastownerId.c_str());
+		lockedAtMillis = Chrono::getCurMillis();
+		if(lockedAtMillis - lockStartMillis >= debugMutexLockMillisecondThreshold) {
+			printf("\n**WARNING possible mutex lock detected ms [%lld] Last ownerid: [%s]\n",(long long int)(lockedAtMillis - lockStartMillis),lastownerId);
 		}
-		chronoPerf->start();
 	}
 }
 
 void Mutex::v() {
 	if(mutex == NULL) {
 		char szBuf[8096]="";
-		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId.c_str(),deleteownerId.c_str());
+		snprintf(szBuf,8095,"In [%s::%s Line: %d] mutex == NULL refCount = %d owner [%s] deleteownerId [%s]",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,refCount,ownerId,deleteownerId);
 		throw megaglest_runtime_error(szBuf);
 	}
 	refCount--;
 
 	if(debugMutexLock == true) {
 		lastownerId = ownerId;
-		if(chronoPerf->getMillis() >= debugMutexLockMillisecondThreshold) {
+		int64 heldMillis = Chrono::getCurMillis() - lockedAtMillis;
+		if(heldMillis >= debugMutexLockMillisecondThreshold) {
 			printf("About to get stacktrace for stuck mutex ...\n");
-			string oldLastownerId = lastownerId;
-			lastownerId = PlatformExceptionHandler::getStackTrace();
+			string stack = PlatformExceptionHandler::getStackTrace();
 
-			printf("\n**WARNING possible mutex lock (on unlock) detected ms [%lld] Last ownerid: [%s]\noldLastownerId: [%s]\n",(long long int)chronoPerf->getMillis(),lastownerId.c_str(),oldLastownerId.c_str());
+			printf("\n**WARNING possible mutex lock (on unlock) detected ms [%lld] Last ownerid: [%s]\nstack: [%s]\n",(long long int)heldMillis,lastownerId,stack.c_str());
 		}
 	}
 	SDL_mutexV(mutex);
 }
 
+// =====================================================
+//	class MutexContentionProfiler
+// =====================================================
+
+#if defined(_MSC_VER)
+	#define MUTEX_PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+	#define MUTEX_PROFILER_THREAD_LOCAL __thread
+#endif
+
+// Call sites seen by one thread, open addressed on the literal's address.
+// Only its own thread writes to it, the accessor keeps reports consistent.
+class MutexContentionTable {
+public:
+	static const int tableSize = 256;
+
+	MutexContentionStats sites[tableSize];
+	uint32 droppedCount;
+	SDL_mutex *accessor;
+
+	MutexContentionTable() : droppedCount(0) {
+		accessor = SDL_CreateMutex();
+	}
+
+	void record(const char *ownerId, int64 waitMicros, int64 holdMicros) {
+		SDL_mutexP(accessor);
+		uint32 slot = (uint32)(((size_t)ownerId >> 2) & (tableSize - 1));
+		for(int probe = 0; probe < tableSize; ++probe) {
+			MutexContentionStats &stats = sites[(slot + probe) & (tableSize - 1)];
+			if(stats.ownerId == NULL) {
+				stats.ownerId = ownerId;
+			}
+			else if(stats.ownerId != ownerId) {
+				continue;
+			}
+
+			stats.lockCount++;
+			stats.waitMicros += waitMicros;
+			stats.maxWaitMicros = max(stats.maxWaitMicros,waitMicros);
+			stats.holdMicros += holdMicros;
+			stats.maxHoldMicros = max(stats.maxHoldMicros,holdMicros);
+			SDL_mutexV(accessor);
+			return;
+		}
+		droppedCount++;
+		SDL_mutexV(accessor);
+	}
+};
+
+class MutexContentionStatsLess {
+public:
+	bool operator()(const MutexContentionStats &stats1, const MutexContentionStats &stats2) const {
+		if(stats1.waitMicros != stats2.waitMicros) {
+			return stats1.waitMicros > stats2.waitMicros;
+		}
+		return stats1.holdMicros > stats2.holdMicros;
+	}
+};
+
+bool MutexContentionProfiler::enabled = false;
+
+static MUTEX_PROFILER_THREAD_LOCAL MutexContentionTable *threadContentionTable = NULL;
+// Tables outlive their threads so a report still sees them
+static vector<MutexContentionTable *> contentionTableList;
+static SDL_mutex *contentionTableListAccessor = SDL_CreateMutex();
+
+int64 MutexContentionProfiler::getCurMicros() {
+#ifdef WIN32
+	static int64 frequency = 0;
+	LARGE_INTEGER counter;
+	if(frequency == 0) {
+		LARGE_INTEGER counterFrequency;
+		QueryPerformanceFrequency(&counterFrequency);
+		frequency = counterFrequency.QuadPart;
+	}
+	QueryPerformanceCounter(&counter);
+	return (int64)(counter.QuadPart * 1000000 / frequency);
+#else
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (int64)now.tv_sec * 1000000 + now.tv_usec;
+#endif
+}
+
+void MutexContentionProfiler::record(const char *ownerId, int64 waitMicros, int64 holdMicros) {
+	if(threadContentionTable == NULL) {
+		threadContentionTable = new MutexContentionTable();
+
+		SDL_mutexP(contentionTableListAccessor);
+		contentionTableList.push_back(threadContentionTable);
+		SDL_mutexV(contentionTableListAccessor);
+	}
+	threadContentionTable->record(ownerId,waitMicros,holdMicros);
+}
+
+vector<MutexContentionStats> MutexContentionProfiler::getStats() {
+	// The same site may be a different literal in another module
+	std::map<string,MutexContentionStats> mergedSites;
+
+	SDL_mutexP(contentionTableListAccessor);
+	for(unsigned int index = 0; index < contentionTableList.size(); ++index) {
+		MutexContentionTable *table = contentionTableList[index];
+		SDL_mutexP(table->accessor);
+		for(int slot = 0; slot < MutexContentionTable::tableSize; ++slot) {
+			const MutexContentionStats &stats = table->sites[slot];
+			if(stats.ownerId == NULL) {
+				continue;
+			}
+			MutexContentionStats &merged = mergedSites[stats.ownerId];
+			merged.ownerId = stats.ownerId;
+			merged.lockCount += stats.lockCount;
+			merged.waitMicros += stats.waitMicros;
+			merged.maxWaitMicros = max(merged.maxWaitMicros,stats.maxWaitMicros);
+			merged.holdMicros += stats.holdMicros;
+			merged.maxHoldMicros = max(merged.maxHoldMicros,stats.maxHoldMicros);
+		}
+		SDL_mutexV(table->accessor);
+	}
+	SDL_mutexV(contentionTableListAccessor);
+
+	vector<MutexContentionStats> result;
+	for(std::map<string,MutexContentionStats>::iterator iterMap = mergedSites.begin();
+		iterMap != mergedSites.end(); ++iterMap) {
+		result.push_back(iterMap->second);
+	}
+	std::sort(result.begin(),result.end(),MutexContentionStatsLess());
+	return result;
+}
+
+string MutexContentionProfiler::getReport(int maxSites) {
+	vector<MutexContentionStats> stats = getStats();
+
+	uint32 droppedCount = 0;
+	SDL_mutexP(contentionTableListAccessor);
+	for(unsigned int index = 0; index < contentionTableList.size(); ++index) {
+		droppedCount += contentionTableList[index]->droppedCount;
+	}
+	int threadCount = (int)contentionTableList.size();
+	SDL_mutexV(contentionTableListAccessor);
+
+	char szBuf[8096]="";
+	snprintf(szBuf,8095,"Mutex contention for %d call sites in %d threads, worst waits first (usecs):\n",(int)stats.size(),threadCount);
+	string result = szBuf;
+	for(int index = 0; index < (int)stats.size() && index < maxSites; ++index) {
+		const MutexContentionStats &site = stats[index];
+		snprintf(szBuf,8095,"locks: %u wait: %lld (max %lld) hold: %lld (max %lld) [%s]\n",
+				site.lockCount,(long long int)site.waitMicros,(long long int)site.maxWaitMicros,
+				(long long int)site.holdMicros,(long long int)site.maxHoldMicros,
+				(site.ownerId[0] != '\0' ? site.ownerId : "<unnamed>"));
+		result += szBuf;
+	}
+	if(droppedCount > 0) {
+		snprintf(szBuf,8095,"%u locks not recorded, call site tables full\n",droppedCount);
+		result += szBuf;
+	}
+	return result;
+}
+
+void MutexContentionProfiler::reset() {
+	SDL_mutexP(contentionTableListAccessor);
+	for(unsigned int index = 0; index < contentionTableList.size(); ++index) {
+		MutexContentionTable *table = contentionTableList[index];
+		SDL_mutexP(table->accessor);
+		for(int slot = 0; slot < MutexContentionTable::tableSize; ++slot) {
+			table->sites[slot] = MutexContentionStats();
+		}
+		table->droppedCount = 0;
+		SDL_mutexV(table->accessor);
+	}
+	SDL_mutexV(contentionTableListAccessor);
+}
+
 // =====================================================
 //	class Semaphore
 // =====================================================
@@ -648,6 +834,7 @@ void Semaphore::resetSemValue(Uint32 initialValue) {
 
 ReadWriteMutex::ReadWriteMutex(int maxReaders) : semaphore(maxReaders) {
 	this->maxReadersCount = maxReaders;
+	this->ownerId = "";
 }
 
 void ReadWriteMutex::LockRead() {
@@ -49,19 +49,19 @@ void SoundSource::unQueueBuffers() {
 
     ALint queued=0;
     alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
-    SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+    SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
     alSourcei(source, AL_LOOPING, AL_FALSE);
-    SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+    SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 	ALint processed=0;
     alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
-    SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+    SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 	while(processed--) {
 		ALuint buffer=0;
 		alSourceUnqueueBuffers(source, 1, &buffer);
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 	}
 
 //	ALint queued=0;
@@ -78,58 +78,63 @@ void SoundSource::unQueueBuffers() {
 
 void SoundSource::stop() {
 	alSourceStop(source);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
     unQueueBuffers();
 
 	alSourcei(source, AL_BUFFER, AL_NONE);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 	//unQueueBuffers();
 
 	alSourceRewind(source);    // stops the source
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 	while(playing() == true) {
 		//alSourceStop(source);
-		//SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		//SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 		ALint state = AL_STOPPED;
 		alGetSourcei(source, AL_SOURCE_STATE, &state);
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 		sleep(1);
 		printf("$$$ WAITING FOR OPENAL TO STOP state = %d!\n",state);
 	}
 	//unQueueBuffers();
-	//SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	//SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 }
 
 ALenum SoundSource::getFormat(Sound* sound)
 {
-	if(sound->getInfo()->getChannels() == 2) {
-		if(sound->getInfo()->getBitsPerSample() == 16) {
+	return getFormat(sound->getInfo(), sound->getFileName());
+}
+
+ALenum SoundSource::getFormat(const SoundInfo *info, const string &fileName)
+{
+	if(info->getChannels() == 2) {
+		if(info->getBitsPerSample() == 16) {
 			return AL_FORMAT_STEREO16;
 		}
-		else if(sound->getInfo()->getBitsPerSample() == 8) {
+		else if(info->getBitsPerSample() == 8) {
 			return AL_FORMAT_STEREO8;
 		}
 		else {
-			throw std::runtime_error("[1] Sample format not supported in file: " + sound->getFileName());
+			throw std::runtime_error("[1] Sample format not supported in file: " + fileName);
 		}
 	}
-	else if(sound->getInfo()->getChannels() == 1) {
-		if(sound->getInfo()->getBitsPerSample() == 16) {
+	else if(info->getChannels() == 1) {
+		if(info->getBitsPerSample() == 16) {
 			return AL_FORMAT_MONO16;
 		}
-		else if(sound->getInfo()->getBitsPerSample() == 8) {
+		else if(info->getBitsPerSample() == 8) {
 			return AL_FORMAT_MONO8;
 		}
 		else {
-			throw std::runtime_error("[2] Sample format not supported in file: " + sound->getFileName());
+			throw std::runtime_error("[2] Sample format not supported in file: " + fileName);
 		}
 	}
 
-	throw std::runtime_error("[3] Sample format not supported in file: " + sound->getFileName());
+	throw std::runtime_error("[3] Sample format not supported in file: " + fileName);
 }
 
 //---------------------------------------------------------------------------
@@ -147,34 +152,56 @@ StaticSoundSource::~StaticSoundSource() {
 }
 
 void StaticSoundSource::play(StaticSound* sound) {
+	if(sound->getPcmData() != NULL) {
+		play(sound->getPcmData(), sound->getVolume());
+	}
+}
+
+void StaticSoundSource::play(PcmSoundData* pcmData, float volume) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	if(bufferAllocated) {
-		stop();
-		alDeleteBuffers(1, &buffer);
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	// Keep the samples from being evicted until OpenAL has copied them
+	PcmSoundCache &cache = PcmSoundCache::getInstance();
+	if(cache.pin(pcmData) == false) {
+		if(cache.decodeNow(pcmData) == false || cache.pin(pcmData) == false) {
+			return;
+		}
 	}
-	ALenum format = getFormat(sound);
 
-	alGenBuffers(1, &buffer);
-	SoundPlayerOpenAL::checkAlError("Couldn't create audio buffer: ");
+	try {
+		if(bufferAllocated) {
+			stop();
+			alDeleteBuffers(1, &buffer);
+			SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
+		}
+		const SoundInfo *info = &pcmData->getInfo();
+		ALenum format = getFormat(info, pcmData->getPath());
 
-	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d] filename [%s] format = %d, sound->getSamples() = %d, sound->getInfo()->getSize() = %d, sound->getInfo()->getSamplesPerSecond() = %d\n",__FILE__,__FUNCTION__,__LINE__,sound->getFileName().c_str(),format,sound->getSamples(),sound->getInfo()->getSize(),sound->getInfo()->getSamplesPerSecond());
+		alGenBuffers(1, &buffer);
+		SoundPlayerOpenAL::checkAlError("Couldn't create audio buffer: ");
 
-	bufferAllocated = true;
-	alBufferData(buffer, format, sound->getSamples(),
-			static_cast<ALsizei> (sound->getInfo()->getSize()),
-			static_cast<ALsizei> (sound->getInfo()->getSamplesPerSecond()));
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d] filename [%s] format = %d, samples = %p, size = %d, samplesPerSecond = %d\n",__FILE__,__FUNCTION__,__LINE__,pcmData->getPath().c_str(),format,pcmData->getSamples(),info->getSize(),info->getSamplesPerSecond());
 
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		bufferAllocated = true;
+		alBufferData(buffer, format, pcmData->getSamples(),
+				static_cast<ALsizei> (info->getSize()),
+				static_cast<ALsizei> (info->getSamplesPerSecond()));
+
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
+	}
+	catch(...) {
+		cache.unpin(pcmData);
+		throw;
+	}
+	cache.unpin(pcmData);
 
 	alSourcei(source, AL_BUFFER, buffer);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
-	alSourcef(source, AL_GAIN, sound->getVolume());
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
+	alSourcef(source, AL_GAIN, volume);
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 	alSourcePlay(source);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 }
 
 StreamSoundSource::StreamSoundSource()
@@ -184,7 +211,7 @@ StreamSoundSource::StreamSoundSource()
 	format = 0;
 	fade = 0;
 	alGenBuffers(STREAMFRAGMENTS, buffers);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 }
 
 StreamSoundSource::~StreamSoundSource()
@@ -223,7 +250,7 @@ void StreamSoundSource::play(StrSound* sound, int64 fadeon)
 	}
 	if(fadeon > 0) {
 		alSourcef(source, AL_GAIN, 0);
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 		fadeState = FadingOn;
 		fade = fadeon;
@@ -231,10 +258,10 @@ void StreamSoundSource::play(StrSound* sound, int64 fadeon)
 	} else {
 		fadeState = NoFading;
 		alSourcef(source, AL_GAIN, sound->getVolume());
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 	}
 	alSourcePlay(source);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 }
 
 void StreamSoundSource::update()
@@ -245,18 +272,18 @@ void StreamSoundSource::update()
 
 	if(fadeState == NoFading){
 		alSourcef(source, AL_GAIN, sound->getVolume());
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 	}
 
 	ALint processed = 0;
 	alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
-	SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+	SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 	while(processed > 0) {
 		processed--;
 
 		ALuint buffer;
 		alSourceUnqueueBuffers(source, 1, &buffer);
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 		if(!fillBufferAndQueue(buffer))
 			break;
@@ -268,7 +295,7 @@ void StreamSoundSource::update()
 
 		std::cerr << "Restarting audio source because of buffer underrun.\n";
 		alSourcePlay(source);
-		SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+		SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
   	}
 
 	// handle fading
@@ -276,13 +303,13 @@ void StreamSoundSource::update()
 		case FadingOn:
 			if(chrono.getMillis() > fade) {
 				alSourcef(source, AL_GAIN, sound->getVolume());
-				SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+				SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 
 				fadeState = NoFading;
 			} else {
 				alSourcef(source, AL_GAIN, sound->getVolume() *
 						static_cast<float> (chrono.getMillis())/fade);
-				SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+				SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 			}
 			break;
 		case FadingOff:
@@ -291,7 +318,7 @@ void StreamSoundSource::update()
 			} else {
 				alSourcef(source, AL_GAIN, sound->getVolume() *
 						(1.0f - static_cast<float>(chrono.getMillis())/fade));
-				SoundPlayerOpenAL::checkAlError(string(__FILE__) + string(" ") + string(__FUNCTION__) + string(" ") + intToStr(__LINE__));
+				SoundPlayerOpenAL::checkAlError(__FILE__,__FUNCTION__,__LINE__);
 			}
 			break;
 		default:
@@ -407,6 +434,7 @@ bool SoundPlayerOpenAL::init(const SoundPlayerParams* params) {
 		checkAlError("Audio error after init: ");
 
 		initOk = true;
+		pendingStaticSoundChrono.start();
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s %d]\n",__FILE__,__FUNCTION__,__LINE__);
 	}
 	catch(const exception &ex) {
@@ -422,6 +450,9 @@ void SoundPlayerOpenAL::end() {
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
+	clearPendingStaticSounds();
+	PcmSoundCache::getInstance().stopDecodeThread();
+
 
 	for(StaticSoundSources::iterator i = staticSources.begin();
 			i != staticSources.end(); ++i) {
@@ -483,6 +514,22 @@ void SoundPlayerOpenAL::play(StaticSound* staticSound) {
 	if(initOk == false) return;
 
 	try {
+		PcmSoundData *pcmData = staticSound->getPcmData();
+		if(pcmData == NULL) {
+			return;
+		}
+		if(staticSound->requestSamples() == false) {
+			// First use, played by updateStreams once the decode thread is done
+			if(pcmData->getState() != pssFailed) {
+				PendingStaticSound pending;
+				pending.pcmData			= PcmSoundCache::getInstance().acquire(pcmData->getPath());
+				pending.volume			= staticSound->getVolume();
+				pending.queuedMillis	= pendingStaticSoundChrono.getMillis();
+				pendingStaticSounds.push_back(pending);
+			}
+			return;
+		}
+
 		StaticSoundSource* source = findStaticSoundSource();
 
 		if(source == 0) {
@@ -528,6 +575,8 @@ void SoundPlayerOpenAL::stop(StrSound* strSound, int64 fadeOff) {
 void SoundPlayerOpenAL::stopAllSounds(int64 fadeOff) {
 	if(initOk == false) return;
 
+	clearPendingStaticSounds();
+
 	for(StaticSoundSources::iterator i = staticSources.begin();
 			i != staticSources.end(); ++i) {
 		StaticSoundSource* source = *i;
@@ -545,6 +594,10 @@ void SoundPlayerOpenAL::updateStreams() {
 
 	assert(context != 0);
 	try {
+		if(pendingStaticSounds.empty() == false) {
+			playPendingStaticSounds();
+		}
+
 		for(StreamSoundSources::iterator i = streamSources.begin();
 				i != streamSources.end(); ++i) {
 			StreamSoundSource* source = *i;
@@ -575,6 +628,42 @@ void SoundPlayerOpenAL::updateStreams() {
 	}
 }
 
+void SoundPlayerOpenAL::playPendingStaticSounds() {
+	PcmSoundCache &cache = PcmSoundCache::getInstance();
+	int64 currentMillis = pendingStaticSoundChrono.getMillis();
+	for(unsigned int i = 0; i < pendingStaticSounds.size();) {
+		PendingStaticSound &pending = pendingStaticSounds[i];
+		bool ready = cache.requestDecode(pending.pcmData);
+		if(ready == false && pending.pcmData->getState() != pssFailed &&
+			currentMillis - pending.queuedMillis <= maxPendingStaticSoundMillis) {
+			++i;
+			continue;
+		}
+
+		if(ready == true) {
+			try {
+				StaticSoundSource* source = findStaticSoundSource();
+				if(source != 0) {
+					source->play(pending.pcmData, pending.volume);
+				}
+			}
+			catch(std::exception& e) {
+				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,e.what());
+				std::cerr << "Couldn't play static sound: [" << e.what() << "]\n";
+			}
+		}
+		cache.release(pending.pcmData);
+		pendingStaticSounds.erase(pendingStaticSounds.begin() + i);
+	}
+}
+
+void SoundPlayerOpenAL::clearPendingStaticSounds() {
+	for(unsigned int i = 0; i < pendingStaticSounds.size(); ++i) {
+		PcmSoundCache::getInstance().release(pendingStaticSounds[i].pcmData);
+	}
+	pendingStaticSounds.clear();
+}
+
 StaticSoundSource* SoundPlayerOpenAL::findStaticSoundSource() {
 	if(initOk == false) return NULL;
 
@@ -648,11 +737,11 @@ void SoundPlayerOpenAL::checkAlcError(string message) {
 	}
 }
 
-void SoundPlayerOpenAL::checkAlError(string message) {
+void SoundPlayerOpenAL::checkAlError(const char *message) {
 	int err = alGetError();
 	if(err != AL_NO_ERROR) {
 		char szBuf[8096]="";
-		snprintf(szBuf,8096,"%s [%s]",message.c_str(),alGetString(err));
+		snprintf(szBuf,8096,"%s [%s]",message,alGetString(err));
 		//std::stringstream msg;
 		//msg << message.c_str() << alGetString(err);
 		printf("openal error [%s]\n",szBuf);
@@ -660,5 +749,17 @@ void SoundPlayerOpenAL::checkAlError(string message) {
 	}
 }
 
+// Only formats the location once an error happened, streams check after
+// every OpenAL call
+void SoundPlayerOpenAL::checkAlError(const char *file, const char *function, int line) {
+	int err = alGetError();
+	if(err != AL_NO_ERROR) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"%s %s %d [%s]",file,function,line,alGetString(err));
+		printf("openal error [%s]\n",szBuf);
+		throw std::runtime_error(szBuf);
+	}
+}
+
 }}} // end of namespace
 
@@ -10,6 +10,7 @@
 // ==============================================================
 
 #include "sound.h"
+#include "sound_cache.h"
 
 #include <fstream>
 #include <stdexcept>
@@ -48,7 +49,7 @@ Sound::Sound() {
 // =====================================================
 
 StaticSound::StaticSound() {
-	samples= NULL;
+	pcmData= NULL;
 	soundFileLoader = NULL;
 	fileName = "";
 }
@@ -58,15 +59,9 @@ StaticSound::~StaticSound() {
 }
 
 void StaticSound::close() {
-	if(samples != NULL) {
-		delete [] samples;
-		samples = NULL;
-	}
-
-	if(soundFileLoader!=NULL){
-		soundFileLoader->close();
-		delete soundFileLoader;
-		soundFileLoader= NULL;
+	if(pcmData != NULL) {
+		PcmSoundCache::getInstance().release(pcmData);
+		pcmData = NULL;
 	}
 }
 
@@ -78,19 +73,31 @@ void StaticSound::load(const string &path) {
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return;
 	}
-	string ext= path.substr(path.find_last_of('.')+1);
-	soundFileLoader= SoundFileLoaderFactory::getInstance()->newInstance(ext);
 
-	if(soundFileLoader == NULL) {
-		throw megaglest_runtime_error("soundFileLoader == NULL");
+	// Decoding is deferred until the sound is first played
+	pcmData= PcmSoundCache::getInstance().acquire(path);
+	info= pcmData->getInfo();
+}
+
+const int8 *StaticSound::getSamples() const {
+	if(pcmData == NULL || pcmData->getState() != pssReady) {
+		return NULL;
 	}
-	soundFileLoader->open(path, &info);
-	samples= new int8[info.getSize()];
-	soundFileLoader->read(samples, info.getSize());
-	soundFileLoader->close();
+	return pcmData->getSamples();
+}
 
-	delete soundFileLoader;
-	soundFileLoader= NULL;
+bool StaticSound::requestSamples() {
+	if(pcmData == NULL) {
+		return false;
+	}
+	return PcmSoundCache::getInstance().requestDecode(pcmData);
+}
+
+bool StaticSound::loadSamples() {
+	if(pcmData == NULL) {
+		return false;
+	}
+	return PcmSoundCache::getInstance().decodeNow(pcmData);
 }
 
 // =====================================================
@@ -0,0 +1,377 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "sound_cache.h"
+
+#include <stdexcept>
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "conversion.h"
+#include "base_thread.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Shared{ namespace Sound{
+
+// =====================================================
+//	class PcmSoundDecodeThread
+// =====================================================
+
+class PcmSoundDecodeThread : public BaseThread {
+private:
+	PcmSoundCache *cache;
+
+public:
+	PcmSoundDecodeThread(PcmSoundCache *cache) : BaseThread(), cache(cache) {
+		setUniqueID("PcmSoundDecodeThread");
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		try {
+			cache->processDecodeQueue();
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		}
+	}
+};
+
+// =====================================================
+//	class PcmSoundData
+// =====================================================
+
+PcmSoundData::PcmSoundData(const string &path) {
+	this->path	= path;
+	samples		= NULL;
+	state		= pssUnloaded;
+	refCount	= 0;
+	pinCount	= 0;
+	lastUseTick	= 0;
+}
+
+PcmSoundData::~PcmSoundData() {
+	delete [] samples;
+	samples = NULL;
+}
+
+// =====================================================
+//	class PcmSoundCache
+// =====================================================
+
+uint64 PcmSoundCache::defaultMemoryLimit = 64 * 1024 * 1024;
+
+PcmSoundCache::PcmSoundCache() : mutex(CODE_AT_LINE) {
+	decodeThread	= NULL;
+	quitDecoding	= false;
+	memoryLimit		= defaultMemoryLimit;
+	memoryUsed		= 0;
+	useTick			= 0;
+	decodeCount		= 0;
+	evictionCount	= 0;
+}
+
+PcmSoundCache::~PcmSoundCache() {
+	stopDecodeThread();
+
+	for(std::map<string, PcmSoundData *>::iterator iterMap = entries.begin();
+		iterMap != entries.end(); ++iterMap) {
+		delete iterMap->second;
+	}
+	entries.clear();
+}
+
+PcmSoundCache &PcmSoundCache::getInstance() {
+	static PcmSoundCache cache;
+	return cache;
+}
+
+PcmSoundData *PcmSoundCache::acquire(const string &path) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	std::map<string, PcmSoundData *>::iterator iterFind = entries.find(path);
+	if(iterFind != entries.end()) {
+		iterFind->second->refCount++;
+		return iterFind->second;
+	}
+	safeMutex.ReleaseLock(true);
+
+	// Only the header is read here so sound info is known before decoding
+	PcmSoundData *data = new PcmSoundData(path);
+	SoundFileLoader *soundFileLoader = NULL;
+	try {
+		string ext = path.substr(path.find_last_of('.') + 1);
+		soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+		if(soundFileLoader == NULL) {
+			throw megaglest_runtime_error("soundFileLoader == NULL");
+		}
+		soundFileLoader->open(path, &data->info);
+		soundFileLoader->close();
+		delete soundFileLoader;
+	}
+	catch(...) {
+		delete soundFileLoader;
+		delete data;
+		throw;
+	}
+
+	safeMutex.Lock();
+	iterFind = entries.find(path);
+	if(iterFind != entries.end()) {
+		// Another thread loaded the same file meanwhile
+		delete data;
+		data = iterFind->second;
+	}
+	else {
+		entries[path] = data;
+	}
+	data->refCount++;
+	return data;
+}
+
+void PcmSoundCache::release(PcmSoundData *data) {
+	if(data == NULL) {
+		return;
+	}
+
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	data->refCount--;
+	if(data->refCount > 0 || data->state == pssDecoding) {
+		// A decoding entry is deleted by the decode thread when it is done
+		return;
+	}
+
+	if(data->state == pssQueued) {
+		for(std::deque<PcmSoundData *>::iterator iterQueue = decodeQueue.begin();
+			iterQueue != decodeQueue.end(); ++iterQueue) {
+			if(*iterQueue == data) {
+				decodeQueue.erase(iterQueue);
+				break;
+			}
+		}
+	}
+	if(data->samples != NULL) {
+		memoryUsed -= data->info.getSize();
+	}
+	entries.erase(data->path);
+	delete data;
+}
+
+bool PcmSoundCache::requestDecode(PcmSoundData *data) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	if(data->state == pssReady) {
+		data->lastUseTick = ++useTick;
+		return true;
+	}
+	if(data->state != pssUnloaded) {
+		return false;
+	}
+
+	data->state = pssQueued;
+	decodeQueue.push_back(data);
+	if(decodeThread == NULL) {
+		quitDecoding = false;
+		decodeThread = new PcmSoundDecodeThread(this);
+		decodeThread->start();
+	}
+	decodeRequested.signal();
+	return false;
+}
+
+bool PcmSoundCache::decodeNow(PcmSoundData *data) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	for(;data->state == pssDecoding;) {
+		// The decode thread already has it, wait rather than decode twice
+		safeMutex.ReleaseLock(true);
+		sleep(1);
+		safeMutex.Lock();
+	}
+
+	if(data->state == pssReady) {
+		data->lastUseTick = ++useTick;
+		return true;
+	}
+	if(data->state == pssFailed) {
+		return false;
+	}
+
+	// Taken over from the queue, the decode thread skips it later
+	data->state = pssDecoding;
+	safeMutex.ReleaseLock();
+	return decode(data);
+}
+
+bool PcmSoundCache::decode(PcmSoundData *data) {
+	SoundInfo info;
+	int8 *samples = NULL;
+	bool decoded = false;
+	SoundFileLoader *soundFileLoader = NULL;
+	try {
+		string ext = data->path.substr(data->path.find_last_of('.') + 1);
+		soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+		if(soundFileLoader == NULL) {
+			throw megaglest_runtime_error("soundFileLoader == NULL");
+		}
+		soundFileLoader->open(data->path, &info);
+		samples = new int8[info.getSize()];
+		soundFileLoader->read(samples, info.getSize());
+		soundFileLoader->close();
+		decoded = true;
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error decoding [%s] [%s]\n",__FILE__,__FUNCTION__,__LINE__,data->path.c_str(),ex.what());
+		delete [] samples;
+		samples = NULL;
+	}
+	delete soundFileLoader;
+
+	MutexSafeWrapper safeMutex(&mutex);
+	if(data->refCount <= 0) {
+		// Released while it was decoding
+		delete [] samples;
+		entries.erase(data->path);
+		delete data;
+		return false;
+	}
+
+	if(decoded == false) {
+		data->state = pssFailed;
+		return false;
+	}
+
+	data->samples		= samples;
+	data->state			= pssReady;
+	data->lastUseTick	= ++useTick;
+	memoryUsed += data->info.getSize();
+	decodeCount++;
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d] decoded [%s] size = %u, memoryUsed = " MG_I64U_SPECIFIER "\n",__FILE__,__FUNCTION__,__LINE__,data->path.c_str(),data->info.getSize(),memoryUsed);
+
+	evictIfRequired(data);
+	return true;
+}
+
+void PcmSoundCache::evictIfRequired(const PcmSoundData *keep) {
+	// Called with the mutex held
+	for(;memoryUsed > memoryLimit;) {
+		PcmSoundData *oldest = NULL;
+		for(std::map<string, PcmSoundData *>::iterator iterMap = entries.begin();
+			iterMap != entries.end(); ++iterMap) {
+			PcmSoundData *data = iterMap->second;
+			if(data != keep && data->state == pssReady && data->pinCount == 0 &&
+				(oldest == NULL || data->lastUseTick < oldest->lastUseTick)) {
+				oldest = data;
+			}
+		}
+		if(oldest == NULL) {
+			break;
+		}
+
+		memoryUsed -= oldest->info.getSize();
+		delete [] oldest->samples;
+		oldest->samples = NULL;
+		oldest->state = pssUnloaded;
+		evictionCount++;
+	}
+}
+
+bool PcmSoundCache::pin(PcmSoundData *data) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	if(data->state != pssReady) {
+		return false;
+	}
+	data->pinCount++;
+	data->lastUseTick = ++useTick;
+	return true;
+}
+
+void PcmSoundCache::unpin(PcmSoundData *data) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	data->pinCount--;
+}
+
+void PcmSoundCache::processDecodeQueue() {
+	for(;;) {
+		decodeRequested.waitTillSignalled();
+
+		MutexSafeWrapper safeMutex(&mutex);
+		for(;quitDecoding == false && decodeQueue.empty() == false;) {
+			PcmSoundData *data = decodeQueue.front();
+			decodeQueue.pop_front();
+			if(data->state != pssQueued) {
+				continue;
+			}
+			data->state = pssDecoding;
+
+			safeMutex.ReleaseLock(true);
+			decode(data);
+			safeMutex.Lock();
+		}
+		if(quitDecoding == true) {
+			break;
+		}
+	}
+}
+
+void PcmSoundCache::stopDecodeThread() {
+	// No function static owner id on the decode thread and shutdown paths,
+	// they also run from the destructor at exit after those statics are gone
+	MutexSafeWrapper safeMutex(&mutex);
+	PcmSoundDecodeThread *thread = decodeThread;
+	decodeThread = NULL;
+	quitDecoding = true;
+
+	// Whatever was still queued goes back to being decoded on demand
+	for(unsigned int i = 0; i < decodeQueue.size(); ++i) {
+		if(decodeQueue[i]->state == pssQueued) {
+			decodeQueue[i]->state = pssUnloaded;
+		}
+	}
+	decodeQueue.clear();
+	safeMutex.ReleaseLock();
+
+	if(thread != NULL) {
+		thread->signalQuit();
+		decodeRequested.signal();
+		if(thread->shutdownAndJoin() == true) {
+			delete thread;
+		}
+	}
+}
+
+void PcmSoundCache::setMemoryLimit(uint64 bytes) {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	memoryLimit = bytes;
+	evictIfRequired(NULL);
+}
+
+uint64 PcmSoundCache::getMemoryUsed() {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	return memoryUsed;
+}
+
+int PcmSoundCache::getEntryCount() {
+	static const char *mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutex,mutexOwnerId);
+	return (int)entries.size();
+}
+
+}}//end namespace
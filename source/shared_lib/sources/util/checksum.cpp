@@ -21,10 +21,16 @@
 
 #include <sys/stat.h> // for open()
 
+#ifndef WIN32
+  #include <unistd.h>
+  #include <sys/mman.h> // for mmap()
+#endif
+
 #include "util.h"
 #include "platform_common.h"
 #include "conversion.h"
 #include "platform_util.h"
+#include "base_thread.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -99,9 +105,37 @@ uint32 Checksum::addByte(const char value) {
 	return sum;
 }
 
+// Slicing-by-8 tables derived from crc_table, they produce exactly the
+// same CRC values while consuming 8 bytes per step
+static unsigned int crc_table_slice[8][256];
+
+static bool initCRCSliceTables() {
+	for(unsigned int i = 0; i < 256; ++i) {
+		crc_table_slice[0][i] = crc_table[i];
+	}
+	for(unsigned int i = 0; i < 256; ++i) {
+		for(unsigned int slice = 1; slice < 8; ++slice) {
+			unsigned int previous = crc_table_slice[slice-1][i];
+			crc_table_slice[slice][i] = (previous >> 8) ^ crc_table[previous & 0xff];
+		}
+	}
+	return true;
+}
+static bool crcSliceTablesReady = initCRCSliceTables();
+
 uint32 Checksum::addBytes(const void *_data, size_t _size) {
 	const unsigned char *rVal = reinterpret_cast<const unsigned char *>(_data);
 	sum = ~sum;
+	while (crcSliceTablesReady == true && _size >= 8) {
+		uint32 one = sum ^ ((uint32)rVal[0] | ((uint32)rVal[1] << 8) | ((uint32)rVal[2] << 16) | ((uint32)rVal[3] << 24));
+		uint32 two = ((uint32)rVal[4] | ((uint32)rVal[5] << 8) | ((uint32)rVal[6] << 16) | ((uint32)rVal[7] << 24));
+		sum = 	crc_table_slice[7][one & 0xff] ^ crc_table_slice[6][(one >> 8) & 0xff] ^
+				crc_table_slice[5][(one >> 16) & 0xff] ^ crc_table_slice[4][one >> 24] ^
+				crc_table_slice[3][two & 0xff] ^ crc_table_slice[2][(two >> 8) & 0xff] ^
+				crc_table_slice[1][(two >> 16) & 0xff] ^ crc_table_slice[0][two >> 24];
+		rVal  += 8;
+		_size -= 8;
+	}
 	while (_size--) {
 		sum = (sum >> 8) ^ crc_table[*rVal++ ^ (sum & 0xff)];
 	}
@@ -174,192 +208,374 @@ void Checksum::addFile(const string &path) {
 	}
 }
 
+void Checksum::addFileContentsToSum(const char *data, size_t size, bool isXMLFile) {
+	if(isXMLFile == false) {
+		addBytes(data,size);
+		return;
+	}
+
+	// Ignore Spaces and comments in XML files as they are
+	// ONLY for formatting. Runs of kept characters are fed to addBytes
+	// in one go which gives the same result as adding them one by one.
+	bool inCommentTag = false;
+	size_t runStart = 0;
+	for(size_t i = 0; i < size; ++i) {
+		bool skip = true;
+		if(inCommentTag == true) {
+			if(data[i] == '>' && i >= 3 && data[i-1] == '-' && data[i-2] == '-') {
+				inCommentTag = false;
+			}
+		}
+		else if(data[i] == '<' && i+4 < size && data[i+1] == '!' && data[i+2] == '-' && data[i+3] == '-') {
+			inCommentTag = true;
+		}
+		else if(data[i] != ' ' && data[i] != '\t' && data[i] != '\n' && data[i] != '\r') {
+			skip = false;
+		}
+
+		if(skip == true) {
+			if(i > runStart) {
+				addBytes(&data[runStart],i - runStart);
+			}
+			runStart = i + 1;
+		}
+	}
+	if(size > runStart) {
+		addBytes(&data[runStart],size - runStart);
+	}
+}
+
 bool Checksum::addFileToSum(const string &path) {
+    bool fileExists = false;
+	bool isXMLFile = (EndsWith(path, ".xml") == true);
 
-// OLD SLOW FILE I/O
-/*
-	FILE* file= fopen(path.c_str(), "rb");
-	if(file!=NULL){
+#if defined(WIN32)
+  #if !defined(__MINGW32__)
+	wstring wstr = utf8_decode(path);
+	FILE *fp = _wfopen(wstr.c_str(), L"rb");
+	ifstream ifs(fp);
+  #else
+    ifstream ifs(path.c_str());
+  #endif
 
+    if (ifs) {
+        fileExists = true;
 		addString(lastFile(path));
 
-		while(!feof(file)){
-			int8 byte= 0;
+		// Determine the file length
+		ifs.seekg(0, ios::end);
+		std::streamoff size=ifs.tellg();
+		ifs.seekg(0, ios::beg);
 
-			size_t readBytes = fread(&byte, 1, 1, file);
-			addByte(byte);
+		if(size > 0) {
+			std::vector<char> buf((size_t)size);
+			ifs.read(&buf[0], buf.size());
+			addFileContentsToSum(&buf[0],buf.size(),isXMLFile);
 		}
+		ifs.close();
+    }
+  #if !defined(__MINGW32__)
+	if(fp) {
+		fclose(fp);
 	}
-	else
-	{
-		throw megaglest_runtime_error("Can not open file: " + path);
+  #endif
+#else
+	// Map the whole file read only and let the kernel read ahead, this
+	// avoids copying every byte through a stream buffer
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd >= 0) {
+		struct stat fileStat;
+		if(fstat(fd, &fileStat) == 0) {
+			fileExists = true;
+			addString(lastFile(path));
+
+			size_t size = (size_t)fileStat.st_size;
+			if(S_ISREG(fileStat.st_mode) && size > 0) {
+				void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(data != MAP_FAILED) {
+					madvise(data, size, MADV_SEQUENTIAL);
+					addFileContentsToSum(static_cast<const char *>(data),size,isXMLFile);
+					munmap(data, size);
+				}
+				else {
+					std::vector<char> buf(size);
+					size_t bytesRead = 0;
+					for(;bytesRead < size;) {
+						ssize_t result = read(fd, &buf[bytesRead], size - bytesRead);
+						if(result <= 0) {
+							break;
+						}
+						bytesRead += (size_t)result;
+					}
+					addFileContentsToSum(&buf[0],bytesRead,isXMLFile);
+				}
+			}
+		}
+		close(fd);
 	}
-	fclose(file);
-*/
+#endif
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] path [%s], isXMLFile = %d, fileExists = %d, sum = %u\n",__FILE__,__FUNCTION__,__LINE__,path.c_str(),isXMLFile,fileExists,sum);
+
+    return fileExists;
+}
 
+// =====================================================
+//	class ChecksumFileWorkerThread
+//
+//	Pulls files off a shared job list and CRCs them, the calling
+//	thread processes the same list so nothing is lost if no workers start
+// =====================================================
 
+class ChecksumFileJobList {
+public:
+	Mutex mutex;
+	Semaphore workerDone;
+	vector<string> &paths;
+	vector<uint32> &results;
+	size_t nextIndex;
 
-/*
-   const double MAX_CRC_FILESIZE = 100000000;
-   int fd=0;
-   size_t bytes_read, bytes_expected = MAX_CRC_FILESIZE * sizeof(int8);
-   int8 *data=0;
-   const char *infile = path.c_str();
+	ChecksumFileJobList(vector<string> &paths, vector<uint32> &results) :
+		mutex(CODE_AT_LINE), paths(paths), results(results), nextIndex(0) {
+	}
 
-   if ((fd = open(infile,O_RDONLY)) < 0)
-	   throw megaglest_runtime_error("Can not open file: " + path);
+	void process() {
+		for(;;) {
+			MutexSafeWrapper safeMutex(&mutex);
+			size_t index = nextIndex++;
+			safeMutex.ReleaseLock();
 
-   if ((data = (int8 *)malloc(bytes_expected)) == NULL)
-	   throw megaglest_runtime_error("malloc failed, Can not open file: " + path);
+			if(index >= paths.size()) {
+				break;
+			}
 
-   bytes_read = read(fd, data, bytes_expected);
+			Checksum fileResult;
+			fileResult.addFileToSum(paths[index]);
+			results[index] = fileResult.getSum();
+		}
+	}
+};
 
-   //if (bytes_read != bytes_expected)
-   //   throw megaglest_runtime_error("read failed, Can not open file: " + path);
+class ChecksumFileWorkerThread : public BaseThread {
+private:
+	ChecksumFileJobList *jobs;
 
-   for(int i = 0; i < bytes_read; i++) {
-		addByte(data[i]);
-   }
-   free(data);
-*/
+public:
+	ChecksumFileWorkerThread(ChecksumFileJobList *jobs) : BaseThread(), jobs(jobs) {
+		setUniqueID("ChecksumFileWorkerThread");
+	}
 
-    bool fileExists = false;
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		try {
+			jobs->process();
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		}
+		jobs->workerDone.signal();
+	}
+};
 
-/*
+// =====================================================
+//	class Checksum (file cache)
+// =====================================================
+
+Mutex Checksum::fileIndexSynchAccessor;
+std::map<string,ChecksumFileIndexEntry> Checksum::fileIndex;
+bool Checksum::fileIndexLoaded = false;
+bool Checksum::fileIndexDirty = false;
+int Checksum::fileHashWorkerThreadCount = -1;
+ChecksumStats Checksum::stats;
+
+static const char *CRC_FILE_INDEX_HEADER 		= "MG_CRC_FILE_INDEX_V2";
+static const unsigned int MIN_FILES_PER_WORKER	= 8;
+
+string ChecksumStats::getReport() const {
+	double megaBytes = (double)bytesHashed / (1024.0 * 1024.0);
+	double megaBytesPerSecond = (hashMillis > 0 ? megaBytes / ((double)hashMillis / 1000.0) : 0.0);
+
+	char szBuf[1024]="";
+	snprintf(szBuf,1023,"CRC hashed %lld files (%.2f MB) in %lld msecs [%.2f MB/sec], %lld files from index",
+			(long long int)filesHashed,megaBytes,(long long int)hashMillis,megaBytesPerSecond,(long long int)filesFromIndex);
+	return szBuf;
+}
+
+string Checksum::getFileIndexPath() {
+	string crcCachePath = getCRCCacheFilePath();
+	if(crcCachePath == "") {
+		return "";
+	}
+	return crcCachePath + "CRC_FILE_INDEX";
+}
+
+bool Checksum::getFileIndexKey(const string &path, ChecksumFileIndexEntry &entry) {
 #ifdef WIN32
-	FILE* file= _wfopen(utf8_decode(path).c_str(), L"rb");
+  #if defined(__MINGW32__)
+	struct _stat fileStat;
+  #else
+	struct _stat64i32 fileStat;
+  #endif
+	if(_wstat(utf8_decode(path).c_str(), &fileStat) != 0) {
+		return false;
+	}
+	entry.inode = 0;
 #else
-	FILE* file= fopen(path.c_str(), "rb");
+	struct stat fileStat;
+	if(stat(path.c_str(), &fileStat) != 0) {
+		return false;
+	}
+	entry.inode = (int64)fileStat.st_ino;
 #endif
-	if(file != NULL) {
-        fileExists = true;
-		addString(lastFile(path));
+	entry.size = (int64)fileStat.st_size;
+	// Modification time in nanoseconds where the platform has them, a file
+	// rewritten within the same second with the same size is still re-read
+	entry.modifiedTime = (int64)fileStat.st_mtime * 1000000000;
+#if defined(__APPLE__)
+	entry.modifiedTime += (int64)fileStat.st_mtimespec.tv_nsec;
+#elif !defined(WIN32) && (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L)
+	entry.modifiedTime += (int64)fileStat.st_mtim.tv_nsec;
+#endif
+	return true;
+}
 
-		bool isXMLFile = (EndsWith(path, ".xml") == true);
-		bool inCommentTag=false;
-		char buf[4096]="";  // Should be large enough.
-		int bufSize = sizeof buf;
-		while(!feof(file)) {
-			//int8 byte= 0;
-
-			//size_t readBytes = fread(&byte, 1, 1, file);
-			memset(buf,0,bufSize);
-			if(fgets(buf, bufSize, file) != NULL) {
-				//addByte(byte);
-			    for(int i = 0; i < bufSize && buf[i] != 0; i++) {
-			    	// Ignore Spaces in XML files as they are
-			    	// ONLY for formatting
-			    	if(isXMLFile == true) {
-			    		if(inCommentTag == true) {
-			    			if(buf[i] == '>' && i >= 3 && buf[i-1] == '-' && buf[i-2] == '-') {
-			    				inCommentTag = false;
-			    				//printf("TURNING OFF comment TAG, i = %d [%c]",i,buf[i]);
-			    			}
-			    			else {
-			    				//printf("SKIPPING XML comment character, i = %d [%c]",i,buf[i]);
-			    			}
-			    			continue;
-			    		}
-			    		//else if(buf[i] == '-' && i >= 4 && buf[i-1] == '-' && buf[i-2] == '!' && buf[i-3] == '<') {
-			    		else if(buf[i] == '<' && i+4 < bufSize && buf[i+1] == '!' && buf[i+2] == '-' && buf[i+3] == '-') {
-		    				inCommentTag = true;
-		    				//printf("TURNING ON comment TAG, i = %d [%c]",i,buf[i]);
-		    				continue;
-			    		}
-			    		else if(buf[i] == ' ' || buf[i] == '\t' || buf[i] == '\n' || buf[i] == '\r') {
-			    			//printf("SKIPPING special character, i = %d [%c]",i,buf[i]);
-			    			continue;
-			    	    }
-			    	}
-			 		addByte(buf[i]);
-			    }
-			}
-		}
+// must be called with fileIndexSynchAccessor locked
+void Checksum::loadFileIndex() {
+	if(fileIndexLoaded == true) {
+		return;
 	}
-	else {
-		throw megaglest_runtime_error("Can not open file: " + path);
+	fileIndexLoaded = true;
+
+	string indexFile = getFileIndexPath();
+	if(indexFile == "" || fileExists(indexFile) == false) {
+		return;
 	}
-	fclose(file);
-*/
 
-#if defined(WIN32) && !defined(__MINGW32__)
-	wstring wstr = utf8_decode(path);
-	FILE *fp = _wfopen(wstr.c_str(), L"rb");
-	ifstream ifs(fp);
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(indexFile).c_str(), L"r");
 #else
-    ifstream ifs(path.c_str());
+	FILE *fp = fopen(indexFile.c_str(),"r");
 #endif
+	if(fp == NULL) {
+		return;
+	}
 
-    if (ifs) {
-        fileExists = true;
-		addString(lastFile(path));
+	// The index is only valid for the game version that wrote it
+	char line[8096]="";
+	if(fgets(line, 8095, fp) != NULL) {
+		string expectedHeader = string(CRC_FILE_INDEX_HEADER) + " " + getGameVersion() + " " + getGameGITVersion();
+		string header = trim(string(line),"\r\n");
+		if(header == expectedHeader) {
+			for(;fgets(line, 8095, fp) != NULL;) {
+				long long int size = 0;
+				long long int modifiedTime = 0;
+				long long int inode = 0;
+				unsigned int crc = 0;
+				int pathOffset = 0;
+				if(sscanf(line,"%lld,%lld,%lld,%u,%n",&size,&modifiedTime,&inode,&crc,&pathOffset) == 4 && pathOffset > 0) {
+					string path = trim(string(&line[pathOffset]),"\r\n");
+					if(path != "") {
+						ChecksumFileIndexEntry &entry = fileIndex[path];
+						entry.size = size;
+						entry.modifiedTime = modifiedTime;
+						entry.inode = inode;
+						entry.crc = crc;
+					}
+				}
+			}
+		}
+	}
+	fclose(fp);
 
-		bool isXMLFile = (EndsWith(path, ".xml") == true);
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Loaded CRC file index [%s] entries: %d\n",indexFile.c_str(),(int)fileIndex.size());
+}
 
-		// Determine the file length
-		ifs.seekg(0, ios::end);
-		std::streamoff size=ifs.tellg();
-		ifs.seekg(0, ios::beg);
+// must be called with fileIndexSynchAccessor locked
+void Checksum::saveFileIndex() {
+	if(fileIndexDirty == false) {
+		return;
+	}
+	string indexFile = getFileIndexPath();
+	if(indexFile == "") {
+		return;
+	}
 
-		unsigned int bufSize = (unsigned int)size / sizeof(char);
-		// Create a vector to store the data
-		std::vector<char> buf(bufSize);
-		// Load the data
-		ifs.read((char*)&buf[0], buf.size());
-
-		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] buf.size() = %d, path [%s], isXMLFile = %d\n",__FILE__,__FUNCTION__,__LINE__,buf.size(), path.c_str(),isXMLFile);
-
-		if(isXMLFile == true) {
-			bool inCommentTag=false;
-			for(std::size_t i = 0; i < buf.size(); ++i) {
-				// Ignore Spaces in XML files as they are
-				// ONLY for formatting
-				//if(isXMLFile == true) {
-					if(inCommentTag == true) {
-						if(buf[i] == '>' && i >= 3 && buf[i-1] == '-' && buf[i-2] == '-') {
-							inCommentTag = false;
-							//printf("TURNING OFF comment TAG, i = %d [%c]",i,buf[i]);
-							if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] i = %d\n",__FILE__,__FUNCTION__,__LINE__,i);
-						}
-						else {
-							//printf("SKIPPING XML comment character, i = %d [%c]",i,buf[i]);
-							if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] i = %d\n",__FILE__,__FUNCTION__,__LINE__,i);
-						}
-						continue;
-					}
-					//else if(buf[i] == '-' && i >= 4 && buf[i-1] == '-' && buf[i-2] == '!' && buf[i-3] == '<') {
-					else if(buf[i] == '<' && i+4 < bufSize && buf[i+1] == '!' && buf[i+2] == '-' && buf[i+3] == '-') {
-						inCommentTag = true;
-						//printf("TURNING ON comment TAG, i = %d [%c]",i,buf[i]);
-						if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] i = %d\n",__FILE__,__FUNCTION__,__LINE__,i);
-						continue;
-					}
-					else if(buf[i] == ' ' || buf[i] == '\t' || buf[i] == '\n' || buf[i] == '\r') {
-						//printf("SKIPPING special character, i = %d [%c]",i,buf[i]);
-						if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] i = %d\n",__FILE__,__FUNCTION__,__LINE__,i);
-						continue;
-					}
-				//}
-				uint32 cipher = addByte(buf[i]);
+	string tempIndexFile = indexFile + ".tmp";
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(tempIndexFile).c_str(), L"w");
+#else
+	FILE *fp = fopen(tempIndexFile.c_str(),"w");
+#endif
+	if(fp == NULL) {
+		return;
+	}
 
-				if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] %d / %d, cipher = %u\n",__FILE__,__FUNCTION__,__LINE__,i,buf.size(), cipher);
-			}
+	// Files deleted since they were indexed are dropped
+	for(std::map<string,ChecksumFileIndexEntry>::iterator iterMap = fileIndex.begin();
+		iterMap != fileIndex.end();) {
+		if(fileExists(iterMap->first) == false) {
+			fileIndex.erase(iterMap++);
 		}
 		else {
-			uint32 cipher = addBytes(&buf[0],buf.size());
-			if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] %d, cipher = %u\n",__FILE__,__FUNCTION__,__LINE__,buf.size(), cipher);
+			++iterMap;
 		}
+	}
 
-		// Close the file
-		ifs.close();
-    }
-#if defined(WIN32) && !defined(__MINGW32__)
-	if(fp) {
-		fclose(fp);
+	fprintf(fp,"%s %s %s\n",CRC_FILE_INDEX_HEADER,getGameVersion().c_str(),getGameGITVersion().c_str());
+	for(std::map<string,ChecksumFileIndexEntry>::const_iterator iterMap = fileIndex.begin();
+		iterMap != fileIndex.end(); ++iterMap) {
+		const ChecksumFileIndexEntry &entry = iterMap->second;
+		fprintf(fp,"%lld,%lld,%lld,%u,%s\n",
+				(long long int)entry.size,(long long int)entry.modifiedTime,
+				(long long int)entry.inode,entry.crc,iterMap->first.c_str());
+	}
+	fclose(fp);
+
+	removeFile(indexFile);
+	if(renameFile(tempIndexFile, indexFile) == true) {
+		fileIndexDirty = false;
+	}
+}
+
+void Checksum::computeFileSums(vector<string> &paths, vector<uint32> &results) {
+	results.assign(paths.size(),0);
+	if(paths.empty() == true) {
+		return;
 	}
+
+	int workerCount = fileHashWorkerThreadCount;
+	if(workerCount < 0) {
+#ifdef WIN32
+		SYSTEM_INFO sysinfo;
+		GetSystemInfo(&sysinfo);
+		workerCount = (int)sysinfo.dwNumberOfProcessors - 1;
+#else
+		workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
 #endif
+	}
+	workerCount = min(workerCount,(int)(paths.size() / MIN_FILES_PER_WORKER));
+	if(workerCount < 0) {
+		workerCount = 0;
+	}
 
-    return fileExists;
+	ChecksumFileJobList jobs(paths, results);
+	vector<ChecksumFileWorkerThread *> workers;
+	for(int index = 0; index < workerCount; ++index) {
+		ChecksumFileWorkerThread *worker = new ChecksumFileWorkerThread(&jobs);
+		worker->start();
+		workers.push_back(worker);
+	}
+
+	jobs.process();
+
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		jobs.workerDone.waitTillSignalled();
+	}
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		if(workers[index]->shutdownAndJoin() == true) {
+			delete workers[index];
+		}
+	}
 }
 
 uint32 Checksum::getSum() {
@@ -367,27 +583,88 @@ uint32 Checksum::getSum() {
 	if(fileList.size() > 0) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] fileList.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,fileList.size());
 
-		Checksum newResult;
-
-		{
-
+		// Collect the files that are not yet in the in memory cache
+		vector<string> pendingFiles;
+		MutexSafeWrapper safeMutex(&Checksum::fileListCacheSynchAccessor,CODE_AT_LINE);
 		for(std::map<string,uint32>::iterator iterMap = fileList.begin();
 			iterMap != fileList.end(); ++iterMap) {
-
-			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,string(__FILE__) + "_" + intToStr(__LINE__));
 			if(Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
-				Checksum fileResult;
-				//bool fileAddedOk = fileResult.addFileToSum(iterMap->first);
-				fileResult.addFileToSum(iterMap->first);
-				Checksum::fileListCache[iterMap->first] = fileResult.getSum();
-				//printf("fileAddedOk = %d for file [%s] CRC [%d]\n",fileAddedOk,iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
+				pendingFiles.push_back(iterMap->first);
 			}
-			else {
-				//printf("Getting checksum from CACHE for file [%s] CRC [%d]\n",iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
+		}
+		safeMutex.ReleaseLock(true);
+
+		if(pendingFiles.empty() == false) {
+			Chrono chrono(true);
+
+			// Anything unchanged on disk since the last run comes from the persistent index
+			vector<string> hashFiles;
+			vector<ChecksumFileIndexEntry> hashFileKeys;
+			std::map<string,uint32> resolvedFiles;
+
+			MutexSafeWrapper safeMutexIndex(&Checksum::fileIndexSynchAccessor,CODE_AT_LINE);
+			loadFileIndex();
+			for(unsigned int index = 0; index < pendingFiles.size(); ++index) {
+				const string &path = pendingFiles[index];
+				ChecksumFileIndexEntry key;
+				if(getFileIndexKey(path, key) == false) {
+					resolvedFiles[path] = 0;
+					if(fileIndex.erase(path) > 0) {
+						fileIndexDirty = true;
+					}
+					continue;
+				}
+				std::map<string,ChecksumFileIndexEntry>::iterator iterFind = fileIndex.find(path);
+				if(iterFind != fileIndex.end() && iterFind->second.isSameFile(key) == true) {
+					resolvedFiles[path] = iterFind->second.crc;
+					stats.filesFromIndex++;
+				}
+				else {
+					hashFiles.push_back(path);
+					hashFileKeys.push_back(key);
+				}
 			}
-			newResult.addSum(Checksum::fileListCache[iterMap->first]);
+			safeMutexIndex.ReleaseLock(true);
+
+			vector<uint32> hashResults;
+			computeFileSums(hashFiles, hashResults);
+
+			safeMutexIndex.Lock();
+			int64 bytesHashed = 0;
+			for(unsigned int index = 0; index < hashFiles.size(); ++index) {
+				ChecksumFileIndexEntry &entry = fileIndex[hashFiles[index]];
+				entry = hashFileKeys[index];
+				entry.crc = hashResults[index];
+				resolvedFiles[hashFiles[index]] = hashResults[index];
+				bytesHashed += hashFileKeys[index].size;
+			}
+			if(hashFiles.empty() == false) {
+				fileIndexDirty = true;
+				stats.filesHashed += (int64)hashFiles.size();
+				stats.bytesHashed += bytesHashed;
+				stats.hashMillis += chrono.getMillis();
+			}
+			safeMutexIndex.ReleaseLock();
+
+			if(SystemFlags::VERBOSE_MODE_ENABLED && hashFiles.empty() == false) {
+				printf("CRC hashed %d of %d files (%.2f MB) in %lld msecs\n",(int)hashFiles.size(),(int)pendingFiles.size(),(double)bytesHashed / (1024.0 * 1024.0),(long long int)chrono.getMillis());
+			}
+
+			safeMutex.Lock();
+			for(std::map<string,uint32>::iterator iterMap = resolvedFiles.begin();
+				iterMap != resolvedFiles.end(); ++iterMap) {
+				Checksum::fileListCache[iterMap->first] = iterMap->second;
+			}
+			safeMutex.ReleaseLock(true);
 		}
+
+		Checksum newResult;
+		safeMutex.Lock();
+		for(std::map<string,uint32>::iterator iterMap = fileList.begin();
+			iterMap != fileList.end(); ++iterMap) {
+			newResult.addSum(Checksum::fileListCache[iterMap->first]);
 		}
+		safeMutex.ReleaseLock();
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] fileList.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,fileList.size());
 
@@ -417,16 +694,54 @@ uint32 Checksum::getFileCount() {
 	return (uint32)fileList.size();
 }
 
+void Checksum::flushFileIndex() {
+	MutexSafeWrapper safeMutex(&Checksum::fileIndexSynchAccessor,CODE_AT_LINE);
+	saveFileIndex();
+}
+
+void Checksum::reloadFileIndex() {
+	MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,CODE_AT_LINE);
+	Checksum::fileListCache.clear();
+	safeMutexSocketDestructorFlag.ReleaseLock();
+
+	MutexSafeWrapper safeMutexIndex(&Checksum::fileIndexSynchAccessor,CODE_AT_LINE);
+	saveFileIndex();
+	fileIndex.clear();
+	fileIndexDirty = false;
+	fileIndexLoaded = false;
+}
+
+ChecksumStats Checksum::getStats() {
+	MutexSafeWrapper safeMutex(&Checksum::fileIndexSynchAccessor,CODE_AT_LINE);
+	return stats;
+}
+
 void Checksum::removeFileFromCache(const string file) {
-	MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,CODE_AT_LINE);
     if(Checksum::fileListCache.find(file) != Checksum::fileListCache.end()) {
         Checksum::fileListCache.erase(file);
     }
+    safeMutexSocketDestructorFlag.ReleaseLock();
+
+	MutexSafeWrapper safeMutexIndex(&Checksum::fileIndexSynchAccessor,CODE_AT_LINE);
+	loadFileIndex();
+	if(fileIndex.erase(file) > 0) {
+		fileIndexDirty = true;
+	}
 }
 
 void Checksum::clearFileCache() {
-	MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,string(__FILE__) + "_" + intToStr(__LINE__));
+	MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,CODE_AT_LINE);
     Checksum::fileListCache.clear();
+    safeMutexSocketDestructorFlag.ReleaseLock();
+
+	// Loaded first so the entries on disk are dropped as well
+	MutexSafeWrapper safeMutexIndex(&Checksum::fileIndexSynchAccessor,CODE_AT_LINE);
+	loadFileIndex();
+	if(fileIndex.empty() == false) {
+		fileIndex.clear();
+		fileIndexDirty = true;
+	}
 }
 
 }}//end namespace
@@ -289,6 +289,11 @@ std::map<string,string> Properties::getTagReplacementValues(std::map<string,stri
 	return mapTagReplacementValues;
 }
 
+string Properties::getPathVariableTagStartCharacters() {
+	// The first character of every variable checked below
+	return "~$%{";
+}
+
 bool Properties::isValuePathVariable(const string &value) {
 	if(value.find("~/") != value.npos ||
 		value.find("$HOME") != value.npos ||
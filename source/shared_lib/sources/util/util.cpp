@@ -31,6 +31,7 @@
 #include "platform_common.h"
 #include "conversion.h"
 #include "simple_threads.h"
+#include "task_scheduler.h"
 #include "platform_util.h"
 #ifndef WIN32
 #include <errno.h>
@@ -59,7 +60,9 @@ bool SystemFlags::curl_global_init_called				= false;
 int SystemFlags::DEFAULT_HTTP_TIMEOUT					= 10;
 bool SystemFlags::VERBOSE_MODE_ENABLED  				= false;
 bool SystemFlags::ENABLE_THREADED_LOGGING 				= false;
-static LogFileThread *threadLogger 						= NULL;
+int SystemFlags::THREADED_LOGGING_RATE_LIMIT			= 0;
+static LogFileWriter *threadLogger 						= NULL;
+static int threadLoggerTaskId							= -1;
 bool SystemFlags::SHUTDOWN_PROGRAM_MODE                 = false;
 //
 
@@ -74,12 +77,12 @@ static void *myrealloc(void *ptr, size_t size)
 }
 
 bool SystemFlags::getThreadedLoggerRunning() {
-    return (threadLogger != NULL && threadLogger->getRunningStatus() == true);
+    return (threadLogger != NULL);
 }
 
 std::size_t SystemFlags::getLogEntryBufferCount() {
     std::size_t ret = 0;
-    if(threadLogger != NULL && threadLogger->getRunningStatus() == true) {
+    if(threadLogger != NULL) {
         ret = threadLogger->getLogEntryBufferCount();
     }
     return ret;
@@ -266,9 +269,15 @@ void SystemFlags::init(bool haveSpecialOutputCommandLineOption) {
 
     if(threadLogger == NULL && SystemFlags::SHUTDOWN_PROGRAM_MODE == false) {
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-        threadLogger = new LogFileThread();
-        threadLogger->start();
-        sleep(1);
+        // Written by a shared scheduler worker, -1 once the scheduler is shut down
+        LogFileWriter *logWriter = new LogFileWriter();
+        threadLoggerTaskId = TaskScheduler::getInstance().scheduleTask(logWriter,LogFileWriter::millisecsBetweenSaves,0,NULL,"LogFileWriter");
+        if(threadLoggerTaskId >= 0) {
+        	threadLogger = logWriter;
+        }
+        else {
+        	delete logWriter;
+        }
     }
 
     if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
@@ -329,26 +338,16 @@ void SystemFlags::Close() {
     if(threadLogger != NULL) {
         SystemFlags::ENABLE_THREADED_LOGGING = false;
         //SystemFlags::SHUTDOWN_PROGRAM_MODE=true;
-        time_t elapsed = time(NULL);
-        threadLogger->signalQuit();
         if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-        //threadLogger->shutdownAndWait();
-		for(;threadLogger->canShutdown(false) == false &&
-			difftime(time(NULL),elapsed) <= 15;) {
-			//sleep(150);
-		}
-		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-//		if(threadLogger->canShutdown(false)) {
-//			Sleep(0);
-//		}
-		if(threadLogger->shutdownAndWait() == true) {
+        // Already cancelled if the scheduler was shut down first
+        if(TaskScheduler::getInstance().cancelTask(threadLoggerTaskId,15000) == true) {
+        	threadLogger->flush();
 			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 			delete threadLogger;
 			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 		}
 		threadLogger = NULL;
-        //delete threadLogger;
-        //threadLogger = NULL;
+		threadLoggerTaskId = -1;
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
     }
 
@@ -416,28 +415,30 @@ void SystemFlags::handleDebug(DebugType type, const char *fmt, ...) {
     }
 
     va_list argList;
-    va_start(argList, fmt);
 
+    // The log writer task formats the entry
+    if( currentDebugLog.debugLogFileName != "" &&
+    	SystemFlags::ENABLE_THREADED_LOGGING &&
+    	threadLogger != NULL) {
+        va_start(argList, fmt);
+        threadLogger->addLogEntry(type, fmt, argList);
+        va_end(argList);
+        return;
+    }
+
+    va_start(argList, fmt);
     const int max_debug_buffer_size = 8096;
     char szBuf[max_debug_buffer_size]="";
     vsnprintf(szBuf,max_debug_buffer_size-1,fmt, argList);
     va_end(argList);
 
-    if( currentDebugLog.debugLogFileName != "" &&
-    	SystemFlags::ENABLE_THREADED_LOGGING &&
-    	threadLogger != NULL &&
-        threadLogger->getRunningStatus() == true) {
-        threadLogger->addLogEntry(type, szBuf);
-    }
-    else {
-        // Get the current time.
-        time_t curtime = time (NULL);
-        logDebugEntry(type, (szBuf[0] != '\0' ? szBuf : ""), curtime);
-    }
+    // Get the current time.
+    time_t curtime = time (NULL);
+    logDebugEntry(type, (szBuf[0] != '\0' ? szBuf : ""), curtime);
 }
 
 
-void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugTime) {
+void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugTime, bool flushStream) {
 	if(SystemFlags::debugLogFileList == NULL) {
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 		SystemFlags::init(false);
@@ -562,7 +563,7 @@ void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugT
             }
 
             if(currentDebugLog.fileStream->is_open() == true) {
-				MutexSafeWrapper safeMutex(currentDebugLog.mutex,string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+				MutexSafeWrapper safeMutex(currentDebugLog.mutex,CODE_AT_LINE);
 
 				(*currentDebugLog.fileStream) << "Starting Mega-Glest logging for type: " << type << "\n";
 				(*currentDebugLog.fileStream).flush();
@@ -574,7 +575,7 @@ void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugT
         assert(currentDebugLog.fileStream != NULL);
 
         if(currentDebugLog.fileStream->is_open() == true) {
-        	static string mutexCodeLocation = string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__);
+        	static const char *mutexCodeLocation = CODE_AT_LINE;
 			MutexSafeWrapper safeMutex(currentDebugLog.mutex,mutexCodeLocation);
 
 			// All items in the if clause we don't want timestamps
@@ -587,7 +588,9 @@ void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugT
 			else {
 				(*currentDebugLog.fileStream) << debugEntry.c_str();
 			}
-			(*currentDebugLog.fileStream).flush();
+			if(flushStream == true) {
+				(*currentDebugLog.fileStream).flush();
+			}
 
 			safeMutex.ReleaseLock();
         }
@@ -611,6 +614,23 @@ void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugT
     }
 }
 
+void SystemFlags::flushDebugLogs() {
+	if(SystemFlags::debugLogFileList == NULL) {
+		return;
+	}
+	for(std::map<SystemFlags::DebugType,SystemFlags::SystemFlagsType>::iterator iterMap = SystemFlags::debugLogFileList->begin();
+		iterMap != SystemFlags::debugLogFileList->end(); ++iterMap) {
+		SystemFlags::SystemFlagsType &currentDebugLog = iterMap->second;
+		// Shared streams are flushed through their owner
+		if(currentDebugLog.fileStreamOwner == true &&
+			currentDebugLog.fileStream != NULL &&
+			currentDebugLog.fileStream->is_open() == true) {
+			MutexSafeWrapper safeMutex(currentDebugLog.mutex,CODE_AT_LINE);
+			(*currentDebugLog.fileStream).flush();
+			safeMutex.ReleaseLock();
+		}
+	}
+}
 
 string lastDir(const string &s) {
 	size_t i= s.find_last_of('/');
@@ -15,6 +15,8 @@
 #include <fstream>
 #include <stdexcept>
 #include <vector>
+#include <set>
+#include <new>
 #include <algorithm>
 
 #include "conversion.h"
@@ -33,6 +35,8 @@
 #include "platform_util.h"
 #include "cache_manager.h"
 
+#include "thread.h"
+
 #include "rapidxml/rapidxml_print.hpp"
 #include "leak_dumper.h"
 
@@ -43,6 +47,7 @@ XERCES_CPP_NAMESPACE_USE
 #endif
 
 using namespace std;
+using namespace Shared::Platform;
 using namespace Shared::PlatformCommon;
 
 namespace Shared { namespace Xml {
@@ -227,7 +232,8 @@ XmlNode *XmlIo::load(const string &path, const std::map<string,string> &mapTagRe
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("XERCES_FULLVERSIONDOT [%s]\nnoValidation = %d\npath [%s]\n",XERCES_FULLVERSIONDOT,noValidation,path.c_str());
 
 		DOMNode *domNode = loadDOMNode(path, noValidation);
-		XmlNode *rootNode= new XmlNode(domNode,mapTagReplacementValues);
+		const XmlTagReplacementContext tagReplacementContext(mapTagReplacementValues);
+		XmlNode *rootNode= new XmlNode(domNode,tagReplacementContext);
 		releaseDOMParser();
 
 		return rootNode;
@@ -406,7 +412,8 @@ XmlNode *XmlIoRapid::load(const string &path, const std::map<string,string> &map
 
         if(showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
-		rootNode= new XmlNode(doc.first_node(),mapTagReplacementValues, skipUpdatePathClimbingParts);
+		const XmlTagReplacementContext tagReplacementContext(mapTagReplacementValues);
+		rootNode= new XmlNode(doc.first_node(),tagReplacementContext, skipUpdatePathClimbingParts);
 
 		if(showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
@@ -612,13 +619,102 @@ XmlTree::~XmlTree() {
 	clearRootNode();
 }
 
+// =====================================================
+//	class XmlNodeArena
+//
+///	Storage for the nodes and attributes of one loaded
+/// document, released in one go with the root node. The
+/// element and attribute names are interned per document,
+/// every node or attribute with the same name points at
+/// one string.
+// =====================================================
+
+class XmlNodeArena {
+private:
+	static const size_t initialBlockSize	= 4096;
+	static const size_t maxBlockSize		= 65536;
+	static const size_t alignment			= 16;
+
+	vector<char *> blocks;
+	size_t blockSize;
+	size_t blockUsed;
+	std::set<string> names;
+
+private:
+	XmlNodeArena(XmlNodeArena&);
+	void operator =(XmlNodeArena&);
+
+public:
+	XmlNodeArena() : blockSize(0), blockUsed(0) {}
+	~XmlNodeArena() {
+		for(unsigned int i = 0; i < blocks.size(); ++i) {
+			delete [] blocks[i];
+		}
+		blocks.clear();
+	}
+
+	void *allocate(size_t size) {
+		size = (size + alignment - 1) & ~(alignment - 1);
+		if(blocks.empty() == true || blockUsed + size > blockSize) {
+			blockSize = (blocks.empty() == true ? initialBlockSize : min(blockSize * 2, maxBlockSize));
+			if(blockSize < size) {
+				blockSize = size;
+			}
+			blocks.push_back(new char[blockSize]);
+			blockUsed = 0;
+		}
+		void *result = blocks.back() + blockUsed;
+		blockUsed += size;
+		return result;
+	}
+
+	const string *intern(const string &name) {
+		return &(*names.insert(name).first);
+	}
+};
+
+const size_t XmlNodeArena::initialBlockSize;
+const size_t XmlNodeArena::maxBlockSize;
+const size_t XmlNodeArena::alignment;
+
+// =====================================================
+//	class XmlTagReplacementContext
+// =====================================================
+
+XmlTagReplacementContext::XmlTagReplacementContext(const std::map<string,string> &mapTagReplacementValues) {
+	this->mapTagReplacementValues	= &mapTagReplacementValues;
+	this->alwaysApplyTags			= false;
+	this->tagStartCharacters		= Properties::getPathVariableTagStartCharacters();
+
+	for(std::map<string,string>::const_iterator iterMap = mapTagReplacementValues.begin();
+			iterMap != mapTagReplacementValues.end(); ++iterMap) {
+		if(iterMap->first.empty() == true) {
+			alwaysApplyTags = true;
+		}
+		else if(tagStartCharacters.find(iterMap->first[0]) == string::npos) {
+			tagStartCharacters += iterMap->first[0];
+		}
+	}
+}
+
+bool XmlTagReplacementContext::applyTagsToValue(string &value, bool skipUpdatePathClimbingParts) const {
+	// Every replacement key and path variable starts with one of these
+	// characters so a value without any of them can never change
+	if(alwaysApplyTags == false &&
+		value.find_first_of(tagStartCharacters) == string::npos) {
+		return false;
+	}
+	return Properties::applyTagsToValue(value,mapTagReplacementValues,skipUpdatePathClimbingParts);
+}
+
 // =====================================================
 //	class XmlNode
 // =====================================================
 
 #if defined(WANT_XERCES)
 
-XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacementValues): superNode(NULL) {
+XmlNode::XmlNode(DOMNode *node, const XmlTagReplacementContext &tagReplacementContext):
+		superNode(NULL), arena(NULL), arenaAllocated(false) {
     if(node == NULL || node->getNodeName() == NULL) {
         throw megaglest_runtime_error("XML structure seems to be corrupt!");
     }
@@ -626,11 +722,13 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 	//get name
 	char str[strSize]="";
 	XMLString::transcode(node->getNodeName(), str, strSize-1);
-	name= str;
 
 	//check document
 	if(node->getNodeType() == DOMNode::DOCUMENT_NODE) {
-		name="document";
+		name= new string("document");
+	}
+	else {
+		name= new string(str);
 	}
 
 	//check children
@@ -638,7 +736,7 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
         for(unsigned int i = 0; i < node->getChildNodes()->getLength(); ++i) {
             DOMNode *currentNode= node->getChildNodes()->item(i);
             if(currentNode != NULL && currentNode->getNodeType()==DOMNode::ELEMENT_NODE){
-                XmlNode *xmlNode= new XmlNode(currentNode, mapTagReplacementValues);
+                XmlNode *xmlNode= new XmlNode(currentNode, tagReplacementContext);
                 children.push_back(xmlNode);
             }
         }
@@ -650,7 +748,7 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 		for(unsigned int i = 0; i < domAttributes->getLength(); ++i) {
 			DOMNode *currentNode= domAttributes->item(i);
 			if(currentNode->getNodeType() == DOMNode::ATTRIBUTE_NODE) {
-				XmlAttribute *xmlAttribute= new XmlAttribute(domAttributes->item(i), mapTagReplacementValues);
+				XmlAttribute *xmlAttribute= new XmlAttribute(domAttributes->item(i), tagReplacementContext);
 				attributes.push_back(xmlAttribute);
 			}
 		}
@@ -663,33 +761,78 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 		//Properties::applyTagsToValue(this->text);
 		XMLString::release(&textStr);
 	}
+
+	buildChildIndex();
+}
+
+#endif
+
+XmlNode::XmlNode(xml_node<> *node, const XmlTagReplacementContext &tagReplacementContext,
+		bool skipUpdatePathClimbingParts) : superNode(NULL), arena(NULL), arenaAllocated(false) {
+	// The root of a loaded document owns the arena for all of its descendants
+	arena = new XmlNodeArena();
+	try {
+		loadRapidXmlNode(node, tagReplacementContext, skipUpdatePathClimbingParts);
+	}
+	catch(...) {
+		destroyChildren();
+		delete arena;
+		arena = NULL;
+		throw;
+	}
+}
+
+XmlNode::XmlNode(xml_node<> *node, const XmlTagReplacementContext &tagReplacementContext,
+		bool skipUpdatePathClimbingParts, XmlNodeArena *arena) :
+		superNode(NULL), arena(arena), arenaAllocated(true) {
+	loadRapidXmlNode(node, tagReplacementContext, skipUpdatePathClimbingParts);
 }
 
+// Children are placement constructed in the arena, which the leak
+// dumper's new macro would break
+#if defined(SL_LEAK_DUMP)
+#undef new
 #endif
 
-XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,
-		bool skipUpdatePathClimbingParts) : superNode(NULL) {
+void XmlNode::loadRapidXmlNode(xml_node<> *node, const XmlTagReplacementContext &tagReplacementContext,
+		bool skipUpdatePathClimbingParts) {
 	if(node == NULL || node->name() == NULL) {
         throw megaglest_runtime_error("XML structure seems to be corrupt!");
     }
 
 	//get name
-	name = node->name();
-	children.reserve(1000);
-	attributes.reserve(1000);
-
 	//check document
 	if(node->type() == node_document) {
-		name="document";
+		name = arena->intern("document");
 	}
+	else {
+		name = arena->intern(node->name());
+	}
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n",name->c_str(),node->value());
 
-	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n",name.c_str(),node->value());
+	// Size the lists exactly instead of reserving for the worst case
+	unsigned int childCount = 0;
+	for(xml_node<> *currentNode = node->first_node();
+			currentNode; currentNode = currentNode->next_sibling()) {
+		if(currentNode->type() == node_element) {
+			childCount++;
+		}
+	}
+	unsigned int attributeCount = 0;
+	for (xml_attribute<> *attr = node->first_attribute();
+			attr; attr = attr->next_attribute()) {
+		attributeCount++;
+	}
+	children.reserve(childCount);
+	attributes.reserve(attributeCount);
 
 	//check children
 	for(xml_node<> *currentNode = node->first_node();
 			currentNode; currentNode = currentNode->next_sibling()) {
 		if(currentNode != NULL && currentNode->type() == node_element) {
-			XmlNode *xmlNode= new XmlNode(currentNode, mapTagReplacementValues, skipUpdatePathClimbingParts);
+			void *nodeMemory = arena->allocate(sizeof(XmlNode));
+			XmlNode *xmlNode= new(nodeMemory) XmlNode(currentNode, tagReplacementContext, skipUpdatePathClimbingParts, arena);
 			children.push_back(xmlNode);
 		}
     }
@@ -697,7 +840,8 @@ XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacem
 	//check attributes
 	for (xml_attribute<> *attr = node->first_attribute();
 			attr; attr = attr->next_attribute()) {
-		XmlAttribute *xmlAttribute= new XmlAttribute(attr, mapTagReplacementValues);
+		void *attributeMemory = arena->allocate(sizeof(XmlAttribute));
+		XmlAttribute *xmlAttribute= new(attributeMemory) XmlAttribute(attr, tagReplacementContext, arena);
 		attributes.push_back(xmlAttribute);
 	}
 
@@ -710,29 +854,122 @@ XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacem
 //			printf("\n----------------------\n** XML!! WILL REPLACE [%s]\n",xmlText.c_str());
 //			debugReplace = true;
 //		}
-		Properties::applyTagsToValue(xmlText,&mapTagReplacementValues, skipUpdatePathClimbingParts);
+		tagReplacementContext.applyTagsToValue(xmlText, skipUpdatePathClimbingParts);
 //		if(debugReplace) {
 //			printf("\n\n** XML!! REPLACED WITH [%s]\n===================\n",xmlText.c_str());
 //		}
 		text = xmlText;
 	}
+
+	buildChildIndex();
 }
 
-XmlNode::XmlNode(const string &name): superNode(NULL) {
-	this->name= name;
+#if defined(SL_LEAK_DUMP)
+#define new new(__FILE__, __LINE__,AllocInfo::getStackTrace())
+#endif
+
+XmlNode::XmlNode(const string &name): superNode(NULL), arena(NULL), arenaAllocated(false) {
+	this->name= new string(name);
 }
 
 XmlNode::~XmlNode() {
+	destroyChildren();
+	// Loaded nodes share the names of their document's arena
+	if(arena == NULL) {
+		delete name;
+	}
+	name = NULL;
+	if(arenaAllocated == false) {
+		delete arena;
+	}
+	arena = NULL;
+}
+
+void XmlNode::destroyChild(XmlNode *node) {
+	if(node->arenaAllocated == true) {
+		node->~XmlNode();
+	}
+	else {
+		delete node;
+	}
+}
+
+void XmlNode::destroyChildren() {
 	for(unsigned int i=0; i<children.size(); ++i) {
-		delete children[i];
+		destroyChild(children[i]);
 	}
 	children.clear();
+	childNameIndex.clear();
 	for(unsigned int i=0; i<attributes.size(); ++i) {
-		delete attributes[i];
+		if(attributes[i]->arenaAllocated == true) {
+			attributes[i]->~XmlAttribute();
+		}
+		else {
+			delete attributes[i];
+		}
 	}
 	attributes.clear();
 }
 
+class XmlNameLess {
+public:
+	bool operator()(const string *name1, const string *name2) const { return *name1 < *name2; }
+};
+
+void XmlNode::buildChildIndex() {
+	childNameIndex.clear();
+
+	// Small nodes are scanned faster than they are indexed
+	const unsigned int minimumIndexedChildCount = 8;
+	if(children.size() < minimumIndexedChildCount) {
+		return;
+	}
+
+	// Children added after loading have names of their own, so the
+	// names are compared by value
+	std::map<const string *,unsigned int,XmlNameLess> entryByName;
+	for(unsigned int i = 0; i < children.size(); ++i) {
+		XmlNode *child = children[i];
+		std::map<const string *,unsigned int,XmlNameLess>::iterator iterFind = entryByName.find(child->name);
+		unsigned int entryIndex = 0;
+		if(iterFind == entryByName.end()) {
+			entryIndex = (unsigned int)childNameIndex.size();
+			entryByName[child->name] = entryIndex;
+			childNameIndex.push_back(ChildIndexEntry());
+			childNameIndex.back().name = child->name;
+		}
+		else {
+			entryIndex = iterFind->second;
+		}
+		childNameIndex[entryIndex].nodes.push_back(child);
+	}
+	std::sort(childNameIndex.begin(),childNameIndex.end());
+}
+
+const vector<XmlNode*> *XmlNode::getIndexedChildren(const string &childName) const {
+	static const vector<XmlNode*> noChildren;
+	if(childNameIndex.empty() == true) {
+		return NULL;
+	}
+	// Binary search of the entries sorted by name
+	unsigned int low = 0;
+	unsigned int high = (unsigned int)childNameIndex.size();
+	while(low < high) {
+		unsigned int middle = low + (high - low) / 2;
+		int result = childNameIndex[middle].name->compare(childName);
+		if(result == 0) {
+			return &childNameIndex[middle].nodes;
+		}
+		else if(result < 0) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return &noChildren;
+}
+
 XmlAttribute *XmlNode::getAttribute(unsigned int i) const {
 	if(i >= attributes.size()) {
 		throw megaglest_runtime_error(getName()+" node doesn't have " + uIntToStr(i) + " attributes");
@@ -768,11 +1005,14 @@ int XmlNode::clearChild(const string &childName) {
 	int clearChildCount = 0;
 	for(int i = (int)children.size()-1; i >= 0; --i) {
 		if(children[i]->getName() == childName) {
-			delete children[i];
+			destroyChild(children[i]);
 			children.erase(children.begin()+i);
 			clearChildCount++;
 		}
 	}
+	if(clearChildCount > 0) {
+		buildChildIndex();
+	}
 	return clearChildCount;
 }
 
@@ -785,6 +1025,11 @@ XmlNode *XmlNode::getChild(unsigned int i) const {
 }
 
 vector<XmlNode *> XmlNode::getChildList(const string &childName) const {
+	const vector<XmlNode*> *indexedChildren = getIndexedChildren(childName);
+	if(indexedChildren != NULL) {
+		return *indexedChildren;
+	}
+
 	vector<XmlNode *> list;
 	for(unsigned int j = 0; j < children.size(); ++j) {
 		if(children[j]->getName() == childName) {
@@ -800,7 +1045,12 @@ XmlNode *XmlNode::getChild(const string &childName, unsigned int i) const {
 		return superNode->getChild(childName,i);
 	}
 	if(i >= children.size()) {
-		throw megaglest_runtime_error("\"" + name + "\" node doesn't have " + uIntToStr(i+1) +" children named \"" + childName + "\"\n\nTree: "+getTreeString());
+		throw megaglest_runtime_error("\"" + getName() + "\" node doesn't have " + uIntToStr(i+1) +" children named \"" + childName + "\"\n\nTree: "+getTreeString());
+	}
+
+	const vector<XmlNode*> *indexedChildren = getIndexedChildren(childName);
+	if(indexedChildren != NULL && i < indexedChildren->size()) {
+		return (*indexedChildren)[i];
 	}
 
 	unsigned int count= 0;
@@ -817,6 +1067,11 @@ XmlNode *XmlNode::getChild(const string &childName, unsigned int i) const {
 }
 
 bool XmlNode::hasChildNoSuper(const string &childName) const {
+	const vector<XmlNode*> *indexedChildren = getIndexedChildren(childName);
+	if(indexedChildren != NULL) {
+		return (indexedChildren->empty() == false);
+	}
+
 	//int count= 0;
 	for(unsigned int j = 0; j < children.size(); ++j) {
 		if(children[j]->getName() == childName) {
@@ -832,7 +1087,15 @@ XmlNode * XmlNode::getChildWithAliases(vector<string> childNameList, unsigned in
 			return superNode->getChild(childName,childIndex);
 		}
 		if(childIndex >= children.size()) {
-			throw megaglest_runtime_error("\"" + name + "\" node doesn't have "+intToStr(childIndex+1)+" children named \"" + childName + "\"\n\nTree: "+getTreeString());
+			throw megaglest_runtime_error("\"" + getName() + "\" node doesn't have "+intToStr(childIndex+1)+" children named \"" + childName + "\"\n\nTree: "+getTreeString());
+		}
+
+		const vector<XmlNode*> *indexedChildren = getIndexedChildren(childName);
+		if(indexedChildren != NULL) {
+			if(childIndex < indexedChildren->size()) {
+				return (*indexedChildren)[childIndex];
+			}
+			continue;
 		}
 
 		unsigned int count= 0;
@@ -852,6 +1115,12 @@ XmlNode * XmlNode::getChildWithAliases(vector<string> childNameList, unsigned in
 bool XmlNode::hasChildAtIndex(const string &childName, int i) const {
 	if(superNode && !hasChildNoSuper(childName))
 		return superNode->hasChildAtIndex(childName,i);
+
+	const vector<XmlNode*> *indexedChildren = getIndexedChildren(childName);
+	if(indexedChildren != NULL) {
+		return (i >= 0 && i < (int)indexedChildren->size());
+	}
+
 	int count= 0;
 	for(unsigned int j = 0; j < children.size(); ++j) {
 		//printf("Looking for [%s] at index: %d found [%s] index = %d\n",childName.c_str(),i,children[j]->getName().c_str(),j);
@@ -887,6 +1156,7 @@ XmlNode *XmlNode::addChild(const string &name, const string text) {
 	XmlNode *node= new XmlNode(name);
 	node->text = text;
 	children.push_back(node);
+	childNameIndex.clear();
 	return node;
 }
 
@@ -900,7 +1170,7 @@ XmlAttribute *XmlNode::addAttribute(const string &name, const string &value, con
 
 DOMElement *XmlNode::buildElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *document) const{
 	XMLCh str[strSize];
-	XMLString::transcode(name.c_str(), str, strSize-1);
+	XMLString::transcode(name->c_str(), str, strSize-1);
 
 	DOMElement *node= document->createElement(str);
 
@@ -924,7 +1194,7 @@ DOMElement *XmlNode::buildElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *do
 #endif
 
 xml_node<>* XmlNode::buildElement(xml_document<> *document) const {
-	xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name.c_str()));
+	xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name->c_str()));
 
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
 		node->append_attribute(
@@ -963,59 +1233,69 @@ string XmlNode::getTreeString() const {
 
 #if defined(WANT_XERCES)
 
-XmlAttribute::XmlAttribute(DOMNode *attribute, const std::map<string,string> &mapTagReplacementValues) {
+XmlAttribute::XmlAttribute(DOMNode *attribute, const XmlTagReplacementContext &tagReplacementContext) {
 	if(attribute == NULL || attribute->getNodeName() == NULL) {
         throw megaglest_runtime_error("XML attribute seems to be corrupt!");
     }
 
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	this->mapTagReplacementValues 	= mapTagReplacementValues;
+	arenaAllocated					= false;
 	char str[strSize]				= "";
 
 	XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 	value= str;
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	skipRestrictionCheck = tagReplacementContext.applyTagsToValue(this->value);
 
 	XMLString::transcode(attribute->getNodeName(), str, strSize-1);
-	name= str;
+	name= new string(str);
 }
 
 #endif
 
-XmlAttribute::XmlAttribute(xml_attribute<> *attribute, const std::map<string,string> &mapTagReplacementValues) {
+XmlAttribute::XmlAttribute(xml_attribute<> *attribute, const XmlTagReplacementContext &tagReplacementContext,
+		XmlNodeArena *arena) {
 	if(attribute == NULL || attribute->name() == NULL) {
         throw megaglest_runtime_error("XML attribute seems to be corrupt!");
     }
 
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	if(mapTagReplacementValues.size() > 0) {
-		this->mapTagReplacementValues 	= mapTagReplacementValues;
-	}
+	arenaAllocated					= (arena != NULL);
 	//char str[strSize]				= "";
 
 	//XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 	value= attribute->value();
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	skipRestrictionCheck = tagReplacementContext.applyTagsToValue(this->value);
 
 	//XMLString::transcode(attribute->getNodeName(), str, strSize-1);
-	name= attribute->name();
+	if(arena != NULL) {
+		name= arena->intern(attribute->name());
+	}
+	else {
+		name= new string(attribute->name());
+	}
 }
 
-XmlAttribute::XmlAttribute(const string &name, const string &value, const std::map<string,string> &mapTagReplacementValues) {
+XmlAttribute::XmlAttribute(const string &name, const string &value, const XmlTagReplacementContext &tagReplacementContext) {
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	if(mapTagReplacementValues.size() > 0) {
-		this->mapTagReplacementValues 	= mapTagReplacementValues;
-	}
-	this->name						= name;
+	arenaAllocated					= false;
+	this->name						= new string(name);
 	this->value						= value;
 
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	skipRestrictionCheck = tagReplacementContext.applyTagsToValue(this->value);
+}
+
+XmlAttribute::~XmlAttribute() {
+	// Attributes in an arena share the names of their document
+	if(arenaAllocated == false) {
+		delete name;
+	}
+	name = NULL;
 }
 
 bool XmlAttribute::getBoolValue() const {
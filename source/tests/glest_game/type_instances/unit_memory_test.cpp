@@ -0,0 +1,64 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "unit_memory.h"
+
+using namespace Glest::Game;
+using namespace Shared::Graphics;
+
+//
+// Tests for UnitColdState and UnitMemoryUsage classes
+//
+class UnitMemoryTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( UnitMemoryTest );
+
+	CPPUNIT_TEST( test_cold_state_bytes );
+	CPPUNIT_TEST( test_usage_string );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_cold_state_bytes() {
+		UnitColdState coldState;
+		CPPUNIT_ASSERT_EQUAL( sizeof(UnitColdState),coldState.getMemoryBytes() );
+
+		coldState.lastSynchDataString = string(100, 'x');
+		size_t stringBytes = coldState.getMemoryBytes();
+		CPPUNIT_ASSERT( stringBytes >= sizeof(UnitColdState) + 101 );
+
+		coldState.badHarvestPosList[Vec2i(3, 4)] = 10;
+		CPPUNIT_ASSERT_EQUAL( stringBytes + sizeof(std::pair<Vec2i,int>) + UnitMemoryUsage::mapNodeOverhead,coldState.getMemoryBytes() );
+
+		coldState.networkCRCDecHpList.push_back(string(50, 'y'));
+		CPPUNIT_ASSERT( coldState.getMemoryBytes() >= stringBytes + sizeof(string) + 51 );
+	}
+
+	void test_usage_string() {
+		UnitMemoryUsage usage;
+		CPPUNIT_ASSERT_EQUAL( (uint64)0,usage.getTotalBytes() );
+		CPPUNIT_ASSERT_EQUAL( string("units [0] cold [0] bytes/unit: object [0] path [0] commands [0] particles [0] fow [0] explored [0] boosts [0] cold [0] all [0] total KB: 0"),usage.toString() );
+
+		usage.unitCount = 2;
+		usage.coldStateCount = 1;
+		usage.bytes[UnitMemoryUsage::umObject] = 4000;
+		usage.bytes[UnitMemoryUsage::umPath] = 400;
+		CPPUNIT_ASSERT_EQUAL( (uint64)4400,usage.getTotalBytes() );
+		CPPUNIT_ASSERT_EQUAL( string("units [2] cold [1] bytes/unit: object [2,000] path [200] commands [0] particles [0] fow [0] explored [0] boosts [0] cold [0] all [2,200] total KB: 4"),usage.toString() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( UnitMemoryTest );
+//
@@ -0,0 +1,249 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "unit_path.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include <list>
+#include <vector>
+#include <cstdio>
+
+using namespace Glest::Game;
+using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility methods for tests
+//
+
+// The path finder refills a path every 10 to 20 cells
+static const int unitPathTestCellCount = 20;
+
+static Vec2i getUnitPathTestCell(int unit, int walk, int cell) {
+	return Vec2i(unit % 256 + cell, walk + cell);
+}
+
+// Unit paths as they were before they kept their cells inline
+class VectorTestPath {
+private:
+	vector<Vec2i> pathQueue;
+public:
+	void add(const Vec2i &pos)	{ pathQueue.push_back(pos); }
+	bool isEmpty() const		{ return pathQueue.empty(); }
+	Vec2i pop() {
+		Vec2i result = pathQueue.front();
+		pathQueue.erase(pathQueue.begin());
+		return result;
+	}
+};
+
+class ListTestPath {
+private:
+	list<Vec2i> cells;
+public:
+	void add(const Vec2i &pos)	{ cells.push_front(pos); }
+	bool isEmpty() const		{ return cells.empty(); }
+	Vec2i peek()				{ return cells.front(); }
+	void pop()					{ cells.pop_front(); }
+};
+
+// Refills the paths the way the path finder does and walks them like
+// moving units, returns the sum of the visited cells
+template<typename Path>
+static int64 walkTestBasicPaths(std::vector<Path> &paths, int walkCount) {
+	int64 result = 0;
+	for(int walk = 0; walk < walkCount; ++walk) {
+		for(unsigned int unit = 0; unit < paths.size(); ++unit) {
+			Path &path = paths[unit];
+			for(int cell = 0; cell < unitPathTestCellCount; ++cell) {
+				path.add(getUnitPathTestCell(unit, walk, cell));
+			}
+			for(;path.isEmpty() == false;) {
+				Vec2i pos = path.pop();
+				result += pos.x + pos.y;
+			}
+		}
+	}
+	return result;
+}
+
+// UnitPath takes its cells last one first
+template<typename Path>
+static int64 walkTestPaths(std::vector<Path> &paths, int walkCount) {
+	int64 result = 0;
+	for(int walk = 0; walk < walkCount; ++walk) {
+		for(unsigned int unit = 0; unit < paths.size(); ++unit) {
+			Path &path = paths[unit];
+			for(int cell = unitPathTestCellCount - 1; cell >= 0; --cell) {
+				path.add(getUnitPathTestCell(unit, walk, cell));
+			}
+			for(;path.isEmpty() == false;) {
+				Vec2i pos = path.peek();
+				result += pos.x + pos.y;
+				path.pop();
+			}
+		}
+	}
+	return result;
+}
+
+//
+// Tests for UnitPathBasic and UnitPath classes
+//
+class UnitPathTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( UnitPathTest );
+
+	CPPUNIT_TEST( test_basic_path_order );
+	CPPUNIT_TEST( test_basic_path_blocked );
+	CPPUNIT_TEST( test_path_order );
+	CPPUNIT_TEST( test_memory_bytes );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_basic_path_order() {
+		UnitPathBasic path;
+		CPPUNIT_ASSERT( path.isEmpty() == true );
+		for(int cell = 0; cell < 3; ++cell) {
+			path.add(Vec2i(cell, -cell));
+		}
+		CPPUNIT_ASSERT_EQUAL( 3,path.getQueueCount() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(1, -1),path.getQueue()[1] );
+
+		// Peeking keeps the cell
+		CPPUNIT_ASSERT_EQUAL( Vec2i(0, 0),path.pop(false) );
+		CPPUNIT_ASSERT_EQUAL( 3,path.getQueueCount() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(0, 0),path.pop() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(1, -1),path.pop() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(2, -2),path.pop() );
+		CPPUNIT_ASSERT( path.isEmpty() == true );
+		CPPUNIT_ASSERT_THROW( path.pop(),megaglest_runtime_error );
+	}
+
+	void test_basic_path_blocked() {
+		UnitPathBasic path;
+		path.add(Vec2i(1, 1));
+		path.incBlockCount();
+		CPPUNIT_ASSERT( path.isEmpty() == true );
+		CPPUNIT_ASSERT( path.isBlocked() == false );
+
+		for(int count = 1; count < 20; ++count) {
+			path.incBlockCount();
+		}
+		CPPUNIT_ASSERT( path.isBlocked() == true );
+		CPPUNIT_ASSERT( path.isStuck() == false );
+		for(int count = 0; count < 20; ++count) {
+			path.incBlockCount();
+		}
+		CPPUNIT_ASSERT( path.isStuck() == true );
+
+		path.clear();
+		CPPUNIT_ASSERT_EQUAL( 0,path.getBlockCount() );
+	}
+
+	void test_path_order() {
+		UnitPath path;
+		for(int cell = 2; cell >= 0; --cell) {
+			path.add(Vec2i(cell, -cell));
+		}
+		CPPUNIT_ASSERT_EQUAL( 3,path.size() );
+		vector<Vec2i> queue = path.getQueue();
+		CPPUNIT_ASSERT_EQUAL( Vec2i(0, 0),queue[0] );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(2, -2),queue[2] );
+
+		for(int cell = 0; cell < 3; ++cell) {
+			CPPUNIT_ASSERT_EQUAL( Vec2i(cell, -cell),path.peek() );
+			path.pop();
+		}
+		CPPUNIT_ASSERT( path.empty() == true );
+	}
+
+	void test_memory_bytes() {
+		UnitPathBasic basicPath;
+		UnitPath path;
+		for(int cell = 0; cell < unitPathTestCellCount; ++cell) {
+			basicPath.add(Vec2i(cell, cell));
+			path.add(Vec2i(cell, cell));
+		}
+		// A refilled path stays inline
+		CPPUNIT_ASSERT_EQUAL( sizeof(UnitPathBasic),basicPath.getMemoryBytes() );
+		CPPUNIT_ASSERT_EQUAL( sizeof(UnitPath),path.getMemoryBytes() );
+
+		basicPath.add(Vec2i(0, 0));
+		path.add(Vec2i(0, 0));
+		CPPUNIT_ASSERT( basicPath.getMemoryBytes() >= sizeof(UnitPathBasic) + 21 * sizeof(Vec2i) );
+		CPPUNIT_ASSERT( path.getMemoryBytes() >= sizeof(UnitPath) + 21 * sizeof(Vec2i) );
+	}
+};
+
+//
+// Benchmark of unit paths, run with --benchmark
+//
+class UnitPathBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( UnitPathBenchmark );
+
+	CPPUNIT_TEST( test_walk_paths );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_walk_paths() {
+		const int unitCount = 10000;
+		const int walkCount = 10;
+
+		std::vector<VectorTestPath> vectorPaths(unitCount);
+		std::vector<UnitPathBasic> basicPaths(unitCount);
+		std::vector<ListTestPath> listPaths(unitCount);
+		std::vector<UnitPath> paths(unitCount);
+
+		Chrono chrono(true);
+		int64 vectorSum = walkTestBasicPaths(vectorPaths, walkCount);
+		int64 vectorMicros = chrono.getMicros();
+
+		chrono.start();
+		int64 basicSum = walkTestBasicPaths(basicPaths, walkCount);
+		int64 basicMicros = chrono.getMicros();
+
+		chrono.start();
+		int64 listSum = walkTestPaths(listPaths, walkCount);
+		int64 listMicros = chrono.getMicros();
+
+		chrono.start();
+		int64 pathSum = walkTestPaths(paths, walkCount);
+		int64 pathMicros = chrono.getMicros();
+
+		CPPUNIT_ASSERT_EQUAL( vectorSum,basicSum );
+		CPPUNIT_ASSERT_EQUAL( vectorSum,listSum );
+		CPPUNIT_ASSERT_EQUAL( vectorSum,pathSum );
+
+		size_t basicBytes = 0;
+		size_t pathBytes = 0;
+		for(int unit = 0; unit < unitCount; ++unit) {
+			basicBytes += basicPaths[unit].getMemoryBytes();
+			pathBytes += paths[unit].getMemoryBytes();
+		}
+
+		printf("\n%d unit paths of %d cells walked %d times: vector " MG_I64_SPECIFIER " usecs, UnitPathBasic " MG_I64_SPECIFIER " usecs [" MG_SIZE_T_SPECIFIER " KB], list " MG_I64_SPECIFIER " usecs, UnitPath " MG_I64_SPECIFIER " usecs [" MG_SIZE_T_SPECIFIER " KB]\n",
+				unitCount,unitPathTestCellCount,walkCount,vectorMicros,basicMicros,basicBytes / 1000,listMicros,pathMicros,pathBytes / 1000);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( UnitPathTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( UnitPathBenchmark, "benchmark" );
+//
@@ -0,0 +1,144 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "interpolation.h"
+#include "platform_util.h"
+#include <vector>
+#include <cstdio>
+
+using namespace Shared::Graphics;
+using namespace Shared::Platform;
+
+//
+// Utility methods for tests
+//
+static void createInterpolationTestFrames(std::vector<Vec3f> &frames, uint32 frameCount, uint32 vertexCount) {
+	frames.resize(frameCount * vertexCount);
+	for(uint32 frame = 0; frame < frameCount; ++frame) {
+		for(uint32 i = 0; i < vertexCount; ++i) {
+			frames[frame * vertexCount + i] = Vec3f(i * 0.5f + frame, (float)frame * frame - i, i * 0.25f - frame * 3.0f);
+		}
+	}
+}
+
+//
+// Tests for InterpolationPoseCache class
+//
+class InterpolationTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( InterpolationTest );
+
+	CPPUNIT_TEST( test_lerp_matches_vec3_lerp );
+	CPPUNIT_TEST( test_shared_poses_are_computed_once );
+	CPPUNIT_TEST( test_quantize_local_t );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_lerp_matches_vec3_lerp() {
+		const uint32 vertexCount = 37;
+		std::vector<Vec3f> frames;
+		createInterpolationTestFrames(frames, 2, vertexCount);
+
+		InterpolationPoseCache cache(vertexCount, 1);
+		const float localT = 0.3f;
+		const Vec3f *pose = cache.getPose(&frames[0], 0, 1, localT);
+		for(uint32 i = 0; i < vertexCount; ++i) {
+			Vec3f expected = frames[i].lerp(localT, frames[vertexCount + i]);
+			CPPUNIT_ASSERT_EQUAL( expected.x,pose[i].x );
+			CPPUNIT_ASSERT_EQUAL( expected.y,pose[i].y );
+			CPPUNIT_ASSERT_EQUAL( expected.z,pose[i].z );
+		}
+	}
+
+	void test_shared_poses_are_computed_once() {
+		const uint32 vertexCount = 64;
+		std::vector<Vec3f> frames;
+		createInterpolationTestFrames(frames, 4, vertexCount);
+
+		InterpolationPoseCache cache(vertexCount, 4);
+		const Vec3f *first = cache.getPose(&frames[0], 1, 2, 0.5f);
+		for(int instance = 0; instance < 100; ++instance) {
+			CPPUNIT_ASSERT( cache.getPose(&frames[0], 1, 2, 0.5f) == first );
+		}
+		CPPUNIT_ASSERT_EQUAL( (uint32)1,cache.getComputeCount() );
+
+		// A different frame pair or local time is a different pose
+		cache.getPose(&frames[0], 2, 3, 0.5f);
+		cache.getPose(&frames[0], 1, 2, 0.75f);
+		CPPUNIT_ASSERT_EQUAL( (uint32)3,cache.getComputeCount() );
+		CPPUNIT_ASSERT_EQUAL( frames[2 * vertexCount].lerp(0.5f, frames[3 * vertexCount]).x,
+				cache.getPose(&frames[0], 2, 3, 0.5f)[0].x );
+		CPPUNIT_ASSERT_EQUAL( (uint32)3,cache.getComputeCount() );
+	}
+
+	void test_quantize_local_t() {
+		CPPUNIT_ASSERT_EQUAL( 0.37f,InterpolationData::quantizeLocalT(0.37f, 0.0f) );
+		CPPUNIT_ASSERT_EQUAL( 0.25f,InterpolationData::quantizeLocalT(0.3f, 0.25f) );
+		CPPUNIT_ASSERT_EQUAL( 0.5f,InterpolationData::quantizeLocalT(0.4f, 0.25f) );
+		CPPUNIT_ASSERT_EQUAL( 1.0f,InterpolationData::quantizeLocalT(0.99f, 0.25f) );
+	}
+};
+
+//
+// Benchmark of shared interpolated poses, run with --benchmark
+//
+class InterpolationBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( InterpolationBenchmark );
+
+	CPPUNIT_TEST( test_shared_instances );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_shared_instances() {
+		// Many instances of one model spread over a few animation phases
+		const uint32 vertexCount = 2000;
+		const uint32 frameCount = 10;
+		const int instanceCount = 500;
+		const int phaseCount = 4;
+		std::vector<Vec3f> frames;
+		createInterpolationTestFrames(frames, frameCount, vertexCount);
+
+		Chrono chrono;
+		chrono.start();
+		std::vector<Vec3f> uncached(vertexCount);
+		for(int instance = 0; instance < instanceCount; ++instance) {
+			float localT = (float)(instance % phaseCount) / phaseCount;
+			InterpolationPoseCache::lerp(&frames[vertexCount].x, &frames[2 * vertexCount].x,
+					localT, &uncached[0].x, vertexCount * 3);
+		}
+		int64 uncachedMillis = chrono.getMillis();
+
+		chrono.start();
+		InterpolationPoseCache cache(vertexCount, phaseCount);
+		for(int instance = 0; instance < instanceCount; ++instance) {
+			float localT = (float)(instance % phaseCount) / phaseCount;
+			cache.getPose(&frames[0], 1, 2, localT);
+		}
+		int64 cachedMillis = chrono.getMillis();
+
+		CPPUNIT_ASSERT_EQUAL( (uint32)phaseCount,cache.getComputeCount() );
+		printf("\nInterpolating %d instances of %u vertices: uncached " MG_I64_SPECIFIER " msecs, cached " MG_I64_SPECIFIER " msecs\n",
+				instanceCount,vertexCount,uncachedMillis,cachedMillis);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( InterpolationTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( InterpolationBenchmark, "benchmark" );
+//
@@ -0,0 +1,144 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "mesh_optimizer.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Shared::Graphics;
+
+//
+// Utility methods for tests
+//
+
+// Triangulated grid with its triangles shuffled, like an exporter that
+// writes faces in no useful order
+static void createMeshOptimizerTestGrid(vector<uint32> &indices, uint32 size) {
+	indices.clear();
+	for(uint32 y = 0; y < size; ++y) {
+		for(uint32 x = 0; x < size; ++x) {
+			uint32 corner = y * (size + 1) + x;
+			indices.push_back(corner);
+			indices.push_back(corner + size + 1);
+			indices.push_back(corner + 1);
+			indices.push_back(corner + 1);
+			indices.push_back(corner + size + 1);
+			indices.push_back(corner + size + 2);
+		}
+	}
+
+	uint32 seed = 12345;
+	for(uint32 triangle = (uint32)indices.size() / 3 - 1; triangle > 0; --triangle) {
+		seed = seed * 1103515245 + 12345;
+		uint32 other = (seed >> 8) % (triangle + 1);
+		for(int corner = 0; corner < 3; ++corner) {
+			std::swap(indices[triangle * 3 + corner], indices[other * 3 + corner]);
+		}
+	}
+}
+
+static vector<vector<uint32> > getMeshOptimizerTestTriangles(const vector<uint32> &indices) {
+	vector<vector<uint32> > triangles;
+	for(unsigned int index = 0; index + 2 < indices.size(); index += 3) {
+		vector<uint32> triangle(indices.begin() + index, indices.begin() + index + 3);
+		// Same winding, any starting corner
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+//
+// Tests for MeshOptimizer class
+//
+class MeshOptimizerTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MeshOptimizerTest );
+
+	CPPUNIT_TEST( test_cache_stats );
+	CPPUNIT_TEST( test_vertex_cache_keeps_triangles );
+	CPPUNIT_TEST( test_vertex_fetch_order );
+	CPPUNIT_TEST( test_report_grid );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_cache_stats() {
+		// Two triangles sharing an edge and a third far away
+		uint32 indices[] = { 0,1,2, 2,1,3, 4,5,6 };
+		MeshCacheStats stats = MeshOptimizer::getCacheStats(indices, 9, 7);
+		CPPUNIT_ASSERT_EQUAL( (uint32)3,stats.triangleCount );
+		CPPUNIT_ASSERT_EQUAL( (uint32)7,stats.cacheMisses );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 7.0 / 3.0,stats.getACMR(),0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0,stats.getATVR(),0.0001 );
+
+		// A FIFO of three drops vertex 0 on the miss for 3, hits do not
+		// refresh an entry
+		uint32 revisit[] = { 0,1,2, 1,2,3, 0,1,3 };
+		stats = MeshOptimizer::getCacheStats(revisit, 9, 4, 3);
+		CPPUNIT_ASSERT_EQUAL( (uint32)6,stats.cacheMisses );
+	}
+
+	void test_vertex_cache_keeps_triangles() {
+		vector<uint32> indices;
+		createMeshOptimizerTestGrid(indices, 20);
+		vector<vector<uint32> > triangles = getMeshOptimizerTestTriangles(indices);
+
+		MeshCacheStats before = MeshOptimizer::getCacheStats(&indices[0], (uint32)indices.size(), 21 * 21);
+		MeshOptimizer::optimizeVertexCache(&indices[0], (uint32)indices.size(), 21 * 21);
+		MeshCacheStats after = MeshOptimizer::getCacheStats(&indices[0], (uint32)indices.size(), 21 * 21);
+
+		CPPUNIT_ASSERT( triangles == getMeshOptimizerTestTriangles(indices) );
+		CPPUNIT_ASSERT( before.getACMR() > 2.0f );
+		CPPUNIT_ASSERT( after.getACMR() < 0.8f );
+	}
+
+	void test_vertex_fetch_order() {
+		uint32 indices[] = { 5,2,6, 6,2,0 };
+		vector<uint32> remap;
+		uint32 usedCount = MeshOptimizer::optimizeVertexFetch(indices, 6, 8, remap);
+
+		CPPUNIT_ASSERT_EQUAL( (uint32)4,usedCount );
+		uint32 expected[] = { 0,1,2, 2,1,3 };
+		for(int index = 0; index < 6; ++index) {
+			CPPUNIT_ASSERT_EQUAL( expected[index],indices[index] );
+		}
+		CPPUNIT_ASSERT_EQUAL( (size_t)8,remap.size() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)2,remap[6] );
+		CPPUNIT_ASSERT_EQUAL( MeshOptimizer::unusedVertex,remap[1] );
+		CPPUNIT_ASSERT_EQUAL( MeshOptimizer::unusedVertex,remap[7] );
+	}
+
+	void test_report_grid() {
+		const uint32 size = 100;
+		const uint32 vertexCount = (size + 1) * (size + 1);
+		vector<uint32> indices;
+		createMeshOptimizerTestGrid(indices, size);
+
+		MeshCacheStats before = MeshOptimizer::getCacheStats(&indices[0], (uint32)indices.size(), vertexCount);
+		MeshOptimizer::optimizeVertexCache(&indices[0], (uint32)indices.size(), vertexCount);
+		vector<uint32> remap;
+		uint32 usedCount = MeshOptimizer::optimizeVertexFetch(&indices[0], (uint32)indices.size(), vertexCount, remap);
+		MeshCacheStats after = MeshOptimizer::getCacheStats(&indices[0], (uint32)indices.size(), usedCount);
+
+		CPPUNIT_ASSERT_EQUAL( vertexCount,usedCount );
+		CPPUNIT_ASSERT( after.cacheMisses < before.cacheMisses );
+		CPPUNIT_ASSERT( MeshOptimizer::getReport(before, after).empty() == false );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( MeshOptimizerTest );
+//
@@ -0,0 +1,273 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "model_draw_list.h"
+#include "model.h"
+#include "platform_util.h"
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Graphics;
+using namespace Shared::Platform;
+
+//
+// Utility methods for tests
+//
+class TestDrawListModel : public Model {
+public:
+	TestDrawListModel(const string &path) {
+		load(path);
+	}
+	virtual void init() {}
+	virtual void end() {}
+};
+
+class TestDrawListTexture : public Texture2D {
+public:
+	virtual void init(Filter filter, int maxAnisotropy) {}
+	virtual void end(bool deletePixelBuffer) {}
+};
+
+static void removeDrawListTestFile(const string &file) {
+#ifdef WIN32
+	_unlink(file.c_str());
+#else
+    unlink(file.c_str());
+#endif
+}
+
+// Untextured single frame v4 model, customColor flags the meshes taking
+// the team colour
+static void createDrawListTestModel(const string &file, const vector<bool> &customColor) {
+	FILE *f = fopen(file.c_str(), "wb");
+	FileHeader fileHeader;
+	memcpy(fileHeader.id, "G3D", 3);
+	fileHeader.version = 4;
+	fwrite(&fileHeader, sizeof(FileHeader), 1, f);
+
+	ModelHeader modelHeader;
+	modelHeader.meshCount = (uint16)customColor.size();
+	modelHeader.type = mtMorphMesh;
+	fwrite(&modelHeader, sizeof(ModelHeader), 1, f);
+
+	for(unsigned int mesh = 0; mesh < customColor.size(); ++mesh) {
+		MeshHeader meshHeader;
+		memset(&meshHeader, 0, sizeof(MeshHeader));
+		meshHeader.frameCount = 1;
+		meshHeader.vertexCount = 3;
+		meshHeader.indexCount = 3;
+		meshHeader.opacity = 1.0f - mesh * 0.25f;
+		meshHeader.properties = (customColor[mesh] == true ? mpfCustomColor : 0);
+		fwrite(&meshHeader, sizeof(MeshHeader), 1, f);
+
+		float32 data[9] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, (float32)mesh };
+		fwrite(data, sizeof(float32), 9, f);
+		fwrite(data, sizeof(float32), 9, f);
+		uint32 indices[3] = { 0, 1, 2 };
+		fwrite(indices, sizeof(uint32), 3, f);
+	}
+	fclose(f);
+}
+
+static Vec3f transformDrawListTestPoint(const Matrix4f &transform, const Vec3f &point) {
+	return Vec3f(	transform[0] * point.x + transform[4] * point.y + transform[8] * point.z + transform[12],
+					transform[1] * point.x + transform[5] * point.y + transform[9] * point.z + transform[13],
+					transform[2] * point.x + transform[6] * point.y + transform[10] * point.z + transform[14]);
+}
+
+//
+// Tests for ModelDrawList class
+//
+class ModelDrawListTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ModelDrawListTest );
+
+	CPPUNIT_TEST( test_buckets_by_mesh_and_team );
+	CPPUNIT_TEST( test_bucket_instance_order );
+	CPPUNIT_TEST( test_transform_matches_gl_order );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_buckets_by_mesh_and_team() {
+		vector<bool> customColor;
+		customColor.push_back(true);
+		customColor.push_back(false);
+		createDrawListTestModel("draw_list_test1.g3d", customColor);
+		customColor.resize(1);
+		createDrawListTestModel("draw_list_test2.g3d", customColor);
+
+		TestDrawListModel model1("draw_list_test1.g3d");
+		TestDrawListModel model2("draw_list_test2.g3d");
+		TestDrawListTexture team1;
+		TestDrawListTexture team2;
+
+		ModelDrawList drawList;
+		drawList.addInstance(&model1, &team1, Vec3f(0.f), 0.f, 0.f, 0.f, 0.f, true);
+		drawList.addInstance(&model2, &team2, Vec3f(1.f), 0.f, 0.f, 0.f, 0.f, true);
+		drawList.addInstance(&model1, &team2, Vec3f(2.f), 0.f, 0.f, 0.f, 0.f, true);
+		drawList.addInstance(&model1, &team1, Vec3f(3.f), 0.f, 0.f, 0.f, 0.f, true);
+		drawList.addInstance(&model2, &team2, Vec3f(4.f), 0.f, 0.f, 0.f, 0.f, true);
+		drawList.build();
+
+		CPPUNIT_ASSERT_EQUAL( (uint32)5,drawList.getInstanceCount() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)8,drawList.getItemCount() );
+		// model1 mesh 0 per team, model1 mesh 1 without team colour, model2
+		CPPUNIT_ASSERT_EQUAL( (uint32)4,drawList.getBucketCount() );
+
+		uint32 itemCount = 0;
+		for(uint32 i = 0; i < drawList.getBucketCount(); ++i) {
+			const ModelDrawBucket &bucket = drawList.getBucket(i);
+			CPPUNIT_ASSERT_EQUAL( itemCount,bucket.firstItem );
+			itemCount += bucket.itemCount;
+
+			for(uint32 j = bucket.firstItem; j < bucket.firstItem + bucket.itemCount; ++j) {
+				const ModelDrawItem &item = drawList.getItem(j);
+				const ModelDrawInstance &instance = drawList.getInstance(item.instanceIndex);
+				CPPUNIT_ASSERT( item.model == bucket.model && instance.model == bucket.model );
+				CPPUNIT_ASSERT_EQUAL( bucket.meshIndex,item.meshIndex );
+				CPPUNIT_ASSERT( bucket.teamTexture == item.teamTexture );
+				bool customTexture = bucket.model->getMesh(bucket.meshIndex)->getCustomTexture();
+				CPPUNIT_ASSERT( item.teamTexture == (customTexture == true ? instance.teamTexture : NULL) );
+			}
+			if(bucket.model == &model1 && bucket.meshIndex == 1) {
+				CPPUNIT_ASSERT_EQUAL( (uint32)3,bucket.itemCount );
+				// The meshes of a model keep their order
+				CPPUNIT_ASSERT( i > 0 && drawList.getBucket(i - 1).meshIndex == 0 );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( drawList.getItemCount(),itemCount );
+		CPPUNIT_ASSERT( drawList.getStateChanges() < drawList.getUnbatchedStateChanges() );
+
+		drawList.clear();
+		CPPUNIT_ASSERT( drawList.empty() == true );
+		CPPUNIT_ASSERT_EQUAL( (uint32)0,drawList.getBucketCount() );
+
+		removeDrawListTestFile("draw_list_test1.g3d");
+		removeDrawListTestFile("draw_list_test2.g3d");
+	}
+
+	void test_bucket_instance_order() {
+		vector<bool> customColor(1, false);
+		createDrawListTestModel("draw_list_test3.g3d", customColor);
+		TestDrawListModel model("draw_list_test3.g3d");
+
+		ModelDrawList drawList;
+		drawList.addInstance(&model, NULL, Vec3f(0.f), 0.f, 0.f, 0.f, 0.7f, false, 0.5f);
+		drawList.addInstance(&model, NULL, Vec3f(0.f), 0.f, 0.f, 0.f, 0.3f, true);
+		drawList.addInstance(&model, NULL, Vec3f(0.f), 0.f, 0.f, 0.f, 0.1f, true);
+		drawList.addInstance(&model, NULL, Vec3f(0.f), 0.f, 0.f, 0.f, 0.3f, true);
+		drawList.build();
+
+		// Same poses next to each other, fading instances last
+		CPPUNIT_ASSERT_EQUAL( (uint32)1,drawList.getBucketCount() );
+		uint32 expected[] = { 2, 1, 3, 0 };
+		for(uint32 i = 0; i < 4; ++i) {
+			CPPUNIT_ASSERT_EQUAL( expected[i],drawList.getItem(i).instanceIndex );
+		}
+
+		removeDrawListTestFile("draw_list_test3.g3d");
+	}
+
+	void test_transform_matches_gl_order() {
+		// glTranslatef(1,2,3) glRotatef(90,0,1,0)
+		Matrix4f transform = ModelDrawList::getTransform(Vec3f(1.f, 2.f, 3.f), 0.f, 0.f, 90.f);
+		Vec3f point = transformDrawListTestPoint(transform, Vec3f(1.f, 0.f, 0.f));
+		CPPUNIT_ASSERT( point.dist(Vec3f(1.f, 2.f, 2.f)) < 0.0001f );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0,transform[15],0.0001 );
+
+		// z rotation is applied last to the point, y first
+		transform = ModelDrawList::getTransform(Vec3f(0.f), 90.f, 0.f, 90.f);
+		point = transformDrawListTestPoint(transform, Vec3f(0.f, 0.f, 1.f));
+		CPPUNIT_ASSERT( point.dist(Vec3f(0.f, 1.f, 0.f)) < 0.0001f );
+
+		transform = ModelDrawList::getTransform(Vec3f(0.f), 0.f, 90.f, 0.f);
+		point = transformDrawListTestPoint(transform, Vec3f(0.f, 1.f, 0.f));
+		CPPUNIT_ASSERT( point.dist(Vec3f(0.f, 0.f, 1.f)) < 0.0001f );
+	}
+};
+
+//
+// Benchmark of the model draw list, run with --benchmark
+//
+class ModelDrawListBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ModelDrawListBenchmark );
+
+	CPPUNIT_TEST( test_draw_list );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_draw_list() {
+		const int modelCount = 20;
+		const int teamCount = 8;
+		const int instanceCount = 2000;
+
+		vector<bool> customColor;
+		customColor.push_back(true);
+		customColor.push_back(false);
+		customColor.push_back(true);
+		vector<TestDrawListModel *> models;
+		for(int index = 0; index < modelCount; ++index) {
+			char szBuf[256] = "";
+			snprintf(szBuf, 256, "draw_list_bench%d.g3d", index);
+			createDrawListTestModel(szBuf, customColor);
+			models.push_back(new TestDrawListModel(szBuf));
+			removeDrawListTestFile(szBuf);
+		}
+		TestDrawListTexture teams[teamCount];
+
+		ModelDrawList drawList;
+		Chrono chrono(true);
+		const int frameCount = 50;
+		for(int frame = 0; frame < frameCount; ++frame) {
+			drawList.clear();
+			uint32 seed = 12345;
+			for(int index = 0; index < instanceCount; ++index) {
+				seed = seed * 1103515245 + 12345;
+				int modelIndex = (seed >> 8) % modelCount;
+				drawList.addInstance(models[modelIndex], &teams[(seed >> 20) % teamCount],
+						Vec3f((float)index, 0.f, (float)frame), 0.f, 0.f, (float)(index % 360),
+						(float)((seed >> 4) % 16) / 16.f, true);
+			}
+			drawList.build();
+		}
+		int64 micros = chrono.getMicros();
+
+		CPPUNIT_ASSERT_EQUAL( (uint32)(instanceCount * 3),drawList.getItemCount() );
+		CPPUNIT_ASSERT( drawList.getBucketCount() <= (uint32)(modelCount * (teamCount * 2 + 1)) );
+		printf("\nDraw list of %d instances: " MG_I64_SPECIFIER " usecs per frame, %u buckets, state changes %u -> %u\n",
+				instanceCount,micros / frameCount,drawList.getBucketCount(),
+				drawList.getUnbatchedStateChanges(),drawList.getStateChanges());
+
+		for(unsigned int index = 0; index < models.size(); ++index) {
+			delete models[index];
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ModelDrawListTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( ModelDrawListBenchmark, "benchmark" );
+//
@@ -12,8 +12,12 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
 #include "model.h"
+#include "platform_common.h"
+#include "conversion.h"
 #include <vector>
 #include <algorithm>
+#include <cstdio>
+#include <cmath>
 
 #ifdef WIN32
 #include <io.h>
@@ -22,6 +26,8 @@
 #endif
 
 using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
 
 class TestBaseColorPickEntity : public BaseColorPickEntity {
 public:
@@ -29,6 +35,146 @@ public:
 		return getColorDescription();
 	}
 };
+
+class TestModel : public Model {
+public:
+	TestModel(const string &path) {
+		load(path);
+	}
+	virtual void init() {}
+	virtual void end() {}
+};
+
+//
+// Utility methods for tests
+//
+static void removeModelTestFile(const string &file) {
+#ifdef WIN32
+	_unlink(file.c_str());
+#else
+    unlink(file.c_str());
+#endif
+}
+
+static Vec3f getModelTestVertex(uint32 mesh, uint32 frame, uint32 vertex) {
+	return Vec3f(mesh + frame * 0.5f + vertex * 0.25f, frame - vertex * 0.125f, mesh * 2.0f - vertex);
+}
+
+static Vec3f getModelTestNormal(uint32 mesh, uint32 frame, uint32 vertex) {
+	Vec3f normal(sin(vertex + frame * 0.1f), cos(vertex * 0.7f + mesh), 0.5f);
+	normal.normalize();
+	return normal;
+}
+
+// Vertex whose data vertex repeats when every duplicateStride vertices repeat
+static uint32 getModelTestSourceVertex(uint32 vertex, uint32 duplicateStride) {
+	return (duplicateStride > 0 ? vertex % duplicateStride : vertex);
+}
+
+// Untextured v4 model, meshes with the same opacity get joined on load
+static void createModelTestFile(const string &file, uint32 meshCount, uint32 frameCount,
+								uint32 vertexCount, bool joinable, uint32 duplicateStride=0) {
+	FILE *f = fopen(file.c_str(), "wb");
+	FileHeader fileHeader;
+	memcpy(fileHeader.id, "G3D", 3);
+	fileHeader.version = 4;
+	fwrite(&fileHeader, sizeof(FileHeader), 1, f);
+
+	ModelHeader modelHeader;
+	modelHeader.meshCount = (uint16)meshCount;
+	modelHeader.type = mtMorphMesh;
+	fwrite(&modelHeader, sizeof(ModelHeader), 1, f);
+
+	for(uint32 mesh = 0; mesh < meshCount; ++mesh) {
+		MeshHeader meshHeader;
+		memset(&meshHeader, 0, sizeof(MeshHeader));
+		snprintf((char *)meshHeader.name, meshNameSize, "mesh%u", mesh);
+		meshHeader.frameCount = frameCount;
+		meshHeader.vertexCount = vertexCount;
+		meshHeader.indexCount = vertexCount;
+		meshHeader.diffuseColor[0] = 1.0f;
+		meshHeader.specularPower = 2.0f;
+		meshHeader.opacity = (joinable == true ? 1.0f : 1.0f - mesh * 0.125f);
+		fwrite(&meshHeader, sizeof(MeshHeader), 1, f);
+
+		for(uint32 frame = 0; frame < frameCount; ++frame) {
+			for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+				Vec3f value = getModelTestVertex(mesh, frame, getModelTestSourceVertex(vertex, duplicateStride));
+				fwrite(value.ptr(), sizeof(float32), 3, f);
+			}
+		}
+		for(uint32 frame = 0; frame < frameCount; ++frame) {
+			for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+				Vec3f value = getModelTestNormal(mesh, frame, getModelTestSourceVertex(vertex, duplicateStride));
+				fwrite(value.ptr(), sizeof(float32), 3, f);
+			}
+		}
+		for(uint32 index = 0; index < vertexCount; ++index) {
+			uint32 value = vertexCount - 1 - index;
+			fwrite(&value, sizeof(uint32), 1, f);
+		}
+	}
+	fclose(f);
+}
+
+// Compares the triangles the mesh draws, optimized meshes reorder them and
+// their vertices. Joined meshes follow meshIndex in the file.
+static bool modelTestMeshMatches(const Mesh *mesh, uint32 meshIndex, uint32 frameCount,
+								 uint32 vertexCount, float normalTolerance,
+								 uint32 joinedMeshCount=1, uint32 duplicateStride=0) {
+	uint32 sourceVertexCount = vertexCount * joinedMeshCount;
+	uint32 meshVertexCount = mesh->getVertexCount();
+	if(mesh->getFrameCount() != frameCount || mesh->getIndexCount() != sourceVertexCount) {
+		return false;
+	}
+
+	// Source of every mesh vertex, found through its first frame
+	vector<uint32> sources(meshVertexCount);
+	for(uint32 vertex = 0; vertex < meshVertexCount; ++vertex) {
+		bool found = false;
+		for(uint32 source = 0; source < sourceVertexCount && found == false; ++source) {
+			uint32 sourceMesh = meshIndex + source / vertexCount;
+			uint32 sourceVertex = getModelTestSourceVertex(source % vertexCount, duplicateStride);
+			if(mesh->getVertices()[vertex] == getModelTestVertex(sourceMesh, 0, sourceVertex)) {
+				sources[vertex] = (source / vertexCount) * vertexCount + sourceVertex;
+				found = true;
+			}
+		}
+		if(found == false) {
+			return false;
+		}
+
+		uint32 sourceMesh = meshIndex + sources[vertex] / vertexCount;
+		uint32 sourceVertex = sources[vertex] % vertexCount;
+		for(uint32 frame = 0; frame < frameCount; ++frame) {
+			if(mesh->getVertices()[frame * meshVertexCount + vertex] != getModelTestVertex(sourceMesh, frame, sourceVertex)) {
+				return false;
+			}
+			if(mesh->getNormals()[frame * meshVertexCount + vertex].dist(getModelTestNormal(sourceMesh, frame, sourceVertex)) > normalTolerance) {
+				return false;
+			}
+		}
+	}
+
+	vector<vector<uint32> > expected;
+	vector<vector<uint32> > actual;
+	for(uint32 index = 0; index + 2 < sourceVertexCount; index += 3) {
+		vector<uint32> expectedTriangle;
+		vector<uint32> actualTriangle;
+		for(uint32 corner = index; corner < index + 3; ++corner) {
+			uint32 joined = (corner / vertexCount) * vertexCount;
+			uint32 fileIndex = vertexCount - 1 - corner % vertexCount;
+			expectedTriangle.push_back(joined + getModelTestSourceVertex(fileIndex, duplicateStride));
+			actualTriangle.push_back(sources[mesh->getIndices()[corner]]);
+		}
+		expected.push_back(expectedTriangle);
+		actual.push_back(actualTriangle);
+	}
+	std::sort(expected.begin(), expected.end());
+	std::sort(actual.begin(), actual.end());
+	return (expected == actual);
+}
+
 //
 // Tests for font class
 //
@@ -38,6 +184,10 @@ class ModelTest : public CppUnit::TestFixture {
 
 	CPPUNIT_TEST( test_ColorPicking_loop );
 	CPPUNIT_TEST( test_ColorPicking_prime );
+	CPPUNIT_TEST( test_load_and_cache_round_trip );
+	CPPUNIT_TEST( test_stale_cache_is_rebuilt );
+	CPPUNIT_TEST( test_joined_meshes_are_cached );
+	CPPUNIT_TEST( test_optimize_merges_duplicate_vertices );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -100,9 +250,174 @@ public:
 		BaseColorPickEntity::setTrackColorUse(false);
 	}
 
+	void test_load_and_cache_round_trip() {
+		const string file = "model_cache_test1.g3d";
+		createModelTestFile(file, 3, 4, 30, false);
+
+		Model::setCachePath("");
+		{
+			TestModel model(file);
+			CPPUNIT_ASSERT_EQUAL( (uint32)3,model.getMeshCount() );
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == false );
+			for(uint32 mesh = 0; mesh < 3; ++mesh) {
+				CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(mesh), mesh, 4, 30, 0.0f) );
+			}
+		}
+
+		Model::setCachePath(".");
+		{
+			TestModel model(file);
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == false );
+		}
+		{
+			// Read straight from the cache mapping, normals are quantized
+			TestModel model(file);
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == true );
+			CPPUNIT_ASSERT_EQUAL( (uint32)3,model.getMeshCount() );
+			for(uint32 mesh = 0; mesh < 3; ++mesh) {
+				CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(mesh), mesh, 4, 30, 0.001f) );
+				CPPUNIT_ASSERT_EQUAL( string("mesh") + intToStr(mesh),model.getMesh(mesh)->getName() );
+				CPPUNIT_ASSERT_EQUAL( 1.0f - mesh * 0.125f,model.getMesh(mesh)->getOpacity() );
+			}
+			CPPUNIT_ASSERT( model.getMesh(0)->hasMappedData() == true );
+		}
+
+		Model::setMapDataInPlace(false);
+		{
+			TestModel model(file);
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == true );
+			CPPUNIT_ASSERT( model.getMesh(0)->hasMappedData() == false );
+			CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(1), 1, 4, 30, 0.001f) );
+		}
+		Model::setMapDataInPlace(true);
+
+		removeModelTestFile(Model::getCacheFileName(file));
+		Model::setCachePath("");
+		removeModelTestFile(file);
+	}
+
+	void test_stale_cache_is_rebuilt() {
+		const string file = "model_cache_test2.g3d";
+		createModelTestFile(file, 2, 2, 12, false);
+
+		Model::setCachePath(".");
+		{
+			TestModel model(file);
+		}
+		createModelTestFile(file, 2, 2, 15, false);
+		{
+			TestModel model(file);
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == false );
+			CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(1), 1, 2, 15, 0.0f) );
+		}
+		{
+			TestModel model(file);
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == true );
+			CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(1), 1, 2, 15, 0.001f) );
+		}
+
+		removeModelTestFile(Model::getCacheFileName(file));
+		Model::setCachePath("");
+		removeModelTestFile(file);
+	}
+
+	void test_joined_meshes_are_cached() {
+		const string file = "model_cache_test3.g3d";
+		createModelTestFile(file, 2, 3, 9, true);
+
+		Model::setCachePath(".");
+		for(int pass = 0; pass < 2; ++pass) {
+			TestModel model(file);
+			CPPUNIT_ASSERT_EQUAL( (pass == 1),model.getLoadedFromCache() );
+			CPPUNIT_ASSERT_EQUAL( (uint32)1,model.getMeshCount() );
+
+			const Mesh *mesh = model.getMesh(0);
+			CPPUNIT_ASSERT_EQUAL( (uint32)18,mesh->getVertexCount() );
+			CPPUNIT_ASSERT( modelTestMeshMatches(mesh, 0, 3, 9, 0.001f, 2) );
+		}
+
+		removeModelTestFile(Model::getCacheFileName(file));
+		Model::setCachePath("");
+		removeModelTestFile(file);
+	}
+
+	void test_optimize_merges_duplicate_vertices() {
+		const string file = "model_optimize_test.g3d";
+		createModelTestFile(file, 2, 3, 60, false, 20);
+
+		Model::setCachePath("");
+		TestModel model(file);
+		MeshCacheStats before;
+		MeshCacheStats after;
+		model.optimizeMeshes(&before, &after);
+
+		CPPUNIT_ASSERT_EQUAL( (uint32)120,before.vertexCount );
+		CPPUNIT_ASSERT_EQUAL( (uint32)40,after.vertexCount );
+		CPPUNIT_ASSERT_EQUAL( before.triangleCount,after.triangleCount );
+		CPPUNIT_ASSERT( after.cacheMisses < before.cacheMisses );
+		// The second mesh is blended and keeps its triangle order
+		CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(0), 0, 3, 60, 0.0f, 1, 20) );
+		CPPUNIT_ASSERT( modelTestMeshMatches(model.getMesh(1), 1, 3, 60, 0.0f, 1, 20) );
+		const Mesh *blendedMesh = model.getMesh(1);
+		CPPUNIT_ASSERT( blendedMesh->getVertices()[blendedMesh->getIndices()[6]] == getModelTestVertex(1, 0, 13) );
+
+		removeModelTestFile(file);
+	}
 };
 
 
+//
+// Benchmark of the model cache, run with --benchmark
+//
+class ModelBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ModelBenchmark );
+
+	CPPUNIT_TEST( test_model_cache );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_model_cache() {
+		const int modelCount = 100;
+		std::vector<string> files;
+		for(int index = 0; index < modelCount; ++index) {
+			files.push_back("model_cache_bench" + intToStr(index) + ".g3d");
+			createModelTestFile(files.back(), 4, 10, 600, false);
+		}
+
+		Model::setCachePath("");
+		Chrono chrono(true);
+		for(int index = 0; index < modelCount; ++index) {
+			TestModel model(files[index]);
+		}
+		int64 uncachedMicros = chrono.getMicros();
+
+		Model::setCachePath(".");
+		for(int index = 0; index < modelCount; ++index) {
+			TestModel model(files[index]);
+		}
+		chrono.start();
+		for(int index = 0; index < modelCount; ++index) {
+			TestModel model(files[index]);
+			CPPUNIT_ASSERT( model.getLoadedFromCache() == true );
+		}
+		int64 cachedMicros = chrono.getMicros();
+
+		for(int index = 0; index < modelCount; ++index) {
+			removeModelTestFile(Model::getCacheFileName(files[index]));
+			removeModelTestFile(files[index]);
+		}
+		Model::setCachePath("");
+
+		printf("\nLoading %d models: g3d files " MG_I64_SPECIFIER " usecs, model cache " MG_I64_SPECIFIER " usecs\n",
+				modelCount,uncachedMicros,cachedMicros);
+	}
+};
+
 // Test Suite Registrations
 CPPUNIT_TEST_SUITE_REGISTRATION( ModelTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( ModelBenchmark, "benchmark" );
 //
@@ -0,0 +1,187 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "particle.h"
+#include "platform_common.h"
+#include <vector>
+#include <cstdio>
+
+using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility classes for tests
+//
+
+// Rain that can be filled with hand made particles and updated without
+// emitting new ones
+class TestRainParticleSystem : public RainParticleSystem {
+public:
+	TestRainParticleSystem(int particleCount) : RainParticleSystem(particleCount) {}
+
+	void addTestParticle(float height, float fallSpeed, float id) {
+		Particle *p = createParticle();
+		p->pos = Vec3f(id, height, 0.f);
+		p->lastPos = p->pos;
+		p->speed = Vec3f(0.f, -fallSpeed, 0.f);
+		p->accel = Vec3f(0.f);
+		p->energy = 100;
+	}
+	void updateTestParticles() {
+		updateParticles();
+	}
+};
+
+// A battle worth of unit and fire particle systems
+static void createParticleTestSystems(std::vector<ParticleSystem *> &systems, int systemCount) {
+	for(int index = 0; index < systemCount; ++index) {
+		ParticleSystem *ps = NULL;
+		if(index % 2 == 0) {
+			UnitParticleSystem *unitSystem = new UnitParticleSystem(200);
+			unitSystem->setSpeed(0.05f);
+			unitSystem->setMaxParticleEnergy(60);
+			unitSystem->setVarParticleEnergy(20);
+			unitSystem->setEmissionRate(5.f);
+			ps = unitSystem;
+		}
+		else {
+			FireParticleSystem *fireSystem = new FireParticleSystem(200);
+			fireSystem->setMaxParticleEnergy(60);
+			fireSystem->setVarParticleEnergy(20);
+			fireSystem->setEmissionRate(5.f);
+			ps = fireSystem;
+		}
+		ps->setPos(Vec3f(index % 64 * 2.f, 1.f, index / 64 * 2.f));
+		systems.push_back(ps);
+	}
+}
+
+static void deleteParticleTestSystems(std::vector<ParticleSystem *> &systems) {
+	for(unsigned int index = 0; index < systems.size(); ++index) {
+		delete systems[index];
+	}
+	systems.clear();
+}
+
+//
+// Tests for particle system updates
+//
+class ParticleTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ParticleTest );
+
+	CPPUNIT_TEST( test_dead_particles_are_compacted );
+	CPPUNIT_TEST( test_updates_are_deterministic );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_dead_particles_are_compacted() {
+		TestRainParticleSystem rain(8);
+		rain.addTestParticle(10.f, 1.f, 0.f);
+		rain.addTestParticle(0.5f, 1.f, 1.f);
+		rain.addTestParticle(10.f, 1.f, 2.f);
+		rain.addTestParticle(0.5f, 1.f, 3.f);
+		rain.addTestParticle(10.f, 1.f, 4.f);
+		CPPUNIT_ASSERT_EQUAL( 5,rain.getAliveParticleCount() );
+
+		rain.updateTestParticles();
+
+		// Particles 1 and 3 hit the ground, the last alive particle takes
+		// the first free place and is only updated from the next frame on
+		CPPUNIT_ASSERT_EQUAL( 3,rain.getAliveParticleCount() );
+		const float expectedIds[] = { 0.f, 4.f, 2.f };
+		const float expectedHeights[] = { 9.f, 10.f, 9.f };
+		const int expectedEnergies[] = { 99, 100, 99 };
+		for(int index = 0; index < rain.getAliveParticleCount(); ++index) {
+			const Particle *p = rain.getParticle(index);
+			CPPUNIT_ASSERT_EQUAL( expectedIds[index],p->pos.x );
+			CPPUNIT_ASSERT_EQUAL( expectedHeights[index],p->pos.y );
+			CPPUNIT_ASSERT_EQUAL( expectedEnergies[index],p->energy );
+		}
+	}
+
+	void test_updates_are_deterministic() {
+		std::vector<ParticleSystem *> systems1;
+		std::vector<ParticleSystem *> systems2;
+		createParticleTestSystems(systems1, 16);
+		createParticleTestSystems(systems2, 16);
+
+		for(int frame = 0; frame < 200; ++frame) {
+			for(unsigned int index = 0; index < systems1.size(); ++index) {
+				systems1[index]->update();
+				systems2[index]->update();
+			}
+		}
+		for(unsigned int index = 0; index < systems1.size(); ++index) {
+			ParticleSystem *ps1 = systems1[index];
+			ParticleSystem *ps2 = systems2[index];
+			CPPUNIT_ASSERT( ps1->getAliveParticleCount() > 0 );
+			CPPUNIT_ASSERT_EQUAL( ps1->getAliveParticleCount(),ps2->getAliveParticleCount() );
+			for(int particle = 0; particle < ps1->getAliveParticleCount(); ++particle) {
+				const Particle *p1 = ps1->getParticle(particle);
+				const Particle *p2 = ps2->getParticle(particle);
+				CPPUNIT_ASSERT( p1->energy > 0 );
+				CPPUNIT_ASSERT_EQUAL( p1->energy,p2->energy );
+				CPPUNIT_ASSERT( p1->pos == p2->pos );
+				CPPUNIT_ASSERT( p1->speed == p2->speed );
+				CPPUNIT_ASSERT( p1->color == p2->color );
+			}
+		}
+		deleteParticleTestSystems(systems1);
+		deleteParticleTestSystems(systems2);
+	}
+};
+
+//
+// Benchmark of particle system updates, run with --benchmark
+//
+class ParticleBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ParticleBenchmark );
+
+	CPPUNIT_TEST( test_battle_update );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_battle_update() {
+		const int systemCount = 2000;
+		const int frameCount = 100;
+		std::vector<ParticleSystem *> systems;
+		createParticleTestSystems(systems, systemCount);
+
+		int64 particleUpdates = 0;
+		Chrono chrono(true);
+		for(int frame = 0; frame < frameCount; ++frame) {
+			for(unsigned int index = 0; index < systems.size(); ++index) {
+				particleUpdates += systems[index]->getAliveParticleCount();
+				systems[index]->update();
+			}
+		}
+		int64 updateMicros = chrono.getMicros();
+		CPPUNIT_ASSERT( particleUpdates > 0 );
+
+		printf("\n%d particle systems over %d frames: " MG_I64_SPECIFIER " particle updates in " MG_I64_SPECIFIER " usecs\n",
+				systemCount,frameCount,particleUpdates,updateMicros);
+		deleteParticleTestSystems(systems);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ParticleTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( ParticleBenchmark, "benchmark" );
+//
@@ -0,0 +1,133 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "sim_math.h"
+#include "math_util.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace Shared::Graphics;
+
+//
+// Utility methods for tests, the float versions the simulation used
+//
+static bool floatIsInsideRadius(const Vec2i &relPos, int radius) {
+	float posLength = relPos.length();
+	return posLength < radius;
+}
+
+static bool floatIsCellInRange(const Vec2f &floatCenter, int i, int j, int range) {
+#ifdef USE_STREFLOP
+	return streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1);
+#else
+	return floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1);
+#endif
+}
+
+//
+// Tests for sim_math, cross checked against the float tests at
+// whatever optimization level the tests are built with
+//
+class SimMathTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SimMathTest );
+
+	CPPUNIT_TEST( test_radius_matches_float_length );
+	CPPUNIT_TEST( test_cell_range_matches_float_dist );
+	CPPUNIT_TEST( test_dist_squared_orders_like_dist );
+	CPPUNIT_TEST( test_octile_distance );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_radius_matches_float_length() {
+		for(int radius = -1; radius <= 70; ++radius) {
+			for(int i = -72; i <= 72; ++i) {
+				for(int j = -72; j <= 72; ++j) {
+					Vec2i relPos(i, j);
+					CPPUNIT_ASSERT_EQUAL( floatIsInsideRadius(relPos, radius),isInsideRadius(relPos, radius) );
+				}
+			}
+		}
+
+		// Far from the origin too
+		Vec2i a(1000, 2000);
+		Vec2i b(1003, 2004);
+		CPPUNIT_ASSERT( isInsideRadius(a, b, 6) == true );
+		CPPUNIT_ASSERT( isInsideRadius(a, b, 5) == false );
+		CPPUNIT_ASSERT_EQUAL( a.dist(b) < 5,isInsideRadius(a, b, 5) );
+	}
+
+	void test_cell_range_matches_float_dist() {
+		const Vec2i positions[] = { Vec2i(0, 0), Vec2i(17, 5), Vec2i(250, 333), Vec2i(1021, 1019) };
+		for(unsigned int posIndex = 0; posIndex < sizeof(positions) / sizeof(positions[0]); ++posIndex) {
+			const Vec2i &pos = positions[posIndex];
+			for(int size = 1; size <= 5; ++size) {
+				// As Unit::getFloatCenteredPos
+				Vec2f floatCenter(pos.x-0.5f+size/2.f, pos.y-0.5f+size/2.f);
+				Vec2i doubledCenter = getDoubledCenter(pos, size);
+				CPPUNIT_ASSERT_EQUAL( floatCenter.x * 2,(float)doubledCenter.x );
+
+				for(int range = 0; range <= 40; range += 3) {
+					for(int i = pos.x - range - 2; i < pos.x + range + size + 2; ++i) {
+						for(int j = pos.y - range - 2; j < pos.y + range + size + 2; ++j) {
+							CPPUNIT_ASSERT_EQUAL( floatIsCellInRange(floatCenter, i, j, range),
+												  isCellInRange(doubledCenter, i, j, range + 1) );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void test_dist_squared_orders_like_dist() {
+		Vec2i target(64, 64);
+		for(int i = 0; i < 128; i += 3) {
+			for(int j = 0; j < 128; j += 5) {
+				Vec2i first(i, j);
+				Vec2i second(j, 127 - i);
+				float firstDist = first.dist(target);
+				float secondDist = second.dist(target);
+				int firstSquared = distSquared(first, target);
+				int secondSquared = distSquared(second, target);
+				CPPUNIT_ASSERT_EQUAL( firstDist < secondDist,firstSquared < secondSquared );
+				CPPUNIT_ASSERT_EQUAL( firstDist == secondDist,firstSquared == secondSquared );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( 25,distSquared(Vec2i(1, 1), Vec2i(4, 5)) );
+	}
+
+	void test_octile_distance() {
+		CPPUNIT_ASSERT_EQUAL( 0,octileDistance(Vec2i(3, 3), Vec2i(3, 3)) );
+		CPPUNIT_ASSERT_EQUAL( 5000,octileDistance(Vec2i(0, 0), Vec2i(5, 0)) );
+		CPPUNIT_ASSERT_EQUAL( 4242,octileDistance(Vec2i(0, 0), Vec2i(-3, 3)) );
+		CPPUNIT_ASSERT_EQUAL( 2 * 1414 + 3000,octileDistance(Vec2i(10, 4), Vec2i(5, 6)) );
+
+		// Not shorter than the straight line, but for the rounding of
+		// sqrt(2) on each diagonal step
+		for(int i = -20; i <= 20; ++i) {
+			for(int j = -20; j <= 20; ++j) {
+				Vec2i pos(i, j);
+				int octile = octileDistance(Vec2i(0, 0), pos);
+				int diagonalSteps = min(abs(i), abs(j));
+				CPPUNIT_ASSERT_EQUAL( octile,octileDistance(pos, Vec2i(0, 0)) );
+				CPPUNIT_ASSERT( octile + diagonalSteps >= (int)(pos.length() * octileStraightCost) );
+			}
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SimMathTest );
+//
@@ -0,0 +1,230 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "texture_decode_queue.h"
+#include "platform_util.h"
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Graphics;
+using namespace Shared::Platform;
+
+//
+// Utility methods for tests
+//
+class TestTexture2D : public Texture2D {
+public:
+	virtual void init(Filter filter, int maxAnisotropy) {
+		inited = true;
+	}
+	virtual void end(bool deletePixelBuffer) {
+		deletePixels();
+	}
+};
+
+static void removeTextureDecodeTestFile(const string &file) {
+#ifdef WIN32
+	_unlink(file.c_str());
+#else
+    unlink(file.c_str());
+#endif
+}
+
+// Writes count noisy images so the png encoder cannot compress them away
+static void createTextureDecodeTestImages(std::vector<string> &files, int count, int size, const string &extension) {
+	files.clear();
+	for(int index = 0; index < count; ++index) {
+		Pixmap2D pixmap(size, size, 4);
+		unsigned int seed = 12345 + index;
+		for(int y = 0; y < size; ++y) {
+			for(int x = 0; x < size; ++x) {
+				for(int component = 0; component < 4; ++component) {
+					seed = seed * 1103515245 + 12345;
+					pixmap.setComponent(x, y, component, (uint8)((seed >> 16) & 0xFF));
+				}
+			}
+		}
+
+		char szBuf[256] = "";
+		snprintf(szBuf, 256, "texture_decode_test%d.%s", index, extension.c_str());
+		pixmap.save(szBuf);
+		files.push_back(szBuf);
+	}
+}
+
+static bool textureDecodeTestPixelsMatch(Texture2D &texture1, Texture2D &texture2) {
+	const Pixmap2D *pixmap1 = texture1.getPixmapConst();
+	const Pixmap2D *pixmap2 = texture2.getPixmapConst();
+	return (pixmap1->getW() == pixmap2->getW() && pixmap1->getH() == pixmap2->getH() &&
+			pixmap1->getComponents() == pixmap2->getComponents() &&
+			pixmap1->getPixels() != NULL && pixmap2->getPixels() != NULL &&
+			memcmp(pixmap1->getPixels(), pixmap2->getPixels(), pixmap1->getPixelByteCount()) == 0);
+}
+
+//
+// Tests for TextureDecodeQueue class
+//
+class TextureDecodeQueueTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TextureDecodeQueueTest );
+
+	CPPUNIT_TEST( test_decode_matches_synchronous_load );
+	CPPUNIT_TEST( test_finish_without_workers );
+	CPPUNIT_TEST( test_decode_error );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_decode_matches_synchronous_load() {
+		std::vector<string> files;
+		createTextureDecodeTestImages(files, 8, 64, "png");
+
+		TextureDecodeQueue &decodeQueue = TextureDecodeQueue::getInstance();
+		decodeQueue.setWorkerCount(2);
+
+		TestTexture2D textures[8];
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			decodeQueue.queueTexture(&textures[index], files[index]);
+			CPPUNIT_ASSERT( decodeQueue.isQueued(&textures[index]) == true );
+		}
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			decodeQueue.finish(&textures[index]);
+			CPPUNIT_ASSERT( decodeQueue.isQueued(&textures[index]) == false );
+
+			TestTexture2D expected;
+			expected.load(files[index]);
+			CPPUNIT_ASSERT( textureDecodeTestPixelsMatch(textures[index], expected) );
+			CPPUNIT_ASSERT_EQUAL( files[index],textures[index].getPath() );
+		}
+
+		decodeQueue.setWorkerCount(-1);
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			removeTextureDecodeTestFile(files[index]);
+		}
+	}
+
+	void test_finish_without_workers() {
+		std::vector<string> files;
+		createTextureDecodeTestImages(files, 2, 32, "tga");
+
+		TextureDecodeQueue &decodeQueue = TextureDecodeQueue::getInstance();
+		decodeQueue.setWorkerCount(0);
+
+		// finish() decodes on the calling thread
+		TestTexture2D texture;
+		texture.getPixmap()->init(3);
+		decodeQueue.queueTexture(&texture, files[1]);
+		decodeQueue.finish(&texture);
+
+		TestTexture2D expected;
+		expected.getPixmap()->init(3);
+		expected.load(files[1]);
+		CPPUNIT_ASSERT_EQUAL( 3,texture.getPixmapConst()->getComponents() );
+		CPPUNIT_ASSERT( textureDecodeTestPixelsMatch(texture, expected) );
+
+		decodeQueue.setWorkerCount(-1);
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			removeTextureDecodeTestFile(files[index]);
+		}
+	}
+
+	void test_decode_error() {
+		const string file = "texture_decode_test_broken.png";
+		FILE *fp = fopen(file.c_str(), "wb");
+		fputs("not a png", fp);
+		fclose(fp);
+
+		TextureDecodeQueue &decodeQueue = TextureDecodeQueue::getInstance();
+		TestTexture2D texture1;
+		TestTexture2D texture2;
+		decodeQueue.queueTexture(&texture1, file);
+		decodeQueue.queueTexture(&texture2, file);
+
+		bool thrown = false;
+		try {
+			decodeQueue.finish(&texture1);
+		}
+		catch(const megaglest_runtime_error &) {
+			thrown = true;
+		}
+		CPPUNIT_ASSERT( thrown == true );
+
+		// Textures that are about to be deleted just wait
+		decodeQueue.finish(&texture2, false);
+		CPPUNIT_ASSERT( decodeQueue.isQueued(&texture2) == false );
+		CPPUNIT_ASSERT( texture2.getPixmapConst()->getPixels() == NULL );
+
+		removeTextureDecodeTestFile(file);
+	}
+};
+
+//
+// Benchmark of the texture decode queue, run with --benchmark
+//
+class TextureDecodeQueueBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TextureDecodeQueueBenchmark );
+
+	CPPUNIT_TEST( test_decode );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_decode() {
+		const int imageCount = 32;
+		std::vector<string> files;
+		createTextureDecodeTestImages(files, imageCount, 256, "png");
+
+		TestTexture2D sequential[imageCount];
+		TestTexture2D queued[imageCount];
+		Chrono chrono(true);
+		for(int index = 0; index < imageCount; ++index) {
+			sequential[index].load(files[index]);
+		}
+		int64 sequentialMicros = chrono.getMicros();
+
+		TextureDecodeQueue &decodeQueue = TextureDecodeQueue::getInstance();
+		decodeQueue.setWorkerCount(-1);
+		chrono.start();
+		for(int index = 0; index < imageCount; ++index) {
+			decodeQueue.queueTexture(&queued[index], files[index]);
+		}
+		for(int index = 0; index < imageCount; ++index) {
+			decodeQueue.finish(&queued[index]);
+		}
+		int64 queuedMicros = chrono.getMicros();
+
+		for(int index = 0; index < imageCount; ++index) {
+			CPPUNIT_ASSERT( textureDecodeTestPixelsMatch(sequential[index], queued[index]) );
+			removeTextureDecodeTestFile(files[index]);
+		}
+
+		printf("\nDecoding %d 256x256 png textures: sequential " MG_I64_SPECIFIER " usecs, decode queue " MG_I64_SPECIFIER " usecs\n",
+				imageCount,sequentialMicros,queuedMicros);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( TextureDecodeQueueTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TextureDecodeQueueBenchmark, "benchmark" );
+//
@@ -0,0 +1,347 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "visibility_index.h"
+#include "platform_util.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+using namespace Shared::Graphics;
+using namespace Shared::Platform;
+
+//
+// Utility methods for tests
+//
+static void addVisibilityTestPlane(std::vector<std::vector<float> > &frustum, const Vec3f &normal, const Vec3f &point) {
+	Vec3f n = normal;
+	n.normalize();
+	std::vector<float> plane(4);
+	plane[0] = n.x;
+	plane[1] = n.y;
+	plane[2] = n.z;
+	plane[3] = -n.dot(point);
+	frustum.push_back(plane);
+}
+
+// Six inward facing planes of a camera looking down on the map at an angle,
+// in the same form Renderer::computeVisibleQuad extracts them
+static void createVisibilityTestFrustum(std::vector<std::vector<float> > &frustum, const Vec3f &camera) {
+	const float halfFov = 0.5f;
+	Vec3f forward(0.f, -1.f, 1.f);
+	forward.normalize();
+	Vec3f right(1.f, 0.f, 0.f);
+	Vec3f up = right.cross(forward);
+	float s = std::sin(halfFov);
+	float c = std::cos(halfFov);
+
+	frustum.clear();
+	addVisibilityTestPlane(frustum, right * c + forward * s, camera);
+	addVisibilityTestPlane(frustum, right * -c + forward * s, camera);
+	addVisibilityTestPlane(frustum, up * c + forward * s, camera);
+	addVisibilityTestPlane(frustum, up * -c + forward * s, camera);
+	addVisibilityTestPlane(frustum, forward, camera + forward * 1.f);
+	addVisibilityTestPlane(frustum, forward * -1.f, camera + forward * 120.f);
+}
+
+// A forest covering about 40% of the cells with objects of varying height
+static void createVisibilityTestForest(std::vector<VisibilityItem> &items, int size) {
+	items.clear();
+	for(int y = 0; y < size; ++y) {
+		for(int x = 0; x < size; ++x) {
+			int hash = (x * 7919 + y * 104729) % 100;
+			if(hash < 40) {
+				Vec3f center(x * 2.f, (float)(hash % 5), y * 2.f);
+				items.push_back(VisibilityItem(Vec2i(x, y), center, 0.5f + hash % 3));
+			}
+		}
+	}
+}
+
+static void bruteForceVisibilityQuery(const std::vector<VisibilityItem> &items, const std::vector<std::vector<float> > &frustum,
+		const Rect2i &cellBounds, std::vector<int> &result) {
+	result.clear();
+	for(unsigned int i = 0; i < items.size(); ++i) {
+		const VisibilityItem &item = items[i];
+		if(cellBounds.isInside(item.cell) == true &&
+			FrustumCulling::cubeInFrustum(frustum, item.center.x, item.center.y, item.center.z, item.size) == true) {
+			result.push_back(i);
+		}
+	}
+}
+
+// Units spread over the map, each frame moves some of them to the next cell
+static Vec2i getVisibilityTestUnitCell(int unit, int frame, int mapSize) {
+	return Vec2i((unit * 37 + frame / 10) % mapSize, (unit * 91 + frame / 7) % mapSize);
+}
+
+// Computed on demand like Unit::getCurrMidHeightVector, with the same
+// truncations
+static Vec3f getVisibilityTestUnitCenter(const Vec2i &cell, int unit) {
+	Vec3f center(truncateDecimal<float>((float)cell.x, 6),
+				 truncateDecimal<float>(1.f + unit % 4, 6),
+				 truncateDecimal<float>((float)cell.y, 6));
+	center.x = truncateDecimal<float>(center.x + 0.5f, 6);
+	center.z = truncateDecimal<float>(center.z + 0.5f, 6);
+	return center;
+}
+
+static float getVisibilityTestUnitSize(int unit) {
+	return 1.f + unit % 3;
+}
+
+//
+// Tests for VisibilityQuadTree and VisibilityLooseGrid classes
+//
+class VisibilityIndexTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( VisibilityIndexTest );
+
+	CPPUNIT_TEST( test_classify_box );
+	CPPUNIT_TEST( test_quadtree_matches_brute_force );
+	CPPUNIT_TEST( test_loose_grid_matches_brute_force );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_classify_box() {
+		std::vector<std::vector<float> > frustum;
+		createVisibilityTestFrustum(frustum, Vec3f(0.f, 40.f, 0.f));
+
+		Vec3f ahead = Vec3f(0.f, 40.f, 0.f) + Vec3f(0.f, -1.f, 1.f) * 30.f;
+		CPPUNIT_ASSERT_EQUAL( (int)FrustumCulling::bcInside,
+				(int)FrustumCulling::classifyBox(frustum, ahead - Vec3f(1.f), ahead + Vec3f(1.f)) );
+		CPPUNIT_ASSERT_EQUAL( (int)FrustumCulling::bcOutside,
+				(int)FrustumCulling::classifyBox(frustum, Vec3f(-500.f, 0.f, -500.f), Vec3f(-400.f, 1.f, -400.f)) );
+		CPPUNIT_ASSERT_EQUAL( (int)FrustumCulling::bcIntersecting,
+				(int)FrustumCulling::classifyBox(frustum, Vec3f(-500.f, -100.f, -500.f), Vec3f(500.f, 100.f, 500.f)) );
+	}
+
+	void test_quadtree_matches_brute_force() {
+		std::vector<VisibilityItem> items;
+		createVisibilityTestForest(items, 128);
+
+		VisibilityQuadTree tree;
+		CPPUNIT_ASSERT( tree.isBuilt() == false );
+		tree.build(items);
+		CPPUNIT_ASSERT( tree.isBuilt() == true );
+		CPPUNIT_ASSERT_EQUAL( (int)items.size(),tree.getItemCount() );
+
+		std::vector<std::vector<float> > frustum;
+		std::vector<int> expected;
+		std::vector<int> result;
+		for(int step = 0; step < 20; ++step) {
+			createVisibilityTestFrustum(frustum, Vec3f(step * 12.f, 40.f, step * 9.f - 30.f));
+			Rect2i cellBounds(step * 3, step * 2, step * 3 + 90, step * 2 + 70);
+
+			bruteForceVisibilityQuery(items, frustum, cellBounds, expected);
+			result.clear();
+			tree.query(&frustum, cellBounds, result);
+			std::sort(result.begin(), result.end());
+			CPPUNIT_ASSERT( expected == result );
+		}
+
+		// Without a frustum only the cell bounds count
+		Rect2i cellBounds(10, 20, 30, 25);
+		result.clear();
+		tree.query(NULL, cellBounds, result);
+		int insideCount = 0;
+		for(unsigned int i = 0; i < items.size(); ++i) {
+			insideCount += (cellBounds.isInside(items[i].cell) ? 1 : 0);
+		}
+		CPPUNIT_ASSERT_EQUAL( insideCount,(int)result.size() );
+	}
+
+	void test_loose_grid_matches_brute_force() {
+		const int mapSize = 64;
+		const int unitCount = 300;
+		VisibilityLooseGrid grid;
+		CPPUNIT_ASSERT( grid.isInitialized() == false );
+		grid.init(mapSize, mapSize, 8, 0.f, 5.f);
+		CPPUNIT_ASSERT( grid.isInitialized() == true );
+
+		std::vector<int> unitItems(unitCount);
+		for(int unit = 0; unit < unitCount; ++unit) {
+			unitItems[unit] = grid.addItem(getVisibilityTestUnitCell(unit, 0, mapSize), 2.f + getVisibilityTestUnitSize(unit));
+		}
+		CPPUNIT_ASSERT_EQUAL( unitCount,grid.getItemCount() );
+
+		// Every third unit dies half way, the rest keep moving
+		std::vector<std::vector<float> > frustum;
+		int decidedCount = 0;
+		for(int frame = 0; frame < 100; ++frame) {
+			if(frame == 50) {
+				for(int unit = 0; unit < unitCount; unit += 3) {
+					grid.removeItem(unitItems[unit]);
+					unitItems[unit] = -1;
+				}
+				CPPUNIT_ASSERT_EQUAL( unitCount - 100,grid.getItemCount() );
+			}
+			for(int unit = 0; unit < unitCount; ++unit) {
+				if(unitItems[unit] >= 0) {
+					grid.updateItem(unitItems[unit], getVisibilityTestUnitCell(unit, frame, mapSize), 2.f + getVisibilityTestUnitSize(unit));
+				}
+			}
+
+			createVisibilityTestFrustum(frustum, Vec3f(frame * 0.5f, 40.f, frame * 0.4f - 20.f));
+			grid.classify(frustum);
+			for(int unit = 0; unit < unitCount; ++unit) {
+				if(unitItems[unit] < 0) {
+					continue;
+				}
+				Vec3f center = getVisibilityTestUnitCenter(getVisibilityTestUnitCell(unit, frame, mapSize), unit);
+				bool visible = FrustumCulling::cubeInFrustum(frustum, center.x, center.y, center.z, getVisibilityTestUnitSize(unit));
+				switch(grid.getItemClassification(unitItems[unit])) {
+					case FrustumCulling::bcInside:
+						CPPUNIT_ASSERT( visible == true );
+						decidedCount++;
+						break;
+					case FrustumCulling::bcOutside:
+						CPPUNIT_ASSERT( visible == false );
+						decidedCount++;
+						break;
+					default:
+						break;
+				}
+			}
+		}
+		// Most cells are decided without per item tests
+		CPPUNIT_ASSERT( decidedCount > 0 );
+
+		// Items of dead units are handed out again
+		int itemIndex = grid.addItem(Vec2i(1, 1), 1.f);
+		CPPUNIT_ASSERT( itemIndex < unitCount );
+		CPPUNIT_ASSERT_EQUAL( unitCount - 99,grid.getItemCount() );
+
+		grid.clear();
+		CPPUNIT_ASSERT( grid.isInitialized() == false );
+		CPPUNIT_ASSERT_EQUAL( 0,grid.getItemCount() );
+	}
+};
+
+//
+// Benchmark of quadtree and loose grid culling, run with --benchmark
+//
+class VisibilityIndexBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( VisibilityIndexBenchmark );
+
+	CPPUNIT_TEST( test_forest );
+	CPPUNIT_TEST( test_moving_units );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_forest() {
+		const int mapSize = 256;
+		const int cameraSteps = 100;
+		std::vector<VisibilityItem> items;
+		createVisibilityTestForest(items, mapSize);
+
+		VisibilityQuadTree tree;
+		tree.build(items);
+
+		std::vector<std::vector<float> > frustum;
+		std::vector<int> expected;
+		std::vector<int> result;
+		int64 bruteForceMicros = 0;
+		int64 indexedMicros = 0;
+		Chrono chrono;
+		for(int step = 0; step < cameraSteps; ++step) {
+			createVisibilityTestFrustum(frustum, Vec3f(step * 4.f, 40.f, step * 3.f));
+			Rect2i cellBounds(step * 2, step * 2 - 10, step * 2 + 60, step * 2 + 70);
+
+			chrono.start();
+			bruteForceVisibilityQuery(items, frustum, cellBounds, expected);
+			bruteForceMicros += chrono.getMicros();
+
+			chrono.start();
+			result.clear();
+			tree.query(&frustum, cellBounds, result);
+			indexedMicros += chrono.getMicros();
+
+			CPPUNIT_ASSERT_EQUAL( expected.size(),result.size() );
+		}
+
+		printf("\nCulling %d objects over %d camera positions: brute force " MG_I64_SPECIFIER " usecs, quadtree " MG_I64_SPECIFIER " usecs\n",
+				(int)items.size(),cameraSteps,bruteForceMicros,indexedMicros);
+	}
+
+	void test_moving_units() {
+		const int mapSize = 256;
+		const int frameCount = 1000;
+		const int unitCounts[] = { 100, 1000, 5000 };
+
+		for(int countIndex = 0; countIndex < 3; ++countIndex) {
+			const int unitCount = unitCounts[countIndex];
+			VisibilityLooseGrid grid;
+			grid.init(mapSize, mapSize, 8, 0.f, 5.f);
+			std::vector<int> unitItems(unitCount);
+			for(int unit = 0; unit < unitCount; ++unit) {
+				unitItems[unit] = grid.addItem(getVisibilityTestUnitCell(unit, 0, mapSize), 2.f + getVisibilityTestUnitSize(unit));
+			}
+
+			std::vector<std::vector<float> > frustum;
+			int bruteForceVisible = 0;
+			int gridVisible = 0;
+			int64 bruteForceMicros = 0;
+			int64 gridMicros = 0;
+			Chrono chrono;
+			for(int frame = 0; frame < frameCount; ++frame) {
+				createVisibilityTestFrustum(frustum, Vec3f((frame % 100) * 2.f, 40.f, (frame % 100) * 1.5f));
+
+				chrono.start();
+				for(int unit = 0; unit < unitCount; ++unit) {
+					Vec3f center = getVisibilityTestUnitCenter(getVisibilityTestUnitCell(unit, frame, mapSize), unit);
+					bruteForceVisible += FrustumCulling::cubeInFrustum(frustum, center.x, center.y, center.z, getVisibilityTestUnitSize(unit));
+				}
+				bruteForceMicros += chrono.getMicros();
+
+				chrono.start();
+				for(int unit = 0; unit < unitCount; ++unit) {
+					grid.updateItem(unitItems[unit], getVisibilityTestUnitCell(unit, frame, mapSize), 2.f + getVisibilityTestUnitSize(unit));
+				}
+				grid.classify(frustum);
+				for(int unit = 0; unit < unitCount; ++unit) {
+					switch(grid.getItemClassification(unitItems[unit])) {
+						case FrustumCulling::bcInside:
+							gridVisible++;
+							break;
+						case FrustumCulling::bcOutside:
+							break;
+						default:
+							{
+							Vec3f center = getVisibilityTestUnitCenter(getVisibilityTestUnitCell(unit, frame, mapSize), unit);
+							gridVisible += FrustumCulling::cubeInFrustum(frustum, center.x, center.y, center.z, getVisibilityTestUnitSize(unit));
+							}
+							break;
+					}
+				}
+				gridMicros += chrono.getMicros();
+			}
+			CPPUNIT_ASSERT_EQUAL( bruteForceVisible,gridVisible );
+
+			printf("\nCulling %d moving units over %d frames: brute force " MG_I64_SPECIFIER " usecs, loose grid " MG_I64_SPECIFIER " usecs\n",
+					unitCount,frameCount,bruteForceMicros,gridMicros);
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( VisibilityIndexTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( VisibilityIndexBenchmark, "benchmark" );
+//
@@ -0,0 +1,177 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "map_catalog.h"
+#include "map_preview.h"
+#include "platform_util.h"
+#include <cstdio>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Map;
+using namespace Shared::Platform;
+
+//
+// Utility methods for tests
+//
+static void removeMapCatalogTestFile(const string &file) {
+#ifdef WIN32
+	_unlink(file.c_str());
+#else
+    unlink(file.c_str());
+#endif
+}
+
+// 64x128 map, the left half 4 units higher with a start location and
+// an object in the first preview cell
+static void createMapCatalogTestMap(const string &file, int players) {
+	MapPreview map;
+	map.reset(64, 128, 5.f, st_Grass);
+	map.resetFactions(players);
+	for(int j = 0; j < 128; ++j) {
+		for(int i = 0; i < 32; ++i) {
+			map.setHeight(i, j, 9.f);
+		}
+	}
+	map.setSurface(42, 2, st_Stone);
+	map.setObject(3, 3, 2);
+	map.changeStartLocation(60, 100, 0);
+	map.setTitle("Catalogue Test");
+	map.saveToFile(file);
+}
+
+//
+// Tests for MapCatalog class
+//
+class MapCatalogTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MapCatalogTest );
+
+	CPPUNIT_TEST( test_entry_and_preview );
+	CPPUNIT_TEST( test_catalog_persists );
+	CPPUNIT_TEST( test_changed_and_invalid_maps );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void setUp() {
+		MapCatalog::setCatalogPath("map_catalog_test.idx");
+		MapCatalog::clear();
+	}
+
+	void tearDown() {
+		removeMapCatalogTestFile("map_catalog_test.idx");
+		removeMapCatalogTestFile("map_catalog_test.gbm");
+		removeMapCatalogTestFile("map_catalog_test2.gbm");
+		MapCatalog::setCatalogPath("");
+	}
+
+	void test_entry_and_preview() {
+		createMapCatalogTestMap("map_catalog_test.gbm", 4);
+
+		MapCatalogEntry entry;
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test.gbm", entry) == false );
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_test.gbm") == true );
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test.gbm", entry) == true );
+
+		CPPUNIT_ASSERT( entry.valid == true );
+		CPPUNIT_ASSERT_EQUAL( 4,entry.players );
+		CPPUNIT_ASSERT_EQUAL( 64,entry.width );
+		CPPUNIT_ASSERT_EQUAL( 128,entry.height );
+		CPPUNIT_ASSERT_EQUAL( string("Catalogue Test"),entry.title );
+		CPPUNIT_ASSERT( entry.crc != 0 );
+		// Downsampled by 4, the short side stays a valid map size
+		CPPUNIT_ASSERT_EQUAL( 16,entry.previewW );
+		CPPUNIT_ASSERT_EQUAL( 32,entry.previewH );
+
+		MapInfo mapInfo;
+		CPPUNIT_ASSERT( MapPreview::loadMapInfo("map_catalog_test.gbm", &mapInfo, "Players", "Size") == true );
+		CPPUNIT_ASSERT_EQUAL( 4,mapInfo.players );
+		CPPUNIT_ASSERT_EQUAL( 128,mapInfo.size.y );
+		CPPUNIT_ASSERT_EQUAL( string("Players: 4\nSize: 64 x 128"),mapInfo.desc );
+
+		MapPreview preview;
+		CPPUNIT_ASSERT( preview.loadFromCatalog("map_catalog_test.gbm") == true );
+		CPPUNIT_ASSERT( preview.hasFileLoaded() == true );
+		CPPUNIT_ASSERT_EQUAL( string("map_catalog_test.gbm"),preview.getMapFileLoaded() );
+		CPPUNIT_ASSERT_EQUAL( 16,preview.getW() );
+		CPPUNIT_ASSERT_EQUAL( 32,preview.getH() );
+		CPPUNIT_ASSERT_EQUAL( 4,preview.getMaxFactions() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 9.0,preview.getHeight(0, 0),0.05 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 5.0,preview.getHeight(15, 31),0.05 );
+		CPPUNIT_ASSERT_EQUAL( 2,preview.getObject(0, 0) );
+		CPPUNIT_ASSERT_EQUAL( 0,preview.getObject(1, 1) );
+		CPPUNIT_ASSERT_EQUAL( (int)st_Stone,(int)preview.getSurface(10, 0) );
+		CPPUNIT_ASSERT_EQUAL( 15,preview.getStartLocationX(0) );
+		CPPUNIT_ASSERT_EQUAL( 25,preview.getStartLocationY(0) );
+	}
+
+	void test_catalog_persists() {
+		createMapCatalogTestMap("map_catalog_test.gbm", 4);
+		createMapCatalogTestMap("map_catalog_test2.gbm", 2);
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_test.gbm") == true );
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_test2.gbm") == true );
+		MapCatalog::save();
+
+		// Reloaded from disk
+		MapCatalog::setCatalogPath("map_catalog_test.idx");
+		CPPUNIT_ASSERT_EQUAL( 2,MapCatalog::getEntryCount() );
+		MapCatalogEntry entry;
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test2.gbm", entry) == true );
+		CPPUNIT_ASSERT_EQUAL( 2,entry.players );
+		CPPUNIT_ASSERT_EQUAL( 16 * 32 * 3,(int)entry.previewCells.size() );
+		CPPUNIT_ASSERT_EQUAL( 4,(int)entry.previewStartLocations.size() );
+		CPPUNIT_ASSERT_EQUAL( 15,entry.previewStartLocations[0] );
+
+		vector<string> paths;
+		paths.push_back("map_catalog_test.gbm");
+		MapCatalog::pruneEntries(paths);
+		CPPUNIT_ASSERT_EQUAL( 1,MapCatalog::getEntryCount() );
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test2.gbm", entry) == false );
+	}
+
+	void test_changed_and_invalid_maps() {
+		createMapCatalogTestMap("map_catalog_test.gbm", 4);
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_test.gbm") == true );
+
+		// More start locations make the file bigger
+		createMapCatalogTestMap("map_catalog_test.gbm", 8);
+		MapCatalogEntry entry;
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test.gbm", entry) == false );
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_test.gbm") == true );
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test.gbm", entry) == true );
+		CPPUNIT_ASSERT_EQUAL( 8,entry.players );
+
+		FILE *f = fopen("map_catalog_test2.gbm", "wb");
+		fwrite("not a map", 1, 9, f);
+		fclose(f);
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_test2.gbm") == true );
+		CPPUNIT_ASSERT( MapCatalog::findEntry("map_catalog_test2.gbm", entry) == true );
+		CPPUNIT_ASSERT( entry.valid == false );
+
+		MapInfo mapInfo;
+		CPPUNIT_ASSERT( MapPreview::loadMapInfo("map_catalog_test2.gbm", &mapInfo, "", "", false) == false );
+		MapPreview preview;
+		CPPUNIT_ASSERT( preview.loadFromCatalog("map_catalog_test2.gbm") == false );
+		CPPUNIT_ASSERT( MapCatalog::refreshEntry("map_catalog_missing.gbm") == false );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( MapCatalogTest );
+//
@@ -0,0 +1,318 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "map_preview.h"
+#include "platform_util.h"
+#include <cstdio>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Map;
+using namespace Shared::Platform;
+
+//
+// Utility methods for tests
+//
+
+// Every cell different, so a cell landing in the wrong place is noticed
+static void createMapPreviewTestMap(MapPreview &map, int w, int h) {
+	map.reset(w, h, 10.f, st_Grass);
+	map.resetFactions(2);
+	for(int j = 0; j < h; ++j) {
+		for(int i = 0; i < w; ++i) {
+			map.setHeight(i, j, (float)((i * 7 + j * 3) % 21));
+			map.setSurface(i, j, static_cast<MapSurfaceType>(st_Grass + (i + j * 2) % 5));
+			if((i + j) % 7 == 0) {
+				map.setObject(i, j, 1 + (i % 10));
+			}
+			else if((i * j) % 11 == 1) {
+				map.setResource(i, j, 1 + (j % 5));
+			}
+		}
+	}
+	map.changeStartLocation(3, 5, 0);
+	map.changeStartLocation(w - 4, h - 6, 1);
+}
+
+static bool sameMapPreviewCells(const MapPreview &map1, const MapPreview &map2) {
+	if(map1.getW() != map2.getW() || map1.getH() != map2.getH()) {
+		return false;
+	}
+	for(int j = 0; j < map1.getH(); ++j) {
+		for(int i = 0; i < map1.getW(); ++i) {
+			if(map1.getHeight(i, j) != map2.getHeight(i, j) ||
+				map1.getSurface(i, j) != map2.getSurface(i, j) ||
+				map1.getObject(i, j) != map2.getObject(i, j) ||
+				map1.getResource(i, j) != map2.getResource(i, j)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// The 3x3 average the smoothing should produce, straight from the old heights
+static float smoothedMapPreviewHeight(const MapPreview &map, int x, int y) {
+	float height = 0.f;
+	for(int k = -1; k <= 1; ++k) {
+		for(int l = -1; l <= 1; ++l) {
+			height += (int)map.getHeight(x + l, y + k);
+		}
+	}
+	return height / 9.f;
+}
+
+//
+// Tests for MapPreview class
+//
+class MapPreviewTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MapPreviewTest );
+
+	CPPUNIT_TEST( test_flip_non_square );
+	CPPUNIT_TEST( test_smooth_non_square );
+	CPPUNIT_TEST( test_resize_and_switch_surfaces );
+	CPPUNIT_TEST( test_workers_match_calling_thread );
+	CPPUNIT_TEST( test_dirty_rect );
+	CPPUNIT_TEST( test_tile_copy_restore );
+	CPPUNIT_TEST( test_save_load );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void tearDown() {
+		MapPreview::rowWorkerThreadCount = -1;
+#ifdef WIN32
+		_unlink("map_preview_test.gbm");
+#else
+		unlink("map_preview_test.gbm");
+#endif
+	}
+
+	void test_flip_non_square() {
+		MapPreview map;
+		createMapPreviewTestMap(map, 64, 256);
+		MapPreview original;
+		createMapPreviewTestMap(original, 64, 256);
+
+		map.flipX();
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(63, 200),map.getHeight(0, 200) );
+		CPPUNIT_ASSERT_EQUAL( original.getSurface(10, 7),map.getSurface(53, 7) );
+		CPPUNIT_ASSERT_EQUAL( original.getObject(0, 0),map.getObject(63, 0) );
+		CPPUNIT_ASSERT_EQUAL( 60,map.getStartLocationX(0) );
+
+		map.flipY();
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(63, 55),map.getHeight(0, 200) );
+		CPPUNIT_ASSERT_EQUAL( original.getResource(20, 250),map.getResource(43, 5) );
+		CPPUNIT_ASSERT_EQUAL( 250,map.getStartLocationY(0) );
+
+		map.flipX();
+		map.flipY();
+		CPPUNIT_ASSERT( sameMapPreviewCells(original, map) == true );
+	}
+
+	void test_smooth_non_square() {
+		MapPreview map;
+		createMapPreviewTestMap(map, 32, 128);
+		MapPreview original;
+		createMapPreviewTestMap(original, 32, 128);
+
+		map.smoothSurface(false);
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(0, 100),map.getHeight(0, 100) );
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(31, 127),map.getHeight(31, 127) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( smoothedMapPreviewHeight(original, 1, 1),map.getHeight(1, 1),0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( smoothedMapPreviewHeight(original, 30, 100),map.getHeight(30, 100),0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( smoothedMapPreviewHeight(original, 5, 126),map.getHeight(5, 126),0.0001 );
+	}
+
+	void test_resize_and_switch_surfaces() {
+		MapPreview map;
+		createMapPreviewTestMap(map, 64, 32);
+		MapPreview original;
+		createMapPreviewTestMap(original, 64, 32);
+
+		map.resize(128, 32, 4.f, st_Road);
+		CPPUNIT_ASSERT_EQUAL( 128,map.getW() );
+		CPPUNIT_ASSERT_EQUAL( 4.f,map.getHeight(0, 0) );
+		CPPUNIT_ASSERT_EQUAL( st_Road,map.getSurface(127, 31) );
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(5, 9),map.getHeight(37, 9) );
+		CPPUNIT_ASSERT_EQUAL( original.getObject(7, 0),map.getObject(39, 0) );
+		CPPUNIT_ASSERT_EQUAL( 35,map.getStartLocationX(0) );
+
+		MapPreview shrunk;
+		createMapPreviewTestMap(shrunk, 64, 32);
+		shrunk.resize(32, 16, 4.f, st_Road);
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(5, 9),shrunk.getHeight(5, 9) );
+		CPPUNIT_ASSERT_EQUAL( original.getSurface(31, 15),shrunk.getSurface(31, 15) );
+
+		shrunk.switchSurfaces(st_Grass, st_Stone);
+		CPPUNIT_ASSERT_EQUAL( st_Stone,shrunk.getSurface(0, 0) );
+		CPPUNIT_ASSERT_EQUAL( st_Grass,shrunk.getSurface(3, 0) );
+		CPPUNIT_ASSERT_EQUAL( st_Road,shrunk.getSurface(2, 0) );
+	}
+
+	void test_workers_match_calling_thread() {
+		MapPreview::rowWorkerThreadCount = 0;
+		MapPreview serial;
+		createMapPreviewTestMap(serial, 512, 1024);
+		serial.flipX();
+		serial.flipY();
+		serial.smoothSurface(true);
+		serial.switchSurfaces(st_Road, st_Ground);
+
+		MapPreview::rowWorkerThreadCount = 3;
+		MapPreview parallel;
+		createMapPreviewTestMap(parallel, 512, 1024);
+		parallel.flipX();
+		parallel.flipY();
+		parallel.smoothSurface(true);
+		parallel.switchSurfaces(st_Road, st_Ground);
+
+		CPPUNIT_ASSERT( sameMapPreviewCells(serial, parallel) == true );
+	}
+
+	void test_dirty_rect() {
+		MapPreview map;
+		map.reset(64, 64, 10.f, st_Grass);
+		int minX = 0, minY = 0, maxX = 0, maxY = 0;
+		CPPUNIT_ASSERT( map.getDirtyRect(minX, minY, maxX, maxY) == true );
+		CPPUNIT_ASSERT_EQUAL( 63,maxX );
+		map.clearDirtyRect();
+		CPPUNIT_ASSERT( map.getDirtyRect(minX, minY, maxX, maxY) == false );
+
+		map.changeSurface(2, 60, st_Stone, 3);
+		CPPUNIT_ASSERT( map.getDirtyRect(minX, minY, maxX, maxY) == true );
+		CPPUNIT_ASSERT_EQUAL( 0,minX );
+		CPPUNIT_ASSERT_EQUAL( 57,minY );
+		CPPUNIT_ASSERT_EQUAL( 5,maxX );
+		CPPUNIT_ASSERT_EQUAL( 63,maxY );
+
+		map.setObject(20, 10, 3);
+		CPPUNIT_ASSERT( map.getDirtyRect(minX, minY, maxX, maxY) == true );
+		CPPUNIT_ASSERT_EQUAL( 10,minY );
+		CPPUNIT_ASSERT_EQUAL( 20,maxX );
+
+		// A zero height stroke levels the cells to the reference height
+		map.clearDirtyRect();
+		map.setRefAlt(30, 30);
+		map.glestChangeHeight(30, 30, 0, 1);
+		CPPUNIT_ASSERT( map.getDirtyRect(minX, minY, maxX, maxY) == true );
+		CPPUNIT_ASSERT_EQUAL( 29,minX );
+		CPPUNIT_ASSERT_EQUAL( 31,maxY );
+
+		// Only the surfaces in use are switched
+		map.clearDirtyRect();
+		map.switchSurfaces(st_Road, st_Ground);
+		CPPUNIT_ASSERT( map.getDirtyRect(minX, minY, maxX, maxY) == false );
+	}
+
+	void test_tile_copy_restore() {
+		MapPreview map;
+		createMapPreviewTestMap(map, 64, 48);
+		MapPreview original;
+		createMapPreviewTestMap(original, 64, 48);
+		CPPUNIT_ASSERT_EQUAL( 2,map.getTilesW() );
+		CPPUNIT_ASSERT_EQUAL( 2,map.getTilesH() );
+
+		MapPreviewTile tile;
+		map.copyTile(1, 1, tile);
+		CPPUNIT_ASSERT_EQUAL( 32,tile.w );
+		CPPUNIT_ASSERT_EQUAL( 16,tile.h );
+		CPPUNIT_ASSERT_EQUAL( original.getHeight(40, 45),tile.heights[13 * 32 + 8] );
+
+		// Only the stamps of the touched tiles change
+		uint32 untouchedStamp = map.getTileStamp(0, 0);
+		map.changeObject(50, 40, 2, 2);
+		CPPUNIT_ASSERT_EQUAL( untouchedStamp,map.getTileStamp(0, 0) );
+		CPPUNIT_ASSERT( map.getTileStamp(1, 1) != tile.stamp );
+
+		map.restoreTile(1, 1, tile);
+		CPPUNIT_ASSERT_EQUAL( tile.stamp,map.getTileStamp(1, 1) );
+		CPPUNIT_ASSERT( sameMapPreviewCells(original, map) == true );
+	}
+
+	void test_save_load() {
+		MapPreview map;
+		createMapPreviewTestMap(map, 64, 128);
+		map.saveToFile("map_preview_test.gbm");
+
+		MapPreview loaded;
+		loaded.loadFromFile("map_preview_test.gbm");
+		CPPUNIT_ASSERT( sameMapPreviewCells(map, loaded) == true );
+		CPPUNIT_ASSERT_EQUAL( 2,loaded.getMaxFactions() );
+		CPPUNIT_ASSERT_EQUAL( 60,loaded.getStartLocationX(1) );
+		CPPUNIT_ASSERT( loaded.getHasChanged() == false );
+	}
+};
+
+//
+// Benchmark of whole map operations, run with --benchmark
+//
+class MapPreviewBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MapPreviewBenchmark );
+
+	CPPUNIT_TEST( test_operations );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void tearDown() {
+		MapPreview::rowWorkerThreadCount = -1;
+#ifdef WIN32
+		_unlink("map_preview_test.gbm");
+#else
+		unlink("map_preview_test.gbm");
+#endif
+	}
+
+	void test_operations() {
+		const int mapSize = 1024;
+		MapPreview map;
+		createMapPreviewTestMap(map, mapSize, mapSize);
+
+		Chrono chrono(true);
+		map.flipX();
+		map.flipY();
+		int64 flipMicros = chrono.getMicros();
+
+		chrono.start();
+		map.smoothSurface(false);
+		int64 smoothMicros = chrono.getMicros();
+
+		chrono.start();
+		map.switchSurfaces(st_Grass, st_Stone);
+		int64 switchMicros = chrono.getMicros();
+
+		chrono.start();
+		for(int index = 0; index < 1000; ++index) {
+			map.glestChangeHeight((index * 37) % mapSize, (index * 91) % mapSize, 3, 8);
+		}
+		int64 brushMicros = chrono.getMicros();
+
+		printf("\nMap %dx%d: flip " MG_I64_SPECIFIER " usecs, smooth " MG_I64_SPECIFIER " usecs, switch surfaces " MG_I64_SPECIFIER " usecs, 1000 brush strokes " MG_I64_SPECIFIER " usecs\n",
+				mapSize,mapSize,flipMicros,smoothMicros,switchMicros,brushMicros);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( MapPreviewTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( MapPreviewBenchmark, "benchmark" );
+//
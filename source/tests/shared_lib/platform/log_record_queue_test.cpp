@@ -0,0 +1,226 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "log_record_queue.h"
+#include "thread.h"
+#include "platform_common.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility methods for tests
+//
+static void pushLogRecord(LogRecordQueue &queue, SystemFlags::DebugType type, const char *fmt, ...) {
+	va_list argList;
+	va_start(argList, fmt);
+	queue.push(type, fmt, argList);
+	va_end(argList);
+}
+
+static string formatLogRecord(const char *fmt, ...) {
+	va_list argList;
+	va_start(argList, fmt);
+	char szBuf[LogRecordQueue::maxEntryLength]="";
+	vsnprintf(szBuf,LogRecordQueue::maxEntryLength-1,fmt,argList);
+	va_end(argList);
+	return szBuf;
+}
+
+static string popLogRecord(LogRecordQueue &queue) {
+	SystemFlags::DebugType type = SystemFlags::debugSystem;
+	string entry = "";
+	time_t entryTime = 0;
+	CPPUNIT_ASSERT( queue.pop(type, entry, entryTime) == true );
+	return entry;
+}
+
+// Pushes numbered records as fast as it can
+class TestLogProducerThread : public Thread {
+private:
+	LogRecordQueue *queue;
+	int producer;
+	int recordCount;
+
+public:
+	TestLogProducerThread(LogRecordQueue *queue, int producer, int recordCount) :
+		queue(queue), producer(producer), recordCount(recordCount) {}
+
+	virtual void execute() {
+		for(int index = 0; index < recordCount; ++index) {
+			pushLogRecord(*queue, SystemFlags::debugNetwork, "producer %d record %d\n", producer, index);
+		}
+	}
+};
+
+//
+// Tests for LogRecordQueue class
+//
+class LogRecordQueueTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( LogRecordQueueTest );
+
+	CPPUNIT_TEST( test_deferred_formatting_matches_printf );
+	CPPUNIT_TEST( test_reused_format_buffer );
+	CPPUNIT_TEST( test_rate_limit );
+	CPPUNIT_TEST( test_overflow_keeps_order );
+	CPPUNIT_TEST( test_multiple_producers );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_deferred_formatting_matches_printf() {
+		LogRecordQueue queue;
+		const char *text = "unit";
+		const char *nullText = NULL;
+		long long frame = 1234567890123LL;
+		size_t count = 42;
+		string longText(3000, 'x');
+
+		pushLogRecord(queue, SystemFlags::debugWorldSynch, "In [%s::%s Line: %d] frame %lld ptr %p\n", "world.cpp", "update", 120, frame, &queue);
+		pushLogRecord(queue, SystemFlags::debugWorldSynch, "%u %c %.2f %04X %ld 100%% %s\n", 7u, 'z', 3.14159, 0xBEEF, -5L, nullText);
+		pushLogRecord(queue, SystemFlags::debugWorldSynch, "[%*d] [%-*.*s] " MG_SIZE_T_SPECIFIER "\n", 6, 42, 8, 2, text, count);
+		pushLogRecord(queue, SystemFlags::debugWorldSynch, "long [%s]\n", longText.c_str());
+		pushLogRecord(queue, SystemFlags::debugWorldSynch, "%Lf\n", (long double)1.5);
+		CPPUNIT_ASSERT_EQUAL( (size_t)5,queue.getCount() );
+
+		CPPUNIT_ASSERT_EQUAL( formatLogRecord("In [%s::%s Line: %d] frame %lld ptr %p\n", "world.cpp", "update", 120, frame, &queue),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( formatLogRecord("%u %c %.2f %04X %ld 100%% %s\n", 7u, 'z', 3.14159, 0xBEEF, -5L, nullText),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( formatLogRecord("[%*d] [%-*.*s] " MG_SIZE_T_SPECIFIER "\n", 6, 42, 8, 2, text, count),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( "long [" + longText + "]\n",popLogRecord(queue) );
+		// Not stored raw, formatted by the producer
+		CPPUNIT_ASSERT_EQUAL( formatLogRecord("%Lf\n", (long double)1.5),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( (size_t)0,queue.getCount() );
+
+		SystemFlags::DebugType type = SystemFlags::debugSystem;
+		string entry = "";
+		time_t entryTime = 0;
+		CPPUNIT_ASSERT( queue.pop(type, entry, entryTime) == false );
+	}
+
+	void test_reused_format_buffer() {
+		LogRecordQueue queue;
+		char szBuf[128]="";
+		for(int index = 0; index < 3; ++index) {
+			snprintf(szBuf,128,"preformatted %d\n",index);
+			pushLogRecord(queue, SystemFlags::debugError, szBuf);
+		}
+		// The same literal twice is one format
+		for(int index = 0; index < 2; ++index) {
+			pushLogRecord(queue, SystemFlags::debugError, "literal %d\n", index);
+		}
+
+		CPPUNIT_ASSERT_EQUAL( string("preformatted 0\n"),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( string("preformatted 1\n"),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( string("preformatted 2\n"),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( string("literal 0\n"),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( string("literal 1\n"),popLogRecord(queue) );
+		CPPUNIT_ASSERT_EQUAL( 2,queue.getFormatCount() );
+	}
+
+	void test_rate_limit() {
+		LogRecordQueue queue;
+		queue.setRateLimit(5);
+		for(int index = 0; index < 20; ++index) {
+			pushLogRecord(queue, SystemFlags::debugNetwork, "network %d\n", index);
+			pushLogRecord(queue, SystemFlags::debugError, "error %d\n", index);
+		}
+
+		int networkCount = 0;
+		int errorCount = 0;
+		SystemFlags::DebugType type = SystemFlags::debugSystem;
+		string entry = "";
+		time_t entryTime = 0;
+		for(;queue.pop(type, entry, entryTime) == true;) {
+			(type == SystemFlags::debugError ? errorCount : networkCount)++;
+		}
+		// At most one more second may have started during the loop
+		CPPUNIT_ASSERT( networkCount >= 5 && networkCount <= 10 );
+		CPPUNIT_ASSERT_EQUAL( 20,errorCount );
+		CPPUNIT_ASSERT_EQUAL( 20 - networkCount,queue.takeDroppedCount(SystemFlags::debugNetwork) );
+		CPPUNIT_ASSERT_EQUAL( 0,queue.takeDroppedCount(SystemFlags::debugNetwork) );
+	}
+
+	void test_overflow_keeps_order() {
+		const int recordCount = LogRecordQueue::slotCount + 10;
+		LogRecordQueue queue;
+		for(int index = 0; index < recordCount; ++index) {
+			pushLogRecord(queue, SystemFlags::debugNetwork, "record %d\n", index);
+		}
+		CPPUNIT_ASSERT_EQUAL( (size_t)recordCount,queue.getCount() );
+		CPPUNIT_ASSERT_EQUAL( 10,queue.getOverflowTotal() );
+
+		// Freeing a slot does not let newer records pass the spilled ones
+		CPPUNIT_ASSERT_EQUAL( string("record 0\n"),popLogRecord(queue) );
+		pushLogRecord(queue, SystemFlags::debugNetwork, "record %d\n", recordCount);
+		CPPUNIT_ASSERT_EQUAL( 11,queue.getOverflowTotal() );
+		for(int index = 1; index <= recordCount; ++index) {
+			CPPUNIT_ASSERT_EQUAL( formatLogRecord("record %d\n", index),popLogRecord(queue) );
+		}
+		CPPUNIT_ASSERT_EQUAL( (size_t)0,queue.getCount() );
+
+		// Caught up, the slots are used again
+		pushLogRecord(queue, SystemFlags::debugNetwork, "record %d\n", 0);
+		CPPUNIT_ASSERT_EQUAL( 11,queue.getOverflowTotal() );
+		CPPUNIT_ASSERT_EQUAL( string("record 0\n"),popLogRecord(queue) );
+	}
+
+	void test_multiple_producers() {
+		const int producerCount = 4;
+		const int recordCount = 5000;
+		LogRecordQueue queue;
+		TestLogProducerThread *producers[producerCount];
+		for(int index = 0; index < producerCount; ++index) {
+			producers[index] = new TestLogProducerThread(&queue, index, recordCount);
+			producers[index]->start();
+		}
+		// Let them fill the queue
+		sleep(100);
+
+		int nextRecord[producerCount] = { 0, 0, 0, 0 };
+		int popCount = 0;
+		Chrono chrono(true);
+		for(;popCount < producerCount * recordCount && chrono.getMillis() < 20000;) {
+			SystemFlags::DebugType type = SystemFlags::debugSystem;
+			string entry = "";
+			time_t entryTime = 0;
+			if(queue.pop(type, entry, entryTime) == false) {
+				sleep(1);
+				continue;
+			}
+			int producer = -1;
+			int record = -1;
+			CPPUNIT_ASSERT_EQUAL( 2,sscanf(entry.c_str(), "producer %d record %d", &producer, &record) );
+			CPPUNIT_ASSERT( producer >= 0 && producer < producerCount );
+			// Each producer's records stay in order
+			CPPUNIT_ASSERT_EQUAL( nextRecord[producer],record );
+			nextRecord[producer]++;
+			popCount++;
+		}
+		for(int index = 0; index < producerCount; ++index) {
+			delete producers[index];
+		}
+
+		CPPUNIT_ASSERT_EQUAL( producerCount * recordCount,popCount );
+		// More records than slots, some spilled over
+		CPPUNIT_ASSERT( queue.getOverflowTotal() > 0 );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( LogRecordQueueTest );
+//
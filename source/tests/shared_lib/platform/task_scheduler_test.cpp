@@ -0,0 +1,183 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "task_scheduler.h"
+#include "platform_common.h"
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility methods for tests
+//
+
+// Counts its runs, each run takes runMillis
+class TestSchedulerTask : public SimpleTaskCallbackInterface {
+private:
+	Mutex mutex;
+	int runCount;
+	int runMillis;
+
+public:
+	BaseThread *lastCallingThread;
+	void *lastUserdata;
+
+	TestSchedulerTask(int runMillis=0) : runCount(0), runMillis(runMillis),
+		lastCallingThread(NULL), lastUserdata(NULL) {}
+
+	virtual void simpleTask(BaseThread *callingThread,void *userdata) {
+		if(runMillis > 0) {
+			sleep(runMillis);
+		}
+		MutexSafeWrapper safeMutex(&mutex);
+		runCount++;
+		lastCallingThread = callingThread;
+		lastUserdata = userdata;
+	}
+
+	int getRunCount() {
+		MutexSafeWrapper safeMutex(&mutex);
+		return runCount;
+	}
+};
+
+static void waitForSchedulerRuns(TestSchedulerTask &task, int runCount, int timeoutMillis) {
+	Chrono chrono(true);
+	for(;task.getRunCount() < runCount && chrono.getMillis() < timeoutMillis;) {
+		sleep(1);
+	}
+}
+
+//
+// Tests for TaskScheduler class
+//
+class TaskSchedulerTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TaskSchedulerTest );
+
+	CPPUNIT_TEST( test_periodic_tasks_share_workers );
+	CPPUNIT_TEST( test_single_task_uses_one_thread );
+	CPPUNIT_TEST( test_execution_count_and_stats );
+	CPPUNIT_TEST( test_cancel_and_run_now );
+	CPPUNIT_TEST( test_shutdown_with_timeout );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_periodic_tasks_share_workers() {
+		TaskScheduler scheduler(2);
+		CPPUNIT_ASSERT_EQUAL( 0,scheduler.getThreadCount() );
+
+		TestSchedulerTask tasks[6];
+		for(int index = 0; index < 6; ++index) {
+			CPPUNIT_ASSERT( scheduler.scheduleTask(&tasks[index], 20 + index * 5) > 0 );
+		}
+		// The second worker is only started once the first one is busy
+		CPPUNIT_ASSERT_EQUAL( 1,scheduler.getThreadCount() );
+
+		for(int index = 0; index < 6; ++index) {
+			waitForSchedulerRuns(tasks[index], 3, 5000);
+			CPPUNIT_ASSERT( tasks[index].getRunCount() >= 3 );
+		}
+		// Two workers whatever the number of tasks
+		CPPUNIT_ASSERT_EQUAL( 2,scheduler.getThreadCount() );
+		CPPUNIT_ASSERT( scheduler.shutdown(2000) == true );
+		CPPUNIT_ASSERT_EQUAL( 0,scheduler.getThreadCount() );
+	}
+
+	void test_single_task_uses_one_thread() {
+		TaskScheduler scheduler(2);
+		TestSchedulerTask task(2);
+		scheduler.scheduleTask(&task, 10);
+
+		// The only worker also keeps the timer, like one SimpleTaskThread
+		waitForSchedulerRuns(task, 5, 5000);
+		CPPUNIT_ASSERT( task.getRunCount() >= 5 );
+		CPPUNIT_ASSERT_EQUAL( 1,scheduler.getThreadCount() );
+	}
+
+	void test_execution_count_and_stats() {
+		TaskScheduler scheduler(1);
+		TestSchedulerTask task(2);
+		int userdata = 7;
+		int taskId = scheduler.scheduleTask(&task, 10, 3, &userdata, "counted");
+
+		TaskSchedulerStats stats;
+		CPPUNIT_ASSERT( scheduler.getTaskStats(taskId, stats) == true );
+		CPPUNIT_ASSERT_EQUAL( string("counted"),stats.name );
+
+		waitForSchedulerRuns(task, 3, 5000);
+		sleep(50);
+		CPPUNIT_ASSERT_EQUAL( 3,task.getRunCount() );
+		CPPUNIT_ASSERT( task.lastUserdata == &userdata );
+		CPPUNIT_ASSERT( task.lastCallingThread != NULL );
+		// Done after three runs
+		CPPUNIT_ASSERT( scheduler.isTaskScheduled(taskId) == false );
+		CPPUNIT_ASSERT( scheduler.getTaskStats(taskId, stats) == false );
+
+		TestSchedulerTask periodic(2);
+		taskId = scheduler.scheduleTask(&periodic, 10);
+		waitForSchedulerRuns(periodic, 2, 5000);
+		CPPUNIT_ASSERT( scheduler.getTaskStats(taskId, stats) == true );
+		CPPUNIT_ASSERT( stats.runCount >= 2 );
+		CPPUNIT_ASSERT( stats.totalMicros >= stats.maxMicros );
+		CPPUNIT_ASSERT( stats.maxMicros >= stats.lastMicros );
+		CPPUNIT_ASSERT( scheduler.getStatsReport().find("task ") != string::npos );
+	}
+
+	void test_cancel_and_run_now() {
+		TaskScheduler scheduler(1);
+		TestSchedulerTask task;
+		int taskId = scheduler.scheduleTask(&task, 60000);
+		CPPUNIT_ASSERT( scheduler.isTaskScheduled(taskId) == true );
+
+		// Due in a minute, run it right away
+		CPPUNIT_ASSERT( scheduler.runTaskNow(taskId) == true );
+		waitForSchedulerRuns(task, 1, 5000);
+		CPPUNIT_ASSERT_EQUAL( 1,task.getRunCount() );
+
+		CPPUNIT_ASSERT( scheduler.cancelTask(taskId) == true );
+		CPPUNIT_ASSERT( scheduler.isTaskScheduled(taskId) == false );
+		CPPUNIT_ASSERT( scheduler.runTaskNow(taskId) == false );
+
+		// A running task is dropped after its run
+		TestSchedulerTask slowTask(200);
+		taskId = scheduler.scheduleTask(&slowTask, 10);
+		sleep(100);
+		CPPUNIT_ASSERT( scheduler.cancelTask(taskId, 0) == false );
+		CPPUNIT_ASSERT( scheduler.isTaskScheduled(taskId) == false );
+		CPPUNIT_ASSERT( scheduler.cancelTask(taskId, 2000) == true );
+		sleep(50);
+		CPPUNIT_ASSERT_EQUAL( 1,slowTask.getRunCount() );
+	}
+
+	void test_shutdown_with_timeout() {
+		TaskScheduler scheduler(1);
+		TestSchedulerTask slowTask(300);
+		scheduler.scheduleTask(&slowTask, 10);
+		sleep(100);
+
+		// The worker is still in the task
+		CPPUNIT_ASSERT( scheduler.shutdown(20) == false );
+		CPPUNIT_ASSERT( scheduler.scheduleTask(&slowTask, 10) == -1 );
+		sleep(400);
+		CPPUNIT_ASSERT_EQUAL( 1,slowTask.getRunCount() );
+		// and is stopped by the next call
+		CPPUNIT_ASSERT( scheduler.shutdown(2000) == true );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( TaskSchedulerTest );
+//
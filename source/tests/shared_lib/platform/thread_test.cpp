@@ -0,0 +1,147 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "thread.h"
+#include "base_thread.h"
+#include "platform_common.h"
+#include <cstring>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility methods for tests
+//
+static const char *threadTestWorkerSite = "thread_test_worker";
+static const char *threadTestMainSite = "thread_test_main";
+
+// Holds the mutex a while once the main thread is about to lock it
+class TestContentionThread : public BaseThread {
+private:
+	Mutex *mutex;
+	Semaphore *locked;
+
+public:
+	TestContentionThread(Mutex *mutex, Semaphore *locked) : BaseThread(), mutex(mutex), locked(locked) {
+		setUniqueID("TestContentionThread");
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		MutexSafeWrapper safeMutex(mutex,threadTestWorkerSite);
+		locked->signal();
+		sleep(60);
+	}
+};
+
+static MutexContentionStats findThreadTestSite(const char *ownerId) {
+	vector<MutexContentionStats> stats = MutexContentionProfiler::getStats();
+	for(unsigned int index = 0; index < stats.size(); ++index) {
+		if(strcmp(stats[index].ownerId,ownerId) == 0) {
+			return stats[index];
+		}
+	}
+	return MutexContentionStats();
+}
+
+//
+// Tests for MutexSafeWrapper and MutexContentionProfiler classes
+//
+class ThreadTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ThreadTest );
+
+	CPPUNIT_TEST( test_profiler_disabled_by_default );
+	CPPUNIT_TEST( test_profiler_counts_call_sites );
+	CPPUNIT_TEST( test_profiler_wait_and_hold_per_thread );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void tearDown() {
+		MutexContentionProfiler::setEnabled(false);
+		MutexContentionProfiler::reset();
+	}
+
+	void test_profiler_disabled_by_default() {
+		CPPUNIT_ASSERT( MutexContentionProfiler::isEnabled() == false );
+
+		Mutex mutex(CODE_AT_LINE);
+		MutexSafeWrapper safeMutex(&mutex,"thread_test_disabled");
+		safeMutex.ReleaseLock();
+		CPPUNIT_ASSERT_EQUAL( (uint32)0,findThreadTestSite("thread_test_disabled").lockCount );
+	}
+
+	void test_profiler_counts_call_sites() {
+		MutexContentionProfiler::reset();
+		MutexContentionProfiler::setEnabled(true);
+
+		Mutex mutex(CODE_AT_LINE);
+		for(int index = 0; index < 5; ++index) {
+			MutexSafeWrapper safeMutex(&mutex,"thread_test_loop");
+		}
+		MutexSafeWrapper safeMutex(&mutex,"thread_test_relock");
+		safeMutex.ReleaseLock(true);
+		safeMutex.Lock();
+		sleep(20);
+		safeMutex.ReleaseLock();
+
+		MutexContentionStats loop = findThreadTestSite("thread_test_loop");
+		MutexContentionStats relock = findThreadTestSite("thread_test_relock");
+		CPPUNIT_ASSERT_EQUAL( (uint32)5,loop.lockCount );
+		CPPUNIT_ASSERT_EQUAL( (uint32)2,relock.lockCount );
+		CPPUNIT_ASSERT( relock.holdMicros >= relock.maxHoldMicros );
+		CPPUNIT_ASSERT( loop.maxHoldMicros < relock.maxHoldMicros );
+
+		MutexContentionProfiler::reset();
+		CPPUNIT_ASSERT_EQUAL( (uint32)0,findThreadTestSite("thread_test_loop").lockCount );
+	}
+
+	void test_profiler_wait_and_hold_per_thread() {
+		MutexContentionProfiler::reset();
+		MutexContentionProfiler::setEnabled(true);
+
+		Mutex mutex(CODE_AT_LINE);
+		Semaphore locked;
+		TestContentionThread *thread = new TestContentionThread(&mutex,&locked);
+		thread->start();
+		locked.waitTillSignalled();
+
+		MutexSafeWrapper safeMutex(&mutex,threadTestMainSite);
+		safeMutex.ReleaseLock();
+		if(thread->shutdownAndJoin() == true) {
+			delete thread;
+		}
+
+		// The worker held the mutex the main thread waited for
+		MutexContentionStats worker = findThreadTestSite(threadTestWorkerSite);
+		MutexContentionStats main = findThreadTestSite(threadTestMainSite);
+		CPPUNIT_ASSERT_EQUAL( (uint32)1,worker.lockCount );
+		CPPUNIT_ASSERT_EQUAL( (uint32)1,main.lockCount );
+		CPPUNIT_ASSERT( main.waitMicros > worker.waitMicros );
+		CPPUNIT_ASSERT( worker.holdMicros > main.holdMicros );
+
+		// Worst wait first
+		vector<MutexContentionStats> stats = MutexContentionProfiler::getStats();
+		CPPUNIT_ASSERT( stats.empty() == false );
+		CPPUNIT_ASSERT( strcmp(stats[0].ownerId,threadTestMainSite) == 0 );
+
+		string report = MutexContentionProfiler::getReport(3);
+		CPPUNIT_ASSERT( report.find(threadTestMainSite) != string::npos );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ThreadTest );
+//
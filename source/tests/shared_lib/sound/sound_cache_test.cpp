@@ -0,0 +1,190 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "sound_cache.h"
+#include "platform_common.h"
+#include <fstream>
+#include <cstring>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Sound;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility methods for tests
+//
+static void removeSoundCacheTestFile(const string &file) {
+#ifdef WIN32
+	_unlink(file.c_str());
+#else
+    unlink(file.c_str());
+#endif
+}
+
+static void writeSoundCacheTestValue(std::ofstream &out, uint32 value, int bytes) {
+	for(int i = 0; i < bytes; ++i) {
+		out.put((char)((value >> (i * 8)) & 0xFF));
+	}
+}
+
+// Mono 16 bit wav whose sample bytes count up from seed
+static void createSoundCacheTestWav(const string &file, uint32 dataSize, int seed) {
+	std::ofstream out(file.c_str(), std::ios::out | std::ios::binary);
+	out.write("RIFF", 4);
+	writeSoundCacheTestValue(out, 36 + dataSize, 4);
+	out.write("WAVE", 4);
+	out.write("fmt ", 4);
+	writeSoundCacheTestValue(out, 16, 4);
+	writeSoundCacheTestValue(out, 1, 2);
+	writeSoundCacheTestValue(out, 1, 2);
+	writeSoundCacheTestValue(out, 8000, 4);
+	writeSoundCacheTestValue(out, 16000, 4);
+	writeSoundCacheTestValue(out, 2, 2);
+	writeSoundCacheTestValue(out, 16, 2);
+	out.write("data", 4);
+	writeSoundCacheTestValue(out, dataSize, 4);
+	for(uint32 i = 0; i < dataSize; ++i) {
+		out.put((char)(i + seed));
+	}
+	out.close();
+}
+
+static bool soundCacheTestSamplesMatch(const int8 *samples, uint32 dataSize, int seed) {
+	for(uint32 i = 0; i < dataSize; ++i) {
+		if(samples[i] != (int8)(i + seed)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//
+// Tests for PcmSoundCache class
+//
+class SoundCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SoundCacheTest );
+
+	CPPUNIT_TEST( test_same_file_is_shared_and_decoded_lazily );
+	CPPUNIT_TEST( test_background_decode );
+	CPPUNIT_TEST( test_memory_limit_evicts_least_recently_used );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_same_file_is_shared_and_decoded_lazily() {
+		const string file = "sound_cache_test1.wav";
+		const uint32 dataSize = 1000;
+		createSoundCacheTestWav(file, dataSize, 3);
+
+		PcmSoundCache &cache = PcmSoundCache::getInstance();
+		int entryCount = cache.getEntryCount();
+		uint32 decodeCount = cache.getDecodeCount();
+		{
+			StaticSound sound1;
+			StaticSound sound2;
+			sound1.load(file);
+			sound2.load(file);
+
+			// Loading only reads the header
+			CPPUNIT_ASSERT( sound1.getPcmData() == sound2.getPcmData() );
+			CPPUNIT_ASSERT_EQUAL( 2,sound1.getPcmData()->getRefCount() );
+			CPPUNIT_ASSERT_EQUAL( dataSize,sound2.getInfo()->getSize() );
+			CPPUNIT_ASSERT_EQUAL( (uint32)8000,sound2.getInfo()->getSamplesPerSecond() );
+			CPPUNIT_ASSERT( sound1.getSamples() == NULL );
+			CPPUNIT_ASSERT_EQUAL( decodeCount,cache.getDecodeCount() );
+
+			CPPUNIT_ASSERT( sound1.loadSamples() == true );
+			CPPUNIT_ASSERT( sound2.loadSamples() == true );
+			CPPUNIT_ASSERT_EQUAL( decodeCount + 1,cache.getDecodeCount() );
+			CPPUNIT_ASSERT( sound2.getSamples() == sound1.getSamples() );
+			CPPUNIT_ASSERT( soundCacheTestSamplesMatch(sound2.getSamples(), dataSize, 3) );
+			CPPUNIT_ASSERT_EQUAL( entryCount + 1,cache.getEntryCount() );
+		}
+		CPPUNIT_ASSERT_EQUAL( entryCount,cache.getEntryCount() );
+
+		removeSoundCacheTestFile(file);
+	}
+
+	void test_background_decode() {
+		const string file = "sound_cache_test2.wav";
+		const uint32 dataSize = 4000;
+		createSoundCacheTestWav(file, dataSize, 7);
+
+		StaticSound sound;
+		sound.load(file);
+		CPPUNIT_ASSERT( sound.requestSamples() == false );
+
+		bool ready = false;
+		for(int attempt = 0; attempt < 5000 && ready == false; ++attempt) {
+			ready = sound.requestSamples();
+			if(ready == false) {
+				sleep(1);
+			}
+		}
+		CPPUNIT_ASSERT( ready == true );
+		CPPUNIT_ASSERT( soundCacheTestSamplesMatch(sound.getSamples(), dataSize, 7) );
+
+		PcmSoundCache::getInstance().stopDecodeThread();
+		sound.close();
+		removeSoundCacheTestFile(file);
+	}
+
+	void test_memory_limit_evicts_least_recently_used() {
+		const uint32 dataSize = 2000;
+		const string files[3] = { "sound_cache_test3.wav", "sound_cache_test4.wav", "sound_cache_test5.wav" };
+		StaticSound sounds[3];
+		for(int i = 0; i < 3; ++i) {
+			createSoundCacheTestWav(files[i], dataSize, i);
+			sounds[i].load(files[i]);
+		}
+
+		PcmSoundCache &cache = PcmSoundCache::getInstance();
+		uint64 memoryLimit = cache.getMemoryLimit();
+		uint64 memoryUsed = cache.getMemoryUsed();
+		uint32 evictionCount = cache.getEvictionCount();
+		cache.setMemoryLimit(memoryUsed + dataSize * 2);
+
+		CPPUNIT_ASSERT( sounds[0].loadSamples() == true );
+		CPPUNIT_ASSERT( sounds[1].loadSamples() == true );
+		CPPUNIT_ASSERT( sounds[0].loadSamples() == true );
+		CPPUNIT_ASSERT( sounds[2].loadSamples() == true );
+
+		// The second sound was used least recently
+		CPPUNIT_ASSERT_EQUAL( evictionCount + 1,cache.getEvictionCount() );
+		CPPUNIT_ASSERT( sounds[1].getSamples() == NULL );
+		CPPUNIT_ASSERT( soundCacheTestSamplesMatch(sounds[0].getSamples(), dataSize, 0) );
+		CPPUNIT_ASSERT( soundCacheTestSamplesMatch(sounds[2].getSamples(), dataSize, 2) );
+
+		// Evicted samples are decoded again when needed
+		CPPUNIT_ASSERT( sounds[1].loadSamples() == true );
+		CPPUNIT_ASSERT( soundCacheTestSamplesMatch(sounds[1].getSamples(), dataSize, 1) );
+
+		cache.setMemoryLimit(memoryLimit);
+		for(int i = 0; i < 3; ++i) {
+			sounds[i].close();
+			removeSoundCacheTestFile(files[i]);
+		}
+		CPPUNIT_ASSERT_EQUAL( memoryUsed,cache.getMemoryUsed() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SoundCacheTest );
+//
@@ -0,0 +1,256 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "checksum.h"
+#include "util.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include <fstream>
+#include <vector>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Utility methods for tests
+//
+static void removeChecksumTestFile(const string &file) {
+#ifdef WIN32
+	_unlink(file.c_str());
+#else
+    unlink(file.c_str());
+#endif
+}
+
+static void createChecksumTestFile(const string &file, const string &contents) {
+	std::ofstream out(file.c_str(), std::ios::out | std::ios::binary);
+	out << contents;
+	out.close();
+}
+
+//
+// Tests for Checksum class
+//
+class ChecksumTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ChecksumTest );
+
+	CPPUNIT_TEST( test_addBytes_matches_addByte );
+	CPPUNIT_TEST( test_xml_formatting_is_ignored );
+	CPPUNIT_TEST( test_file_cache_is_refreshed );
+	CPPUNIT_TEST( test_same_size_rewrite_is_rehashed );
+	CPPUNIT_TEST( test_parallel_matches_serial );
+	CPPUNIT_TEST( test_file_index_is_reloaded );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_addBytes_matches_addByte() {
+		std::vector<char> data;
+		for(unsigned int i = 0; i < 1027; ++i) {
+			data.push_back((char)((i * 31) ^ (i >> 3)));
+		}
+
+		// Every length exercises a different split between the 8 byte
+		// slices and the single byte tail
+		for(unsigned int length = 0; length < data.size(); length += 13) {
+			Checksum byteResult;
+			for(unsigned int i = 0; i < length; ++i) {
+				byteResult.addByte(data[i]);
+			}
+			Checksum blockResult;
+			blockResult.addBytes(length > 0 ? &data[0] : NULL, length);
+
+			CPPUNIT_ASSERT_EQUAL( byteResult.getSum(),blockResult.getSum() );
+		}
+	}
+
+	void test_xml_formatting_is_ignored() {
+		const string file1 = "checksum_test1.xml";
+		const string file2 = "checksum_test2.xml";
+		createChecksumTestFile(file1, "<menu value=\"1\"><child/></menu>");
+		createChecksumTestFile(file2, "<menu value=\"1\">\r\n\t<!-- a comment -->\n\t<child/>\n</menu>\n");
+
+		Checksum::clearFileCache();
+		Checksum checksum1;
+		checksum1.addFile(file1);
+		Checksum checksum2;
+		checksum2.addFile(file2);
+
+		CPPUNIT_ASSERT( checksum1.getFinalFileListSum() != 0 );
+		CPPUNIT_ASSERT( checksum2.getFinalFileListSum() != 0 );
+
+		// The file name is part of each file's sum
+		Checksum expected1;
+		expected1.addString(file1);
+		expected1.addString("<menuvalue=\"1\"><child/></menu>");
+		CPPUNIT_ASSERT_EQUAL( expected1.getSum(),checksum1.getFinalFileListSum() );
+
+		Checksum expected2;
+		expected2.addString(file2);
+		expected2.addString("<menuvalue=\"1\"><child/></menu>");
+		CPPUNIT_ASSERT_EQUAL( expected2.getSum(),checksum2.getFinalFileListSum() );
+
+		removeChecksumTestFile(file1);
+		removeChecksumTestFile(file2);
+	}
+
+	void test_file_cache_is_refreshed() {
+		const string file = "checksum_test3.bin";
+		createChecksumTestFile(file, "first version");
+
+		Checksum::clearFileCache();
+		Checksum checksum1;
+		checksum1.addFile(file);
+		uint32 firstSum = checksum1.getFinalFileListSum();
+
+		createChecksumTestFile(file, "second version, longer");
+		Checksum::removeFileFromCache(file);
+
+		Checksum checksum2;
+		checksum2.addFile(file);
+		uint32 secondSum = checksum2.getFinalFileListSum();
+		CPPUNIT_ASSERT( firstSum != secondSum );
+
+		Checksum expected;
+		expected.addString(file);
+		expected.addString("second version, longer");
+		CPPUNIT_ASSERT_EQUAL( expected.getSum(),secondSum );
+
+		removeChecksumTestFile(file);
+	}
+
+	void test_same_size_rewrite_is_rehashed() {
+		const string file = "checksum_test4.bin";
+		createChecksumTestFile(file, "version 1");
+
+		Checksum::clearFileCache();
+		Checksum checksum1;
+		checksum1.addFile(file);
+		checksum1.getFinalFileListSum();
+
+		// Same size and most likely the same second, removing the file
+		// from the cache must also drop its file index entry
+		createChecksumTestFile(file, "version 2");
+		Checksum::removeFileFromCache(file);
+
+		Checksum checksum2;
+		checksum2.addFile(file);
+		Checksum expected;
+		expected.addString(file);
+		expected.addString("version 2");
+		CPPUNIT_ASSERT_EQUAL( expected.getSum(),checksum2.getFinalFileListSum() );
+
+		removeChecksumTestFile(file);
+	}
+
+	void test_parallel_matches_serial() {
+		// Enough files for 4 workers of at least 8 files each
+		const int fileCount = 40;
+		std::vector<string> files;
+		uint32 expectedSum = 0;
+		for(int index = 0; index < fileCount; ++index) {
+			string file = "checksum_test_parallel" + intToStr(index) + ".bin";
+			string contents(index * 37 + 1, (char)('a' + index % 26));
+			createChecksumTestFile(file, contents);
+			files.push_back(file);
+
+			Checksum expected;
+			expected.addString(file);
+			expected.addString(contents);
+			expectedSum += expected.getSum();
+		}
+		int workerThreadCount = Checksum::getFileHashWorkerThreadCount();
+
+		Checksum::clearFileCache();
+		Checksum::setFileHashWorkerThreadCount(0);
+		Checksum serial;
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			serial.addFile(files[index]);
+		}
+		uint32 serialSum = serial.getFinalFileListSum();
+
+		Checksum::clearFileCache();
+		Checksum::setFileHashWorkerThreadCount(4);
+		ChecksumStats statsBefore = Checksum::getStats();
+		Checksum parallel;
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			parallel.addFile(files[index]);
+		}
+		uint32 parallelSum = parallel.getFinalFileListSum();
+		ChecksumStats statsAfter = Checksum::getStats();
+		Checksum::setFileHashWorkerThreadCount(workerThreadCount);
+
+		CPPUNIT_ASSERT_EQUAL( expectedSum,serialSum );
+		CPPUNIT_ASSERT_EQUAL( serialSum,parallelSum );
+		CPPUNIT_ASSERT_EQUAL( statsBefore.filesHashed + fileCount,statsAfter.filesHashed );
+
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			removeChecksumTestFile(files[index]);
+		}
+	}
+
+	void test_file_index_is_reloaded() {
+		const string file = "checksum_test5.bin";
+		const string indexFile = "checksum_test_CRC_FILE_INDEX";
+		string cachePath = getCRCCacheFilePath();
+
+		// The index is written next to the test files
+		Checksum::reloadFileIndex();
+		setCRCCacheFilePath("checksum_test_");
+		removeChecksumTestFile(indexFile);
+
+		createChecksumTestFile(file, "first version");
+		Checksum checksum1;
+		checksum1.addFile(file);
+		uint32 firstSum = checksum1.getFinalFileListSum();
+		Checksum::flushFileIndex();
+		CPPUNIT_ASSERT( fileExists(indexFile) == true );
+
+		// Unchanged files come from the index read back from disk
+		Checksum::reloadFileIndex();
+		ChecksumStats statsBefore = Checksum::getStats();
+		Checksum checksum2;
+		checksum2.addFile(file);
+		CPPUNIT_ASSERT_EQUAL( firstSum,checksum2.getFinalFileListSum() );
+		CPPUNIT_ASSERT_EQUAL( statsBefore.filesFromIndex + 1,Checksum::getStats().filesFromIndex );
+
+		// A file changed since the index was written is hashed again
+		createChecksumTestFile(file, "second version, longer");
+		Checksum::reloadFileIndex();
+		statsBefore = Checksum::getStats();
+		Checksum checksum3;
+		checksum3.addFile(file);
+		Checksum expected;
+		expected.addString(file);
+		expected.addString("second version, longer");
+		CPPUNIT_ASSERT_EQUAL( expected.getSum(),checksum3.getFinalFileListSum() );
+		CPPUNIT_ASSERT_EQUAL( statsBefore.filesHashed + 1,Checksum::getStats().filesHashed );
+
+		Checksum::reloadFileIndex();
+		setCRCCacheFilePath(cachePath);
+		removeChecksumTestFile(indexFile);
+		removeChecksumTestFile(file);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ChecksumTest );
+//
@@ -0,0 +1,100 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "scratch_arena.h"
+#include <memory>
+#include <cstddef>
+
+using namespace Shared::Util;
+
+//
+// Utility classes for tests
+//
+static int scratchArenaTestAllocationCount = 0;
+
+template<typename T>
+class ScratchArenaCountingAllocator : public std::allocator<T> {
+public:
+	typedef size_t size_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+
+	template<typename U>
+	struct rebind { typedef ScratchArenaCountingAllocator<U> other; };
+
+	ScratchArenaCountingAllocator() : std::allocator<T>() {}
+	ScratchArenaCountingAllocator(const ScratchArenaCountingAllocator &obj) : std::allocator<T>(obj) {}
+	template<typename U>
+	ScratchArenaCountingAllocator(const ScratchArenaCountingAllocator<U> &obj) : std::allocator<T>() {}
+
+	pointer allocate(size_type n, const void *hint=0) {
+		scratchArenaTestAllocationCount++;
+		return std::allocator<T>::allocate(n);
+	}
+};
+
+//
+// Tests for ScratchArena class
+//
+class ScratchArenaTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ScratchArenaTest );
+
+	CPPUNIT_TEST( test_reuse_does_not_allocate );
+	CPPUNIT_TEST( test_slots_are_independent );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_reuse_does_not_allocate() {
+		ScratchArena<int, ScratchArenaCountingAllocator<int> > arena(2);
+
+		// Warm up the slot to the largest size the query will need
+		ScratchArena<int, ScratchArenaCountingAllocator<int> >::List &warmup = arena.acquire(1);
+		for(int i = 0; i < 250; ++i) {
+			warmup.push_back(i);
+		}
+
+		scratchArenaTestAllocationCount = 0;
+		for(int pass = 0; pass < 100; ++pass) {
+			ScratchArena<int, ScratchArenaCountingAllocator<int> >::List &list = arena.acquire(1);
+			CPPUNIT_ASSERT_EQUAL( 0,(int)list.size() );
+			for(int i = 0; i < 250; ++i) {
+				list.push_back(i + pass);
+			}
+			CPPUNIT_ASSERT_EQUAL( 250,(int)list.size() );
+		}
+		CPPUNIT_ASSERT_EQUAL( 0,scratchArenaTestAllocationCount );
+	}
+
+	void test_slots_are_independent() {
+		ScratchArena<int> arena(3);
+		CPPUNIT_ASSERT_EQUAL( 3,arena.getSlotCount() );
+
+		ScratchArena<int>::List &list0 = arena.acquire(0);
+		ScratchArena<int>::List &list2 = arena.acquire(2);
+		list0.push_back(1);
+		list2.push_back(2);
+		list2.push_back(3);
+
+		CPPUNIT_ASSERT_EQUAL( 1,(int)list0.size() );
+		CPPUNIT_ASSERT_EQUAL( 2,(int)list2.size() );
+		CPPUNIT_ASSERT_EQUAL( 0,(int)arena.acquire(0).size() );
+		CPPUNIT_ASSERT_EQUAL( 2,(int)list2.size() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ScratchArenaTest );
+//
@@ -0,0 +1,123 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "small_vector.h"
+#include "vec.h"
+
+using namespace Shared::Util;
+using namespace Shared::Graphics;
+
+//
+// Utility methods for tests
+//
+typedef SmallVector<Vec2i,20> TestPathCells;
+
+//
+// Tests for SmallVector class
+//
+class SmallVectorTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SmallVectorTest );
+
+	CPPUNIT_TEST( test_inline_until_full );
+	CPPUNIT_TEST( test_insert_erase );
+	CPPUNIT_TEST( test_copy );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_inline_until_full() {
+		TestPathCells cells;
+		CPPUNIT_ASSERT( cells.empty() == true );
+		for(int index = 0; index < 20; ++index) {
+			cells.push_back(Vec2i(index, -index));
+		}
+		CPPUNIT_ASSERT( cells.isInline() == true );
+		CPPUNIT_ASSERT_EQUAL( (size_t)0,cells.getHeapBytes() );
+
+		// Pushing an item of the full storage
+		cells.push_back(cells[3]);
+		CPPUNIT_ASSERT( cells.isInline() == false );
+		CPPUNIT_ASSERT_EQUAL( 21,cells.size() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(3, -3),cells.back() );
+		CPPUNIT_ASSERT_EQUAL( cells.getCapacity() * sizeof(Vec2i),cells.getHeapBytes() );
+		for(int index = 0; index < 20; ++index) {
+			CPPUNIT_ASSERT_EQUAL( Vec2i(index, -index),cells[index] );
+		}
+
+		// Clear keeps the storage, shrink goes back inline
+		cells.clear();
+		CPPUNIT_ASSERT( cells.isInline() == false );
+		cells.push_back(Vec2i(7, 7));
+		cells.shrinkToFit();
+		CPPUNIT_ASSERT( cells.isInline() == true );
+		CPPUNIT_ASSERT_EQUAL( 1,cells.size() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(7, 7),cells.front() );
+	}
+
+	void test_insert_erase() {
+		SmallVector<int,4> values;
+		for(int index = 0; index < 6; ++index) {
+			values.insert(values.begin(), index);
+		}
+		// 5 4 3 2 1 0
+		CPPUNIT_ASSERT_EQUAL( 6,values.size() );
+		CPPUNIT_ASSERT_EQUAL( 5,values.front() );
+		CPPUNIT_ASSERT_EQUAL( 0,values.back() );
+
+		values.insert(values.begin() + 2, values[5]);
+		// 5 4 0 3 2 1 0
+		CPPUNIT_ASSERT_EQUAL( 0,values[2] );
+		CPPUNIT_ASSERT_EQUAL( 3,values[3] );
+
+		SmallVector<int,4>::iterator iter = values.erase(values.begin());
+		CPPUNIT_ASSERT_EQUAL( 4,*iter );
+		values.erase(values.end() - 1);
+		values.pop_back();
+		// 4 0 3 2
+		const int expected[] = { 4, 0, 3, 2 };
+		CPPUNIT_ASSERT_EQUAL( 4,values.size() );
+		int index = 0;
+		for(SmallVector<int,4>::const_iterator iterValue = values.begin(); iterValue != values.end(); ++iterValue) {
+			CPPUNIT_ASSERT_EQUAL( expected[index++],*iterValue );
+		}
+	}
+
+	void test_copy() {
+		TestPathCells small;
+		small.push_back(Vec2i(1, 2));
+		TestPathCells large;
+		for(int index = 0; index < 30; ++index) {
+			large.push_back(Vec2i(index, index));
+		}
+
+		TestPathCells copy(large);
+		CPPUNIT_ASSERT_EQUAL( 30,copy.size() );
+		CPPUNIT_ASSERT( copy.begin() != large.begin() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(29, 29),copy.back() );
+
+		copy = small;
+		CPPUNIT_ASSERT_EQUAL( 1,copy.size() );
+		CPPUNIT_ASSERT_EQUAL( Vec2i(1, 2),copy[0] );
+
+		TestPathCells inlineCopy(small);
+		CPPUNIT_ASSERT( inlineCopy.isInline() == true );
+		inlineCopy = inlineCopy;
+		CPPUNIT_ASSERT_EQUAL( Vec2i(1, 2),inlineCopy[0] );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SmallVectorTest );
+//
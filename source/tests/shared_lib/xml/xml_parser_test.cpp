@@ -171,6 +171,7 @@ class XmlIoRapidTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST_EXCEPTION( test_load_file_malformed_content,  megaglest_runtime_error );
 	CPPUNIT_TEST_EXCEPTION( test_save_file_null_node,  megaglest_runtime_error );
 	CPPUNIT_TEST(test_save_file_valid_node );
+	CPPUNIT_TEST( test_load_file_indexed_children );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -230,6 +231,41 @@ public:
 
 		delete rootNode;
 	}
+
+	void test_load_file_indexed_children() {
+		const string test_filename = "xml_test_indexed_children.xml";
+		std::ofstream xmlFile(test_filename.c_str());
+		xmlFile << "<?xml version=\"1.0\"?>" << std::endl << "<units>" << std::endl;
+		for(int i = 0; i < 20; ++i) {
+			xmlFile << "<unit id=\"" << i << "\"/>" << std::endl;
+			if(i % 5 == 0) {
+				xmlFile << "<marker id=\"" << i << "\"/>" << std::endl;
+			}
+		}
+		xmlFile << "</units>" << std::endl;
+		xmlFile.close();
+		SafeRemoveTestFile deleteFile(test_filename);
+
+		XmlNode *rootNode = XmlIoRapid::getInstance().load(test_filename, std::map<string,string>());
+		CPPUNIT_ASSERT( rootNode != NULL );
+
+		CPPUNIT_ASSERT_EQUAL( (size_t)24,rootNode->getChildCount() );
+		CPPUNIT_ASSERT_EQUAL( (size_t)20,rootNode->getChildList("unit").size() );
+		CPPUNIT_ASSERT_EQUAL( (size_t)4,rootNode->getChildList("marker").size() );
+		CPPUNIT_ASSERT_EQUAL( (size_t)0,rootNode->getChildList("missing").size() );
+		CPPUNIT_ASSERT_EQUAL( 13,rootNode->getChild("unit",13)->getAttribute("id")->getIntValue() );
+		CPPUNIT_ASSERT_EQUAL( 15,rootNode->getChild("marker",3)->getAttribute("id")->getIntValue() );
+		CPPUNIT_ASSERT_EQUAL( true, rootNode->hasChildAtIndex("unit",19) );
+		CPPUNIT_ASSERT_EQUAL( false, rootNode->hasChildAtIndex("unit",20) );
+		CPPUNIT_ASSERT_EQUAL( false, rootNode->hasChild("missing") );
+
+		// Removing children keeps the lookups consistent
+		CPPUNIT_ASSERT_EQUAL( 4, rootNode->clearChild("marker") );
+		CPPUNIT_ASSERT_EQUAL( false, rootNode->hasChild("marker") );
+		CPPUNIT_ASSERT_EQUAL( 7,rootNode->getChild("unit",7)->getAttribute("id")->getIntValue() );
+
+		delete rootNode;
+	}
 };
 
 //
@@ -335,6 +371,7 @@ class XmlNodeTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( test_valid_named_node );
 	CPPUNIT_TEST( test_child_nodes );
 	CPPUNIT_TEST( test_node_attributes );
+	CPPUNIT_TEST( test_attribute_tag_replacement );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -471,6 +508,24 @@ public:
 		CPPUNIT_ASSERT_EQUAL( true, node.hasAttribute("some-attribute") );
 	}
 
+	void test_attribute_tag_replacement() {
+		XmlNode node("testNode");
+
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$TESTPATH"] = "/test/path";
+		mapTagReplacementValues["{TESTNAME}"] = "name";
+
+		XmlAttribute *attribute1 = node.addAttribute("plain", "some-value", mapTagReplacementValues);
+		CPPUNIT_ASSERT_EQUAL( string("some-value"), attribute1->getValue() );
+
+		XmlAttribute *attribute2 = node.addAttribute("tagged", "$TESTPATH/{TESTNAME}.xml", mapTagReplacementValues);
+		CPPUNIT_ASSERT_EQUAL( string("/test/path/name.xml"), attribute2->getValue() );
+
+		// Tag start characters alone are left untouched
+		XmlAttribute *attribute3 = node.addAttribute("marker", "50%{", mapTagReplacementValues);
+		CPPUNIT_ASSERT_EQUAL( string("50%{"), attribute3->getValue() );
+	}
+
 };
 
 #if defined(WANT_XERCES)
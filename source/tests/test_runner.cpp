@@ -12,7 +12,7 @@
 #include <cppunit/CompilerOutputter.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
-
+#include <string>
 
 int main(int argc, char* argv[])
 {
@@ -23,6 +23,13 @@ int main(int argc, char* argv[])
   CppUnit::TextUi::TestRunner runner;
   runner.addTest( suite );
 
+  // Benchmarks are registered as "benchmark" and only run on request
+  for(int index = 1; index < argc; ++index) {
+    if(std::string(argv[index]) == "--benchmark") {
+      runner.addTest( CppUnit::TestFactoryRegistry::getRegistry("benchmark").makeTest() );
+    }
+  }
+
   // Change the default outputter to a compiler error format outputter
   runner.setOutputter( new CppUnit::CompilerOutputter( &runner.result(),
                                                        std::cerr ) );